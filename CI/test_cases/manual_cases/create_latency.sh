@@ -0,0 +1,68 @@
+#!/bin/bash
+#
+# attributes: isulad create performance
+# concurrent: NA
+# spend time: 120
+
+# Manual Testcase Remarks:
+# Measure the latency of container create. COUNT containers are created one by one,
+# total and per container time are printed, then all of them are removed. Compare the
+# output of two builds on the same machine, e.g. COUNT=1000 ./create_latency.sh
+
+#######################################################################
+##- @Copyright (C) Huawei Technologies., Ltd. 2026. All rights reserved.
+# - iSulad licensed under the Mulan PSL v2.
+# - You can use this software according to the terms and conditions of the Mulan PSL v2.
+# - You may obtain a copy of Mulan PSL v2 at:
+# -     http://license.coscl.org.cn/MulanPSL2
+# - THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+# - IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+# - PURPOSE.
+# - See the Mulan PSL v2 for more details.
+##- @Description:CI
+##- @Author: agent
+##- @Create: 2026-10-18
+#######################################################################
+
+declare -r curr_path=$(dirname $(readlink -f "$0"))
+source ../helpers.sh
+test="create latency test => test_create_latency"
+count=${COUNT:-1000}
+image="busybox"
+prefix="create_latency_"
+
+function test_create_latency()
+{
+  local ret=0
+  local start
+  local end
+  local cost
+
+  isula inspect ${image} > /dev/null 2>&1 || isula pull ${image}
+  [[ $? -ne 0 ]] && msg_err "${FUNCNAME[0]}:${LINENO} - failed to pull image: ${image}" && return 1
+
+  start=$(date +%s%N)
+  for i in $(seq 1 ${count}); do
+    isula create --name ${prefix}${i} ${image} > /dev/null
+    [[ $? -ne 0 ]] && msg_err "${FUNCNAME[0]}:${LINENO} - failed to create container ${prefix}${i}" && ((ret++)) && break
+  done
+  end=$(date +%s%N)
+
+  cost=$(((end - start) / 1000000))
+  msg_info "created ${count} containers in ${cost} ms, $((cost * 1000 / count)) us per container"
+
+  isula ps -aq --filter "name=${prefix}" | xargs -r isula rm -f > /dev/null
+  [[ $? -ne 0 ]] && msg_err "${FUNCNAME[0]}:${LINENO} - failed to remove containers" && ((ret++))
+
+  return ${ret}
+}
+
+declare -i ans=0
+
+msg_info "${test} starting..."
+
+test_create_latency || ((ans++))
+
+msg_info "${test} finished with return ${ans}..."
+
+show_result ${ans} "${curr_path}/${0}"
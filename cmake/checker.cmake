@@ -47,6 +47,16 @@ find_library(ZLIB_LIBRARY z
   HINTS ${PC_ZLIB_LIBDIR} ${PC_ZLIB_LIBRARY_DIRS})
 _CHECK(ZLIB_LIBRARY "ZLIB_LIBRARY-NOTFOUND" "libz.so")
 
+if (ENABLE_ZSTD)
+    pkg_check_modules(PC_ZSTD "libzstd>=1.4.0")
+    find_path(ZSTD_INCLUDE_DIR zstd.h
+        HINTS ${PC_ZSTD_INCLUDEDIR} ${PC_ZSTD_INCLUDE_DIRS})
+    _CHECK(ZSTD_INCLUDE_DIR "ZSTD_INCLUDE_DIR-NOTFOUND" "zstd.h")
+    find_library(ZSTD_LIBRARY zstd
+        HINTS ${PC_ZSTD_LIBDIR} ${PC_ZSTD_LIBRARY_DIRS})
+    _CHECK(ZSTD_LIBRARY "ZSTD_LIBRARY-NOTFOUND" "libzstd.so")
+endif()
+
 # check libyajl
 pkg_check_modules(PC_LIBYAJL REQUIRED "yajl>=2")
 find_path(LIBYAJL_INCLUDE_DIR yajl/yajl_tree.h
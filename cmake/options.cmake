@@ -61,6 +61,18 @@ if (ENABLE_EMBEDDED STREQUAL "ON")
     set(ENABLE_EMBEDDED_IMAGE 1)
 endif()
 
+option(ENABLE_ZSTD "enable zstd compressed image layers" OFF)
+if (ENABLE_ZSTD STREQUAL "ON")
+    add_definitions(-DENABLE_ZSTD=1)
+    set(ENABLE_ZSTD 1)
+endif()
+
+option(ENABLE_METRICS "enable the metrics of isulad on a local unix socket" OFF)
+if (ENABLE_METRICS STREQUAL "ON")
+    add_definitions(-DENABLE_METRICS=1)
+    set(ENABLE_METRICS 1)
+endif()
+
 option(ENABLE_SELINUX "enable isulad daemon selinux option" ON)
 if (ENABLE_SELINUX STREQUAL "ON")
     add_definitions(-DENABLE_SELINUX=1)
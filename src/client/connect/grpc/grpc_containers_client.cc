@@ -36,6 +36,19 @@ using grpc::Status;
 using grpc::StatusCode;
 using google::protobuf::Timestamp;
 
+// Output of attach/exec goes straight to the terminal fds, flushing an ostream for
+// every message used to cost more than the write itself.
+template <class Response>
+static void WriteStreamOutputToTerminal(const Response &response)
+{
+    if (!response.stdout().empty()) {
+        (void)util_write_nointr_in_total(STDOUT_FILENO, response.stdout().data(), response.stdout().size());
+    }
+    if (!response.stderr().empty()) {
+        (void)util_write_nointr_in_total(STDERR_FILENO, response.stderr().data(), response.stderr().size());
+    }
+}
+
 class ContainerVersion : public ClientBase<ContainerService, ContainerService::Stub, isula_version_request,
     VersionRequest, isula_version_response, VersionResponse> {
 public:
@@ -407,12 +420,7 @@ public:
                 if (stream_response.finish()) {
                     break;
                 }
-                if (!stream_response.stdout().empty()) {
-                    std::cout << stream_response.stdout() << std::flush;
-                }
-                if (!stream_response.stderr().empty()) {
-                    std::cerr << stream_response.stderr() << std::flush;
-                }
+                WriteStreamOutputToTerminal(stream_response);
             }
         }
         write_task.stop();
@@ -992,12 +1000,7 @@ out:
             if (stream_response.finish()) {
                 break;
             }
-            if (!stream_response.stdout().empty()) {
-                std::cout << stream_response.stdout() << std::flush;
-            }
-            if (!stream_response.stderr().empty()) {
-                std::cerr << stream_response.stderr() << std::flush;
-            }
+            WriteStreamOutputToTerminal(stream_response);
         }
         write_task.stop();
         stream->WritesDone();
@@ -1397,12 +1400,7 @@ public:
                 if (stream_response.finish()) {
                     break;
                 }
-                if (!stream_response.stdout().empty()) {
-                    std::cout << stream_response.stdout() << std::flush;
-                }
-                if (!stream_response.stderr().empty()) {
-                    std::cerr << stream_response.stderr() << std::flush;
-                }
+                WriteStreamOutputToTerminal(stream_response);
             }
         }
         write_task.stop();
@@ -1635,6 +1633,32 @@ public:
     }
 };
 
+static void container_info_from_grpc(const containers::Container_info &gstats, isula_container_info *stats)
+{
+    if (!gstats.id().empty()) {
+        stats->id = util_strdup_s(gstats.id().c_str());
+    }
+    stats->pids_current = gstats.pids_current();
+    stats->cpu_use_nanos = gstats.cpu_use_nanos();
+    stats->cpu_system_use = gstats.cpu_system_use();
+    stats->online_cpus = gstats.online_cpus();
+    stats->blkio_read = gstats.blkio_read();
+    stats->blkio_write = gstats.blkio_write();
+    stats->mem_used = gstats.mem_used();
+    stats->mem_limit = gstats.mem_limit();
+    stats->kmem_used = gstats.kmem_used();
+    stats->kmem_limit = gstats.kmem_limit();
+    if (!gstats.name().empty()) {
+        stats->name = util_strdup_s(gstats.name().c_str());
+    }
+    if (!gstats.status().empty()) {
+        stats->status = util_strdup_s(gstats.status().c_str());
+    }
+    stats->cache = gstats.cache();
+    stats->cache_total = gstats.cache_total();
+    stats->inactive_file_total = gstats.inactive_file_total();
+}
+
 class ContainerStats : public ClientBase<ContainerService, ContainerService::Stub, isula_stats_request, StatsRequest,
     isula_stats_response, StatsResponse> {
 public:
@@ -1670,28 +1694,7 @@ public:
                 return -1;
             }
             for (int i = 0; i < size; i++) {
-                if (!gresponse->containers(i).id().empty()) {
-                    response->container_stats[i].id = util_strdup_s(gresponse->containers(i).id().c_str());
-                }
-                response->container_stats[i].pids_current = gresponse->containers(i).pids_current();
-                response->container_stats[i].cpu_use_nanos = gresponse->containers(i).cpu_use_nanos();
-                response->container_stats[i].cpu_system_use = gresponse->containers(i).cpu_system_use();
-                response->container_stats[i].online_cpus = gresponse->containers(i).online_cpus();
-                response->container_stats[i].blkio_read = gresponse->containers(i).blkio_read();
-                response->container_stats[i].blkio_write = gresponse->containers(i).blkio_write();
-                response->container_stats[i].mem_used = gresponse->containers(i).mem_used();
-                response->container_stats[i].mem_limit = gresponse->containers(i).mem_limit();
-                response->container_stats[i].kmem_used = gresponse->containers(i).kmem_used();
-                response->container_stats[i].kmem_limit = gresponse->containers(i).kmem_limit();
-                if (!gresponse->containers(i).name().empty()) {
-                    response->container_stats[i].name = util_strdup_s(gresponse->containers(i).name().c_str());
-                }
-                if (!gresponse->containers(i).status().empty()) {
-                    response->container_stats[i].status = util_strdup_s(gresponse->containers(i).status().c_str());
-                }
-                response->container_stats[i].cache = gresponse->containers(i).cache();
-                response->container_stats[i].cache_total = gresponse->containers(i).cache_total();
-                response->container_stats[i].inactive_file_total = gresponse->containers(i).inactive_file_total();
+                container_info_from_grpc(gresponse->containers(i), &response->container_stats[i]);
             }
             response->container_num = static_cast<size_t>(size);
         }
@@ -1714,6 +1717,98 @@ public:
     }
 };
 
+class ContainerStatsStream : public ClientBase<ContainerService, ContainerService::Stub, isula_stats_request,
+    StatsRequest, isula_stats_response, StatsStreamResponse> {
+public:
+    explicit ContainerStatsStream(void *args)
+        : ClientBase(args)
+    {
+    }
+    ~ContainerStatsStream() = default;
+
+    auto run(const struct isula_stats_request *request, struct isula_stats_response *response) -> int override
+    {
+        StatsRequest req;
+        StatsStreamResponse gframe;
+        ClientContext context;
+        Status status;
+        struct isula_stats_frame *frame = nullptr;
+
+        if (request == nullptr) {
+            response->cc = ISULAD_ERR_INPUT;
+            return -1;
+        }
+
+        if (SetMetadataInfo(context) != 0) {
+            ERROR("Failed to set metadata info for authorization");
+            response->cc = ISULAD_ERR_INPUT;
+            return -1;
+        }
+
+        for (size_t i = 0; request->containers != nullptr && i < request->containers_len; i++) {
+            req.add_containers(request->containers[i]);
+        }
+        req.set_all(request->all);
+
+        std::unique_ptr<ClientReader<StatsStreamResponse>> reader(stub_->StatsStream(&context, req));
+        while (reader->Read(&gframe)) {
+            frame = frame_from_grpc(&gframe);
+            if (frame == nullptr) {
+                ERROR("Out of memory");
+                context.TryCancel();
+                response->cc = ISULAD_ERR_EXEC;
+                return -1;
+            }
+            if (request->cb != nullptr) {
+                request->cb(frame, request->cb_arg);
+            }
+            isula_stats_frame_free(frame);
+            frame = nullptr;
+        }
+        status = reader->Finish();
+        if (!status.ok()) {
+            ERROR("error_code: %d: %s", status.error_code(), status.error_message().c_str());
+            unpackStatus(status, response);
+            return -1;
+        }
+
+        return 0;
+    }
+
+private:
+    struct isula_stats_frame *frame_from_grpc(StatsStreamResponse *gframe)
+    {
+        struct isula_stats_frame *frame =
+            static_cast<struct isula_stats_frame *>(util_common_calloc_s(sizeof(struct isula_stats_frame)));
+        if (frame == nullptr) {
+            return nullptr;
+        }
+
+        int size = gframe->containers_size();
+        if (size > 0) {
+            frame->container_stats = static_cast<isula_container_info *>(
+                                         util_common_calloc_s(size * sizeof(struct isula_container_info)));
+            if (frame->container_stats == nullptr) {
+                isula_stats_frame_free(frame);
+                return nullptr;
+            }
+            for (int i = 0; i < size; i++) {
+                container_info_from_grpc(gframe->containers(i), &frame->container_stats[i]);
+            }
+            frame->container_num = static_cast<size_t>(size);
+        }
+        for (int i = 0; i < gframe->removed_size(); i++) {
+            if (util_array_append(&frame->removed, gframe->removed(i).c_str()) != 0) {
+                isula_stats_frame_free(frame);
+                return nullptr;
+            }
+            frame->removed_len++;
+        }
+
+        return frame;
+    }
+};
+
 class ContainerEvents : public ClientBase<ContainerService, ContainerService::Stub, isula_events_request, EventsRequest,
     isula_events_response, Event> {
 public:
@@ -2224,6 +2319,7 @@ auto grpc_containers_client_ops_init(isula_connect_ops *ops) -> int
     ops->container.update = container_func<isula_update_request, isula_update_response, ContainerUpdate>;
     ops->container.kill = container_func<isula_kill_request, isula_kill_response, ContainerKill>;
     ops->container.stats = container_func<isula_stats_request, isula_stats_response, ContainerStats>;
+    ops->container.stats_stream = container_func<isula_stats_request, isula_stats_response, ContainerStatsStream>;
     ops->container.wait = container_func<isula_wait_request, isula_wait_response, ContainerWait>;
     ops->container.events = container_func<isula_events_request, isula_events_response, ContainerEvents>;
     ops->container.inspect = container_func<isula_inspect_request, isula_inspect_response, ContainerInspect>;
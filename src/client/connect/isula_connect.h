@@ -51,6 +51,9 @@ typedef struct {
 
     int (*stats)(const struct isula_stats_request *request, struct isula_stats_response *response, void *arg);
 
+    // optional, calls request->cb with a frame every sampling interval until the stream ends
+    int (*stats_stream)(const struct isula_stats_request *request, struct isula_stats_response *response, void *arg);
+
     int (*events)(const struct isula_events_request *request, struct isula_events_response *response, void *arg);
 
     int (*copy_from_container)(const struct isula_copy_from_container_request *request,
@@ -725,6 +725,10 @@ void isula_stats_response_free(struct isula_stats_response *response)
         for (i = 0; i < response->container_num; i++) {
             free(response->container_stats[i].id);
             response->container_stats[i].id = NULL;
+            free(response->container_stats[i].name);
+            response->container_stats[i].name = NULL;
+            free(response->container_stats[i].status);
+            response->container_stats[i].status = NULL;
         }
         free(response->container_stats);
         response->container_stats = NULL;
@@ -732,6 +736,26 @@ void isula_stats_response_free(struct isula_stats_response *response)
     free(response);
 }
 
+void isula_stats_frame_free(struct isula_stats_frame *frame)
+{
+    size_t i;
+
+    if (frame == NULL) {
+        return;
+    }
+
+    for (i = 0; frame->container_stats != NULL && i < frame->container_num; i++) {
+        free(frame->container_stats[i].id);
+        free(frame->container_stats[i].name);
+        free(frame->container_stats[i].status);
+    }
+    free(frame->container_stats);
+    frame->container_stats = NULL;
+    util_free_array_by_len(frame->removed, frame->removed_len);
+    frame->removed = NULL;
+    free(frame);
+}
+
 /* isula events request free */
 void isula_events_request_free(struct isula_events_request *request)
 {
@@ -218,10 +218,23 @@ struct isula_list_response {
     char *errmsg;
 };
 
+// frame of a stats stream, containers whose stats changed and ids of containers removed since the last frame
+struct isula_stats_frame {
+    size_t container_num;
+    struct isula_container_info *container_stats;
+    char **removed;
+    size_t removed_len;
+};
+
+typedef void (*container_stats_callback_t)(const struct isula_stats_frame *frame, void *arg);
+
 struct isula_stats_request {
     char **containers;
     size_t containers_len;
     bool all;
+    // frames of stats_stream
+    container_stats_callback_t cb;
+    void *cb_arg;
 };
 
 struct isula_stats_response {
@@ -691,6 +704,8 @@ void isula_stats_request_free(struct isula_stats_request *request);
 
 void isula_stats_response_free(struct isula_stats_response *response);
 
+void isula_stats_frame_free(struct isula_stats_frame *frame);
+
 void isula_events_request_free(struct isula_events_request *request);
 
 void isula_events_response_free(struct isula_events_response *response);
@@ -44,6 +44,9 @@ struct client_arguments g_cmd_stats_args = {
 };
 
 static struct isula_stats_response *g_oldstats = NULL;
+// containers shown by a stats stream, g_oldstats is the view before the last frame
+static struct isula_stats_response *g_curstats = NULL;
+static size_t g_stream_frames = 0;
 
 static void isula_size_humanize(unsigned long long val, char *buf, size_t bufsz)
 {
@@ -188,18 +191,23 @@ static void stats_output_original(const struct client_arguments *args, struct is
     }
 }
 
-static void stats_output(const struct client_arguments *args, struct isula_stats_response **response)
+static void stats_print_view(const struct isula_stats_response *view)
 {
     size_t i;
 
+    printf(TERMCLEAR);
+    stats_print_header();
+    for (i = 0; i < view->container_num; i++) {
+        stats_print(&(view->container_stats[i]));
+        printf("\n");
+    }
+    fflush(stdout);
+}
+
+static void stats_output(const struct client_arguments *args, struct isula_stats_response **response)
+{
     if (g_oldstats != NULL) {
-        printf(TERMCLEAR);
-        stats_print_header();
-        for (i = 0; i < (*response)->container_num; i++) {
-            stats_print(&((*response)->container_stats[i]));
-            printf("\n");
-        }
-        fflush(stdout);
+        stats_print_view(*response);
     }
 
     isula_stats_response_free(g_oldstats);
@@ -207,6 +215,145 @@ static void stats_output(const struct client_arguments *args, struct isula_stats
     *response = NULL;
 }
 
+static void stats_copy_info(struct isula_container_info *dst, const struct isula_container_info *src)
+{
+    *dst = *src;
+    dst->id = util_strdup_s(src->id);
+    dst->name = util_strdup_s(src->name);
+    dst->status = util_strdup_s(src->status);
+}
+
+static const struct isula_container_info *stats_frame_find(const struct isula_stats_frame *frame, const char *id)
+{
+    size_t i;
+
+    for (i = 0; i < frame->container_num; i++) {
+        if (frame->container_stats[i].id != NULL && strcmp(frame->container_stats[i].id, id) == 0) {
+            return &frame->container_stats[i];
+        }
+    }
+    return NULL;
+}
+
+static bool stats_frame_removed(const struct isula_stats_frame *frame, const char *id)
+{
+    size_t i;
+
+    for (i = 0; i < frame->removed_len; i++) {
+        if (strcmp(frame->removed[i], id) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool stats_view_has(const struct isula_stats_response *view, const char *id)
+{
+    size_t i;
+
+    for (i = 0; view != NULL && i < view->container_num; i++) {
+        if (strcmp(view->container_stats[i].id, id) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// containers of view updated by frame, unchanged containers are copied and new ones appended
+static struct isula_stats_response *stats_merge_frame(const struct isula_stats_response *view,
+                                                      const struct isula_stats_frame *frame)
+{
+    size_t i;
+    size_t len = frame->container_num;
+    const struct isula_container_info *info = NULL;
+    struct isula_stats_response *merged = NULL;
+
+    merged = util_common_calloc_s(sizeof(struct isula_stats_response));
+    if (merged == NULL) {
+        return NULL;
+    }
+    if (view != NULL) {
+        len += view->container_num;
+    }
+    merged->container_stats = util_smart_calloc_s(sizeof(struct isula_container_info), len + 1);
+    if (merged->container_stats == NULL) {
+        free(merged);
+        return NULL;
+    }
+
+    for (i = 0; view != NULL && i < view->container_num; i++) {
+        if (stats_frame_removed(frame, view->container_stats[i].id)) {
+            continue;
+        }
+        info = stats_frame_find(frame, view->container_stats[i].id);
+        stats_copy_info(&merged->container_stats[merged->container_num++],
+                        info != NULL ? info : &view->container_stats[i]);
+    }
+    for (i = 0; i < frame->container_num; i++) {
+        if (frame->container_stats[i].id == NULL || stats_view_has(view, frame->container_stats[i].id)) {
+            continue;
+        }
+        stats_copy_info(&merged->container_stats[merged->container_num++], &frame->container_stats[i]);
+    }
+
+    return merged;
+}
+
+static void stats_stream_frame_cb(const struct isula_stats_frame *frame, void *arg)
+{
+    struct isula_stats_response *merged = NULL;
+
+    (void)arg;
+    merged = stats_merge_frame(g_curstats, frame);
+    if (merged == NULL) {
+        ERROR("Out of memory");
+        return;
+    }
+    g_stream_frames++;
+
+    isula_stats_response_free(g_oldstats);
+    g_oldstats = g_curstats;
+    g_curstats = merged;
+    if (g_oldstats != NULL) {
+        stats_print_view(g_curstats);
+    }
+}
+
+// the daemon samples the stats once for all clients and pushes the changed containers
+static int client_stats_stream(const isula_connect_ops *ops, const struct isula_stats_request *request,
+                               client_connect_config_t *config, bool *fallback)
+{
+    int ret = 0;
+    struct isula_stats_request stream_request = *request;
+    struct isula_stats_response *response = NULL;
+
+    response = util_common_calloc_s(sizeof(struct isula_stats_response));
+    if (response == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    stream_request.cb = stats_stream_frame_cb;
+    stream_request.cb_arg = NULL;
+    ret = ops->container.stats_stream(&stream_request, response, config);
+    if (ret != 0 && g_stream_frames == 0) {
+        // a daemon without stats stream, poll it
+        INFO("Stats stream is unavailable, poll the stats");
+        *fallback = true;
+        ret = 0;
+    } else if (ret != 0) {
+        ERROR("Failed to stats containers info");
+        client_print_error(response->cc, response->server_errono, response->errmsg);
+    }
+
+    isula_stats_response_free(response);
+    isula_stats_response_free(g_curstats);
+    g_curstats = NULL;
+    isula_stats_response_free(g_oldstats);
+    g_oldstats = NULL;
+    return ret;
+}
+
 static int client_stats_mainloop(const struct client_arguments *args, const struct isula_stats_request *request)
 {
     int ret = 0;
@@ -223,6 +370,15 @@ static int client_stats_mainloop(const struct client_arguments *args, const stru
     }
     config = get_connect_config(args);
 
+    if (!args->original && !args->nostream && ops->container.stats_stream != NULL) {
+        bool fallback = false;
+
+        ret = client_stats_stream(ops, request, &config, &fallback);
+        if (!fallback) {
+            return ret;
+        }
+    }
+
     while (1) {
         bool first_frame = false;
         struct isula_stats_response *response = NULL;
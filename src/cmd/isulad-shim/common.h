@@ -45,6 +45,8 @@ extern "C" {
 
 #define SHIM_BINARY "isulad-shim"
 #define SHIM_LOG_NAME "shim-log.json"
+// fd of the pipe on which isulad waits for "<pid> <error>" of the created process
+#define SHIM_READY_FD_ENV "ISULAD_SHIM_READY_FD"
 
 #define CONTAINER_ACTION_REBOOT 129
 #define CONTAINER_ACTION_SHUTDOWN 130
@@ -68,6 +70,8 @@ void close_fd(int *pfd);
 
 int open_no_inherit(const char *path, int flag, mode_t mode);
 
+int set_fd_no_inherited(int fd);
+
 #ifdef __cplusplus
 }
 #endif
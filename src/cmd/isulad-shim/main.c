@@ -22,6 +22,7 @@
 #include <sys/prctl.h>
 #include <isula_libutils/shim_client_process_state.h>
 #include <stdlib.h>
+#include <limits.h>
 
 #include "common.h"
 #include "process.h"
@@ -62,6 +63,45 @@ static int set_subreaper()
     return SHIM_OK;
 }
 
+/* readiness pipe passed by isulad, -1 if there is none */
+static int get_ready_fd()
+{
+    const char *val = getenv(SHIM_READY_FD_ENV);
+    char *end = NULL;
+    long fd = -1;
+
+    if (val == NULL) {
+        return -1;
+    }
+
+    errno = 0;
+    fd = strtol(val, &end, 10);
+    if (errno != 0 || end == val || *end != '\0' || fd <= STDERR_FILENO || fd > INT_MAX) {
+        write_message(g_log_fd, WARN_MSG, "invalid ready fd %s", val);
+        fd = -1;
+    } else if (set_fd_no_inherited((int)fd) != SHIM_OK) {
+        write_message(g_log_fd, WARN_MSG, "ready fd %ld is not open", fd);
+        fd = -1;
+    }
+    /* the runtime and the container must not see it */
+    (void)unsetenv(SHIM_READY_FD_ENV);
+
+    return (int)fd;
+}
+
+/* report the created process once, isulad reads the pid file when nothing is reported */
+static void notify_ready(int *ready_fd, int pid, int err)
+{
+    if (*ready_fd < 0) {
+        return;
+    }
+
+    if (dprintf(*ready_fd, "%d %d\n", pid, err) < 0) {
+        write_message(g_log_fd, WARN_MSG, "notify isulad of pid %d failed:%d", pid, SHIM_SYS_ERR(errno));
+    }
+    close_fd(ready_fd);
+}
+
 static int parse_args(int argc, char **argv, char **cid, char **bundle, char **rt_name, char **log_level)
 {
     if (argc < 4) {
@@ -97,6 +137,7 @@ int main(int argc, char **argv)
     char *log_level = NULL;
     int ret = SHIM_ERR;
     int efd = -1;
+    int ready_fd = -1;
     process_t *p = NULL;
 
     g_log_fd = open_no_inherit(SHIM_LOG_NAME, O_CREAT | O_WRONLY | O_APPEND | O_SYNC, 0640);
@@ -110,6 +151,8 @@ int main(int argc, char **argv)
      */
     set_timeout_exit(DEFAULT_TIMEOUT);
 
+    ready_fd = get_ready_fd();
+
     ret = set_subreaper();
     if (ret != SHIM_OK) {
         write_message(g_log_fd, ERR_MSG, "set subreaper failed:%d", ret);
@@ -158,11 +201,13 @@ int main(int argc, char **argv)
 
     ret = create_process(p);
     if (ret != SHIM_OK) {
+        notify_ready(&ready_fd, 0, ret);
         if (p->console_sock_path != NULL) {
             (void)unlink(p->console_sock_path);
         }
         exit(EXIT_FAILURE);
     }
+    notify_ready(&ready_fd, p->ctr_pid, SHIM_OK);
 
     released_timeout_exit();
 
@@ -71,6 +71,9 @@
 #include "utils_verify.h"
 #include "volume_api.h"
 #include "opt_log.h"
+#ifdef ENABLE_METRICS
+#include "metrics.h"
+#endif
 
 #ifdef GRPC_CONNECTOR
 #include "clibcni/api.h"
@@ -1415,10 +1418,49 @@ out:
     return ret;
 }
 
+#ifdef ENABLE_METRICS
+static int start_metrics_server(char **msg)
+{
+    int ret = -1;
+    char *statedir = NULL;
+    char *socket_path = NULL;
+
+    statedir = conf_get_isulad_statedir();
+    if (statedir == NULL) {
+        *msg = "Failed to get isulad state dir";
+        goto out;
+    }
+
+    socket_path = util_path_join(statedir, METRICS_SOCKET_NAME);
+    if (socket_path == NULL) {
+        *msg = "Failed to get metrics socket path";
+        goto out;
+    }
+
+    if (metrics_server_start(socket_path) != 0) {
+        *msg = "Failed to start metrics server";
+        goto out;
+    }
+
+    ret = 0;
+out:
+    free(statedir);
+    free(socket_path);
+    return ret;
+}
+#endif
+
 static int start_daemon_threads(char **msg)
 {
     int ret = -1;
 
+#ifdef ENABLE_METRICS
+    // before the modules, so that the timings of their init are recorded too
+    if (start_metrics_server(msg) != 0) {
+        goto out;
+    }
+#endif
+
     if (new_shutdown_handler()) {
         *msg = "Create new shutdown handler thread failed";
         goto out;
@@ -0,0 +1,549 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide internal metrics of isulad in prometheus text format
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "metrics.h"
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "utils_file.h"
+#include "map.h"
+#include "buffer.h"
+
+#define METRICS_BUCKETS_NUM 13
+#define METRICS_MAX_COLLECTORS 8
+#define METRICS_LINE_MAX 1024
+#define METRICS_REQUEST_MAX 4096
+#define METRICS_LISTEN_BACKLOG 16
+#define METRICS_ACCEPT_BACKOFF_US (100 * 1000)
+
+typedef enum { METRICS_COUNTER, METRICS_GAUGE, METRICS_HISTOGRAM } metrics_type_t;
+
+struct metrics_metric {
+    metrics_type_t type;
+    char *name;
+    char *labels;
+    // value of a counter or gauge, the number of observations of a histogram
+    int64_t value;
+    uint64_t sum_nanos;
+    uint64_t buckets[METRICS_BUCKETS_NUM + 1];
+};
+
+// upper bounds of histogram buckets, from lock waits to image pulls, the last bucket is +Inf
+static const uint64_t g_bucket_bounds[METRICS_BUCKETS_NUM] = {
+    10000ULL, 100000ULL, 1000000ULL, 5000000ULL, 10000000ULL, 50000000ULL, 100000000ULL,
+    500000000ULL, 1000000000ULL, 5000000000ULL, 30000000000ULL, 120000000000ULL, 300000000000ULL
+};
+static const char *g_bucket_names[METRICS_BUCKETS_NUM] = {
+    "1e-05", "0.0001", "0.001", "0.005", "0.01", "0.05", "0.1", "0.5", "1", "5", "30", "120", "300"
+};
+
+static const char *g_type_names[] = { "counter", "gauge", "histogram" };
+
+static struct {
+    pthread_mutex_t mutex;
+    // "name{labels}" to metric, sorted so that the series of a name are exported together
+    map_t *metrics;
+    metrics_collector_t collectors[METRICS_MAX_COLLECTORS];
+    size_t collectors_len;
+    bool enabled;
+    int listen_fd;
+} g_metrics = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .listen_fd = -1,
+};
+
+static void metrics_kvfree(void *key, void *value)
+{
+    struct metrics_metric *metric = (struct metrics_metric *)value;
+
+    free(key);
+    if (metric != NULL) {
+        free(metric->name);
+        free(metric->labels);
+        free(metric);
+    }
+}
+
+static struct metrics_metric *metrics_get(metrics_type_t type, const char *name, const char *labels)
+{
+    struct metrics_metric *metric = NULL;
+    char *key = NULL;
+    size_t len = 0;
+
+    if (name == NULL) {
+        return NULL;
+    }
+    if (labels == NULL) {
+        labels = "";
+    }
+
+    len = strlen(name) + strlen(labels) + 3;
+    key = util_common_calloc_s(len);
+    if (key == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    (void)snprintf(key, len, "%s{%s}", name, labels);
+
+    if (pthread_mutex_lock(&g_metrics.mutex) != 0) {
+        ERROR("Failed to lock metrics");
+        free(key);
+        return NULL;
+    }
+
+    if (g_metrics.metrics == NULL) {
+        g_metrics.metrics = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, metrics_kvfree);
+        if (g_metrics.metrics == NULL) {
+            ERROR("Out of memory");
+            goto unlock;
+        }
+    }
+
+    metric = map_search(g_metrics.metrics, key);
+    if (metric != NULL) {
+        if (metric->type != type) {
+            ERROR("Metric %s is registered as %s", key, g_type_names[metric->type]);
+            metric = NULL;
+        }
+        goto unlock;
+    }
+
+    metric = util_common_calloc_s(sizeof(struct metrics_metric));
+    if (metric == NULL) {
+        ERROR("Out of memory");
+        goto unlock;
+    }
+    metric->type = type;
+    metric->name = util_strdup_s(name);
+    metric->labels = util_strdup_s(labels);
+    if (!map_insert(g_metrics.metrics, key, metric)) {
+        ERROR("Failed to register metric %s", key);
+        free(metric->name);
+        free(metric->labels);
+        free(metric);
+        metric = NULL;
+    }
+
+unlock:
+    (void)pthread_mutex_unlock(&g_metrics.mutex);
+    free(key);
+    return metric;
+}
+
+metrics_histogram_t *metrics_histogram(const char *name, const char *labels)
+{
+    return metrics_get(METRICS_HISTOGRAM, name, labels);
+}
+
+metrics_counter_t *metrics_counter(const char *name, const char *labels)
+{
+    return metrics_get(METRICS_COUNTER, name, labels);
+}
+
+metrics_gauge_t *metrics_gauge(const char *name, const char *labels)
+{
+    return metrics_get(METRICS_GAUGE, name, labels);
+}
+
+bool metrics_enabled(void)
+{
+    return __atomic_load_n(&g_metrics.enabled, __ATOMIC_RELAXED);
+}
+
+void metrics_enable(void)
+{
+    __atomic_store_n(&g_metrics.enabled, true, __ATOMIC_RELAXED);
+}
+
+uint64_t metrics_now(void)
+{
+    struct timespec ts = { 0 };
+
+    if (!metrics_enabled()) {
+        return 0;
+    }
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void metrics_observe_nanos(metrics_histogram_t *histogram, uint64_t nanos)
+{
+    size_t i = 0;
+
+    if (histogram == NULL || !metrics_enabled()) {
+        return;
+    }
+
+    while (i < METRICS_BUCKETS_NUM && nanos > g_bucket_bounds[i]) {
+        i++;
+    }
+    (void)__atomic_add_fetch(&histogram->buckets[i], 1, __ATOMIC_RELAXED);
+    (void)__atomic_add_fetch(&histogram->sum_nanos, nanos, __ATOMIC_RELAXED);
+    (void)__atomic_add_fetch(&histogram->value, 1, __ATOMIC_RELAXED);
+}
+
+void metrics_observe_since(metrics_histogram_t *histogram, uint64_t start)
+{
+    uint64_t now = 0;
+
+    if (start == 0) {
+        return;
+    }
+
+    now = metrics_now();
+    metrics_observe_nanos(histogram, now > start ? now - start : 0);
+}
+
+void metrics_counter_add(metrics_counter_t *counter, uint64_t value)
+{
+    if (counter == NULL || !metrics_enabled()) {
+        return;
+    }
+
+    (void)__atomic_add_fetch(&counter->value, (int64_t)value, __ATOMIC_RELAXED);
+}
+
+void metrics_gauge_add(metrics_gauge_t *gauge, int64_t value)
+{
+    if (gauge == NULL) {
+        return;
+    }
+
+    (void)__atomic_add_fetch(&gauge->value, value, __ATOMIC_RELAXED);
+}
+
+int metrics_register_collector(metrics_collector_t collector)
+{
+    int ret = 0;
+
+    if (collector == NULL) {
+        return -1;
+    }
+
+    if (pthread_mutex_lock(&g_metrics.mutex) != 0) {
+        ERROR("Failed to lock metrics");
+        return -1;
+    }
+    if (g_metrics.collectors_len >= METRICS_MAX_COLLECTORS) {
+        ERROR("Too many metrics collectors");
+        ret = -1;
+    } else {
+        g_metrics.collectors[g_metrics.collectors_len++] = collector;
+    }
+    (void)pthread_mutex_unlock(&g_metrics.mutex);
+
+    return ret;
+}
+
+static int metrics_printf(Buffer *buf, const char *format, ...)
+{
+    char line[METRICS_LINE_MAX] = { 0 };
+    va_list args;
+    int nret = 0;
+
+    va_start(args, format);
+    nret = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (nret < 0 || (size_t)nret >= sizeof(line)) {
+        ERROR("Metrics line is too long");
+        return -1;
+    }
+
+    return buffer_append(buf, line, (size_t)nret);
+}
+
+// the braces and labels of a series, nothing for a metric without labels
+#define LABELS_ARGS(metric) \
+    ((metric)->labels[0] != '\0' ? "{" : ""), (metric)->labels, ((metric)->labels[0] != '\0' ? "}" : "")
+
+static int export_histogram(Buffer *buf, const struct metrics_metric *metric)
+{
+    const char *sep = metric->labels[0] != '\0' ? "," : "";
+    uint64_t cumulative = 0;
+    size_t i = 0;
+
+    for (i = 0; i <= METRICS_BUCKETS_NUM; i++) {
+        cumulative += __atomic_load_n(&metric->buckets[i], __ATOMIC_RELAXED);
+        if (metrics_printf(buf, "%s_bucket{%s%sle=\"%s\"} %" PRIu64 "\n", metric->name, metric->labels, sep,
+                           i < METRICS_BUCKETS_NUM ? g_bucket_names[i] : "+Inf", cumulative) != 0) {
+            return -1;
+        }
+    }
+
+    if (metrics_printf(buf, "%s_sum%s%s%s %.9f\n", metric->name, LABELS_ARGS(metric),
+                       (double)__atomic_load_n(&metric->sum_nanos, __ATOMIC_RELAXED) / 1000000000.0) != 0) {
+        return -1;
+    }
+
+    return metrics_printf(buf, "%s_count%s%s%s %" PRId64 "\n", metric->name, LABELS_ARGS(metric),
+                          __atomic_load_n(&metric->value, __ATOMIC_RELAXED));
+}
+
+static int export_metrics(Buffer *buf)
+{
+    int ret = 0;
+    map_itor *itor = NULL;
+    const char *last_name = NULL;
+
+    if (g_metrics.metrics == NULL) {
+        return 0;
+    }
+
+    itor = map_itor_new(g_metrics.metrics);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        const struct metrics_metric *metric = map_itor_value(itor);
+
+        if (last_name == NULL || strcmp(last_name, metric->name) != 0) {
+            ret = metrics_printf(buf, "# TYPE %s %s\n", metric->name, g_type_names[metric->type]);
+            if (ret != 0) {
+                break;
+            }
+            last_name = metric->name;
+        }
+
+        if (metric->type == METRICS_HISTOGRAM) {
+            ret = export_histogram(buf, metric);
+        } else {
+            ret = metrics_printf(buf, "%s%s%s%s %" PRId64 "\n", metric->name, LABELS_ARGS(metric),
+                                 __atomic_load_n(&metric->value, __ATOMIC_RELAXED));
+        }
+        if (ret != 0) {
+            break;
+        }
+    }
+
+    map_itor_free(itor);
+    return ret;
+}
+
+char *metrics_export(void)
+{
+    Buffer *buf = NULL;
+    char *out = NULL;
+    metrics_collector_t collectors[METRICS_MAX_COLLECTORS] = { 0 };
+    size_t collectors_len = 0;
+    size_t i = 0;
+    int ret = 0;
+
+    buf = buffer_alloc(METRICS_REQUEST_MAX);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    if (pthread_mutex_lock(&g_metrics.mutex) != 0) {
+        ERROR("Failed to lock metrics");
+        goto out;
+    }
+    ret = export_metrics(buf);
+    collectors_len = g_metrics.collectors_len;
+    (void)memcpy(collectors, g_metrics.collectors, sizeof(collectors));
+    (void)pthread_mutex_unlock(&g_metrics.mutex);
+    if (ret != 0) {
+        goto out;
+    }
+
+    // collectors take locks of their own modules, call them without the metrics lock
+    for (i = 0; i < collectors_len; i++) {
+        char *text = collectors[i]();
+        if (text == NULL) {
+            continue;
+        }
+        ret = buffer_append(buf, text, strlen(text));
+        free(text);
+        if (ret != 0) {
+            goto out;
+        }
+    }
+
+    out = util_strdup_s(buf->contents);
+
+out:
+    buffer_free(buf);
+    return out;
+}
+
+static bool read_request(int fd, char *request, size_t size)
+{
+    size_t len = 0;
+
+    while (len < size - 1) {
+        ssize_t nret = read(fd, request + len, size - 1 - len);
+        if (nret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nret <= 0) {
+            return false;
+        }
+        len += (size_t)nret;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") != NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void serve_one(int fd)
+{
+    char request[METRICS_REQUEST_MAX] = { 0 };
+    char header[METRICS_LINE_MAX] = { 0 };
+    struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+    char *body = NULL;
+    const char *status = "404 Not Found";
+    int nret = 0;
+
+    // a client that does not finish its request must not hold the server
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0 ||
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) != 0) {
+        SYSERROR("Failed to set timeout of metrics connection");
+        return;
+    }
+
+    if (!read_request(fd, request, sizeof(request))) {
+        return;
+    }
+
+    if (strncmp(request, "GET /metrics ", strlen("GET /metrics ")) == 0) {
+        body = metrics_export();
+        status = body != NULL ? "200 OK" : "500 Internal Server Error";
+    }
+
+    nret = snprintf(header, sizeof(header),
+                    "HTTP/1.0 %s\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n"
+                    "Connection: close\r\n\r\n",
+                    status, body != NULL ? strlen(body) : 0);
+    if (nret < 0 || (size_t)nret >= sizeof(header)) {
+        goto out;
+    }
+
+    if (util_write_nointr_in_total(fd, header, (size_t)nret) < 0 ||
+        (body != NULL && util_write_nointr_in_total(fd, body, strlen(body)) < 0)) {
+        WARN("Failed to write metrics response: %s", strerror(errno));
+    }
+
+out:
+    free(body);
+}
+
+static void *metrics_serve(void *arg)
+{
+    int listen_fd = (int)(long)arg;
+
+    if (pthread_detach(pthread_self()) != 0) {
+        ERROR("Failed to detach metrics thread");
+    }
+    prctl(PR_SET_NAME, "Metrics");
+
+    for (;;) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno == EMFILE || errno == ENFILE) {
+                // the connection stays pending, accept would fail at once again until fds are freed
+                WARN("Failed to accept metrics connection: %s, retry later", strerror(errno));
+                util_usleep_nointerupt(METRICS_ACCEPT_BACKOFF_US);
+                continue;
+            }
+            SYSERROR("Failed to accept metrics connection");
+            break;
+        }
+        serve_one(fd);
+        close(fd);
+    }
+
+    return NULL;
+}
+
+int metrics_server_start(const char *socket_path)
+{
+    struct sockaddr_un addr = { 0 };
+    pthread_t thread;
+    mode_t mask;
+    int fd = -1;
+    int nret = 0;
+
+    if (socket_path == NULL || strlen(socket_path) >= sizeof(addr.sun_path)) {
+        ERROR("Invalid metrics socket path");
+        return -1;
+    }
+
+    if (g_metrics.listen_fd >= 0) {
+        return 0;
+    }
+
+    fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        SYSERROR("Failed to create metrics socket");
+        return -1;
+    }
+
+    addr.sun_family = AF_UNIX;
+    (void)strcpy(addr.sun_path, socket_path);
+    if (unlink(socket_path) != 0 && errno != ENOENT) {
+        SYSERROR("Failed to remove old metrics socket %s", socket_path);
+        goto err_out;
+    }
+    // created 0600, a chmod after bind would leave it open to others until then
+    mask = umask(S_IXUSR | S_IRWXG | S_IRWXO);
+    nret = bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+    umask(mask);
+    if (nret != 0) {
+        SYSERROR("Failed to bind metrics socket %s", socket_path);
+        goto err_out;
+    }
+    if (listen(fd, METRICS_LISTEN_BACKLOG) != 0) {
+        SYSERROR("Failed to listen metrics socket %s", socket_path);
+        goto err_out;
+    }
+
+    if (pthread_create(&thread, NULL, metrics_serve, (void *)(long)fd) != 0) {
+        ERROR("Failed to create metrics thread");
+        goto err_out;
+    }
+
+    g_metrics.listen_fd = fd;
+    metrics_enable();
+    INFO("Serving metrics on %s", socket_path);
+    return 0;
+
+err_out:
+    close(fd);
+    return -1;
+}
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide internal metrics of isulad in prometheus text format
+ ******************************************************************************/
+#ifndef DAEMON_COMMON_METRICS_H
+#define DAEMON_COMMON_METRICS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_SOCKET_NAME "metrics.sock"
+
+/*
+ * Metrics are registered once by name and labels, the returned handle lives until exit
+ * and is updated with atomics only, so callers keep it in a static and use it on hot paths.
+ * Nothing is recorded until metrics_enable(), a disabled metric costs one atomic load.
+ */
+typedef struct metrics_metric metrics_histogram_t;
+typedef struct metrics_metric metrics_counter_t;
+typedef struct metrics_metric metrics_gauge_t;
+
+// text of metrics kept elsewhere, in prometheus text format, freed by the caller
+typedef char *(*metrics_collector_t)(void);
+
+// labels like `method="Create",service="containers.ContainerService"`, NULL for none
+metrics_histogram_t *metrics_histogram(const char *name, const char *labels);
+metrics_counter_t *metrics_counter(const char *name, const char *labels);
+metrics_gauge_t *metrics_gauge(const char *name, const char *labels);
+
+bool metrics_enabled(void);
+
+void metrics_enable(void);
+
+// monotonic nanoseconds to start a duration, 0 if metrics are disabled
+uint64_t metrics_now(void);
+
+// observe the seconds from start, a start of 0 is ignored
+void metrics_observe_since(metrics_histogram_t *histogram, uint64_t start);
+
+void metrics_observe_nanos(metrics_histogram_t *histogram, uint64_t nanos);
+
+void metrics_counter_add(metrics_counter_t *counter, uint64_t value);
+
+// gauges are kept even if metrics are disabled, so that they never go below zero after enable
+void metrics_gauge_add(metrics_gauge_t *gauge, int64_t value);
+
+int metrics_register_collector(metrics_collector_t collector);
+
+char *metrics_export(void);
+
+// serve metrics_export() over http on a unix socket, and enable metrics
+int metrics_server_start(const char *socket_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_COMMON_METRICS_H
@@ -29,6 +29,7 @@
 #include "utils.h"
 #include "utils_array.h"
 #include "utils_file.h"
+#include "utils_mount_table.h"
 #include "utils_string.h"
 
 // Cgroup V1 Item Definition
@@ -69,7 +70,6 @@
 #define CGROUP2_PIDS_MAX "pids.max"
 #define CGROUP2_FILES_LIMIT "files.limit"
 
-#define CGROUP_MOUNTPOINT "/sys/fs/cgroup"
 #define CGROUP_ISULAD_PATH CGROUP_MOUNTPOINT"/isulad"
 #define DEFAULT_CGROUP_DIR_MODE 0755
 #define DEFAULT_CGROUP_FILE_MODE 0644
@@ -86,9 +86,6 @@
 #define CGROUP_SUPER_MAGIC 0x27e0eb
 #endif
 
-#define CGROUP_VERSION_1 1
-#define CGROUP_VERSION_2 2
-
 static sysinfo_t *g_sysinfo = NULL;
 
 struct layer {
@@ -1008,7 +1005,7 @@ free_out:
     free(defaultpagesize);
 }
 
-static int get_cgroup_version()
+int get_cgroup_version(void)
 {
     struct statfs fs = {0};
 
@@ -1554,43 +1551,60 @@ mountinfo_t *find_mount_info(mountinfo_t **minfos, const char *dir)
     return NULL;
 }
 
+static mountinfo_t *dup_mount_info(const util_mount_entry_t *entry)
+{
+    mountinfo_t *info = NULL;
+
+    info = util_common_calloc_s(sizeof(mountinfo_t));
+    if (info == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    info->root = util_strdup_s(entry->root);
+    info->mountpoint = util_strdup_s(entry->mountpoint);
+    info->opts = util_strdup_s(entry->opts);
+    info->optional = entry->optional != NULL ? util_strdup_s(entry->optional) : NULL;
+    info->fstype = util_strdup_s(entry->fstype);
+    info->source = util_strdup_s(entry->source);
+    info->vfsopts = util_strdup_s(entry->vfsopts);
+
+    return info;
+}
+
 /* getmountsinfo */
 mountinfo_t **getmountsinfo(void)
 {
     mountinfo_t **minfos = NULL;
+    util_mount_table_t *table = NULL;
+    size_t len = 0;
+    size_t i;
     int ret = 0;
-    FILE *fp = NULL;
-    size_t length;
-    char *pline = NULL;
 
-    fp = util_fopen("/proc/self/mountinfo", "r");
-    if (fp == NULL) {
-        ERROR("Failed to open \"/proc/self/mountinfo\"\n");
+    table = util_mount_table_get();
+    if (table == NULL) {
+        ERROR("Failed to get mount table");
         return NULL;
     }
 
-    while (getline(&pline, &length, fp) != -1) {
-        int index;
-        mountinfo_t *info;
-
-        info = get_mount_info(pline);
-        if (info == NULL) {
-            ret = -1;
-            goto free_out;
-        }
+    len = util_mount_table_len(table);
+    minfos = util_smart_calloc_s(sizeof(mountinfo_t *), len + 1);
+    if (minfos == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto free_out;
+    }
 
-        index = add_null_to_list((void ***)&minfos);
-        if (index < 0) {
-            free_mount_info(info);
+    for (i = 0; i < len; i++) {
+        minfos[i] = dup_mount_info(util_mount_table_at(table, i));
+        if (minfos[i] == NULL) {
             ret = -1;
             goto free_out;
         }
-        minfos[index] = info;
     }
-free_out:
 
-    fclose(fp);
-    free(pline);
+free_out:
+    util_mount_table_put(table);
     if (ret != 0) {
         free_mounts_info(minfos);
         minfos = NULL;
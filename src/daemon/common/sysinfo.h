@@ -22,6 +22,11 @@
 #define etcOsRelease "/etc/os-release"
 #define altOsRelease "/usr/lib/os-release"
 
+#define CGROUP_MOUNTPOINT "/sys/fs/cgroup"
+
+#define CGROUP_VERSION_1 1
+#define CGROUP_VERSION_2 2
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -125,6 +130,9 @@ char *validate_hugetlb(const char *pagesize, uint64_t limit);
 
 int find_cgroup_mountpoint_and_root(const char *subsystem, char **mountpoint, char **root);
 
+// CGROUP_VERSION_1 or CGROUP_VERSION_2 of CGROUP_MOUNTPOINT, -1 on error
+int get_cgroup_version(void);
+
 sysinfo_t *get_sys_info(bool quiet);
 
 char *get_default_huge_page_size(void);
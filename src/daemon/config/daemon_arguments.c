@@ -200,6 +200,17 @@ void service_arguments_free(struct service_arguments *args)
     free_default_ulimit(args->default_ulimit);
     args->default_ulimit = NULL;
     args->default_ulimit_len = 0;
+
+    free_grpc_request_classes(args->grpc_request_classes, args->grpc_request_classes_len);
+    args->grpc_request_classes = NULL;
+    args->grpc_request_classes_len = 0;
+
+    free_plugin_event_timeouts(args->plugin_event_timeouts, args->plugin_event_timeouts_len);
+    args->plugin_event_timeouts = NULL;
+    args->plugin_event_timeouts_len = 0;
+
+    free(args->image_db_synchronous);
+    args->image_db_synchronous = NULL;
 }
 
 /* server log opt parser */
@@ -319,3 +330,23 @@ void free_default_ulimit(host_config_ulimits_element **default_ulimit)
     }
     free(default_ulimit);
 }
+
+void free_grpc_request_classes(struct grpc_request_class_limit *classes, size_t len)
+{
+    size_t i;
+
+    for (i = 0; classes != NULL && i < len; i++) {
+        free(classes[i].name);
+    }
+    free(classes);
+}
+
+void free_plugin_event_timeouts(struct plugin_event_timeout *timeouts, size_t len)
+{
+    size_t i;
+
+    for (i = 0; timeouts != NULL && i < len; i++) {
+        free(timeouts[i].name);
+    }
+    free(timeouts);
+}
@@ -30,6 +30,19 @@ extern "C" {
 
 typedef void (*service_arguments_help_t)(void);
 
+// limits of a grpc request class, an entry of "grpc-request-classes" in daemon.json
+struct grpc_request_class_limit {
+    char *name;
+    size_t max_inflight;
+    size_t max_queued;
+};
+
+// deadline of event requests to a plugin, an entry of "plugin-event-timeouts" in daemon.json
+struct plugin_event_timeout {
+    char *name;
+    long timeout_ms;
+};
+
 struct service_arguments {
     service_arguments_help_t print_help;
 
@@ -63,6 +76,15 @@ struct service_arguments {
     // store all daemon.json configs
     isulad_daemon_configs *json_confs;
 
+    struct { /* daemon.json sections not known by isulad_daemon_configs */
+        struct grpc_request_class_limit *grpc_request_classes;
+        size_t grpc_request_classes_len;
+        struct plugin_event_timeout *plugin_event_timeouts;
+        size_t plugin_event_timeouts_len;
+        // synchronous level of the embedded image database, "image-db-synchronous" in daemon.json
+        char *image_db_synchronous;
+    };
+
     // remaining arguments
     char * const *argv;
     int argc;
@@ -79,6 +101,10 @@ int ulimit_array_append(host_config_ulimits_element ***default_ulimit, const hos
 
 void free_default_ulimit(host_config_ulimits_element **default_ulimit);
 
+void free_grpc_request_classes(struct grpc_request_class_limit *classes, size_t len);
+
+void free_plugin_event_timeouts(struct plugin_event_timeout *timeouts, size_t len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <pthread.h>
 #include <limits.h>
 #include <fcntl.h>
@@ -29,6 +30,7 @@
 #include <isula_libutils/json_common.h>
 #include <isula_libutils/oci_runtime_spec.h>
 #include <isula_libutils/log.h>
+#include <yajl/yajl_tree.h>
 
 #include "constants.h"
 #include "utils.h"
@@ -1498,6 +1500,298 @@ static int merge_default_ulimits_conf_into_global(struct service_arguments *args
     return 0;
 }
 
+/*
+ * Sections of daemon.json which are not known by isulad_daemon_configs, whose schema is generated
+ * in isula_libutils. They are parsed once with the rest of the file and kept in the server conf.
+ * Return 0 with the parsed file, 1 if there is no file, -1 if it is invalid.
+ */
+static int parse_daemon_json_tree(yajl_val *tree)
+{
+    char *data = NULL;
+    char errbuf[BUFSIZ] = { 0 };
+
+    data = util_read_text_file(ISULAD_DAEMON_JSON_CONF_FILE);
+    if (data == NULL) {
+        return 1;
+    }
+
+    *tree = yajl_tree_parse(data, errbuf, sizeof(errbuf));
+    free(data);
+    if (*tree == NULL) {
+        COMMAND_ERROR("Failed to parse %s: %s", ISULAD_DAEMON_JSON_CONF_FILE, errbuf);
+        return -1;
+    }
+    return 0;
+}
+
+static int get_request_class_count(yajl_val cls, const char *key, size_t *value)
+{
+    const char *path[] = { key, NULL };
+    yajl_val val = NULL;
+
+    val = yajl_tree_get(cls, path, yajl_t_any);
+    if (val == NULL) {
+        return 1;
+    }
+    if (!YAJL_IS_INTEGER(val) || YAJL_GET_INTEGER(val) < 0) {
+        return -1;
+    }
+    *value = (size_t)YAJL_GET_INTEGER(val);
+    return 0;
+}
+
+static int parse_grpc_request_class(const char *name, yajl_val cls, struct grpc_request_class_limit *limit)
+{
+    if (!YAJL_IS_OBJECT(cls)) {
+        COMMAND_ERROR("Invalid grpc request class %s, expect an object", name);
+        return -1;
+    }
+    if (get_request_class_count(cls, "max-inflight", &limit->max_inflight) != 0) {
+        COMMAND_ERROR("Invalid max-inflight of grpc request class %s", name);
+        return -1;
+    }
+    limit->max_queued = 0;
+    if (get_request_class_count(cls, "max-queued", &limit->max_queued) < 0) {
+        COMMAND_ERROR("Invalid max-queued of grpc request class %s", name);
+        return -1;
+    }
+    limit->name = util_strdup_s(name);
+    return 0;
+}
+
+/* "grpc-request-classes": { "<name>": { "max-inflight": n, "max-queued": n } } */
+static int merge_grpc_request_classes_into_global(struct service_arguments *args, yajl_val tree)
+{
+    const char *path[] = { "grpc-request-classes", NULL };
+    yajl_val classes = NULL;
+    struct grpc_request_class_limit *limits = NULL;
+    size_t len = 0;
+    size_t i;
+
+    classes = yajl_tree_get(tree, path, yajl_t_any);
+    if (classes == NULL) {
+        return 0;
+    }
+    if (!YAJL_IS_OBJECT(classes)) {
+        COMMAND_ERROR("Invalid grpc-request-classes, expect an object");
+        return -1;
+    }
+    len = YAJL_GET_OBJECT(classes)->len;
+    if (len == 0) {
+        return 0;
+    }
+
+    limits = util_smart_calloc_s(sizeof(struct grpc_request_class_limit), len);
+    if (limits == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        if (parse_grpc_request_class(YAJL_GET_OBJECT(classes)->keys[i], YAJL_GET_OBJECT(classes)->values[i],
+                                     &limits[i]) != 0) {
+            free_grpc_request_classes(limits, len);
+            return -1;
+        }
+    }
+
+    free_grpc_request_classes(args->grpc_request_classes, args->grpc_request_classes_len);
+    args->grpc_request_classes = limits;
+    args->grpc_request_classes_len = len;
+    return 0;
+}
+
+/* "plugin-event-timeouts": { "<name>": ms } */
+static int merge_plugin_event_timeouts_into_global(struct service_arguments *args, yajl_val tree)
+{
+    const char *path[] = { "plugin-event-timeouts", NULL };
+    yajl_val plugins = NULL;
+    struct plugin_event_timeout *timeouts = NULL;
+    size_t len = 0;
+    size_t i;
+
+    plugins = yajl_tree_get(tree, path, yajl_t_any);
+    if (plugins == NULL) {
+        return 0;
+    }
+    if (!YAJL_IS_OBJECT(plugins)) {
+        COMMAND_ERROR("Invalid plugin-event-timeouts, expect an object");
+        return -1;
+    }
+    len = YAJL_GET_OBJECT(plugins)->len;
+    if (len == 0) {
+        return 0;
+    }
+
+    timeouts = util_smart_calloc_s(sizeof(struct plugin_event_timeout), len);
+    if (timeouts == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    for (i = 0; i < len; i++) {
+        const char *name = YAJL_GET_OBJECT(plugins)->keys[i];
+        yajl_val val = YAJL_GET_OBJECT(plugins)->values[i];
+
+        if (!YAJL_IS_INTEGER(val) || YAJL_GET_INTEGER(val) <= 0) {
+            COMMAND_ERROR("Invalid event timeout of plugin %s, expect a positive number of milliseconds", name);
+            free_plugin_event_timeouts(timeouts, len);
+            return -1;
+        }
+        timeouts[i].name = util_strdup_s(name);
+        timeouts[i].timeout_ms = (long)YAJL_GET_INTEGER(val);
+    }
+
+    free_plugin_event_timeouts(args->plugin_event_timeouts, args->plugin_event_timeouts_len);
+    args->plugin_event_timeouts = timeouts;
+    args->plugin_event_timeouts_len = len;
+    return 0;
+}
+
+/* "image-db-synchronous": "OFF" | "NORMAL" | "FULL" | "EXTRA" */
+static int merge_image_db_synchronous_into_global(struct service_arguments *args, yajl_val tree)
+{
+    const char *path[] = { "image-db-synchronous", NULL };
+    const char *levels[] = { "OFF", "NORMAL", "FULL", "EXTRA" };
+    yajl_val val = NULL;
+    const char *level = NULL;
+    size_t i;
+
+    val = yajl_tree_get(tree, path, yajl_t_any);
+    if (val == NULL) {
+        return 0;
+    }
+    level = YAJL_GET_STRING(val);
+    if (level == NULL) {
+        COMMAND_ERROR("Invalid image-db-synchronous, expect a string");
+        return -1;
+    }
+
+    for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (strcasecmp(level, levels[i]) == 0) {
+            free(args->image_db_synchronous);
+            args->image_db_synchronous = util_strdup_s(levels[i]);
+            return 0;
+        }
+    }
+
+    COMMAND_ERROR("Invalid image-db-synchronous %s, expect one of OFF, NORMAL, FULL or EXTRA", level);
+    return -1;
+}
+
+static int merge_extra_sections_into_global(struct service_arguments *args)
+{
+    int ret = 0;
+    yajl_val tree = NULL;
+
+    ret = parse_daemon_json_tree(&tree);
+    if (ret != 0) {
+        return ret > 0 ? 0 : -1;
+    }
+
+    if (merge_grpc_request_classes_into_global(args, tree) != 0 ||
+        merge_plugin_event_timeouts_into_global(args, tree) != 0 ||
+        merge_image_db_synchronous_into_global(args, tree) != 0) {
+        ret = -1;
+    }
+
+    yajl_tree_free(tree);
+    return ret;
+}
+
+/*
+ * Limits of a grpc request class configured in daemon.json.
+ * Return 0 if the class is configured, 1 if not, -1 on error.
+ */
+int conf_get_grpc_request_class_limit(const char *name, size_t *max_inflight, size_t *max_queued)
+{
+    int ret = 1;
+    size_t i;
+    struct service_arguments *conf = NULL;
+
+    if (name == NULL || max_inflight == NULL || max_queued == NULL) {
+        return -1;
+    }
+
+    if (isulad_server_conf_rdlock() != 0) {
+        return -1;
+    }
+
+    conf = conf_get_server_conf();
+    if (conf == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < conf->grpc_request_classes_len; i++) {
+        if (strcmp(conf->grpc_request_classes[i].name, name) == 0) {
+            *max_inflight = conf->grpc_request_classes[i].max_inflight;
+            *max_queued = conf->grpc_request_classes[i].max_queued;
+            ret = 0;
+            break;
+        }
+    }
+
+out:
+    (void)isulad_server_conf_unlock();
+    return ret;
+}
+
+/*
+ * Deadline of event requests to a plugin in milliseconds configured in daemon.json.
+ * Return 0 if it is configured, 1 if not, -1 on error.
+ */
+int conf_get_plugin_event_timeout(const char *name, long *timeout_ms)
+{
+    int ret = 1;
+    size_t i;
+    struct service_arguments *conf = NULL;
+
+    if (name == NULL || timeout_ms == NULL) {
+        return -1;
+    }
+
+    if (isulad_server_conf_rdlock() != 0) {
+        return -1;
+    }
+
+    conf = conf_get_server_conf();
+    if (conf == NULL) {
+        goto out;
+    }
+
+    for (i = 0; i < conf->plugin_event_timeouts_len; i++) {
+        if (strcmp(conf->plugin_event_timeouts[i].name, name) == 0) {
+            *timeout_ms = conf->plugin_event_timeouts[i].timeout_ms;
+            ret = 0;
+            break;
+        }
+    }
+
+out:
+    (void)isulad_server_conf_unlock();
+    return ret;
+}
+
+/* Synchronous level of the embedded image database configured in daemon.json, NULL if not configured. */
+char *conf_get_image_db_synchronous(void)
+{
+    char *level = NULL;
+    struct service_arguments *conf = NULL;
+
+    if (isulad_server_conf_rdlock() != 0) {
+        return NULL;
+    }
+
+    conf = conf_get_server_conf();
+    if (conf == NULL || conf->image_db_synchronous == NULL) {
+        goto out;
+    }
+
+    level = util_strdup_s(conf->image_db_synchronous);
+
+out:
+    (void)isulad_server_conf_unlock();
+    return level;
+}
+
 int merge_json_confs_into_global(struct service_arguments *args)
 {
     isulad_daemon_configs *tmp_json_confs;
@@ -1590,6 +1884,11 @@ int merge_json_confs_into_global(struct service_arguments *args)
         goto out;
     }
 
+    if (merge_extra_sections_into_global(args)) {
+        ret = -1;
+        goto out;
+    }
+
 #ifdef ENABLE_SELINUX
     args->json_confs->selinux_enabled = tmp_json_confs->selinux_enabled;
 #endif
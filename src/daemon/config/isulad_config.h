@@ -94,6 +94,12 @@ bool conf_get_image_layer_check_flag();
 
 int merge_json_confs_into_global(struct service_arguments *args);
 
+int conf_get_grpc_request_class_limit(const char *name, size_t *max_inflight, size_t *max_queued);
+
+int conf_get_plugin_event_timeout(const char *name, long *timeout_ms);
+
+char *conf_get_image_db_synchronous(void);
+
 bool conf_get_use_decrypted_key_flag();
 bool conf_get_skip_insecure_verify_flag();
 int parse_log_opts(struct service_arguments *args, const char *key, const char *value);
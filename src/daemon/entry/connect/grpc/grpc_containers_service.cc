@@ -21,9 +21,12 @@
 #include "isula_libutils/log.h"
 #include "utils.h"
 #include "error.h"
+#include "err_msg.h"
 #include "cxxutils.h"
 #include "stoppable_thread.h"
 #include "grpc_server_tls_auth.h"
+#include "grpc_request_class.h"
+#include "grpc_stream_writer.h"
 #include "container_api.h"
 #include "isula_libutils/logger_json_file.h"
 
@@ -108,6 +111,48 @@ bool grpc_event_write_function(void *writer, void *data)
     return gwriter->Write(gevent);
 }
 
+static void stats_frame_to_grpc(const struct isulad_stats_frame *frame, StatsStreamResponse *gframe)
+{
+    for (size_t i = 0; i < frame->containers_len; i++) {
+        const container_info *info = frame->containers[i];
+        containers::Container_info *stats = gframe->add_containers();
+        if (info->id != nullptr) {
+            stats->set_id(info->id);
+        }
+        stats->set_pids_current(info->pids_current);
+        stats->set_cpu_use_nanos(info->cpu_use_nanos);
+        stats->set_cpu_system_use(info->cpu_system_use);
+        stats->set_online_cpus(info->online_cpus);
+        stats->set_blkio_read(info->blkio_read);
+        stats->set_blkio_write(info->blkio_write);
+        stats->set_mem_used(info->mem_used);
+        stats->set_mem_limit(info->mem_limit);
+        stats->set_kmem_used(info->kmem_used);
+        stats->set_kmem_limit(info->kmem_limit);
+        if (info->name != nullptr) {
+            stats->set_name(info->name);
+        }
+        if (info->status != nullptr) {
+            stats->set_status(info->status);
+        }
+        stats->set_cache(info->cache);
+        stats->set_cache_total(info->cache_total);
+        stats->set_inactive_file_total(info->inactive_file_total);
+    }
+    for (size_t i = 0; i < frame->removed_len; i++) {
+        gframe->add_removed(frame->removed[i]);
+    }
+}
+
+bool grpc_stats_stream_write_function(void *writer, void *data)
+{
+    struct isulad_stats_frame *frame = (struct isulad_stats_frame *)data;
+    ServerWriter<StatsStreamResponse> *gwriter = (ServerWriter<StatsStreamResponse> *)writer;
+    StatsStreamResponse gframe;
+    stats_frame_to_grpc(frame, &gframe);
+    return gwriter->Write(gframe);
+}
+
 bool grpc_copy_from_container_write_function(void *writer, void *data)
 {
     struct isulad_copy_from_container_response *copy = (struct isulad_copy_from_container_response *)data;
@@ -158,6 +203,7 @@ Status ContainerServiceImpl::Version(ServerContext *context, const VersionReques
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.version == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -190,6 +236,7 @@ Status ContainerServiceImpl::Info(ServerContext *context, const InfoRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.info == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -222,6 +269,7 @@ Status ContainerServiceImpl::Create(ServerContext *context, const CreateRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     // 获取服务执行器
     cb = get_service_executor();
     if (cb == nullptr || cb->container.create == nullptr) {
@@ -255,6 +303,7 @@ Status ContainerServiceImpl::Start(ServerContext *context, const StartRequest *r
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.start == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -329,6 +378,8 @@ Status ContainerServiceImpl::RemoteStart(ServerContext *context,
     container_start_response *container_res = nullptr;
     sem_t sem;
 
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
+
     cb = get_service_executor();
     if (cb == nullptr || cb->container.start == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -408,6 +459,7 @@ Status ContainerServiceImpl::Top(ServerContext *context, const TopRequest *reque
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.top == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -440,6 +492,7 @@ Status ContainerServiceImpl::Stop(ServerContext *context, const StopRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.stop == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -472,6 +525,7 @@ Status ContainerServiceImpl::Restart(ServerContext *context, const RestartReques
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.restart == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -504,6 +558,7 @@ Status ContainerServiceImpl::Kill(ServerContext *context, const KillRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.kill == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -536,6 +591,7 @@ Status ContainerServiceImpl::Delete(ServerContext *context, const DeleteRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.remove == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -568,6 +624,7 @@ Status ContainerServiceImpl::Exec(ServerContext *context, const ExecRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.exec == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -589,19 +646,15 @@ Status ContainerServiceImpl::Exec(ServerContext *context, const ExecRequest *req
     return Status::OK;
 }
 
+using RemoteExecCoalescer = GrpcStreamCoalescer<RemoteExecResponse, RemoteExecRequest>;
+
 ssize_t WriteExecStdoutResponseToRemoteClient(void *context, const void *data, size_t len)
 {
     if (context == nullptr || data == nullptr || len == 0) {
         return 0;
     }
-    auto stream = static_cast<ServerReaderWriter<RemoteExecResponse, RemoteExecRequest> *>(context);
-    RemoteExecResponse response;
-    response.set_stdout((char *)data, len);
-    if (!stream->Write(response)) {
-        ERROR("Failed to write request to grpc client");
-        return -1;
-    }
-    return static_cast<ssize_t>(len);
+    auto writer = static_cast<RemoteExecCoalescer *>(context);
+    return writer->Write(true, data, len);
 }
 
 ssize_t WriteExecStderrResponseToRemoteClient(void *context, const void *data, size_t len)
@@ -609,14 +662,8 @@ ssize_t WriteExecStderrResponseToRemoteClient(void *context, const void *data, s
     if (context == nullptr || data == nullptr || len == 0) {
         return 0;
     }
-    auto stream = static_cast<ServerReaderWriter<RemoteExecResponse, RemoteExecRequest> *>(context);
-    RemoteExecResponse response;
-    response.set_stderr((char *)data, len);
-    if (!stream->Write(response)) {
-        ERROR("Failed to write request to grpc client");
-        return -1;
-    }
-    return static_cast<ssize_t>(len);
+    auto writer = static_cast<RemoteExecCoalescer *>(context);
+    return writer->Write(false, data, len);
 }
 
 class RemoteExecReceiveFromClientTask : public StoppableThread {
@@ -671,6 +718,7 @@ Status ContainerServiceImpl::RemoteExec(ServerContext *context,
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.exec == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -698,25 +746,22 @@ Status ContainerServiceImpl::RemoteExec(ServerContext *context,
         });
     }
 
+    RemoteExecCoalescer coalescer(stream);
     struct io_write_wrapper StdoutstringWriter = { 0 };
-    StdoutstringWriter.context = (void *)stream;
+    StdoutstringWriter.context = (void *)&coalescer;
     StdoutstringWriter.write_func = WriteExecStdoutResponseToRemoteClient;
     StdoutstringWriter.close_func = nullptr;
     struct io_write_wrapper StderrstringWriter = { 0 };
-    StderrstringWriter.context = (void *)stream;
+    StderrstringWriter.context = (void *)&coalescer;
     StderrstringWriter.write_func = WriteExecStderrResponseToRemoteClient;
     StderrstringWriter.close_func = nullptr;
     (void)cb->container.exec(container_req, &container_res, read_pipe_fd[0], &StdoutstringWriter, &StderrstringWriter);
 
-    RemoteExecResponse finish_response;
-    finish_response.set_finish(true);
-
     if (container_req->attach_stdin) {
         receive_task.stop();
     }
 
-    if (!stream->Write(finish_response)) {
-        ERROR("Failed to write finish request to grpc client");
+    if (!coalescer.Finish()) {
         return Status(StatusCode::INTERNAL, "Internal errors");
     }
 
@@ -745,6 +790,7 @@ Status ContainerServiceImpl::Inspect(ServerContext *context, const InspectContai
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
 
     cb = get_service_executor();
     if (cb == nullptr || cb->container.inspect == nullptr) {
@@ -778,6 +824,7 @@ Status ContainerServiceImpl::List(ServerContext *context, const ListRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.list == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -799,8 +846,10 @@ Status ContainerServiceImpl::List(ServerContext *context, const ListRequest *req
     return Status::OK;
 }
 
+using AttachCoalescer = GrpcStreamCoalescer<AttachResponse, AttachRequest>;
+
 struct AttachContext {
-    ServerReaderWriter<AttachResponse, AttachRequest> *stream;
+    AttachCoalescer *writer;
     bool isStdout;
     sem_t *sem;
 };
@@ -811,18 +860,8 @@ ssize_t WriteAttachResponseToRemoteClient(void *context, const void *data, size_
         return 0;
     }
     struct AttachContext *ctx = (struct AttachContext *)context;
-    AttachResponse response;
-    if (ctx->isStdout) {
-        response.set_stdout((char *)data, len);
-    } else {
-        response.set_stderr((char *)data, len);
-    }
-
-    if (!ctx->stream->Write(response)) {
-        ERROR("Failed to write request to grpc client");
-        return 0;
-    }
-    return static_cast<ssize_t>(len);
+    ssize_t ret = ctx->writer->Write(ctx->isStdout, data, len);
+    return ret < 0 ? 0 : ret;
 }
 
 int grpc_attach_stream_close(void *context, char **err)
@@ -830,10 +869,7 @@ int grpc_attach_stream_close(void *context, char **err)
     int ret = 0;
     (void)err;
     struct AttachContext *ctx = (struct AttachContext *)context;
-    AttachResponse finish_response;
-    finish_response.set_finish(true);
-    if (!ctx->stream->Write(finish_response)) {
-        ERROR("Failed to write finish request to grpc client");
+    if (!ctx->writer->Finish()) {
         ret = -1;
     }
     if (ctx->sem != nullptr) {
@@ -886,13 +922,16 @@ Status ContainerServiceImpl::Attach(ServerContext *context, ServerReaderWriter<A
     sem_t sem_stderr;
     int pipefd[2] = { -1, -1 };
 
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
+
     auto status = AttachInit(context, &cb, &container_req, &container_res, &sem_stderr, pipefd);
     if (!status.ok()) {
         return status;
     }
 
+    AttachCoalescer coalescer(stream);
     struct AttachContext stdoutCtx = { 0 };
-    stdoutCtx.stream = stream;
+    stdoutCtx.writer = &coalescer;
     stdoutCtx.isStdout = true;
     struct io_write_wrapper stdoutWriter = { 0 };
     stdoutWriter.context = (void *)(&stdoutCtx);
@@ -900,7 +939,7 @@ Status ContainerServiceImpl::Attach(ServerContext *context, ServerReaderWriter<A
     stdoutWriter.close_func = nullptr;
 
     struct AttachContext stderrCtx = { 0 };
-    stderrCtx.stream = stream;
+    stderrCtx.writer = &coalescer;
     stderrCtx.sem = &sem_stderr;
     struct io_write_wrapper stderrWriter = { 0 };
     stderrWriter.context = (void *)(&stderrCtx);
@@ -950,6 +989,7 @@ Status ContainerServiceImpl::Pause(ServerContext *context, const PauseRequest *r
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.pause == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -982,6 +1022,7 @@ Status ContainerServiceImpl::Resume(ServerContext *context, const ResumeRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.resume == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1014,6 +1055,7 @@ Status ContainerServiceImpl::Export(ServerContext *context, const ExportRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::HEAVY, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.export_rootfs == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1046,6 +1088,7 @@ Status ContainerServiceImpl::Rename(ServerContext *context, const RenameRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
 
     cb = get_service_executor();
     if (cb == nullptr || cb->container.rename == nullptr) {
@@ -1079,6 +1122,7 @@ Status ContainerServiceImpl::Resize(ServerContext *context, const ResizeRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
 
     cb = get_service_executor();
     if (cb == nullptr || cb->container.resize == nullptr) {
@@ -1112,6 +1156,7 @@ Status ContainerServiceImpl::Update(ServerContext *context, const UpdateRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.update == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1144,6 +1189,7 @@ Status ContainerServiceImpl::Stats(ServerContext *context, const StatsRequest *r
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.stats == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1165,6 +1211,49 @@ Status ContainerServiceImpl::Stats(ServerContext *context, const StatsRequest *r
     return Status::OK;
 }
 
+Status ContainerServiceImpl::StatsStream(ServerContext *context, const StatsRequest *request,
+                                         ServerWriter<StatsStreamResponse> *writer)
+{
+    int tret;
+    service_executor_t *cb = nullptr;
+    container_stats_request *container_req = nullptr;
+    stream_func_wrapper stream = { 0 };
+
+    auto status = GrpcServerTlsAuth::auth(context, "container_stats");
+    if (!status.ok()) {
+        return status;
+    }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
+    cb = get_service_executor();
+    if (cb == nullptr || cb->container.stats_stream == nullptr) {
+        return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
+    }
+
+    tret = stats_request_from_grpc(request, &container_req);
+    if (tret != 0) {
+        ERROR("Failed to transform grpc request");
+        return Status(StatusCode::INTERNAL, "Failed to transform grpc request");
+    }
+
+    stream.context = (void *)context;
+    stream.is_cancelled = &grpc_is_call_cancelled;
+    stream.write_func = &grpc_stats_stream_write_function;
+    stream.writer = (void *)writer;
+
+    tret = cb->container.stats_stream(container_req, &stream);
+    free_container_stats_request(container_req);
+    if (tret != 0) {
+        std::string errmsg = "Failed to execute stats stream callback";
+        if (g_isulad_errmsg != nullptr) {
+            errmsg = g_isulad_errmsg;
+        }
+        DAEMON_CLEAR_ERRMSG();
+        return Status(StatusCode::INTERNAL, errmsg);
+    }
+
+    return Status::OK;
+}
+
 Status ContainerServiceImpl::Wait(ServerContext *context, const WaitRequest *request, WaitResponse *reply)
 {
     int tret;
@@ -1176,6 +1265,7 @@ Status ContainerServiceImpl::Wait(ServerContext *context, const WaitRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.wait == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1208,6 +1298,7 @@ Status ContainerServiceImpl::Events(ServerContext *context, const EventsRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.events == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1244,6 +1335,7 @@ Status ContainerServiceImpl::CopyFromContainer(ServerContext *context, const Cop
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
     cb = get_service_executor();
     if (cb == nullptr || cb->container.copy_from_container == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -1393,6 +1485,7 @@ Status ContainerServiceImpl::Logs(ServerContext *context, const LogsRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::STREAMING, "containers.ContainerService", context);
 
     cb = get_service_executor();
     if (cb == nullptr || cb->container.logs == nullptr) {
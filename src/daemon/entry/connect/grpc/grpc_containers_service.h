@@ -84,6 +84,9 @@ public:
 
     Status Stats(ServerContext *context, const StatsRequest *request, StatsResponse *reply) override;
 
+    Status StatsStream(ServerContext *context, const StatsRequest *request,
+                       ServerWriter<StatsStreamResponse> *writer) override;
+
     Status Wait(ServerContext *context, const WaitRequest *request, WaitResponse *reply) override;
 
     Status Events(ServerContext *context, const EventsRequest *request, ServerWriter<Event> *writer) override;
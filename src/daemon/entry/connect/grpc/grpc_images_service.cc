@@ -24,6 +24,7 @@
 #include "isula_libutils/log.h"
 #include "utils.h"
 #include "grpc_server_tls_auth.h"
+#include "grpc_request_class.h"
 
 int ImagesServiceImpl::image_list_request_from_grpc(const ListImagesRequest *grequest,
                                                     image_list_images_request **request)
@@ -257,6 +258,7 @@ Status ImagesServiceImpl::List(ServerContext *context, const ListImagesRequest *
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.list == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -286,6 +288,7 @@ Status ImagesServiceImpl::Delete(ServerContext *context, const DeleteImageReques
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.remove == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -315,6 +318,7 @@ Status ImagesServiceImpl::Tag(ServerContext *context, const TagImageRequest *req
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.tag == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -361,6 +365,7 @@ Status ImagesServiceImpl::Import(ServerContext *context, const ImportRequest *re
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::HEAVY, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.import == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -390,6 +395,7 @@ Status ImagesServiceImpl::Load(ServerContext *context, const LoadImageRequest *r
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::HEAVY, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.load == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -425,6 +431,7 @@ Status ImagesServiceImpl::Inspect(ServerContext *context, const InspectImageRequ
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
 
     cb = get_service_executor();
     if (cb == nullptr || cb->image.inspect == nullptr) {
@@ -497,6 +504,7 @@ Status ImagesServiceImpl::Login(ServerContext *context, const LoginRequest *requ
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.login == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -526,6 +534,7 @@ Status ImagesServiceImpl::Logout(ServerContext *context, const LogoutRequest *re
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "images.ImagesService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->image.logout == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -0,0 +1,262 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide grpc request classes with admission limits
+ ******************************************************************************/
+#include "grpc_request_class.h"
+#include <algorithm>
+#include <sstream>
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "isulad_config.h"
+
+namespace {
+// spare threads for grpc internals, calls are rejected by the quota beyond that
+const int SPARE_THREADS = 8;
+// a waiting call checks whether it was cancelled this often
+const std::chrono::milliseconds ADMIT_POLL_INTERVAL { 100 };
+
+const char *ClassName(int cls)
+{
+    static const char *names[] = { "cri_status", "streaming", "heavy", "default" };
+    return names[cls];
+}
+
+// keys of the classes in "grpc-request-classes" of daemon.json
+const char *ClassConfigName(int cls)
+{
+    static const char *names[] = { "cri-status", "streaming", "heavy", "default" };
+    return names[cls];
+}
+
+char *RequestClassMetrics()
+{
+    return util_strdup_s(RequestClassScheduler::GetInstance()->DumpStats().c_str());
+}
+} // namespace
+
+// upper bounds of latency buckets in seconds, the last bucket is +Inf
+const double RequestClassScheduler::LatencyBounds[BucketsNum] = { 0.001, 0.005, 0.01, 0.05, 0.1,
+                                                                  0.5, 1, 5, 30, 300 };
+
+RequestClassScheduler *RequestClassScheduler::GetInstance() noexcept
+{
+    static RequestClassScheduler instance;
+    return &instance;
+}
+
+RequestClassScheduler::RequestClassScheduler()
+{
+    for (auto &state : m_states) {
+        state.inflight = 0;
+        state.queued = 0;
+        state.rejected = 0;
+        for (auto &bucket : state.latencyBuckets) {
+            bucket = 0;
+        }
+        state.latencyCount = 0;
+        state.latencySumSeconds = 0;
+    }
+    State(RequestClass::CRI_STATUS).maxInflight = 64;
+    State(RequestClass::CRI_STATUS).maxQueued = 64;
+    // events, logs -f, wait and attach last as long as the client wants, a waiting stream
+    // may wait long, so the cap is high and few wait, but it is finite: every class gets
+    // its own share of the server threads
+    State(RequestClass::STREAMING).maxInflight = 256;
+    State(RequestClass::STREAMING).maxQueued = 16;
+    State(RequestClass::HEAVY).maxInflight = 4;
+    State(RequestClass::HEAVY).maxQueued = 32;
+    State(RequestClass::DEFAULT).maxInflight = 64;
+    State(RequestClass::DEFAULT).maxQueued = 64;
+    (void)metrics_register_collector(RequestClassMetrics);
+}
+
+RequestClassScheduler::ClassState &RequestClassScheduler::State(RequestClass cls)
+{
+    return m_states[static_cast<int>(cls)];
+}
+
+void RequestClassScheduler::SetLimit(RequestClass cls, size_t maxInflight, size_t maxQueued)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (cls >= RequestClass::MAX) {
+        return;
+    }
+    State(cls).maxInflight = maxInflight;
+    State(cls).maxQueued = maxQueued;
+    State(cls).cond.notify_all();
+}
+
+void RequestClassScheduler::LoadLimits()
+{
+    for (int cls = 0; cls < static_cast<int>(RequestClass::MAX); cls++) {
+        size_t maxInflight { 0 };
+        size_t maxQueued { 0 };
+        int nret = conf_get_grpc_request_class_limit(ClassConfigName(cls), &maxInflight, &maxQueued);
+        if (nret < 0) {
+            WARN("Invalid limit of %s requests, keep the default one", ClassName(cls));
+            continue;
+        }
+        if (nret > 0) {
+            continue;
+        }
+        SetLimit(static_cast<RequestClass>(cls), maxInflight, maxQueued);
+        INFO("Limit %s requests to %zu in flight and %zu queued", ClassName(cls), maxInflight, maxQueued);
+    }
+}
+
+int RequestClassScheduler::RequiredThreads()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t total = SPARE_THREADS;
+    for (const auto &state : m_states) {
+        if (state.maxInflight == 0) {
+            return 0;
+        }
+        // waiting calls hold a server thread as well
+        total += state.maxInflight + state.maxQueued;
+    }
+    return static_cast<int>(total);
+}
+
+grpc::Status RequestClassScheduler::Admit(RequestClass cls, grpc::ServerContext *context)
+{
+    if (context == nullptr) {
+        return Admit(cls, std::chrono::system_clock::time_point::max(), [] { return false; });
+    }
+    return Admit(cls, context->deadline(), [context] { return context->IsCancelled(); });
+}
+
+grpc::Status RequestClassScheduler::Admit(RequestClass cls, std::chrono::system_clock::time_point deadline,
+                                          const std::function<bool()> &cancelled)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ClassState &state = State(cls);
+    grpc::Status status;
+
+    if (state.maxInflight != 0 && state.inflight >= state.maxInflight) {
+        if (state.queued >= state.maxQueued) {
+            state.rejected++;
+            return grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                std::string("Too many ") + ClassName(static_cast<int>(cls)) + " requests in flight");
+        }
+        state.queued++;
+        while (state.maxInflight != 0 && state.inflight >= state.maxInflight) {
+            if (cancelled()) {
+                status = grpc::Status(grpc::StatusCode::CANCELLED, "Request cancelled while waiting for a slot");
+                break;
+            }
+            auto left = deadline - std::chrono::system_clock::now();
+            if (left <= std::chrono::system_clock::duration::zero()) {
+                status = grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED,
+                                      "Deadline exceeded while waiting for a slot");
+                break;
+            }
+            // wake up now and then to notice cancelled calls, grpc does not signal them here
+            (void)state.cond.wait_for(lock, std::min<std::chrono::system_clock::duration>(left, ADMIT_POLL_INTERVAL));
+        }
+        state.queued--;
+        if (!status.ok()) {
+            state.rejected++;
+            return status;
+        }
+    }
+    state.inflight++;
+    return status;
+}
+
+void RequestClassScheduler::Release(RequestClass cls, std::chrono::steady_clock::time_point start)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ClassState &state = State(cls);
+    size_t i { 0 };
+
+    for (; i < BucketsNum; i++) {
+        if (seconds <= LatencyBounds[i]) {
+            break;
+        }
+    }
+    state.latencyBuckets[i]++;
+    state.latencyCount++;
+    state.latencySumSeconds += seconds;
+
+    state.inflight--;
+    state.cond.notify_one();
+}
+
+std::string RequestClassScheduler::DumpStats()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::ostringstream out;
+
+    for (int cls = 0; cls < static_cast<int>(RequestClass::MAX); cls++) {
+        const ClassState &state = m_states[cls];
+        std::string label = std::string("{class=\"") + ClassName(cls) + "\"";
+        out << "isulad_grpc_class_queue_depth" << label << "} " << state.queued << "\n";
+        out << "isulad_grpc_class_inflight" << label << "} " << state.inflight << "\n";
+        out << "isulad_grpc_class_rejected_total" << label << "} " << state.rejected << "\n";
+        uint64_t cumulative { 0 };
+        for (size_t i = 0; i <= BucketsNum; i++) {
+            cumulative += state.latencyBuckets[i];
+            out << "isulad_grpc_class_latency_seconds_bucket" << label << ",le=\"";
+            if (i < BucketsNum) {
+                out << LatencyBounds[i];
+            } else {
+                out << "+Inf";
+            }
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "isulad_grpc_class_latency_seconds_sum" << label << "} " << state.latencySumSeconds << "\n";
+        out << "isulad_grpc_class_latency_seconds_count" << label << "} " << state.latencyCount << "\n";
+    }
+    return out.str();
+}
+
+metrics_histogram_t *RequestClassGuard::MethodLatency(const char *service, const char *method)
+{
+    std::string labels = std::string("method=\"") + method + "\",service=\"" + service + "\"";
+    return metrics_histogram("isulad_grpc_request_duration_seconds", labels.c_str());
+}
+
+RequestClassGuard::RequestClassGuard(RequestClass cls, metrics_histogram_t *latency, grpc::ServerContext *context)
+    : m_class(cls)
+    , m_start(std::chrono::steady_clock::now())
+    , m_latency(latency)
+{
+    m_status = RequestClassScheduler::GetInstance()->Admit(cls, context);
+    if (!m_status.ok()) {
+        WARN("Reject %s request: %s", ClassName(static_cast<int>(cls)), m_status.error_message().c_str());
+        return;
+    }
+
+    // the time waited for a slot is not counted, it is in the latency of the class
+    m_metricsStart = metrics_now();
+}
+
+RequestClassGuard::~RequestClassGuard()
+{
+    if (m_status.ok()) {
+        metrics_observe_since(m_latency, m_metricsStart);
+        RequestClassScheduler::GetInstance()->Release(m_class, m_start);
+    }
+}
+
+bool RequestClassGuard::Admitted() const
+{
+    return m_status.ok();
+}
+
+grpc::Status RequestClassGuard::RejectStatus() const
+{
+    return m_status;
+}
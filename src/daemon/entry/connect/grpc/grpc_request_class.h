@@ -0,0 +1,111 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide grpc request classes with admission limits
+ ******************************************************************************/
+
+#ifndef DAEMON_ENTRY_CONNECT_GRPC_GRPC_REQUEST_CLASS_H
+#define DAEMON_ENTRY_CONNECT_GRPC_GRPC_REQUEST_CLASS_H
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <grpc++/grpc++.h>
+#include "metrics.h"
+
+// Requests of different classes never compete for the same slots: latency sensitive
+// CRI status/list calls keep being served while image pulls or log follows pile up.
+enum class RequestClass {
+    CRI_STATUS = 0, // kubelet probes: status, list, stats, ExecSync
+    STREAMING,      // long lived calls: attach, remote exec, logs, events, copy, wait
+    HEAVY,          // image pull, load, import and container export
+    DEFAULT,        // everything else
+    MAX
+};
+
+class RequestClassScheduler {
+public:
+    static RequestClassScheduler *GetInstance() noexcept;
+    // maxInflight calls of cls run concurrently, at most maxQueued more wait for a slot,
+    // a maxInflight of 0 does not limit the class
+    void SetLimit(RequestClass cls, size_t maxInflight, size_t maxQueued);
+    // apply the limits configured in "grpc-request-classes" of daemon.json
+    void LoadLimits();
+    // number of server threads needed so that every class can use all of its slots,
+    // 0 if a class is not limited
+    int RequiredThreads();
+    // wait for a slot until the deadline of the call, or until it is cancelled
+    grpc::Status Admit(RequestClass cls, grpc::ServerContext *context);
+    // same as above for a call with the given deadline, cancelled tells whether it was cancelled meanwhile
+    grpc::Status Admit(RequestClass cls, std::chrono::system_clock::time_point deadline,
+                       const std::function<bool()> &cancelled);
+    void Release(RequestClass cls, std::chrono::steady_clock::time_point start);
+    // queue depth, inflight, rejected counters and latency histograms in prometheus text format
+    std::string DumpStats();
+
+private:
+    static const size_t BucketsNum { 10 };
+    struct ClassState {
+        size_t maxInflight;
+        size_t maxQueued;
+        size_t inflight;
+        size_t queued;
+        uint64_t rejected;
+        uint64_t latencyBuckets[BucketsNum + 1];
+        uint64_t latencyCount;
+        double latencySumSeconds;
+        std::condition_variable cond;
+    };
+
+    RequestClassScheduler();
+    RequestClassScheduler(const RequestClassScheduler &) = delete;
+    RequestClassScheduler &operator=(const RequestClassScheduler &) = delete;
+    virtual ~RequestClassScheduler() = default;
+    ClassState &State(RequestClass cls);
+
+    std::mutex m_mutex;
+    ClassState m_states[static_cast<int>(RequestClass::MAX)];
+    static const double LatencyBounds[BucketsNum];
+};
+
+// RequestClassGuard holds a slot of its class from construction to destruction,
+// and records the latency of the method when metrics are enabled
+class RequestClassGuard {
+public:
+    RequestClassGuard(RequestClass cls, metrics_histogram_t *latency, grpc::ServerContext *context);
+    ~RequestClassGuard();
+    RequestClassGuard(const RequestClassGuard &) = delete;
+    RequestClassGuard &operator=(const RequestClassGuard &) = delete;
+    bool Admitted() const;
+    grpc::Status RejectStatus() const;
+    // latency histogram of a method, resolved once per call site by REQUEST_CLASS_GUARD
+    static metrics_histogram_t *MethodLatency(const char *service, const char *method);
+
+private:
+    RequestClass m_class;
+    grpc::Status m_status;
+    std::chrono::steady_clock::time_point m_start;
+    metrics_histogram_t *m_latency { nullptr };
+    uint64_t m_metricsStart { 0 };
+};
+
+// Take a slot of cls for the rest of the handler, return the status of the call if there is none
+#define REQUEST_CLASS_GUARD(cls, service, context)                                                         \
+    static metrics_histogram_t *requestClassLatency = RequestClassGuard::MethodLatency(service, __func__); \
+    RequestClassGuard classGuard(cls, requestClassLatency, context);                                       \
+    if (!classGuard.Admitted()) {                                                                          \
+        return classGuard.RejectStatus();                                                                  \
+    }
+
+#endif // DAEMON_ENTRY_CONNECT_GRPC_GRPC_REQUEST_CLASS_H
@@ -23,6 +23,129 @@ std::string auth_plugin = "";
 };
 
 namespace GrpcServerTlsAuth {
+AuthzCache *AuthzCache::GetInstance() noexcept
+{
+    // allowed decisions live 10s, denied ones 2s
+    static AuthzCache instance(1024, std::chrono::seconds(10), std::chrono::seconds(2));
+    return &instance;
+}
+
+AuthzCache::AuthzCache(size_t maxEntries, std::chrono::milliseconds allowedTTL, std::chrono::milliseconds deniedTTL)
+    : MaxEntries(maxEntries)
+    , AllowedTTL(allowedTTL)
+    , DeniedTTL(deniedTTL)
+{
+}
+
+void AuthzCache::GarbageCollection()
+{
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = m_ll.begin(); it != m_ll.end();) {
+        if (now < it->expireTime) {
+            ++it;
+            continue;
+        }
+        m_entries.erase(it->key);
+        it = m_ll.erase(it);
+    }
+}
+
+bool AuthzCache::Lookup(const std::string &user, const std::string &action, bool &allowed, std::string &errmsg)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_entries.find(std::make_pair(user, action));
+    if (it == m_entries.end()) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() >= it->second->expireTime ||
+        it->second->generation != authz_http_generation()) {
+        m_ll.erase(it->second);
+        m_entries.erase(it);
+        return false;
+    }
+    // move to front, so busy (user, action) pairs are the last to be evicted
+    m_ll.splice(m_ll.begin(), m_ll, it->second);
+    allowed = it->second->allowed;
+    errmsg = it->second->errmsg;
+    return true;
+}
+
+void AuthzCache::Insert(const std::string &user, const std::string &action, bool allowed, const std::string &errmsg,
+                        uint64_t generation)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto key = std::make_pair(user, action);
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_ll.erase(it->second);
+        m_entries.erase(it);
+    }
+    if (m_ll.size() >= MaxEntries) {
+        GarbageCollection();
+    }
+    while (m_ll.size() >= MaxEntries) {
+        m_entries.erase(m_ll.back().key);
+        m_ll.pop_back();
+    }
+
+    Entry entry { key, allowed, errmsg, std::chrono::steady_clock::now() + (allowed ? AllowedTTL : DeniedTTL),
+                  generation };
+    m_ll.push_front(entry);
+    m_entries[key] = m_ll.begin();
+}
+
+void AuthzCache::Invalidate(const std::string &user)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (user.empty()) {
+        m_entries.clear();
+        m_ll.clear();
+        return;
+    }
+    for (auto it = m_ll.begin(); it != m_ll.end();) {
+        if (it->key.first != user) {
+            ++it;
+            continue;
+        }
+        m_entries.erase(it->key);
+        it = m_ll.erase(it);
+    }
+}
+
+static Status authz_broker_auth(const std::string &username, const std::string &action)
+{
+    bool allowed { false };
+    std::string cached_err;
+    auto *cache = AuthzCache::GetInstance();
+
+    if (cache->Lookup(username, action, allowed, cached_err)) {
+        return allowed ? Status::OK : Status(StatusCode::PERMISSION_DENIED, cached_err);
+    }
+
+    // a decision asked across a restart of the plugin is of the old generation
+    uint64_t generation = authz_http_generation();
+    char *errmsg = nullptr;
+    int ret = authz_http_request(username.c_str(), action.c_str(), &errmsg);
+    std::string err = (errmsg != nullptr) ? errmsg : "";
+    free(errmsg);
+    if (ret == AUTHZ_RES_ALLOWED) {
+        cache->Insert(username, action, true, "", generation);
+        return Status::OK;
+    }
+    if (ret == AUTHZ_RES_DENIED) {
+        cache->Insert(username, action, false, err, generation);
+    } else {
+        // plugin unreachable, it may come back with a different policy, answers of requests
+        // asked before are not cached either
+        authz_http_invalidate();
+        cache->Invalidate();
+    }
+    return Status(StatusCode::PERMISSION_DENIED, err);
+}
+
 Status auth(ServerContext *context, std::string action)
 {
     const std::multimap<grpc::string_ref, grpc::string_ref> init_metadata = context->client_metadata();
@@ -42,20 +165,10 @@ Status auth(ServerContext *context, std::string action)
             return Status(StatusCode::UNKNOWN, "unknown error");
         }
         std::string username = std::string(username_kv->second.data(), username_kv->second.length());
-        char *errmsg = nullptr;
-        if (authz_http_request(username.c_str(), action.c_str(), &errmsg)) {
-            std::string err = errmsg;
-            free(errmsg);
-            return Status(StatusCode::PERMISSION_DENIED, err);
-        } else {
-            if (errmsg != nullptr) {
-                free(errmsg);
-            }
-        }
+        return authz_broker_auth(username, action);
     } else {
         return Status(StatusCode::UNIMPLEMENTED, "authorization plugin invalid");
     }
     return Status::OK;
 }
 } // namespace GrpcServerTlsAuth
-
@@ -16,6 +16,12 @@
 #ifndef DAEMON_ENTRY_CONNECT_GRPC_GRPC_SERVER_TLS_AUTH_H
 #define DAEMON_ENTRY_CONNECT_GRPC_GRPC_SERVER_TLS_AUTH_H
 #include <string>
+#include <list>
+#include <mutex>
+#include <chrono>
+#include <utility>
+#include <map>
+#include <cstdint>
 #include <grpc++/grpc++.h>
 
 using grpc::ServerContext;
@@ -27,8 +33,45 @@ extern std::string auth_plugin;
 };
 
 namespace GrpcServerTlsAuth {
+// AuthzCache remembers authz plugin decisions keyed by (user, action) for a short time,
+// denied decisions are cached for a shorter time than allowed ones. A decision is only valid
+// in the authz_http_generation() it was asked in, so all of them are dropped when the plugin
+// is restarted, see authz_http_invalidate().
+class AuthzCache {
+public:
+    static AuthzCache *GetInstance() noexcept;
+    AuthzCache(size_t maxEntries, std::chrono::milliseconds allowedTTL, std::chrono::milliseconds deniedTTL);
+    virtual ~AuthzCache() = default;
+    // return true and fill allowed/errmsg if a valid decision is cached
+    bool Lookup(const std::string &user, const std::string &action, bool &allowed, std::string &errmsg);
+    // generation is the one taken before the plugin was asked
+    void Insert(const std::string &user, const std::string &action, bool allowed, const std::string &errmsg,
+                uint64_t generation);
+    // drop all decisions of user, or all decisions if user is empty
+    void Invalidate(const std::string &user = "");
+
+private:
+    struct Entry {
+        std::pair<std::string, std::string> key;
+        bool allowed;
+        std::string errmsg;
+        std::chrono::steady_clock::time_point expireTime;
+        uint64_t generation;
+    };
+    AuthzCache(const AuthzCache &) = delete;
+    AuthzCache &operator=(const AuthzCache &) = delete;
+    void GarbageCollection();
+
+    std::mutex m_mutex;
+    // m_ll keeps entries in least recently used order, most recent at front
+    std::list<Entry> m_ll;
+    std::map<std::pair<std::string, std::string>, std::list<Entry>::iterator> m_entries;
+    const size_t MaxEntries;
+    const std::chrono::milliseconds AllowedTTL;
+    const std::chrono::milliseconds DeniedTTL;
+};
+
 Status auth(ServerContext *context, std::string action);
 };
 
 #endif // DAEMON_ENTRY_CONNECT_GRPC_GRPC_SERVER_TLS_AUTH_H
-
@@ -18,6 +18,7 @@
 #include <memory>
 #include <vector>
 #include <grpc++/grpc++.h>
+#include <grpc++/resource_quota.h>
 #include <sstream>
 #include <fstream>
 #include "grpc_containers_service.h"
@@ -29,6 +30,7 @@
 #include "network_plugin.h"
 #include "errors.h"
 #include "grpc_server_tls_auth.h"
+#include "grpc_request_class.h"
 
 using grpc::SslServerCredentialsOptions;
 
@@ -75,6 +77,17 @@ public:
         m_builder.RegisterService(&m_runtimeRuntimeService);
         m_builder.RegisterService(&m_runtimeImageService);
 
+        // Every request class waits for its own slots inside the handlers, give the sync
+        // server enough threads for all of them, so a class never runs out of threads
+        // because another class piled up. Without a limit on some class there is no bound.
+        RequestClassScheduler::GetInstance()->LoadLimits();
+        int threads = RequestClassScheduler::GetInstance()->RequiredThreads();
+        if (threads > 0) {
+            grpc::ResourceQuota quota("isulad_grpc_server");
+            quota.SetMaxThreads(threads);
+            m_builder.SetResourceQuota(quota);
+        }
+
         // Finally assemble the server.
         m_server = m_builder.BuildAndStart();
         if (m_server == nullptr) {
@@ -0,0 +1,287 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide coalescing writer for attach/exec output streams
+ ******************************************************************************/
+
+#ifndef DAEMON_ENTRY_CONNECT_GRPC_GRPC_STREAM_WRITER_H
+#define DAEMON_ENTRY_CONNECT_GRPC_GRPC_STREAM_WRITER_H
+#include <string>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <atomic>
+#include <map>
+#include <set>
+#include <utility>
+#include <sys/types.h>
+#include <grpc++/grpc++.h>
+#include <grpc++/support/sync_stream.h>
+#include <google/protobuf/arena.h>
+#include "isula_libutils/log.h"
+
+// Flush deadlines of all coalescers are kept by this one timer thread, so that a stream
+// needs no thread of its own. Deadlines are called on the timer thread, a target should
+// not wait there for a stream which is written by someone else.
+class GrpcFlushTimer {
+public:
+    class Target {
+    public:
+        virtual ~Target() = default;
+        virtual void OnDeadline() = 0;
+    };
+
+    static GrpcFlushTimer &Instance()
+    {
+        static GrpcFlushTimer timer;
+        return timer;
+    }
+
+    // an earlier deadline of target is kept
+    void Schedule(Target *target, std::chrono::steady_clock::time_point deadline)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_targets.find(target);
+        if (it != m_targets.end()) {
+            if (it->second <= deadline) {
+                return;
+            }
+            m_deadlines.erase(std::make_pair(it->second, target));
+            it->second = deadline;
+        } else {
+            m_targets.emplace(target, deadline);
+        }
+        m_deadlines.emplace(deadline, target);
+        if (m_deadlines.begin()->second == target) {
+            m_cond.notify_one();
+        }
+    }
+
+    // once it returns, target is neither scheduled nor called any more
+    void Cancel(Target *target)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this, target]() {
+            return m_running != target;
+        });
+        auto it = m_targets.find(target);
+        if (it != m_targets.end()) {
+            m_deadlines.erase(std::make_pair(it->second, target));
+            m_targets.erase(it);
+        }
+    }
+
+    GrpcFlushTimer(const GrpcFlushTimer &) = delete;
+    GrpcFlushTimer &operator=(const GrpcFlushTimer &) = delete;
+
+private:
+    GrpcFlushTimer()
+    {
+        m_thread = std::thread([this]() {
+            Loop();
+        });
+    }
+
+    ~GrpcFlushTimer()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cond.notify_one();
+        m_thread.join();
+    }
+
+    void Loop()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stop) {
+            if (m_deadlines.empty()) {
+                m_cond.wait(lock);
+                continue;
+            }
+            auto first = *m_deadlines.begin();
+            if (std::chrono::steady_clock::now() < first.first) {
+                m_cond.wait_until(lock, first.first);
+                continue;
+            }
+            m_deadlines.erase(m_deadlines.begin());
+            m_targets.erase(first.second);
+            m_running = first.second;
+            lock.unlock();
+            first.second->OnDeadline();
+            lock.lock();
+            m_running = nullptr;
+            m_done.notify_all();
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    // signals Cancel() that the deadline of a target was handled
+    std::condition_variable m_done;
+    std::map<Target *, std::chrono::steady_clock::time_point> m_targets;
+    std::set<std::pair<std::chrono::steady_clock::time_point, Target *>> m_deadlines;
+    Target *m_running { nullptr };
+    bool m_stop { false };
+    std::thread m_thread;
+};
+
+// Console output arrives in small pieces, so sending one message per piece turns a
+// chatty process into thousands of tiny grpc messages. Consecutive output of the same
+// channel is collected here and sent in one message once it reaches MaxPendingBytes or
+// has been pending for FlushWindow, whichever comes first. A write to the other channel
+// sends the current message first, so stdout and stderr keep their relative order.
+//
+// Full messages are sent by Write() itself, which runs on an io writer thread and may wait
+// for a slow client there. Only the deadline is left to the shared GrpcFlushTimer.
+template <class Response, class Request, class Stream = grpc::ServerReaderWriter<Response, Request>>
+class GrpcStreamCoalescer : public GrpcFlushTimer::Target {
+public:
+    static constexpr size_t MaxPendingBytes = 32 * 1024;
+    static constexpr std::chrono::milliseconds FlushWindow { 2 };
+
+    explicit GrpcStreamCoalescer(Stream *stream)
+        : m_stream(stream)
+    {
+        m_pending.reserve(MaxPendingBytes);
+    }
+
+    ~GrpcStreamCoalescer() override
+    {
+        Stop();
+    }
+
+    GrpcStreamCoalescer(const GrpcStreamCoalescer &) = delete;
+    GrpcStreamCoalescer &operator=(const GrpcStreamCoalescer &) = delete;
+
+    ssize_t Write(bool isStdout, const void *data, size_t len)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed || m_stopped) {
+            return -1;
+        }
+        if (!m_pending.empty() && m_pendingStdout != isStdout && !FlushLocked(false)) {
+            return -1;
+        }
+        m_pendingStdout = isStdout;
+        m_pending.append(static_cast<const char *>(data), len);
+        // more output is very likely on its way, let grpc batch the frames as well
+        if (m_pending.size() >= MaxPendingBytes && !FlushLocked(true)) {
+            return -1;
+        }
+        GrpcFlushTimer::Instance().Schedule(this, std::chrono::steady_clock::now() + FlushWindow);
+        return static_cast<ssize_t>(len);
+    }
+
+    // Send everything pending followed by the finish message, no write is allowed afterwards
+    bool Finish()
+    {
+        Stop();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed) {
+            return false;
+        }
+        if (!m_pending.empty() && !FlushLocked(false)) {
+            return false;
+        }
+        Response finish;
+        finish.set_finish(true);
+        if (!m_stream->Write(finish)) {
+            ERROR("Failed to write finish request to grpc client");
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    void OnDeadline() override
+    {
+        std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            // Write() is sending, the output it added is looked at after another window
+            if (!m_stopped) {
+                GrpcFlushTimer::Instance().Schedule(this, std::chrono::steady_clock::now() + FlushWindow);
+            }
+            return;
+        }
+        if (m_stopped || m_failed) {
+            return;
+        }
+        if (!m_pending.empty()) {
+            (void)FlushLocked(false);
+        } else if (m_corked) {
+            // nothing came after a message with a buffer hint, an empty one pushes it to the client
+            std::string empty;
+            (void)SendLocked(true, empty, false);
+        }
+    }
+
+private:
+    void Stop()
+    {
+        m_stopped = true;
+        GrpcFlushTimer::Instance().Cancel(this);
+    }
+
+    bool FlushLocked(bool corked)
+    {
+        std::string data;
+
+        data.swap(m_pending);
+        bool ok = SendLocked(m_pendingStdout, data, corked);
+        // the buffer is reused for the next output
+        data.clear();
+        m_pending.swap(data);
+        return ok;
+    }
+
+    bool SendLocked(bool isStdout, std::string &data, bool corked)
+    {
+        // the payload string is swapped in and out of the message instead of copied, the
+        // arena keeps the message itself off the heap and is reset after each write
+        Response *response = google::protobuf::Arena::CreateMessage<Response>(&m_arena);
+        std::string *payload = isStdout ? response->mutable_stdout() : response->mutable_stderr();
+        payload->swap(data);
+        grpc::WriteOptions options;
+        if (corked) {
+            options.set_buffer_hint();
+        }
+        bool ok = m_stream->Write(*response, options);
+        payload->swap(data);
+        m_arena.Reset();
+        m_corked = ok && corked;
+        if (!ok) {
+            ERROR("Failed to write request to grpc client");
+            m_failed = true;
+        }
+        return ok;
+    }
+
+    Stream *m_stream;
+    google::protobuf::Arena m_arena;
+    // held while a message is sent, so messages leave in the order they were cut
+    std::mutex m_mutex;
+    std::string m_pending;
+    bool m_pendingStdout { true };
+    std::atomic<bool> m_stopped { false };
+    bool m_failed { false };
+    // the last write carried a buffer hint and may still be held back by grpc
+    bool m_corked { false };
+};
+
+template <class Response, class Request, class Stream>
+constexpr std::chrono::milliseconds GrpcStreamCoalescer<Response, Request, Stream>::FlushWindow;
+
+#endif // DAEMON_ENTRY_CONNECT_GRPC_GRPC_STREAM_WRITER_H
@@ -24,6 +24,7 @@
 #include "isula_libutils/log.h"
 #include "utils.h"
 #include "grpc_server_tls_auth.h"
+#include "grpc_request_class.h"
 
 int VolumeServiceImpl::volume_list_request_from_grpc(const ListVolumeRequest *grequest,
                                                      volume_list_volume_request **request)
@@ -124,6 +125,7 @@ Status VolumeServiceImpl::List(ServerContext *context, const ListVolumeRequest *
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "volume.VolumeService", context);
     auto cb = get_service_executor();
     if (cb == nullptr || cb->volume.list == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -158,6 +160,7 @@ Status VolumeServiceImpl::Remove(ServerContext *context, const RemoveVolumeReque
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "volume.VolumeService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->volume.remove == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
@@ -191,6 +194,7 @@ Status VolumeServiceImpl::Prune(ServerContext *context, const PruneVolumeRequest
     if (!status.ok()) {
         return status;
     }
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "volume.VolumeService", context);
     service_executor_t *cb = get_service_executor();
     if (cb == nullptr || cb->volume.prune == nullptr) {
         return Status(StatusCode::UNIMPLEMENTED, "Unimplemented callback");
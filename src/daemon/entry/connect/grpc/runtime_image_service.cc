@@ -20,6 +20,7 @@
 #include "isula_libutils/log.h"
 #include "cri_helpers.h"
 #include "cri_image_manager_service_impl.h"
+#include "grpc_request_class.h"
 
 RuntimeImageServiceImpl::RuntimeImageServiceImpl()
 {
@@ -33,6 +34,8 @@ grpc::Status RuntimeImageServiceImpl::PullImage(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::HEAVY, "runtime.v1alpha2.ImageService", context);
+
     EVENT("Event: {Object: CRI, Type: Pulling image %s}", request->image().image().c_str());
 
     std::string imageRef = rService->PullImage(request->image(), request->auth(), error);
@@ -54,6 +57,8 @@ grpc::Status RuntimeImageServiceImpl::ListImages(grpc::ServerContext *context,
     std::vector<std::unique_ptr<runtime::v1alpha2::Image>> images;
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.ImageService", context);
+
     WARN("Event: {Object: CRI, Type: Listing all images}");
 
     rService->ListImages(request->filter(), &images, error);
@@ -82,6 +87,8 @@ grpc::Status RuntimeImageServiceImpl::ImageStatus(grpc::ServerContext *context,
     std::unique_ptr<runtime::v1alpha2::Image> image_info = nullptr;
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.ImageService", context);
+
     WARN("Event: {Object: CRI, Type: Statusing image %s}", request->image().image().c_str());
 
     image_info = rService->ImageStatus(request->image(), error);
@@ -108,6 +115,8 @@ grpc::Status RuntimeImageServiceImpl::ImageFsInfo(grpc::ServerContext *context,
     std::vector<std::unique_ptr<runtime::v1alpha2::FilesystemUsage>> usages;
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.ImageService", context);
+
     WARN("Event: {Object: CRI, Type: Statusing image fs info}");
 
     rService->ImageFsInfo(&usages, error);
@@ -135,6 +144,8 @@ grpc::Status RuntimeImageServiceImpl::RemoveImage(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.ImageService", context);
+
     EVENT("Event: {Object: CRI, Type: Removing image %s}", request->image().image().c_str());
 
     rService->RemoveImage(request->image(), error);
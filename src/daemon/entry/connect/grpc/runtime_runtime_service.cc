@@ -25,6 +25,7 @@
 #include "cri_pod_sandbox_manager_service_impl.h"
 #include "cri_runtime_manager_service_impl.h"
 #include "cri_helpers.h"
+#include "grpc_request_class.h"
 
 using namespace CRI;
 
@@ -89,6 +90,9 @@ grpc::Status RuntimeRuntimeServiceImpl::Version(grpc::ServerContext *context,
                                                 runtime::v1alpha2::VersionResponse *reply)
 {
     Errors error;
+
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     rService->Version(request->version(), reply, error);
     if (!error.Empty()) {
         return grpc::Status(grpc::StatusCode::UNKNOWN, error.GetMessage());
@@ -103,6 +107,8 @@ grpc::Status RuntimeRuntimeServiceImpl::CreateContainer(grpc::ServerContext *con
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Creating Container}");
 
     std::string responseID =
@@ -124,6 +130,8 @@ grpc::Status RuntimeRuntimeServiceImpl::StartContainer(grpc::ServerContext *cont
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Starting Container: %s}", request->container_id().c_str());
 
     rService->StartContainer(request->container_id(), error);
@@ -143,6 +151,8 @@ grpc::Status RuntimeRuntimeServiceImpl::StopContainer(grpc::ServerContext *conte
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Stopping Container: %s}", request->container_id().c_str());
 
     rService->StopContainer(request->container_id(), (int64_t)request->timeout(), error);
@@ -162,6 +172,8 @@ grpc::Status RuntimeRuntimeServiceImpl::RemoveContainer(grpc::ServerContext *con
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Removing Container: %s}", request->container_id().c_str());
 
     rService->RemoveContainer(request->container_id(), error);
@@ -181,6 +193,8 @@ grpc::Status RuntimeRuntimeServiceImpl::ListContainers(grpc::ServerContext *cont
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Listing all Container}");
 
     std::vector<std::unique_ptr<runtime::v1alpha2::Container>> containers;
@@ -210,6 +224,8 @@ grpc::Status RuntimeRuntimeServiceImpl::ListContainerStats(grpc::ServerContext *
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Listing all Container stats}");
 
     std::vector<std::unique_ptr<runtime::v1alpha2::ContainerStats>> containers;
@@ -239,6 +255,8 @@ grpc::Status RuntimeRuntimeServiceImpl::ContainerStatus(grpc::ServerContext *con
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Statusing Container: %s}", request->container_id().c_str());
 
     std::unique_ptr<runtime::v1alpha2::ContainerStatus> contStatus =
@@ -260,6 +278,8 @@ grpc::Status RuntimeRuntimeServiceImpl::ExecSync(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: sync execing Container: %s}", request->container_id().c_str());
 
     rService->ExecSync(request->container_id(), request->cmd(), request->timeout(), reply, error);
@@ -279,6 +299,8 @@ grpc::Status RuntimeRuntimeServiceImpl::RunPodSandbox(grpc::ServerContext *conte
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Running Pod}");
 
     std::string responseID = rService->RunPodSandbox(request->config(), request->runtime_handler(), error);
@@ -299,6 +321,8 @@ grpc::Status RuntimeRuntimeServiceImpl::StopPodSandbox(grpc::ServerContext *cont
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Stopping Pod: %s}", request->pod_sandbox_id().c_str());
 
     rService->StopPodSandbox(request->pod_sandbox_id(), error);
@@ -319,6 +343,8 @@ grpc::Status RuntimeRuntimeServiceImpl::RemovePodSandbox(grpc::ServerContext *co
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Removing Pod: %s}", request->pod_sandbox_id().c_str());
 
     rService->RemovePodSandbox(request->pod_sandbox_id(), error);
@@ -339,6 +365,8 @@ grpc::Status RuntimeRuntimeServiceImpl::PodSandboxStatus(grpc::ServerContext *co
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Status Pod: %s}", request->pod_sandbox_id().c_str());
 
     std::unique_ptr<runtime::v1alpha2::PodSandboxStatus> podStatus;
@@ -361,6 +389,8 @@ grpc::Status RuntimeRuntimeServiceImpl::ListPodSandbox(grpc::ServerContext *cont
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Listing all Pods}");
 
     std::vector<std::unique_ptr<runtime::v1alpha2::PodSandbox>> pods;
@@ -390,6 +420,8 @@ RuntimeRuntimeServiceImpl::UpdateContainerResources(grpc::ServerContext *context
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Updating container resources: %s}", request->container_id().c_str());
 
     rService->UpdateContainerResources(request->container_id(), request->linux(), error);
@@ -410,6 +442,8 @@ grpc::Status RuntimeRuntimeServiceImpl::Exec(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: execing Container: %s}", request->container_id().c_str());
 
     rService->Exec(*request, response, error);
@@ -430,6 +464,8 @@ grpc::Status RuntimeRuntimeServiceImpl::Attach(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: attaching Container: %s}", request->container_id().c_str());
 
     rService->Attach(*request, response, error);
@@ -451,6 +487,8 @@ RuntimeRuntimeServiceImpl::UpdateRuntimeConfig(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::DEFAULT, "runtime.v1alpha2.RuntimeService", context);
+
     EVENT("Event: {Object: CRI, Type: Updating Runtime Config}");
 
     rService->UpdateRuntimeConfig(request->runtime_config(), error);
@@ -470,6 +508,8 @@ grpc::Status RuntimeRuntimeServiceImpl::Status(grpc::ServerContext *context,
 {
     Errors error;
 
+    REQUEST_CLASS_GUARD(RequestClass::CRI_STATUS, "runtime.v1alpha2.RuntimeService", context);
+
     WARN("Event: {Object: CRI, Type: Statusing daemon}");
 
     std::unique_ptr<runtime::v1alpha2::RuntimeStatus> status = rService->Status(error);
@@ -16,6 +16,8 @@
 
 #include <stdlib.h>
 
+#include "utils_array.h"
+
 #include "image_cb.h"
 #include "execution.h"
 #include "volume_cb.h"
@@ -35,6 +37,23 @@ void isulad_events_request_free(struct isulad_events_request *request)
     free(request);
 }
 
+void isulad_stats_frame_free(struct isulad_stats_frame *frame)
+{
+    size_t i;
+
+    if (frame == NULL) {
+        return;
+    }
+    for (i = 0; i < frame->containers_len; i++) {
+        free_container_info(frame->containers[i]);
+    }
+    free(frame->containers);
+    frame->containers = NULL;
+    util_free_array_by_len(frame->removed, frame->removed_len);
+    frame->removed = NULL;
+    free(frame);
+}
+
 void isulad_copy_from_container_request_free(struct isulad_copy_from_container_request *request)
 {
     if (request == NULL) {
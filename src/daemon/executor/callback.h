@@ -103,6 +103,14 @@ struct isulad_events_request {
     types_timestamp_t until;
 };
 
+// frame of a stats stream, containers whose stats changed since the last frame and ids of removed ones
+struct isulad_stats_frame {
+    container_info **containers;
+    size_t containers_len;
+    char **removed;
+    size_t removed_len;
+};
+
 struct isulad_events_response {
     uint32_t server_errono;
     uint32_t cc;
@@ -168,6 +176,8 @@ struct isulad_container_resize_response {
 
 void isulad_events_request_free(struct isulad_events_request *request);
 
+void isulad_stats_frame_free(struct isulad_stats_frame *frame);
+
 void isulad_copy_from_container_request_free(struct isulad_copy_from_container_request *request);
 
 void isulad_copy_from_container_response_free(struct isulad_copy_from_container_response *response);
@@ -219,6 +229,8 @@ typedef struct {
 
     int (*stats)(const container_stats_request *request, container_stats_response **response);
 
+    int (*stats_stream)(const container_stats_request *request, const stream_func_wrapper *stream);
+
     int (*pause)(const container_pause_request *request, container_pause_response **response);
 
     int (*resume)(const container_resume_request *request, container_resume_response **response);
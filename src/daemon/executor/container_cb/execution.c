@@ -249,7 +249,7 @@ out:
 
 static int prepare_start_io(container_t *cont, const container_start_request *request, char **fifopath, char *fifos[],
                             int stdinfd, struct io_write_wrapper *stdout_handler,
-                            struct io_write_wrapper *stderr_handler, int *sync_fd, pthread_t *thread_id)
+                            struct io_write_wrapper *stderr_handler, int *sync_fd, io_copy_session_t **io_session)
 {
     int ret = 0;
     char *id = NULL;
@@ -271,7 +271,7 @@ static int prepare_start_io(container_t *cont, const container_start_request *re
         }
 
         if (ready_copy_io_data(*sync_fd, false, request->stdin, request->stdout, request->stderr, stdinfd,
-                               stdout_handler, stderr_handler, (const char **)fifos, thread_id)) {
+                               stdout_handler, stderr_handler, (const char **)fifos, io_session)) {
             ret = -1;
             goto out;
         }
@@ -299,7 +299,7 @@ static void pack_start_response(container_start_response *response, uint32_t cc,
 
 static int container_start_prepare(container_t *cont, const container_start_request *request, int stdinfd,
                                    struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                                   char **fifopath, char *fifos[], int *sync_fd, pthread_t *thread_id)
+                                   char **fifopath, char *fifos[], int *sync_fd, io_copy_session_t **io_session)
 {
     const char *id = cont->common_config->id;
 
@@ -309,22 +309,18 @@ static int container_start_prepare(container_t *cont, const container_start_requ
         return -1;
     }
 
-    if (prepare_start_io(cont, request, fifopath, fifos, stdinfd, stdout_handler, stderr_handler, sync_fd, thread_id) !=
-        0) {
+    if (prepare_start_io(cont, request, fifopath, fifos, stdinfd, stdout_handler, stderr_handler, sync_fd,
+                         io_session) != 0) {
         return -1;
     }
 
     return 0;
 }
 
-static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thread_id)
+static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, io_copy_session_t *io_session)
 {
     if (cc == ISULAD_SUCCESS) {
-        if (thread_id > 0) {
-            if (pthread_detach(thread_id) != 0) {
-                SYSERROR("Failed to detach 0x%lx", thread_id);
-            }
-        }
+        io_copy_session_detach(io_session);
         if (sync_fd >= 0) {
             close(sync_fd);
         }
@@ -334,11 +330,7 @@ static void handle_start_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thr
                 ERROR("Failed to write eventfd: %s", strerror(errno));
             }
         }
-        if (thread_id > 0) {
-            if (pthread_join(thread_id, NULL) != 0) {
-                ERROR("Failed to join thread: 0x%lx", thread_id);
-            }
-        }
+        (void)io_copy_session_wait(io_session);
         if (sync_fd >= 0) {
             close(sync_fd);
         }
@@ -354,7 +346,7 @@ static int container_start_cb(const container_start_request *request, container_
     char *fifopath = NULL;
     container_t *cont = NULL;
     int sync_fd = -1;
-    pthread_t thread_id = 0;
+    io_copy_session_t *io_session = NULL;
 
     DAEMON_CLEAR_ERRMSG();
 
@@ -396,7 +388,7 @@ static int container_start_cb(const container_start_request *request, container_
     }
 
     if (container_start_prepare(cont, request, stdinfd, stdout_handler, stderr_handler, &fifopath, fifos, &sync_fd,
-                                &thread_id) != 0) {
+                                &io_session) != 0) {
         cc = ISULAD_ERR_EXEC;
         goto pack_response;
     }
@@ -410,7 +402,7 @@ static int container_start_cb(const container_start_request *request, container_
     (void)isulad_monitor_send_container_event(id, START, -1, 0, NULL, NULL);
 
 pack_response:
-    handle_start_io_thread_by_cc(cc, sync_fd, thread_id);
+    handle_start_io_thread_by_cc(cc, sync_fd, io_session);
     delete_daemon_fifos(fifopath, (const char **)fifos);
     free(fifos[0]);
     free(fifos[1]);
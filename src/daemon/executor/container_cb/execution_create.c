@@ -53,6 +53,7 @@
 #include "err_msg.h"
 #include "event_type.h"
 #include "utils_file.h"
+#include "utils_trash.h"
 #include "utils_string.h"
 #include "utils_timestamp.h"
 #include "utils_verify.h"
@@ -907,6 +908,7 @@ static int delete_container_root_dir(const char *id, const char *runtime_root)
 {
     int ret = 0;
     char container_root[PATH_MAX] = { 0x00 };
+    char *isulad_root = NULL;
 
     ret = snprintf(container_root, sizeof(container_root), "%s/%s", runtime_root, id);
     if ((size_t)ret >= sizeof(container_root) || ret < 0) {
@@ -915,7 +917,8 @@ static int delete_container_root_dir(const char *id, const char *runtime_root)
         goto out;
     }
 
-    ret = util_recursive_rmdir(container_root, 0);
+    isulad_root = conf_get_isulad_rootdir();
+    ret = util_trash_path(isulad_root, container_root);
     if (ret != 0) {
         ERROR("Failed to delete container's state directory %s", container_root);
         ret = -1;
@@ -923,6 +926,7 @@ static int delete_container_root_dir(const char *id, const char *runtime_root)
     }
 
 out:
+    free(isulad_root);
     return ret;
 }
 
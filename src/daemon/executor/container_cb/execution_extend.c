@@ -15,7 +15,6 @@
 #include "execution_extend.h"
 
 #include <stdio.h>
-#include <sys/sysinfo.h>
 #include <isula_libutils/container_config.h>
 #include <isula_libutils/container_config_v2.h>
 #include <isula_libutils/container_export_request.h>
@@ -56,6 +55,7 @@
 #include "stream_wrapper.h"
 #include "utils_array.h"
 #include "utils_verify.h"
+#include "stats_sampler.h"
 
 struct stats_context {
     struct filters_args *stats_filters;
@@ -220,80 +220,36 @@ static int copy_map_labels(const container_config *config, map_t **map_labels)
     return 0;
 }
 
-static container_info *get_container_stats(const container_t *cont,
-                                           const struct runtime_container_resources_stats_info *einfo,
-                                           const struct stats_context *ctx)
+static bool stats_filter_match(const container_t *cont, const struct stats_context *ctx)
 {
-    int ret = 0;
-    uint64_t sysmem_limit;
-    uint64_t sys_cpu_usage = 0;
-    container_info *info = NULL;
+    bool ret = false;
     map_t *map_labels = NULL;
 
-    info = util_common_calloc_s(sizeof(container_info));
-    if (info == NULL) {
-        ERROR("Out of memory");
-        return NULL;
-    }
-
-    info->id = util_strdup_s(cont->common_config->id);
-    info->pids_current = einfo->pids_current;
-    info->cpu_use_nanos = einfo->cpu_use_nanos;
-    info->blkio_read = einfo->blkio_read;
-    info->blkio_write = einfo->blkio_write;
-    info->mem_used = einfo->mem_used;
-    info->mem_limit = einfo->mem_limit;
-    info->kmem_used = einfo->kmem_used;
-    info->kmem_limit = einfo->kmem_limit;
-
-    sysmem_limit = get_default_total_mem_size();
-    if (get_system_cpu_usage(&sys_cpu_usage)) {
-        WARN("Failed to get system cpu usage");
+    if (!filters_args_match(ctx->stats_filters, "id", cont->common_config->id)) {
+        return false;
     }
 
-    if (sysmem_limit > 0) {
-        if (info->mem_limit > sysmem_limit) {
-            info->mem_limit = sysmem_limit;
-        }
-        if (info->kmem_limit > sysmem_limit) {
-            info->kmem_limit = sysmem_limit;
-        }
-    }
-    info->cpu_system_use = sys_cpu_usage;
-    info->online_cpus = (uint32_t)get_nprocs();
-
-    info->image_type = util_strdup_s(cont->common_config->image_type);
-
-    info->name = util_strdup_s(cont->common_config->name);
-    info->status = util_strdup_s(container_state_to_string(container_state_get_status(cont->state)));
-    info->cache = einfo->cache;
-    info->cache_total = einfo->cache_total;
-    info->inactive_file_total = einfo->inactive_file_total;
-
     if (copy_map_labels(cont->common_config->config, &map_labels) != 0) {
-        ret = -1;
-        goto cleanup;
-    }
-
-    if (!filters_args_match(ctx->stats_filters, "id", info->id)) {
-        ret = -1;
         goto cleanup;
     }
 
     // Do not include container if any of the labels don't match
-    if (!filters_args_match_kv_list(ctx->stats_filters, "label", map_labels)) {
-        ret = -1;
-        goto cleanup;
-    }
+    ret = filters_args_match_kv_list(ctx->stats_filters, "label", map_labels);
 
 cleanup:
     map_free(map_labels);
-    if (ret != 0) {
-        free_container_info(info);
-        info = NULL;
+    return ret;
+}
+
+static container_info *get_container_stats(const container_t *cont,
+                                           const struct runtime_container_resources_stats_info *einfo,
+                                           const struct stats_context *ctx)
+{
+    if (!stats_filter_match(cont, ctx)) {
+        return NULL;
     }
 
-    return info;
+    return stats_sampler_container_info(cont, einfo);
 }
 
 static struct stats_context *fold_stats_filter(const container_stats_request *request)
@@ -509,6 +465,339 @@ pack_response:
     return (cc == ISULAD_SUCCESS) ? 0 : -1;
 }
 
+struct stats_stream_context {
+    const struct stats_context *ctx;
+    // ids of the requested containers, NULL for all containers
+    map_t *wanted;
+    // stats last sent to the client by id
+    map_t *sent;
+    // result of the filters by id, the labels of a container do not change
+    map_t *matched;
+    // containers of the last sample wanted by the client
+    container_info **candidates;
+    size_t candidates_len;
+    size_t candidates_cap;
+};
+
+static void stats_stream_sent_kvfree(void *key, void *value)
+{
+    free(key);
+    free_container_info((container_info *)value);
+}
+
+static container_info *dup_stats_info(const container_info *src)
+{
+    container_info *info = NULL;
+
+    info = util_common_calloc_s(sizeof(container_info));
+    if (info == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    info->id = util_strdup_s(src->id);
+    info->pids_current = src->pids_current;
+    info->cpu_use_nanos = src->cpu_use_nanos;
+    info->cpu_system_use = src->cpu_system_use;
+    info->online_cpus = src->online_cpus;
+    info->blkio_read = src->blkio_read;
+    info->blkio_write = src->blkio_write;
+    info->mem_used = src->mem_used;
+    info->mem_limit = src->mem_limit;
+    info->kmem_used = src->kmem_used;
+    info->kmem_limit = src->kmem_limit;
+    info->image_type = util_strdup_s(src->image_type);
+    info->name = util_strdup_s(src->name);
+    info->status = util_strdup_s(src->status);
+    info->cache = src->cache;
+    info->cache_total = src->cache_total;
+    info->inactive_file_total = src->inactive_file_total;
+
+    return info;
+}
+
+// the system cpu usage changes every sample, it does not make a container changed
+static bool stats_info_changed(const container_info *old, const container_info *info)
+{
+    return old->pids_current != info->pids_current || old->cpu_use_nanos != info->cpu_use_nanos ||
+           old->online_cpus != info->online_cpus || old->blkio_read != info->blkio_read ||
+           old->blkio_write != info->blkio_write || old->mem_used != info->mem_used ||
+           old->mem_limit != info->mem_limit || old->kmem_used != info->kmem_used ||
+           old->kmem_limit != info->kmem_limit || old->cache != info->cache ||
+           old->cache_total != info->cache_total || old->inactive_file_total != info->inactive_file_total ||
+           strcmp(old->name, info->name) != 0 || strcmp(old->status, info->status) != 0;
+}
+
+static void stats_stream_collect(const container_info *info, bool running, void *arg)
+{
+    struct stats_stream_context *sctx = (struct stats_stream_context *)arg;
+    container_info **tmp = NULL;
+    size_t cap;
+
+    if (info->id == NULL || info->name == NULL || info->status == NULL) {
+        return;
+    }
+    if (sctx->wanted != NULL && map_search(sctx->wanted, info->id) == NULL) {
+        return;
+    }
+    if (!running && !sctx->ctx->stats_config->all) {
+        return;
+    }
+
+    if (sctx->candidates_len == sctx->candidates_cap) {
+        cap = sctx->candidates_cap == 0 ? 16 : sctx->candidates_cap * 2;
+        if (util_mem_realloc((void **)&tmp, cap * sizeof(container_info *), sctx->candidates,
+                             sctx->candidates_cap * sizeof(container_info *)) != 0) {
+            ERROR("Out of memory");
+            return;
+        }
+        sctx->candidates = tmp;
+        sctx->candidates_cap = cap;
+    }
+    sctx->candidates[sctx->candidates_len] = dup_stats_info(info);
+    if (sctx->candidates[sctx->candidates_len] != NULL) {
+        sctx->candidates_len++;
+    }
+}
+
+static bool stats_stream_match(struct stats_stream_context *sctx, const char *id)
+{
+    bool *cached = NULL;
+    bool matched = false;
+    container_t *cont = NULL;
+
+    cached = map_search(sctx->matched, (void *)id);
+    if (cached != NULL) {
+        return *cached;
+    }
+
+    cont = containers_store_get(id);
+    if (cont == NULL) {
+        return false;
+    }
+    matched = stats_filter_match(cont, sctx->ctx);
+    container_unref(cont);
+    if (!map_insert(sctx->matched, (void *)id, &matched)) {
+        WARN("Failed to cache filters result of %s", id);
+    }
+
+    return matched;
+}
+
+static int stats_stream_pick_removed(struct stats_stream_context *sctx, map_t *seen,
+                                     struct isulad_stats_frame *frame)
+{
+    size_t i;
+    map_itor *itor = NULL;
+
+    itor = map_itor_new(sctx->sent);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        if (map_search(seen, map_itor_key(itor)) != NULL) {
+            continue;
+        }
+        if (util_array_append(&frame->removed, map_itor_key(itor)) != 0) {
+            ERROR("Out of memory");
+            map_itor_free(itor);
+            return -1;
+        }
+        frame->removed_len++;
+    }
+    map_itor_free(itor);
+
+    for (i = 0; i < frame->removed_len; i++) {
+        (void)map_remove(sctx->sent, frame->removed[i]);
+        (void)map_remove(sctx->matched, frame->removed[i]);
+    }
+    return 0;
+}
+
+// frame of the containers changed since the last frame, the first frame holds all containers
+static int stats_stream_make_frame(struct stats_stream_context *sctx, struct isulad_stats_frame *frame)
+{
+    int ret = -1;
+    bool val = true;
+    size_t i;
+    map_t *seen = NULL;
+    container_info *info = NULL;
+    container_info *old = NULL;
+
+    seen = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (seen == NULL || service_stats_make_memory(&frame->containers, sctx->candidates_len + 1) != 0) {
+        ERROR("Out of memory");
+        goto out;
+    }
+
+    for (i = 0; i < sctx->candidates_len; i++) {
+        info = sctx->candidates[i];
+        if (!stats_stream_match(sctx, info->id)) {
+            continue;
+        }
+        if (!map_replace(seen, info->id, &val)) {
+            ERROR("Out of memory");
+            goto out;
+        }
+        old = map_search(sctx->sent, info->id);
+        if (old != NULL && !stats_info_changed(old, info)) {
+            continue;
+        }
+        old = dup_stats_info(info);
+        if (old == NULL || !map_replace(sctx->sent, info->id, old)) {
+            ERROR("Out of memory");
+            free_container_info(old);
+            goto out;
+        }
+        frame->containers[frame->containers_len++] = info;
+        sctx->candidates[i] = NULL;
+    }
+
+    ret = stats_stream_pick_removed(sctx, seen, frame);
+
+out:
+    for (i = 0; i < sctx->candidates_len; i++) {
+        free_container_info(sctx->candidates[i]);
+        sctx->candidates[i] = NULL;
+    }
+    sctx->candidates_len = 0;
+    map_free(seen);
+    return ret;
+}
+
+static int stats_stream_send(struct stats_stream_context *sctx, stats_sampler_client_t *client,
+                             const stream_func_wrapper *stream, bool first)
+{
+    int ret = 0;
+    struct isulad_stats_frame *frame = NULL;
+
+    frame = util_common_calloc_s(sizeof(struct isulad_stats_frame));
+    if (frame == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    stats_sampler_foreach(client, stats_stream_collect, sctx);
+    if (stats_stream_make_frame(sctx, frame) != 0) {
+        ret = -1;
+        goto out;
+    }
+
+    if (!first && frame->containers_len == 0 && frame->removed_len == 0) {
+        goto out;
+    }
+    if (!stream->write_func(stream->writer, frame)) {
+        INFO("Stats stream client is gone");
+        ret = -1;
+    }
+
+out:
+    isulad_stats_frame_free(frame);
+    return ret;
+}
+
+static int stats_stream_resolve_containers(const container_stats_request *request, map_t **wanted)
+{
+    bool val = true;
+    size_t i;
+    container_t *cont = NULL;
+
+    if (request->containers == NULL || request->containers_len == 0) {
+        return 0;
+    }
+
+    *wanted = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (*wanted == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < request->containers_len; i++) {
+        if (!util_valid_container_id_or_name(request->containers[i])) {
+            ERROR("Invalid container name: %s", request->containers[i]);
+            isulad_set_error_message("Invalid container name: %s", request->containers[i]);
+            return -1;
+        }
+        cont = containers_store_get(request->containers[i]);
+        if (cont == NULL) {
+            ERROR("No such container: %s", request->containers[i]);
+            isulad_set_error_message("No such container: %s", request->containers[i]);
+            return -1;
+        }
+        if (!map_replace(*wanted, cont->common_config->id, &val)) {
+            ERROR("Out of memory");
+            container_unref(cont);
+            return -1;
+        }
+        container_unref(cont);
+    }
+
+    return 0;
+}
+
+static int container_stats_stream_cb(const container_stats_request *request, const stream_func_wrapper *stream)
+{
+    int ret = 0;
+    bool first = true;
+    struct stats_context *ctx = NULL;
+    struct stats_stream_context sctx = { 0 };
+    stats_sampler_client_t *client = NULL;
+
+    DAEMON_CLEAR_ERRMSG();
+    if (request == NULL || stream == NULL || stream->write_func == NULL) {
+        ERROR("Invalid NULL input");
+        return -1;
+    }
+
+    ctx = fold_stats_filter(request);
+    if (ctx == NULL) {
+        ret = -1;
+        goto out;
+    }
+    sctx.ctx = ctx;
+
+    if (stats_stream_resolve_containers(request, &sctx.wanted) != 0) {
+        ret = -1;
+        goto out;
+    }
+
+    sctx.sent = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, stats_stream_sent_kvfree);
+    sctx.matched = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (sctx.sent == NULL || sctx.matched == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    client = stats_sampler_join();
+    if (client == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    while (stream->is_cancelled == NULL || !stream->is_cancelled(stream->context)) {
+        if (!stats_sampler_wait(client, STATS_SAMPLER_INTERVAL_MS)) {
+            continue;
+        }
+        // the client is gone, or frames can not be made any more
+        if (stats_stream_send(&sctx, client, stream, first) != 0) {
+            break;
+        }
+        first = false;
+    }
+
+    stats_sampler_leave(client);
+
+out:
+    free(sctx.candidates);
+    map_free(sctx.wanted);
+    map_free(sctx.sent);
+    map_free(sctx.matched);
+    free_stats_context(ctx);
+    return ret;
+}
+
 static int do_resume_container(container_t *cont)
 {
     int ret = 0;
@@ -972,6 +1261,10 @@ static int update_container(const container_t *cont, const host_config *hostconf
         chostconfig->blkio_weight = hostconfig->blkio_weight;
     }
 
+    if (hostconfig->pids_limit != 0) {
+        chostconfig->pids_limit = hostconfig->pids_limit;
+    }
+
     ret = update_container_cpu(hostconfig, chostconfig);
     if (ret != 0) {
         ret = -1;
@@ -1507,6 +1800,7 @@ void container_extend_callback_init(service_container_callback_t *cb)
     cb->pause = container_pause_cb;
     cb->resume = container_resume_cb;
     cb->stats = container_stats_cb;
+    cb->stats_stream = container_stats_stream_cb;
     cb->events = container_events_cb;
     cb->export_rootfs = container_export_cb;
     cb->resize = container_resize_cb;
@@ -216,7 +216,7 @@ out:
 
 static int attach_prepare_console(const container_t *cont, const container_attach_request *request, int stdinfd,
                                   struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                                  char **fifos, char **fifopath, int *sync_fd, pthread_t *tid)
+                                  char **fifos, char **fifopath, int *sync_fd, io_copy_session_t **io_session)
 {
     int ret = 0;
     const char *id = cont->common_config->id;
@@ -236,7 +236,7 @@ static int attach_prepare_console(const container_t *cont, const container_attac
         }
 
         if (ready_copy_io_data(*sync_fd, false, request->stdin, request->stdout, request->stderr, stdinfd,
-                               stdout_handler, stderr_handler, (const char **)fifos, tid)) {
+                               stdout_handler, stderr_handler, (const char **)fifos, io_session)) {
             ret = -1;
             goto out;
         }
@@ -246,14 +246,10 @@ out:
     return ret;
 }
 
-static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t thread_id)
+static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, io_copy_session_t *io_session)
 {
     if (cc == ISULAD_SUCCESS) {
-        if (thread_id > 0) {
-            if (pthread_detach(thread_id) != 0) {
-                SYSERROR("Failed to detach 0x%lx", thread_id);
-            }
-        }
+        io_copy_session_detach(io_session);
         if (sync_fd >= 0) {
             close(sync_fd);
         }
@@ -263,11 +259,7 @@ static void handle_attach_io_thread_by_cc(uint32_t cc, int sync_fd, pthread_t th
                 ERROR("Failed to write eventfd: %s", strerror(errno));
             }
         }
-        if (thread_id > 0) {
-            if (pthread_join(thread_id, NULL) != 0) {
-                ERROR("Failed to join thread: 0x%lx", thread_id);
-            }
-        }
+        (void)io_copy_session_wait(io_session);
         if (sync_fd >= 0) {
             close(sync_fd);
         }
@@ -283,7 +275,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     char *fifos[3] = { NULL, NULL, NULL };
     char *fifopath = NULL;
     int syncfd = -1;
-    pthread_t tid = 0;
+    io_copy_session_t *io_session = NULL;
     container_t *cont = NULL;
     rt_attach_params_t params = { 0 };
 
@@ -305,7 +297,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     }
 
     if (attach_prepare_console(cont, request, stdinfd, stdout_handler, stderr_handler, fifos, &fifopath, &syncfd,
-                               &tid) != 0) {
+                               &io_session) != 0) {
         cc = ISULAD_ERR_EXEC;
         goto pack_response;
     }
@@ -324,7 +316,7 @@ static int container_attach_cb(const container_attach_request *request, containe
     }
 
 pack_response:
-    handle_attach_io_thread_by_cc(cc, syncfd, tid);
+    handle_attach_io_thread_by_cc(cc, syncfd, io_session);
     if (*response != NULL) {
         (*response)->cc = cc;
         if (g_isulad_errmsg != NULL) {
@@ -192,6 +192,24 @@ static inline void set_idsearch(size_t ids_len, bool *value)
     }
 }
 
+// fastpath of label filters, false if the label index of the store can not be used
+static bool filter_by_labels(const struct list_context *ctx, char ***filtered_ids)
+{
+    bool ret = false;
+    char **labels = NULL;
+    size_t labels_len = 0;
+
+    labels = filters_args_get(ctx->ps_filters, "label");
+    labels_len = util_array_len((const char **)labels);
+    if (labels_len > 0 &&
+        containers_store_list_ids_by_labels((const char **)labels, labels_len, filtered_ids) == 0) {
+        ret = true;
+    }
+
+    util_free_array(labels);
+    return ret;
+}
+
 static char **filter_by_name_id_matches(const struct list_context *ctx, const map_t *map_id_name)
 {
     int ret = 0;
@@ -209,6 +227,10 @@ static char **filter_by_name_id_matches(const struct list_context *ctx, const ma
     ids = filters_args_get(ctx->ps_filters, "id");
     ids_len = util_array_len((const char **)ids);
     if (names_len == 0 && ids_len == 0) {
+        // only the containers with the labels are checked, such as the ones of a sandbox
+        if (filter_by_labels(ctx, &filtered_ids)) {
+            return filtered_ids;
+        }
         if (append_ids(map_id_name, &filtered_ids) != 0) {
             goto cleanup;
         }
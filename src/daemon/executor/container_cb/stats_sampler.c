@@ -0,0 +1,452 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide shared stats sampler of stats streams
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "stats_sampler.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/prctl.h>
+#include <sys/sysinfo.h>
+
+#include "isula_libutils/log.h"
+#include "events_collector_api.h"
+#include "events_format.h"
+#include "isulad_config.h"
+#include "sysinfo.h"
+#include "map.h"
+#include "stream_wrapper.h"
+#include "utils.h"
+#include "utils_array.h"
+
+/*
+ * Polling stats made each client walk all containers and read their cgroups once per
+ * second. A stream client joins the sampler instead: one pass per interval reads the
+ * stats of all containers for all clients, and only while there are clients. The ids to
+ * sample are listed from the store when the sampler starts and then follow the create
+ * events, ids gone from the store are dropped by the pass which misses them.
+ */
+// list the store again now and then, for containers created before the events client was added
+#define STATS_SAMPLER_RESYNC_PASSES 30
+
+struct stats_sampler_client {
+    uint64_t generation;
+};
+
+struct stats_sample {
+    container_info *info;
+    bool running;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    // ids of containers to sample
+    map_t *ids;
+    struct stats_sample *samples;
+    size_t samples_len;
+    uint64_t generation;
+    // a sample was taken since the sampler started
+    bool sampled;
+    size_t clients;
+    bool started;
+    // tells the events client of a stopped sampler from the one of the running sampler
+    uint64_t epoch;
+} g_sampler = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+container_info *stats_sampler_container_info(const container_t *cont,
+                                             const struct runtime_container_resources_stats_info *einfo)
+{
+    uint64_t sysmem_limit;
+    uint64_t sys_cpu_usage = 0;
+    container_info *info = NULL;
+
+    info = util_common_calloc_s(sizeof(container_info));
+    if (info == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    info->id = util_strdup_s(cont->common_config->id);
+    info->pids_current = einfo->pids_current;
+    info->cpu_use_nanos = einfo->cpu_use_nanos;
+    info->blkio_read = einfo->blkio_read;
+    info->blkio_write = einfo->blkio_write;
+    info->mem_used = einfo->mem_used;
+    info->mem_limit = einfo->mem_limit;
+    info->kmem_used = einfo->kmem_used;
+    info->kmem_limit = einfo->kmem_limit;
+
+    sysmem_limit = get_default_total_mem_size();
+    if (get_system_cpu_usage(&sys_cpu_usage)) {
+        WARN("Failed to get system cpu usage");
+    }
+
+    if (sysmem_limit > 0) {
+        if (info->mem_limit > sysmem_limit) {
+            info->mem_limit = sysmem_limit;
+        }
+        if (info->kmem_limit > sysmem_limit) {
+            info->kmem_limit = sysmem_limit;
+        }
+    }
+    info->cpu_system_use = sys_cpu_usage;
+    info->online_cpus = (uint32_t)get_nprocs();
+
+    info->image_type = util_strdup_s(cont->common_config->image_type);
+
+    info->name = util_strdup_s(cont->common_config->name);
+    info->status = util_strdup_s(container_state_to_string(container_state_get_status(cont->state)));
+    info->cache = einfo->cache;
+    info->cache_total = einfo->cache_total;
+    info->inactive_file_total = einfo->inactive_file_total;
+
+    return info;
+}
+
+static void free_samples(struct stats_sample *samples, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        free_container_info(samples[i].info);
+    }
+    free(samples);
+}
+
+static void add_ids(char **ids)
+{
+    bool val = true;
+    size_t i;
+
+    for (i = 0; ids != NULL && ids[i] != NULL; i++) {
+        if (!map_replace(g_sampler.ids, ids[i], &val)) {
+            WARN("Failed to add %s to stats sampler", ids[i]);
+        }
+    }
+}
+
+static char **list_ids(void)
+{
+    char **ids = NULL;
+    map_itor *itor = NULL;
+
+    itor = map_itor_new(g_sampler.ids);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        if (util_array_append(&ids, map_itor_key(itor)) != 0) {
+            ERROR("Out of memory");
+            break;
+        }
+    }
+    map_itor_free(itor);
+
+    return ids;
+}
+
+static bool sampler_events_cancelled(void *context)
+{
+    bool cancelled = false;
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    cancelled = !g_sampler.started || (uint64_t)(uintptr_t)context != g_sampler.epoch;
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    return cancelled;
+}
+
+static bool sampler_events_write(void *writer, void *data)
+{
+    const struct isulad_events_format *event = (const struct isulad_events_format *)data;
+    char *ids[] = { NULL, NULL };
+
+    (void)writer;
+    if (event == NULL || event->id == NULL || !event->has_type) {
+        return true;
+    }
+    // start covers containers of a restarted daemon too
+    if (event->type != EVENTS_TYPE_CREATE && event->type != EVENTS_TYPE_START) {
+        return true;
+    }
+
+    ids[0] = event->id;
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    if (g_sampler.ids != NULL) {
+        add_ids(ids);
+    }
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    return true;
+}
+
+static void *sampler_events_thread(void *arg)
+{
+    stream_func_wrapper stream = { 0 };
+
+    (void)pthread_detach(pthread_self());
+    (void)prctl(PR_SET_NAME, "StatsEvents");
+
+    stream.context = arg;
+    stream.is_cancelled = sampler_events_cancelled;
+    stream.writer = &g_sampler;
+    stream.write_func = sampler_events_write;
+    if (add_monitor_client(NULL, NULL, NULL, &stream) != 0) {
+        WARN("Failed to follow events for stats sampler");
+    }
+
+    return NULL;
+}
+
+static struct stats_sample *sample_containers(char **ids, size_t *samples_len, char ***gone)
+{
+    struct stats_sample *samples = NULL;
+    size_t len = util_array_len((const char **)ids);
+    size_t i;
+
+    samples = util_smart_calloc_s(sizeof(struct stats_sample), len + 1);
+    if (samples == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    *samples_len = 0;
+    for (i = 0; i < len; i++) {
+        struct runtime_container_resources_stats_info einfo = { 0 };
+        container_t *cont = NULL;
+        bool running = false;
+
+        cont = containers_store_get(ids[i]);
+        if (cont == NULL) {
+            (void)util_array_append(gone, ids[i]);
+            continue;
+        }
+        running = container_is_running(cont->state);
+        if (running) {
+            rt_stats_params_t params = { 0 };
+            params.rootpath = cont->root_path;
+            params.state = cont->state_path;
+
+            if (runtime_resources_stats(cont->common_config->id, cont->runtime, &params, &einfo) != 0) {
+                container_unref(cont);
+                continue;
+            }
+        }
+
+        samples[*samples_len].info = stats_sampler_container_info(cont, &einfo);
+        container_unref(cont);
+        if (samples[*samples_len].info == NULL) {
+            continue;
+        }
+        samples[*samples_len].running = running;
+        (*samples_len)++;
+    }
+
+    return samples;
+}
+
+static void wait_interval(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += STATS_SAMPLER_INTERVAL_MS / 1000;
+    ts.tv_nsec += (STATS_SAMPLER_INTERVAL_MS % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    while (g_sampler.clients > 0) {
+        if (pthread_cond_timedwait(&g_sampler.cond, &g_sampler.mutex, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+}
+
+static void *sampler_thread(void *arg)
+{
+    char **ids = NULL;
+    char **gone = NULL;
+    struct stats_sample *samples = NULL;
+    size_t samples_len = 0;
+    size_t passes = 0;
+    size_t i;
+
+    (void)arg;
+    (void)pthread_detach(pthread_self());
+    (void)prctl(PR_SET_NAME, "StatsSampler");
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    while (g_sampler.clients > 0) {
+        if (passes++ % STATS_SAMPLER_RESYNC_PASSES == 0) {
+            (void)pthread_mutex_unlock(&g_sampler.mutex);
+            ids = containers_store_list_ids();
+            (void)pthread_mutex_lock(&g_sampler.mutex);
+            add_ids(ids);
+            util_free_array(ids);
+        }
+        ids = list_ids();
+        (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+        samples_len = 0;
+        samples = sample_containers(ids, &samples_len, &gone);
+        util_free_array(ids);
+
+        (void)pthread_mutex_lock(&g_sampler.mutex);
+        for (i = 0; gone != NULL && gone[i] != NULL; i++) {
+            (void)map_remove(g_sampler.ids, gone[i]);
+        }
+        util_free_array(gone);
+        gone = NULL;
+        if (samples != NULL) {
+            free_samples(g_sampler.samples, g_sampler.samples_len);
+            g_sampler.samples = samples;
+            g_sampler.samples_len = samples_len;
+            g_sampler.generation++;
+            g_sampler.sampled = true;
+            (void)pthread_cond_broadcast(&g_sampler.cond);
+        }
+
+        wait_interval();
+    }
+
+    g_sampler.started = false;
+    free_samples(g_sampler.samples, g_sampler.samples_len);
+    g_sampler.samples = NULL;
+    g_sampler.samples_len = 0;
+    map_free(g_sampler.ids);
+    g_sampler.ids = NULL;
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    return NULL;
+}
+
+static int start_sampler(void)
+{
+    pthread_t tid;
+
+    g_sampler.ids = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (g_sampler.ids == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    if (pthread_create(&tid, NULL, sampler_thread, NULL) != 0) {
+        ERROR("Failed to start stats sampler");
+        map_free(g_sampler.ids);
+        g_sampler.ids = NULL;
+        return -1;
+    }
+    g_sampler.started = true;
+    g_sampler.sampled = false;
+    g_sampler.epoch++;
+
+    if (pthread_create(&tid, NULL, sampler_events_thread, (void *)(uintptr_t)g_sampler.epoch) != 0) {
+        WARN("Failed to follow events for stats sampler, new containers are found by listing the store");
+    }
+
+    return 0;
+}
+
+stats_sampler_client_t *stats_sampler_join(void)
+{
+    stats_sampler_client_t *client = NULL;
+
+    client = util_common_calloc_s(sizeof(stats_sampler_client_t));
+    if (client == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    if (!g_sampler.started && start_sampler() != 0) {
+        (void)pthread_mutex_unlock(&g_sampler.mutex);
+        free(client);
+        return NULL;
+    }
+    g_sampler.clients++;
+    // the last sample of a running sampler is new to the client
+    client->generation = g_sampler.sampled ? g_sampler.generation - 1 : g_sampler.generation;
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    return client;
+}
+
+bool stats_sampler_wait(stats_sampler_client_t *client, unsigned int timeout_ms)
+{
+    struct timespec ts = { 0 };
+    bool ret = false;
+
+    if (client == NULL) {
+        return false;
+    }
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    while (g_sampler.generation == client->generation) {
+        if (pthread_cond_timedwait(&g_sampler.cond, &g_sampler.mutex, &ts) == ETIMEDOUT) {
+            break;
+        }
+    }
+    ret = (g_sampler.generation != client->generation);
+    client->generation = g_sampler.generation;
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    return ret;
+}
+
+void stats_sampler_foreach(stats_sampler_client_t *client, stats_sample_cb_t cb, void *arg)
+{
+    size_t i;
+
+    if (client == NULL || cb == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    for (i = 0; i < g_sampler.samples_len; i++) {
+        cb(g_sampler.samples[i].info, g_sampler.samples[i].running, arg);
+    }
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+}
+
+void stats_sampler_leave(stats_sampler_client_t *client)
+{
+    if (client == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_sampler.mutex);
+    g_sampler.clients--;
+    // wake the sampler up to stop with the last client
+    (void)pthread_cond_broadcast(&g_sampler.cond);
+    (void)pthread_mutex_unlock(&g_sampler.mutex);
+
+    free(client);
+}
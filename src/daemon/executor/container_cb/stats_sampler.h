@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide shared stats sampler of stats streams
+ ******************************************************************************/
+#ifndef DAEMON_EXECUTOR_CONTAINER_CB_STATS_SAMPLER_H
+#define DAEMON_EXECUTOR_CONTAINER_CB_STATS_SAMPLER_H
+
+#include <stdbool.h>
+#include <isula_libutils/container_info.h>
+
+#include "container_api.h"
+#include "runtime_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the unit test samples faster
+#ifndef STATS_SAMPLER_INTERVAL_MS
+#define STATS_SAMPLER_INTERVAL_MS 1000
+#endif
+
+typedef struct stats_sampler_client stats_sampler_client_t;
+
+typedef void (*stats_sample_cb_t)(const container_info *info, bool running, void *arg);
+
+// stats of cont, einfo is empty if cont is not running
+container_info *stats_sampler_container_info(const container_t *cont,
+                                             const struct runtime_container_resources_stats_info *einfo);
+
+// the sampler runs while it has clients, one pass per interval serves all of them
+stats_sampler_client_t *stats_sampler_join(void);
+
+// wait at most timeout_ms for a sample newer than the last one seen by client
+bool stats_sampler_wait(stats_sampler_client_t *client, unsigned int timeout_ms);
+
+// call cb for each container of the last sample, cb must not block
+void stats_sampler_foreach(stats_sampler_client_t *client, stats_sample_cb_t cb, void *arg);
+
+void stats_sampler_leave(stats_sampler_client_t *client);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_EXECUTOR_CONTAINER_CB_STATS_SAMPLER_H
@@ -119,6 +119,10 @@ int containers_store_list(container_t ***out, size_t *size);
 
 char **containers_store_list_ids(void);
 
+// ids of the containers having all the labels, each label is "key" or "key=value",
+// fails if the label index can not be used and the containers have to be checked one by one
+int containers_store_list_ids_by_labels(const char **labels, size_t labels_len, char ***ids);
+
 /* name indexs */
 int container_name_index_init(void);
 
@@ -30,9 +30,18 @@ int create_daemon_fifos(const char *id, const char *runtime, bool attach_stdin,
 
 void delete_daemon_fifos(const char *fifopath, const char *fifos[]);
 
+/* io copy of one exec/attach, served by the shared io reactor threads */
+typedef struct io_copy_session io_copy_session_t;
+
 int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char *fifoout, const char *fifoerr,
                        int stdin_fd, struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                       const char *fifos[], pthread_t *tid);
+                       const char *fifos[], io_copy_session_t **session);
+
+/* wait until all data of session is copied, and free the session */
+int io_copy_session_wait(io_copy_session_t *session);
+
+/* let session free itself when the copy is done */
+void io_copy_session_detach(io_copy_session_t *session);
 
 #ifdef __cplusplus
 }
@@ -41,6 +41,19 @@
 #define PLUGIN_EVENT_CONTAINER_POST_STOP (1UL << 2)
 #define PLUGIN_EVENT_CONTAINER_POST_REMOVE (1UL << 3)
 
+struct http_conn;
+
+/* counters of event requests to a plugin */
+typedef struct plugin_stats {
+    uint64_t requests;
+    /* requests not answered in time or failed to send */
+    uint64_t failures;
+    /* requests failed fast while the plugin is considered down */
+    uint64_t rejected;
+    uint64_t latency_total_us;
+    uint64_t latency_max_us;
+} plugin_stats_t;
+
 typedef struct plugin_manifest {
     uint64_t init_type;
     uint64_t watch_event;
@@ -58,6 +71,16 @@ typedef struct plugin {
     char *activated_errmsg;
 
     uint64_t ref;
+
+    /* persistent connections of event requests */
+    struct http_conn *conn;
+    /* deadline of each event request */
+    long event_timeout_ms;
+    /* protected by lock */
+    plugin_stats_t stats;
+    /* circuit breaker, requests fail fast until open_until after too many failures in a row */
+    uint32_t consecutive_failures;
+    int64_t open_until;
 } plugin_t;
 
 /*
@@ -71,6 +94,7 @@ void plugin_put(plugin_t *plugin); /* ref-- */
 int plugin_set_activated(plugin_t *plugin, bool activated, const char *errmsg);
 int plugin_set_manifest(plugin_t *plugin, const plugin_manifest_t *manifest);
 bool plugin_is_watching(plugin_t *plugin, uint64_t pe);
+void plugin_get_stats(plugin_t *plugin, plugin_stats_t *stats);
 
 typedef struct plugin_manager {
     pthread_rwlock_t pm_rwlock;
@@ -114,6 +114,8 @@ typedef struct _rt_rm_params_t {
 typedef struct _rt_status_params_t {
     const char *rootpath;
     const char *state;
+    // process the container was running with, if the runtime finds it unchanged it may skip asking the oci runtime
+    const pid_ppid_info_t *last_pid_info;
 } rt_status_params_t;
 
 typedef struct _rt_stats_params_t {
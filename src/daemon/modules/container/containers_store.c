@@ -12,6 +12,7 @@
  * Create: 2017-11-22
  * Description: provide container store functions
  ******************************************************************************/
+#include <stdio.h>
 #include <stdlib.h>
 #include <pthread.h>
 #include <stdbool.h>
@@ -23,9 +24,14 @@
 #include "utils.h"
 #include "map.h"
 #include "utils_array.h"
+#include "metrics.h"
 
 typedef struct memory_store_t {
     map_t *map; // map string container_t
+    // "key" and "key=value" of the labels of the containers to their ids, so that label
+    // filters such as the ones of CRI sandboxes do not need to look at every container
+    map_t *labels; // map string map_t
+    bool labels_incomplete;
     pthread_rwlock_t rwlock;
 } memory_store;
 
@@ -38,6 +44,9 @@ static memory_store *g_containers_store = NULL;
 
 static name_index *g_indexs = NULL;
 
+static metrics_histogram_t *g_store_rdlock_wait = NULL;
+static metrics_histogram_t *g_store_wrlock_wait = NULL;
+
 /* memory store map kvfree */
 static void memory_store_map_kvfree(void *key, void *value)
 {
@@ -46,6 +55,14 @@ static void memory_store_map_kvfree(void *key, void *value)
     container_unref((container_t *)value);
 }
 
+/* label index map kvfree */
+static void label_index_map_kvfree(void *key, void *value)
+{
+    free(key);
+
+    map_free((map_t *)value);
+}
+
 /* memory store free */
 static void memory_store_free(memory_store *store)
 {
@@ -54,6 +71,8 @@ static void memory_store_free(memory_store *store)
     }
     map_free(store->map);
     store->map = NULL;
+    map_free(store->labels);
+    store->labels = NULL;
     pthread_rwlock_destroy(&(store->rwlock));
     free(store);
 }
@@ -75,27 +94,152 @@ static memory_store *memory_store_new(void)
         free(store);
         return NULL;
     }
-    store->map = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, memory_store_map_kvfree);
+    store->map = map_new_hash(MAP_STR_PTR, memory_store_map_kvfree);
     if (store->map == NULL) {
         ERROR("Out of memory");
         goto error_out;
     }
+    store->labels = map_new_hash(MAP_STR_PTR, label_index_map_kvfree);
+    if (store->labels == NULL) {
+        ERROR("Out of memory");
+        goto error_out;
+    }
     return store;
 error_out:
     memory_store_free(store);
     return NULL;
 }
 
+static const json_map_string_string *container_labels(const container_t *cont)
+{
+    if (cont == NULL || cont->common_config == NULL || cont->common_config->config == NULL) {
+        return NULL;
+    }
+    return cont->common_config->config->labels;
+}
+
+static bool label_index_add_one(const char *label, const char *id)
+{
+    bool value = true;
+    map_t *ids = map_search(g_containers_store->labels, (void *)label);
+
+    if (ids == NULL) {
+        ids = map_new_hash(MAP_STR_BOOL, MAP_DEFAULT_FREE_FUNC);
+        if (ids == NULL) {
+            ERROR("Out of memory");
+            return false;
+        }
+        if (!map_insert(g_containers_store->labels, (void *)label, ids)) {
+            ERROR("Failed to insert label %s to index", label);
+            map_free(ids);
+            return false;
+        }
+    }
+
+    return map_replace(ids, (void *)id, &value);
+}
+
+static void label_index_remove_one(const char *label, const char *id)
+{
+    map_t *ids = map_search(g_containers_store->labels, (void *)label);
+
+    if (ids == NULL) {
+        return;
+    }
+    (void)map_remove(ids, (void *)id);
+    if (map_size(ids) == 0) {
+        (void)map_remove(g_containers_store->labels, (void *)label);
+    }
+}
+
+static char *label_index_key(const char *key, const char *value)
+{
+    char *label = NULL;
+    size_t len = strlen(key) + strlen(value) + 2;
+
+    label = util_common_calloc_s(len);
+    if (label == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    (void)snprintf(label, len, "%s=%s", key, value);
+
+    return label;
+}
+
+/* index labels of container id, called with the store locked for write */
+static bool label_index_add(const char *id, const container_t *cont)
+{
+    size_t i;
+    bool ret = true;
+    char *label = NULL;
+    const json_map_string_string *labels = container_labels(cont);
+
+    for (i = 0; labels != NULL && i < labels->len; i++) {
+        label = label_index_key(labels->keys[i], labels->values[i] != NULL ? labels->values[i] : "");
+        if (label == NULL || !label_index_add_one(labels->keys[i], id) || !label_index_add_one(label, id)) {
+            ret = false;
+        }
+        free(label);
+    }
+
+    return ret;
+}
+
+/* remove labels of container id from index, called with the store locked for write */
+static void label_index_remove(const char *id, const container_t *cont)
+{
+    size_t i;
+    char *label = NULL;
+    const json_map_string_string *labels = container_labels(cont);
+
+    for (i = 0; labels != NULL && i < labels->len; i++) {
+        label_index_remove_one(labels->keys[i], id);
+        label = label_index_key(labels->keys[i], labels->values[i] != NULL ? labels->values[i] : "");
+        if (label != NULL) {
+            label_index_remove_one(label, id);
+        }
+        free(label);
+    }
+}
+
+/* lock the memory store, the time waited is recorded if metrics are enabled */
+static int containers_store_lock(bool write)
+{
+    uint64_t start = metrics_now();
+    int nret = 0;
+
+    if (write) {
+        nret = pthread_rwlock_wrlock(&g_containers_store->rwlock);
+        metrics_observe_since(g_store_wrlock_wait, start);
+    } else {
+        nret = pthread_rwlock_rdlock(&g_containers_store->rwlock);
+        metrics_observe_since(g_store_rdlock_wait, start);
+    }
+
+    return nret;
+}
+
 /* containers store add */
 bool containers_store_add(const char *id, container_t *cont)
 {
     bool ret = false;
+    container_t *old = NULL;
 
-    if (pthread_rwlock_wrlock(&g_containers_store->rwlock)) {
+    if (containers_store_lock(true)) {
         ERROR("lock memory store failed");
         return false;
     }
+    old = map_search(g_containers_store->map, (void *)id);
+    if (old != NULL) {
+        label_index_remove(id, old);
+    }
     ret = map_replace(g_containers_store->map, (void *)id, (void *)cont);
+    if (ret && !label_index_add(id, cont)) {
+        // a container missing in the index would not be listed with label filters
+        ERROR("Failed to index labels of container %s, label index disabled", id);
+        g_containers_store->labels_incomplete = true;
+    }
     if (pthread_rwlock_unlock(&g_containers_store->rwlock)) {
         ERROR("unlock memory store failed");
         return false;
@@ -111,7 +255,7 @@ static container_t *containers_store_get_by_id(const char *id)
     if (id == NULL) {
         return NULL;
     }
-    if (pthread_rwlock_rdlock(&g_containers_store->rwlock) != 0) {
+    if (containers_store_lock(false) != 0) {
         ERROR("lock memory store failed");
         return cont;
     }
@@ -158,7 +302,7 @@ container_t *containers_store_get_by_prefix(const char *prefix)
     if (prefix == NULL) {
         return NULL;
     }
-    if (pthread_rwlock_rdlock(&g_containers_store->rwlock) != 0) {
+    if (containers_store_lock(false) != 0) {
         ERROR("lock memory store failed");
         return NULL;
     }
@@ -247,7 +391,7 @@ int containers_store_list(container_t ***out, size_t *size)
     container_t **conts = NULL;
     map_itor *itor = NULL;
 
-    if (pthread_rwlock_rdlock(&g_containers_store->rwlock) != 0) {
+    if (containers_store_lock(false) != 0) {
         ERROR("lock memory store failed");
         return -1;
     }
@@ -299,7 +443,7 @@ char **containers_store_list_ids(void)
     char **idsarray = NULL;
     map_itor *itor = NULL;
 
-    if (pthread_rwlock_rdlock(&g_containers_store->rwlock) != 0) {
+    if (containers_store_lock(false) != 0) {
         ERROR("lock memory store failed");
         return NULL;
     }
@@ -335,15 +479,100 @@ unlock:
     return idsarray;
 }
 
+/* containers store list ids by labels */
+int containers_store_list_ids_by_labels(const char **labels, size_t labels_len, char ***ids)
+{
+    int ret = -1;
+    size_t i;
+    map_t **sets = NULL;
+    map_t *smallest = NULL;
+    map_itor *itor = NULL;
+    char **result = NULL;
+
+    if (labels == NULL || labels_len == 0 || ids == NULL) {
+        ERROR("Invalid arguments");
+        return -1;
+    }
+
+    sets = util_smart_calloc_s(sizeof(map_t *), labels_len);
+    if (sets == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    if (containers_store_lock(false) != 0) {
+        ERROR("lock memory store failed");
+        free(sets);
+        return -1;
+    }
+
+    if (g_containers_store->labels_incomplete) {
+        goto unlock;
+    }
+
+    for (i = 0; i < labels_len; i++) {
+        sets[i] = map_search(g_containers_store->labels, (void *)labels[i]);
+        if (sets[i] == NULL) {
+            // no container has this label
+            ret = 0;
+            goto unlock;
+        }
+        if (smallest == NULL || map_size(sets[i]) < map_size(smallest)) {
+            smallest = sets[i];
+        }
+    }
+
+    itor = map_itor_new(smallest);
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        goto unlock;
+    }
+
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        const char *id = map_itor_key(itor);
+        for (i = 0; i < labels_len; i++) {
+            if (sets[i] != smallest && map_search(sets[i], (void *)id) == NULL) {
+                break;
+            }
+        }
+        if (i < labels_len) {
+            continue;
+        }
+        if (util_array_append(&result, id) != 0) {
+            ERROR("Out of memory");
+            goto unlock;
+        }
+    }
+    ret = 0;
+
+unlock:
+    if (pthread_rwlock_unlock(&g_containers_store->rwlock) != 0) {
+        ERROR("unlock memory store failed");
+    }
+    map_itor_free(itor);
+    free(sets);
+    if (ret != 0) {
+        util_free_array(result);
+        result = NULL;
+    }
+    *ids = result;
+    return ret;
+}
+
 /* containers store remove */
 bool containers_store_remove(const char *id)
 {
     bool ret = false;
+    container_t *cont = NULL;
 
-    if (pthread_rwlock_wrlock(&g_containers_store->rwlock) != 0) {
+    if (containers_store_lock(true) != 0) {
         ERROR("lock memory store failed");
         return false;
     }
+    cont = map_search(g_containers_store->map, (void *)id);
+    if (cont != NULL) {
+        label_index_remove(id, cont);
+    }
     ret = map_remove(g_containers_store->map, (void *)id);
     if (pthread_rwlock_unlock(&g_containers_store->rwlock) != 0) {
         ERROR("unlock memory store failed");
@@ -359,6 +588,8 @@ int containers_store_init(void)
     if (g_containers_store == NULL) {
         return -1;
     }
+    g_store_rdlock_wait = metrics_histogram("isulad_store_lock_wait_seconds", "lock=\"read\",store=\"containers\"");
+    g_store_wrlock_wait = metrics_histogram("isulad_store_lock_wait_seconds", "lock=\"write\",store=\"containers\"");
     return 0;
 }
 
@@ -391,7 +622,7 @@ static name_index *name_index_new(void)
         free(indexs);
         return NULL;
     }
-    indexs->map = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    indexs->map = map_new_hash(MAP_STR_STR, MAP_DEFAULT_FREE_FUNC);
     if (indexs->map == NULL) {
         ERROR("Out of memory");
         goto error_out;
@@ -38,6 +38,7 @@
 #include "utils_array.h"
 #include "utils_file.h"
 #include "utils_timestamp.h"
+#include "utils_trash.h"
 
 /* restore supervisor */
 static int restore_supervisor(const container_t *cont)
@@ -252,12 +253,20 @@ static void restore_state(container_t *cont)
     const char *runtime = cont->runtime;
     rt_status_params_t params = { 0 };
     struct runtime_container_status_info real_status = { 0 };
+    pid_ppid_info_t last_pid_info = { 0 };
     Container_Status status = container_state_get_status(cont->state);
 
     (void)container_exit_on_next(cont); /* cancel restart policy */
 
     params.rootpath = cont->root_path;
     params.state = cont->state_path;
+    if (status == CONTAINER_STATUS_RUNNING) {
+        last_pid_info.pid = cont->state->state->pid;
+        last_pid_info.ppid = cont->state->state->p_pid;
+        last_pid_info.start_time = cont->state->state->start_time;
+        last_pid_info.pstart_time = cont->state->state->p_start_time;
+        params.last_pid_info = &last_pid_info;
+    }
     nret = runtime_status(id, runtime, &params, &real_status);
     if (nret != 0) {
         ERROR("Failed to restore container %s, make real status to STOPPED. Due to can not load container with status %d",
@@ -515,6 +524,14 @@ void containers_restore(void)
     size_t i = 0;
     char *engines_path = NULL;
     char **subdir = NULL;
+    char *isulad_root = NULL;
+
+    // container roots removed before a restart may be left in trash
+    isulad_root = conf_get_isulad_rootdir();
+    if (util_trash_resume(isulad_root) != 0) {
+        WARN("Failed to resume deletion of container trash");
+    }
+    free(isulad_root);
 
     engines_path = conf_get_engine_rootpath();
     if (engines_path == NULL) {
@@ -31,11 +31,13 @@
 #include "events_collector_api.h"
 #include "event_type.h"
 #include "utils_file.h"
+#include "monitord_queue.h"
 
 struct monitored_handler {
     struct epoll_descr *pdescr;
     int fifo_fd;
     char *fifo_path;
+    int queue_fd;
 };
 
 /* monitor event cb */
@@ -60,9 +62,23 @@ out:
     return EPOLL_LOOP_HANDLE_CONTINUE;
 }
 
+/* monitor queue cb: events sent by isulad itself */
+static int monitor_queue_cb(int fd, uint32_t events, void *cbdata, struct epoll_descr *descr)
+{
+    if (monitord_queue_drain(events_handler) > 0 && malloc_trim(0) == 0) {
+        DEBUG("Malloc trim failed");
+    }
+
+    return EPOLL_LOOP_HANDLE_CONTINUE;
+}
+
 /* free monitored */
 static void free_monitored(struct monitored_handler *mhandler)
 {
+    if (mhandler->queue_fd != -1) {
+        monitord_queue_close();
+        epoll_loop_del_handler(mhandler->pdescr, mhandler->queue_fd);
+    }
     if (mhandler->fifo_fd != -1) {
         epoll_loop_del_handler(mhandler->pdescr, mhandler->fifo_fd);
         close(mhandler->fifo_fd);
@@ -90,6 +106,7 @@ static void *monitored(void *arg)
     struct epoll_descr descr;
 
     mhandler.fifo_fd = -1;
+    mhandler.queue_fd = -1;
     ret = pthread_detach(pthread_self());
     if (ret != 0) {
         CRIT("Set thread detach fail");
@@ -143,6 +160,15 @@ static void *monitored(void *arg)
         goto err;
     }
 
+    /* 2. events of isulad itself skip the fifo, they fall back to it if the queue is unavailable */
+    mhandler.queue_fd = monitord_queue_open();
+    if (mhandler.queue_fd != -1 &&
+        epoll_loop_add_handler(&descr, mhandler.queue_fd, monitor_queue_cb, NULL) != 0) {
+        WARN("Failed to add handler for events queue, use fifo only");
+        monitord_queue_close();
+        mhandler.queue_fd = -1;
+    }
+
     sem_post(msync->monitord_sem);
 
     /* loop forever except error occurred */
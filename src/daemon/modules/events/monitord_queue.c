@@ -0,0 +1,181 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide in-process event queue of monitored
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "monitord_queue.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "metrics.h"
+
+/*
+ * Events of the daemon itself are queued here instead of written to the monitor fifo.
+ * The queue is a multi-producer single-consumer linked list: senders exchange the tail
+ * and link the old one to their node, so pushing never blocks or fails because the reader
+ * is slow. monitored is the only consumer. The eventfd is written only by the sender that
+ * finds the queue idle, monitored marks it idle before draining, so no message is left
+ * without a wake up.
+ */
+struct queue_node {
+    struct queue_node *next;
+    struct monitord_msg msg;
+};
+
+static struct {
+    // senders push at tail, monitored pops after head
+    struct queue_node *tail;
+    struct queue_node *head;
+    struct queue_node stub;
+    int efd;
+    bool open;
+    bool signaled;
+    // messages pushed but not handled yet
+    metrics_gauge_t *depth;
+} g_queue = {
+    .efd = -1,
+};
+
+int monitord_queue_open(void)
+{
+    int efd = -1;
+
+    if (g_queue.efd >= 0) {
+        return g_queue.efd;
+    }
+
+    efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (efd < 0) {
+        SYSERROR("Failed to create eventfd of events queue");
+        return -1;
+    }
+
+    g_queue.stub.next = NULL;
+    g_queue.head = &g_queue.stub;
+    g_queue.tail = &g_queue.stub;
+    g_queue.signaled = false;
+    g_queue.depth = metrics_gauge("isulad_event_queue_depth", NULL);
+    g_queue.efd = efd;
+    __atomic_store_n(&g_queue.open, true, __ATOMIC_RELEASE);
+
+    return efd;
+}
+
+void monitord_queue_close(void)
+{
+    __atomic_store_n(&g_queue.open, false, __ATOMIC_RELEASE);
+}
+
+static void queue_link(struct queue_node *node)
+{
+    struct queue_node *prev = NULL;
+
+    node->next = NULL;
+    prev = __atomic_exchange_n(&g_queue.tail, node, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+bool monitord_queue_push(const struct monitord_msg *msg)
+{
+    struct queue_node *node = NULL;
+
+    if (msg == NULL || !__atomic_load_n(&g_queue.open, __ATOMIC_ACQUIRE)) {
+        return false;
+    }
+
+    node = util_common_calloc_s(sizeof(struct queue_node));
+    if (node == NULL) {
+        ERROR("Out of memory");
+        return false;
+    }
+    (void)memcpy(&node->msg, msg, sizeof(struct monitord_msg));
+
+    queue_link(node);
+    metrics_gauge_add(g_queue.depth, 1);
+
+    if (!__atomic_exchange_n(&g_queue.signaled, true, __ATOMIC_ACQ_REL)) {
+        if (eventfd_write(g_queue.efd, 1) != 0) {
+            SYSERROR("Failed to wake up monitored");
+        }
+    }
+
+    return true;
+}
+
+// NULL if empty, or a sender has taken the tail but not linked it yet, it will ring again
+static struct queue_node *queue_pop(void)
+{
+    struct queue_node *head = g_queue.head;
+    struct queue_node *next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+
+    if (head == &g_queue.stub) {
+        if (next == NULL) {
+            return NULL;
+        }
+        g_queue.head = next;
+        head = next;
+        next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    }
+
+    if (next != NULL) {
+        g_queue.head = next;
+        return head;
+    }
+
+    if (head != __atomic_load_n(&g_queue.tail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    // head is the last one, put the stub behind it to take it out
+    queue_link(&g_queue.stub);
+    next = __atomic_load_n(&head->next, __ATOMIC_ACQUIRE);
+    if (next == NULL) {
+        return NULL;
+    }
+    g_queue.head = next;
+    return head;
+}
+
+size_t monitord_queue_drain(monitord_queue_handler_t handler)
+{
+    eventfd_t value = 0;
+    struct queue_node *node = NULL;
+    size_t handled = 0;
+
+    if (g_queue.efd < 0) {
+        return 0;
+    }
+
+    if (eventfd_read(g_queue.efd, &value) != 0 && errno != EAGAIN) {
+        SYSERROR("Failed to read eventfd of events queue");
+    }
+    // pairs with the exchange of senders, nodes linked before it are seen below
+    (void)__atomic_exchange_n(&g_queue.signaled, false, __ATOMIC_ACQ_REL);
+
+    while ((node = queue_pop()) != NULL) {
+        if (handler != NULL) {
+            handler(&node->msg);
+        }
+        free(node);
+        handled++;
+    }
+    metrics_gauge_add(g_queue.depth, -(int64_t)handled);
+
+    return handled;
+}
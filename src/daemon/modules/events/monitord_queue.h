@@ -0,0 +1,45 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide in-process event queue of monitored
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_EVENTS_MONITORD_QUEUE_H
+#define DAEMON_MODULES_EVENTS_MONITORD_QUEUE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "event_type.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*monitord_queue_handler_t)(struct monitord_msg *msg);
+
+// start the queue, returns the eventfd monitored polls, or -1
+int monitord_queue_open(void);
+
+// stop accepting messages, senders fall back to the fifo
+void monitord_queue_close(void);
+
+// queue msg for monitored, false if the queue is not open
+bool monitord_queue_push(const struct monitord_msg *msg);
+
+// consume the doorbell and handle queued messages in order, returns the number handled
+size_t monitord_queue_drain(monitord_queue_handler_t handler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_EVENTS_MONITORD_QUEUE_H
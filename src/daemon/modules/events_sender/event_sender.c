@@ -27,6 +27,7 @@
 #include "event_type.h"
 #include "utils.h"
 #include "utils_file.h"
+#include "monitord_queue.h"
 
 /* isulad monitor fifo send */
 static void isulad_monitor_fifo_send(const struct monitord_msg *msg)
@@ -35,6 +36,10 @@ static void isulad_monitor_fifo_send(const struct monitord_msg *msg)
     ssize_t ret = 0;
     char *fifo_path = NULL;
 
+    if (monitord_queue_push(msg)) {
+        return;
+    }
+
     fifo_path = conf_get_isulad_monitor_fifo_path();
     if (fifo_path == NULL) {
         return;
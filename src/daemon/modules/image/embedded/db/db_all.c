@@ -204,12 +204,10 @@ static int db_read_image_sql(const char *image_name,
                 "image_names.image_name = ? AND "
                 "image_info.rowid = "
                 "image_names.image_rowid";
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_text(stmt, 1, image_name, -1, SQLITE_STATIC);
@@ -229,9 +227,7 @@ static int db_read_image_sql(const char *image_name,
     *image_rowid = w.image_rowid;
 
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -239,15 +235,13 @@ cleanup:
 static int db_add_image_name_sql(const char *image_name, const char *digest, const char *path)
 {
     int ret = 0;
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
     char *sql = "INSERT INTO image_names SELECT  ?1,image_info.rowid"
                 " FROM image_info WHERE image_info.config_digest = ?2 AND "
                 "image_info.config_path = ?3;";
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_text(stmt, 1, image_name, -1, SQLITE_STATIC);
@@ -259,9 +253,7 @@ static int db_add_image_name_sql(const char *image_name, const char *digest, con
     }
 
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
 
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
@@ -271,17 +263,15 @@ static int db_save_image_info_sql(struct db_image *image)
 {
     int ret = 0;
     int64_t layer_num = 0;
-    sqlite3 *db = NULL;
     char *sql = "INSERT INTO image_info"
                 " SELECT ?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11 "
                 " WHERE NOT EXISTS(SELECT rowid FROM image_info WHERE "
                 "image_info.config_digest = ?12 AND "
                 "image_info.config_path = ?13);";
     sqlite3_stmt *stmt = NULL;
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_text(stmt, 1, image->image_type, -1, SQLITE_STATIC);
@@ -304,9 +294,7 @@ static int db_save_image_info_sql(struct db_image *image)
     }
 
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -315,12 +303,10 @@ static int db_delete_image_name_sql(char *name)
 {
     int ret = 0;
     char *sql = "DELETE FROM image_names WHERE image_name = ?;";
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
@@ -329,9 +315,7 @@ static int db_delete_image_name_sql(char *name)
         ret = DB_FAIL;
     }
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -365,19 +349,31 @@ int db_save_image(struct db_image *image)
         goto out;
     }
 
+    if (db_sqlite_begin() != SQLITE_OK) {
+        ret = DB_FAIL;
+        goto out;
+    }
+
     ret = db_save_image_info_sql(image);
     if (ret < 0) {
+        db_sqlite_rollback();
         goto out;
     }
 
     ret = db_add_image_name_sql(image->image_name,
                                 image->config_digest, image->config_path);
     if (ret) {
-        /* Should not error when add image name. If error occurred,
-         * database is abnormal, so do not rollback. */
+        /* Should not error when add image name, drop the image info
+         * added above so that no dangling info is left. */
+        db_sqlite_rollback();
         goto out;
     }
 
+    if (db_sqlite_commit() != SQLITE_OK) {
+        db_sqlite_rollback();
+        ret = DB_FAIL;
+    }
+
 out:
     g_mutex_unlock();
     if (read_image != NULL) {
@@ -417,13 +413,11 @@ static int db_read_image_name_sql(char *name,
                                   struct db_image_name **imagename)
 {
     int ret = 0;
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
     char *sql = "SELECT * FROM image_names WHERE image_name = ?";
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
@@ -434,9 +428,7 @@ static int db_read_image_name_sql(char *name,
         }
     }
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -445,12 +437,11 @@ static int db_read_image_rowid_sql(long long rowid,
                                    struct db_image_name **imagename)
 {
     int ret = 0;
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
     char *sql = "SELECT * FROM image_names WHERE image_rowid = ?";
-    db = get_global_db();
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_int64(stmt, 1, rowid);
@@ -461,9 +452,7 @@ static int db_read_image_rowid_sql(long long rowid,
         }
     }
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -504,14 +493,12 @@ out:
 static int db_delete_image_info_sql(long long image_rowid)
 {
     int ret = 0;
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
     char *sql = "DELETE FROM image_info WHERE rowid = ?1 AND NOT EXISTS"
                 " (SELECT rowid FROM image_names WHERE image_rowid = ?2);";
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     sqlite3_bind_int64(stmt, 1, image_rowid);
@@ -522,9 +509,7 @@ static int db_delete_image_info_sql(long long image_rowid)
         ret = DB_FAIL;
     }
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -552,16 +537,28 @@ int db_delete_image(char *name, bool force)
         goto out;
     }
 
+    if (db_sqlite_begin() != SQLITE_OK) {
+        ret = DB_FAIL;
+        goto out;
+    }
+
     ret = db_delete_image_name_sql(name);
     if (ret < 0) {
+        db_sqlite_rollback();
         goto out;
     }
 
     ret = db_delete_image_info_sql(imagename->image_rowid);
     if (ret < 0) {
+        db_sqlite_rollback();
         goto out;
     }
 
+    if (db_sqlite_commit() != SQLITE_OK) {
+        db_sqlite_rollback();
+        ret = DB_FAIL;
+    }
+
 out:
     g_mutex_unlock();
 
@@ -573,17 +570,15 @@ out:
 static int db_exec_sql(const char *sql)
 {
     int ret = 0;
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
 
     if (sql == NULL || strlen(sql) == 0) {
         return DB_FAIL;
     }
 
-    db = get_global_db();
-    ret = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to prepare SQL");
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        ret = DB_FAIL;
         goto cleanup;
     }
     if (sqlite3_step(stmt) != SQLITE_DONE) {
@@ -591,9 +586,7 @@ static int db_exec_sql(const char *sql)
         ret = DB_FAIL;
     }
 cleanup:
-    if (stmt && (sqlite3_finalize(stmt) != SQLITE_OK)) {
-        ERROR("Failed to finalize sqlite3_stmt");
-    }
+    db_sqlite_stmt_put(stmt);
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
@@ -621,6 +614,10 @@ static int db_delete_dangling_image_no_lock()
 {
     int ret = 0;
 
+    if (db_sqlite_begin() != SQLITE_OK) {
+        return DB_FAIL;
+    }
+
     ret = db_delete_dangling_image_name_sql();
     if (ret) {
         goto out;
@@ -631,7 +628,14 @@ static int db_delete_dangling_image_no_lock()
         goto out;
     }
 
+    if (db_sqlite_commit() != SQLITE_OK) {
+        ret = DB_FAIL;
+    }
+
 out:
+    if (ret) {
+        db_sqlite_rollback();
+    }
     return ret;
 }
 
@@ -755,30 +759,30 @@ int db_read_all_images_info_sql(struct db_all_images **image_info)
                 "image_info.mount_string,"
                 "image_info.config"
                 " FROM image_info";
-    sqlite3 *db = NULL;
     sqlite3_stmt *stmt = NULL;
-    db = get_global_db();
-    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
-        if (stmt != NULL) {
-            ERROR("Failed to prepare SQL");
-            sqlite3_finalize(stmt);
-            return DB_FAIL;
-        }
+    stmt = db_sqlite_stmt_get(sql);
+    if (stmt == NULL) {
+        return DB_FAIL;
     }
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
+    while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
         if (read_all_images_info(stmt, (void **)&w) != DB_OK) {
             ERROR("Failed to read image info");
             if (w != NULL) {
                 db_all_imginfo_free(w);
             }
-            sqlite3_finalize(stmt);
+            db_sqlite_stmt_put(stmt);
             return DB_FAIL;
         }
     }
-    ret = sqlite3_finalize(stmt);
-    if (ret != SQLITE_OK) {
-        ERROR("Failed to finalize sqlite3_stmt");
+    db_sqlite_stmt_put(stmt);
+    if (ret != SQLITE_DONE) {
+        ERROR("Failed to read all images info");
+        if (w != NULL) {
+            db_all_imginfo_free(w);
+        }
+        return DB_FAIL;
     }
+    ret = SQLITE_OK;
 
     *image_info = w;
 
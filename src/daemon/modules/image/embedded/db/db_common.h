@@ -15,6 +15,10 @@
 #ifndef DAEMON_MODULES_IMAGE_EMBEDDED_DB_DB_COMMON_H
 #define DAEMON_MODULES_IMAGE_EMBEDDED_DB_DB_COMMON_H
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define DB_OUT_OF_MEMORY        -3
 #define DB_INVALID_PARAM        -2
 #define DB_FAIL                 -1
@@ -25,9 +29,13 @@
 #define DB_DEREF_ONLY           4
 #define DB_NOT_EXIST            5
 
-int db_common_init(const char *rootpath);
+int db_common_init(const char *rootpath, const char *synchronous);
 
 void db_common_finish(void);
 
+#ifdef __cplusplus
+}
+#endif
+
 #endif // DAEMON_MODULES_IMAGE_EMBEDDED_DB_DB_COMMON_H
 
@@ -14,7 +14,10 @@
  ******************************************************************************/
 #include "sqlite_common.h"
 #include <limits.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <unistd.h>
 #include <sys/stat.h>
 
@@ -30,8 +33,28 @@
 #define ISULA_SQLITE_PAGECACHE_SIZE 4096
 #define ISULA_SQLITE_PAGECACHE_NUM 8
 
+// WAL keeps more pages around than the rollback journal, a tiny limit makes
+// sqlite drop its cache on every statement
+#define ISULA_SQLITE_SOFT_HEAP_LIMIT (2 * 1024 * 1024)
+
+// used without "image-db-synchronous" in daemon.json, NORMAL syncs the WAL only at
+// checkpoints, a power loss may lose the last transactions but never corrupts the database
+#define ISULA_SQLITE_DEFAULT_SYNCHRONOUS "NORMAL"
+
+// the embedded image module uses about ten distinct statements
+#define ISULA_SQLITE_STMT_CACHE_SIZE 32
+
 sqlite3 *g_db = NULL;
 
+static struct {
+    pthread_mutex_t mutex;
+    const char *sql[ISULA_SQLITE_STMT_CACHE_SIZE];
+    sqlite3_stmt *stmt[ISULA_SQLITE_STMT_CACHE_SIZE];
+    size_t len;
+} g_stmt_cache = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
 sqlite3 *get_global_db()
 {
     return g_db;
@@ -52,19 +75,125 @@ int db_sqlite_init(const char *dbpath)
         ERROR("Change mode of db file failed: %s", strerror(errno));
         goto cleanup;
     }
+    if (sqlite3_busy_timeout(g_db, ISULA_SQLITE_BUSY_TIMEOUT) != SQLITE_OK) {
+        ERROR("Falied to set sqlite busy timeout");
+        goto cleanup;
+    }
     return 0;
 cleanup:
     if (g_db != NULL) {
         (void)sqlite3_close(g_db);
+        g_db = NULL;
     }
     return -1;
 }
 
+static void stmt_cache_clear(void)
+{
+    size_t i;
+
+    (void)pthread_mutex_lock(&g_stmt_cache.mutex);
+    for (i = 0; i < g_stmt_cache.len; i++) {
+        (void)sqlite3_finalize(g_stmt_cache.stmt[i]);
+        g_stmt_cache.stmt[i] = NULL;
+        g_stmt_cache.sql[i] = NULL;
+    }
+    g_stmt_cache.len = 0;
+    (void)pthread_mutex_unlock(&g_stmt_cache.mutex);
+}
+
 /* db sqlite finish */
 void db_sqlite_finish(void)
 {
+    stmt_cache_clear();
     if (g_db != NULL) {
         (void)sqlite3_close(g_db);
+        g_db = NULL;
+    }
+}
+
+sqlite3_stmt *db_sqlite_stmt_get(const char *sql)
+{
+    sqlite3_stmt *stmt = NULL;
+    size_t i;
+
+    if (sql == NULL) {
+        return NULL;
+    }
+
+    (void)pthread_mutex_lock(&g_stmt_cache.mutex);
+    for (i = 0; i < g_stmt_cache.len; i++) {
+        if (g_stmt_cache.sql[i] == sql || strcmp(g_stmt_cache.sql[i], sql) == 0) {
+            stmt = g_stmt_cache.stmt[i];
+            goto out;
+        }
+    }
+
+    if (sqlite3_prepare_v2(g_db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        ERROR("Failed to prepare SQL %s: %s", sql, sqlite3_errmsg(g_db));
+        (void)sqlite3_finalize(stmt);
+        stmt = NULL;
+        goto out;
+    }
+    // a full cache still works, the statement is finalized on put
+    if (g_stmt_cache.len < ISULA_SQLITE_STMT_CACHE_SIZE) {
+        g_stmt_cache.sql[g_stmt_cache.len] = sql;
+        g_stmt_cache.stmt[g_stmt_cache.len] = stmt;
+        g_stmt_cache.len++;
+    }
+
+out:
+    (void)pthread_mutex_unlock(&g_stmt_cache.mutex);
+    return stmt;
+}
+
+void db_sqlite_stmt_put(sqlite3_stmt *stmt)
+{
+    bool cached = false;
+    size_t i;
+
+    if (stmt == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_stmt_cache.mutex);
+    for (i = 0; i < g_stmt_cache.len; i++) {
+        if (g_stmt_cache.stmt[i] == stmt) {
+            cached = true;
+            break;
+        }
+    }
+    (void)pthread_mutex_unlock(&g_stmt_cache.mutex);
+
+    if (!cached) {
+        (void)sqlite3_finalize(stmt);
+        return;
+    }
+    // the error of the last step is returned by reset again, it was reported by the caller
+    (void)sqlite3_reset(stmt);
+    (void)sqlite3_clear_bindings(stmt);
+}
+
+/* take the write lock at once, a deferred transaction fails with busy
+ * instead of waiting when it has to upgrade its read lock */
+int db_sqlite_begin(void)
+{
+    return db_sqlite_request("BEGIN IMMEDIATE;");
+}
+
+int db_sqlite_commit(void)
+{
+    return db_sqlite_request("COMMIT;");
+}
+
+void db_sqlite_rollback(void)
+{
+    // sqlite may have rolled back itself after an error
+    if (sqlite3_get_autocommit(g_db)) {
+        return;
+    }
+    if (db_sqlite_request("ROLLBACK;") != SQLITE_OK) {
+        ERROR("Failed to rollback transaction");
     }
 }
 
@@ -150,8 +279,78 @@ int db_integrity_check()
     return (ret == SQLITE_OK) ? DB_OK : DB_FAIL;
 }
 
-/* db common init */
-int db_common_init(const char *rootpath)
+/* Callback for sql request of 'PRAGMA journal_mode' */
+static int callback_journal_mode_result(void *data, int argc, char **argv, char **colname)
+{
+    // the old mode is returned if the database can not change to WAL, e.g. without shared memory
+    if (argc == 1 && argv[0] != NULL && strcasecmp(argv[0], "wal") != 0) {
+        WARN("Database journal mode is %s instead of wal", argv[0]);
+    }
+    return 0;
+}
+
+static const char *db_synchronous_level(const char *level)
+{
+    const char *levels[] = { "OFF", "NORMAL", "FULL", "EXTRA" };
+    size_t i;
+
+    if (level == NULL || strlen(level) == 0) {
+        return ISULA_SQLITE_DEFAULT_SYNCHRONOUS;
+    }
+
+    for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++) {
+        if (strcasecmp(level, levels[i]) == 0) {
+            return levels[i];
+        }
+    }
+
+    WARN("Invalid database synchronous level %s, use %s", level, ISULA_SQLITE_DEFAULT_SYNCHRONOUS);
+    return ISULA_SQLITE_DEFAULT_SYNCHRONOUS;
+}
+
+/* use WAL, writers append to the log instead of syncing the journal and the database */
+static int db_set_journal(const char *synchronous)
+{
+    char stmt[64] = { 0 };
+    int nret = 0;
+
+    if (db_sqlite_request_callback("PRAGMA journal_mode=WAL;", callback_journal_mode_result, NULL) != SQLITE_OK) {
+        ERROR("Failed to set journal mode");
+        return -1;
+    }
+
+    nret = snprintf(stmt, sizeof(stmt), "PRAGMA synchronous=%s;", db_synchronous_level(synchronous));
+    if (nret < 0 || (size_t)nret >= sizeof(stmt)) {
+        ERROR("Failed to print string");
+        return -1;
+    }
+    if (db_sqlite_request(stmt) != SQLITE_OK) {
+        ERROR("Failed to set synchronous level");
+        return -1;
+    }
+
+    return 0;
+}
+
+static void db_remove_files(const char *dbpath)
+{
+    const char *suffixes[] = { "-wal", "-shm" };
+    char path[PATH_MAX] = { 0 };
+    size_t i;
+    int nret = 0;
+
+    (void)unlink(dbpath);
+    for (i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+        nret = snprintf(path, sizeof(path), "%s%s", dbpath, suffixes[i]);
+        if (nret < 0 || (size_t)nret >= sizeof(path)) {
+            continue;
+        }
+        (void)unlink(path);
+    }
+}
+
+/* db common init, synchronous is the level of "PRAGMA synchronous", NULL for the default */
+int db_common_init(const char *rootpath, const char *synchronous)
 {
     int ret = 0;
     int nret = 0;
@@ -163,10 +362,11 @@ int db_common_init(const char *rootpath)
         ERROR("Failed to print string");
         return -1;
     }
+    // sqlite can only be configured before it is initialized, a database opened again keeps the first page cache
     ret = sqlite3_config(SQLITE_CONFIG_PAGECACHE, NULL, ISULA_SQLITE_PAGECACHE_SIZE,
                          ISULA_SQLITE_PAGECACHE_NUM);
     if (ret != SQLITE_OK) {
-        goto open_new_db;
+        DEBUG("Failed to config sqlite page cache: %d", ret);
     }
 
 try_open_db:
@@ -185,7 +385,12 @@ try_open_db:
         goto open_new_db;
     }
 
-    (void)sqlite3_soft_heap_limit64(65536);
+    if (db_set_journal(synchronous) != 0) {
+        db_common_finish();
+        return -1;
+    }
+
+    (void)sqlite3_soft_heap_limit64(ISULA_SQLITE_SOFT_HEAP_LIMIT);
     INFO("sqlite3 used size: %lld", sqlite3_memory_used());
 
     return 0;
@@ -196,7 +401,7 @@ open_new_db:
         /* We can delete database file safely because user will
          * reload image if image not found. Only image managerment
          * module is using database currently. */
-        (void)unlink(dbpath);
+        db_remove_files(dbpath);
         ERROR("Delete database file %s because database broken detected", dbpath);
 
         retry = false;
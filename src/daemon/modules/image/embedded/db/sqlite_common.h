@@ -17,6 +17,10 @@
 
 #include <sqlite3.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 #define DBNAME "sqlite.db"
 
 typedef int(*sqlite_callback_t)(void *, int, char **, char **);
@@ -32,5 +36,23 @@ int db_sqlite_request(const char *stmt);
 int db_sqlite_request_callback(const char *stmt,
                                sqlite_callback_t callback, void *data);
 
+/* Prepared statement of sql, kept until the database is closed. sql must be a
+ * string constant, callers serialize the use of a statement and give it back
+ * with db_sqlite_stmt_put, which resets it and clears its bindings. */
+sqlite3_stmt *db_sqlite_stmt_get(const char *sql);
+
+void db_sqlite_stmt_put(sqlite3_stmt *stmt);
+
+/* Statements between begin and commit are written and synced once. */
+int db_sqlite_begin(void);
+
+int db_sqlite_commit(void);
+
+void db_sqlite_rollback(void);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
 
@@ -26,6 +26,7 @@
 #include "isula_libutils/log.h"
 #include "lim.h"
 #include "embedded_config_merge.h"
+#include "isulad_config.h"
 #include "db_all.h"
 #include "utils.h"
 #include "err_msg.h"
@@ -310,12 +311,18 @@ int embedded_inspect_image(const im_inspect_request *request, char **inspected_j
 
 int embedded_init(const isulad_daemon_configs *args)
 {
+    int ret = 0;
+    char *db_synchronous = NULL;
+
     if (args == NULL) {
         ERROR("Invalid image configs");
         return -1;
     }
 
-    return lim_init(args->graph);
+    db_synchronous = conf_get_image_db_synchronous();
+    ret = lim_init(args->graph, db_synchronous);
+    free(db_synchronous);
+    return ret;
 }
 
 void embedded_exit()
@@ -30,7 +30,7 @@
 #include "sha256.h"
 
 /* lim init */
-int lim_init(const char *rootpath)
+int lim_init(const char *rootpath, const char *db_synchronous)
 {
     int ret = 0;
 
@@ -39,7 +39,7 @@ int lim_init(const char *rootpath)
         return -1;
     }
 
-    if (db_common_init(rootpath)) {
+    if (db_common_init(rootpath, db_synchronous)) {
         ERROR("Failed to init database");
         ret = -1;
         goto out;
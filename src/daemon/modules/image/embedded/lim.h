@@ -38,7 +38,7 @@ struct image_info {
     char *config_digest;        /* sha256 digest of image's config */
 };
 
-int lim_init(const char *rootpath);
+int lim_init(const char *rootpath, const char *db_synchronous);
 
 int lim_create_image_start(char *name, char *type, struct image_creator **pic);
 
@@ -40,6 +40,7 @@
 #include "io_wrapper.h"
 #include "utils_array.h"
 #include "utils_file.h"
+#include "util_gzip.h"
 #include "utils_verify.h"
 #include "oci_image.h"
 
@@ -630,7 +631,7 @@ out:
 static int check_and_set_digest_from_tarball(load_layer_blob_t *layer, const char *conf_diff_id)
 {
     int ret = 0;
-    bool gzip = false;
+    compression_type_t compression = COMPRESSION_NONE;
 
     if (layer == NULL || conf_diff_id == NULL) {
         ERROR("Invalid input param");
@@ -652,13 +653,14 @@ static int check_and_set_digest_from_tarball(load_layer_blob_t *layer, const cha
         goto out;
     }
 
-    if (util_gzip_compressed(layer->fpath, &gzip) != 0) {
-        ERROR("Judge layer file gzip attr err");
+    if (util_detect_compression(layer->fpath, &compression) != 0) {
+        ERROR("Judge layer file compression attr err");
         ret = -1;
         goto out;
     }
 
-    layer->compressed_digest = gzip ? sha256_full_file_digest(layer->fpath) : util_strdup_s(layer->diff_id);
+    layer->compressed_digest = compression != COMPRESSION_NONE ? sha256_full_file_digest(layer->fpath) :
+                               util_strdup_s(layer->diff_id);
     if (layer->compressed_digest == NULL) {
         ERROR("Calc layer %s compressed digest failed", layer->fpath);
         ret = -1;
@@ -49,10 +49,12 @@
 #include "constants.h"
 #include "utils_images.h"
 #include "utils_file.h"
+#include "util_gzip.h"
 #include "utils_string.h"
 #include "utils_timestamp.h"
 #include "utils_verify.h"
 #include "oci_image.h"
+#include "metrics.h"
 
 #define MANIFEST_BIG_DATA_KEY "manifest"
 #define MAX_CONCURRENT_DOWNLOAD_NUM 5
@@ -94,6 +96,12 @@ typedef struct {
 
 static registry_global *g_shared;
 
+// resolved once in registry_init, updated on every pull
+static metrics_histogram_t *g_layer_unpack_seconds = NULL;
+static metrics_counter_t *g_layer_unpack_bytes = NULL;
+static metrics_histogram_t *g_image_pull_seconds = NULL;
+static metrics_counter_t *g_image_pull_bytes = NULL;
+
 static void free_file_elem(file_elem *elem)
 {
     if (elem != NULL) {
@@ -226,6 +234,21 @@ out:
     return ret;
 }
 
+static bool oci_layer_media_type_supported(const char *media_type)
+{
+    if (strcmp(media_type, OCI_IMAGE_LAYER_TAR_GZIP) == 0 || strcmp(media_type, OCI_IMAGE_LAYER_TAR) == 0 ||
+        strcmp(media_type, OCI_IMAGE_LAYER_ND_TAR) == 0 || strcmp(media_type, OCI_IMAGE_LAYER_ND_TAR_GZIP) == 0) {
+        return true;
+    }
+
+    // zstd layers need a zstd codec both to unpack and to calculate their diff ids
+    if (strcmp(media_type, OCI_IMAGE_LAYER_TAR_ZSTD) == 0 || strcmp(media_type, OCI_IMAGE_LAYER_ND_TAR_ZSTD) == 0) {
+        return util_compression_supported(COMPRESSION_ZSTD);
+    }
+
+    return false;
+}
+
 static int parse_manifest_ociv1(pull_descriptor *desc)
 {
     oci_image_manifest *manifest = NULL;
@@ -258,10 +281,7 @@ static int parse_manifest_ociv1(pull_descriptor *desc)
     }
 
     for (i = 0; i < manifest->layers_len; i++) {
-        if (strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_TAR_GZIP) &&
-            strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_TAR) &&
-            strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_ND_TAR) &&
-            strcmp(manifest->layers[i]->media_type, OCI_IMAGE_LAYER_ND_TAR_GZIP)) {
+        if (!oci_layer_media_type_supported(manifest->layers[i]->media_type)) {
             ERROR("Unsupported layer's media type %s, layer index %zu", manifest->layers[i]->media_type, i);
             ret = -1;
             goto out;
@@ -584,6 +604,7 @@ static int register_layer(pull_descriptor *desc, size_t i)
     struct layer *l = NULL;
     char *id = NULL;
     cached_layer *cached = NULL;
+    uint64_t start = 0;
 
     if (desc == NULL) {
         ERROR("Invalid NULL pointer");
@@ -630,10 +651,15 @@ static int register_layer(pull_descriptor *desc, size_t i)
         .writable = false,
         .layer_data_path = desc->layers[i].file,
     };
+    start = metrics_now();
     if (storage_layer_create(id, &copts) != 0) {
         ERROR("create layer %s failed, parent %s, file %s", id, desc->parent_layer_id, desc->layers[i].file);
         return -1;
     }
+    if (start != 0) {
+        metrics_observe_since(g_layer_unpack_seconds, start);
+        metrics_counter_add(g_layer_unpack_bytes, desc->layers[i].size);
+    }
     desc->layers[i].registered = true;
     free(desc->layer_of_hold_refs);
     desc->layer_of_hold_refs = util_strdup_s(id);
@@ -1995,11 +2021,27 @@ static void try_rollback_layers(pull_descriptor *desc)
     }
 }
 
+// the bytes downloaded by a pull, layers already in the store are not fetched
+static uint64_t pulled_bytes(const pull_descriptor *desc)
+{
+    uint64_t bytes = desc->config.size;
+    size_t i = 0;
+
+    for (i = 0; i < desc->layers_len; i++) {
+        if (!desc->layers[i].already_exist) {
+            bytes += desc->layers[i].size;
+        }
+    }
+
+    return bytes;
+}
+
 int registry_pull(registry_pull_options *options)
 {
     int ret = 0;
     pull_descriptor *desc = NULL;
     bool reuse = false;
+    uint64_t start = metrics_now();
 
     if (options == NULL || options->image_name == NULL) {
         ERROR("Invalid NULL param");
@@ -2039,6 +2081,10 @@ int registry_pull(registry_pull_options *options)
     }
 
     INFO("Pull images %s success", options->image_name);
+    if (start != 0) {
+        metrics_observe_since(g_image_pull_seconds, start);
+        metrics_counter_add(g_image_pull_bytes, pulled_bytes(desc));
+    }
 
 out:
     if (desc->layer_of_hold_refs != NULL && storage_dec_hold_refs(desc->layer_of_hold_refs) != 0) {
@@ -2089,6 +2135,11 @@ int registry_init(char *auths_dir, char *certs_dir)
     auths_set_dir(auths_dir);
     certs_set_dir(certs_dir);
 
+    g_layer_unpack_seconds = metrics_histogram("isulad_layer_unpack_seconds", NULL);
+    g_layer_unpack_bytes = metrics_counter("isulad_layer_unpack_bytes_total", NULL);
+    g_image_pull_seconds = metrics_histogram("isulad_image_pull_seconds", NULL);
+    g_image_pull_bytes = metrics_counter("isulad_image_pull_bytes_total", NULL);
+
     g_shared = util_common_calloc_s(sizeof(registry_global));
     if (g_shared == NULL) {
         ERROR("out of memory");
@@ -50,6 +50,8 @@
 #include "image_type.h"
 #include "linked_list.h"
 #include "utils_verify.h"
+#include "storage_index.h"
+#include "metrics.h"
 
 // the name of the big data item whose contents we consider useful for computing a "digest" of the
 // image, by which we can locate the image later.
@@ -82,8 +84,11 @@ enum lock_type { SHARED = 0, EXCLUSIVE };
 
 image_store_t *g_image_store = NULL;
 
+static metrics_histogram_t *g_image_store_lock_wait[2] = { NULL, NULL };
+
 static inline bool image_store_lock(enum lock_type type)
 {
+    uint64_t start = metrics_now();
     int nret = 0;
 
     if (type == SHARED) {
@@ -91,6 +96,7 @@ static inline bool image_store_lock(enum lock_type type)
     } else {
         nret = pthread_rwlock_wrlock(&g_image_store->rwlock);
     }
+    metrics_observe_since(g_image_store_lock_wait[type], start);
     if (nret != 0) {
         ERROR("Lock memory store failed: %s", strerror(nret));
         return false;
@@ -2856,12 +2862,12 @@ out:
     return ret;
 }
 
-static int do_append_image(storage_image *im)
+static int do_append_image(storage_image *im, const char *spec_data)
 {
     image_t *img = NULL;
     struct linked_list *item = NULL;
 
-    img = new_image(im, g_image_store->dir);
+    img = new_image_with_spec(im, spec_data, g_image_store->dir);
     if (img == NULL) {
         ERROR("Out of memory");
         return -1;
@@ -2948,7 +2954,60 @@ static int append_image_by_directory(const char *image_dir)
         goto out;
     }
 
-    if (do_append_image(im) != 0) {
+    if (do_append_image(im, NULL) != 0) {
+        ERROR("Failed to append images");
+        ret = -1;
+        goto out;
+    }
+
+    im = NULL;
+
+out:
+    free_storage_image(im);
+    free(err);
+    return ret;
+}
+
+/*
+ * An image is in the index only if it was loaded before, so its manifest is not checked
+ * for v1 again. Returns 1 if the image is not indexed or its files changed since.
+ */
+static int append_image_from_index(storage_index_t *index, const char *id)
+{
+    int ret = 0;
+    const char *image_json = NULL;
+    char *spec_name = NULL;
+    storage_image *im = NULL;
+    parser_error err = NULL;
+
+    if (storage_index_get(index, id, IMAGE_DIGEST_BIG_DATA_KEY) == NULL) {
+        return 1;
+    }
+    image_json = storage_index_get(index, id, IMAGE_JSON);
+    if (image_json == NULL) {
+        return 1;
+    }
+
+    im = storage_image_parse_data(image_json, NULL, &err);
+    if (im == NULL) {
+        WARN("Failed to parse indexed image %s: %s", id, err);
+        ret = 1;
+        goto out;
+    }
+
+    spec_name = image_spec_base_name(id);
+    if (spec_name == NULL) {
+        ret = 1;
+        goto out;
+    }
+
+    if (strip_default_hostname(im) != 0) {
+        ERROR("Failed to strip default hostname");
+        ret = -1;
+        goto out;
+    }
+
+    if (do_append_image(im, storage_index_get(index, id, spec_name)) != 0) {
         ERROR("Failed to append images");
         ret = -1;
         goto out;
@@ -2958,10 +3017,35 @@ static int append_image_by_directory(const char *image_dir)
 
 out:
     free_storage_image(im);
+    free(spec_name);
     free(err);
     return ret;
 }
 
+static void save_images_index(storage_index_t *index)
+{
+    struct linked_list *item = NULL;
+    struct linked_list *next = NULL;
+    char *spec_name = NULL;
+
+    linked_list_for_each_safe(item, &(g_image_store->images_list), next) {
+        image_t *img = (image_t *)item->elem;
+
+        // left out images are loaded from their json files
+        spec_name = image_spec_base_name(img->simage->id);
+        if (spec_name == NULL || storage_index_add(index, img->simage->id, IMAGE_DIGEST_BIG_DATA_KEY) != 0 ||
+            storage_index_add(index, img->simage->id, IMAGE_JSON) != 0 ||
+            storage_index_add(index, img->simage->id, spec_name) != 0) {
+            WARN("Failed to add image %s to index", img->simage->id);
+        }
+        free(spec_name);
+    }
+
+    if (storage_index_save(index) != 0) {
+        WARN("Failed to save index of images");
+    }
+}
+
 static int with_valid_converted_config(const char *path, bool *valid)
 {
     int ret = 0;
@@ -3419,6 +3503,7 @@ static int get_images_from_json()
     size_t i;
     char *id_patten = "^[a-f0-9]{64}$";
     char image_path[PATH_MAX] = { 0x00 };
+    storage_index_t *index = NULL;
 
     ret = util_list_all_subdir(g_image_store->dir, &image_dirs);
     if (ret != 0) {
@@ -3427,6 +3512,7 @@ static int get_images_from_json()
     }
     image_dirs_num = util_array_len((const char **)image_dirs);
 
+    index = storage_index_open(g_image_store->dir);
     for (i = 0; i < image_dirs_num; i++) {
         bool valid_v1_image = false;
 
@@ -3437,6 +3523,15 @@ static int get_images_from_json()
         }
 
         DEBUG("Restore the images:%s", image_dirs[i]);
+        nret = append_image_from_index(index, image_dirs[i]);
+        if (nret == 0) {
+            continue;
+        }
+        if (nret < 0) {
+            ERROR("Found indexed image but load failed: %s", image_dirs[i]);
+            continue;
+        }
+
         nret = snprintf(image_path, sizeof(image_path), "%s/%s", g_image_store->dir, image_dirs[i]);
         if (nret < 0 || (size_t)nret >= sizeof(image_path)) {
             ERROR("Failed to get image path");
@@ -3461,7 +3556,13 @@ static int get_images_from_json()
         }
     }
 
+    // many images changed since the index was saved, e.g. the daemon was killed
+    if (storage_index_need_save(index)) {
+        save_images_index(index);
+    }
+
 out:
+    storage_index_free(index);
     util_free_array(image_dirs);
     return ret;
 }
@@ -3545,6 +3646,9 @@ int image_store_init(struct storage_module_init_options *opts)
         ret = -1;
         goto out;
     }
+    g_image_store_lock_wait[SHARED] = metrics_histogram("isulad_store_lock_wait_seconds", "lock=\"read\",store=\"images\"");
+    g_image_store_lock_wait[EXCLUSIVE] =
+        metrics_histogram("isulad_store_lock_wait_seconds", "lock=\"write\",store=\"images\"");
 
     g_image_store->dir = root_dir;
     root_dir = NULL;
@@ -3552,21 +3656,21 @@ int image_store_init(struct storage_module_init_options *opts)
     g_image_store->images_list_len = 0;
     linked_list_init(&g_image_store->images_list);
 
-    g_image_store->byid = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_field_kvfree);
+    g_image_store->byid = map_new_hash(MAP_STR_PTR, image_store_field_kvfree);
     if (g_image_store->byid == NULL) {
         ERROR("Out of memory");
         ret = -1;
         goto out;
     }
 
-    g_image_store->byname = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_field_kvfree);
+    g_image_store->byname = map_new_hash(MAP_STR_PTR, image_store_field_kvfree);
     if (g_image_store->byname == NULL) {
         ERROR("Out of memory");
         ret = -1;
         goto out;
     }
 
-    g_image_store->bydigest = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, image_store_digest_field_kvfree);
+    g_image_store->bydigest = map_new_hash(MAP_STR_PTR, image_store_digest_field_kvfree);
     if (g_image_store->bydigest == NULL) {
         ERROR("Out of memory");
         ret = -1;
@@ -3588,3 +3692,24 @@ out:
     free(root_dir);
     return ret;
 }
+
+void image_store_exit()
+{
+    storage_index_t *index = NULL;
+
+    if (g_image_store == NULL) {
+        return;
+    }
+
+    // save the index used by next start
+    if (!image_store_lock(SHARED)) {
+        ERROR("Failed to lock image store");
+        return;
+    }
+    index = storage_index_open(g_image_store->dir);
+    if (index != NULL) {
+        save_images_index(index);
+    }
+    image_store_unlock();
+    storage_index_free(index);
+}
@@ -104,6 +104,9 @@ size_t image_store_get_images_number();
 // Retrieves image file system info
 int image_store_get_fs_info(imagetool_fs_info *fs_info);
 
+// Save the startup index of image store
+void image_store_exit();
+
 // Free memory of image store, but will not delete the persisted files
 void image_store_free();
 
@@ -44,30 +44,45 @@ err_out:
     return NULL;
 }
 
-int try_fill_image_spec(image_t *img, const char *id, const char *image_store_dir)
+char *image_spec_base_name(const char *id)
 {
-    int ret = 0;
-    int nret = 0;
     char *base_name = NULL;
-    char *config_file = NULL;
     char *sha256_key = NULL;
-    parser_error err = NULL;
 
-    if (img == NULL || id == NULL || image_store_dir == NULL) {
-        return -1;
+    if (id == NULL) {
+        return NULL;
     }
 
     sha256_key = util_full_digest(id);
     if (sha256_key == NULL) {
         ERROR("Failed to get sha256 key");
-        return -1;
+        return NULL;
     }
 
     base_name = make_big_data_base_name(sha256_key);
     if (base_name == NULL) {
         ERROR("Failed to retrieve oci image spec file's base name");
-        ret = -1;
-        goto out;
+    }
+
+    free(sha256_key);
+    return base_name;
+}
+
+int try_fill_image_spec(image_t *img, const char *id, const char *image_store_dir)
+{
+    int ret = 0;
+    int nret = 0;
+    char *base_name = NULL;
+    char *config_file = NULL;
+    parser_error err = NULL;
+
+    if (img == NULL || id == NULL || image_store_dir == NULL) {
+        return -1;
+    }
+
+    base_name = image_spec_base_name(id);
+    if (base_name == NULL) {
+        return -1;
     }
 
     nret = asprintf(&config_file, "%s/%s/%s", image_store_dir, id, base_name);
@@ -87,15 +102,15 @@ int try_fill_image_spec(image_t *img, const char *id, const char *image_store_di
 out:
     free(base_name);
     free(config_file);
-    free(sha256_key);
     free(err);
 
     return ret;
 }
 
-image_t *new_image(storage_image *simg, const char *image_store_dir)
+image_t *new_image_with_spec(storage_image *simg, const char *spec_data, const char *image_store_dir)
 {
     image_t *img = NULL;
+    parser_error err = NULL;
 
     if (simg == NULL || image_store_dir == NULL) {
         ERROR("Empty storage image");
@@ -107,14 +122,29 @@ image_t *new_image(storage_image *simg, const char *image_store_dir)
         return NULL;
     }
 
+    if (spec_data != NULL) {
+        img->spec = oci_image_spec_parse_data(spec_data, NULL, &err);
+        if (img->spec == NULL) {
+            WARN("Failed to parse oci image spec of %s: %s", simg->id, err);
+        }
+        free(err);
+    }
+
     // try to load the oci image config, it may fail when load/pull/restore v1 image
-    (void)try_fill_image_spec(img, simg->id, image_store_dir);
+    if (img->spec == NULL) {
+        (void)try_fill_image_spec(img, simg->id, image_store_dir);
+    }
 
     img->simage = simg;
 
     return img;
 }
 
+image_t *new_image(storage_image *simg, const char *image_store_dir)
+{
+    return new_image_with_spec(simg, NULL, image_store_dir);
+}
+
 void image_ref_inc(image_t *img)
 {
     if (img == NULL) {
@@ -33,8 +33,11 @@ typedef struct _image_t_ {
     uint64_t refcnt;
 } image_t;
 
+char *image_spec_base_name(const char *id);
 int try_fill_image_spec(image_t *img, const char *id, const char *image_store_dir);
 image_t *new_image(storage_image *simg, const char *image_store_dir);
+// spec_data is the content of the oci image spec file, it is read from the file if NULL
+image_t *new_image_with_spec(storage_image *simg, const char *spec_data, const char *image_store_dir);
 void image_ref_inc(image_t *img);
 void image_ref_dec(image_t *img);
 void free_image_t(image_t *ptr);
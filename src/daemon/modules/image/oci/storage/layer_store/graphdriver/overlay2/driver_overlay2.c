@@ -33,6 +33,7 @@
 #include "project_quota.h"
 #include "driver.h"
 #include "driver_overlay2_types.h"
+#include "driver_overlay2_pool.h"
 #include "image_api.h"
 #include "utils_array.h"
 #include "utils_convert.h"
@@ -40,6 +41,7 @@
 #include "utils_fs.h"
 #include "utils_string.h"
 #include "utils_timestamp.h"
+#include "utils_trash.h"
 #include "selinux_label.h"
 #include "err_msg.h"
 
@@ -57,12 +59,23 @@ struct io_read_wrapper;
 
 #define QUOTA_SIZE_OPTION "overlay2.size"
 #define QUOTA_BASESIZE_OPTIONS "overlay2.basesize"
+#define LAYER_POOL_SIZE_OPTION "overlay2.layer_pool_size"
+#define LAYER_POOL_MAX_SIZE 64
 // MAX_LAYER_ID_LENGTH represents the number of random characters which can be used to create the unique link identifer
 // for every layer. If this value is too long then the page size limit for the mount command may be exceeded.
 // The idLength should be selected such that following equation is true (512 is a buffer for label metadata).
 // ((idLength + len(linkDir) + 1) * maxDepth) <= (pageSize - 512)
 #define MAX_LAYER_ID_LENGTH 26
 
+static int pool_create_layer(const char *id, const char *parent, const struct graphdriver *driver);
+static int pool_rename_layer(const char *id, const char *new_id, const struct graphdriver *driver);
+
+static const struct overlay2_pool_ops g_overlay2_pool_ops = {
+    .create = pool_create_layer,
+    .rename = pool_rename_layer,
+    .remove = overlay2_rm_layer,
+};
+
 void free_driver_create_opts(struct driver_create_opts *opts)
 {
     if (opts == NULL) {
@@ -161,6 +174,15 @@ static int overlay2_parse_options(struct graphdriver *driver, const char **optio
             overlay_opts->skip_mount_home = converted_bool;
         } else if (strcasecmp(dup, "overlay2.mountopt") == 0) {
             overlay_opts->mount_options = util_strdup_s(val);
+        } else if (strcasecmp(dup, LAYER_POOL_SIZE_OPTION) == 0) {
+            unsigned int converted = 0;
+            ret = util_safe_uint(val, &converted);
+            if (ret != 0 || converted > LAYER_POOL_MAX_SIZE) {
+                ERROR("Invalid layer pool size: '%s', should be 0 to %d", val, LAYER_POOL_MAX_SIZE);
+                ret = -1;
+                goto out;
+            }
+            overlay_opts->layer_pool_size = converted;
         } else {
             ERROR("Overlay2: unknown option: '%s'", dup);
             ret = -1;
@@ -370,6 +392,11 @@ int overlay2_init(struct graphdriver *driver, const char *drvier_home, const cha
         goto out;
     }
 
+    if (overlay2_pool_init(driver, driver->overlay_opts->layer_pool_size, &g_overlay2_pool_ops) != 0) {
+        ret = -1;
+        goto out;
+    }
+
 out:
     free(link_dir);
     free(root_dir);
@@ -918,6 +945,7 @@ int overlay2_create_rw(const char *id, const char *parent, const struct graphdri
                        struct driver_create_opts *create_opts)
 {
     int ret = 0;
+    bool poolable = false;
 
     if (id == NULL || driver == NULL || create_opts == NULL) {
         ERROR("Invalid input arguments");
@@ -932,12 +960,22 @@ int overlay2_create_rw(const char *id, const char *parent, const struct graphdri
         goto out;
     }
 
+    // layers with storage options of their own are not pooled
+    poolable = parent != NULL && (create_opts->storage_opt == NULL || create_opts->storage_opt->len == 0);
+    if (poolable && overlay2_pool_claim(id, parent) == 0) {
+        overlay2_pool_refill(parent);
+        goto out;
+    }
+
     if (driver->support_quota && append_default_quota_opts(create_opts, driver->overlay_opts->default_quota) != 0) {
         ret = -1;
         goto out;
     }
 
     ret = do_create(id, parent, driver, create_opts);
+    if (ret == 0 && poolable) {
+        overlay2_pool_refill(parent);
+    }
 
 out:
     return ret;
@@ -998,6 +1036,7 @@ int overlay2_rm_layer(const char *id, const struct graphdriver *driver)
     int ret = 0;
     int nret = 0;
     char *layer_dir = NULL;
+    char *storage_root = NULL;
     char *link_id = NULL;
     char link_path[PATH_MAX] = { 0 };
     char clean_path[PATH_MAX] = { 0 };
@@ -1007,6 +1046,9 @@ int overlay2_rm_layer(const char *id, const struct graphdriver *driver)
         return -1;
     }
 
+    // pooled writable layers on it go first
+    overlay2_pool_drain(id);
+
     layer_dir = util_path_join(driver->home, id);
     if (layer_dir == NULL) {
         ERROR("Failed to join layer dir:%s", id);
@@ -1033,14 +1075,125 @@ int overlay2_rm_layer(const char *id, const struct graphdriver *driver)
         }
     }
 
-    if (util_recursive_rmdir(layer_dir, 0) != 0) {
+    // trash of storage root, the driver home is scanned for layers
+    storage_root = util_path_dir(driver->home);
+    if (util_trash_path(storage_root, layer_dir) != 0) {
         SYSERROR("Failed to remove layer directory %s", layer_dir);
         ret = -1;
         goto out;
     }
 
+out:
+    free(storage_root);
+    free(layer_dir);
+    free(link_id);
+    return ret;
+}
+
+static int pool_create_layer(const char *id, const char *parent, const struct graphdriver *driver)
+{
+    int ret = 0;
+    struct driver_create_opts create_opts = { 0 };
+
+    // same as a create without storage options
+    if (driver->support_quota && append_default_quota_opts(&create_opts, driver->overlay_opts->default_quota) != 0) {
+        ret = -1;
+        goto out;
+    }
+
+    ret = do_create(id, parent, driver, &create_opts);
+
+out:
+    free_json_map_string_string(create_opts.storage_opt);
+    return ret;
+}
+
+// point link of the layer to its renamed diff directory
+static int redo_diff_symlink(const char *id, const char *link_id, const char *driver_home)
+{
+    int nret = 0;
+    char target_path[PATH_MAX] = { 0 };
+    char link_path[PATH_MAX] = { 0 };
+    char tmp_path[PATH_MAX] = { 0 };
+
+    nret = snprintf(target_path, PATH_MAX, "../%s/diff", id);
+    if (nret < 0 || nret >= PATH_MAX) {
+        ERROR("Failed to get target path %s", id);
+        return -1;
+    }
+
+    nret = snprintf(link_path, PATH_MAX, "%s/%s/%s", driver_home, OVERLAY_LINK_DIR, link_id);
+    if (nret < 0 || nret >= PATH_MAX) {
+        ERROR("Failed to get link path %s", link_id);
+        return -1;
+    }
+
+    nret = snprintf(tmp_path, PATH_MAX, "%s.tmp", link_path);
+    if (nret < 0 || nret >= PATH_MAX) {
+        ERROR("Failed to get temporary link path %s", link_id);
+        return -1;
+    }
+
+    (void)unlink(tmp_path);
+    if (symlink(target_path, tmp_path) != 0) {
+        SYSERROR("Failed to create symlink from \"%s\" to \"%s\"", tmp_path, target_path);
+        return -1;
+    }
+    if (rename(tmp_path, link_path) != 0) {
+        SYSERROR("Failed to rename symlink %s to %s", tmp_path, link_path);
+        (void)unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int pool_rename_layer(const char *id, const char *new_id, const struct graphdriver *driver)
+{
+    int ret = 0;
+    char *layer_dir = NULL;
+    char *new_layer_dir = NULL;
+    char *link_id = NULL;
+
+    layer_dir = util_path_join(driver->home, id);
+    new_layer_dir = util_path_join(driver->home, new_id);
+    if (layer_dir == NULL || new_layer_dir == NULL) {
+        ERROR("Failed to join layer dir:%s", new_id);
+        ret = -1;
+        goto out;
+    }
+
+    link_id = read_layer_link_file(layer_dir);
+    if (link_id == NULL) {
+        ERROR("Failed to read link of layer %s", layer_dir);
+        ret = -1;
+        goto out;
+    }
+
+    // rename replaces an empty directory
+    if (util_dir_exists(new_layer_dir)) {
+        ERROR("Layer directory %s exists", new_layer_dir);
+        ret = -1;
+        goto out;
+    }
+
+    if (rename(layer_dir, new_layer_dir) != 0) {
+        SYSERROR("Failed to rename %s to %s", layer_dir, new_layer_dir);
+        ret = -1;
+        goto out;
+    }
+
+    if (redo_diff_symlink(new_id, link_id, driver->home) != 0) {
+        if (rename(new_layer_dir, layer_dir) != 0) {
+            SYSERROR("Failed to rename %s back to %s", new_layer_dir, layer_dir);
+        }
+        ret = -1;
+        goto out;
+    }
+
 out:
     free(layer_dir);
+    free(new_layer_dir);
     free(link_id);
     return ret;
 }
@@ -1926,6 +2079,8 @@ int overlay2_clean_up(struct graphdriver *driver)
         goto out;
     }
 
+    overlay2_pool_exit();
+
     if (umount(driver->home) != 0) {
         ret = -1;
         goto out;
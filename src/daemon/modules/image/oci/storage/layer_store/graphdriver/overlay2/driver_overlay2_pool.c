@@ -0,0 +1,404 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide pool of pre-created overlay2 writable layers
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "driver_overlay2_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/prctl.h>
+
+#include "isula_libutils/log.h"
+#include "driver.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_file.h"
+
+/*
+ * Creating the writable layer of a container makes directories, the link and lower files
+ * and sets the project quota, under the layer store lock. With a pool, the writable layers
+ * of recently used images are created in background with ids of their own, and create
+ * renames one of them to the container id. The pool of an image is refilled after each
+ * create and drained when its top layer is removed. A parent whose layers fail to be created,
+ * e.g. because the quota of the filesystem is used up, is not tried again before a backoff
+ * which doubles with each failure, its ready layers are kept.
+ */
+#define POOL_MAX_PARENTS 8
+#define POOL_ID_RANDOM_LENGTH 32
+#define POOL_BACKOFF_MIN_MS 1000ULL
+#define POOL_BACKOFF_MAX_MS (5 * 60 * 1000ULL)
+
+struct pool_parent {
+    char *parent;
+    // ids of ready layers
+    char **ready;
+    size_t ready_len;
+    // layers being created by the worker
+    size_t creating;
+    uint64_t last_used;
+    // tells a parent from a drained one with the same id
+    uint64_t gen;
+    // consecutive failures to create a layer, not filled again before retry_after
+    unsigned int failures;
+    uint64_t retry_after;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    const struct graphdriver *driver;
+    const struct overlay2_pool_ops *ops;
+    size_t size;
+    struct pool_parent parents[POOL_MAX_PARENTS];
+    size_t parents_len;
+    uint64_t clock;
+    pthread_t worker;
+    bool started;
+    bool stop;
+} g_pool = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+bool overlay2_pool_is_pool_id(const char *id)
+{
+    return id != NULL && strncmp(id, OVERLAY2_POOL_ID_PREFIX, strlen(OVERLAY2_POOL_ID_PREFIX)) == 0;
+}
+
+static struct pool_parent *find_parent(const char *parent)
+{
+    size_t i;
+
+    for (i = 0; i < g_pool.parents_len; i++) {
+        if (strcmp(g_pool.parents[i].parent, parent) == 0) {
+            return &g_pool.parents[i];
+        }
+    }
+    return NULL;
+}
+
+// takes parent out of the pool, its ready layers are returned to be removed without the lock
+static char **take_parent(struct pool_parent *p)
+{
+    char **ready = p->ready;
+    size_t index = (size_t)(p - g_pool.parents);
+
+    free(p->parent);
+    g_pool.parents_len--;
+    if (index != g_pool.parents_len) {
+        g_pool.parents[index] = g_pool.parents[g_pool.parents_len];
+    }
+    (void)memset(&g_pool.parents[g_pool.parents_len], 0, sizeof(struct pool_parent));
+
+    return ready;
+}
+
+static void remove_layers(char **ids)
+{
+    size_t i;
+
+    for (i = 0; ids != NULL && ids[i] != NULL; i++) {
+        if (g_pool.ops->remove(ids[i], g_pool.driver) != 0) {
+            WARN("Failed to remove pooled layer %s", ids[i]);
+        }
+    }
+    util_free_array(ids);
+}
+
+static uint64_t pool_now_ms(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static uint64_t pool_backoff_ms(unsigned int failures)
+{
+    uint64_t backoff = POOL_BACKOFF_MIN_MS;
+
+    while (failures > 1 && backoff < POOL_BACKOFF_MAX_MS) {
+        backoff *= 2;
+        failures--;
+    }
+    return backoff < POOL_BACKOFF_MAX_MS ? backoff : POOL_BACKOFF_MAX_MS;
+}
+
+// parents in backoff are skipped, they are filled again by the first refill after it
+static struct pool_parent *next_unfilled_parent(void)
+{
+    uint64_t now = pool_now_ms();
+    size_t i;
+
+    for (i = 0; i < g_pool.parents_len; i++) {
+        if (g_pool.parents[i].retry_after > now) {
+            continue;
+        }
+        if (g_pool.parents[i].ready_len + g_pool.parents[i].creating < g_pool.size) {
+            return &g_pool.parents[i];
+        }
+    }
+    return NULL;
+}
+
+static void fill_one(struct pool_parent *p)
+{
+    char id[sizeof(OVERLAY2_POOL_ID_PREFIX) + POOL_ID_RANDOM_LENGTH] = { 0 };
+    char random[POOL_ID_RANDOM_LENGTH + 1] = { 0 };
+    char *parent = util_strdup_s(p->parent);
+    uint64_t gen = p->gen;
+    char **drop = NULL;
+    uint64_t backoff = 0;
+    int ret = 0;
+
+    p->creating++;
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    ret = util_generate_random_str(random, POOL_ID_RANDOM_LENGTH);
+    if (ret == 0) {
+        (void)snprintf(id, sizeof(id), "%s%s", OVERLAY2_POOL_ID_PREFIX, random);
+        ret = g_pool.ops->create(id, parent, g_pool.driver);
+    }
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    p = find_parent(parent);
+    if (p != NULL && p->gen != gen) {
+        p = NULL;
+    }
+    if (p != NULL) {
+        p->creating--;
+    }
+    if (ret != 0) {
+        // do not try again and again
+        if (p != NULL) {
+            p->failures++;
+            backoff = pool_backoff_ms(p->failures);
+            p->retry_after = pool_now_ms() + backoff;
+        }
+        WARN("Failed to create pooled layer of %s, retry in %llu ms", parent, (unsigned long long)backoff);
+    } else if (p != NULL && !g_pool.stop && util_array_append(&p->ready, id) == 0) {
+        p->ready_len++;
+        p->failures = 0;
+        p->retry_after = 0;
+    } else {
+        // parent drained while creating
+        (void)util_array_append(&drop, id);
+    }
+
+    if (drop != NULL) {
+        (void)pthread_mutex_unlock(&g_pool.mutex);
+        remove_layers(drop);
+        (void)pthread_mutex_lock(&g_pool.mutex);
+    }
+    free(parent);
+}
+
+static void *pool_worker(void *arg)
+{
+    struct pool_parent *p = NULL;
+
+    (void)arg;
+    (void)prctl(PR_SET_NAME, "rwpool");
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    while (!g_pool.stop) {
+        p = next_unfilled_parent();
+        if (p == NULL) {
+            (void)pthread_cond_wait(&g_pool.cond, &g_pool.mutex);
+            continue;
+        }
+        fill_one(p);
+    }
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    return NULL;
+}
+
+static void remove_stale_layers(const char *home)
+{
+    char **entries = NULL;
+    size_t i;
+
+    if (util_list_all_subdir(home, &entries) != 0) {
+        WARN("Failed to list %s", home);
+        return;
+    }
+    for (i = 0; entries != NULL && entries[i] != NULL; i++) {
+        if (!overlay2_pool_is_pool_id(entries[i])) {
+            continue;
+        }
+        INFO("Remove pooled layer %s left by last run", entries[i]);
+        if (g_pool.ops->remove(entries[i], g_pool.driver) != 0) {
+            WARN("Failed to remove pooled layer %s", entries[i]);
+        }
+    }
+    util_free_array(entries);
+}
+
+int overlay2_pool_init(const struct graphdriver *driver, size_t size, const struct overlay2_pool_ops *ops)
+{
+    if (driver == NULL || ops == NULL) {
+        return -1;
+    }
+
+    g_pool.driver = driver;
+    g_pool.ops = ops;
+    remove_stale_layers(driver->home);
+
+    if (size == 0) {
+        return 0;
+    }
+    g_pool.size = size;
+    g_pool.stop = false;
+    if (pthread_create(&g_pool.worker, NULL, pool_worker, NULL) != 0) {
+        ERROR("Failed to start writable layer pool");
+        g_pool.size = 0;
+        return -1;
+    }
+    g_pool.started = true;
+
+    return 0;
+}
+
+int overlay2_pool_claim(const char *id, const char *parent)
+{
+    struct pool_parent *p = NULL;
+    char *pool_id = NULL;
+
+    if (id == NULL || parent == NULL) {
+        return -1;
+    }
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    if (g_pool.started) {
+        p = find_parent(parent);
+    }
+    if (p != NULL && p->ready_len > 0) {
+        p->ready_len--;
+        pool_id = p->ready[p->ready_len];
+        p->ready[p->ready_len] = NULL;
+        p->last_used = ++g_pool.clock;
+    }
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    if (pool_id == NULL) {
+        return -1;
+    }
+
+    if (g_pool.ops->rename(pool_id, id, g_pool.driver) != 0) {
+        WARN("Failed to claim pooled layer %s as %s", pool_id, id);
+        (void)g_pool.ops->remove(pool_id, g_pool.driver);
+        free(pool_id);
+        return -1;
+    }
+
+    DEBUG("Claimed pooled layer %s as %s", pool_id, id);
+    free(pool_id);
+    return 0;
+}
+
+void overlay2_pool_refill(const char *parent)
+{
+    struct pool_parent *p = NULL;
+    char **evicted = NULL;
+    size_t i;
+
+    if (parent == NULL) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    if (!g_pool.started || g_pool.stop) {
+        goto unlock_out;
+    }
+
+    p = find_parent(parent);
+    if (p == NULL) {
+        if (g_pool.parents_len == POOL_MAX_PARENTS) {
+            // evict the least recently used image
+            p = &g_pool.parents[0];
+            for (i = 1; i < g_pool.parents_len; i++) {
+                if (g_pool.parents[i].last_used < p->last_used) {
+                    p = &g_pool.parents[i];
+                }
+            }
+            evicted = take_parent(p);
+        }
+        p = &g_pool.parents[g_pool.parents_len++];
+        p->parent = util_strdup_s(parent);
+        p->gen = ++g_pool.clock;
+    }
+    p->last_used = ++g_pool.clock;
+    (void)pthread_cond_signal(&g_pool.cond);
+
+unlock_out:
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+    remove_layers(evicted);
+}
+
+void overlay2_pool_drain(const char *parent)
+{
+    struct pool_parent *p = NULL;
+    char **ready = NULL;
+
+    if (parent == NULL || overlay2_pool_is_pool_id(parent)) {
+        return;
+    }
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    p = find_parent(parent);
+    if (p != NULL) {
+        ready = take_parent(p);
+    }
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    if (ready != NULL) {
+        DEBUG("Drain pooled layers of %s", parent);
+    }
+    remove_layers(ready);
+}
+
+void overlay2_pool_exit(void)
+{
+    char **ready = NULL;
+    char **all = NULL;
+    size_t i;
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    if (!g_pool.started) {
+        (void)pthread_mutex_unlock(&g_pool.mutex);
+        return;
+    }
+    g_pool.stop = true;
+    (void)pthread_cond_broadcast(&g_pool.cond);
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    (void)pthread_join(g_pool.worker, NULL);
+
+    (void)pthread_mutex_lock(&g_pool.mutex);
+    g_pool.started = false;
+    while (g_pool.parents_len > 0) {
+        ready = take_parent(&g_pool.parents[0]);
+        for (i = 0; ready != NULL && ready[i] != NULL; i++) {
+            (void)util_array_append(&all, ready[i]);
+        }
+        util_free_array(ready);
+    }
+    (void)pthread_mutex_unlock(&g_pool.mutex);
+
+    remove_layers(all);
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide pool of pre-created overlay2 writable layers
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_IMAGE_OCI_STORAGE_LAYER_STORE_GRAPHDRIVER_OVERLAY2_DRIVER_OVERLAY2_POOL_H
+#define DAEMON_MODULES_IMAGE_OCI_STORAGE_LAYER_STORE_GRAPHDRIVER_OVERLAY2_DRIVER_OVERLAY2_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+struct graphdriver;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ids of pooled layers, they are not known by the layer store
+#define OVERLAY2_POOL_ID_PREFIX "rwpool-"
+
+struct overlay2_pool_ops {
+    // create writable layer id on parent, with the default options
+    int (*create)(const char *id, const char *parent, const struct graphdriver *driver);
+    // rename layer id to new_id
+    int (*rename)(const char *id, const char *new_id, const struct graphdriver *driver);
+    int (*remove)(const char *id, const struct graphdriver *driver);
+};
+
+// keep size ready layers for each recently used parent, layers left by last run are removed
+int overlay2_pool_init(const struct graphdriver *driver, size_t size, const struct overlay2_pool_ops *ops);
+
+// rename a ready layer of parent to id, fails if there is none
+int overlay2_pool_claim(const char *id, const char *parent);
+
+// create ready layers of parent in background
+void overlay2_pool_refill(const char *parent);
+
+// remove ready layers of parent, before parent is removed
+void overlay2_pool_drain(const char *parent);
+
+bool overlay2_pool_is_pool_id(const char *id);
+
+void overlay2_pool_exit(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
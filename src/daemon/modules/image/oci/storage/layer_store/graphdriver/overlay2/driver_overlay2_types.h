@@ -30,6 +30,8 @@ struct overlay_options {
     const char *mount_program;
     bool skip_mount_home;
     const char *mount_options;
+    // ready writable layers kept for each recently used image
+    size_t layer_pool_size;
 };
 
 #ifdef __cplusplus
@@ -118,7 +118,7 @@ void layer_ref_dec(layer_t *layer)
     free_layer_t(layer);
 }
 
-layer_t *load_layer(const char *fname, const char *mountpoint_fname)
+static layer_t *do_load_layer(const char *fname, const char *data, const char *mountpoint_fname)
 {
     parser_error err = NULL;
     layer_t *result = NULL;
@@ -128,7 +128,11 @@ layer_t *load_layer(const char *fname, const char *mountpoint_fname)
     if (fname == NULL) {
         return result;
     }
-    slayer = storage_layer_parse_file(fname, NULL, &err);
+    if (data != NULL) {
+        slayer = storage_layer_parse_data(data, NULL, &err);
+    } else {
+        slayer = storage_layer_parse_file(fname, NULL, &err);
+    }
     if (slayer == NULL) {
         ERROR("Parse layer failed: %s", err);
         goto free_out;
@@ -155,6 +159,19 @@ free_out:
     return NULL;
 }
 
+layer_t *load_layer(const char *fname, const char *mountpoint_fname)
+{
+    return do_load_layer(fname, NULL, mountpoint_fname);
+}
+
+layer_t *load_layer_from_data(const char *fname, const char *data, const char *mountpoint_fname)
+{
+    if (data == NULL) {
+        return NULL;
+    }
+    return do_load_layer(fname, data, mountpoint_fname);
+}
+
 int save_layer(layer_t *layer)
 {
     char *jstr = NULL;
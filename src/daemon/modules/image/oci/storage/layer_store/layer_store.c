@@ -50,8 +50,10 @@
 #include "http.h"
 #include "utils_base64.h"
 #include "constants.h"
+#include "storage_index.h"
 
 #define PAYLOAD_CRC_LEN 12
+#define LAYER_JSON_FILE "layer.json"
 
 struct io_read_wrapper;
 
@@ -434,7 +436,7 @@ static inline char *layer_json_path(const char *id)
     char *result = NULL;
     int nret = 0;
 
-    nret = asprintf(&result, "%s/%s/layer.json", g_root_dir, id);
+    nret = asprintf(&result, "%s/%s/" LAYER_JSON_FILE, g_root_dir, id);
     if (nret < 0 || nret > PATH_MAX) {
         SYSERROR("Create layer json path failed");
         return NULL;
@@ -1749,6 +1751,8 @@ static bool load_layer_json_cb(const char *path_name, const struct dirent *sub_d
     char *rpath = NULL;
     char *mount_point_path = NULL;
     layer_t *l = NULL;
+    storage_index_t *index = (storage_index_t *)context;
+    const char *data = NULL;
 
     nret = snprintf(tmpdir, PATH_MAX, "%s/%s", path_name, sub_dir->d_name);
     if (nret < 0 || nret >= PATH_MAX) {
@@ -1756,7 +1760,9 @@ static bool load_layer_json_cb(const char *path_name, const struct dirent *sub_d
         goto free_out;
     }
 
-    if (!util_dir_exists(tmpdir)) {
+    // an unchanged layer.json in the index shows it is a directory
+    data = storage_index_get(index, sub_dir->d_name, LAYER_JSON_FILE);
+    if (data == NULL && !util_dir_exists(tmpdir)) {
         // ignore non-dir
         DEBUG("%s is not directory", sub_dir->d_name);
         goto free_out;
@@ -1779,7 +1785,10 @@ static bool load_layer_json_cb(const char *path_name, const struct dirent *sub_d
         goto remove_invalid_dir;
     }
 
-    l = load_layer(rpath, mount_point_path);
+    l = load_layer_from_data(rpath, data, mount_point_path);
+    if (l == NULL) {
+        l = load_layer(rpath, mount_point_path);
+    }
     if (l == NULL) {
         ERROR("load layer: %s failed, remove it", sub_dir->d_name);
         goto remove_invalid_dir;
@@ -1819,18 +1828,39 @@ free_out:
     return true;
 }
 
+static void save_layers_index(storage_index_t *index)
+{
+    struct linked_list *item = NULL;
+    struct linked_list *next = NULL;
+
+    linked_list_for_each_safe(item, &(g_metadata.layers_list), next) {
+        layer_t *l = (layer_t *)item->elem;
+
+        // left out layers are loaded from their json files
+        if (storage_index_add(index, l->slayer->id, LAYER_JSON_FILE) != 0) {
+            WARN("Failed to add layer %s to index", l->slayer->id);
+        }
+    }
+
+    if (storage_index_save(index) != 0) {
+        WARN("Failed to save index of layers");
+    }
+}
+
 static int load_layers_from_json_files()
 {
     int ret = 0;
     struct linked_list *item = NULL;
     struct linked_list *next = NULL;
     bool should_save = false;
+    storage_index_t *index = NULL;
 
     if (!layer_store_lock(true)) {
         return -1;
     }
 
-    ret = util_scan_subdirs(g_root_dir, load_layer_json_cb, NULL);
+    index = storage_index_open(g_root_dir);
+    ret = util_scan_subdirs(g_root_dir, load_layer_json_cb, index);
     if (ret != 0) {
         goto unlock_out;
     }
@@ -1885,9 +1915,15 @@ static int load_layers_from_json_files()
         }
     }
 
+    // many layers changed since the index was saved, e.g. the daemon was killed
+    if (storage_index_need_save(index)) {
+        save_layers_index(index);
+    }
+
     ret = 0;
     goto unlock_out;
 unlock_out:
+    storage_index_free(index);
     layer_store_unlock();
     return ret;
 }
@@ -1909,22 +1945,22 @@ int layer_store_init(const struct storage_module_init_options *conf)
         ERROR("Failed to init metadata rwlock");
         goto free_out;
     }
-    g_metadata.by_id = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, layer_map_kvfree);
+    g_metadata.by_id = map_new_hash(MAP_STR_PTR, layer_map_kvfree);
     if (g_metadata.by_id == NULL) {
         ERROR("Failed to new ids map");
         goto free_out;
     }
-    g_metadata.by_name = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, layer_map_kvfree);
+    g_metadata.by_name = map_new_hash(MAP_STR_PTR, layer_map_kvfree);
     if (g_metadata.by_name == NULL) {
         ERROR("Failed to new names map");
         goto free_out;
     }
-    g_metadata.by_compress_digest = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, digest_map_kvfree);
+    g_metadata.by_compress_digest = map_new_hash(MAP_STR_PTR, digest_map_kvfree);
     if (g_metadata.by_compress_digest == NULL) {
         ERROR("Failed to new compress map");
         goto free_out;
     }
-    g_metadata.by_uncompress_digest = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, digest_map_kvfree);
+    g_metadata.by_uncompress_digest = map_new_hash(MAP_STR_PTR, digest_map_kvfree);
     if (g_metadata.by_uncompress_digest == NULL) {
         ERROR("Failed to new uncompress map");
         goto free_out;
@@ -1956,6 +1992,18 @@ free_out:
 
 void layer_store_exit()
 {
+    storage_index_t *index = NULL;
+
+    // save the index used by next start
+    if (g_metadata.by_id != NULL && layer_store_lock(false)) {
+        index = storage_index_open(g_root_dir);
+        if (index != NULL) {
+            save_layers_index(index);
+        }
+        layer_store_unlock();
+        storage_index_free(index);
+    }
+
     graphdriver_cleanup();
 }
 
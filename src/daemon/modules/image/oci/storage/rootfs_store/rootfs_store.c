@@ -37,6 +37,8 @@
 #include "utils_regex.h"
 #include "utils_string.h"
 #include "utils_timestamp.h"
+#include "utils_trash.h"
+#include "storage_index.h"
 
 #define CONTAINER_JSON "container.json"
 
@@ -194,6 +196,51 @@ out:
     return ret;
 }
 
+static bool append_container_from_index(storage_index_t *index, const char *id)
+{
+    const char *data = NULL;
+    storage_rootfs *c = NULL;
+    parser_error err = NULL;
+
+    data = storage_index_get(index, id, CONTAINER_JSON);
+    if (data == NULL) {
+        return false;
+    }
+
+    c = storage_rootfs_parse_data(data, NULL, &err);
+    if (c == NULL) {
+        WARN("Failed to parse indexed container %s: %s", id, err);
+        free(err);
+        return false;
+    }
+
+    if (do_append_container(c) != 0) {
+        free_storage_rootfs(c);
+        return false;
+    }
+
+    return true;
+}
+
+static void save_containers_index(storage_index_t *index)
+{
+    struct linked_list *item = NULL;
+    struct linked_list *next = NULL;
+
+    linked_list_for_each_safe(item, &(g_rootfs_store->rootfs_list), next) {
+        cntrootfs_t *cntr = (cntrootfs_t *)item->elem;
+
+        // left out containers are loaded from their json files
+        if (storage_index_add(index, cntr->srootfs->id, CONTAINER_JSON) != 0) {
+            WARN("Failed to add container %s to index", cntr->srootfs->id);
+        }
+    }
+
+    if (storage_index_save(index) != 0) {
+        WARN("Failed to save index of containers");
+    }
+}
+
 static int get_containers_from_json()
 {
     int ret = 0;
@@ -203,6 +250,7 @@ static int get_containers_from_json()
     size_t i;
     char *id_patten = "^[a-f0-9]{64}$";
     char container_path[PATH_MAX] = { 0x00 };
+    storage_index_t *index = NULL;
 
     if (!rootfs_store_lock(EXCLUSIVE)) {
         ERROR("Failed to lock container store");
@@ -216,6 +264,7 @@ static int get_containers_from_json()
     }
     container_dirs_num = util_array_len((const char **)container_dirs);
 
+    index = storage_index_open(g_rootfs_store->dir);
     for (i = 0; i < container_dirs_num; i++) {
         if (util_reg_match(id_patten, container_dirs[i]) != 0) {
             WARN("Container's json is placed inside container's data directory, so skip any other file or directory: %s",
@@ -224,6 +273,9 @@ static int get_containers_from_json()
         }
 
         DEBUG("Restore the containers:%s", container_dirs[i]);
+        if (append_container_from_index(index, container_dirs[i])) {
+            continue;
+        }
         nret = snprintf(container_path, sizeof(container_path), "%s/%s", g_rootfs_store->dir, container_dirs[i]);
         if (nret < 0 || (size_t)nret >= sizeof(container_path)) {
             ERROR("Failed to get container path");
@@ -239,7 +291,13 @@ static int get_containers_from_json()
         }
     }
 
+    // many containers changed since the index was saved, e.g. the daemon was killed
+    if (storage_index_need_save(index)) {
+        save_containers_index(index);
+    }
+
 out:
+    storage_index_free(index);
     util_free_array(container_dirs);
     rootfs_store_unlock();
     return ret;
@@ -477,21 +535,21 @@ int rootfs_store_init(struct storage_module_init_options *opts)
     g_rootfs_store->rootfs_list_len = 0;
     linked_list_init(&g_rootfs_store->rootfs_list);
 
-    g_rootfs_store->byid = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, rootfs_store_field_kvfree);
+    g_rootfs_store->byid = map_new_hash(MAP_STR_PTR, rootfs_store_field_kvfree);
     if (g_rootfs_store->byid == NULL) {
         ERROR("Out of memory");
         ret = -1;
         goto out;
     }
 
-    g_rootfs_store->bylayer = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, rootfs_store_field_kvfree);
+    g_rootfs_store->bylayer = map_new_hash(MAP_STR_PTR, rootfs_store_field_kvfree);
     if (g_rootfs_store->bylayer == NULL) {
         ERROR("Out of memory");
         ret = -1;
         goto out;
     }
 
-    g_rootfs_store->byname = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, rootfs_store_field_kvfree);
+    g_rootfs_store->byname = map_new_hash(MAP_STR_PTR, rootfs_store_field_kvfree);
     if (g_rootfs_store->byname == NULL) {
         ERROR("Out of memory");
         ret = -1;
@@ -514,6 +572,27 @@ out:
     return ret;
 }
 
+void rootfs_store_exit()
+{
+    storage_index_t *index = NULL;
+
+    if (g_rootfs_store == NULL) {
+        return;
+    }
+
+    // save the index used by next start
+    if (!rootfs_store_lock(SHARED)) {
+        ERROR("Failed to lock container store");
+        return;
+    }
+    index = storage_index_open(g_rootfs_store->dir);
+    if (index != NULL) {
+        save_containers_index(index);
+    }
+    rootfs_store_unlock();
+    storage_index_free(index);
+}
+
 static char *generate_random_container_id()
 {
     char *id = NULL;
@@ -854,18 +933,23 @@ out:
 static int remove_rootfs_dir(const char *id)
 {
     char rootfs_path[PATH_MAX] = { 0x00 };
+    char *storage_root = NULL;
+    int ret = 0;
 
     if (get_data_dir(id, rootfs_path, sizeof(rootfs_path)) != 0) {
         ERROR("Failed to get rootfs data dir: %s", id);
         return -1;
     }
 
-    if (util_recursive_rmdir(rootfs_path, 0) != 0) {
+    // trash of storage root, the rootfs directory itself is scanned on load
+    storage_root = util_path_dir(g_rootfs_store->dir);
+    if (util_trash_path(storage_root, rootfs_path) != 0) {
         ERROR("Failed to delete rootfs directory : %s", rootfs_path);
-        return -1;
+        ret = -1;
     }
 
-    return 0;
+    free(storage_root);
+    return ret;
 }
 
 static int delete_rootfs_from_store_without_lock(const char *id)
@@ -65,6 +65,9 @@ storage_rootfs *rootfs_store_get_rootfs(const char *id);
 // Return a slice enumerating the known containers.
 int rootfs_store_get_all_rootfs(struct rootfs_list *all_rootfs);
 
+// Save the startup index of container store
+void rootfs_store_exit();
+
 // Free memory of container store, but will not delete the persisted files
 void rootfs_store_free();
 
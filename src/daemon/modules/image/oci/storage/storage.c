@@ -39,6 +39,7 @@
 #include "utils_file.h"
 #include "utils_string.h"
 #include "utils_verify.h"
+#include "utils_trash.h"
 #include "sha256.h"
 
 static pthread_rwlock_t g_storage_rwlock;
@@ -1020,6 +1021,8 @@ void storage_module_exit()
 {
     free(g_storage_run_root);
     g_storage_run_root = NULL;
+    image_store_exit();
+    rootfs_store_exit();
     layer_store_exit();
 }
 
@@ -1814,6 +1817,11 @@ int storage_module_init(struct storage_module_init_options *opts)
         goto out;
     }
 
+    // layers and rootfs removed before a restart may be left in trash
+    if (util_trash_resume(opts->storage_root) != 0) {
+        WARN("Failed to resume deletion of storage trash");
+    }
+
     if (layer_store_init(opts) != 0) {
         ERROR("Failed to init layer store");
         ret = -1;
@@ -0,0 +1,521 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide startup index of the json files of a store
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "storage_index.h"
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "isula_libutils/log.h"
+#include "constants.h"
+#include "utils.h"
+#include "utils_file.h"
+
+/*
+ * Layout of the index file, all records are validated when it is opened except the crc of
+ * their data, which is checked when a record is used:
+ *   header | entries sorted by path | paths | data
+ * Paths and data are terminated by '\0', so data can be parsed in place.
+ */
+#define STORAGE_INDEX_MAGIC "ISULIDX"
+#define STORAGE_INDEX_VERSION 1
+// misses of a load to save the index again
+#define STORAGE_INDEX_RESAVE_MISSES 64
+
+struct index_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint64_t size;
+    uint64_t data_start;
+    uint32_t table_crc;
+    // crc of the fields above
+    uint32_t header_crc;
+};
+
+struct index_entry {
+    uint64_t ino;
+    uint64_t size;
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    uint64_t path_off;
+    uint64_t data_off;
+    uint32_t path_len;
+    uint32_t data_len;
+    uint32_t data_crc;
+    uint32_t reserved;
+};
+
+struct staged_entry {
+    char *path;
+    struct stat st;
+    const char *data;
+    uint32_t data_len;
+    // data read from the file, else data is in the mapped index
+    char *owned;
+};
+
+struct storage_index {
+    char *path;
+    int dirfd;
+
+    char *map;
+    size_t map_size;
+    const struct index_header *header;
+    const struct index_entry *entries;
+
+    size_t misses;
+
+    struct staged_entry *staged;
+    size_t staged_len;
+    size_t staged_cap;
+};
+
+static uint32_t index_crc(const void *buf, size_t len)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+    const Bytef *p = buf;
+
+    // crc32 takes uInt lengths
+    while (len > 0) {
+        uInt n = len > UINT_MAX ? UINT_MAX : (uInt)len;
+        crc = crc32(crc, p, n);
+        p += n;
+        len -= n;
+    }
+    return (uint32_t)crc;
+}
+
+static bool range_valid(uint64_t off, uint64_t len, uint64_t start, uint64_t end, const char *map)
+{
+    // the byte after the range is the terminating '\0'
+    return off >= start && off <= end && len < end - off && map[off + len] == '\0';
+}
+
+static bool index_valid(const char *map, size_t size)
+{
+    const struct index_header *header = (const struct index_header *)map;
+    const struct index_entry *entries = NULL;
+    uint64_t table_end = 0;
+    const char *prev = NULL;
+    size_t i;
+
+    if (size < sizeof(struct index_header) || memcmp(header->magic, STORAGE_INDEX_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != STORAGE_INDEX_VERSION ||
+        index_crc(header, offsetof(struct index_header, header_crc)) != header->header_crc || header->size != size) {
+        return false;
+    }
+
+    table_end = sizeof(struct index_header) + (uint64_t)header->count * sizeof(struct index_entry);
+    if (table_end > header->data_start || header->data_start > size ||
+        index_crc(map + sizeof(struct index_header), header->data_start - sizeof(struct index_header)) !=
+        header->table_crc) {
+        return false;
+    }
+
+    entries = (const struct index_entry *)(map + sizeof(struct index_header));
+    for (i = 0; i < header->count; i++) {
+        if (!range_valid(entries[i].path_off, entries[i].path_len, table_end, header->data_start, map) ||
+            !range_valid(entries[i].data_off, entries[i].data_len, header->data_start, size, map)) {
+            return false;
+        }
+        // sorted, lookups are binary searches
+        if (prev != NULL && strcmp(prev, map + entries[i].path_off) >= 0) {
+            return false;
+        }
+        prev = map + entries[i].path_off;
+    }
+
+    return true;
+}
+
+static void index_map(storage_index_t *index)
+{
+    struct stat st = { 0 };
+    void *map = NULL;
+    int fd = -1;
+
+    fd = openat(index->dirfd, STORAGE_INDEX_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            SYSWARN("Failed to open %s", index->path);
+        }
+        return;
+    }
+
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        goto out;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        SYSWARN("Failed to map %s", index->path);
+        goto out;
+    }
+
+    if (!index_valid(map, (size_t)st.st_size)) {
+        WARN("Ignore invalid index %s", index->path);
+        (void)munmap(map, (size_t)st.st_size);
+        goto out;
+    }
+
+    index->map = map;
+    index->map_size = (size_t)st.st_size;
+    index->header = (const struct index_header *)index->map;
+    index->entries = (const struct index_entry *)(index->map + sizeof(struct index_header));
+
+out:
+    close(fd);
+}
+
+storage_index_t *storage_index_open(const char *dir)
+{
+    storage_index_t *index = NULL;
+
+    if (dir == NULL) {
+        return NULL;
+    }
+
+    index = util_common_calloc_s(sizeof(storage_index_t));
+    if (index == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    index->path = util_path_join(dir, STORAGE_INDEX_FILE);
+    if (index->path == NULL) {
+        ERROR("Failed to get index path of %s", dir);
+        free(index);
+        return NULL;
+    }
+
+    index->dirfd = util_open(dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0);
+    if (index->dirfd < 0) {
+        SYSERROR("Failed to open %s", dir);
+        storage_index_free(index);
+        return NULL;
+    }
+
+    index_map(index);
+
+    return index;
+}
+
+static int entry_cmp(const void *key, const void *elem)
+{
+    const storage_index_t *index = ((const void **)key)[0];
+    const char *path = ((const void **)key)[1];
+
+    return strcmp(path, index->map + ((const struct index_entry *)elem)->path_off);
+}
+
+static const struct index_entry *index_lookup(const storage_index_t *index, const char *path)
+{
+    const void *key[] = { index, path };
+
+    if (index->map == NULL) {
+        return NULL;
+    }
+    return bsearch(key, index->entries, index->header->count, sizeof(struct index_entry), entry_cmp);
+}
+
+static bool stat_match(const struct index_entry *entry, const struct stat *st)
+{
+    return entry->ino == (uint64_t)st->st_ino && entry->size == (uint64_t)st->st_size &&
+           entry->mtime_sec == (int64_t)st->st_mtim.tv_sec && entry->mtime_nsec == (int64_t)st->st_mtim.tv_nsec;
+}
+
+// data of path if the file is unchanged since it was indexed
+static const char *index_fresh_data(const storage_index_t *index, const char *path, const struct stat *st)
+{
+    const struct index_entry *entry = index_lookup(index, path);
+
+    if (entry == NULL || !stat_match(entry, st)) {
+        return NULL;
+    }
+    if (index_crc(index->map + entry->data_off, entry->data_len) != entry->data_crc) {
+        WARN("Ignore corrupt record %s in %s", path, index->path);
+        return NULL;
+    }
+    return index->map + entry->data_off;
+}
+
+static int index_path(const char *key, const char *name, char *path, size_t len)
+{
+    int nret = snprintf(path, len, "%s/%s", key, name);
+
+    return (nret < 0 || (size_t)nret >= len) ? -1 : 0;
+}
+
+const char *storage_index_get(storage_index_t *index, const char *key, const char *name)
+{
+    char path[PATH_MAX] = { 0 };
+    struct stat st = { 0 };
+    const char *data = NULL;
+
+    if (index == NULL || key == NULL || name == NULL) {
+        return NULL;
+    }
+
+    if (index_path(key, name, path, sizeof(path)) == 0 && fstatat(index->dirfd, path, &st, 0) == 0) {
+        data = index_fresh_data(index, path, &st);
+    }
+    if (data == NULL) {
+        index->misses++;
+    }
+
+    return data;
+}
+
+bool storage_index_need_save(const storage_index_t *index)
+{
+    return index != NULL && index->misses >= STORAGE_INDEX_RESAVE_MISSES;
+}
+
+static int read_staged_file(const storage_index_t *index, struct staged_entry *entry)
+{
+    int ret = -1;
+    int fd = -1;
+    ssize_t nret = 0;
+
+    fd = openat(index->dirfd, entry->path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return errno == ENOENT ? 1 : -1;
+    }
+    // the files are replaced by atomic writes, so this is the stat of what is read
+    if (fstat(fd, &entry->st) != 0 || entry->st.st_size < 0 || entry->st.st_size >= UINT32_MAX) {
+        goto out;
+    }
+
+    entry->owned = util_common_calloc_s((size_t)entry->st.st_size + 1);
+    if (entry->owned == NULL) {
+        ERROR("Out of memory");
+        goto out;
+    }
+    nret = util_read_nointr(fd, entry->owned, (size_t)entry->st.st_size);
+    if (nret != entry->st.st_size) {
+        goto out;
+    }
+    entry->data = entry->owned;
+    entry->data_len = (uint32_t)nret;
+    ret = 0;
+
+out:
+    close(fd);
+    return ret;
+}
+
+int storage_index_add(storage_index_t *index, const char *key, const char *name)
+{
+    char path[PATH_MAX] = { 0 };
+    struct staged_entry *entry = NULL;
+    struct staged_entry *tmp = NULL;
+    size_t new_cap = 0;
+    int ret = 0;
+
+    if (index == NULL || key == NULL || name == NULL) {
+        return -1;
+    }
+
+    if (index_path(key, name, path, sizeof(path)) != 0) {
+        ERROR("Invalid index path %s/%s", key, name);
+        return -1;
+    }
+
+    if (index->staged_len == index->staged_cap) {
+        new_cap = index->staged_cap == 0 ? 64 : index->staged_cap * 2;
+        if (util_mem_realloc((void **)&tmp, new_cap * sizeof(struct staged_entry), index->staged,
+                             index->staged_cap * sizeof(struct staged_entry)) != 0) {
+            ERROR("Out of memory");
+            return -1;
+        }
+        index->staged = tmp;
+        index->staged_cap = new_cap;
+    }
+
+    entry = &index->staged[index->staged_len];
+    (void)memset(entry, 0, sizeof(struct staged_entry));
+
+    if (fstatat(index->dirfd, path, &entry->st, 0) != 0) {
+        // nothing to index
+        return errno == ENOENT ? 0 : -1;
+    }
+
+    // unchanged files are copied from the old index
+    entry->data = index_fresh_data(index, path, &entry->st);
+    if (entry->data != NULL) {
+        entry->data_len = (uint32_t)strlen(entry->data);
+        entry->path = util_strdup_s(path);
+        index->staged_len++;
+        return 0;
+    }
+
+    entry->path = util_strdup_s(path);
+    ret = read_staged_file(index, entry);
+    if (ret != 0) {
+        free(entry->path);
+        free(entry->owned);
+        if (ret > 0) {
+            return 0;
+        }
+        SYSERROR("Failed to read %s for index", path);
+        return -1;
+    }
+
+    index->staged_len++;
+    return 0;
+}
+
+static int staged_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct staged_entry *)a)->path, ((const struct staged_entry *)b)->path);
+}
+
+static void free_staged(storage_index_t *index)
+{
+    size_t i;
+
+    for (i = 0; i < index->staged_len; i++) {
+        free(index->staged[i].path);
+        free(index->staged[i].owned);
+    }
+    free(index->staged);
+    index->staged = NULL;
+    index->staged_len = 0;
+    index->staged_cap = 0;
+}
+
+static char *build_index(storage_index_t *index, size_t *size)
+{
+    struct index_header *header = NULL;
+    struct index_entry *entries = NULL;
+    char *buf = NULL;
+    uint64_t paths_len = 0;
+    uint64_t datas_len = 0;
+    uint64_t off = 0;
+    uint64_t doff = 0;
+    size_t i;
+
+    qsort(index->staged, index->staged_len, sizeof(struct staged_entry), staged_cmp);
+    for (i = 0; i < index->staged_len; i++) {
+        if (i > 0 && strcmp(index->staged[i - 1].path, index->staged[i].path) == 0) {
+            ERROR("Duplicate index path %s", index->staged[i].path);
+            return NULL;
+        }
+        paths_len += strlen(index->staged[i].path) + 1;
+        datas_len += (uint64_t)index->staged[i].data_len + 1;
+    }
+
+    off = sizeof(struct index_header) + index->staged_len * sizeof(struct index_entry);
+    *size = (size_t)(off + paths_len + datas_len);
+    buf = util_common_calloc_s(*size);
+    if (buf == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    header = (struct index_header *)buf;
+    entries = (struct index_entry *)(buf + sizeof(struct index_header));
+    doff = off + paths_len;
+    for (i = 0; i < index->staged_len; i++) {
+        const struct staged_entry *staged = &index->staged[i];
+
+        entries[i].ino = (uint64_t)staged->st.st_ino;
+        entries[i].size = (uint64_t)staged->st.st_size;
+        entries[i].mtime_sec = (int64_t)staged->st.st_mtim.tv_sec;
+        entries[i].mtime_nsec = (int64_t)staged->st.st_mtim.tv_nsec;
+        entries[i].path_off = off;
+        entries[i].path_len = (uint32_t)strlen(staged->path);
+        (void)memcpy(buf + off, staged->path, entries[i].path_len);
+        off += entries[i].path_len + 1;
+        entries[i].data_off = doff;
+        entries[i].data_len = staged->data_len;
+        (void)memcpy(buf + doff, staged->data, staged->data_len);
+        entries[i].data_crc = index_crc(buf + doff, staged->data_len);
+        doff += (uint64_t)staged->data_len + 1;
+    }
+
+    (void)memcpy(header->magic, STORAGE_INDEX_MAGIC, sizeof(header->magic));
+    header->version = STORAGE_INDEX_VERSION;
+    header->count = (uint32_t)index->staged_len;
+    header->size = *size;
+    header->data_start = off;
+    header->table_crc = index_crc(buf + sizeof(struct index_header), off - sizeof(struct index_header));
+    header->header_crc = index_crc(header, offsetof(struct index_header, header_crc));
+
+    return buf;
+}
+
+int storage_index_save(storage_index_t *index)
+{
+    char *buf = NULL;
+    size_t size = 0;
+    int ret = 0;
+
+    if (index == NULL) {
+        return -1;
+    }
+
+    if (index->staged_len > UINT32_MAX) {
+        ERROR("Too many records for index %s", index->path);
+        ret = -1;
+        goto out;
+    }
+
+    buf = build_index(index, &size);
+    if (buf == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    if (util_atomic_write_file(index->path, buf, size, SECURE_CONFIG_FILE_MODE, false) != 0) {
+        ERROR("Failed to save index %s", index->path);
+        ret = -1;
+        goto out;
+    }
+    DEBUG("Saved index %s with %zu records", index->path, index->staged_len);
+    index->misses = 0;
+
+out:
+    free(buf);
+    free_staged(index);
+    return ret;
+}
+
+void storage_index_free(storage_index_t *index)
+{
+    if (index == NULL) {
+        return;
+    }
+
+    free_staged(index);
+    if (index->map != NULL) {
+        (void)munmap(index->map, index->map_size);
+    }
+    if (index->dirfd >= 0) {
+        close(index->dirfd);
+    }
+    free(index->path);
+    free(index);
+}
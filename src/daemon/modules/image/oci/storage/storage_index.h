@@ -0,0 +1,55 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide startup index of the json files of a store
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_IMAGE_OCI_STORAGE_STORAGE_INDEX_H
+#define DAEMON_MODULES_IMAGE_OCI_STORAGE_STORAGE_INDEX_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STORAGE_INDEX_FILE ".index"
+
+/*
+ * Snapshot of the json files of a store in one mmap'd file, <store dir>/.index.
+ * Each record holds the content of <store dir>/<key>/<name> and the inode, size and
+ * mtime the file had, the json files stay the source of truth: a record is used only
+ * while the file is unchanged, and a missing or corrupt index is ignored.
+ */
+typedef struct storage_index storage_index_t;
+
+// map the index of store dir, an index without records is returned if it can not be used
+storage_index_t *storage_index_open(const char *dir);
+
+// content of file name of key, NULL if it is not indexed or changed since
+const char *storage_index_get(storage_index_t *index, const char *key, const char *name);
+
+// too many lookups missed, the index should be saved again after load
+bool storage_index_need_save(const storage_index_t *index);
+
+// add file name of key to the next save, nothing is added if it does not exist
+int storage_index_add(storage_index_t *index, const char *key, const char *name);
+
+// replace the index file with the added files
+int storage_index_save(storage_index_t *index);
+
+void storage_index_free(storage_index_t *index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_IMAGE_OCI_STORAGE_STORAGE_INDEX_H
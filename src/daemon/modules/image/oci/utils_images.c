@@ -35,6 +35,7 @@
 #include "utils_array.h"
 #include "utils_base64.h"
 #include "utils_file.h"
+#include "util_gzip.h"
 #include "utils_string.h"
 #include "utils_verify.h"
 #include "isulad_config.h"
@@ -301,25 +302,32 @@ out:
     return base_name;
 }
 
+static int decompress_layer(const struct io_write_wrapper *writer, void *arg)
+{
+    return util_decompress_file((const char *)arg, writer);
+}
+
 char *oci_calc_diffid(const char *file)
 {
     int ret = 0;
     char *diff_id = NULL;
-    bool gzip = false;
+    compression_type_t compression = COMPRESSION_NONE;
 
     if (file == NULL) {
         ERROR("Invalid NULL param");
         return NULL;
     }
 
-    ret = util_gzip_compressed(file, &gzip);
+    ret = util_detect_compression(file, &compression);
     if (ret != 0) {
-        ERROR("Get layer file %s gzip attribute failed", file);
+        ERROR("Get layer file %s compression attribute failed", file);
         goto out;
     }
 
-    if (gzip) {
+    if (compression == COMPRESSION_GZIP) {
         diff_id = sha256_full_gzip_digest(file);
+    } else if (compression != COMPRESSION_NONE) {
+        diff_id = sha256_full_stream_digest(decompress_layer, (void *)file);
     } else {
         diff_id = sha256_full_file_digest(file);
     }
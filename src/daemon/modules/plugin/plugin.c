@@ -31,6 +31,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/select.h>
+#include <sys/prctl.h>
+#include <time.h>
 
 #include "isula_libutils/log.h"
 #include "plugin_api.h"
@@ -42,8 +44,10 @@
 #include "specs_api.h"
 #include "specs_extend.h"
 #include "rest_common.h"
+#include "http.h"
 #include "container_api.h"
 #include "constants.h"
+#include "linked_list.h"
 #include "isula_libutils/plugin_activate_plugin_request.h"
 #include "isula_libutils/plugin_activate_plugin_response.h"
 #include "isula_libutils/plugin_init_plugin_request.h"
@@ -72,6 +76,17 @@
 
 #define PLUGIN_ACTIVATE_MAX_RETRY 3
 
+/*
+ * default deadline of each event request, a slow plugin does not delay the others.
+ * "plugin-event-timeouts" of daemon.json sets it per plugin.
+ */
+#define PLUGIN_EVENT_TIMEOUT_MS (30 * 1000)
+/* after this many failed requests in a row, fail fast for a while, then let one request try */
+#define PLUGIN_BREAKER_MAX_FAILURES 3
+#define PLUGIN_BREAKER_OPEN_NANOS (10LL * 1000 * 1000 * 1000)
+/* threads sending events of containers to several plugins at the same time */
+#define PLUGIN_EVENT_WORKERS 4
+
 #ifndef RestHttpHead
 #define RestHttpHead "http://localhost"
 #endif
@@ -86,9 +101,9 @@ static plugin_manager_t *g_plugin_manager;
 
 static int pm_init_plugin(const plugin_t *plugin);
 
-static int plugin_event_pre_start_handle(const plugin_t *plugin, const char *cid);
-static int plugin_event_post_stop_handle(const plugin_t *plugin, const char *cid);
-static int plugin_event_post_remove_handle(const plugin_t *plugin, const char *cid);
+static int plugin_event_pre_start_handle(plugin_t *plugin, const char *cid);
+static int plugin_event_post_stop_handle(plugin_t *plugin, const char *cid);
+static int plugin_event_post_remove_handle(plugin_t *plugin, const char *cid);
 
 enum plugin_action { ACTIVE_PLUGIN, DEACTIVE_PLUGIN };
 
@@ -457,6 +472,8 @@ static void free_plugin(plugin_t *plugin)
     UTIL_FREE_AND_SET_NULL(plugin->addr);
     UTIL_FREE_AND_SET_NULL(plugin->manifest);
     UTIL_FREE_AND_SET_NULL(plugin->activated_errmsg);
+    http_conn_free(plugin->conn);
+    plugin->conn = NULL;
     free(plugin);
 }
 
@@ -562,6 +579,11 @@ static int handle_plugin_event(const char *event_name, const char *plugin_dir, i
     if (get_plugin_addr_and_name(addr, name, event_name, plugin_dir, action) < 0) {
         return -1;
     }
+    if (strcmp(name, AUTHZ_PLUGIN_NAME) == 0) {
+        // the restarted authz plugin may carry a new policy, drop its cached decisions
+        INFO("Authz plugin %s is %s", name, action == ACTIVE_PLUGIN ? "started" : "stopped");
+        authz_http_invalidate();
+    }
     switch (action) {
         case ACTIVE_PLUGIN:
             INFO("Activate plugin: %s...", name);
@@ -777,6 +799,17 @@ plugin_t *plugin_new(const char *name, const char *addr)
         goto bad;
     }
 
+    plugin->conn = http_conn_new(addr);
+    if (plugin->conn == NULL) {
+        goto bad;
+    }
+
+    plugin->event_timeout_ms = PLUGIN_EVENT_TIMEOUT_MS;
+    if (conf_get_plugin_event_timeout(name, &plugin->event_timeout_ms) < 0) {
+        WARN("Use default event timeout %dms for plugin %s", PLUGIN_EVENT_TIMEOUT_MS, name);
+        plugin->event_timeout_ms = PLUGIN_EVENT_TIMEOUT_MS;
+    }
+
     return plugin;
 
 bad:
@@ -859,6 +892,148 @@ bool plugin_is_watching(plugin_t *plugin, uint64_t pe)
     return ok;
 }
 
+void plugin_get_stats(plugin_t *plugin, plugin_stats_t *stats)
+{
+    if (plugin == NULL || stats == NULL) {
+        return;
+    }
+
+    plugin_rdlock(plugin);
+    *stats = plugin->stats;
+    plugin_unlock(plugin);
+}
+
+static int64_t plugin_now_nanos(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+static bool plugin_breaker_allow(plugin_t *plugin)
+{
+    bool allow = true;
+    int64_t now = plugin_now_nanos();
+
+    plugin_wrlock(plugin);
+    if (plugin->open_until != 0) {
+        if (now < plugin->open_until) {
+            plugin->stats.rejected++;
+            allow = false;
+        } else {
+            // half open, others fail fast until this request is answered
+            plugin->open_until = now + PLUGIN_BREAKER_OPEN_NANOS;
+        }
+    }
+    plugin_unlock(plugin);
+
+    return allow;
+}
+
+static void plugin_record_request(plugin_t *plugin, bool failed, int64_t start)
+{
+    int64_t now = plugin_now_nanos();
+    uint64_t latency_us = (uint64_t)((now - start) / 1000);
+
+    plugin_wrlock(plugin);
+    plugin->stats.requests++;
+    plugin->stats.latency_total_us += latency_us;
+    if (latency_us > plugin->stats.latency_max_us) {
+        plugin->stats.latency_max_us = latency_us;
+    }
+    if (!failed) {
+        if (plugin->open_until != 0) {
+            INFO("plugin %s is available again", plugin->name);
+        }
+        plugin->consecutive_failures = 0;
+        plugin->open_until = 0;
+    } else {
+        plugin->stats.failures++;
+        plugin->consecutive_failures++;
+        if (plugin->consecutive_failures >= PLUGIN_BREAKER_MAX_FAILURES) {
+            if (plugin->open_until == 0) {
+                WARN("plugin %s failed %u requests in a row, fail its events fast for a while", plugin->name,
+                     plugin->consecutive_failures);
+            }
+            plugin->open_until = now + PLUGIN_BREAKER_OPEN_NANOS;
+        }
+    }
+    plugin_unlock(plugin);
+}
+
+/* like get_response(), without the dlopen'd handle of rest_common which events of plugins must not share */
+static int plugin_get_response(const Buffer *output, unpack_response_func_t unpack_func, void *arg)
+{
+    int ret = 0;
+    const char *tmp = NULL;
+    struct parsed_http_message *msg = NULL;
+
+    tmp = strstr(output->contents, "HTTP/1.1");
+    if (tmp == NULL) {
+        ERROR("Failed to parse response, the response did not have HTTP/1.1");
+        return -1;
+    }
+
+    msg = util_common_calloc_s(sizeof(struct parsed_http_message));
+    if (msg == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    ret = parse_http(tmp, buffer_strlen(output) - (size_t)(tmp - output->contents), msg, HTTP_RESPONSE);
+    if (ret != 0) {
+        ERROR("Failed to parse response");
+        ret = -1;
+        goto out;
+    }
+
+    ret = unpack_func(msg, arg);
+
+out:
+    free(msg->body);
+    free(msg);
+    return ret;
+}
+
+/*
+ * send event request on the persistent connections of plugin, requests at the same time
+ * to one plugin go on different connections.
+ */
+static int plugin_event_request(plugin_t *plugin, const char *url, const char *body, size_t body_len,
+                                unpack_response_func_t unpack_func, void *arg)
+{
+    int ret = 0;
+    int64_t start = 0;
+    Buffer *output = NULL;
+
+    if (!plugin_breaker_allow(plugin)) {
+        ERROR("plugin %s is unavailable, it failed %d requests in a row", plugin->name,
+              PLUGIN_BREAKER_MAX_FAILURES);
+        return -1;
+    }
+
+    output = buffer_alloc(HTTP_GET_BUFFER_SIZE);
+    if (output == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    start = plugin_now_nanos();
+    ret = http_conn_post(plugin->conn, url, body, body_len, plugin->event_timeout_ms, output, NULL);
+    plugin_record_request(plugin, ret != 0, start);
+    if (ret != 0) {
+        ERROR("send request %s to plugin %s failed", url, plugin->name);
+        goto out;
+    }
+
+    ret = plugin_get_response(output, unpack_func, arg);
+
+out:
+    buffer_free(output);
+    return ret;
+}
+
 static int unpack_activate_response(const struct parsed_http_message *message, void *arg)
 {
     int ret = 0;
@@ -1337,11 +1512,200 @@ bad:
     return -1;
 }
 
+static int plugin_event_handle(plugin_t *plugin, const char *cid, uint64_t pe)
+{
+    switch (pe) {
+        case PLUGIN_EVENT_CONTAINER_PRE_START:
+            return plugin_event_pre_start_handle(plugin, cid);
+        case PLUGIN_EVENT_CONTAINER_POST_STOP:
+            return plugin_event_post_stop_handle(plugin, cid);
+        case PLUGIN_EVENT_CONTAINER_POST_REMOVE:
+            return plugin_event_post_remove_handle(plugin, cid);
+        default:
+            ERROR("plugin event %ld not support.", pe);
+            return -1;
+    }
+}
+
+struct plugin_event_batch {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    /* jobs of the batch not done yet, protected by mutex */
+    size_t pending;
+};
+
+struct plugin_event_job {
+    plugin_t *plugin;
+    const char *cid;
+    uint64_t pe;
+    int ret;
+    /* error message is thread local, bring it back to the dispatching thread */
+    char *errmsg;
+    struct plugin_event_batch *batch;
+    /* waiting in the queue of the pool, protected by the mutex of the pool */
+    bool queued;
+    struct linked_list node;
+};
+
+/* threads sending events to plugins, shared by the events of all containers */
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct linked_list jobs;
+} g_plugin_event_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, { NULL, NULL, NULL } };
+static pthread_once_t g_plugin_event_pool_once = PTHREAD_ONCE_INIT;
+static int g_plugin_event_pool_ret = -1;
+
+static void plugin_event_job_run(struct plugin_event_job *job)
+{
+    job->ret = plugin_event_handle(job->plugin, job->cid, job->pe);
+    if (g_isulad_errmsg != NULL) {
+        job->errmsg = util_strdup_s(g_isulad_errmsg);
+        DAEMON_CLEAR_ERRMSG();
+    }
+
+    if (job->batch == NULL) {
+        return;
+    }
+    (void)pthread_mutex_lock(&job->batch->mutex);
+    job->batch->pending--;
+    if (job->batch->pending == 0) {
+        (void)pthread_cond_signal(&job->batch->cond);
+    }
+    (void)pthread_mutex_unlock(&job->batch->mutex);
+}
+
+static void *plugin_event_worker(void *arg)
+{
+    struct plugin_event_job *job = NULL;
+
+    (void)arg;
+    (void)prctl(PR_SET_NAME, "PluginEvent");
+
+    for (;;) {
+        (void)pthread_mutex_lock(&g_plugin_event_pool.mutex);
+        while (linked_list_empty(&g_plugin_event_pool.jobs)) {
+            (void)pthread_cond_wait(&g_plugin_event_pool.cond, &g_plugin_event_pool.mutex);
+        }
+        job = linked_list_first_elem(&g_plugin_event_pool.jobs);
+        linked_list_del(&job->node);
+        job->queued = false;
+        (void)pthread_mutex_unlock(&g_plugin_event_pool.mutex);
+
+        plugin_event_job_run(job);
+    }
+
+    return NULL;
+}
+
+static void plugin_event_pool_init(void)
+{
+    size_t i;
+    pthread_t tid;
+
+    linked_list_init(&g_plugin_event_pool.jobs);
+    for (i = 0; i < PLUGIN_EVENT_WORKERS; i++) {
+        if (pthread_create(&tid, NULL, plugin_event_worker, NULL) != 0) {
+            ERROR("Failed to create plugin event thread");
+            // the threads started serve the queue, with none the events are sent in place
+            if (i > 0) {
+                g_plugin_event_pool_ret = 0;
+            }
+            return;
+        }
+        if (pthread_detach(tid) != 0) {
+            SYSERROR("Failed to detach plugin event thread");
+        }
+    }
+    g_plugin_event_pool_ret = 0;
+}
+
+/*
+ * plugins do not depend on each other for events other than pre-create, ask them at the same time.
+ * The first job is run in place, the others are queued to the pool. Jobs still queued when the
+ * first is done are taken back and run in place, so a busy pool never holds the event up.
+ */
+static int plugin_event_run_jobs(struct plugin_event_job *jobs, size_t len)
+{
+    int ret = 0;
+    bool errmsg_set = false;
+    size_t i = 0;
+    struct plugin_event_batch batch;
+
+    (void)pthread_once(&g_plugin_event_pool_once, plugin_event_pool_init);
+    if (len == 1 || g_plugin_event_pool_ret != 0) {
+        for (i = 0; i < len; i++) {
+            if (plugin_event_handle(jobs[i].plugin, jobs[i].cid, jobs[i].pe) != 0) {
+                ret = -1;
+            }
+        }
+        return ret;
+    }
+
+    (void)pthread_mutex_init(&batch.mutex, NULL);
+    (void)pthread_cond_init(&batch.cond, NULL);
+    batch.pending = len;
+
+    (void)pthread_mutex_lock(&g_plugin_event_pool.mutex);
+    for (i = 0; i < len; i++) {
+        jobs[i].batch = &batch;
+        if (i == 0) {
+            continue;
+        }
+        linked_list_add_elem(&jobs[i].node, &jobs[i]);
+        linked_list_add_tail(&g_plugin_event_pool.jobs, &jobs[i].node);
+        jobs[i].queued = true;
+    }
+    (void)pthread_cond_broadcast(&g_plugin_event_pool.cond);
+    (void)pthread_mutex_unlock(&g_plugin_event_pool.mutex);
+
+    plugin_event_job_run(&jobs[0]);
+    for (i = 1; i < len; i++) {
+        bool take = false;
+
+        (void)pthread_mutex_lock(&g_plugin_event_pool.mutex);
+        if (jobs[i].queued) {
+            linked_list_del(&jobs[i].node);
+            jobs[i].queued = false;
+            take = true;
+        }
+        (void)pthread_mutex_unlock(&g_plugin_event_pool.mutex);
+        if (take) {
+            plugin_event_job_run(&jobs[i]);
+        }
+    }
+
+    (void)pthread_mutex_lock(&batch.mutex);
+    while (batch.pending > 0) {
+        (void)pthread_cond_wait(&batch.cond, &batch.mutex);
+    }
+    (void)pthread_mutex_unlock(&batch.mutex);
+    (void)pthread_cond_destroy(&batch.cond);
+    (void)pthread_mutex_destroy(&batch.mutex);
+
+    for (i = 0; i < len; i++) {
+        if (jobs[i].ret != 0) {
+            ret = -1;
+        }
+        if (jobs[i].errmsg != NULL && !errmsg_set) {
+            isulad_set_error_message("%s", jobs[i].errmsg);
+            errmsg_set = true;
+        }
+        free(jobs[i].errmsg);
+        jobs[i].errmsg = NULL;
+    }
+
+    return ret;
+}
+
 static int plugin_event_handle_dispath_impl(const char *cid, const char *plugins, uint64_t pe)
 {
     int ret = 0;
     plugin_t *plugin = NULL;
     char **pnames = NULL;
+    size_t pnames_len = 0;
+    struct plugin_event_job *jobs = NULL;
+    size_t jobs_len = 0;
     size_t i = 0;
 
     pnames = get_enable_plugins(plugins);
@@ -1349,7 +1713,15 @@ static int plugin_event_handle_dispath_impl(const char *cid, const char *plugins
         goto out;
     }
 
-    for (i = 0; i < util_array_len((const char **)pnames); i++) {
+    pnames_len = util_array_len((const char **)pnames);
+    jobs = util_smart_calloc_s(sizeof(struct plugin_event_job), pnames_len);
+    if (jobs == NULL) {
+        ERROR("Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    for (i = 0; i < pnames_len; i++) {
         if (pm_get_plugin(pnames[i], &plugin)) { /* plugin not found */
             ERROR("plugin %s not registered.", pnames[i]);
             ret = -1;
@@ -1360,31 +1732,23 @@ static int plugin_event_handle_dispath_impl(const char *cid, const char *plugins
             continue;
         }
 
-        switch (pe) {
-            case PLUGIN_EVENT_CONTAINER_PRE_START:
-                ret = plugin_event_pre_start_handle(plugin, cid);
-                break;
-            case PLUGIN_EVENT_CONTAINER_POST_STOP:
-                ret = plugin_event_post_stop_handle(plugin, cid);
-                break;
-            case PLUGIN_EVENT_CONTAINER_POST_REMOVE:
-                ret = plugin_event_post_remove_handle(plugin, cid);
-                break;
-            default:
-                ERROR("plugin event %ld not support.", pe);
-                ret = -1;
-                break;
-        }
-
-        pm_put_plugin(plugin);
+        /* pm_put_plugin() called after the job is done */
+        jobs[jobs_len].plugin = plugin;
+        jobs[jobs_len].cid = cid;
+        jobs[jobs_len].pe = pe;
+        jobs_len++;
         plugin = NULL;
-        if (ret != 0) {
-            ret = -1;
-            continue;
-        }
+    }
+
+    if (jobs_len > 0 && plugin_event_run_jobs(jobs, jobs_len) != 0) {
+        ret = -1;
     }
 
 out:
+    for (i = 0; i < jobs_len; i++) {
+        pm_put_plugin(jobs[i].plugin);
+    }
+    free(jobs);
     util_free_array(pnames);
     return ret;
 }
@@ -1460,10 +1824,9 @@ out:
     return ret;
 }
 
-static int plugin_event_pre_create_handle(const plugin_t *plugin, const char *cid, char **base)
+static int plugin_event_pre_create_handle(plugin_t *plugin, const char *cid, char **base)
 {
     int ret = 0;
-    int nret = 0;
     char *body = NULL;
     size_t body_len = 0;
     struct parser_context ctx = {
@@ -1471,10 +1834,8 @@ static int plugin_event_pre_create_handle(const plugin_t *plugin, const char *ci
         0,
     };
     parser_error err = NULL;
-    Buffer *output = NULL;
     char *dst = NULL;
     char *new = NULL;
-    char socket[PATH_MAX] = { 0 };
     plugin_event_pre_create_request reqs = { 0 };
 
     reqs.id = (char *)cid;
@@ -1488,24 +1849,11 @@ static int plugin_event_pre_create_handle(const plugin_t *plugin, const char *ci
     }
 
     body_len = strlen(body) + 1;
-    nret = snprintf(socket, sizeof(socket), "unix://%s", plugin->addr);
-    if (nret < 0 || (size_t)nret >= sizeof(socket)) {
-        ERROR("get plugin socket failed %s", plugin->addr);
-        ret = -1;
-        goto out;
-    }
-
-    ret = rest_send_requst(socket, RestHttpHead PluginServicePreCreate, body, body_len, &output);
-    if (ret != 0) {
-        ret = -1;
-        ERROR("send event precreate request to %s failed", plugin->addr);
-        goto out;
-    }
-
-    ret = get_response(output, unpack_event_pre_create_response, (void *)(&new));
+    ret = plugin_event_request(plugin, RestHttpHead PluginServicePreCreate, body, body_len, unpack_event_pre_create_response,
+                               (void *)(&new));
     if (ret != 0) {
         ret = -1;
-        ERROR("unpack event precreate response from %s failed", plugin->addr);
+        ERROR("event precreate request to %s failed", plugin->addr);
         goto out;
     }
 
@@ -1523,7 +1871,6 @@ static int plugin_event_pre_create_handle(const plugin_t *plugin, const char *ci
 out:
     free(dst);
     free(new);
-    buffer_free(output);
     free(err);
     free(body);
     return ret;
@@ -1635,10 +1982,9 @@ out:
     return ret;
 }
 
-static int plugin_event_pre_start_handle(const plugin_t *plugin, const char *cid)
+static int plugin_event_pre_start_handle(plugin_t *plugin, const char *cid)
 {
     int ret = 0;
-    int nret = 0;
     char *body = NULL;
     size_t body_len = 0;
     struct parser_context ctx = {
@@ -1646,8 +1992,6 @@ static int plugin_event_pre_start_handle(const plugin_t *plugin, const char *cid
         0,
     };
     parser_error err = NULL;
-    Buffer *output = NULL;
-    char socket[PATH_MAX] = { 0 };
     plugin_event_pre_start_request reqs = { 0 };
 
     reqs.id = (char *)cid;
@@ -1660,30 +2004,15 @@ static int plugin_event_pre_start_handle(const plugin_t *plugin, const char *cid
     }
 
     body_len = strlen(body) + 1;
-    nret = snprintf(socket, sizeof(socket), "unix://%s", plugin->addr);
-    if (nret < 0 || (size_t)nret >= sizeof(socket)) {
-        ERROR("get plugin socket failed %s", plugin->addr);
-        ret = -1;
-        goto out;
-    }
-
-    ret = rest_send_requst(socket, RestHttpHead PluginServicePreStart, body, body_len, &output);
+    ret = plugin_event_request(plugin, RestHttpHead PluginServicePreStart, body, body_len, unpack_event_pre_start_response,
+                               NULL);
     if (ret != 0) {
         ret = -1;
-        ERROR("send event prestart request to %s failed", plugin->addr);
-        goto out;
-    }
-
-    ret = get_response(output, unpack_event_pre_start_response, NULL);
-    if (ret != 0) {
-        ret = -1;
-        ERROR("unpack event prestart response from %s failed", plugin->addr);
+        ERROR("event prestart request to %s failed", plugin->addr);
         goto out;
     }
 
 out:
-    buffer_free(output);
-
     free(err);
     free(body);
     return ret;
@@ -1735,10 +2064,9 @@ out:
     return ret;
 }
 
-static int plugin_event_post_stop_handle(const plugin_t *plugin, const char *cid)
+static int plugin_event_post_stop_handle(plugin_t *plugin, const char *cid)
 {
     int ret = 0;
-    int nret = 0;
     char *body = NULL;
     size_t body_len = 0;
     struct parser_context ctx = {
@@ -1746,8 +2074,6 @@ static int plugin_event_post_stop_handle(const plugin_t *plugin, const char *cid
         0,
     };
     parser_error err = NULL;
-    Buffer *output = NULL;
-    char socket[PATH_MAX] = { 0 };
     plugin_event_post_stop_request reqs = { 0 };
 
     reqs.id = (char *)cid;
@@ -1760,29 +2086,15 @@ static int plugin_event_post_stop_handle(const plugin_t *plugin, const char *cid
     }
 
     body_len = strlen(body) + 1;
-    nret = snprintf(socket, sizeof(socket), "unix://%s", plugin->addr);
-    if (nret < 0 || (size_t)nret >= sizeof(socket)) {
-        ERROR("get plugin socket failed %s", plugin->addr);
-        ret = -1;
-        goto out;
-    }
-
-    ret = rest_send_requst(socket, RestHttpHead PluginServicePostStop, body, body_len, &output);
+    ret = plugin_event_request(plugin, RestHttpHead PluginServicePostStop, body, body_len, unpack_event_post_stop_response,
+                               NULL);
     if (ret != 0) {
         ret = -1;
-        ERROR("send event post_stop request to %s failed", plugin->addr);
-        goto out;
-    }
-
-    ret = get_response(output, unpack_event_post_stop_response, NULL);
-    if (ret != 0) {
-        ret = -1;
-        ERROR("unpack event post_stop response from %s failed", plugin->addr);
+        ERROR("event post_stop request to %s failed", plugin->addr);
         goto out;
     }
 
 out:
-    buffer_free(output);
     free(err);
     free(body);
     return ret;
@@ -1834,10 +2146,9 @@ out:
     return ret;
 }
 
-static int plugin_event_post_remove_handle(const plugin_t *plugin, const char *cid)
+static int plugin_event_post_remove_handle(plugin_t *plugin, const char *cid)
 {
     int ret = 0;
-    int nret = 0;
     char *body = NULL;
     size_t body_len = 0;
     struct parser_context ctx = {
@@ -1845,8 +2156,6 @@ static int plugin_event_post_remove_handle(const plugin_t *plugin, const char *c
         0,
     };
     parser_error err = NULL;
-    Buffer *output = NULL;
-    char socket[PATH_MAX] = { 0 };
     plugin_event_post_remove_request reqs = { 0 };
 
     reqs.id = (char *)cid;
@@ -1859,29 +2168,15 @@ static int plugin_event_post_remove_handle(const plugin_t *plugin, const char *c
     }
 
     body_len = strlen(body) + 1;
-    nret = snprintf(socket, sizeof(socket), "unix://%s", plugin->addr);
-    if (nret < 0 || (size_t)nret >= sizeof(socket)) {
-        ERROR("get plugin socket failed %s", plugin->addr);
-        ret = -1;
-        goto out;
-    }
-
-    ret = rest_send_requst(socket, RestHttpHead PluginServicePostRemove, body, body_len, &output);
+    ret = plugin_event_request(plugin, RestHttpHead PluginServicePostRemove, body, body_len, unpack_event_post_remove_response,
+                               NULL);
     if (ret != 0) {
         ret = -1;
-        ERROR("send event post_remove request to %s failed", plugin->addr);
-        goto out;
-    }
-
-    ret = get_response(output, unpack_event_post_remove_response, NULL);
-    if (ret != 0) {
-        ret = -1;
-        ERROR("unpack event post_remove response from %s failed", plugin->addr);
+        ERROR("event post_remove request to %s failed", plugin->addr);
         goto out;
     }
 
 out:
-    buffer_free(output);
     free(err);
     free(body);
     return ret;
@@ -31,6 +31,7 @@
 #include "err_msg.h"
 #include "runtime_api.h"
 #include "utils_file.h"
+#include "utils_trash.h"
 
 bool rt_lcr_detect(const char *runtime)
 {
@@ -199,6 +200,7 @@ static int remove_container_rootpath(const char *id, const char *root_path)
 {
     int ret = 0;
     char cont_root_path[PATH_MAX] = { 0 };
+    char *isulad_root = NULL;
 
     ret = snprintf(cont_root_path, sizeof(cont_root_path), "%s/%s", root_path, id);
     if (ret < 0 || (size_t)ret >= sizeof(cont_root_path)) {
@@ -206,7 +208,8 @@ static int remove_container_rootpath(const char *id, const char *root_path)
         ret = -1;
         goto out;
     }
-    ret = util_recursive_rmdir(cont_root_path, 0);
+    isulad_root = conf_get_isulad_rootdir();
+    ret = util_trash_path(isulad_root, cont_root_path);
     if (ret != 0) {
         const char *tmp_err = (errno != 0) ? strerror(errno) : "error";
         ERROR("Failed to delete container's root directory %s: %s", cont_root_path, tmp_err);
@@ -216,6 +219,7 @@ static int remove_container_rootpath(const char *id, const char *root_path)
     }
 
 out:
+    free(isulad_root);
     return ret;
 }
 
@@ -0,0 +1,658 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide cgroup update and pids of isulad-shim containers
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "isula_rt_cgroup.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <unistd.h>
+
+#include "isula_libutils/log.h"
+#include "err_msg.h"
+#include "sysinfo.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_convert.h"
+#include "utils_file.h"
+#include "utils_string.h"
+#include "utils_timestamp.h"
+
+/*
+ * isulad-shim has no update and ps of its own, the limits are written to the cgroup files of
+ * the container the way runc update does, and the pids are read from cgroup.procs, without
+ * running the runtime binary for each call.
+ */
+#define CGROUP_PROCS "cgroup.procs"
+#define CGROUP_VALUE_LEN 64
+#define CGROUP_PIDS_INIT_LEN 16
+
+// the cgroup path is from the root of the host hierarchy, the hierarchy mounted here may only be a sub tree
+static const char *cgroup_path_in_mount(const char *cgroup_path, const char *root)
+{
+    size_t len = strlen(root);
+
+    while (len > 0 && root[len - 1] == '/') {
+        len--;
+    }
+    if (len == 0 || strncmp(cgroup_path, root, len) != 0) {
+        return cgroup_path;
+    }
+    if (cgroup_path[len] != '/' && cgroup_path[len] != '\0') {
+        return cgroup_path;
+    }
+
+    return cgroup_path + len;
+}
+
+static char *cgroup_dir(int version, const char *subsystem, const char *cgroup_path)
+{
+    char *mountpoint = NULL;
+    char *root = NULL;
+    char *dir = NULL;
+
+    if (version == CGROUP_VERSION_2) {
+        return util_path_join(CGROUP_MOUNTPOINT, cgroup_path);
+    }
+
+    if (find_cgroup_mountpoint_and_root(subsystem, &mountpoint, &root) != 0 || mountpoint == NULL ||
+        root == NULL) {
+        ERROR("Cgroup subsystem %s is not mounted", subsystem);
+        goto out;
+    }
+    dir = util_path_join(mountpoint, cgroup_path_in_mount(cgroup_path, root));
+
+out:
+    free(mountpoint);
+    free(root);
+    return dir;
+}
+
+static int cgroup_file_path(const char *dir, const char *file, char *path, size_t len)
+{
+    int nret = snprintf(path, len, "%s/%s", dir, file);
+
+    if (nret < 0 || (size_t)nret >= len) {
+        ERROR("Path %s/%s is too long", dir, file);
+        return -1;
+    }
+    return 0;
+}
+
+static int cgroup_write(const char *dir, const char *file, const char *value)
+{
+    int ret = 0;
+    int fd = -1;
+    ssize_t len = 0;
+    char path[PATH_MAX] = { 0 };
+
+    if (cgroup_file_path(dir, file, path, sizeof(path)) != 0) {
+        return -1;
+    }
+
+    fd = util_open(path, O_WRONLY | O_TRUNC | O_CLOEXEC, 0);
+    if (fd < 0) {
+        SYSERROR("Failed to open %s", path);
+        isulad_set_error_message("Failed to open %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    len = util_write_nointr(fd, value, strlen(value));
+    if (len < 0 || (size_t)len != strlen(value)) {
+        SYSERROR("Failed to write %s to %s", value, path);
+        isulad_set_error_message("Failed to write %s to %s: %s", value, path, strerror(errno));
+        ret = -1;
+    }
+    close(fd);
+
+    return ret;
+}
+
+// negative value is no limit
+static int cgroup_write_limit(int version, const char *dir, const char *file, int64_t value)
+{
+    char buf[CGROUP_VALUE_LEN] = { 0 };
+
+    if (value < 0) {
+        return cgroup_write(dir, file, version == CGROUP_VERSION_2 ? "max" : "-1");
+    }
+    (void)snprintf(buf, sizeof(buf), "%lld", (long long)value);
+    return cgroup_write(dir, file, buf);
+}
+
+static int cgroup_write_uint(const char *dir, const char *file, uint64_t value)
+{
+    char buf[CGROUP_VALUE_LEN] = { 0 };
+
+    (void)snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+    return cgroup_write(dir, file, buf);
+}
+
+// "max" is returned as -1
+static int cgroup_parse_limit(const char *str, long long *value)
+{
+    if (strcmp(str, "max") == 0) {
+        *value = -1;
+        return 0;
+    }
+    return util_safe_llong(str, value);
+}
+
+static char *cgroup_read(const char *dir, const char *file)
+{
+    char path[PATH_MAX] = { 0 };
+    char *content = NULL;
+
+    if (cgroup_file_path(dir, file, path, sizeof(path)) != 0) {
+        return NULL;
+    }
+
+    content = util_read_content_from_file(path);
+    if (content == NULL) {
+        ERROR("Failed to read %s", path);
+        isulad_set_error_message("Failed to read %s", path);
+        return NULL;
+    }
+    (void)util_trim_space(content);
+
+    return content;
+}
+
+static int cgroup_read_limit(const char *dir, const char *file, long long *value)
+{
+    int ret = 0;
+    char *content = cgroup_read(dir, file);
+
+    if (content == NULL) {
+        return -1;
+    }
+    if (cgroup_parse_limit(content, value) != 0) {
+        ERROR("Invalid value %s of %s/%s", content, dir, file);
+        ret = -1;
+    }
+    free(content);
+
+    return ret;
+}
+
+static int update_blkio(int version, const char *cgroup_path, const host_config *hostconfig)
+{
+    int ret = 0;
+    char *dir = NULL;
+    char buf[CGROUP_VALUE_LEN] = { 0 };
+    uint64_t weight = hostconfig->blkio_weight;
+
+    if (weight == 0) {
+        return 0;
+    }
+
+    dir = cgroup_dir(version, "blkio", cgroup_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    if (version == CGROUP_VERSION_2) {
+        // blkio weight [10, 1000] to io weight [1, 10000]
+        weight = 1 + (weight - 10) * 9999 / 990;
+        (void)snprintf(buf, sizeof(buf), "default %llu", (unsigned long long)weight);
+        ret = cgroup_write(dir, "io.weight", buf);
+    } else {
+        ret = cgroup_write_uint(dir, "blkio.weight", weight);
+    }
+
+    free(dir);
+    return ret;
+}
+
+static void get_cpu_quota(const host_config *hostconfig, int64_t *period, int64_t *quota)
+{
+    *period = hostconfig->cpu_period;
+    *quota = hostconfig->cpu_quota;
+
+    if (hostconfig->nano_cpus > 0) {
+        *period = (int64_t)(100 * Time_Milli / Time_Micro);
+        *quota = hostconfig->nano_cpus * (*period) / 1e9;
+    }
+}
+
+static int update_cpu_v1(const char *dir, const host_config *hostconfig, int64_t period, int64_t quota)
+{
+    if (hostconfig->cpu_shares != 0 && cgroup_write_uint(dir, "cpu.shares", (uint64_t)hostconfig->cpu_shares) != 0) {
+        return -1;
+    }
+    if (period != 0 && cgroup_write_uint(dir, "cpu.cfs_period_us", (uint64_t)period) != 0) {
+        return -1;
+    }
+    if (quota != 0 && cgroup_write_limit(CGROUP_VERSION_1, dir, "cpu.cfs_quota_us", quota) != 0) {
+        return -1;
+    }
+    if (hostconfig->cpu_realtime_period != 0 &&
+        cgroup_write_uint(dir, "cpu.rt_period_us", (uint64_t)hostconfig->cpu_realtime_period) != 0) {
+        return -1;
+    }
+    if (hostconfig->cpu_realtime_runtime != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "cpu.rt_runtime_us", hostconfig->cpu_realtime_runtime) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int update_cpu_max(const char *dir, int64_t period, int64_t quota)
+{
+    int ret = -1;
+    char *content = NULL;
+    char **fields = NULL;
+    long long cur_quota = 0;
+    long long cur_period = 0;
+    char buf[CGROUP_VALUE_LEN] = { 0 };
+
+    // cpu.max is "$QUOTA $PERIOD", keep the one not updated
+    content = cgroup_read(dir, "cpu.max");
+    if (content == NULL) {
+        return -1;
+    }
+    fields = util_string_split_multi(content, ' ');
+    if (fields == NULL || util_array_len((const char **)fields) != 2 ||
+        cgroup_parse_limit(fields[0], &cur_quota) != 0 || util_safe_llong(fields[1], &cur_period) != 0) {
+        ERROR("Invalid cpu.max %s of %s", content, dir);
+        goto out;
+    }
+
+    if (quota != 0) {
+        cur_quota = quota;
+    }
+    if (period != 0) {
+        cur_period = period;
+    }
+
+    if (cur_quota < 0) {
+        (void)snprintf(buf, sizeof(buf), "max %lld", cur_period);
+    } else {
+        (void)snprintf(buf, sizeof(buf), "%lld %lld", cur_quota, cur_period);
+    }
+    ret = cgroup_write(dir, "cpu.max", buf);
+
+out:
+    util_free_array(fields);
+    free(content);
+    return ret;
+}
+
+static int update_cpu_v2(const char *dir, const host_config *hostconfig, int64_t period, int64_t quota)
+{
+    uint64_t shares = (uint64_t)hostconfig->cpu_shares;
+
+    if (hostconfig->cpu_realtime_period != 0 || hostconfig->cpu_realtime_runtime != 0) {
+        ERROR("Cpu realtime is not supported on cgroup v2");
+        isulad_set_error_message("Cpu realtime is not supported on cgroup v2");
+        return -1;
+    }
+
+    if (shares != 0) {
+        // cpu shares [2, 262144] to cpu weight [1, 10000]
+        shares = shares < 2 ? 2 : (shares > 262144 ? 262144 : shares);
+        if (cgroup_write_uint(dir, "cpu.weight", 1 + ((shares - 2) * 9999) / 262142) != 0) {
+            return -1;
+        }
+    }
+
+    if (period != 0 || quota != 0) {
+        return update_cpu_max(dir, period, quota);
+    }
+
+    return 0;
+}
+
+static int update_cpu(int version, const char *cgroup_path, const host_config *hostconfig)
+{
+    int ret = 0;
+    char *dir = NULL;
+    int64_t period = 0;
+    int64_t quota = 0;
+
+    get_cpu_quota(hostconfig, &period, &quota);
+    if (hostconfig->cpu_shares == 0 && period == 0 && quota == 0 && hostconfig->cpu_realtime_period == 0 &&
+        hostconfig->cpu_realtime_runtime == 0) {
+        return 0;
+    }
+
+    dir = cgroup_dir(version, "cpu", cgroup_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    if (version == CGROUP_VERSION_2) {
+        ret = update_cpu_v2(dir, hostconfig, period, quota);
+    } else {
+        ret = update_cpu_v1(dir, hostconfig, period, quota);
+    }
+
+    free(dir);
+    return ret;
+}
+
+static int update_cpuset(int version, const char *cgroup_path, const host_config *hostconfig)
+{
+    int ret = 0;
+    char *dir = NULL;
+
+    if (hostconfig->cpuset_cpus == NULL && hostconfig->cpuset_mems == NULL) {
+        return 0;
+    }
+
+    dir = cgroup_dir(version, "cpuset", cgroup_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    if (hostconfig->cpuset_cpus != NULL && cgroup_write(dir, "cpuset.cpus", hostconfig->cpuset_cpus) != 0) {
+        ret = -1;
+        goto out;
+    }
+    if (hostconfig->cpuset_mems != NULL && cgroup_write(dir, "cpuset.mems", hostconfig->cpuset_mems) != 0) {
+        ret = -1;
+        goto out;
+    }
+
+out:
+    free(dir);
+    return ret;
+}
+
+static int update_memory_v1(const char *dir, const host_config *hostconfig)
+{
+    long long cur = 0;
+    bool swap_first = false;
+
+    if (hostconfig->memory != 0 && hostconfig->memory_swap != 0) {
+        // memory limit can not be larger than memsw limit, raise memsw first and lower it last
+        if (cgroup_read_limit(dir, "memory.limit_in_bytes", &cur) != 0) {
+            return -1;
+        }
+        swap_first = hostconfig->memory < 0 || (cur >= 0 && hostconfig->memory > cur);
+    }
+
+    if (swap_first &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "memory.memsw.limit_in_bytes", hostconfig->memory_swap) != 0) {
+        return -1;
+    }
+    if (hostconfig->memory != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "memory.limit_in_bytes", hostconfig->memory) != 0) {
+        return -1;
+    }
+    if (!swap_first && hostconfig->memory_swap != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "memory.memsw.limit_in_bytes", hostconfig->memory_swap) != 0) {
+        return -1;
+    }
+    if (hostconfig->memory_reservation != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "memory.soft_limit_in_bytes", hostconfig->memory_reservation) != 0) {
+        return -1;
+    }
+    if (hostconfig->kernel_memory != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_1, dir, "memory.kmem.limit_in_bytes", hostconfig->kernel_memory) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int update_memory_swap_v2(const char *dir, const host_config *hostconfig)
+{
+    long long memory = hostconfig->memory;
+
+    if (hostconfig->memory_swap < 0) {
+        return cgroup_write_limit(CGROUP_VERSION_2, dir, "memory.swap.max", -1);
+    }
+
+    // memory swap is memory plus swap, cgroup v2 limits the swap only
+    if (memory == 0 && cgroup_read_limit(dir, "memory.max", &memory) != 0) {
+        return -1;
+    }
+    if (memory < 0 || hostconfig->memory_swap < memory) {
+        ERROR("Memory swap %lld should be larger than memory limit %lld", (long long)hostconfig->memory_swap, memory);
+        isulad_set_error_message("Memory swap should be larger than memory limit");
+        return -1;
+    }
+
+    return cgroup_write_limit(CGROUP_VERSION_2, dir, "memory.swap.max", hostconfig->memory_swap - memory);
+}
+
+static int update_memory_v2(const char *dir, const host_config *hostconfig)
+{
+    if (hostconfig->memory != 0 && cgroup_write_limit(CGROUP_VERSION_2, dir, "memory.max", hostconfig->memory) != 0) {
+        return -1;
+    }
+    if (hostconfig->memory_swap != 0 && update_memory_swap_v2(dir, hostconfig) != 0) {
+        return -1;
+    }
+    if (hostconfig->memory_reservation != 0 &&
+        cgroup_write_limit(CGROUP_VERSION_2, dir, "memory.low", hostconfig->memory_reservation) != 0) {
+        return -1;
+    }
+    if (hostconfig->kernel_memory != 0) {
+        WARN("Kernel memory is not supported on cgroup v2, ignore it");
+    }
+
+    return 0;
+}
+
+static int update_memory(int version, const char *cgroup_path, const host_config *hostconfig)
+{
+    int ret = 0;
+    char *dir = NULL;
+
+    if (hostconfig->memory == 0 && hostconfig->memory_swap == 0 && hostconfig->memory_reservation == 0 &&
+        hostconfig->kernel_memory == 0) {
+        return 0;
+    }
+
+    dir = cgroup_dir(version, "memory", cgroup_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    if (version == CGROUP_VERSION_2) {
+        ret = update_memory_v2(dir, hostconfig);
+    } else {
+        ret = update_memory_v1(dir, hostconfig);
+    }
+
+    free(dir);
+    return ret;
+}
+
+static int update_pids(int version, const char *cgroup_path, const host_config *hostconfig)
+{
+    int ret = 0;
+    char *dir = NULL;
+
+    if (hostconfig->pids_limit == 0) {
+        return 0;
+    }
+
+    dir = cgroup_dir(version, "pids", cgroup_path);
+    if (dir == NULL) {
+        return -1;
+    }
+
+    // pids.max is "max" for no limit on both versions
+    ret = cgroup_write_limit(CGROUP_VERSION_2, dir, "pids.max", hostconfig->pids_limit > 0 ? hostconfig->pids_limit : -1);
+
+    free(dir);
+    return ret;
+}
+
+int isula_cgroup_update(const char *cgroup_path, const host_config *hostconfig)
+{
+    int version = 0;
+
+    if (cgroup_path == NULL || hostconfig == NULL) {
+        ERROR("Invalid arguments");
+        return -1;
+    }
+
+    version = get_cgroup_version();
+    if (version < 0) {
+        return -1;
+    }
+
+    if (update_blkio(version, cgroup_path, hostconfig) != 0) {
+        return -1;
+    }
+    if (update_cpu(version, cgroup_path, hostconfig) != 0) {
+        return -1;
+    }
+    if (update_cpuset(version, cgroup_path, hostconfig) != 0) {
+        return -1;
+    }
+    if (update_memory(version, cgroup_path, hostconfig) != 0) {
+        return -1;
+    }
+    if (update_pids(version, cgroup_path, hostconfig) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+struct pids_buf {
+    pid_t *pids;
+    size_t len;
+    size_t cap;
+};
+
+static int pids_append(struct pids_buf *buf, pid_t pid)
+{
+    size_t new_cap = 0;
+
+    if (buf->len == buf->cap) {
+        new_cap = buf->cap == 0 ? CGROUP_PIDS_INIT_LEN : buf->cap * 2;
+        if (new_cap > SIZE_MAX / sizeof(pid_t)) {
+            ERROR("Too many pids");
+            return -1;
+        }
+        if (util_mem_realloc((void **)&buf->pids, new_cap * sizeof(pid_t), buf->pids, buf->cap * sizeof(pid_t)) != 0) {
+            ERROR("Out of memory");
+            return -1;
+        }
+        buf->cap = new_cap;
+    }
+    buf->pids[buf->len++] = pid;
+
+    return 0;
+}
+
+static int read_procs(const char *dir, struct pids_buf *buf)
+{
+    int ret = 0;
+    int pid = 0;
+    size_t i;
+    char *content = NULL;
+    char **lines = NULL;
+    DIR *directory = NULL;
+    struct dirent *entry = NULL;
+    char sub[PATH_MAX] = { 0 };
+
+    content = cgroup_read(dir, CGROUP_PROCS);
+    if (content == NULL) {
+        return -1;
+    }
+    lines = util_string_split_multi(content, '\n');
+    for (i = 0; lines != NULL && lines[i] != NULL; i++) {
+        if (lines[i][0] == '\0') {
+            continue;
+        }
+        if (util_safe_int(lines[i], &pid) != 0) {
+            ERROR("Invalid pid %s in %s/%s", lines[i], dir, CGROUP_PROCS);
+            ret = -1;
+            goto out;
+        }
+        if (pids_append(buf, (pid_t)pid) != 0) {
+            ret = -1;
+            goto out;
+        }
+    }
+
+    // processes of the sub cgroups made in the container
+    directory = opendir(dir);
+    if (directory == NULL) {
+        SYSERROR("Failed to open %s", dir);
+        ret = -1;
+        goto out;
+    }
+    while ((entry = readdir(directory)) != NULL) {
+        if (entry->d_type != DT_DIR || strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        if (cgroup_file_path(dir, entry->d_name, sub, sizeof(sub)) != 0 || read_procs(sub, buf) != 0) {
+            ret = -1;
+            goto out;
+        }
+    }
+
+out:
+    if (directory != NULL) {
+        (void)closedir(directory);
+    }
+    util_free_array(lines);
+    free(content);
+    return ret;
+}
+
+int isula_cgroup_get_pids(const char *cgroup_path, pid_t **pids, size_t *pids_len)
+{
+    int ret = 0;
+    int version = 0;
+    char *dir = NULL;
+    struct pids_buf buf = { 0 };
+
+    if (cgroup_path == NULL || pids == NULL || pids_len == NULL) {
+        ERROR("Invalid arguments");
+        return -1;
+    }
+
+    version = get_cgroup_version();
+    if (version < 0) {
+        return -1;
+    }
+
+    // every v1 hierarchy has all the processes, use one that is always there
+    dir = cgroup_dir(version, "pids", cgroup_path);
+    if (dir == NULL) {
+        dir = cgroup_dir(version, "cpu", cgroup_path);
+    }
+    if (dir == NULL) {
+        return -1;
+    }
+
+    ret = read_procs(dir, &buf);
+    if (ret != 0) {
+        free(buf.pids);
+        goto out;
+    }
+
+    *pids = buf.pids;
+    *pids_len = buf.len;
+
+out:
+    free(dir);
+    return ret;
+}
@@ -0,0 +1,36 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide cgroup update and pids of isulad-shim containers
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_CGROUP_H
+#define DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_CGROUP_H
+
+#include <stddef.h>
+#include <sys/types.h>
+#include <isula_libutils/host_config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// write the resources set in hostconfig to the cgroup files of cgroup_path, zero values are left as they are
+int isula_cgroup_update(const char *cgroup_path, const host_config *hostconfig);
+
+// pids of the processes in cgroup_path and its sub cgroups
+int isula_cgroup_get_pids(const char *cgroup_path, pid_t **pids, size_t *pids_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DAEMON_MODULES_RUNTIME_ISULA_ISULA_RT_CGROUP_H
@@ -21,6 +21,8 @@
 #include <limits.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
 #include <isula_libutils/defs.h>
 #include <isula_libutils/isulad_daemon_configs.h>
 #include <isula_libutils/json_common.h>
@@ -46,13 +48,29 @@
 #include "daemon_arguments.h"
 #include "utils_convert.h"
 #include "utils_file.h"
+#include "utils_trash.h"
 #include "console.h"
+#include "map.h"
+#include "isula_rt_cgroup.h"
+#include "metrics.h"
 
 #define SHIM_BINARY "isulad-shim"
 #define RESIZE_FIFO_NAME "resize_fifo"
 #define SHIM_LOG_SIZE ((BUFSIZ - 100) / 2)
 #define RESIZE_DATA_SIZE 100
 #define PID_WAIT_TIME 120
+// the shim reports "<pid> <error>" of the created process on the pipe passed in this env
+#define SHIM_READY_FD_ENV "ISULAD_SHIM_READY_FD"
+// how often the pid file is checked while waiting on the pipe, for a shim which does not report
+#define PID_FILE_CHECK_MS 500
+
+/* readiness pipes of created containers by workdir, waited on by start */
+static struct {
+    pthread_mutex_t mutex;
+    map_t *fds;
+} g_ready_fds = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
 
 static void copy_process(shim_client_process_state *p, defs_process *dp)
 {
@@ -73,6 +91,15 @@ static void copy_process(shim_client_process_state *p, defs_process *dp)
     p->rlimits_len = dp->rlimits_len;
 }
 
+// resolved on the first spawn with metrics enabled
+static metrics_histogram_t *g_shim_spawn_seconds = NULL;
+static pthread_once_t g_shim_metrics_once = PTHREAD_ONCE_INIT;
+
+static void shim_metrics_init(void)
+{
+    g_shim_spawn_seconds = metrics_histogram("isulad_shim_spawn_seconds", NULL);
+}
+
 static void copy_annotations(shim_client_process_state *p, json_map_string_string *anno)
 {
     size_t i;
@@ -438,25 +465,6 @@ static void runtime_exec_info_init(runtime_exec_info *rei, const char *workdir,
     runtime_exec_param_dump((const char **)rei->params);
 }
 
-static void runtime_exec_func(void *arg)
-{
-    runtime_exec_info *rei = (runtime_exec_info *)arg;
-
-    if (rei == NULL) {
-        dprintf(STDERR_FILENO, "missing runtime exec info");
-        _exit(EXIT_FAILURE);
-    }
-
-    if (chdir(rei->workdir) < 0) {
-        dprintf(STDERR_FILENO, "chdir %s failed", rei->workdir);
-        _exit(EXIT_FAILURE);
-    }
-
-    execvp(rei->cmd, rei->params);
-    dprintf(STDERR_FILENO, "exec %s %s %s failed", rei->cmd, rei->subcmd, rei->id);
-    _exit(EXIT_FAILURE);
-}
-
 static int status_string_to_int(const char *status)
 {
     if (strcmp(status, "running") == 0) {
@@ -485,7 +493,7 @@ static int runtime_call_status(const char *workdir, const char *runtime, const c
 
     runtime_exec_info_init(&rei, workdir, runtime, "state", NULL, 0, id, params, PARAM_NUM);
 
-    if (!util_exec_cmd(runtime_exec_func, &rei, NULL, &stdout, &stderr)) {
+    if (!util_exec_argv_cmd(rei.workdir, rei.params, NULL, &stdout, &stderr)) {
         ERROR("call runtime status failed: %s", stderr);
         ret = -1;
         goto out;
@@ -535,7 +543,7 @@ static int runtime_call_stats(const char *workdir, const char *runtime, const ch
 
     runtime_exec_info_init(&rei, workdir, runtime, "events", opts, 1, id, params, PARAM_NUM);
 
-    if (!util_exec_cmd(runtime_exec_func, &rei, NULL, &stdout, &stderr)) {
+    if (!util_exec_argv_cmd(rei.workdir, rei.params, NULL, &stdout, &stderr)) {
         ERROR("call runtime events --stats failed: %s", stderr);
         ret = -1;
         goto out;
@@ -587,7 +595,7 @@ static int runtime_call_simple(const char *workdir, const char *runtime, const c
     char *params[PARAM_NUM] = { 0 };
 
     runtime_exec_info_init(&rei, workdir, runtime, subcmd, opts, opts_len, id, params, PARAM_NUM);
-    if (!util_exec_cmd(runtime_exec_func, &rei, NULL, &stdout, &stderr)) {
+    if (!util_exec_argv_cmd(rei.workdir, rei.params, NULL, &stdout, &stderr)) {
         ERROR("call runtime %s failed stderr %s", subcmd, stderr);
         ret = -1;
         goto out;
@@ -628,15 +636,69 @@ static int status_to_exit_code(int status)
     return exit_code;
 }
 
+static void ready_fd_put(const char *workdir, int fd)
+{
+    int *old = NULL;
+
+    (void)pthread_mutex_lock(&g_ready_fds.mutex);
+    if (g_ready_fds.fds == NULL) {
+        g_ready_fds.fds = map_new(MAP_STR_INT, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    }
+    // left by a create of the same container which was never started
+    if (g_ready_fds.fds != NULL) {
+        old = map_search(g_ready_fds.fds, (void *)workdir);
+    }
+    if (old != NULL) {
+        close(*old);
+        (void)map_remove(g_ready_fds.fds, (void *)workdir);
+    }
+    if (g_ready_fds.fds == NULL || !map_replace(g_ready_fds.fds, (void *)workdir, &fd)) {
+        // start reads the pid file
+        WARN("Failed to keep readiness pipe of %s", workdir);
+        close(fd);
+    }
+    (void)pthread_mutex_unlock(&g_ready_fds.mutex);
+}
+
+static int ready_fd_take(const char *workdir)
+{
+    int fd = -1;
+    int *val = NULL;
+
+    (void)pthread_mutex_lock(&g_ready_fds.mutex);
+    if (g_ready_fds.fds != NULL) {
+        val = map_search(g_ready_fds.fds, (void *)workdir);
+    }
+    if (val != NULL) {
+        fd = *val;
+        (void)map_remove(g_ready_fds.fds, (void *)workdir);
+    }
+    (void)pthread_mutex_unlock(&g_ready_fds.mutex);
+
+    return fd;
+}
+
+static void ready_fd_drop(const char *workdir)
+{
+    int fd = ready_fd_take(workdir);
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
 static int shim_create(bool fg, const char *id, const char *workdir, const char *bundle, const char *runtime_cmd,
-                       int *exit_code)
+                       int *exit_code, int *ready_fd)
 {
     pid_t pid = 0;
     int exec_fd[2] = { -1, -1 };
+    int ready_pipe[2] = { -1, -1 };
+    int keep_fds[2] = { -1, -1 };
     int num = 0;
     int ret = 0;
     char exec_buff[BUFSIZ + 1] = { 0 };
     char fpid[PATH_MAX] = { 0 };
+    char sfd[UINT_LEN] = { 0 };
     const char *params[PARAM_NUM] = { 0 };
     int i = 0;
     int status = 0;
@@ -659,11 +721,21 @@ static int shim_create(bool fg, const char *id, const char *workdir, const char
         return -1;
     }
 
+    // without the readiness pipe the pid file is polled
+    if (ready_fd != NULL && pipe2(ready_pipe, O_CLOEXEC) != 0) {
+        WARN("failed to create readiness pipe for shim create: %s", strerror(errno));
+        ready_fd = NULL;
+    }
+
     pid = fork();
     if (pid < 0) {
         ERROR("failed fork for shim parent %s", strerror(errno));
         close(exec_fd[0]);
         close(exec_fd[1]);
+        if (ready_fd != NULL) {
+            close(ready_pipe[0]);
+            close(ready_pipe[1]);
+        }
         return -1;
     }
 
@@ -703,7 +775,18 @@ realexec:
             exit(EXIT_FAILURE);
         }
 
-        if (util_check_inherited(true, exec_fd[1]) != 0) {
+        keep_fds[0] = exec_fd[1];
+        if (ready_fd != NULL) {
+            close(ready_pipe[0]);
+            keep_fds[1] = ready_pipe[1];
+            if (fcntl(ready_pipe[1], F_SETFD, 0) != 0 || snprintf(sfd, sizeof(sfd), "%d", ready_pipe[1]) < 0 ||
+                setenv(SHIM_READY_FD_ENV, sfd, 1) != 0) {
+                (void)dprintf(exec_fd[1], "%s: failed to pass readiness pipe %s", id, strerror(errno));
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        if (util_check_inherited_exclude_fds(true, keep_fds, ready_fd != NULL ? 2 : 1) != 0) {
             (void)dprintf(exec_fd[1], "close inherited fds failed");
         }
 
@@ -712,6 +795,9 @@ realexec:
     }
 
     close(exec_fd[1]);
+    if (ready_fd != NULL) {
+        close(ready_pipe[1]);
+    }
     num = util_read_nointr(exec_fd[0], exec_buff, sizeof(exec_buff));
     close(exec_fd[0]);
     if (num > 0) {
@@ -736,6 +822,13 @@ out:
         show_shim_runtime_errlog(workdir);
         kill(pid, SIGKILL); /* can kill other process? */
     }
+    if (ready_fd != NULL) {
+        if (ret == 0) {
+            *ready_fd = ready_pipe[0];
+        } else {
+            close(ready_pipe[0]);
+        }
+    }
 
     return ret;
 }
@@ -780,6 +873,79 @@ static int get_container_process_pid(const char *workdir)
     return -1;
 }
 
+/*
+ * The shim reports "<pid> <error>" on the readiness pipe as soon as the runtime returns, and
+ * the pipe is closed without a report if the shim exits before. The pid file is still checked
+ * now and then, for a shim which does not report.
+ */
+static int wait_container_process_pid(const char *workdir, int ready_fd)
+{
+    char fname[PATH_MAX] = { 0 };
+    char buf[UINT_LEN * 2 + 2] = { 0 };
+    size_t len = 0;
+    ssize_t nread = 0;
+    int nret = 0;
+    int pid = 0;
+    int err = 0;
+    struct pollfd pfd = { 0 };
+    struct timespec beg = { 0 };
+    struct timespec end = { 0 };
+
+    if (ready_fd < 0) {
+        return get_container_process_pid(workdir);
+    }
+
+    if (snprintf(fname, sizeof(fname), "%s/pid", workdir) < 0 || clock_gettime(CLOCK_MONOTONIC, &beg) != 0) {
+        close(ready_fd);
+        return get_container_process_pid(workdir);
+    }
+
+    while (len < sizeof(buf) - 1 && memchr(buf, '\n', len) == NULL) {
+        if (clock_gettime(CLOCK_MONOTONIC, &end) != 0 || end.tv_sec - beg.tv_sec > PID_WAIT_TIME) {
+            ERROR("wait container process pid timeout %s", workdir);
+            close(ready_fd);
+            return -1;
+        }
+
+        pfd.fd = ready_fd;
+        pfd.events = POLLIN;
+        nret = poll(&pfd, 1, PID_FILE_CHECK_MS);
+        if (nret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (nret < 0) {
+            SYSERROR("failed to poll readiness pipe of %s", workdir);
+            break;
+        }
+        if (nret == 0) {
+            file_read_int(fname, &pid);
+            if (pid > 0) {
+                close(ready_fd);
+                return pid;
+            }
+            continue;
+        }
+
+        nread = util_read_nointr(ready_fd, buf + len, sizeof(buf) - 1 - len);
+        if (nread <= 0) {
+            break;
+        }
+        len += (size_t)nread;
+    }
+    close(ready_fd);
+
+    if (sscanf(buf, "%d %d", &pid, &err) == 2) {
+        if (err != 0 || pid <= 0) {
+            ERROR("shim failed to create process of %s: %d", workdir, err);
+            return -1;
+        }
+        return pid;
+    }
+
+    // nothing reported, the pid file tells whether the runtime did create the process
+    return get_container_process_pid(workdir);
+}
+
 static void shim_kill_force(const char *workdir)
 {
     int pid = 0;
@@ -810,7 +976,9 @@ int rt_isula_create(const char *id, const char *runtime, const rt_create_params_
     size_t runtime_args_len = 0;
     int ret = 0;
     char workdir[PATH_MAX] = { 0 };
+    int ready_fd = -1;
     shim_client_process_state p = { 0 };
+    uint64_t start = 0;
 
     if (id == NULL || runtime == NULL || params == NULL) {
         ERROR("nullptr arguments not allowed");
@@ -843,12 +1011,20 @@ int rt_isula_create(const char *id, const char *runtime, const rt_create_params_
     }
 
     get_runtime_cmd(runtime, &cmd);
-    ret = shim_create(false, id, workdir, params->bundle, cmd, NULL);
+    start = metrics_now();
+    ret = shim_create(false, id, workdir, params->bundle, cmd, NULL, &ready_fd);
     if (ret != 0) {
         runtime_call_delete_force(workdir, runtime, id);
         ERROR("%s: failed create shim process", id);
         goto out;
     }
+    if (start != 0) {
+        (void)pthread_once(&g_shim_metrics_once, shim_metrics_init);
+        metrics_observe_since(g_shim_spawn_seconds, start);
+    }
+    if (ready_fd >= 0) {
+        ready_fd_put(workdir, ready_fd);
+    }
 
 out:
     return ret;
@@ -880,7 +1056,8 @@ int rt_isula_start(const char *id, const char *runtime, const rt_start_params_t
         return -1;
     }
 
-    pid = get_container_process_pid(workdir);
+    // after a restart of isulad there is no readiness pipe of the container
+    pid = wait_container_process_pid(workdir, ready_fd_take(workdir));
     if (pid < 0) {
         ret = -1;
         ERROR("%s: failed wait init pid", id);
@@ -956,6 +1133,7 @@ int rt_isula_clean_resource(const char *id, const char *runtime, const rt_clean_
         return -1;
     }
 
+    ready_fd_drop(workdir);
     if (shim_alive(workdir)) {
         shim_kill_force(workdir);
     }
@@ -975,6 +1153,8 @@ int rt_isula_clean_resource(const char *id, const char *runtime, const rt_clean_
 int rt_isula_rm(const char *id, const char *runtime, const rt_rm_params_t *params)
 {
     char libdir[PATH_MAX] = { 0 };
+    char *isulad_root = NULL;
+    int ret = 0;
 
     if (id == NULL || runtime == NULL || params == NULL) {
         ERROR("nullptr arguments not allowed");
@@ -989,7 +1169,10 @@ int rt_isula_rm(const char *id, const char *runtime, const rt_rm_params_t *param
         return -1;
     }
 
-    if (util_recursive_rmdir(libdir, 0) != 0) {
+    isulad_root = conf_get_isulad_rootdir();
+    ret = util_trash_path(isulad_root, libdir);
+    free(isulad_root);
+    if (ret != 0) {
         ERROR("failed rmdir -r shim workdir");
         return -1;
     }
@@ -1040,6 +1223,8 @@ int rt_isula_exec(const char *id, const char *runtime, const rt_exec_params_t *p
     int ret = 0;
     char bundle[PATH_MAX] = { 0 };
     int pid = 0;
+    int ready_fd = -1;
+    bool fg = false;
     shim_client_process_state p = { 0 };
 
     if (id == NULL || runtime == NULL || params == NULL || exit_code == NULL) {
@@ -1106,13 +1291,15 @@ int rt_isula_exec(const char *id, const char *runtime, const rt_exec_params_t *p
     }
 
     get_runtime_cmd(runtime, &cmd);
-    ret = shim_create(fg_exec(params), id, workdir, bundle, cmd, exit_code);
+    // a foreground exec returns when the process exits, the pid file is there
+    fg = fg_exec(params);
+    ret = shim_create(fg, id, workdir, bundle, cmd, exit_code, fg ? NULL : &ready_fd);
     if (ret != 0) {
         ERROR("%s: failed create shim process for exec %s", id, exec_id);
         goto out;
     }
 
-    pid = get_container_process_pid(workdir);
+    pid = wait_container_process_pid(workdir, ready_fd);
     if (pid < 0) {
         ERROR("%s: failed get exec process id", workdir);
         ret = -1;
@@ -1131,6 +1318,62 @@ out:
     return ret;
 }
 
+/*
+ * The container process is a child of the shim, its subreaper. A process with the pid, parent
+ * and start times the container last ran with is still the container, and one which is gone or
+ * has another start time means it has exited, so restore does not need to run "<runtime> state"
+ * for each container. Anything else, such as a zombie or a pid file which does not match, is
+ * left to the runtime. Returns 0 if the status is known.
+ */
+static int last_process_status(const char *workdir, const pid_ppid_info_t *last,
+                               struct runtime_container_status_info *status)
+{
+    char fname[PATH_MAX] = { 0 };
+    int pid = 0;
+    proc_t *proc = NULL;
+    proc_t *pproc = NULL;
+    int ret = -1;
+
+    if (last == NULL || last->pid <= 0 || last->start_time == 0) {
+        return -1;
+    }
+
+    if (snprintf(fname, sizeof(fname), "%s/pid", workdir) < 0) {
+        return -1;
+    }
+    file_read_int(fname, &pid);
+    if (pid != last->pid) {
+        return -1;
+    }
+
+    proc = util_get_process_proc_info(pid);
+    if (proc == NULL || proc->start_time != last->start_time) {
+        DEBUG("container process %d of %s is gone", pid, workdir);
+        status->status = RUNTIME_CONTAINER_STATUS_STOPPED;
+        ret = 0;
+        goto out;
+    }
+
+    if (proc->state == 'Z' || proc->ppid != last->ppid) {
+        goto out;
+    }
+
+    pproc = util_get_process_proc_info(proc->ppid);
+    if (pproc == NULL || pproc->start_time != last->pstart_time) {
+        goto out;
+    }
+
+    status->status = RUNTIME_CONTAINER_STATUS_RUNNING;
+    status->pid = (uint32_t)pid;
+    status->has_pid = true;
+    ret = 0;
+
+out:
+    free(proc);
+    free(pproc);
+    return ret;
+}
+
 int rt_isula_status(const char *id, const char *runtime, const rt_status_params_t *params,
                     struct runtime_container_status_info *status)
 {
@@ -1154,6 +1397,11 @@ int rt_isula_status(const char *id, const char *runtime, const rt_status_params_
         goto out;
     }
 
+    if (last_process_status(workdir, params->last_pid_info, status) == 0) {
+        INFO("container %s status %d pid %u by its process", id, status->status, status->pid);
+        goto out;
+    }
+
     ret = runtime_call_status(workdir, runtime, id, status);
 
 out:
@@ -1167,11 +1415,69 @@ int rt_isula_attach(const char *id, const char *runtime, const rt_attach_params_
     return -1;
 }
 
+/* cgroups path of the spec in the bundle, the systemd cgroup driver is not supported */
+static char *get_container_cgroup_path(const char *rootpath, const char *id)
+{
+    char filename[PATH_MAX] = { 0 };
+    oci_runtime_spec *spec = NULL;
+    parser_error err = NULL;
+    char *cgroup_path = NULL;
+    int nret = 0;
+
+    nret = snprintf(filename, sizeof(filename), "%s/%s/%s", rootpath, id, OCI_CONFIG_JSON);
+    if (nret < 0 || (size_t)nret >= sizeof(filename)) {
+        ERROR("Failed to join config path of %s", id);
+        return NULL;
+    }
+
+    spec = oci_runtime_spec_parse_file(filename, NULL, &err);
+    if (spec == NULL) {
+        ERROR("Failed to parse %s: %s", filename, err);
+        goto out;
+    }
+
+    if (spec->linux == NULL || spec->linux->cgroups_path == NULL) {
+        ERROR("No cgroups path in %s", filename);
+        goto out;
+    }
+
+    if (strchr(spec->linux->cgroups_path, ':') != NULL) {
+        ERROR("Systemd cgroups path %s is not supported", spec->linux->cgroups_path);
+        goto out;
+    }
+
+    cgroup_path = util_strdup_s(spec->linux->cgroups_path);
+
+out:
+    free(err);
+    free_oci_runtime_spec(spec);
+    return cgroup_path;
+}
+
 int rt_isula_update(const char *id, const char *runtime, const rt_update_params_t *params)
 {
-    ERROR("isula update not support on isulad-shim");
-    isulad_set_error_message("isula update not support on isulad-shim");
-    return -1;
+    int ret = 0;
+    char *cgroup_path = NULL;
+
+    if (id == NULL || runtime == NULL || params == NULL || params->rootpath == NULL || params->hostconfig == NULL) {
+        ERROR("nullptr arguments not allowed");
+        return -1;
+    }
+
+    cgroup_path = get_container_cgroup_path(params->rootpath, id);
+    if (cgroup_path == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    ret = isula_cgroup_update(cgroup_path, params->hostconfig);
+
+out:
+    if (ret != 0) {
+        isulad_try_set_error_message("Cannot update container %s", id);
+    }
+    free(cgroup_path);
+    return ret;
 }
 
 int rt_isula_pause(const char *id, const char *runtime, const rt_pause_params_t *params)
@@ -1210,9 +1516,28 @@ int rt_isula_resume(const char *id, const char *runtime, const rt_resume_params_
 
 int rt_isula_listpids(const char *name, const char *runtime, const rt_listpids_params_t *params, rt_listpids_out_t *out)
 {
-    ERROR("isula top/listpids not support on isulad-shim");
-    isulad_set_error_message("isula top/listpids not support on isulad-shim");
-    return -1;
+    int ret = 0;
+    char *cgroup_path = NULL;
+
+    if (name == NULL || runtime == NULL || params == NULL || params->rootpath == NULL || out == NULL) {
+        ERROR("nullptr arguments not allowed");
+        return -1;
+    }
+
+    cgroup_path = get_container_cgroup_path(params->rootpath, name);
+    if (cgroup_path == NULL) {
+        ret = -1;
+        goto out;
+    }
+
+    ret = isula_cgroup_get_pids(cgroup_path, &out->pids, &out->pids_len);
+
+out:
+    if (ret != 0) {
+        isulad_try_set_error_message("Runtime top container %s error", name);
+    }
+    free(cgroup_path);
+    return ret;
 }
 
 int rt_isula_resources_stats(const char *id, const char *runtime, const rt_stats_params_t *params,
@@ -21,11 +21,9 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <limits.h>
-#include <semaphore.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/prctl.h>
 #include <time.h>
 
 #include "isula_libutils/log.h"
@@ -35,6 +33,7 @@
 #include "utils.h"
 #include "utils_file.h"
 #include "err_msg.h"
+#include "io_reactor.h"
 
 static char *create_single_fifo(const char *statepath, const char *subpath, const char *stdflag)
 {
@@ -186,221 +185,116 @@ struct io_copy_arg {
     transfer_channel_type channel;
 };
 
-struct io_copy_thread_arg {
-    struct io_copy_arg *copy_arg;
-    bool detach;
-    size_t len;
-    int sync_fd;
-    sem_t wait_sem;
-};
-
-static void io_copy_thread_cleanup(struct io_write_wrapper *writers, struct io_copy_thread_arg *thread_arg, int *infds,
-                                   int *outfds, int *srcfds, transfer_channel_type *channels, size_t len)
+static void io_copy_channels_cleanup(struct io_reactor_channel *channels, size_t len)
 {
     size_t i = 0;
+
     for (i = 0; i < len; i++) {
-        if (writers != NULL && writers[i].close_func != NULL) {
-            (void)writers[i].close_func(writers[i].context, NULL);
-        }
-    }
-    free(srcfds);
-    for (i = 0; i < len; i++) {
-        if ((infds != NULL) && (infds[i] >= 0)) {
-            console_fifo_close(infds[i]);
+        if (channels[i].srcfd >= 0) {
+            console_fifo_close(channels[i].srcfd);
         }
-        if ((outfds != NULL) && (outfds[i] >= 0)) {
-            console_fifo_close(outfds[i]);
+        if (channels[i].dstfd >= 0) {
+            console_fifo_close(channels[i].dstfd);
         }
     }
-    free(infds);
-    free(outfds);
-    free(writers);
-    free(channels);
 }
 
-static int io_copy_init_fds(size_t len, int **infds, int **outfds, int **srcfds,
-                            struct io_write_wrapper **writers, transfer_channel_type **channels)
-{
-    size_t i;
-
-    if (len > SIZE_MAX / sizeof(struct io_write_wrapper)) {
-        ERROR("Invalid arguments");
-        return -1;
-    }
-    *srcfds = util_common_calloc_s(sizeof(int) * len);
-    if (*srcfds == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-
-    *infds = util_common_calloc_s(sizeof(int) * len);
-    if (*infds == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-    for (i = 0; i < len; i++) {
-        (*infds)[i] = -1;
-    }
-    *outfds = util_common_calloc_s(sizeof(int) * len);
-    if (*outfds == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-    for (i = 0; i < len; i++) {
-        (*outfds)[i] = -1;
-    }
-
-    *writers = util_common_calloc_s(sizeof(struct io_write_wrapper) * len);
-    if (*writers == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-
-    *channels = util_common_calloc_s(sizeof(transfer_channel_type) * len);
-    if (*channels == NULL) {
-        ERROR("Out of memory");
-        return -1;
-    }
-
-    for (i = 0; i < len; i++) {
-        (*channels)[i] = MAX_CHANNEL;
-    }
-    return 0;
-
-}
-typedef int (*src_io_type_handle)(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds);
+typedef int (*src_io_type_handle)(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel);
 
 struct src_io_copy_handler {
     io_type type;
     src_io_type_handle handle;
 };
 
-static int handle_src_io_fd(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static int handle_src_io_fd(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
-    srcfds[index] = *(int *)(copy_arg[index].src);
+    // the fd belongs to caller, io session closes its own copy when done
+    channel->srcfd = fcntl(*(int *)(copy_arg->src), F_DUPFD_CLOEXEC, 0);
+    if (channel->srcfd < 0) {
+        ERROR("Failed to dup src fd: %s", strerror(errno));
+        return -1;
+    }
 
     return 0;
 }
 
-static int handle_src_io_fifo(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static int handle_src_io_fifo(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
-    if (console_fifo_open((const char *)copy_arg[index].src, &(infds[index]), O_RDONLY | O_NONBLOCK)) {
+    if (console_fifo_open((const char *)copy_arg->src, &(channel->srcfd), O_RDONLY | O_NONBLOCK)) {
         ERROR("failed to open console fifo.");
         return -1;
     }
-    srcfds[index] = infds[index];
 
     return 0;
 }
 
-static int handle_src_io_fun(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static int handle_src_io_fun(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
     ERROR("Got invalid src fd type");
     return -1;
 }
 
-static int handle_src_io_max(int index, struct io_copy_arg *copy_arg, int *infds, int *srcfds)
+static int handle_src_io_max(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
     ERROR("Got invalid src fd type");
     return -1;
 }
 
-static int io_copy_make_srcfds(size_t len, struct io_copy_arg *copy_arg, int *infds,
-                               int *srcfds, transfer_channel_type *channels)
-{
-    size_t i;
-
-    struct src_io_copy_handler src_handler_jump_table[] = {
-        { IO_FD, handle_src_io_fd },
-        { IO_FIFO, handle_src_io_fifo },
-        { IO_FUNC, handle_src_io_fun },
-        { IO_MAX, handle_src_io_max },
-    };
-
-    for (i = 0; i < len; i++) {
-        if (src_handler_jump_table[(int)(copy_arg[i].srctype)].handle(i, copy_arg, infds, srcfds) != 0) {
-            return -1;
-        }
-        channels[i] = copy_arg[i].channel;
-    }
-
-    return 0;
-}
-
-static ssize_t write_to_fifo(void *context, const void *data, size_t len)
-{
-    ssize_t ret;
-    int fd;
-
-    fd = *(int *)context;
-    ret = util_write_nointr_in_total(fd, data, len);
-    if ((ret <= 0) || (ret != (ssize_t)len)) {
-        ERROR("Failed to write %d: %s", fd, strerror(errno));
-        return -1;
-    }
-    return ret;
-}
-
-static ssize_t write_to_fd(void *context, const void *data, size_t len)
-{
-    ssize_t ret;
-    ret = util_write_nointr(*(int *)context, data, len);
-    if ((ret <= 0) || (ret != (ssize_t)len)) {
-        ERROR("Failed to write: %s", strerror(errno));
-        return -1;
-    }
-    return ret;
-}
-
-typedef int (*dst_io_type_handle)(int index, struct io_copy_arg *copy_arg, int *outfds,
-                                  struct io_write_wrapper *writers);
+typedef int (*dst_io_type_handle)(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel);
 
 struct dst_io_copy_handler {
     io_type type;
     dst_io_type_handle handle;
 };
 
-static int handle_dst_io_fd(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fd(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
-    writers[index].context = copy_arg[index].dst;
-    writers[index].write_func = write_to_fd;
+    channel->dstfd = fcntl(*(int *)(copy_arg->dst), F_DUPFD_CLOEXEC, 0);
+    if (channel->dstfd < 0) {
+        ERROR("Failed to dup dst fd: %s", strerror(errno));
+        return -1;
+    }
 
     return 0;
 }
 
-static int handle_dst_io_fifo(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fifo(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
-    if (console_fifo_open_withlock((const char *)copy_arg[index].dst, &outfds[index],
-                                   copy_arg[index].dstfifoflag | O_NONBLOCK)) {
+    if (console_fifo_open_withlock((const char *)copy_arg->dst, &(channel->dstfd),
+                                   copy_arg->dstfifoflag | O_NONBLOCK)) {
         ERROR("Failed to open console fifo.");
         return -1;
     }
-    writers[index].context = &outfds[index];
-    writers[index].write_func = write_to_fifo;
 
     return 0;
 }
 
-static int handle_dst_io_fun(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_fun(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
-    struct io_write_wrapper *io_write = copy_arg[index].dst;
-    writers[index].context = io_write->context;
-    writers[index].write_func = io_write->write_func;
-    writers[index].close_func = io_write->close_func;
+    struct io_write_wrapper *io_write = copy_arg->dst;
+    channel->writer.context = io_write->context;
+    channel->writer.write_func = io_write->write_func;
+    channel->writer.close_func = io_write->close_func;
 
     return 0;
 }
 
-static int handle_dst_io_max(int index, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int handle_dst_io_max(const struct io_copy_arg *copy_arg, struct io_reactor_channel *channel)
 {
     ERROR("Got invalid dst fd type");
     return -1;
 }
 
-static int io_copy_make_dstfds(size_t len, struct io_copy_arg *copy_arg, int *outfds, struct io_write_wrapper *writers)
+static int io_copy_make_channels(const struct io_copy_arg *copy_arg, size_t len, struct io_reactor_channel *channels)
 {
     size_t i;
 
+    struct src_io_copy_handler src_handler_jump_table[] = {
+        { IO_FD, handle_src_io_fd },
+        { IO_FIFO, handle_src_io_fifo },
+        { IO_FUNC, handle_src_io_fun },
+        { IO_MAX, handle_src_io_max },
+    };
     struct dst_io_copy_handler dst_handler_jump_table[] = {
         { IO_FD, handle_dst_io_fd },
         { IO_FIFO, handle_dst_io_fifo },
@@ -409,89 +303,46 @@ static int io_copy_make_dstfds(size_t len, struct io_copy_arg *copy_arg, int *ou
     };
 
     for (i = 0; i < len; i++) {
-        if (dst_handler_jump_table[(int)(copy_arg[i].dsttype)].handle(i, copy_arg, outfds, writers) != 0) {
-            return -1;
-        }
+        channels[i].srcfd = -1;
+        channels[i].dstfd = -1;
     }
 
-    return 0;
-}
-
-static void *io_copy_thread_main(void *arg)
-{
-    int ret = -1;
-    struct io_copy_thread_arg *thread_arg = (struct io_copy_thread_arg *)arg;
-    struct io_copy_arg *copy_arg = thread_arg->copy_arg;
-    size_t len = 0;
-    int *infds = NULL;
-    int *outfds = NULL; // recored fds to close
-    int *srcfds = NULL;
-    struct io_write_wrapper *writers = NULL;
-    transfer_channel_type *channels = NULL;
-    int sync_fd = thread_arg->sync_fd;
-    bool posted = false;
-
-    if (thread_arg->detach) {
-        ret = pthread_detach(pthread_self());
-        if (ret != 0) {
-            CRIT("Set thread detach fail");
-            goto err;
+    for (i = 0; i < len; i++) {
+        if (src_handler_jump_table[(int)(copy_arg[i].srctype)].handle(&copy_arg[i], &channels[i]) != 0) {
+            return -1;
+        }
+        if (dst_handler_jump_table[(int)(copy_arg[i].dsttype)].handle(&copy_arg[i], &channels[i]) != 0) {
+            return -1;
         }
     }
 
-    (void)prctl(PR_SET_NAME, "IoCopy");
-
-    len = thread_arg->len;
-    if (io_copy_init_fds(len, &infds, &outfds, &srcfds, &writers, &channels) != 0) {
-        goto err;
-    }
-
-    if (io_copy_make_srcfds(len, copy_arg, infds, srcfds, channels) != 0) {
-        goto err;
-    }
-
-    if (io_copy_make_dstfds(len, copy_arg, outfds, writers) != 0) {
-        goto err;
-    }
-
-    sem_post(&thread_arg->wait_sem);
-    posted = true;
-    (void)console_loop_io_copy(sync_fd, srcfds, writers, channels, len);
-err:
-    if (!posted) {
-        sem_post(&thread_arg->wait_sem);
-    }
-    io_copy_thread_cleanup(writers, thread_arg, infds, outfds, srcfds, channels, len);
-    DAEMON_CLEAR_ERRMSG();
-    return NULL;
+    return 0;
 }
 
-static int start_io_copy_thread(int sync_fd, bool detach, struct io_copy_arg *copy_arg, size_t len, pthread_t *tid)
+static int start_io_copy_session(int sync_fd, bool detach, const struct io_copy_arg *copy_arg, size_t len,
+                                 io_copy_session_t **session)
 {
-    int res = 0;
-    struct io_copy_thread_arg thread_arg;
+    struct io_reactor_channel channels[IO_REACTOR_MAX_CHANNELS] = { 0 };
 
     if (copy_arg == NULL || len == 0) {
         return 0;
     }
 
-    thread_arg.detach = detach;
-    thread_arg.copy_arg = copy_arg;
-    thread_arg.len = len;
-    thread_arg.sync_fd = sync_fd;
-    if (sem_init(&thread_arg.wait_sem, 0, 0)) {
-        ERROR("Failed to init start semaphore");
+    if (len > IO_REACTOR_MAX_CHANNELS) {
+        ERROR("Too many io channels");
+        return -1;
+    }
+
+    if (io_copy_make_channels(copy_arg, len, channels) != 0) {
+        io_copy_channels_cleanup(channels, len);
         return -1;
     }
 
-    res = pthread_create(tid, NULL, io_copy_thread_main, (void *)(&thread_arg));
-    if (res != 0) {
-        CRIT("Thread creation failed");
+    if (io_reactor_session_start(sync_fd, detach, channels, len, session) != 0) {
+        io_copy_channels_cleanup(channels, len);
         return -1;
     }
 
-    sem_wait(&thread_arg.wait_sem);
-    sem_destroy(&thread_arg.wait_sem);
     return 0;
 }
 
@@ -522,7 +373,7 @@ static void add_io_copy_element(struct io_copy_arg *element, io_type srctype, vo
 */
 int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char *fifoout, const char *fifoerr,
                        int stdin_fd, struct io_write_wrapper *stdout_handler, struct io_write_wrapper *stderr_handler,
-                       const char *fifos[], pthread_t *tid)
+                       const char *fifos[], io_copy_session_t **session)
 {
     size_t len = 0;
     struct io_copy_arg io_copy[6];
@@ -555,7 +406,7 @@ int ready_copy_io_data(int sync_fd, bool detach, const char *fifoin, const char
         add_io_copy_element(&io_copy[len++], IO_FIFO, (void *)fifos[2], IO_FUNC, stderr_handler, O_WRONLY, STDERR_CHANNEL);
     }
 
-    if (start_io_copy_thread(sync_fd, detach, io_copy, len, tid) != 0) {
+    if (start_io_copy_session(sync_fd, detach, io_copy, len, session) != 0) {
         return -1;
     }
 
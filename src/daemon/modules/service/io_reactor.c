@@ -0,0 +1,1112 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide shared io reactor for exec/attach io copy sessions
+ ********************************************************************************/
+#define _GNU_SOURCE
+#include "io_reactor.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "isula_libutils/log.h"
+#include "linked_list.h"
+#include "utils.h"
+#include "utils_file.h"
+#include "err_msg.h"
+#include "constants.h"
+
+/* all exec/attach sessions of the daemon are multiplexed on these threads */
+#define IO_REACTOR_THREADS 4
+#define IO_REACTOR_MAX_EVENTS 128
+#define IO_REACTOR_BUFFER_SIZE (64 * 1024)
+/* after the first channel of a session closed, others are drained until idle for this long */
+#define IO_REACTOR_DRAIN_IDLE_MS 100
+#define IO_REACTOR_TICK_MS 20
+/* one call of a writer gets at most this much, the cri websocket writer copies it into such a buffer */
+#define IO_REACTOR_WRITER_CHUNK MAX_MSG_BUFFER_SIZE
+/* data of a session queued to the writer threads, sources of writers are not watched above it */
+#define IO_REACTOR_WRITER_QUEUE_MAX (256 * 1024)
+/* writers of all sessions are called on these threads, a session is run by one of them at a time */
+#define IO_WRITER_THREADS 8
+/* chunks of one session written in a row, before sessions queued behind it get their turn */
+#define IO_WRITER_BATCH 16
+
+typedef enum { WATCH_WAKE = 0, WATCH_SYNC, WATCH_SRC, WATCH_DST, WATCH_RESUME } io_watch_kind;
+
+typedef enum { SESSION_RUNNING = 0, SESSION_DRAINING, SESSION_DONE } io_session_state;
+
+struct io_reactor_pipe;
+
+struct io_watch {
+    io_watch_kind kind;
+    int fd;
+    bool armed;
+    struct io_reactor_pipe *pipe;
+    struct io_copy_session *session;
+};
+
+struct io_reactor_pipe {
+    int srcfd;
+    int dstfd;
+    struct io_write_wrapper writer;
+    /* both ends are pipes, move data in kernel without copying it to user space */
+    bool use_splice;
+    bool closed;
+    /* data the dst fd could not take yet, src is not watched until it is flushed */
+    char *pending;
+    size_t pending_len;
+    size_t pending_off;
+    /* src is not watched because the writer queue is full, only touched by the reactor thread */
+    bool writer_paused;
+    /* writer returned an error, later data is dropped, protected by wmutex of session */
+    bool writer_failed;
+    struct io_watch src_watch;
+    struct io_watch dst_watch;
+};
+
+struct io_reactor {
+    pthread_t tid;
+    int epfd;
+    int wakefd;
+    struct io_watch wake_watch;
+    char *buf;
+    /* sessions handed over by other threads, protected by mutex */
+    pthread_mutex_t mutex;
+    struct linked_list incoming;
+    /* sessions waiting for idle deadline, only touched by the reactor thread */
+    struct linked_list draining;
+};
+
+struct io_copy_session {
+    struct io_reactor *reactor;
+    struct io_reactor_pipe pipes[IO_REACTOR_MAX_CHANNELS];
+    size_t len;
+    size_t open_pipes;
+    int sync_fd;
+    struct io_watch sync_watch;
+    io_session_state state;
+    uint64_t drain_deadline;
+    /* node in incoming, draining or finishing list of reactor */
+    struct linked_list node;
+    bool in_list;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool detached;
+    bool finished;
+
+    /*
+     * Writers may block on slow clients, so they are called on the shared writer threads instead
+     * of the reactor. Data is queued in arrival order of all channels, the writer thread posts
+     * resume_fd when the queue is below half again or a writer failed.
+     */
+    bool has_writer;
+    int resume_fd;
+    struct io_watch resume_watch;
+    pthread_mutex_t wmutex;
+    struct linked_list wqueue;
+    size_t wqueued;
+    bool wpaused;
+    bool wstop;
+    /* in ready list of the writer pool or run by a writer thread, keeps the chunks in order */
+    bool wscheduled;
+    struct linked_list wnode;
+};
+
+struct io_writer_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    /* sessions with queued chunks, or stopped by the reactor and waiting to be ended */
+    struct linked_list ready;
+};
+
+struct io_writer_chunk {
+    struct linked_list node;
+    struct io_reactor_pipe *pipe;
+    size_t len;
+    char data[];
+};
+
+static struct io_reactor g_io_reactors[IO_REACTOR_THREADS];
+static pthread_once_t g_io_reactor_once = PTHREAD_ONCE_INIT;
+static int g_io_reactor_init_ret = -1;
+static unsigned int g_io_reactor_next = 0;
+static struct io_writer_pool g_io_writer_pool;
+
+static uint64_t monotonic_ms(void)
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static bool fd_is_pipe(int fd)
+{
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        return false;
+    }
+    return S_ISFIFO(st.st_mode);
+}
+
+static int fd_set_nonblock(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+static int watch_arm(struct io_reactor *reactor, struct io_watch *watch, uint32_t events)
+{
+    struct epoll_event ev = { 0 };
+
+    if (watch->armed) {
+        return 0;
+    }
+    ev.events = events;
+    ev.data.ptr = watch;
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, watch->fd, &ev) < 0) {
+        ERROR("Failed to add fd %d to io reactor: %s", watch->fd, strerror(errno));
+        return -1;
+    }
+    watch->armed = true;
+    return 0;
+}
+
+static void watch_disarm(struct io_reactor *reactor, struct io_watch *watch)
+{
+    if (!watch->armed) {
+        return;
+    }
+    if (epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, watch->fd, NULL) < 0) {
+        WARN("Failed to delete fd %d from io reactor: %s", watch->fd, strerror(errno));
+    }
+    watch->armed = false;
+}
+
+static void session_list_del(struct io_copy_session *session)
+{
+    if (session->in_list) {
+        linked_list_del(&session->node);
+        session->in_list = false;
+    }
+}
+
+static void session_mark_done(struct io_copy_session *session, struct linked_list *done)
+{
+    if (session->state == SESSION_DONE) {
+        return;
+    }
+    session_list_del(session);
+    session->state = SESSION_DONE;
+    linked_list_add_tail(done, &session->node);
+    session->in_list = true;
+}
+
+static void session_touch(struct io_copy_session *session)
+{
+    if (session->state == SESSION_DRAINING) {
+        session->drain_deadline = monotonic_ms() + IO_REACTOR_DRAIN_IDLE_MS;
+    }
+}
+
+/* same as the former per session loop: the first close starts draining, the second ends the session */
+static void session_start_drain(struct io_copy_session *session, struct linked_list *done)
+{
+    if (session->state != SESSION_RUNNING || session->open_pipes == 0) {
+        session_mark_done(session, done);
+        return;
+    }
+    session->state = SESSION_DRAINING;
+    session->drain_deadline = monotonic_ms() + IO_REACTOR_DRAIN_IDLE_MS;
+    linked_list_add_tail(&session->reactor->draining, &session->node);
+    session->in_list = true;
+}
+
+static void pipe_close(struct io_copy_session *session, struct io_reactor_pipe *pipe, struct linked_list *done)
+{
+    if (pipe->closed) {
+        return;
+    }
+    watch_disarm(session->reactor, &pipe->src_watch);
+    watch_disarm(session->reactor, &pipe->dst_watch);
+    pipe->closed = true;
+    session->open_pipes--;
+    session_start_drain(session, done);
+}
+
+/* return 0 if all data is written or kept as pending, -1 if dst is broken */
+static int pipe_write_dst(struct io_copy_session *session, struct io_reactor_pipe *pipe, const char *data,
+                          size_t len)
+{
+    size_t off = 0;
+    ssize_t nret;
+
+    while (off < len) {
+        nret = write(pipe->dstfd, data + off, len - off);
+        if (nret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                break;
+            }
+            ERROR("Failed to write %d: %s", pipe->dstfd, strerror(errno));
+            return -1;
+        }
+        off += (size_t)nret;
+    }
+    if (off == len) {
+        return 0;
+    }
+
+    // dst is full, stop reading src of this pipe until dst can take the rest
+    pipe->pending = util_common_calloc_s(len - off);
+    if (pipe->pending == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    (void)memcpy(pipe->pending, data + off, len - off);
+    pipe->pending_len = len - off;
+    pipe->pending_off = 0;
+    watch_disarm(session->reactor, &pipe->src_watch);
+    return watch_arm(session->reactor, &pipe->dst_watch, EPOLLOUT);
+}
+
+static void handle_dst_writable(struct io_copy_session *session, struct io_reactor_pipe *pipe,
+                                struct linked_list *done)
+{
+    ssize_t nret;
+
+    if (pipe->use_splice) {
+        // dst was full for splice, data is still in src
+        watch_disarm(session->reactor, &pipe->dst_watch);
+        if (watch_arm(session->reactor, &pipe->src_watch, EPOLLIN) != 0) {
+            pipe_close(session, pipe, done);
+        }
+        return;
+    }
+
+    while (pipe->pending_off < pipe->pending_len) {
+        nret = write(pipe->dstfd, pipe->pending + pipe->pending_off, pipe->pending_len - pipe->pending_off);
+        if (nret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN) {
+                return;
+            }
+            ERROR("Failed to write %d: %s", pipe->dstfd, strerror(errno));
+            pipe_close(session, pipe, done);
+            return;
+        }
+        pipe->pending_off += (size_t)nret;
+        session_touch(session);
+    }
+
+    free(pipe->pending);
+    pipe->pending = NULL;
+    pipe->pending_len = 0;
+    pipe->pending_off = 0;
+    watch_disarm(session->reactor, &pipe->dst_watch);
+    if (watch_arm(session->reactor, &pipe->src_watch, EPOLLIN) != 0) {
+        pipe_close(session, pipe, done);
+    }
+}
+
+/* return true if the data was moved by splice or the pipe is closed or waiting for dst */
+static bool pipe_try_splice(struct io_copy_session *session, struct io_reactor_pipe *pipe, struct linked_list *done)
+{
+    ssize_t nret;
+
+    nret = splice(pipe->srcfd, NULL, pipe->dstfd, NULL, IO_REACTOR_BUFFER_SIZE, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    if (nret > 0) {
+        session_touch(session);
+        return true;
+    }
+    if (nret == 0) {
+        pipe_close(session, pipe, done);
+        return true;
+    }
+    if (errno == EINTR) {
+        return true;
+    }
+    if (errno == EAGAIN) {
+        // src is readable, so dst is full
+        watch_disarm(session->reactor, &pipe->src_watch);
+        if (watch_arm(session->reactor, &pipe->dst_watch, EPOLLOUT) != 0) {
+            pipe_close(session, pipe, done);
+        }
+        return true;
+    }
+    if (errno == EINVAL) {
+        DEBUG("Splice is not supported between %d and %d, fallback to copy", pipe->srcfd, pipe->dstfd);
+        pipe->use_splice = false;
+        return false;
+    }
+    ERROR("Failed to splice %d to %d: %s", pipe->srcfd, pipe->dstfd, strerror(errno));
+    pipe_close(session, pipe, done);
+    return true;
+}
+
+/* hand the session to the writer threads, called with wmutex of session held */
+static void session_schedule_writer(struct io_copy_session *session)
+{
+    if (session->wscheduled) {
+        return;
+    }
+    session->wscheduled = true;
+    (void)pthread_mutex_lock(&g_io_writer_pool.mutex);
+    linked_list_add_tail(&g_io_writer_pool.ready, &session->wnode);
+    (void)pthread_cond_signal(&g_io_writer_pool.cond);
+    (void)pthread_mutex_unlock(&g_io_writer_pool.mutex);
+}
+
+/* return -1 if the writer of pipe failed or out of memory */
+static int pipe_queue_writer(struct io_copy_session *session, struct io_reactor_pipe *pipe, const char *data,
+                             size_t len)
+{
+    struct io_writer_chunk *chunk = NULL;
+    bool failed = false;
+    bool full = false;
+
+    chunk = util_common_calloc_s(sizeof(struct io_writer_chunk) + len);
+    if (chunk == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    chunk->node.elem = chunk;
+    chunk->pipe = pipe;
+    chunk->len = len;
+    (void)memcpy(chunk->data, data, len);
+
+    if (pthread_mutex_lock(&session->wmutex) != 0) {
+        ERROR("Failed to lock io writer queue");
+        free(chunk);
+        return -1;
+    }
+    failed = pipe->writer_failed;
+    if (!failed) {
+        linked_list_add_tail(&session->wqueue, &chunk->node);
+        session->wqueued += len;
+        if (session->wqueued >= IO_REACTOR_WRITER_QUEUE_MAX) {
+            session->wpaused = true;
+            full = true;
+        }
+        session_schedule_writer(session);
+    }
+    (void)pthread_mutex_unlock(&session->wmutex);
+
+    if (failed) {
+        free(chunk);
+        return -1;
+    }
+    if (full) {
+        // the writer thread posts resume_fd once the queue is below half
+        watch_disarm(session->reactor, &pipe->src_watch);
+        pipe->writer_paused = true;
+    }
+    return 0;
+}
+
+static void handle_src_readable(struct io_copy_session *session, struct io_reactor_pipe *pipe,
+                                struct linked_list *done)
+{
+    char *buf = session->reactor->buf;
+    size_t max = pipe->dstfd >= 0 ? IO_REACTOR_BUFFER_SIZE : IO_REACTOR_WRITER_CHUNK;
+    ssize_t nret;
+
+    if (pipe->use_splice && pipe_try_splice(session, pipe, done)) {
+        return;
+    }
+
+    nret = util_read_nointr(pipe->srcfd, buf, max);
+    if (nret < 0 && errno == EAGAIN) {
+        return;
+    }
+    if (nret <= 0) {
+        pipe_close(session, pipe, done);
+        return;
+    }
+    session_touch(session);
+
+    if (pipe->dstfd >= 0) {
+        if (pipe_write_dst(session, pipe, buf, (size_t)nret) != 0) {
+            pipe_close(session, pipe, done);
+        }
+        return;
+    }
+
+    if (pipe->writer.context == NULL || pipe->writer.write_func == NULL) {
+        return;
+    }
+    if (pipe_queue_writer(session, pipe, buf, (size_t)nret) != 0) {
+        pipe_close(session, pipe, done);
+    }
+}
+
+static void handle_writer_resume(struct io_copy_session *session, struct linked_list *done)
+{
+    size_t i;
+    eventfd_t val = 0;
+    bool paused = false;
+    bool failed[IO_REACTOR_MAX_CHANNELS] = { 0 };
+
+    (void)eventfd_read(session->resume_fd, &val);
+
+    if (pthread_mutex_lock(&session->wmutex) != 0) {
+        ERROR("Failed to lock io writer queue");
+        return;
+    }
+    paused = session->wpaused;
+    for (i = 0; i < session->len; i++) {
+        failed[i] = session->pipes[i].writer_failed;
+    }
+    (void)pthread_mutex_unlock(&session->wmutex);
+
+    session_touch(session);
+    for (i = 0; i < session->len; i++) {
+        struct io_reactor_pipe *pipe = &session->pipes[i];
+        if (pipe->closed) {
+            continue;
+        }
+        if (failed[i]) {
+            pipe_close(session, pipe, done);
+            continue;
+        }
+        if (pipe->writer_paused && !paused) {
+            pipe->writer_paused = false;
+            if (watch_arm(session->reactor, &pipe->src_watch, EPOLLIN) != 0) {
+                pipe_close(session, pipe, done);
+            }
+        }
+    }
+}
+
+static void handle_sync(struct io_copy_session *session, struct linked_list *done)
+{
+    eventfd_t val = 0;
+
+    // the caller failed, or closed sync fd after detaching
+    (void)eventfd_read(session->sync_fd, &val);
+    watch_disarm(session->reactor, &session->sync_watch);
+    session_start_drain(session, done);
+}
+
+static void session_arm(struct io_copy_session *session, struct linked_list *done)
+{
+    size_t i;
+
+    if (session->sync_fd >= 0 && watch_arm(session->reactor, &session->sync_watch, EPOLLIN) != 0) {
+        session_mark_done(session, done);
+        return;
+    }
+    if (session->has_writer && watch_arm(session->reactor, &session->resume_watch, EPOLLIN) != 0) {
+        session_mark_done(session, done);
+        return;
+    }
+    for (i = 0; i < session->len; i++) {
+        if (watch_arm(session->reactor, &session->pipes[i].src_watch, EPOLLIN) != 0) {
+            session_mark_done(session, done);
+            return;
+        }
+    }
+}
+
+static void session_free(struct io_copy_session *session)
+{
+    if (session == NULL) {
+        return;
+    }
+    (void)pthread_mutex_destroy(&session->mutex);
+    (void)pthread_cond_destroy(&session->cond);
+    (void)pthread_mutex_destroy(&session->wmutex);
+    free(session);
+}
+
+static void session_notify_finished(struct io_copy_session *session)
+{
+    bool detached = false;
+
+    if (pthread_mutex_lock(&session->mutex) != 0) {
+        ERROR("Failed to lock io copy session");
+        return;
+    }
+    session->finished = true;
+    detached = session->detached;
+    if (!detached) {
+        (void)pthread_cond_broadcast(&session->cond);
+    }
+    (void)pthread_mutex_unlock(&session->mutex);
+
+    if (detached) {
+        session_free(session);
+    }
+}
+
+static void session_close_writers(struct io_copy_session *session)
+{
+    size_t i;
+
+    for (i = 0; i < session->len; i++) {
+        struct io_reactor_pipe *pipe = &session->pipes[i];
+        if (pipe->writer.close_func != NULL) {
+            (void)pipe->writer.close_func(pipe->writer.context, NULL);
+        }
+    }
+}
+
+/*
+ * Write up to IO_WRITER_BATCH chunks of session, return true if the session was stopped by the
+ * reactor and all of its data is written, then the caller ends it.
+ */
+static bool io_writer_run_session(struct io_copy_session *session)
+{
+    struct io_writer_chunk *chunk = NULL;
+    bool failed = false;
+    bool resume = false;
+    bool stopped = false;
+    ssize_t wret;
+    int i;
+
+    (void)pthread_mutex_lock(&session->wmutex);
+    for (i = 0; i < IO_WRITER_BATCH && !linked_list_empty(&session->wqueue); i++) {
+        chunk = linked_list_first_elem(&session->wqueue);
+        linked_list_del(&chunk->node);
+        failed = chunk->pipe->writer_failed;
+        (void)pthread_mutex_unlock(&session->wmutex);
+
+        if (!failed) {
+            wret = chunk->pipe->writer.write_func(chunk->pipe->writer.context, chunk->data, chunk->len);
+            if (wret <= 0 || (size_t)wret != chunk->len) {
+                ERROR("failed to write, error:%s", strerror(errno));
+                failed = true;
+            }
+        }
+
+        (void)pthread_mutex_lock(&session->wmutex);
+        session->wqueued -= chunk->len;
+        resume = failed && !chunk->pipe->writer_failed;
+        chunk->pipe->writer_failed = failed;
+        if (session->wpaused && session->wqueued <= IO_REACTOR_WRITER_QUEUE_MAX / 2) {
+            session->wpaused = false;
+            resume = true;
+        }
+        // resume_fd is closed by the reactor before it sets wstop
+        if (resume && !session->wstop && eventfd_write(session->resume_fd, 1) < 0) {
+            WARN("Failed to wake up io reactor: %s", strerror(errno));
+        }
+        free(chunk);
+    }
+
+    if (!linked_list_empty(&session->wqueue)) {
+        // still scheduled, go to the end of the ready list
+        (void)pthread_mutex_lock(&g_io_writer_pool.mutex);
+        linked_list_add_tail(&g_io_writer_pool.ready, &session->wnode);
+        (void)pthread_cond_signal(&g_io_writer_pool.cond);
+        (void)pthread_mutex_unlock(&g_io_writer_pool.mutex);
+    } else if (session->wstop) {
+        // stays scheduled, nothing is queued after wstop
+        stopped = true;
+    } else {
+        session->wscheduled = false;
+    }
+    (void)pthread_mutex_unlock(&session->wmutex);
+
+    return stopped;
+}
+
+/* writers of all sessions run here, the session is ended once its queue is flushed after the reactor stopped it */
+static void *io_writer_main(void *arg)
+{
+    struct io_copy_session *session = NULL;
+
+    (void)arg;
+    (void)prctl(PR_SET_NAME, "IoWriter");
+
+    for (;;) {
+        (void)pthread_mutex_lock(&g_io_writer_pool.mutex);
+        while (linked_list_empty(&g_io_writer_pool.ready)) {
+            (void)pthread_cond_wait(&g_io_writer_pool.cond, &g_io_writer_pool.mutex);
+        }
+        session = linked_list_first_elem(&g_io_writer_pool.ready);
+        linked_list_del(&session->wnode);
+        (void)pthread_mutex_unlock(&g_io_writer_pool.mutex);
+
+        if (io_writer_run_session(session)) {
+            session_close_writers(session);
+            DAEMON_CLEAR_ERRMSG();
+            session_notify_finished(session);
+        }
+    }
+
+    return NULL;
+}
+
+static void session_finish(struct io_copy_session *session)
+{
+    size_t i;
+
+    watch_disarm(session->reactor, &session->sync_watch);
+    watch_disarm(session->reactor, &session->resume_watch);
+    for (i = 0; i < session->len; i++) {
+        struct io_reactor_pipe *pipe = &session->pipes[i];
+        watch_disarm(session->reactor, &pipe->src_watch);
+        watch_disarm(session->reactor, &pipe->dst_watch);
+        if (pipe->srcfd >= 0) {
+            close(pipe->srcfd);
+        }
+        if (pipe->dstfd >= 0) {
+            close(pipe->dstfd);
+        }
+        free(pipe->pending);
+        pipe->pending = NULL;
+    }
+    if (session->sync_fd >= 0) {
+        close(session->sync_fd);
+        session->sync_fd = -1;
+    }
+    DAEMON_CLEAR_ERRMSG();
+
+    if (!session->has_writer) {
+        session_notify_finished(session);
+        return;
+    }
+
+    // the writer thread flushes the queue, closes writers and ends the session
+    if (pthread_mutex_lock(&session->wmutex) != 0) {
+        ERROR("Failed to lock io writer queue");
+        return;
+    }
+    close(session->resume_fd);
+    session->resume_fd = -1;
+    session->wstop = true;
+    session_schedule_writer(session);
+    (void)pthread_mutex_unlock(&session->wmutex);
+}
+
+static void reactor_take_incoming(struct io_reactor *reactor, struct linked_list *done)
+{
+    eventfd_t val = 0;
+    struct linked_list incoming;
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+
+    (void)eventfd_read(reactor->wakefd, &val);
+
+    linked_list_init(&incoming);
+    if (pthread_mutex_lock(&reactor->mutex) != 0) {
+        ERROR("Failed to lock io reactor");
+        return;
+    }
+    linked_list_for_each_safe(it, &reactor->incoming, next) {
+        linked_list_del(it);
+        linked_list_add_tail(&incoming, it);
+    }
+    (void)pthread_mutex_unlock(&reactor->mutex);
+
+    linked_list_for_each_safe(it, &incoming, next) {
+        struct io_copy_session *session = it->elem;
+        linked_list_del(it);
+        session->in_list = false;
+        session_arm(session, done);
+    }
+}
+
+static bool session_writer_paused(const struct io_copy_session *session)
+{
+    size_t i;
+
+    for (i = 0; i < session->len; i++) {
+        if (session->pipes[i].writer_paused && !session->pipes[i].closed) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void reactor_check_draining(struct io_reactor *reactor, struct linked_list *done)
+{
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+    uint64_t now = monotonic_ms();
+
+    linked_list_for_each_safe(it, &reactor->draining, next) {
+        struct io_copy_session *session = it->elem;
+        // time spent by a slow writer is not idle
+        if (session_writer_paused(session)) {
+            continue;
+        }
+        if (now >= session->drain_deadline) {
+            session_mark_done(session, done);
+        }
+    }
+}
+
+static void reactor_handle_event(struct io_reactor *reactor, struct io_watch *watch, struct linked_list *done)
+{
+    if (watch->kind == WATCH_WAKE) {
+        reactor_take_incoming(reactor, done);
+        return;
+    }
+    // events of a session which ended earlier in this batch
+    if (watch->session->state == SESSION_DONE || !watch->armed) {
+        return;
+    }
+
+    switch (watch->kind) {
+        case WATCH_SYNC:
+            handle_sync(watch->session, done);
+            break;
+        case WATCH_SRC:
+            handle_src_readable(watch->session, watch->pipe, done);
+            break;
+        case WATCH_DST:
+            handle_dst_writable(watch->session, watch->pipe, done);
+            break;
+        case WATCH_RESUME:
+            handle_writer_resume(watch->session, done);
+            break;
+        default:
+            break;
+    }
+}
+
+static void *io_reactor_main(void *arg)
+{
+    struct io_reactor *reactor = arg;
+    struct epoll_event evs[IO_REACTOR_MAX_EVENTS];
+    struct linked_list done;
+    struct linked_list *it = NULL;
+    struct linked_list *next = NULL;
+    int i;
+
+    (void)prctl(PR_SET_NAME, "IoReactor");
+
+    for (;;) {
+        int timeout = linked_list_empty(&reactor->draining) ? -1 : IO_REACTOR_TICK_MS;
+        int ep_fds = epoll_wait(reactor->epfd, evs, IO_REACTOR_MAX_EVENTS, timeout);
+        if (ep_fds < 0) {
+            if (errno != EINTR) {
+                ERROR("Io reactor epoll wait failed: %s", strerror(errno));
+            }
+            continue;
+        }
+
+        linked_list_init(&done);
+        for (i = 0; i < ep_fds; i++) {
+            reactor_handle_event(reactor, (struct io_watch *)evs[i].data.ptr, &done);
+        }
+        reactor_check_draining(reactor, &done);
+
+        // finish sessions after the batch, later events of the batch may still point to them
+        linked_list_for_each_safe(it, &done, next) {
+            struct io_copy_session *session = it->elem;
+            linked_list_del(it);
+            session->in_list = false;
+            session_finish(session);
+        }
+    }
+
+    return NULL;
+}
+
+static int io_reactor_init_one(struct io_reactor *reactor)
+{
+    reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epfd < 0) {
+        ERROR("Failed to create io reactor epoll: %s", strerror(errno));
+        return -1;
+    }
+    reactor->wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (reactor->wakefd < 0) {
+        ERROR("Failed to create io reactor eventfd: %s", strerror(errno));
+        return -1;
+    }
+    reactor->buf = util_common_calloc_s(IO_REACTOR_BUFFER_SIZE);
+    if (reactor->buf == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    if (pthread_mutex_init(&reactor->mutex, NULL) != 0) {
+        ERROR("Failed to init io reactor mutex");
+        return -1;
+    }
+    linked_list_init(&reactor->incoming);
+    linked_list_init(&reactor->draining);
+
+    reactor->wake_watch.kind = WATCH_WAKE;
+    reactor->wake_watch.fd = reactor->wakefd;
+    if (watch_arm(reactor, &reactor->wake_watch, EPOLLIN) != 0) {
+        return -1;
+    }
+
+    if (pthread_create(&reactor->tid, NULL, io_reactor_main, reactor) != 0) {
+        CRIT("Io reactor thread creation failed");
+        return -1;
+    }
+    if (pthread_detach(reactor->tid) != 0) {
+        SYSERROR("Failed to detach io reactor thread");
+    }
+    return 0;
+}
+
+static int io_writer_pool_init(void)
+{
+    size_t i;
+    pthread_t tid;
+
+    if (pthread_mutex_init(&g_io_writer_pool.mutex, NULL) != 0) {
+        ERROR("Failed to init io writer pool mutex");
+        return -1;
+    }
+    if (pthread_cond_init(&g_io_writer_pool.cond, NULL) != 0) {
+        ERROR("Failed to init io writer pool cond");
+        return -1;
+    }
+    linked_list_init(&g_io_writer_pool.ready);
+
+    for (i = 0; i < IO_WRITER_THREADS; i++) {
+        if (pthread_create(&tid, NULL, io_writer_main, NULL) != 0) {
+            CRIT("Io writer thread creation failed");
+            return -1;
+        }
+        if (pthread_detach(tid) != 0) {
+            SYSERROR("Failed to detach io writer thread");
+        }
+    }
+    return 0;
+}
+
+static void io_reactor_init(void)
+{
+    size_t i;
+
+    if (io_writer_pool_init() != 0) {
+        return;
+    }
+    for (i = 0; i < IO_REACTOR_THREADS; i++) {
+        if (io_reactor_init_one(&g_io_reactors[i]) != 0) {
+            return;
+        }
+    }
+    g_io_reactor_init_ret = 0;
+}
+
+static void session_init_pipe(struct io_copy_session *session, struct io_reactor_pipe *pipe,
+                              const struct io_reactor_channel *channel)
+{
+    pipe->srcfd = channel->srcfd;
+    pipe->dstfd = channel->dstfd;
+    pipe->writer = channel->writer;
+    pipe->use_splice = pipe->dstfd >= 0 && (fd_is_pipe(pipe->srcfd) || fd_is_pipe(pipe->dstfd));
+    if (pipe->dstfd < 0) {
+        session->has_writer = true;
+    }
+    // fds dup'd from callers may be blocking, which would stall every session of the reactor
+    if (fd_set_nonblock(pipe->srcfd) != 0 || (pipe->dstfd >= 0 && fd_set_nonblock(pipe->dstfd) != 0)) {
+        WARN("Failed to set io fds of session nonblock: %s", strerror(errno));
+    }
+
+    pipe->src_watch.kind = WATCH_SRC;
+    pipe->src_watch.fd = pipe->srcfd;
+    pipe->src_watch.pipe = pipe;
+    pipe->src_watch.session = session;
+
+    pipe->dst_watch.kind = WATCH_DST;
+    pipe->dst_watch.fd = pipe->dstfd;
+    pipe->dst_watch.pipe = pipe;
+    pipe->dst_watch.session = session;
+}
+
+static struct io_copy_session *session_new(void)
+{
+    struct io_copy_session *session = NULL;
+
+    session = util_common_calloc_s(sizeof(struct io_copy_session));
+    if (session == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    if (pthread_mutex_init(&session->mutex, NULL) != 0) {
+        ERROR("Failed to init io copy session mutex");
+        goto err_out;
+    }
+    if (pthread_cond_init(&session->cond, NULL) != 0) {
+        ERROR("Failed to init io copy session cond");
+        goto err_mutex;
+    }
+    if (pthread_mutex_init(&session->wmutex, NULL) != 0) {
+        ERROR("Failed to init io writer queue mutex");
+        goto err_cond;
+    }
+    linked_list_init(&session->wqueue);
+    session->wnode.elem = session;
+    session->sync_fd = -1;
+    session->resume_fd = -1;
+    return session;
+
+err_cond:
+    (void)pthread_cond_destroy(&session->cond);
+err_mutex:
+    (void)pthread_mutex_destroy(&session->mutex);
+err_out:
+    free(session);
+    return NULL;
+}
+
+static void session_release_fds(struct io_copy_session *session)
+{
+    if (session->sync_fd >= 0) {
+        close(session->sync_fd);
+        session->sync_fd = -1;
+    }
+    if (session->resume_fd >= 0) {
+        close(session->resume_fd);
+        session->resume_fd = -1;
+    }
+}
+
+int io_reactor_session_start(int sync_fd, bool detach, const struct io_reactor_channel *channels, size_t len,
+                             io_copy_session_t **session_out)
+{
+    size_t i;
+    struct io_copy_session *session = NULL;
+    struct io_reactor *reactor = NULL;
+
+    if (channels == NULL || len == 0 || len > IO_REACTOR_MAX_CHANNELS) {
+        ERROR("Invalid io channels");
+        return -1;
+    }
+
+    (void)pthread_once(&g_io_reactor_once, io_reactor_init);
+    if (g_io_reactor_init_ret != 0) {
+        ERROR("Io reactor is not available");
+        return -1;
+    }
+
+    session = session_new();
+    if (session == NULL) {
+        return -1;
+    }
+
+    // own a copy of sync fd, the caller closes its one once the operation succeeded
+    if (sync_fd >= 0) {
+        session->sync_fd = fcntl(sync_fd, F_DUPFD_CLOEXEC, 0);
+        if (session->sync_fd < 0) {
+            ERROR("Failed to dup sync fd: %s", strerror(errno));
+            goto err_out;
+        }
+    }
+    session->sync_watch.kind = WATCH_SYNC;
+    session->sync_watch.fd = session->sync_fd;
+    session->sync_watch.session = session;
+
+    reactor = &g_io_reactors[__sync_fetch_and_add(&g_io_reactor_next, 1) % IO_REACTOR_THREADS];
+    session->reactor = reactor;
+    session->len = len;
+    session->open_pipes = len;
+    session->detached = detach;
+    for (i = 0; i < len; i++) {
+        session_init_pipe(session, &session->pipes[i], &channels[i]);
+    }
+    session->node.elem = session;
+
+    if (session->has_writer) {
+        session->resume_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (session->resume_fd < 0) {
+            ERROR("Failed to create io writer eventfd: %s", strerror(errno));
+            goto err_out;
+        }
+        session->resume_watch.kind = WATCH_RESUME;
+        session->resume_watch.fd = session->resume_fd;
+        session->resume_watch.session = session;
+    }
+
+    if (pthread_mutex_lock(&reactor->mutex) != 0) {
+        ERROR("Failed to lock io reactor");
+        goto err_out;
+    }
+    linked_list_add_tail(&reactor->incoming, &session->node);
+    session->in_list = true;
+    (void)pthread_mutex_unlock(&reactor->mutex);
+
+    if (eventfd_write(reactor->wakefd, 1) < 0) {
+        WARN("Failed to wake up io reactor: %s", strerror(errno));
+    }
+
+    if (session_out != NULL) {
+        *session_out = detach ? NULL : session;
+    }
+    return 0;
+
+err_out:
+    session_release_fds(session);
+    session_free(session);
+    return -1;
+}
+
+int io_copy_session_wait(io_copy_session_t *session)
+{
+    if (session == NULL) {
+        return 0;
+    }
+
+    if (pthread_mutex_lock(&session->mutex) != 0) {
+        ERROR("Failed to lock io copy session");
+        return -1;
+    }
+    while (!session->finished) {
+        (void)pthread_cond_wait(&session->cond, &session->mutex);
+    }
+    (void)pthread_mutex_unlock(&session->mutex);
+
+    session_free(session);
+    return 0;
+}
+
+void io_copy_session_detach(io_copy_session_t *session)
+{
+    bool finished = false;
+
+    if (session == NULL) {
+        return;
+    }
+
+    if (pthread_mutex_lock(&session->mutex) != 0) {
+        ERROR("Failed to lock io copy session");
+        return;
+    }
+    finished = session->finished;
+    session->detached = true;
+    (void)pthread_mutex_unlock(&session->mutex);
+
+    if (finished) {
+        session_free(session);
+    }
+}
@@ -0,0 +1,53 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide shared io reactor for exec/attach io copy sessions
+ ********************************************************************************/
+#ifndef DAEMON_MODULES_SERVICE_IO_REACTOR_H
+#define DAEMON_MODULES_SERVICE_IO_REACTOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "io_handler.h"
+#include "io_wrapper.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* max channels of one session: stdin, stdout and stderr from both fifos and handlers */
+#define IO_REACTOR_MAX_CHANNELS 6
+
+struct io_reactor_channel {
+    /* read end, owned by the session once started */
+    int srcfd;
+    /* write end if it is a fd, owned by the session once started, -1 if data goes to writer */
+    int dstfd;
+    struct io_write_wrapper writer;
+};
+
+/*
+ * Start copying data of channels on one of the shared reactor threads. The session ends
+ * when sync_fd is readable or a channel is closed, after draining the others for a while.
+ * If detach is true, the session frees itself when done and *session is set to NULL.
+ * Writers are not called on the reactor, but in order on the shared writer threads, with at
+ * most MAX_MSG_BUFFER_SIZE bytes per call.
+ */
+int io_reactor_session_start(int sync_fd, bool detach, const struct io_reactor_channel *channels, size_t len,
+                             io_copy_session_t **session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -37,6 +37,7 @@
 #include "specs_mount.h"
 #include "specs_extend.h"
 #include "specs_namespace.h"
+#include "specs_template.h"
 #include "path.h"
 #include "constants.h"
 #ifdef ENABLE_SELINUX
@@ -379,7 +380,7 @@ oci_runtime_spec *default_spec(bool system_container)
     parser_error err = NULL;
     // 从/etc/default/isulad/config.json中的default_spec添加入oci_spec
     /* parse the input oci file */
-    oci_spec = oci_runtime_spec_parse_file(oci_file, NULL, &err);
+    oci_spec = spec_template_new_oci_spec(oci_file, &err);
     if (oci_spec == NULL) {
         ERROR("Failed to parse OCI specification file \"%s\", error message: %s", oci_file, err);
         isulad_set_error_message("Can not read the default /etc/default/isulad/config.json file: %s", err);
@@ -732,7 +733,7 @@ static int merge_hook_spec(oci_runtime_spec *oci_spec, const char *hook_spec)
         goto out;
     }
 
-    hooks = oci_runtime_spec_hooks_parse_file(hook_spec, NULL, &err);
+    hooks = spec_template_new_hooks(hook_spec, &err);
     if (hooks == NULL) {
         ERROR("Failed to parse hook-spec file: %s", err);
         ret = -1;
@@ -0,0 +1,237 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide parsed templates of default spec and hook spec files
+ ******************************************************************************/
+#include "specs_template.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "utils_file.h"
+#include "map.h"
+
+/*
+ * A template is the immutable json tree of one file, parsed once. A new spec is built from
+ * the tree by the generated make_* constructors, which allocate every field again, so the
+ * clone is owned by the caller alone and the file is neither read nor tokenized per create.
+ * Templates are reference counted, a caller keeps using its template while the file is
+ * reloaded. The file identity, size and mtime are checked for every clone and the template
+ * is rebuilt as soon as they change.
+ */
+struct spec_template {
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    struct timespec mtime;
+    yajl_val tree;
+    /* protected by g_templates_mutex */
+    size_t refcnt;
+};
+
+/* default specs of normal and system containers, and hook spec files */
+#define SPEC_TEMPLATE_MAX 32
+
+static map_t *g_templates = NULL;
+static pthread_mutex_t g_templates_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void template_free(struct spec_template *tpl)
+{
+    if (tpl == NULL) {
+        return;
+    }
+    yajl_tree_free(tpl->tree);
+    free(tpl);
+}
+
+/* called with g_templates_mutex held */
+static void template_unref_locked(struct spec_template *tpl)
+{
+    if (tpl == NULL) {
+        return;
+    }
+    tpl->refcnt--;
+    if (tpl->refcnt == 0) {
+        template_free(tpl);
+    }
+}
+
+static void template_unref(struct spec_template *tpl)
+{
+    if (tpl == NULL) {
+        return;
+    }
+    if (pthread_mutex_lock(&g_templates_mutex) != 0) {
+        ERROR("Failed to lock spec templates");
+        return;
+    }
+    template_unref_locked(tpl);
+    (void)pthread_mutex_unlock(&g_templates_mutex);
+}
+
+/* map freer, the map holds one reference of each template */
+static void template_map_kvfree(void *key, void *value)
+{
+    free(key);
+    template_unref_locked((struct spec_template *)value);
+}
+
+static bool template_match(const struct spec_template *tpl, const struct stat *st)
+{
+    return tpl->dev == st->st_dev && tpl->ino == st->st_ino && tpl->size == st->st_size &&
+           tpl->mtime.tv_sec == st->st_mtim.tv_sec && tpl->mtime.tv_nsec == st->st_mtim.tv_nsec;
+}
+
+static struct spec_template *template_load(const char *path, const struct stat *st, parser_error *err)
+{
+    char errbuf[BUFSIZ] = { 0 };
+    char *data = NULL;
+    struct spec_template *tpl = NULL;
+
+    data = util_read_text_file(path);
+    if (data == NULL) {
+        *err = util_strdup_s("cannot read the file");
+        return NULL;
+    }
+
+    tpl = util_common_calloc_s(sizeof(struct spec_template));
+    if (tpl == NULL) {
+        ERROR("Out of memory");
+        *err = util_strdup_s("out of memory");
+        goto out;
+    }
+    tpl->tree = yajl_tree_parse(data, errbuf, sizeof(errbuf));
+    if (tpl->tree == NULL) {
+        *err = util_string_append(errbuf, "cannot parse the data: ");
+        free(tpl);
+        tpl = NULL;
+        goto out;
+    }
+    tpl->dev = st->st_dev;
+    tpl->ino = st->st_ino;
+    tpl->size = st->st_size;
+    tpl->mtime = st->st_mtim;
+    tpl->refcnt = 1;
+
+out:
+    free(data);
+    return tpl;
+}
+
+/* return a referenced template of path, release it by template_unref */
+static struct spec_template *template_get(const char *path, parser_error *err)
+{
+    struct stat st;
+    struct spec_template *tpl = NULL;
+    struct spec_template *cached = NULL;
+
+    if (stat(path, &st) != 0) {
+        *err = util_strdup_s("cannot read the file");
+        return NULL;
+    }
+
+    if (pthread_mutex_lock(&g_templates_mutex) != 0) {
+        ERROR("Failed to lock spec templates");
+        return template_load(path, &st, err);
+    }
+    if (g_templates != NULL) {
+        cached = map_search(g_templates, (void *)path);
+    }
+    if (cached != NULL && template_match(cached, &st)) {
+        cached->refcnt++;
+        (void)pthread_mutex_unlock(&g_templates_mutex);
+        return cached;
+    }
+    (void)pthread_mutex_unlock(&g_templates_mutex);
+
+    tpl = template_load(path, &st, err);
+    if (tpl == NULL) {
+        return NULL;
+    }
+
+    if (pthread_mutex_lock(&g_templates_mutex) != 0) {
+        ERROR("Failed to lock spec templates");
+        return tpl;
+    }
+    if (g_templates == NULL) {
+        g_templates = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, template_map_kvfree);
+    }
+    if (g_templates == NULL || (map_search(g_templates, (void *)path) == NULL &&
+                                map_size(g_templates) >= SPEC_TEMPLATE_MAX)) {
+        /* too many hook spec files in use, serve this one uncached */
+        goto unlock;
+    }
+    tpl->refcnt++;
+    if (!map_replace(g_templates, (void *)path, tpl)) {
+        ERROR("Failed to cache spec template of %s", path);
+        tpl->refcnt--;
+    }
+
+unlock:
+    (void)pthread_mutex_unlock(&g_templates_mutex);
+    return tpl;
+}
+
+oci_runtime_spec *spec_template_new_oci_spec(const char *path, parser_error *err)
+{
+    struct parser_context ctx = { 0 };
+    struct spec_template *tpl = NULL;
+    oci_runtime_spec *spec = NULL;
+
+    if (path == NULL || err == NULL) {
+        return NULL;
+    }
+
+    tpl = template_get(path, err);
+    if (tpl == NULL) {
+        return NULL;
+    }
+    spec = make_oci_runtime_spec(tpl->tree, &ctx, err);
+    template_unref(tpl);
+    return spec;
+}
+
+oci_runtime_spec_hooks *spec_template_new_hooks(const char *path, parser_error *err)
+{
+    struct parser_context ctx = { 0 };
+    struct spec_template *tpl = NULL;
+    oci_runtime_spec_hooks *hooks = NULL;
+
+    if (path == NULL || err == NULL) {
+        return NULL;
+    }
+
+    tpl = template_get(path, err);
+    if (tpl == NULL) {
+        return NULL;
+    }
+    hooks = make_oci_runtime_spec_hooks(tpl->tree, &ctx, err);
+    template_unref(tpl);
+    return hooks;
+}
+
+void spec_template_clear(void)
+{
+    if (pthread_mutex_lock(&g_templates_mutex) != 0) {
+        ERROR("Failed to lock spec templates");
+        return;
+    }
+    map_free(g_templates);
+    g_templates = NULL;
+    (void)pthread_mutex_unlock(&g_templates_mutex);
+}
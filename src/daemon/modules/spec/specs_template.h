@@ -0,0 +1,42 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide parsed templates of default spec and hook spec files
+ ******************************************************************************/
+#ifndef DAEMON_MODULES_SPEC_SPECS_TEMPLATE_H
+#define DAEMON_MODULES_SPEC_SPECS_TEMPLATE_H
+
+#include <isula_libutils/json_common.h>
+
+#include "isula_libutils/oci_runtime_hooks.h"
+#include "isula_libutils/oci_runtime_spec.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+/*
+ * Return a new oci spec cloned from the template of file path. The file is parsed the first
+ * time and again after it changed on disk, the clone never shares memory with the template.
+ */
+oci_runtime_spec *spec_template_new_oci_spec(const char *path, parser_error *err);
+
+/* Same as spec_template_new_oci_spec, for hook spec files */
+oci_runtime_spec_hooks *spec_template_new_hooks(const char *path, parser_error *err);
+
+void spec_template_clear(void);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif
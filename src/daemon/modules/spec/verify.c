@@ -44,6 +44,7 @@
 #include "utils.h"
 #include "utils_convert.h"
 #include "utils_file.h"
+#include "utils_mount_table.h"
 #include "utils_verify.h"
 
 /* verify hook timeout */
@@ -1299,8 +1300,8 @@ out:
 /* get source mount */
 static int get_source_mount(const char *src, char **srcpath, char **optional)
 {
-    mountinfo_t **minfos = NULL;
-    mountinfo_t *info = NULL;
+    util_mount_table_t *table = NULL;
+    const util_mount_entry_t *entry = NULL;
     int ret = 0;
     char real_path[PATH_MAX + 1] = { 0 };
     char *dirc = NULL;
@@ -1311,17 +1312,18 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
         return -1;
     }
 
-    minfos = getmountsinfo();
-    if (minfos == NULL) {
+    // changes of propagation are not notified, so do not use the cached table
+    table = util_mount_table_load();
+    if (table == NULL) {
         ERROR("Failed to get mounts info");
         ret = -1;
         goto out;
     }
 
-    info = find_mount_info(minfos, real_path);
-    if (info != NULL) {
+    entry = util_mount_table_find(table, real_path);
+    if (entry != NULL) {
         *srcpath = util_strdup_s(real_path);
-        *optional = info->optional ? util_strdup_s(info->optional) : NULL;
+        *optional = entry->optional ? util_strdup_s(entry->optional) : NULL;
         goto out;
     }
 
@@ -1329,10 +1331,10 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
     dname = dirc;
     while (strcmp(dirc, "/")) {
         dname = dirname(dname);
-        info = find_mount_info(minfos, dname);
-        if (info != NULL) {
+        entry = util_mount_table_find(table, dname);
+        if (entry != NULL) {
             *srcpath = util_strdup_s(dname);
-            *optional = info->optional ? util_strdup_s(info->optional) : NULL;
+            *optional = entry->optional ? util_strdup_s(entry->optional) : NULL;
             goto out;
         }
     }
@@ -1340,7 +1342,7 @@ static int get_source_mount(const char *src, char **srcpath, char **optional)
     ret = -1;
 out:
     free(dirc);
-    free_mounts_info(minfos);
+    util_mount_table_put(table);
     return ret;
 }
 
@@ -0,0 +1,447 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide hash map of string keys
+ ******************************************************************************/
+#include "hash_map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+
+#define HASH_MAP_MIN_CAP 16
+// grow when the entries fill 4/5 of the slots
+#define HASH_MAP_LOAD_NUM 4
+#define HASH_MAP_LOAD_DEN 5
+// slots of the old table handled per insert or remove, enough to empty it before the next grow
+#define HASH_MAP_MOVE_STEPS 8
+
+uint32_t hash_map_str_hash(const char *key)
+{
+    // 64 bits fnv-1a folded to 32 bits
+    uint64_t h = 14695981039346656037ULL;
+    const unsigned char *p = (const unsigned char *)key;
+
+    for (; *p != '\0'; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+
+    return (uint32_t)(h ^ (h >> 32));
+}
+
+static hash_entry_t *table_find(const hash_table_t *table, const char *key, uint32_t hash)
+{
+    size_t mask = table->cap - 1;
+    size_t i;
+    uint32_t dist = 1;
+
+    if (table->cap == 0) {
+        return NULL;
+    }
+
+    for (i = hash & mask;; i = (i + 1) & mask, dist++) {
+        hash_entry_t *entry = &table->entries[i];
+
+        // robin hood: the key would have taken the place of a richer entry
+        if (entry->dist < dist) {
+            return NULL;
+        }
+        if (entry->hash == hash && strcmp((const char *)entry->key, key) == 0) {
+            return entry;
+        }
+    }
+}
+
+// put an entry of a new key, the table must have an empty slot
+static void table_put(hash_table_t *table, hash_entry_t entry)
+{
+    size_t mask = table->cap - 1;
+    size_t i;
+
+    entry.dist = 1;
+    for (i = entry.hash & mask;; i = (i + 1) & mask, entry.dist++) {
+        hash_entry_t *slot = &table->entries[i];
+
+        if (slot->dist == 0) {
+            *slot = entry;
+            table->size++;
+            return;
+        }
+        if (slot->dist < entry.dist) {
+            hash_entry_t tmp = *slot;
+            *slot = entry;
+            entry = tmp;
+        }
+    }
+}
+
+// backward shift deletion, no tombstone is left
+static void table_erase(hash_table_t *table, hash_entry_t *entry)
+{
+    size_t mask = table->cap - 1;
+    size_t i = (size_t)(entry - table->entries);
+
+    for (;;) {
+        size_t next = (i + 1) & mask;
+
+        if (table->entries[next].dist <= 1) {
+            (void)memset(&table->entries[i], 0, sizeof(hash_entry_t));
+            break;
+        }
+        table->entries[i] = table->entries[next];
+        table->entries[i].dist--;
+        i = next;
+    }
+    table->size--;
+}
+
+static void table_free_entries(hash_table_t *table, key_value_freer kvfreer)
+{
+    size_t i;
+
+    for (i = 0; i < table->cap; i++) {
+        if (table->entries[i].dist != 0 && kvfreer != NULL) {
+            kvfreer(table->entries[i].key, table->entries[i].value);
+        }
+    }
+    free(table->entries);
+    (void)memset(table, 0, sizeof(hash_table_t));
+}
+
+/*
+ * The slots of the old table before map->moved are empty: a slot is passed only once it
+ * is empty and nothing is put in the old table, so erasing there never shifts an entry
+ * back below map->moved.
+ */
+static void move_old_entries(hash_map_t *map, size_t steps)
+{
+    while (map->old.entries != NULL && steps > 0) {
+        hash_entry_t *entry = NULL;
+        hash_entry_t moving;
+
+        if (map->moved >= map->old.cap) {
+            free(map->old.entries);
+            (void)memset(&map->old, 0, sizeof(hash_table_t));
+            map->moved = 0;
+            break;
+        }
+
+        entry = &map->old.entries[map->moved];
+        if (entry->dist == 0) {
+            map->moved++;
+        } else {
+            moving = *entry;
+            table_erase(&map->old, entry);
+            table_put(&map->table, moving);
+        }
+        steps--;
+    }
+}
+
+static bool grow_if_needed(hash_map_t *map)
+{
+    size_t size = map->table.size + map->old.size + 1;
+    size_t cap = HASH_MAP_MIN_CAP;
+    hash_entry_t *entries = NULL;
+
+    if (size * HASH_MAP_LOAD_DEN <= map->table.cap * HASH_MAP_LOAD_NUM) {
+        return true;
+    }
+
+    if (map->table.cap > 0) {
+        if (map->table.cap > SIZE_MAX / 2 / sizeof(hash_entry_t)) {
+            ERROR("Too many entries in hash map");
+            return false;
+        }
+        cap = map->table.cap * 2;
+    }
+
+    entries = util_smart_calloc_s(sizeof(hash_entry_t), cap);
+    if (entries == NULL) {
+        ERROR("Out of memory");
+        return false;
+    }
+
+    // the old table of the last grow is left only after many removes, finish it first
+    move_old_entries(map, SIZE_MAX);
+
+    map->old = map->table;
+    map->moved = 0;
+    map->table.entries = entries;
+    map->table.cap = cap;
+    map->table.size = 0;
+    if (map->old.size == 0) {
+        free(map->old.entries);
+        (void)memset(&map->old, 0, sizeof(hash_table_t));
+    }
+
+    return true;
+}
+
+static hash_entry_t *map_find(const hash_map_t *map, const char *key)
+{
+    uint32_t hash = hash_map_str_hash(key);
+    hash_entry_t *entry = NULL;
+
+    entry = table_find(&map->table, key, hash);
+    if (entry == NULL) {
+        entry = table_find(&map->old, key, hash);
+    }
+
+    return entry;
+}
+
+hash_map_t *hash_map_new(key_value_freer kvfreer)
+{
+    hash_map_t *map = NULL;
+
+    map = util_common_calloc_s(sizeof(hash_map_t));
+    if (map == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    map->kvfreer = kvfreer;
+
+    return map;
+}
+
+void hash_map_clear(hash_map_t *map)
+{
+    if (map == NULL) {
+        return;
+    }
+
+    table_free_entries(&map->old, map->kvfreer);
+    table_free_entries(&map->table, map->kvfreer);
+    map->moved = 0;
+}
+
+void hash_map_free(hash_map_t *map)
+{
+    if (map == NULL) {
+        return;
+    }
+
+    hash_map_clear(map);
+    free(map);
+}
+
+bool hash_map_insert(hash_map_t *map, void *key, void *value)
+{
+    hash_entry_t entry = { 0 };
+
+    if (map == NULL || key == NULL || value == NULL) {
+        ERROR("map, key or value is empty!");
+        return false;
+    }
+
+    // unique key
+    if (map_find(map, (const char *)key) != NULL) {
+        ERROR("the key already existed in hash map!");
+        return false;
+    }
+
+    if (!grow_if_needed(map)) {
+        return false;
+    }
+
+    entry.key = key;
+    entry.value = value;
+    entry.hash = hash_map_str_hash((const char *)key);
+    table_put(&map->table, entry);
+
+    move_old_entries(map, HASH_MAP_MOVE_STEPS);
+    return true;
+}
+
+bool hash_map_replace(hash_map_t *map, void *key, void *value)
+{
+    hash_entry_t *entry = NULL;
+
+    if (map == NULL || key == NULL || value == NULL) {
+        ERROR("map, key or value is empty!");
+        return false;
+    }
+
+    // if not find, then insert
+    entry = map_find(map, (const char *)key);
+    if (entry == NULL) {
+        return hash_map_insert(map, key, value);
+    }
+
+    if (map->kvfreer != NULL) {
+        map->kvfreer(key, entry->value);
+    }
+    entry->value = value;
+
+    return true;
+}
+
+bool hash_map_remove(hash_map_t *map, const void *key)
+{
+    uint32_t hash = 0;
+    hash_table_t *table = NULL;
+    hash_entry_t *entry = NULL;
+
+    if (map == NULL || key == NULL) {
+        return false;
+    }
+
+    hash = hash_map_str_hash((const char *)key);
+    table = &map->table;
+    entry = table_find(table, (const char *)key, hash);
+    if (entry == NULL) {
+        table = &map->old;
+        entry = table_find(table, (const char *)key, hash);
+    }
+    if (entry == NULL) {
+        ERROR("no such key in hash map");
+        return false;
+    }
+
+    if (map->kvfreer != NULL) {
+        map->kvfreer(entry->key, entry->value);
+    }
+    table_erase(table, entry);
+
+    move_old_entries(map, HASH_MAP_MOVE_STEPS);
+    return true;
+}
+
+void *hash_map_search(const hash_map_t *map, const void *key)
+{
+    hash_entry_t *entry = NULL;
+
+    if (map == NULL || key == NULL) {
+        return NULL;
+    }
+
+    entry = map_find(map, (const char *)key);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    return entry->value;
+}
+
+size_t hash_map_size(const hash_map_t *map)
+{
+    if (map == NULL) {
+        return 0;
+    }
+
+    return map->table.size + map->old.size;
+}
+
+// find an entry from itor->slot of itor->table, going to the other table at the end
+static bool iterator_seek(hash_iterator_t *itor, bool forward)
+{
+    while (itor->table != NULL) {
+        if (forward) {
+            for (; itor->slot < itor->table->cap; itor->slot++) {
+                if (itor->table->entries[itor->slot].dist != 0) {
+                    return true;
+                }
+            }
+            itor->table = (itor->table == &itor->map->old) ? &itor->map->table : NULL;
+            itor->slot = 0;
+        } else {
+            for (; itor->slot > 0; itor->slot--) {
+                if (itor->table->entries[itor->slot - 1].dist != 0) {
+                    itor->slot--;
+                    return true;
+                }
+            }
+            itor->table = (itor->table == &itor->map->table) ? &itor->map->old : NULL;
+            itor->slot = (itor->table != NULL) ? itor->table->cap : 0;
+        }
+    }
+
+    return false;
+}
+
+void hash_iterator_init(hash_iterator_t *itor, hash_map_t *map)
+{
+    if (itor == NULL) {
+        return;
+    }
+
+    itor->map = map;
+    (void)hash_iterator_first(itor);
+}
+
+bool hash_iterator_valid(const hash_iterator_t *itor)
+{
+    return itor != NULL && itor->table != NULL;
+}
+
+bool hash_iterator_next(hash_iterator_t *itor)
+{
+    if (!hash_iterator_valid(itor)) {
+        return false;
+    }
+
+    itor->slot++;
+    return iterator_seek(itor, true);
+}
+
+bool hash_iterator_prev(hash_iterator_t *itor)
+{
+    if (!hash_iterator_valid(itor)) {
+        return false;
+    }
+
+    return iterator_seek(itor, false);
+}
+
+bool hash_iterator_first(hash_iterator_t *itor)
+{
+    if (itor == NULL || itor->map == NULL) {
+        return false;
+    }
+
+    itor->table = &itor->map->old;
+    itor->slot = 0;
+    return iterator_seek(itor, true);
+}
+
+bool hash_iterator_last(hash_iterator_t *itor)
+{
+    if (itor == NULL || itor->map == NULL) {
+        return false;
+    }
+
+    itor->table = &itor->map->table;
+    itor->slot = itor->table->cap;
+    return iterator_seek(itor, false);
+}
+
+void *hash_iterator_key(const hash_iterator_t *itor)
+{
+    if (!hash_iterator_valid(itor)) {
+        return NULL;
+    }
+
+    return itor->table->entries[itor->slot].key;
+}
+
+void *hash_iterator_value(const hash_iterator_t *itor)
+{
+    if (!hash_iterator_valid(itor)) {
+        return NULL;
+    }
+
+    return itor->table->entries[itor->slot].value;
+}
@@ -0,0 +1,87 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide hash map of string keys
+ ******************************************************************************/
+#ifndef UTILS_CUTILS_MAP_HASH_MAP_H
+#define UTILS_CUTILS_MAP_HASH_MAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "rb_tree.h"
+
+#if defined(__cplusplus) || defined(c_plusplus)
+extern "C" {
+#endif
+
+typedef struct hash_entry {
+    void *key;
+    void *value;
+    uint32_t hash;
+    // distance to the home slot of hash plus one, 0 if the slot is empty
+    uint32_t dist;
+} hash_entry_t;
+
+typedef struct hash_table {
+    hash_entry_t *entries;
+    // power of 2
+    size_t cap;
+    size_t size;
+} hash_table_t;
+
+/*
+ * Open addressing with robin hood probing. The table grows incrementally: after a grow
+ * the entries of the old table are moved a few slots per insert or remove, so no
+ * single insert rehashes the whole map.
+ */
+typedef struct hash_map {
+    hash_table_t table;
+    // the table before the last grow, until all its entries are moved
+    hash_table_t old;
+    size_t moved;
+    key_value_freer kvfreer;
+} hash_map_t;
+
+// iterates the old table then the new one, the map must not change meanwhile
+typedef struct hash_iterator {
+    hash_map_t *map;
+    hash_table_t *table;
+    size_t slot;
+} hash_iterator_t;
+
+uint32_t hash_map_str_hash(const char *key);
+
+hash_map_t *hash_map_new(key_value_freer kvfreer);
+void hash_map_clear(hash_map_t *map);
+void hash_map_free(hash_map_t *map);
+bool hash_map_insert(hash_map_t *map, void *key, void *value);
+bool hash_map_replace(hash_map_t *map, void *key, void *value);
+bool hash_map_remove(hash_map_t *map, const void *key);
+void *hash_map_search(const hash_map_t *map, const void *key);
+size_t hash_map_size(const hash_map_t *map);
+
+void hash_iterator_init(hash_iterator_t *itor, hash_map_t *map);
+bool hash_iterator_valid(const hash_iterator_t *itor);
+bool hash_iterator_next(hash_iterator_t *itor);
+bool hash_iterator_prev(hash_iterator_t *itor);
+bool hash_iterator_first(hash_iterator_t *itor);
+bool hash_iterator_last(hash_iterator_t *itor);
+void *hash_iterator_key(const hash_iterator_t *itor);
+void *hash_iterator_value(const hash_iterator_t *itor);
+
+#if defined(__cplusplus) || defined(c_plusplus)
+}
+#endif
+
+#endif // UTILS_CUTILS_MAP_HASH_MAP_H
@@ -18,6 +18,12 @@
 #include "isula_libutils/log.h"
 #include "utils.h"
 
+struct _map_itor {
+    rb_iterator_t *rb_itor;
+    // used if rb_itor is NULL
+    hash_iterator_t hash_itor;
+};
+
 static void map_free_key_value(void *key, void *val)
 {
     free(key);
@@ -31,6 +37,10 @@ bool map_remove(map_t *map, void *key)
         return false;
     }
 
+    if (map->hash_store != NULL) {
+        return hash_map_remove(map->hash_store, key);
+    }
+
     return rbtree_remove(map->store, key);
 }
 
@@ -41,17 +51,40 @@ void *map_search(const map_t *map, void *key)
         return NULL;
     }
 
+    if (map->hash_store != NULL) {
+        return hash_map_search(map->hash_store, key);
+    }
+
     return rbtree_search(map->store, key);
 }
 
 /* function to return map itor */
 map_itor *map_itor_new(const map_t *map)
 {
+    map_itor *itor = NULL;
+
     if (map == NULL) {
         return NULL;
     }
 
-    return rbtree_iterator_new(map->store);
+    itor = util_common_calloc_s(sizeof(map_itor));
+    if (itor == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    if (map->hash_store != NULL) {
+        hash_iterator_init(&itor->hash_itor, map->hash_store);
+        return itor;
+    }
+
+    itor->rb_itor = rbtree_iterator_new(map->store);
+    if (itor->rb_itor == NULL) {
+        free(itor);
+        return NULL;
+    }
+
+    return itor;
 }
 
 /* function to free map itor */
@@ -61,7 +94,10 @@ void map_itor_free(map_itor *itor)
         return;
     }
 
-    rbtree_iterator_free(itor);
+    if (itor->rb_itor != NULL) {
+        rbtree_iterator_free(itor->rb_itor);
+    }
+    free(itor);
 }
 
 /* function to locate first map itor */
@@ -71,7 +107,11 @@ bool map_itor_first(map_itor *itor)
         return false;
     }
 
-    return rbtree_iterator_first(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_first(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_first(itor->rb_itor);
 }
 
 /* function to locate last map itor */
@@ -81,7 +121,11 @@ bool map_itor_last(map_itor *itor)
         return false;
     }
 
-    return rbtree_iterator_last(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_last(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_last(itor->rb_itor);
 }
 
 /* function to locate next itor */
@@ -91,7 +135,11 @@ bool map_itor_next(map_itor *itor)
         return false;
     }
 
-    return rbtree_iterator_next(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_next(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_next(itor->rb_itor);
 }
 
 /* function to locate prev itor */
@@ -101,7 +149,11 @@ bool map_itor_prev(map_itor *itor)
         return false;
     }
 
-    return rbtree_iterator_prev(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_prev(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_prev(itor->rb_itor);
 }
 
 /* function to check itor is valid */
@@ -111,7 +163,11 @@ bool map_itor_valid(const map_itor *itor)
         return false;
     }
 
-    return rbtree_iterator_valid(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_valid(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_valid(itor->rb_itor);
 }
 
 /* function to check itor is valid */
@@ -121,7 +177,11 @@ void *map_itor_key(map_itor *itor)
         return NULL;
     }
 
-    return rbtree_iterator_key(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_key(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_key(itor->rb_itor);
 }
 
 /* function to check itor is valid */
@@ -131,7 +191,11 @@ void *map_itor_value(map_itor *itor)
         return NULL;
     }
 
-    return rbtree_iterator_value(itor);
+    if (itor->rb_itor == NULL) {
+        return hash_iterator_value(&itor->hash_itor);
+    }
+
+    return rbtree_iterator_value(itor->rb_itor);
 }
 
 /* function to get size of map */
@@ -141,6 +205,10 @@ size_t map_size(const map_t *map)
         return 0;
     }
 
+    if (map->hash_store != NULL) {
+        return hash_map_size(map->hash_store);
+    }
+
     return rbtree_size(map->store);
 }
 
@@ -271,7 +339,8 @@ bool map_replace(const map_t *map, void *key, void *value)
         return false;
     }
 
-    bool ret = rbtree_replace(map->store, tmp, tmp_value);
+    bool ret = (map->hash_store != NULL) ? hash_map_replace(map->hash_store, tmp, tmp_value) :
+               rbtree_replace(map->store, tmp, tmp_value);
     if (!ret) {
         ERROR("failed to replace node in rbtree");
         if (!is_key_ptr(map->type)) {
@@ -310,7 +379,8 @@ bool map_insert(map_t *map, void *key, void *value)
         return false;
     }
 
-    bool ret = rbtree_insert(map->store, tmp, tmp_value);
+    bool ret = (map->hash_store != NULL) ? hash_map_insert(map->hash_store, tmp, tmp_value) :
+               rbtree_insert(map->store, tmp, tmp_value);
     if (!ret) {
         ERROR("failed to insert node to rbtree");
         if (!is_key_ptr(map->type)) {
@@ -361,12 +431,39 @@ map_t *map_new(map_type_t kvtype, map_cmp_func comparator, map_kvfree_func kvfre
     return map;
 }
 
+// malloc a new map of string keys by type, stored in a hash table
+map_t *map_new_hash(map_type_t kvtype, map_kvfree_func kvfree)
+{
+    map_t *map = NULL;
+
+    if (!is_key_str(kvtype)) {
+        ERROR("hash map only supports string keys");
+        return NULL;
+    }
+
+    map = util_common_calloc_s(sizeof(map_t));
+    if (map == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    map->type = kvtype;
+    map->hash_store = hash_map_new(kvfree == MAP_DEFAULT_FREE_FUNC ? map_free_key_value : kvfree);
+    if (map->hash_store == NULL) {
+        map_free(map);
+        return NULL;
+    }
+    return map;
+}
+
 /* just clear all nodes */
 void map_clear(map_t *map)
 {
     if (map != NULL && map->store != NULL) {
         rbtree_clear(map->store);
     }
+    if (map != NULL && map->hash_store != NULL) {
+        hash_map_clear(map->hash_store);
+    }
 }
 
 /* map free */
@@ -380,6 +477,10 @@ void map_free(map_t *map)
         rbtree_free(map->store);
         map->store = NULL;
     }
+    if (map->hash_store != NULL) {
+        hash_map_free(map->hash_store);
+        map->hash_store = NULL;
+    }
     free(map);
 }
 
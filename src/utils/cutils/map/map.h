@@ -19,15 +19,17 @@
 #include <stddef.h>
 
 #include "rb_tree.h"
+#include "hash_map.h"
 
 struct _map_t;
+struct _map_itor;
 
 #if defined(__cplusplus) || defined(c_plusplus)
 extern "C" {
 #endif
 
 typedef struct _map_t map_t;
-typedef struct rb_iterator map_itor;
+typedef struct _map_itor map_itor;
 
 #define MAP_DEFAULT_CMP_FUNC NULL
 #define MAP_DEFAULT_FREE_FUNC NULL
@@ -97,10 +99,15 @@ typedef enum {
 struct _map_t {
     map_type_t type;
     rb_tree_t *store;
+    // set instead of store by map_new_hash
+    hash_map_t *hash_store;
 };
 
 map_t *map_new(map_type_t kvtype, map_cmp_func comparator, map_kvfree_func kvfree);
 
+/* map of string keys on a hash table, faster than map_new, but iterated in no particular order */
+map_t *map_new_hash(map_type_t kvtype, map_kvfree_func kvfree);
+
 void map_free(map_t *map);
 
 void map_clear(map_t *map);
@@ -28,7 +28,13 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <sched.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
 #include <sys/prctl.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/utsname.h>
@@ -132,6 +138,10 @@ out:
     return ret;
 }
 
+#ifndef __NR_close_range
+#define __NR_close_range 436
+#endif
+
 #ifndef PR_SET_MM
 #define PR_SET_MM 35
 #endif
@@ -157,12 +167,41 @@ static bool util_is_std_fileno(int fd)
     return fd == STDIN_FILENO || fd == STDOUT_FILENO || fd == STDERR_FILENO;
 }
 
+static int util_close_range(unsigned int first, unsigned int last)
+{
+    return (int)syscall(__NR_close_range, first, last, 0);
+}
+
+// close_range is not supported by kernels before 5.9
+static bool util_close_range_supported(void)
+{
+    return util_close_range(~0U, ~0U) == 0;
+}
+
+// close all fds but stdio and fd_to_ignore without walking /proc/self/fd
+static int close_inherited_by_range(int fd_to_ignore)
+{
+    if (fd_to_ignore <= STDERR_FILENO) {
+        return util_close_range(STDERR_FILENO + 1, ~0U);
+    }
+
+    if (fd_to_ignore > STDERR_FILENO + 1 && util_close_range(STDERR_FILENO + 1, (unsigned int)fd_to_ignore - 1) != 0) {
+        return -1;
+    }
+
+    return util_close_range((unsigned int)fd_to_ignore + 1, ~0U);
+}
+
 int util_check_inherited(bool closeall, int fd_to_ignore)
 {
     struct dirent *pdirent = NULL;
     int fd, fddir;
     DIR *directory = NULL;
 
+    if (closeall && close_inherited_by_range(fd_to_ignore) == 0) {
+        return 0;
+    }
+
 restart:
     directory = opendir("/proc/self/fd");
     if (directory == NULL) {
@@ -719,6 +758,27 @@ static void close_pipes_fd(int *pipes, size_t pipe_size)
     }
 }
 
+/*
+ * Only the end of the parent is nonblocking, a child writing more than the pipe holds
+ * or reading its stdin before it is written would fail with EAGAIN.
+ */
+static int exec_pipe(int fds[2], int parent_end)
+{
+    int flags = 0;
+
+    if (pipe2(fds, O_CLOEXEC) != 0) {
+        return -1;
+    }
+
+    flags = fcntl(fds[parent_end], F_GETFL);
+    if (flags < 0 || fcntl(fds[parent_end], F_SETFL, flags | O_NONBLOCK) != 0) {
+        close_pipes_fd(fds, 2);
+        return -1;
+    }
+
+    return 0;
+}
+
 bool util_exec_cmd(exec_func_t cb_func, void *args, const char *stdin_msg, char **stdout_msg, char **stderr_msg)
 {
     bool ret = false;
@@ -736,19 +796,19 @@ bool util_exec_cmd(exec_func_t cb_func, void *args, const char *stdin_msg, char
     pid_t pid = 0;
     int status = 0;
 
-    if (pipe2(in_fd, O_CLOEXEC | O_NONBLOCK) != 0) {
+    if (exec_pipe(in_fd, 1) != 0) {
         ERROR("Failed to create stdin pipe");
         set_stderr_buf(&stderr_buffer, "Failed to create stdin pipe");
         goto out;
     }
 
-    if (pipe2(err_fd, O_CLOEXEC | O_NONBLOCK) != 0) {
+    if (exec_pipe(err_fd, 0) != 0) {
         ERROR("Failed to create pipe");
         set_stderr_buf(&stderr_buffer, "Failed to create pipe");
         close_pipes_fd(in_fd, 2);
         goto out;
     }
-    if (pipe2(out_fd, O_CLOEXEC | O_NONBLOCK) != 0) {
+    if (exec_pipe(out_fd, 0) != 0) {
         ERROR("Failed to create pipe");
         set_stderr_buf(&stderr_buffer, "Failed to create pipe");
         close_pipes_fd(in_fd, 2);
@@ -845,6 +905,249 @@ out:
     return ret;
 }
 
+#define EXEC_ARGV_STACK_SIZE (64 * 1024)
+
+struct exec_argv_child_args {
+    const char *path;
+    char **argv;
+    const char *dir;
+    // stdin, stdout and stderr of the child
+    int stdio_fds[3];
+    const sigset_t *sigmask;
+    int err;
+};
+
+static int set_child_stdio(int fd, int target)
+{
+    // dup2 to itself keeps FD_CLOEXEC of the pipe
+    if (fd == target) {
+        return fcntl(fd, F_SETFD, 0);
+    }
+
+    return dup2(fd, target) < 0 ? -1 : 0;
+}
+
+/*
+ * Runs in the memory of the parent until execve, only syscalls can be used here:
+ * no malloc, no locks and no log.
+ */
+static int exec_argv_child(void *arg)
+{
+    struct exec_argv_child_args *cargs = (struct exec_argv_child_args *)arg;
+    struct sigaction sa;
+    int i;
+
+    // handlers of the parent must not run in the child with its blocked signals restored
+    for (i = 1; i < NSIG; i++) {
+        if (sigaction(i, NULL, &sa) != 0 || sa.sa_handler == SIG_IGN || sa.sa_handler == SIG_DFL) {
+            continue;
+        }
+        (void)memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = SIG_DFL;
+        (void)sigaction(i, &sa, NULL);
+    }
+
+    for (i = STDIN_FILENO; i <= STDERR_FILENO; i++) {
+        if (set_child_stdio(cargs->stdio_fds[i], i) != 0) {
+            goto err_out;
+        }
+    }
+
+    if (close_inherited_by_range(-1) != 0) {
+        goto err_out;
+    }
+
+    /* become session leader */
+    (void)setsid();
+
+    if (cargs->dir != NULL && chdir(cargs->dir) != 0) {
+        goto err_out;
+    }
+
+    if (sigprocmask(SIG_SETMASK, cargs->sigmask, NULL) != 0) {
+        goto err_out;
+    }
+
+    execve(cargs->path, cargs->argv, environ);
+
+err_out:
+    cargs->err = errno;
+    _exit(127);
+}
+
+// child of util_exec_cmd on kernels without close_range
+static void exec_argv_func(void *args)
+{
+    struct exec_argv_child_args *cargs = (struct exec_argv_child_args *)args;
+
+    if (cargs->dir != NULL && chdir(cargs->dir) != 0) {
+        dprintf(STDERR_FILENO, "chdir %s failed: %s", cargs->dir, strerror(errno));
+        _exit(127);
+    }
+
+    execv(cargs->path, cargs->argv);
+    dprintf(STDERR_FILENO, "exec %s failed: %s", cargs->path, strerror(errno));
+    _exit(127);
+}
+
+/*
+ * Start the child like vfork, it shares the memory of the parent until execve,
+ * so there are no page tables to copy however big the daemon is.
+ */
+static pid_t exec_argv_spawn(struct exec_argv_child_args *cargs)
+{
+    pid_t pid = -1;
+    char *stack = NULL;
+    sigset_t all;
+    sigset_t old;
+
+    stack = mmap(NULL, EXEC_ARGV_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (stack == MAP_FAILED) {
+        SYSERROR("Failed to map stack of child");
+        return -1;
+    }
+
+    // no signal handler may run on the stack of the child before it has reset them
+    (void)sigfillset(&all);
+    (void)pthread_sigmask(SIG_SETMASK, &all, &old);
+    cargs->sigmask = &old;
+    cargs->err = 0;
+
+    // the parent is suspended until the child calls execve or exits
+    pid = clone(exec_argv_child, stack + EXEC_ARGV_STACK_SIZE, CLONE_VM | CLONE_VFORK | SIGCHLD, cargs);
+    if (pid < 0) {
+        SYSERROR("Failed to clone child");
+    }
+
+    (void)pthread_sigmask(SIG_SETMASK, &old, NULL);
+    (void)munmap(stack, EXEC_ARGV_STACK_SIZE);
+    cargs->sigmask = NULL;
+
+    return pid;
+}
+
+static void exec_argv_read_output(int out_fd, int err_fd, char **stdout_buffer, char **stderr_buffer,
+                                  size_t *stderr_real_size)
+{
+    struct pollfd pfds[2] = { { .fd = out_fd, .events = POLLIN }, { .fd = err_fd, .events = POLLIN } };
+    size_t buf_size[2] = { 0 };
+    size_t real_size[2] = { 0 };
+    char **buffer[2] = { stdout_buffer, stderr_buffer };
+    int i;
+
+    while (pfds[0].fd >= 0 || pfds[1].fd >= 0) {
+        if (poll(pfds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            SYSERROR("Failed to poll output of cmd");
+            break;
+        }
+        for (i = 0; i < 2; i++) {
+            if (pfds[i].revents == 0) {
+                continue;
+            }
+            if (util_read_pipe(pfds[i].fd, buffer[i], &buf_size[i], &real_size[i]) != 0) {
+                // a negative fd is ignored by poll
+                pfds[i].fd = -1;
+            }
+        }
+    }
+
+    *stderr_real_size = real_size[1];
+}
+
+bool util_exec_argv_cmd(const char *dir, char **argv, const char *stdin_msg, char **stdout_msg, char **stderr_msg)
+{
+    bool ret = false;
+    char *stdout_buffer = NULL;
+    char *stderr_buffer = NULL;
+    char *path = NULL;
+    char *err = NULL;
+    size_t stderr_real_size = 0;
+    int err_fd[2] = { -1, -1 };
+    int out_fd[2] = { -1, -1 };
+    int in_fd[2] = { -1, -1 };
+    struct exec_argv_child_args cargs = { 0 };
+    pid_t pid = 0;
+    int status = 0;
+
+    if (argv == NULL || argv[0] == NULL || stdout_msg == NULL || stderr_msg == NULL) {
+        ERROR("Invalid arguments");
+        return false;
+    }
+
+    // resolved here as execvp may allocate in the child
+    path = look_path(argv[0], &err);
+    if (path == NULL) {
+        ERROR("Failed to find cmd %s: %s", argv[0], err != NULL ? err : "not found");
+        set_stderr_buf(&stderr_buffer, "Failed to find cmd %s", argv[0]);
+        goto out;
+    }
+    cargs.path = path;
+    cargs.argv = argv;
+    cargs.dir = dir;
+
+    if (!util_close_range_supported()) {
+        ret = util_exec_cmd(exec_argv_func, &cargs, stdin_msg, &stdout_buffer, &stderr_buffer);
+        goto out;
+    }
+
+    if (exec_pipe(in_fd, 1) != 0 || exec_pipe(err_fd, 0) != 0 || exec_pipe(out_fd, 0) != 0) {
+        ERROR("Failed to create pipe");
+        set_stderr_buf(&stderr_buffer, "Failed to create pipe");
+        goto close_out;
+    }
+    cargs.stdio_fds[STDIN_FILENO] = in_fd[0];
+    cargs.stdio_fds[STDOUT_FILENO] = out_fd[1];
+    cargs.stdio_fds[STDERR_FILENO] = err_fd[1];
+
+    pid = exec_argv_spawn(&cargs);
+    if (pid < 0) {
+        set_stderr_buf(&stderr_buffer, "Failed to clone()");
+        goto close_out;
+    }
+
+    close_pipes_fd(&in_fd[0], 1);
+    close_pipes_fd(&out_fd[1], 1);
+    close_pipes_fd(&err_fd[1], 1);
+
+    if (cargs.err != 0) {
+        // the child has exited already
+        (void)util_wait_for_pid_status(pid);
+        ERROR("Failed to exec %s: %s", path, strerror(cargs.err));
+        set_stderr_buf(&stderr_buffer, "Failed to exec %s: %s", path, strerror(cargs.err));
+        goto close_out;
+    }
+
+    if (stdin_msg != NULL) {
+        size_t len = strlen(stdin_msg);
+        if (util_write_nointr(in_fd[1], stdin_msg, len) != len) {
+            WARN("Write instr: %s failed", stdin_msg);
+        }
+    }
+    close_pipes_fd(&in_fd[1], 1);
+
+    exec_argv_read_output(out_fd[0], err_fd[0], &stdout_buffer, &stderr_buffer, &stderr_real_size);
+
+    marshal_stderr_msg(&stderr_buffer, &stderr_real_size);
+
+    status = util_wait_for_pid_status(pid);
+
+    ret = deal_with_result_of_waitpid(status, &stderr_buffer, stderr_real_size);
+
+close_out:
+    close_pipes_fd(in_fd, 2);
+    close_pipes_fd(err_fd, 2);
+    close_pipes_fd(out_fd, 2);
+out:
+    free(path);
+    free(err);
+    *stdout_msg = stdout_buffer;
+    *stderr_msg = stderr_buffer;
+    return ret;
+}
+
 char **util_get_backtrace(void)
 {
 #define BACKTRACE_SIZE 16
@@ -330,6 +330,12 @@ int util_wait_for_pid_status(pid_t pid);
 typedef void (*exec_func_t)(void *args);
 bool util_exec_cmd(exec_func_t cb_func, void *args, const char *stdin_msg, char **stdout_msg, char **stderr_msg);
 
+/*
+ * util_exec_cmd of argv without a callback, the child is started like vfork and does not
+ * copy the page tables of the daemon, dir is the working dir of the child if not NULL
+ */
+bool util_exec_argv_cmd(const char *dir, char **argv, const char *stdin_msg, char **stdout_msg, char **stderr_msg);
+
 typedef void (*exec_top_func_t)(char **args, const char *pid_args, size_t args_len);
 bool util_exec_top_cmd(exec_top_func_t cb_func, char **args, const char *pid_args, size_t args_len, char **stdout_msg,
                        char **stderr_msg);
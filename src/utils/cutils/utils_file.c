@@ -29,9 +29,13 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <pthread.h>
 #include <sys/types.h>
 #include <grp.h>
 #include <sys/xattr.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
 
 #include "constants.h"
 #include "isula_libutils/log.h"
@@ -41,7 +45,8 @@
 #include "utils_array.h"
 #include "utils_string.h"
 
-int copy_dir_recursive(char *copy_dst, char *copy_src, map_t *inodes);
+struct copy_tree;
+static int copy_dir_recursive(char *copy_dst, char *copy_src, struct copy_tree *tree);
 static void do_calculate_dir_size_without_hardlink(const char *dirpath, int recursive_depth, int64_t *total_size,
                                                    int64_t *total_inode, map_t *map);
 
@@ -362,11 +367,6 @@ static int recursive_rmdir_helper(const char *dirpath, int recursive_depth, int
     return failure;
 }
 
-static void run_force_rmdir(void *args)
-{
-    execvp(((char **)args)[0], (char **)args);
-}
-
 static int exec_force_rmdir_command(const char *dir)
 {
     int ret = 0;
@@ -386,7 +386,7 @@ static int exec_force_rmdir_command(const char *dir)
         goto free_out;
     }
 
-    if (!util_exec_cmd(run_force_rmdir, args, NULL, &stdout_msg, &stderr_msg)) {
+    if (!util_exec_argv_cmd(NULL, args, NULL, &stdout_msg, &stderr_msg)) {
         ERROR("force rmdir failed, unexpected command output %s with error: %s", stdout_msg, stderr_msg);
         ret = -1;
         goto free_out;
@@ -1107,15 +1107,198 @@ char *verify_file_and_get_real_path(const char *file)
     return util_strdup_s(resolved_path);
 }
 
+/*
+ * Data of regular files is copied in kernel when possible: FICLONE shares the extents on
+ * filesystems with reflink, else copy_file_range, sendfile and at last pread/pwrite are used.
+ * Holes found by SEEK_DATA/SEEK_HOLE are not copied, so sparse files stay sparse.
+ */
+#define COPY_CHUNK_SIZE (1024 * 1024)
+#define COPY_RW_BUFSIZE (64 * 1024)
+
+enum copy_method {
+    COPY_METHOD_RANGE = 0,
+    COPY_METHOD_SENDFILE,
+    COPY_METHOD_RW,
+};
+
+static ssize_t copy_file_range_nointr(int src_fd, off_t *src_off, int dst_fd, off_t *dst_off, size_t len)
+{
+#ifdef __NR_copy_file_range
+    ssize_t nret;
+
+    do {
+        nret = syscall(__NR_copy_file_range, src_fd, src_off, dst_fd, dst_off, len, 0);
+    } while (nret < 0 && errno == EINTR);
+    return nret;
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+static ssize_t sendfile_nointr(int src_fd, int dst_fd, off_t offset, size_t len)
+{
+    off_t src_off = offset;
+    ssize_t nret;
+
+    // sendfile writes at the file offset of dst_fd
+    if (lseek(dst_fd, offset, SEEK_SET) < 0) {
+        return -1;
+    }
+    do {
+        nret = sendfile(dst_fd, src_fd, &src_off, len);
+    } while (nret < 0 && errno == EINTR);
+    return nret;
+}
+
+static ssize_t copy_rw_chunk(int src_fd, int dst_fd, off_t offset, size_t len)
+{
+    char buf[COPY_RW_BUFSIZE];
+    ssize_t nread;
+    ssize_t nwrite;
+    ssize_t done = 0;
+
+    do {
+        nread = pread(src_fd, buf, MIN(len, sizeof(buf)), offset);
+    } while (nread < 0 && errno == EINTR);
+    if (nread <= 0) {
+        return nread;
+    }
+    while (done < nread) {
+        nwrite = pwrite(dst_fd, buf + done, (size_t)(nread - done), offset + done);
+        if (nwrite < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += nwrite;
+    }
+    return nread;
+}
+
+static int copy_data_range(int src_fd, int dst_fd, off_t offset, off_t len, enum copy_method *method)
+{
+    off_t end = offset + len;
+    off_t src_off = 0;
+    off_t dst_off = 0;
+    size_t chunk = 0;
+    ssize_t nret = 0;
+
+    while (offset < end) {
+        chunk = (size_t)MIN(end - offset, COPY_CHUNK_SIZE);
+        if (*method == COPY_METHOD_RANGE) {
+            src_off = offset;
+            dst_off = offset;
+            nret = copy_file_range_nointr(src_fd, &src_off, dst_fd, &dst_off, chunk);
+            // 0 before the end does not mean end of file on all filesystems, e.g. files whose
+            // size is not known to the kernel, so it is a failure and the next method is tried
+            if (nret == 0 ||
+                (nret < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))) {
+                *method = COPY_METHOD_SENDFILE;
+                continue;
+            }
+        } else if (*method == COPY_METHOD_SENDFILE) {
+            nret = sendfile_nointr(src_fd, dst_fd, offset, chunk);
+            if (nret == 0 || (nret < 0 && (errno == ENOSYS || errno == EINVAL))) {
+                *method = COPY_METHOD_RW;
+                continue;
+            }
+        } else {
+            nret = copy_rw_chunk(src_fd, dst_fd, offset, chunk);
+        }
+        if (nret < 0) {
+            return -1;
+        }
+        if (nret == 0) {
+            // only read tells the end, the source file was truncated
+            break;
+        }
+        offset += nret;
+    }
+
+    return 0;
+}
+
+static int copy_fd_stream(int src_fd, int dst_fd)
+{
+    char buf[COPY_RW_BUFSIZE];
+    ssize_t len = 0;
+
+    while (true) {
+        len = util_read_nointr(src_fd, buf, sizeof(buf));
+        if (len < 0) {
+            ERROR("Read src file failed: %s", strerror(errno));
+            return -1;
+        } else if (len == 0) {
+            break;
+        }
+        if (util_write_nointr(dst_fd, buf, (size_t)len) != len) {
+            ERROR("Write file failed: %s", strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int copy_fd_data(int src_fd, int dst_fd, const struct stat *st)
+{
+    enum copy_method method = COPY_METHOD_RANGE;
+    off_t offset = 0;
+    off_t data = 0;
+    off_t hole = 0;
+
+    // size of files in pseudo filesystems is unknown
+    if (st->st_size == 0) {
+        return copy_fd_stream(src_fd, dst_fd);
+    }
+
+#ifdef FICLONE
+    if (ioctl(dst_fd, FICLONE, src_fd) == 0) {
+        return 0;
+    }
+#endif
+
+    while (offset < st->st_size) {
+        data = lseek(src_fd, offset, SEEK_DATA);
+        if (data < 0 && errno == ENXIO) {
+            // only a hole is left
+            break;
+        }
+        if (data < 0) {
+            // no hole information, copy all
+            data = offset;
+            hole = st->st_size;
+        } else {
+            hole = lseek(src_fd, data, SEEK_HOLE);
+            hole = (hole < 0 || hole > st->st_size) ? st->st_size : hole;
+        }
+        if (data >= hole) {
+            break;
+        }
+        if (copy_data_range(src_fd, dst_fd, data, hole - data, &method) != 0) {
+            ERROR("Copy file data failed: %s", strerror(errno));
+            return -1;
+        }
+        offset = hole;
+    }
+
+    // sets the size when the file ends with a hole
+    if (ftruncate(dst_fd, st->st_size) != 0) {
+        ERROR("Truncate file failed: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
 int util_copy_file(const char *src_file, const char *dst_file, mode_t mode)
 {
-#define BUFSIZE 4096
     int ret = 0;
     char *nret = NULL;
     char real_src_file[PATH_MAX + 1] = { 0 };
     int src_fd = -1;
     int dst_fd = -1;
-    char buf[BUFSIZE + 1] = { 0 };
+    struct stat st = { 0 };
 
     if (src_file == NULL || dst_file == NULL) {
         return ret;
@@ -1132,27 +1315,18 @@ int util_copy_file(const char *src_file, const char *dst_file, mode_t mode)
         ret = -1;
         goto free_out;
     }
+    if (fstat(src_fd, &st) != 0) {
+        ERROR("Stat src file: %s, failed: %s", real_src_file, strerror(errno));
+        ret = -1;
+        goto free_out;
+    }
     dst_fd = util_open(dst_file, O_WRONLY | O_CREAT | O_TRUNC, mode);
     if (dst_fd < 0) {
         ERROR("Creat file: %s, failed: %s", dst_file, strerror(errno));
         ret = -1;
         goto free_out;
     }
-    while (true) {
-        ssize_t len = util_read_nointr(src_fd, buf, BUFSIZE);
-        if (len < 0) {
-            ERROR("Read src file failed: %s", strerror(errno));
-            ret = -1;
-            goto free_out;
-        } else if (len == 0) {
-            break;
-        }
-        if (util_write_nointr(dst_fd, buf, (size_t)len) != len) {
-            ERROR("Write file failed: %s", strerror(errno));
-            ret = -1;
-            goto free_out;
-        }
-    }
+    ret = copy_fd_data(src_fd, dst_fd, &st);
 
 free_out:
     if (src_fd >= 0) {
@@ -1925,6 +2099,168 @@ static int copy_folder(char *copy_dst, char *copy_src)
     return copy_infos(copy_dst, copy_src, &src_stat);
 }
 
+/*
+ * Volumes of images are copied at container create. Big regular files are handed to a few
+ * worker threads while the walker goes on creating directories and small files, the walker
+ * copies a file itself when the queue is full. Hard linked files are always copied by the
+ * walker, the link targets must exist when the next link to them is found.
+ */
+#define COPY_TREE_MAX_WORKERS 4
+#define COPY_TREE_MAX_JOBS 64
+#define COPY_TREE_JOB_MIN_SIZE (64 * 1024)
+
+struct copy_job {
+    char *src;
+    char *dst;
+    struct stat st;
+    struct copy_job *next;
+};
+
+struct copy_tree {
+    // key: source inode, value: target file path, only used by the walker
+    map_t *inodes;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct copy_job *head;
+    struct copy_job *tail;
+    size_t queued;
+    pthread_t workers[COPY_TREE_MAX_WORKERS];
+    size_t worker_num;
+    bool closed;
+    bool failed;
+};
+
+static void copy_job_free(struct copy_job *job)
+{
+    if (job == NULL) {
+        return;
+    }
+    free(job->src);
+    free(job->dst);
+    free(job);
+}
+
+static void *copy_tree_worker(void *arg)
+{
+    struct copy_tree *tree = (struct copy_tree *)arg;
+    struct copy_job *job = NULL;
+    bool failed = false;
+
+    while (true) {
+        (void)pthread_mutex_lock(&tree->mutex);
+        while (tree->head == NULL && !tree->closed) {
+            (void)pthread_cond_wait(&tree->cond, &tree->mutex);
+        }
+        job = tree->head;
+        if (job != NULL) {
+            tree->head = job->next;
+            if (tree->head == NULL) {
+                tree->tail = NULL;
+            }
+            tree->queued--;
+        }
+        failed = tree->failed;
+        (void)pthread_mutex_unlock(&tree->mutex);
+
+        if (job == NULL) {
+            break;
+        }
+        if (!failed && (util_copy_file(job->src, job->dst, job->st.st_mode) != 0 ||
+                        copy_infos(job->dst, job->src, &job->st) != 0)) {
+            ERROR("Failed to copy %s to %s", job->src, job->dst);
+            (void)pthread_mutex_lock(&tree->mutex);
+            tree->failed = true;
+            (void)pthread_mutex_unlock(&tree->mutex);
+        }
+        copy_job_free(job);
+    }
+
+    return NULL;
+}
+
+static bool copy_tree_failed(struct copy_tree *tree)
+{
+    bool failed = false;
+
+    (void)pthread_mutex_lock(&tree->mutex);
+    failed = tree->failed;
+    (void)pthread_mutex_unlock(&tree->mutex);
+    return failed;
+}
+
+// returns false if the walker should copy the file itself
+static bool copy_tree_enqueue(struct copy_tree *tree, const char *dst, const char *src, const struct stat *st)
+{
+    struct copy_job *job = NULL;
+
+    if (tree->worker_num == 0 || st->st_size < COPY_TREE_JOB_MIN_SIZE) {
+        return false;
+    }
+
+    (void)pthread_mutex_lock(&tree->mutex);
+    if (tree->queued >= COPY_TREE_MAX_JOBS) {
+        (void)pthread_mutex_unlock(&tree->mutex);
+        return false;
+    }
+    (void)pthread_mutex_unlock(&tree->mutex);
+
+    job = util_common_calloc_s(sizeof(struct copy_job));
+    if (job == NULL) {
+        return false;
+    }
+    job->src = util_strdup_s(src);
+    job->dst = util_strdup_s(dst);
+    job->st = *st;
+
+    (void)pthread_mutex_lock(&tree->mutex);
+    if (tree->tail == NULL) {
+        tree->head = job;
+    } else {
+        tree->tail->next = job;
+    }
+    tree->tail = job;
+    tree->queued++;
+    (void)pthread_cond_signal(&tree->cond);
+    (void)pthread_mutex_unlock(&tree->mutex);
+
+    return true;
+}
+
+static void copy_tree_start(struct copy_tree *tree)
+{
+    int nprocs = get_nprocs();
+    size_t want = 0;
+
+    // the walker copies too, workers only help with more than one cpu
+    if (nprocs <= 1) {
+        return;
+    }
+    want = MIN((size_t)nprocs, COPY_TREE_MAX_WORKERS);
+    for (tree->worker_num = 0; tree->worker_num < want; tree->worker_num++) {
+        if (pthread_create(&tree->workers[tree->worker_num], NULL, copy_tree_worker, tree) != 0) {
+            WARN("Failed to start copy worker, go on with %zu", tree->worker_num);
+            break;
+        }
+    }
+}
+
+static int copy_tree_finish(struct copy_tree *tree)
+{
+    size_t i;
+
+    (void)pthread_mutex_lock(&tree->mutex);
+    tree->closed = true;
+    (void)pthread_cond_broadcast(&tree->cond);
+    (void)pthread_mutex_unlock(&tree->mutex);
+
+    for (i = 0; i < tree->worker_num; i++) {
+        (void)pthread_join(tree->workers[i], NULL);
+    }
+    tree->worker_num = 0;
+
+    return tree->failed ? -1 : 0;
+}
+
 static int copy_regular(char *copy_dst, char *copy_src, struct stat *src_stat, map_t *inodes)
 {
     char *target = NULL;
@@ -1975,12 +2311,15 @@ static int copy_device(char *copy_dst, char *copy_src, struct stat *src_stat)
     return 0;
 }
 
-static int copy_file(char *copy_dst, char *copy_src, struct stat *src_stat, map_t *inodes)
+static int copy_file(char *copy_dst, char *copy_src, struct stat *src_stat, struct copy_tree *tree)
 {
     int ret = 0;
 
     if (S_ISREG(src_stat->st_mode)) {
-        ret = copy_regular(copy_dst, copy_src, src_stat, inodes);
+        if (src_stat->st_nlink == 1 && copy_tree_enqueue(tree, copy_dst, copy_src, src_stat)) {
+            return 0;
+        }
+        ret = copy_regular(copy_dst, copy_src, src_stat, tree->inodes);
     } else if (S_ISLNK(src_stat->st_mode)) {
         ret = copy_symbolic(copy_dst, copy_src);
     } else if (S_ISCHR(src_stat->st_mode) || S_ISBLK(src_stat->st_mode)) {
@@ -1999,23 +2338,31 @@ static int copy_file(char *copy_dst, char *copy_src, struct stat *src_stat, map_
 int util_copy_dir_recursive(char *copy_dst, char *copy_src)
 {
     int ret = 0;
-    map_t *inodes = NULL;
+    struct copy_tree tree = { 0 };
 
     // key: source inode, value: target file path
-    inodes = map_new(MAP_INT_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
-    if (inodes == NULL) {
+    tree.inodes = map_new(MAP_INT_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (tree.inodes == NULL) {
         ERROR("out of memory");
         return -1;
     }
+    (void)pthread_mutex_init(&tree.mutex, NULL);
+    (void)pthread_cond_init(&tree.cond, NULL);
 
-    ret = copy_dir_recursive(copy_dst, copy_src, inodes);
+    copy_tree_start(&tree);
+    ret = copy_dir_recursive(copy_dst, copy_src, &tree);
+    if (copy_tree_finish(&tree) != 0) {
+        ret = -1;
+    }
 
-    map_free(inodes);
+    (void)pthread_cond_destroy(&tree.cond);
+    (void)pthread_mutex_destroy(&tree.mutex);
+    map_free(tree.inodes);
 
     return ret;
 }
 
-int copy_dir_recursive(char *copy_dst, char *copy_src, map_t *inodes)
+static int copy_dir_recursive(char *copy_dst, char *copy_src, struct copy_tree *tree)
 {
     char **entries = NULL;
     size_t entry_num = 0;
@@ -2038,6 +2385,10 @@ int copy_dir_recursive(char *copy_dst, char *copy_src, map_t *inodes)
     entry_num = util_array_len((const char **)entries);
 
     for (i = 0; i < entry_num; i++) {
+        if (copy_tree_failed(tree)) {
+            ret = -1;
+            goto out;
+        }
         src = util_path_join(copy_src, entries[i]);
         dst = util_path_join(copy_dst, entries[i]);
         if (src == NULL || dst == NULL) {
@@ -2052,9 +2403,9 @@ int copy_dir_recursive(char *copy_dst, char *copy_src, map_t *inodes)
         }
 
         if (S_ISDIR(st.st_mode)) {
-            ret = copy_dir_recursive(dst, src, inodes);
+            ret = copy_dir_recursive(dst, src, tree);
         } else {
-            ret = copy_file(dst, src, &st, inodes);
+            ret = copy_file(dst, src, &st, tree);
         }
         if (ret != 0) {
             goto out;
@@ -32,6 +32,7 @@
 #include "utils.h"
 #include "utils_array.h"
 #include "utils_file.h"
+#include "utils_mount_table.h"
 #include "utils_string.h"
 
 #ifndef JFS_SUPER_MAGIC
@@ -314,110 +315,50 @@ out:
     return ret;
 }
 
-static char *get_mtpoint(const char *line)
-{
-    int i;
-    const char *tmp = NULL;
-    char *pend = NULL;
-    char *sret = NULL;
-    size_t len;
-
-    if (line == NULL) {
-        goto err_out;
-    }
-
-    tmp = line;
-
-    for (i = 0; i < 4; i++) {
-        tmp = strchr(tmp, ' ');
-        if (tmp == NULL) {
-            goto err_out;
-        }
-        tmp++;
-    }
-    pend = strchr(tmp, ' ');
-    if ((pend == NULL) || pend == tmp) {
-        goto err_out;
-    }
-
-    /* stuck a \0 after the mountpoint */
-    len = (size_t)(pend - tmp);
-    sret = util_common_calloc_s(len + 1);
-    if (sret == NULL) {
-        goto err_out;
-    }
-    (void)memcpy(sret, tmp, len);
-    sret[len] = '\0';
-
-err_out:
-    return sret;
-}
-
 bool util_detect_mounted(const char *path)
 {
-    FILE *fp = NULL;
-    char *line = NULL;
-    char *mountpoint = NULL;
-    size_t length = 0;
+    util_mount_table_t *table = NULL;
     bool bret = false;
 
-    fp = util_fopen("/proc/self/mountinfo", "r");
-    if (fp == NULL) {
-        ERROR("Failed opening /proc/self/mountinfo");
+    if (path == NULL) {
         return false;
     }
 
-    while (getline(&line, &length, fp) != -1) {
-        mountpoint = get_mtpoint(line);
-        if (mountpoint == NULL) {
-            INFO("Error reading mountinfo: bad line '%s'", line);
-            continue;
-        }
-        if (strcmp(mountpoint, path) == 0) {
-            free(mountpoint);
-            bret = true;
-            goto out;
-        }
-        free(mountpoint);
+    table = util_mount_table_get();
+    if (table == NULL) {
+        ERROR("Failed to get mount table");
+        return false;
     }
-out:
-    fclose(fp);
-    free(line);
+
+    bret = util_mount_table_find(table, path) != NULL;
+
+    util_mount_table_put(table);
     return bret;
 }
 
 bool util_deal_with_mount_info(mount_info_call_back_t cb, const char *pattern)
 {
-    FILE *fp = NULL;
-    char *line = NULL;
-    char *mountpoint = NULL;
-    size_t length = 0;
+    util_mount_table_t *table = NULL;
+    size_t i;
+    size_t len;
     bool bret = true;
-    int nret = 0;
 
-    fp = util_fopen("/proc/self/mountinfo", "r");
-    if (fp == NULL) {
-        ERROR("Failed opening /proc/self/mountinfo");
+    table = util_mount_table_get();
+    if (table == NULL) {
+        ERROR("Failed to get mount table");
         return false;
     }
 
-    while (getline(&line, &length, fp) != -1) {
-        mountpoint = get_mtpoint(line);
-        if (mountpoint == NULL) {
-            INFO("Error reading mountinfo: bad line '%s'", line);
-            continue;
-        }
-        nret = cb(mountpoint, pattern);
-        free(mountpoint);
-        if (nret != 0) {
+    // callbacks may umount, the snapshot does not change under them
+    len = util_mount_table_len(table);
+    for (i = 0; i < len; i++) {
+        if (cb(util_mount_table_at(table, i)->mountpoint, pattern) != 0) {
             bret = false;
-            goto out;
+            break;
         }
     }
 
-out:
-    fclose(fp);
-    free(line);
+    util_mount_table_put(table);
     return bret;
 }
 
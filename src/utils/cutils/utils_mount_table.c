@@ -0,0 +1,363 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide cached mount table of the process
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "utils_mount_table.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "utils_convert.h"
+#include "map.h"
+
+/*
+ * With thousands of overlay mounts, parsing mountinfo for every lookup made each container
+ * operation O(mounts). The table is parsed once into entries indexed by mount point and
+ * mount id, and kept until poll on an open mountinfo reports POLLPRI, which the kernel does
+ * after every mount, umount and remount in the namespace.
+ */
+#define MOUNTINFO_PATH "/proc/self/mountinfo"
+#define MOUNTINFO_READ_SIZE (64 * 1024)
+#define MOUNTINFO_MIN_FIELDS 10
+
+struct util_mount_table {
+    // mountinfo data, fields of entries point into it
+    char *data;
+    util_mount_entry_t *entries;
+    size_t len;
+    // mountpoint to first entry on it
+    map_t *by_point;
+    // mount id to entry
+    map_t *by_id;
+    // references of a cached table, protected by the cache mutex
+    size_t refs;
+    bool cached;
+};
+
+static struct {
+    pthread_mutex_t mutex;
+    int fd;
+    // the fd shows the mount namespace of the process which opened it
+    pid_t pid;
+    util_mount_table_t *table;
+} g_mount_cache = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .fd = -1,
+};
+
+static void mount_table_index_kvfree(void *key, void *value)
+{
+    (void)value;
+    free(key);
+}
+
+static void mount_table_free(util_mount_table_t *table)
+{
+    if (table == NULL) {
+        return;
+    }
+    map_free(table->by_point);
+    map_free(table->by_id);
+    free(table->entries);
+    free(table->data);
+    free(table);
+}
+
+static char *mount_table_read(int fd)
+{
+    char *data = NULL;
+    char *tmp = NULL;
+    size_t size = 0;
+    size_t len = 0;
+    ssize_t nret = 0;
+
+    if (lseek(fd, 0, SEEK_SET) < 0) {
+        SYSERROR("Failed to seek %s", MOUNTINFO_PATH);
+        return NULL;
+    }
+
+    while (true) {
+        if (size - len < MOUNTINFO_READ_SIZE + 1) {
+            if (util_mem_realloc((void **)&tmp, size + MOUNTINFO_READ_SIZE + 1, data, size) != 0) {
+                ERROR("Out of memory");
+                free(data);
+                return NULL;
+            }
+            data = tmp;
+            size += MOUNTINFO_READ_SIZE + 1;
+        }
+        nret = util_read_nointr(fd, data + len, size - len - 1);
+        if (nret < 0) {
+            SYSERROR("Failed to read %s", MOUNTINFO_PATH);
+            free(data);
+            return NULL;
+        }
+        if (nret == 0) {
+            break;
+        }
+        len += (size_t)nret;
+    }
+    data[len] = '\0';
+
+    return data;
+}
+
+// split line in place, "36 35 98:0 /mnt1 /mnt2 rw,noatime master:1 - ext3 /dev/root rw"
+static int mount_table_parse_line(char *line, util_mount_entry_t *entry)
+{
+    char *fields[MOUNTINFO_MIN_FIELDS] = { 0 };
+    char *saveptr = NULL;
+    char *field = NULL;
+    size_t n = 0;
+    bool optional_end = false;
+
+    for (field = strtok_r(line, " ", &saveptr); field != NULL; field = strtok_r(NULL, " ", &saveptr)) {
+        if (n < 6) {
+            fields[n++] = field;
+            continue;
+        }
+        if (!optional_end) {
+            if (strcmp(field, "-") == 0) {
+                optional_end = true;
+            } else if (fields[6] == NULL) {
+                fields[6] = field;
+            }
+            n = 7;
+            continue;
+        }
+        if (n < MOUNTINFO_MIN_FIELDS) {
+            fields[n++] = field;
+        }
+    }
+    if (!optional_end || n < MOUNTINFO_MIN_FIELDS) {
+        return -1;
+    }
+
+    if (util_safe_int(fields[0], &entry->id) != 0 || util_safe_int(fields[1], &entry->parent_id) != 0) {
+        return -1;
+    }
+    entry->root = fields[3];
+    entry->mountpoint = fields[4];
+    entry->opts = fields[5];
+    entry->optional = fields[6];
+    entry->fstype = fields[7];
+    entry->source = fields[8];
+    entry->vfsopts = fields[9];
+    return 0;
+}
+
+static int mount_table_index(util_mount_table_t *table)
+{
+    util_mount_entry_t *entry = NULL;
+    size_t i;
+
+    table->by_point = map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, mount_table_index_kvfree);
+    table->by_id = map_new(MAP_INT_PTR, MAP_DEFAULT_CMP_FUNC, mount_table_index_kvfree);
+    if (table->by_point == NULL || table->by_id == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+
+    for (i = 0; i < table->len; i++) {
+        entry = &table->entries[i];
+        // stacked mounts, keep the first like a scan of mountinfo finds
+        if (map_search(table->by_point, entry->mountpoint) == NULL &&
+            !map_insert(table->by_point, entry->mountpoint, entry)) {
+            ERROR("Failed to index mount point %s", entry->mountpoint);
+            return -1;
+        }
+        if (!map_insert(table->by_id, &entry->id, entry)) {
+            ERROR("Failed to index mount id %d", entry->id);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static util_mount_table_t *mount_table_build(int fd)
+{
+    util_mount_table_t *table = NULL;
+    char *line = NULL;
+    char *saveptr = NULL;
+    size_t lines = 0;
+    const char *p = NULL;
+
+    table = util_common_calloc_s(sizeof(util_mount_table_t));
+    if (table == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+
+    table->data = mount_table_read(fd);
+    if (table->data == NULL) {
+        goto err_out;
+    }
+
+    for (p = table->data; *p != '\0'; p++) {
+        if (*p == '\n') {
+            lines++;
+        }
+    }
+    table->entries = util_smart_calloc_s(sizeof(util_mount_entry_t), lines + 1);
+    if (table->entries == NULL) {
+        ERROR("Out of memory");
+        goto err_out;
+    }
+
+    for (line = strtok_r(table->data, "\n", &saveptr); line != NULL; line = strtok_r(NULL, "\n", &saveptr)) {
+        if (table->len > lines) {
+            break;
+        }
+        if (mount_table_parse_line(line, &table->entries[table->len]) != 0) {
+            INFO("Error reading mountinfo: bad line '%s'", line);
+            continue;
+        }
+        table->len++;
+    }
+
+    if (mount_table_index(table) != 0) {
+        goto err_out;
+    }
+    return table;
+
+err_out:
+    mount_table_free(table);
+    return NULL;
+}
+
+static bool mount_table_changed(int fd)
+{
+    struct pollfd pfd = { 0 };
+    int nret = 0;
+
+    pfd.fd = fd;
+    pfd.events = POLLPRI;
+    do {
+        nret = poll(&pfd, 1, 0);
+    } while (nret < 0 && errno == EINTR);
+
+    // reread on errors, a stale table is worse than a slow one
+    return nret < 0 || (pfd.revents & (POLLPRI | POLLERR)) != 0;
+}
+
+util_mount_table_t *util_mount_table_load(void)
+{
+    util_mount_table_t *table = NULL;
+    int fd = -1;
+
+    fd = util_open(MOUNTINFO_PATH, O_RDONLY, 0);
+    if (fd < 0) {
+        SYSERROR("Failed to open %s", MOUNTINFO_PATH);
+        return NULL;
+    }
+    table = mount_table_build(fd);
+    close(fd);
+
+    return table;
+}
+
+util_mount_table_t *util_mount_table_get(void)
+{
+    util_mount_table_t *table = NULL;
+
+    // a forked child may be in another mount namespace, and must not take the mutex
+    if (g_mount_cache.pid != 0 && g_mount_cache.pid != getpid()) {
+        return util_mount_table_load();
+    }
+
+    (void)pthread_mutex_lock(&g_mount_cache.mutex);
+    if (g_mount_cache.fd < 0) {
+        g_mount_cache.fd = util_open(MOUNTINFO_PATH, O_RDONLY, 0);
+        if (g_mount_cache.fd < 0) {
+            SYSERROR("Failed to open %s", MOUNTINFO_PATH);
+            goto out;
+        }
+        g_mount_cache.pid = getpid();
+    }
+
+    if (g_mount_cache.table == NULL || mount_table_changed(g_mount_cache.fd)) {
+        table = mount_table_build(g_mount_cache.fd);
+        if (table == NULL) {
+            goto out;
+        }
+        table->cached = true;
+        table->refs = 1;
+        if (g_mount_cache.table != NULL && --g_mount_cache.table->refs == 0) {
+            mount_table_free(g_mount_cache.table);
+        }
+        g_mount_cache.table = table;
+    }
+
+    table = g_mount_cache.table;
+    table->refs++;
+
+out:
+    (void)pthread_mutex_unlock(&g_mount_cache.mutex);
+    return table;
+}
+
+void util_mount_table_put(util_mount_table_t *table)
+{
+    bool release = true;
+
+    if (table == NULL) {
+        return;
+    }
+
+    if (table->cached) {
+        (void)pthread_mutex_lock(&g_mount_cache.mutex);
+        release = (--table->refs == 0);
+        (void)pthread_mutex_unlock(&g_mount_cache.mutex);
+    }
+    if (release) {
+        mount_table_free(table);
+    }
+}
+
+size_t util_mount_table_len(const util_mount_table_t *table)
+{
+    return table != NULL ? table->len : 0;
+}
+
+const util_mount_entry_t *util_mount_table_at(const util_mount_table_t *table, size_t index)
+{
+    if (table == NULL || index >= table->len) {
+        return NULL;
+    }
+    return &table->entries[index];
+}
+
+const util_mount_entry_t *util_mount_table_find(const util_mount_table_t *table, const char *mountpoint)
+{
+    if (table == NULL || mountpoint == NULL) {
+        return NULL;
+    }
+    return map_search(table->by_point, (void *)mountpoint);
+}
+
+const util_mount_entry_t *util_mount_table_find_id(const util_mount_table_t *table, int id)
+{
+    if (table == NULL) {
+        return NULL;
+    }
+    return map_search(table->by_id, &id);
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide cached mount table of the process
+ ******************************************************************************/
+#ifndef UTILS_CUTILS_UTILS_MOUNT_TABLE_H
+#define UTILS_CUTILS_UTILS_MOUNT_TABLE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int id;
+    int parent_id;
+    char *root;
+    char *mountpoint;
+    char *opts;
+    // first optional field, NULL if there is none
+    char *optional;
+    char *fstype;
+    char *source;
+    char *vfsopts;
+} util_mount_entry_t;
+
+typedef struct util_mount_table util_mount_table_t;
+
+// Read only snapshot of /proc/self/mountinfo, shared by callers and reread only after the
+// kernel reports a mount, umount or remount. Changes of propagation are not reported by the
+// kernel, use util_mount_table_load to check them. Release it with util_mount_table_put.
+util_mount_table_t *util_mount_table_get(void);
+
+// Snapshot read from /proc/self/mountinfo now, not shared with other callers
+util_mount_table_t *util_mount_table_load(void);
+
+void util_mount_table_put(util_mount_table_t *table);
+
+size_t util_mount_table_len(const util_mount_table_t *table);
+
+const util_mount_entry_t *util_mount_table_at(const util_mount_table_t *table, size_t index);
+
+// first mount on mountpoint in mountinfo order
+const util_mount_entry_t *util_mount_table_find(const util_mount_table_t *table, const char *mountpoint);
+
+const util_mount_entry_t *util_mount_table_find_id(const util_mount_table_t *table, int id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTILS_CUTILS_UTILS_MOUNT_TABLE_H
@@ -0,0 +1,463 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide background deletion of directories through a trash directory
+ ******************************************************************************/
+#define _GNU_SOURCE
+#include "utils_trash.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+
+#include "isula_libutils/log.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_file.h"
+
+/*
+ * Removing a rootfs or layer with many files takes seconds, and used to block the rpc
+ * doing it. The directory is renamed into a trash directory next to it instead, which is
+ * atomic and cheap, and a small pool of background workers deletes the trash with fd based
+ * readdir and unlinkat. While workers are idle, subdirectories of a directory in trash are
+ * moved to the top of the trash as entries of their own, so one big tree is deleted by all
+ * workers. Trash left by a killed daemon is deleted again on next start.
+ */
+#define TRASH_MAX_WORKERS 4
+#define TRASH_DIR_MODE 0700
+
+struct trash_task {
+    // trash directory of the entry
+    char *trash_dir;
+    char *name;
+    struct trash_task *next;
+};
+
+struct trash_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    struct trash_task *head;
+    struct trash_task *tail;
+    size_t workers;
+    size_t idle;
+    // roots whose leftover trash was resumed
+    char **resumed;
+    uint64_t seq;
+};
+
+static struct trash_queue g_trash = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+static void trash_task_free(struct trash_task *task)
+{
+    if (task == NULL) {
+        return;
+    }
+    free(task->trash_dir);
+    free(task->name);
+    free(task);
+}
+
+// unique name in trash for an entry named base
+static int trash_entry_name(const char *base, char *name, size_t len)
+{
+    struct timespec ts = { 0 };
+    uint64_t seq;
+    int nret;
+
+    (void)clock_gettime(CLOCK_REALTIME, &ts);
+    (void)pthread_mutex_lock(&g_trash.mutex);
+    seq = ++g_trash.seq;
+    (void)pthread_mutex_unlock(&g_trash.mutex);
+
+    nret = snprintf(name, len, "%.64s-%lld%09ld-%llu", base, (long long)ts.tv_sec, ts.tv_nsec,
+                    (unsigned long long)seq);
+    if (nret < 0 || (size_t)nret >= len) {
+        ERROR("Failed to make trash name of %s", base);
+        return -1;
+    }
+    return 0;
+}
+
+static int trash_mark_mutable(int dirfd, const char *name)
+{
+    int fd = -1;
+    int attributes = 0;
+    int ret = 0;
+
+    fd = openat(dirfd, name, O_RDONLY | O_NOFOLLOW | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (ioctl(fd, FS_IOC_GETFLAGS, &attributes) < 0) {
+        ret = -1;
+        goto out;
+    }
+    attributes &= ~(FS_IMMUTABLE_FL | FS_APPEND_FL);
+    if (ioctl(fd, FS_IOC_SETFLAGS, &attributes) < 0) {
+        ret = -1;
+    }
+
+out:
+    close(fd);
+    return ret;
+}
+
+static int trash_unlinkat(int dirfd, const char *name, int flags)
+{
+    if (unlinkat(dirfd, name, flags) == 0 || errno == ENOENT) {
+        return 0;
+    }
+    if (errno != EPERM || trash_mark_mutable(dirfd, name) != 0) {
+        return -1;
+    }
+    if (unlinkat(dirfd, name, flags) == 0 || errno == ENOENT) {
+        return 0;
+    }
+    return -1;
+}
+
+static bool trash_has_idle_worker(void)
+{
+    bool idle = false;
+
+    (void)pthread_mutex_lock(&g_trash.mutex);
+    idle = g_trash.idle > 0 && g_trash.head == NULL;
+    (void)pthread_mutex_unlock(&g_trash.mutex);
+    return idle;
+}
+
+static int trash_enqueue(const char *trash_dir, const char *name);
+
+// hand subdirectory name of dirfd to an idle worker, it is moved to the top of the trash so
+// that its parent can be removed without waiting for it
+static bool trash_split(int dirfd, const char *name, const char *trash_dir, int trash_fd)
+{
+    char new_name[NAME_MAX + 1] = { 0 };
+
+    if (trash_fd < 0 || !trash_has_idle_worker()) {
+        return false;
+    }
+    if (trash_entry_name("split", new_name, sizeof(new_name)) != 0) {
+        return false;
+    }
+    if (renameat(dirfd, name, trash_fd, new_name) != 0) {
+        return false;
+    }
+    if (trash_enqueue(trash_dir, new_name) != 0) {
+        // remove it here instead
+        (void)renameat(trash_fd, new_name, dirfd, name);
+        return false;
+    }
+    return true;
+}
+
+static int trash_remove_at(int dirfd, const char *name, int depth, const char *trash_dir, int trash_fd)
+{
+    int fd = -1;
+    DIR *dir = NULL;
+    struct dirent *ent = NULL;
+    int ret = 0;
+
+    if (depth > MAX_PATH_DEPTH) {
+        ERROR("Reach max path depth while deleting %s in %s", name, trash_dir);
+        return -1;
+    }
+
+    fd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) {
+            return 0;
+        }
+        // not a directory any more
+        return trash_unlinkat(dirfd, name, 0);
+    }
+    dir = fdopendir(fd);
+    if (dir == NULL) {
+        close(fd);
+        return -1;
+    }
+
+    for (ent = readdir(dir); ent != NULL; ent = readdir(dir)) {
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
+            continue;
+        }
+        if (ent->d_type == DT_DIR) {
+            if (!trash_split(fd, ent->d_name, trash_dir, trash_fd) &&
+                trash_remove_at(fd, ent->d_name, depth + 1, trash_dir, trash_fd) != 0) {
+                ret = -1;
+            }
+            continue;
+        }
+        if (trash_unlinkat(fd, ent->d_name, 0) == 0) {
+            continue;
+        }
+        // d_type is not filled by all filesystems
+        if ((errno != EISDIR && errno != EPERM) ||
+            trash_remove_at(fd, ent->d_name, depth + 1, trash_dir, trash_fd) != 0) {
+            ret = -1;
+        }
+    }
+    (void)closedir(dir);
+
+    if (trash_unlinkat(dirfd, name, AT_REMOVEDIR) != 0) {
+        ret = -1;
+    }
+    return ret;
+}
+
+static void trash_delete(const struct trash_task *task)
+{
+    int trash_fd = -1;
+    char *path = NULL;
+
+    path = util_path_join(task->trash_dir, task->name);
+    if (path == NULL) {
+        ERROR("Failed to join %s and %s", task->trash_dir, task->name);
+        return;
+    }
+
+    trash_fd = open(task->trash_dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (trash_fd >= 0 && trash_remove_at(trash_fd, task->name, 0, task->trash_dir, trash_fd) == 0) {
+        DEBUG("Deleted %s", path);
+        goto out;
+    }
+
+    WARN("Failed to delete %s in background: %s, try again in place", path, strerror(errno));
+    if (util_recursive_rmdir(path, 0) != 0) {
+        ERROR("Failed to delete %s", path);
+    }
+
+out:
+    if (trash_fd >= 0) {
+        close(trash_fd);
+    }
+    free(path);
+}
+
+static void *trash_worker(void *arg)
+{
+    struct trash_task *task = NULL;
+
+    (void)arg;
+    (void)pthread_detach(pthread_self());
+    (void)prctl(PR_SET_NAME, "trash");
+
+    (void)pthread_mutex_lock(&g_trash.mutex);
+    for (;;) {
+        while (g_trash.head == NULL) {
+            g_trash.idle++;
+            (void)pthread_cond_wait(&g_trash.cond, &g_trash.mutex);
+            g_trash.idle--;
+        }
+        task = g_trash.head;
+        g_trash.head = task->next;
+        if (g_trash.head == NULL) {
+            g_trash.tail = NULL;
+        }
+        (void)pthread_mutex_unlock(&g_trash.mutex);
+
+        trash_delete(task);
+        trash_task_free(task);
+
+        (void)pthread_mutex_lock(&g_trash.mutex);
+    }
+
+    return NULL;
+}
+
+static int trash_enqueue(const char *trash_dir, const char *name)
+{
+    struct trash_task *task = NULL;
+    pthread_t tid;
+    int ret = 0;
+
+    task = util_common_calloc_s(sizeof(struct trash_task));
+    if (task == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    task->trash_dir = util_strdup_s(trash_dir);
+    task->name = util_strdup_s(name);
+
+    (void)pthread_mutex_lock(&g_trash.mutex);
+    if (g_trash.idle == 0 && g_trash.workers < TRASH_MAX_WORKERS) {
+        if (pthread_create(&tid, NULL, trash_worker, NULL) == 0) {
+            g_trash.workers++;
+        } else if (g_trash.workers == 0) {
+            ERROR("Failed to start trash worker");
+            ret = -1;
+            goto unlock;
+        }
+    }
+    if (g_trash.tail == NULL) {
+        g_trash.head = task;
+    } else {
+        g_trash.tail->next = task;
+    }
+    g_trash.tail = task;
+    task = NULL;
+    (void)pthread_cond_signal(&g_trash.cond);
+
+unlock:
+    (void)pthread_mutex_unlock(&g_trash.mutex);
+    trash_task_free(task);
+    return ret;
+}
+
+static char *trash_dir_of(const char *root)
+{
+    char *trash_dir = NULL;
+
+    trash_dir = util_path_join(root, TRASH_DIR_NAME);
+    if (trash_dir == NULL) {
+        ERROR("Failed to join trash directory of %s", root);
+        return NULL;
+    }
+    if (mkdir(trash_dir, TRASH_DIR_MODE) != 0 && errno != EEXIST) {
+        SYSERROR("Failed to create trash directory %s", trash_dir);
+        free(trash_dir);
+        return NULL;
+    }
+    return trash_dir;
+}
+
+int util_trash_path(const char *root, const char *path)
+{
+    struct stat st;
+    char *trash_dir = NULL;
+    char *base = NULL;
+    char name[NAME_MAX + 1] = { 0 };
+    char target[PATH_MAX] = { 0 };
+    int nret;
+
+    if (path == NULL) {
+        return -1;
+    }
+
+    if (root == NULL || lstat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        // nothing to move, keep the behavior of util_recursive_rmdir
+        return util_recursive_rmdir(path, 0);
+    }
+
+    trash_dir = trash_dir_of(root);
+    if (trash_dir == NULL) {
+        goto in_place;
+    }
+    base = util_path_base(path);
+    if (base == NULL || trash_entry_name(base, name, sizeof(name)) != 0) {
+        goto in_place;
+    }
+    nret = snprintf(target, sizeof(target), "%s/%s", trash_dir, name);
+    if (nret < 0 || (size_t)nret >= sizeof(target)) {
+        ERROR("Trash path of %s is too long", path);
+        goto in_place;
+    }
+
+    // fails with EXDEV if root is on another filesystem
+    if (rename(path, target) != 0) {
+        WARN("Failed to move %s to trash: %s, delete it in place", path, strerror(errno));
+        goto in_place;
+    }
+    if (trash_enqueue(trash_dir, name) != 0) {
+        // already renamed, delete it from trash in place
+        nret = util_recursive_rmdir(target, 0);
+        goto out;
+    }
+
+    DEBUG("Moved %s to trash %s", path, target);
+    nret = 0;
+    goto out;
+
+in_place:
+    nret = util_recursive_rmdir(path, 0);
+
+out:
+    free(trash_dir);
+    free(base);
+    return nret;
+}
+
+static bool trash_mark_resumed(const char *root)
+{
+    bool resumed = false;
+    size_t i;
+
+    (void)pthread_mutex_lock(&g_trash.mutex);
+    for (i = 0; g_trash.resumed != NULL && g_trash.resumed[i] != NULL; i++) {
+        if (strcmp(g_trash.resumed[i], root) == 0) {
+            resumed = true;
+            goto unlock;
+        }
+    }
+    if (util_array_append(&g_trash.resumed, root) != 0) {
+        ERROR("Out of memory");
+    }
+
+unlock:
+    (void)pthread_mutex_unlock(&g_trash.mutex);
+    return resumed;
+}
+
+int util_trash_resume(const char *root)
+{
+    char *trash_dir = NULL;
+    char **entries = NULL;
+    size_t i;
+    int ret = 0;
+
+    if (root == NULL) {
+        return -1;
+    }
+
+    // several owners share the trash of one root
+    if (trash_mark_resumed(root)) {
+        return 0;
+    }
+
+    trash_dir = trash_dir_of(root);
+    if (trash_dir == NULL) {
+        return -1;
+    }
+
+    if (util_list_all_entries(trash_dir, &entries) != 0) {
+        ERROR("Failed to list trash directory %s", trash_dir);
+        ret = -1;
+        goto out;
+    }
+    for (i = 0; entries != NULL && entries[i] != NULL; i++) {
+        INFO("Delete %s left in trash %s", entries[i], trash_dir);
+        if (trash_enqueue(trash_dir, entries[i]) != 0) {
+            ret = -1;
+        }
+    }
+
+out:
+    util_free_array(entries);
+    free(trash_dir);
+    return ret;
+}
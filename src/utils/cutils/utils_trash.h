@@ -0,0 +1,39 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide background deletion of directories through a trash directory
+ ******************************************************************************/
+#ifndef UTILS_CUTILS_UTILS_TRASH_H
+#define UTILS_CUTILS_UTILS_TRASH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRASH_DIR_NAME ".trash"
+
+/*
+ * Move directory path into the trash directory of root and delete it in background.
+ * root should be on the same filesystem as path and must not be scanned by its owner,
+ * path is removed in place if it can not be moved or root is NULL. Same return value as
+ * util_recursive_rmdir.
+ */
+int util_trash_path(const char *root, const char *path);
+
+/* Delete in background what is left in the trash directory of root, e.g. by a killed daemon */
+int util_trash_resume(const char *root);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UTILS_CUTILS_UTILS_TRASH_H
@@ -14,6 +14,7 @@
  ******************************************************************************/
 #include "http.h"
 #include <curl/curl.h>
+#include <pthread.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <string.h>
@@ -90,8 +91,31 @@ void http_global_init(void)
     curl_global_init(CURL_GLOBAL_ALL);
 }
 
+/*
+ * persistent connections to authz plugin, created once and kept until exit, so requests never
+ * race with its release. Decisions made before authz_http_invalidate() are of older generations.
+ */
+static http_conn_t *g_authz_conn = NULL;
+static pthread_once_t g_authz_conn_once = PTHREAD_ONCE_INIT;
+static uint64_t g_authz_generation = 0;
+
+static void authz_conn_init(void)
+{
+    g_authz_conn = http_conn_new(AUTHZ_UNIX_SOCK);
+    if (g_authz_conn == NULL) {
+        ERROR("Failed to create connection to authz plugin");
+    }
+}
+
+static http_conn_t *authz_conn(void)
+{
+    (void)pthread_once(&g_authz_conn_once, authz_conn_init);
+    return g_authz_conn;
+}
+
 void http_global_cleanup(void)
 {
+    http_conn_reset(g_authz_conn);
     curl_global_cleanup();
 }
 
@@ -500,7 +524,6 @@ int authz_http_request(const char *username, const char *action, char **resp)
     int ret = 0;
     int nret = 0;
     size_t length = 0;
-    struct http_get_options *options = NULL;
     if (strlen(username) > ((SIZE_MAX - strlen(action)) - strlen(":")) - 1) {
         ERROR("Invalid arguments");
         return -1;
@@ -518,21 +541,9 @@ int authz_http_request(const char *username, const char *action, char **resp)
         free(request_body);
         return -1;
     }
-    options = util_common_calloc_s(sizeof(struct http_get_options));
-    if (options == NULL) {
-        ERROR("Failed to malloc http_get_options");
-        *resp = util_strdup_s("Inernal server error: Out of memory");
-        free(request_body);
-        return -1;
-    }
-
-    options->with_head = 1;
-    options->with_header_json = 1;
-    options->input = request_body;
-    options->input_len = strlen(request_body);
-    options->unix_socket_path = util_strdup_s(AUTHZ_UNIX_SOCK);
 
-    ret = http_request(AUTHZ_REQUEST_URL, options, &response_code, 0);
+    ret = http_conn_post(authz_conn(), AUTHZ_REQUEST_URL, request_body, strlen(request_body),
+                         AUTHZ_REQUEST_TIMEOUT_MS, NULL, &response_code);
     if (ret != 0) {
         ERROR("Failed to request authz plugin. Is server running ?");
         *resp = util_strdup_s("Failed to request authz plugin. Is server running ?");
@@ -540,7 +551,7 @@ int authz_http_request(const char *username, const char *action, char **resp)
         goto out;
     }
     if (response_code != StatusOK) {
-        ret = -1;
+        ret = AUTHZ_RES_DENIED;
         nret = snprintf(err_msg, sizeof(err_msg), "action '%s' for user '%s': permission denied", action, username);
         if (nret < 0 || (size_t)nret >= sizeof(err_msg)) {
             ERROR("Out of memory");
@@ -553,9 +564,216 @@ int authz_http_request(const char *username, const char *action, char **resp)
 
 out:
     free(request_body);
-    if (options != NULL) {
-        free(options->unix_socket_path);
-        free(options);
+    return ret;
+}
+
+uint64_t authz_http_generation(void)
+{
+    /* read for each cached decision, so it does not take the global lock of util_atomic */
+    return __atomic_load_n(&g_authz_generation, __ATOMIC_ACQUIRE);
+}
+
+void authz_http_invalidate(void)
+{
+    (void)__atomic_add_fetch(&g_authz_generation, 1, __ATOMIC_ACQ_REL);
+    http_conn_reset(authz_conn());
+}
+
+/* idle handles kept by a connection, requests beyond them at the same time use short-lived handles */
+#define HTTP_CONN_MAX_IDLE 8
+
+struct http_conn {
+    pthread_mutex_t mutex;
+    char *unix_socket_path;
+    /* idle handles, each one keeps its own connection alive, protected by mutex */
+    CURL *idle[HTTP_CONN_MAX_IDLE];
+    size_t idle_len;
+};
+
+http_conn_t *http_conn_new(const char *unix_socket_path)
+{
+    http_conn_t *conn = NULL;
+
+    if (unix_socket_path == NULL) {
+        return NULL;
     }
+
+    conn = util_common_calloc_s(sizeof(http_conn_t));
+    if (conn == NULL) {
+        ERROR("Out of memory");
+        return NULL;
+    }
+    if (pthread_mutex_init(&conn->mutex, NULL) != 0) {
+        ERROR("Failed to init http connection mutex");
+        free(conn);
+        return NULL;
+    }
+    conn->unix_socket_path = util_strdup_s(unix_socket_path);
+
+    return conn;
+}
+
+/* take an idle handle of conn, or a new one if all of them are busy */
+static CURL *http_conn_get_handle(http_conn_t *conn)
+{
+    CURL *curl_handle = NULL;
+
+    if (pthread_mutex_lock(&conn->mutex) != 0) {
+        ERROR("Failed to lock http connection");
+        return NULL;
+    }
+    if (conn->idle_len > 0) {
+        conn->idle_len--;
+        curl_handle = conn->idle[conn->idle_len];
+        conn->idle[conn->idle_len] = NULL;
+    }
+    if (pthread_mutex_unlock(&conn->mutex) != 0) {
+        ERROR("Failed to unlock http connection");
+    }
+
+    if (curl_handle != NULL) {
+        /* reset options only, live connections and caches of the handle are kept */
+        curl_easy_reset(curl_handle);
+        return curl_handle;
+    }
+    curl_handle = curl_easy_init();
+    if (curl_handle == NULL) {
+        ERROR("Failed to init curl handle of %s", conn->unix_socket_path);
+    }
+    return curl_handle;
+}
+
+/* keep the handle with its connection for later requests, unless enough handles are idle */
+static void http_conn_put_handle(http_conn_t *conn, CURL *curl_handle)
+{
+    if (pthread_mutex_lock(&conn->mutex) != 0) {
+        ERROR("Failed to lock http connection");
+        curl_easy_cleanup(curl_handle);
+        return;
+    }
+    if (conn->idle_len < HTTP_CONN_MAX_IDLE) {
+        conn->idle[conn->idle_len++] = curl_handle;
+        curl_handle = NULL;
+    }
+    if (pthread_mutex_unlock(&conn->mutex) != 0) {
+        ERROR("Failed to unlock http connection");
+    }
+    if (curl_handle != NULL) {
+        curl_easy_cleanup(curl_handle);
+    }
+}
+
+static int http_conn_perform(const http_conn_t *conn, CURL *curl_handle, const char *url, const char *body,
+                             size_t body_len, long timeout_ms, struct Buffer *output, long *response_code)
+{
+    int ret = 0;
+    CURLcode curl_result = CURLE_OK;
+    struct curl_slist *chunk = NULL;
+    char errbuf[CURL_ERROR_SIZE] = { 0 };
+
+    chunk = curl_slist_append(chunk, "Content-Type: application/json");
+    // Disable "Expect: 100-continue"
+    chunk = curl_slist_append(chunk, "Expect:");
+    if (chunk == NULL) {
+        ERROR("Failed to set request header");
+        return -1;
+    }
+
+    curl_easy_setopt(curl_handle, CURLOPT_URL, url);
+    curl_easy_setopt(curl_handle, CURLOPT_UNIX_SOCKET_PATH, conn->unix_socket_path);
+    curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT_MS, timeout_ms);
+    curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, errbuf);
+    curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, chunk);
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, body);
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDSIZE, (long)body_len);
+    curl_easy_setopt(curl_handle, CURLOPT_POST, 1L);
+    if (output != NULL) {
+        curl_easy_setopt(curl_handle, CURLOPT_HEADER, 1L);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, output);
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, fwrite_buffer);
+    } else {
+        /* only response code matters, drop the body */
+        curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, fwrite_null);
+    }
+
+    curl_result = curl_easy_perform(curl_handle);
+    if (curl_result != CURLE_OK) {
+        ERROR("curl response error code %d, error message: %s", curl_result,
+              strlen(errbuf) != 0 ? errbuf : curl_easy_strerror(curl_result));
+        ret = -1;
+    } else if (response_code != NULL) {
+        curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, response_code);
+    }
+
+    /* do not leave pointers to stack and freed memory in the kept handle */
+    curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, NULL);
+    curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, NULL);
+    curl_easy_setopt(curl_handle, CURLOPT_POSTFIELDS, NULL);
+    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, NULL);
+    curl_slist_free_all(chunk);
     return ret;
 }
+
+int http_conn_post(http_conn_t *conn, const char *url, const char *body, size_t body_len, long timeout_ms,
+                   struct Buffer *output, long *response_code)
+{
+    int ret = 0;
+    CURL *curl_handle = NULL;
+
+    if (conn == NULL || url == NULL || body == NULL || timeout_ms <= 0) {
+        ERROR("Invalid parameter");
+        return -1;
+    }
+
+    curl_handle = http_conn_get_handle(conn);
+    if (curl_handle == NULL) {
+        return -1;
+    }
+    ret = http_conn_perform(conn, curl_handle, url, body, body_len, timeout_ms, output, response_code);
+    if (ret != 0) {
+        /* drop the handle, the server may have been restarted, reconnect next time */
+        curl_easy_cleanup(curl_handle);
+        return ret;
+    }
+    http_conn_put_handle(conn, curl_handle);
+
+    return 0;
+}
+
+void http_conn_reset(http_conn_t *conn)
+{
+    size_t i;
+
+    if (conn == NULL) {
+        return;
+    }
+
+    if (pthread_mutex_lock(&conn->mutex) != 0) {
+        ERROR("Failed to lock http connection");
+        return;
+    }
+    for (i = 0; i < conn->idle_len; i++) {
+        curl_easy_cleanup(conn->idle[i]);
+        conn->idle[i] = NULL;
+    }
+    conn->idle_len = 0;
+    if (pthread_mutex_unlock(&conn->mutex) != 0) {
+        ERROR("Failed to unlock http connection");
+    }
+}
+
+void http_conn_free(http_conn_t *conn)
+{
+    if (conn == NULL) {
+        return;
+    }
+
+    http_conn_reset(conn);
+    (void)pthread_mutex_destroy(&conn->mutex);
+    free(conn->unix_socket_path);
+    free(conn);
+}
@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,6 +98,12 @@ struct http_get_options {
 /* authz unix sock and request url */
 #define AUTHZ_UNIX_SOCK             "/run/isulad/plugins/authz-broker.sock"
 #define AUTHZ_REQUEST_URL           "http://localhost/isulad.auth"
+#define AUTHZ_PLUGIN_NAME           "authz-broker"
+#define AUTHZ_REQUEST_TIMEOUT_MS    (30 * 1000)
+
+/* authz_http_request() result, any other non-zero value means the plugin could not be asked */
+#define AUTHZ_RES_ALLOWED           0
+#define AUTHZ_RES_DENIED            1
 
 /* http response code */
 enum http_response_code {
@@ -171,8 +178,45 @@ void free_http_get_options(struct http_get_options *options);
 int http_request(const char *url, struct http_get_options *options,
                  long *response_code, int recursive_len);
 
+/*
+ * Ask authz plugin whether user can perform action, return AUTHZ_RES_ALLOWED if allowed,
+ * AUTHZ_RES_DENIED if denied and -1 on failure. The connections to plugin are kept alive
+ * between requests and released by http_global_cleanup().
+ */
 int authz_http_request(const char *username, const char *action, char **resp);
 
+/*
+ * Decisions of authz plugin are only valid in the generation they were asked in, callers
+ * caching them take the generation before asking. authz_http_invalidate() starts a new
+ * generation and drops the kept connections, e.g. when the plugin is restarted.
+ */
+uint64_t authz_http_generation(void);
+
+void authz_http_invalidate(void);
+
+/*
+ * Persistent connections to a server on unix socket, curl keeps them alive between
+ * requests. Requests at the same time are sent on different connections.
+ */
+typedef struct http_conn http_conn_t;
+
+struct Buffer;
+
+http_conn_t *http_conn_new(const char *unix_socket_path);
+
+/*
+ * POST json body to url, the response with its head is appended to output, or dropped if
+ * output is NULL, and its status code is stored in response_code if not NULL. Fails if the
+ * response is not received in timeout_ms, the connection is dropped on failure.
+ */
+int http_conn_post(http_conn_t *conn, const char *url, const char *body, size_t body_len, long timeout_ms,
+                   struct Buffer *output, long *response_code);
+
+/* close the kept connections, later requests connect again */
+void http_conn_reset(http_conn_t *conn);
+
+void http_conn_free(http_conn_t *conn);
+
 void http_global_init(void);
 
 void http_global_cleanup(void);
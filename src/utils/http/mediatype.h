@@ -57,6 +57,15 @@
 // restrictions.
 #define MediaTypeImageLayerNonDistributableGzip "application/vnd.oci.image.layer.nondistributable.v1.tar+gzip"
 
+// MediaTypeImageLayerZstd is the media type used for zstd compressed
+// layers referenced by the manifest.
+#define MediaTypeImageLayerZstd "application/vnd.oci.image.layer.v1.tar+zstd"
+
+// MediaTypeImageLayerNonDistributableZstd is the media type for zstd
+// compressed layers referenced by the manifest but with distribution
+// restrictions.
+#define MediaTypeImageLayerNonDistributableZstd "application/vnd.oci.image.layer.nondistributable.v1.tar+zstd"
+
 // MediaTypeImageConfig specifies the media type for the image configuration.
 #define MediaTypeImageConfig "application/vnd.oci.image.config.v1+json"
 
@@ -85,6 +94,8 @@
 #define OCI_IMAGE_LAYER_TAR_GZIP "application/vnd.oci.image.layer.v1.tar+gzip"
 #define OCI_IMAGE_LAYER_ND_TAR "application/vnd.oci.image.layer.nondistributable.v1.tar"
 #define OCI_IMAGE_LAYER_ND_TAR_GZIP "application/vnd.oci.image.layer.nondistributable.v1.tar+gzip"
+#define OCI_IMAGE_LAYER_TAR_ZSTD "application/vnd.oci.image.layer.v1.tar+zstd"
+#define OCI_IMAGE_LAYER_ND_TAR_ZSTD "application/vnd.oci.image.layer.nondistributable.v1.tar+zstd"
 
 #endif
 
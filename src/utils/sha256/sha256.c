@@ -265,6 +265,47 @@ char *sha256_full_file_digest(const char *filename)
     return full_digest;
 }
 
+static ssize_t sha256_stream_write(void *context, const void *data, size_t len)
+{
+    if (SHA256_Update((SHA256_CTX *)context, data, len) != 1) {
+        return -1;
+    }
+    return (ssize_t)len;
+}
+
+char *sha256_full_stream_digest(sha256_stream_func_t func, void *arg)
+{
+    SHA256_CTX ctx;
+    unsigned char hash[SHA256_DIGEST_LENGTH] = { 0x00 };
+    char output_buffer[(SHA256_DIGEST_LENGTH * 2) + 1] = { 0x00 };
+    struct io_write_wrapper writer = { 0 };
+    int i = 0;
+
+    if (func == NULL) {
+        ERROR("invalid NULL param");
+        return NULL;
+    }
+
+    SHA256_Init(&ctx);
+    writer.context = &ctx;
+    writer.write_func = sha256_stream_write;
+    if (func(&writer, arg) != 0) {
+        ERROR("Failed to read data to digest");
+        return NULL;
+    }
+    SHA256_Final(hash, &ctx);
+
+    for (i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        int sret = snprintf(output_buffer + (i * 2), 3, "%02x", (unsigned int)hash[i]);
+        if (sret >= 3 || sret < 0) {
+            return NULL;
+        }
+    }
+    output_buffer[SHA256_DIGEST_LENGTH * 2] = '\0';
+
+    return util_full_digest(output_buffer);
+}
+
 bool sha256_valid_digest_file(const char *path, const char *digest)
 {
     char *file_digest = NULL;
@@ -20,6 +20,8 @@
 #include <stdio.h>
 #include <zlib.h>
 
+#include "io_wrapper.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -32,6 +34,10 @@ char *sha256_full_gzip_digest(const char *filename);
 
 char *sha256_full_file_digest(const char *filename);
 
+// func writes the data to digest into writer, e.g. a layer decompressed by a codec zlib lacks
+typedef int (*sha256_stream_func_t)(const struct io_write_wrapper *writer, void *arg);
+char *sha256_full_stream_digest(sha256_stream_func_t func, void *arg);
+
 bool sha256_valid_digest_file(const char *path, const char *digest);
 
 char *sha256_full_digest_str(char *str);
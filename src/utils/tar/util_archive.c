@@ -27,6 +27,14 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <libgen.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <endian.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <dirent.h>
 
 #include "stdbool.h"
 #include "utils.h"
@@ -36,12 +44,14 @@
 #include "map.h"
 #include "path.h"
 #include "error.h"
+#include "util_gzip.h"
 
 struct archive;
 struct archive_entry;
 
-#define ARCHIVE_READ_BUFFER_SIZE (10 * 1024)
+#define ARCHIVE_READ_BUFFER_SIZE (128 * 1024)
 #define ARCHIVE_WRITE_BUFFER_SIZE (10 * 1024)
+#define DECOMPRESS_PIPE_SIZE (1024 * 1024)
 #define TAR_DEFAULT_MODE 0600
 #define TAR_DEFAULT_FLAG (O_WRONLY | O_CREAT | O_TRUNC)
 
@@ -61,16 +71,93 @@ struct archive_content_data {
     char buff[ARCHIVE_READ_BUFFER_SIZE];
 };
 
+/*
+ * Compressed content is decompressed on a thread of its own and handed to libarchive as a
+ * plain tar through a pipe, so inflating the next blocks overlaps with writing files, and
+ * formats libarchive was built without are decoded by our own codecs.
+ */
+struct decompress_stage {
+    const struct io_read_wrapper *content;
+    int pipefd[2];
+    pthread_t tid;
+    bool started;
+    int ret;
+};
+
 ssize_t read_content(struct archive *a, void *client_data, const void **buff)
 {
     struct archive_content_data *mydata = client_data;
 
-    memset(mydata->buff, 0, sizeof(mydata->buff));
-
     *buff = mydata->buff;
 
     return mydata->content->read(mydata->content->context, mydata->buff, sizeof(mydata->buff));
 }
+static ssize_t stage_pipe_read(void *context, void *buf, size_t len)
+{
+    return util_read_nointr(*(int *)context, buf, len);
+}
+
+static ssize_t stage_pipe_write(void *context, const void *data, size_t len)
+{
+    return util_write_nointr_in_total(*(int *)context, data, len);
+}
+
+static void *decompress_stage_routine(void *arg)
+{
+    struct decompress_stage *stage = (struct decompress_stage *)arg;
+    struct io_write_wrapper writer = { 0 };
+
+    writer.context = &stage->pipefd[1];
+    writer.write_func = stage_pipe_write;
+    stage->ret = util_decompress_stream(stage->content, &writer);
+    // EOF of the pipe tells libarchive the stream ends here
+    close(stage->pipefd[1]);
+    stage->pipefd[1] = -1;
+    return NULL;
+}
+
+static int decompress_stage_start(struct decompress_stage *stage, const struct io_read_wrapper *content,
+                                  struct io_read_wrapper *staged)
+{
+    stage->content = content;
+    if (pipe2(stage->pipefd, O_CLOEXEC) != 0) {
+        SYSERROR("Failed to create decompress pipe");
+        return -1;
+    }
+    (void)fcntl(stage->pipefd[0], F_SETPIPE_SZ, DECOMPRESS_PIPE_SIZE);
+
+    if (pthread_create(&stage->tid, NULL, decompress_stage_routine, stage) != 0) {
+        ERROR("Failed to start decompress thread");
+        close(stage->pipefd[0]);
+        close(stage->pipefd[1]);
+        stage->pipefd[0] = -1;
+        stage->pipefd[1] = -1;
+        return -1;
+    }
+    stage->started = true;
+
+    staged->context = &stage->pipefd[0];
+    staged->read = stage_pipe_read;
+    return 0;
+}
+
+static int decompress_stage_finish(struct decompress_stage *stage, bool drain, char *buf, size_t len)
+{
+    if (!stage->started) {
+        return 0;
+    }
+    // padding after the end of the tar is never read by libarchive, consume it so the
+    // decompress thread can finish. On failure the read end is closed and the thread gets
+    // EPIPE, SIGPIPE is ignored by the daemon and the setting is inherited here.
+    while (drain && util_read_nointr(stage->pipefd[0], buf, len) > 0) {
+    }
+    close(stage->pipefd[0]);
+    stage->pipefd[0] = -1;
+    (void)pthread_join(stage->tid, NULL);
+    stage->started = false;
+    return stage->ret;
+}
+
 // 标记
 static bool overlay_whiteout_convert_read(struct archive_entry *entry, const char *dst_path, map_t *unpacked_path_map)
 {
@@ -428,7 +515,9 @@ int archive_unpack_handler(const struct io_read_wrapper *content, const struct a
     int flags;
     whiteout_convert_call_back_t wh_handle_cb = NULL;
     map_t *unpacked_path_map = NULL; // used for hanling opaque dir, marke paths had been unpacked
-    
+    struct decompress_stage stage = { .pipefd = { -1, -1 } };
+    struct io_read_wrapper staged_content = { 0 };
+
     unpacked_path_map = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
     if (unpacked_path_map == NULL) {
         ERROR("Out of memory");
@@ -445,6 +534,11 @@ int archive_unpack_handler(const struct io_read_wrapper *content, const struct a
         goto out;
     }
     mydata->content = content;
+    if (decompress_stage_start(&stage, content, &staged_content) == 0) {
+        mydata->content = &staged_content;
+    } else {
+        WARN("Decompress content in line with unpacking");
+    }
 
     flags = ARCHIVE_EXTRACT_TIME;
     flags |= ARCHIVE_EXTRACT_OWNER;
@@ -562,6 +656,12 @@ int archive_unpack_handler(const struct io_read_wrapper *content, const struct a
     ret = 0;
 
 out:
+    if (mydata != NULL && decompress_stage_finish(&stage, ret == 0, mydata->buff, sizeof(mydata->buff)) != 0 &&
+        ret == 0) {
+        ERROR("Failed to decompress archive content");
+        fprintf(stderr, "Failed to decompress archive content");
+        ret = -1;
+    }
     map_free(unpacked_path_map);
     free(dst_path);
     archive_read_close(a);
@@ -572,98 +672,1502 @@ out:
     return ret;
 }
 
-static void close_archive_pipes_fd(int *pipes, size_t pipe_size)
+/*
+ * Layers are unpacked in the daemon process instead of a forked child chrooted into the
+ * destination. Every directory is resolved with openat2(RESOLVE_IN_ROOT | RESOLVE_NO_SYMLINKS)
+ * below the destination, which confines the entries as the chroot did and refuses to extract
+ * through symlinks as ARCHIVE_EXTRACT_SECURE_SYMLINKS does, all other operations are relative
+ * to the resolved directory fd. The main thread walks the archive in order and creates every
+ * inode, so whiteouts, replaced paths and hardlinks keep the order of the archive, and the
+ * bodies and metadata of small regular files are written by a pool of workers through the fds
+ * the main thread opened. Directory modes and times are applied at the end like libarchive
+ * does, after all their children are created.
+ */
+#ifndef __NR_openat2
+#define __NR_openat2 437
+#endif
+#define UNPACK_RESOLVE_NO_SYMLINKS 0x04
+#define UNPACK_RESOLVE_IN_ROOT 0x10
+#define UNPACK_OPENAT2_RETRIES 16
+
+#define UNPACK_DIR_FLAGS (O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+#define UNPACK_MAX_WORKERS 4
+// bodies of regular files up to this size are buffered and written by the workers
+#define UNPACK_BUFFERED_FILE_MAX (1024 * 1024)
+// bound of the memory held by buffered bodies not yet written
+#define UNPACK_MAX_PENDING_BYTES (64 * 1024 * 1024)
+
+#define UNPACK_ACL_XATTR_VERSION 2
+#define UNPACK_ACL_USER_OBJ 0x01
+#define UNPACK_ACL_USER 0x02
+#define UNPACK_ACL_GROUP_OBJ 0x04
+#define UNPACK_ACL_GROUP 0x08
+#define UNPACK_ACL_MASK 0x10
+#define UNPACK_ACL_OTHER 0x20
+#define UNPACK_ACL_UNDEFINED_ID ((uint32_t)-1)
+
+// struct open_how of linux/openat2.h, which is missing in older kernel headers
+struct unpack_open_how {
+    uint64_t flags;
+    uint64_t mode;
+    uint64_t resolve;
+};
+
+struct unpack_error {
+    pthread_mutex_t mutex;
+    bool set;
+    char msg[BUFSIZ];
+};
+
+struct unpack_xattr {
+    char *name;
+    void *value;
+    size_t size;
+};
+
+struct unpack_meta {
+    uid_t uid;
+    gid_t gid;
+    mode_t mode;
+    struct timespec times[2];
+    struct unpack_xattr *xattrs;
+    size_t xattrs_len;
+    // inode flags of FS_IOC_SETFLAGS, libarchive reports them so on linux
+    unsigned long fflags;
+};
+
+struct unpack_file_job {
+    int fd;
+    char *path;
+    char *data;
+    size_t len;
+    struct unpack_meta meta;
+    struct unpack_file_job *next;
+};
+
+struct unpack_pool {
+    pthread_mutex_t mutex;
+    pthread_cond_t job_cond;
+    pthread_cond_t done_cond;
+    struct unpack_file_job *head;
+    struct unpack_file_job *tail;
+    size_t pending_jobs;
+    size_t pending_bytes;
+    bool stop;
+    size_t nthreads;
+    pthread_t tids[UNPACK_MAX_WORKERS];
+    struct unpack_error *err;
+};
+
+struct unpack_dir_fixup {
+    char *path;
+    struct unpack_meta meta;
+    struct unpack_dir_fixup *next;
+};
+
+struct unpack_context {
+    int root_fd;
+    const char *dstdir;
+    // relative path of the directory parent_fd refers to, entries of a directory are
+    // usually stored together, so it is resolved once for all of them
+    char *parent_path;
+    int parent_fd;
+    struct unpack_dir_fixup *fixups;
+    struct unpack_dir_fixup *fixups_tail;
+    struct unpack_pool pool;
+    struct unpack_error err;
+};
+
+static void unpack_set_error(struct unpack_error *uerr, const char *fmt, ...)
 {
-    size_t i = 0;
+    char msg[BUFSIZ] = { 0 };
+    va_list args;
 
-    for (i = 0; i < pipe_size; i++) {
-        if (pipes[i] >= 0) {
-            close(pipes[i]);
-            pipes[i] = -1;
+    va_start(args, fmt);
+    (void)vsnprintf(msg, sizeof(msg), fmt, args);
+    va_end(args);
+
+    ERROR("%s", msg);
+    (void)pthread_mutex_lock(&uerr->mutex);
+    if (!uerr->set) {
+        (void)memcpy(uerr->msg, msg, sizeof(uerr->msg));
+        uerr->set = true;
+    }
+    (void)pthread_mutex_unlock(&uerr->mutex);
+}
+
+static bool unpack_has_error(struct unpack_error *uerr)
+{
+    bool set = false;
+
+    (void)pthread_mutex_lock(&uerr->mutex);
+    set = uerr->set;
+    (void)pthread_mutex_unlock(&uerr->mutex);
+    return set;
+}
+
+static int unpack_openat2(int dirfd, const char *path, int flags)
+{
+    struct unpack_open_how how = { 0 };
+    int retries = UNPACK_OPENAT2_RETRIES;
+    long fd;
+
+    how.flags = (uint64_t)(unsigned int)flags;
+    how.resolve = UNPACK_RESOLVE_IN_ROOT | UNPACK_RESOLVE_NO_SYMLINKS;
+    do {
+        fd = syscall(__NR_openat2, dirfd, path, &how, sizeof(how));
+    } while (fd < 0 && (errno == EINTR || errno == EAGAIN) && retries-- > 0);
+
+    return (int)fd;
+}
+
+// "./a//b/" to "a/b", the root is "", paths with ".." are refused like
+// ARCHIVE_EXTRACT_SECURE_NODOTDOT does
+static char *unpack_clean_path(const char *path)
+{
+    char *copy = NULL;
+    char *result = NULL;
+    char *comp = NULL;
+    char *saveptr = NULL;
+
+    copy = util_strdup_s(path);
+    result = util_common_calloc_s(strlen(path) + 1);
+    if (result == NULL) {
+        ERROR("Out of memory");
+        goto out;
+    }
+
+    for (comp = strtok_r(copy, "/", &saveptr); comp != NULL; comp = strtok_r(NULL, "/", &saveptr)) {
+        if (strcmp(comp, ".") == 0) {
+            continue;
+        }
+        if (strcmp(comp, "..") == 0) {
+            free(result);
+            result = NULL;
+            goto out;
         }
+        if (result[0] != '\0') {
+            (void)strcat(result, "/");
+        }
+        (void)strcat(result, comp);
     }
+
+out:
+    free(copy);
+    return result;
 }
 
-int archive_unpack(const struct io_read_wrapper *content, const char *dstdir, const struct archive_options *options,
-                   char **errmsg)
+// open directory path below the root, missing directories are created on the way and
+// non directories in the way are replaced as libarchive does
+static int unpack_open_dir(struct unpack_context *ctx, const char *path, bool create)
 {
-    int ret = 0;
-    pid_t pid = -1;
-    int keepfds[] = { -1, -1, -1 };
-    int pipe_stderr[2] = { -1, -1 };
-    char errbuf[BUFSIZ] = { 0 };
+    int fd = -1;
+    int dirfd = -1;
+    char *copy = NULL;
+    char *comp = NULL;
+    char *saveptr = NULL;
 
-    if (pipe2(pipe_stderr, O_CLOEXEC) != 0) {
-        ERROR("Failed to create pipe");
-        ret = -1;
-        goto cleanup;
+    fd = unpack_openat2(ctx->root_fd, path[0] != '\0' ? path : ".", UNPACK_DIR_FLAGS);
+    if (fd >= 0 || !create || (errno != ENOENT && errno != ENOTDIR)) {
+        return fd;
     }
-    // 创建子进程
-    pid = fork();
-    if (pid == (pid_t) -1) {
-        ERROR("Failed to fork: %s", strerror(errno));
-        goto cleanup;
+
+    dirfd = unpack_openat2(ctx->root_fd, ".", UNPACK_DIR_FLAGS);
+    if (dirfd < 0) {
+        return -1;
     }
-    // 子进程
-    if (pid == (pid_t)0) {
-        keepfds[0] = isula_libutils_get_log_fd();
-        keepfds[1] = *(int *)(content->context);
-        keepfds[2] = pipe_stderr[1];
-        ret = util_check_inherited_exclude_fds(true, keepfds, 3);
-        if (ret != 0) {
-            ERROR("Failed to close fds.");
-            fprintf(stderr, "Failed to close fds.");
-            ret = -1;
-            goto child_out;
+    copy = util_strdup_s(path);
+    for (comp = strtok_r(copy, "/", &saveptr); comp != NULL; comp = strtok_r(NULL, "/", &saveptr)) {
+        fd = unpack_openat2(dirfd, comp, UNPACK_DIR_FLAGS);
+        if (fd < 0 && errno == ENOTDIR) {
+            if (unlinkat(dirfd, comp, 0) != 0) {
+                goto err_out;
+            }
+            errno = ENOENT;
         }
-
-        // child process, dup2 pipe_for_read[1] to stderr,
-        if (dup2(pipe_stderr[1], 2) < 0) {
-            ERROR("Dup fd error: %s", strerror(errno));
-            ret = -1;
-            goto child_out;
+        if (fd < 0 && errno == ENOENT) {
+            if (mkdirat(dirfd, comp, 0777) != 0 && errno != EEXIST) {
+                goto err_out;
+            }
+            fd = unpack_openat2(dirfd, comp, UNPACK_DIR_FLAGS);
         }
-
-        if (chroot(dstdir) != 0) {
-            SYSERROR("Failed to chroot to %s", dstdir);
-            fprintf(stderr, "Failed to chroot to %s: %s", dstdir, strerror(errno));
-            ret = -1;
-            goto child_out;
+        if (fd < 0) {
+            goto err_out;
         }
+        close(dirfd);
+        dirfd = fd;
+    }
+    free(copy);
+    return dirfd;
 
-        if (chdir("/") != 0) {
-            SYSERROR("Failed to chroot to /");
-            fprintf(stderr, "Failed to chroot to /: %s", strerror(errno));
-            ret = -1;
-            goto child_out;
+err_out:
+    free(copy);
+    close(dirfd);
+    return -1;
+}
+
+static int unpack_enter_dir(struct unpack_context *ctx, const char *path)
+{
+    int fd = -1;
+
+    if (ctx->parent_fd >= 0 && strcmp(ctx->parent_path, path) == 0) {
+        return ctx->parent_fd;
+    }
+
+    fd = unpack_open_dir(ctx, path, true);
+    if (fd < 0) {
+        unpack_set_error(&ctx->err, "Failed to open directory %s/%s: %s", ctx->dstdir, path, strerror(errno));
+        return -1;
+    }
+    if (ctx->parent_fd >= 0) {
+        close(ctx->parent_fd);
+    }
+    free(ctx->parent_path);
+    ctx->parent_fd = fd;
+    ctx->parent_path = util_strdup_s(path);
+    return fd;
+}
+
+static void unpack_meta_free(struct unpack_meta *meta)
+{
+    size_t i;
+
+    for (i = 0; i < meta->xattrs_len; i++) {
+        free(meta->xattrs[i].name);
+        free(meta->xattrs[i].value);
+    }
+    free(meta->xattrs);
+    meta->xattrs = NULL;
+    meta->xattrs_len = 0;
+}
+
+static int unpack_meta_add_xattr(struct unpack_meta *meta, const char *name, const void *value, size_t size)
+{
+    struct unpack_xattr *xattrs = NULL;
+    void *copy = NULL;
+
+    copy = util_common_calloc_s(size + 1);
+    if (copy == NULL) {
+        return -1;
+    }
+    if (size > 0) {
+        (void)memcpy(copy, value, size);
+    }
+
+    if (util_mem_realloc((void **)&xattrs, (meta->xattrs_len + 1) * sizeof(struct unpack_xattr), meta->xattrs,
+                         meta->xattrs_len * sizeof(struct unpack_xattr)) != 0) {
+        free(copy);
+        return -1;
+    }
+    meta->xattrs = xattrs;
+    meta->xattrs[meta->xattrs_len].name = util_strdup_s(name);
+    meta->xattrs[meta->xattrs_len].value = copy;
+    meta->xattrs[meta->xattrs_len].size = size;
+    meta->xattrs_len++;
+    return 0;
+}
+
+struct unpack_acl_entry {
+    uint16_t tag;
+    uint16_t perm;
+    uint32_t id;
+};
+
+static int unpack_acl_entry_cmp(const void *a, const void *b)
+{
+    const struct unpack_acl_entry *ea = (const struct unpack_acl_entry *)a;
+    const struct unpack_acl_entry *eb = (const struct unpack_acl_entry *)b;
+
+    if (ea->tag != eb->tag) {
+        return ea->tag < eb->tag ? -1 : 1;
+    }
+    if (ea->id != eb->id) {
+        return ea->id < eb->id ? -1 : 1;
+    }
+    return 0;
+}
+
+static uint16_t unpack_acl_tag(int tag)
+{
+    switch (tag) {
+        case ARCHIVE_ENTRY_ACL_USER_OBJ:
+            return UNPACK_ACL_USER_OBJ;
+        case ARCHIVE_ENTRY_ACL_USER:
+            return UNPACK_ACL_USER;
+        case ARCHIVE_ENTRY_ACL_GROUP_OBJ:
+            return UNPACK_ACL_GROUP_OBJ;
+        case ARCHIVE_ENTRY_ACL_GROUP:
+            return UNPACK_ACL_GROUP;
+        case ARCHIVE_ENTRY_ACL_MASK:
+            return UNPACK_ACL_MASK;
+        case ARCHIVE_ENTRY_ACL_OTHER:
+            return UNPACK_ACL_OTHER;
+        default:
+            return 0;
+    }
+}
+
+// posix acls of the entry are restored as the system.posix_acl_* xattrs the kernel
+// keeps them in, which is what ARCHIVE_EXTRACT_ACL does through libacl
+static int unpack_meta_add_acl(struct unpack_meta *meta, struct archive_entry *entry, int type, const char *name)
+{
+    int count;
+    int entry_type, permset, tag, qual;
+    const char *qual_name = NULL;
+    struct unpack_acl_entry *acl = NULL;
+    size_t len = 0;
+    size_t i;
+    char *value = NULL;
+    uint32_t version = htole32(UNPACK_ACL_XATTR_VERSION);
+    int ret = 0;
+
+    count = archive_entry_acl_reset(entry, type);
+    if (count <= 0) {
+        return 0;
+    }
+
+    acl = util_common_calloc_s((size_t)count * sizeof(struct unpack_acl_entry));
+    if (acl == NULL) {
+        return -1;
+    }
+    while (len < (size_t)count &&
+           archive_entry_acl_next(entry, type, &entry_type, &permset, &tag, &qual, &qual_name) == ARCHIVE_OK) {
+        uint16_t acl_tag = unpack_acl_tag(tag);
+        if (acl_tag == 0) {
+            continue;
         }
+        acl[len].tag = acl_tag;
+        acl[len].perm = (uint16_t)(permset & (ARCHIVE_ENTRY_ACL_READ | ARCHIVE_ENTRY_ACL_WRITE |
+                                              ARCHIVE_ENTRY_ACL_EXECUTE));
+        acl[len].id = (acl_tag == UNPACK_ACL_USER || acl_tag == UNPACK_ACL_GROUP) ? (uint32_t)qual :
+                      UNPACK_ACL_UNDEFINED_ID;
+        len++;
+    }
+    // the kernel only accepts entries sorted by tag and id
+    qsort(acl, len, sizeof(struct unpack_acl_entry), unpack_acl_entry_cmp);
 
-        ret = archive_unpack_handler(content, options);
+    value = util_common_calloc_s(sizeof(version) + len * sizeof(struct unpack_acl_entry));
+    if (value == NULL) {
+        ret = -1;
+        goto out;
+    }
+    (void)memcpy(value, &version, sizeof(version));
+    for (i = 0; i < len; i++) {
+        struct unpack_acl_entry le = { htole16(acl[i].tag), htole16(acl[i].perm), htole32(acl[i].id) };
+        (void)memcpy(value + sizeof(version) + i * sizeof(le), &le, sizeof(le));
+    }
+    ret = unpack_meta_add_xattr(meta, name, value, sizeof(version) + len * sizeof(struct unpack_acl_entry));
 
-child_out:
-        if (ret != 0) {
-            exit(EXIT_FAILURE);
-        } else {
-            exit(EXIT_SUCCESS);
+out:
+    free(acl);
+    free(value);
+    return ret;
+}
+
+static int unpack_meta_init(struct archive_entry *entry, struct unpack_meta *meta)
+{
+    const char *name = NULL;
+    const void *value = NULL;
+    size_t size = 0;
+    unsigned long fflags_set = 0;
+    unsigned long fflags_clear = 0;
+
+    meta->uid = (uid_t)archive_entry_uid(entry);
+    meta->gid = (gid_t)archive_entry_gid(entry);
+    meta->mode = archive_entry_perm(entry) & 07777;
+    meta->times[0].tv_sec = archive_entry_atime(entry);
+    meta->times[0].tv_nsec = archive_entry_atime_is_set(entry) ? archive_entry_atime_nsec(entry) : UTIME_NOW;
+    meta->times[1].tv_sec = archive_entry_mtime(entry);
+    meta->times[1].tv_nsec = archive_entry_mtime_is_set(entry) ? archive_entry_mtime_nsec(entry) : UTIME_NOW;
+
+    (void)archive_entry_xattr_reset(entry);
+    while (archive_entry_xattr_next(entry, &name, &value, &size) == ARCHIVE_OK) {
+        if (name != NULL && unpack_meta_add_xattr(meta, name, value, size) != 0) {
+            goto err_out;
         }
     }
-    close(pipe_stderr[1]);
-    pipe_stderr[1] = -1;
 
-    ret = util_wait_for_pid(pid);
-    if (ret != 0) {
-        ERROR("Wait archive_untar_handler failed");
-        fcntl(pipe_stderr[0], F_SETFL, O_NONBLOCK);
-        if (read(pipe_stderr[0], errbuf, BUFSIZ) < 0) {
-            ERROR("read error message from child failed");
+    if (unpack_meta_add_acl(meta, entry, ARCHIVE_ENTRY_ACL_TYPE_ACCESS, "system.posix_acl_access") != 0 ||
+        unpack_meta_add_acl(meta, entry, ARCHIVE_ENTRY_ACL_TYPE_DEFAULT, "system.posix_acl_default") != 0) {
+        goto err_out;
+    }
+
+    archive_entry_fflags(entry, &fflags_set, &fflags_clear);
+    meta->fflags = fflags_set;
+    return 0;
+
+err_out:
+    ERROR("Out of memory");
+    unpack_meta_free(meta);
+    return -1;
+}
+
+// path of the magic link in /proc of fd, which refers to the inode itself
+static int unpack_proc_fd_path(int fd, char *buf, size_t len)
+{
+    int nret = snprintf(buf, len, "/proc/self/fd/%d", fd);
+
+    if (nret < 0 || (size_t)nret >= len) {
+        return -1;
+    }
+    return 0;
+}
+
+// flags like immutable need CAP_LINUX_IMMUTABLE and a filesystem supporting them, as
+// libarchive does they are given up with a warning instead of failing the unpack
+static void unpack_set_fflags(int fd, const char *path, unsigned long fflags)
+{
+    int flags = 0;
+
+    if (fflags == 0) {
+        return;
+    }
+    if (ioctl(fd, FS_IOC_GETFLAGS, &flags) != 0) {
+        WARN("Failed to get flags of %s, flags %lx are not restored: %s", path, fflags, strerror(errno));
+        return;
+    }
+    flags |= (int)(fflags & FS_FL_USER_MODIFIABLE);
+    if (ioctl(fd, FS_IOC_SETFLAGS, &flags) != 0) {
+        WARN("Failed to set flags %lx of %s: %s", fflags, path, strerror(errno));
+    }
+}
+
+// owner first so that setuid bits set by mode are not cleared, acls after mode for the
+// acl mask, times and then inode flags, which may make the inode immutable, at last
+static int unpack_apply_fd_meta(int fd, const char *path, const struct unpack_meta *meta, struct unpack_error *uerr)
+{
+    size_t i;
+
+    if (fchown(fd, meta->uid, meta->gid) != 0) {
+        unpack_set_error(uerr, "Failed to chown %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (fchmod(fd, meta->mode) != 0) {
+        unpack_set_error(uerr, "Failed to chmod %s: %s", path, strerror(errno));
+        return -1;
+    }
+    for (i = 0; i < meta->xattrs_len; i++) {
+        if (fsetxattr(fd, meta->xattrs[i].name, meta->xattrs[i].value, meta->xattrs[i].size, 0) != 0) {
+            unpack_set_error(uerr, "Failed to set xattr %s of %s: %s", meta->xattrs[i].name, path, strerror(errno));
+            return -1;
         }
     }
+    if (futimens(fd, meta->times) != 0) {
+        unpack_set_error(uerr, "Failed to set times of %s: %s", path, strerror(errno));
+        return -1;
+    }
+    unpack_set_fflags(fd, path, meta->fflags);
+    return 0;
+}
 
-cleanup:
-    close_archive_pipes_fd(pipe_stderr, 2);
-    if (errmsg != NULL && strlen(errbuf) != 0) {
-        *errmsg = util_strdup_s(errbuf);
+// xattrs can not be set through an O_PATH fd, but through its magic link in /proc, which
+// refers to the inode itself even if it is a symlink, so the host path is never resolved
+static int unpack_set_path_xattrs(int dirfd, const char *base, const char *path, const struct unpack_meta *meta,
+                                  struct unpack_error *uerr)
+{
+    char proc_path[PATH_MAX] = { 0 };
+    size_t i;
+    int fd = -1;
+    int ret = 0;
+
+    if (meta->xattrs_len == 0) {
+        return 0;
+    }
+
+    fd = openat(dirfd, base, O_PATH | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        unpack_set_error(uerr, "Failed to open %s: %s", path, strerror(errno));
+        return -1;
     }
+    if (unpack_proc_fd_path(fd, proc_path, sizeof(proc_path)) != 0) {
+        unpack_set_error(uerr, "Failed to print proc path of %s", path);
+        ret = -1;
+        goto out;
+    }
+    for (i = 0; i < meta->xattrs_len; i++) {
+        if (setxattr(proc_path, meta->xattrs[i].name, meta->xattrs[i].value, meta->xattrs[i].size, 0) != 0) {
+            unpack_set_error(uerr, "Failed to set xattr %s of %s: %s", meta->xattrs[i].name, path, strerror(errno));
+            ret = -1;
+            goto out;
+        }
+    }
+
+out:
+    close(fd);
+    return ret;
+}
+
+// glibc before 2.32 refuses AT_SYMLINK_NOFOLLOW of fchmodat with EOPNOTSUPP even for
+// inodes other than symlinks, chmod them through the magic link in /proc as newer glibc does
+static int unpack_chmod_nofollow(int dirfd, const char *base, mode_t mode)
+{
+    char proc_path[PATH_MAX] = { 0 };
+    int fd = -1;
+    int ret = -1;
+
+    if (fchmodat(dirfd, base, mode, AT_SYMLINK_NOFOLLOW) == 0) {
+        return 0;
+    }
+    if (errno != EOPNOTSUPP) {
+        return -1;
+    }
+
+    fd = openat(dirfd, base, O_PATH | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (unpack_proc_fd_path(fd, proc_path, sizeof(proc_path)) == 0) {
+        ret = chmod(proc_path, mode);
+    }
+    close(fd);
+    return ret;
+}
+
+// metadata of inodes which can not be opened, symlinks and special files
+static int unpack_apply_path_meta(int dirfd, const char *base, const char *path, bool is_symlink,
+                                  const struct unpack_meta *meta, struct unpack_error *uerr)
+{
+    if (fchownat(dirfd, base, meta->uid, meta->gid, AT_SYMLINK_NOFOLLOW) != 0) {
+        unpack_set_error(uerr, "Failed to chown %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (!is_symlink && unpack_chmod_nofollow(dirfd, base, meta->mode) != 0) {
+        unpack_set_error(uerr, "Failed to chmod %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (unpack_set_path_xattrs(dirfd, base, path, meta, uerr) != 0) {
+        return -1;
+    }
+    if (utimensat(dirfd, base, meta->times, AT_SYMLINK_NOFOLLOW) != 0) {
+        unpack_set_error(uerr, "Failed to set times of %s: %s", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static void unpack_free_job(struct unpack_file_job *job)
+{
+    if (job->fd >= 0) {
+        close(job->fd);
+    }
+    free(job->path);
+    free(job->data);
+    unpack_meta_free(&job->meta);
+    free(job);
+}
+
+static void unpack_run_job(struct unpack_file_job *job, struct unpack_error *uerr)
+{
+    if (job->len > 0 && util_write_nointr_in_total(job->fd, job->data, job->len) != (ssize_t)job->len) {
+        unpack_set_error(uerr, "Failed to write %s: %s", job->path, strerror(errno));
+        return;
+    }
+    (void)unpack_apply_fd_meta(job->fd, job->path, &job->meta, uerr);
+}
+
+static void *unpack_worker_routine(void *arg)
+{
+    struct unpack_pool *pool = (struct unpack_pool *)arg;
+    struct unpack_file_job *job = NULL;
+
+    (void)pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (pool->head == NULL && !pool->stop) {
+            (void)pthread_cond_wait(&pool->job_cond, &pool->mutex);
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+        job = pool->head;
+        pool->head = job->next;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        (void)pthread_mutex_unlock(&pool->mutex);
+
+        unpack_run_job(job, pool->err);
+
+        (void)pthread_mutex_lock(&pool->mutex);
+        pool->pending_jobs--;
+        pool->pending_bytes -= job->len;
+        (void)pthread_cond_broadcast(&pool->done_cond);
+        unpack_free_job(job);
+    }
+    (void)pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+static void unpack_pool_init(struct unpack_pool *pool, struct unpack_error *uerr)
+{
+    size_t want = (size_t)get_nprocs();
+    size_t i;
+
+    pool->err = uerr;
+    (void)pthread_mutex_init(&pool->mutex, NULL);
+    (void)pthread_cond_init(&pool->job_cond, NULL);
+    (void)pthread_cond_init(&pool->done_cond, NULL);
+
+    if (want > UNPACK_MAX_WORKERS) {
+        want = UNPACK_MAX_WORKERS;
+    }
+    // with one cpu the workers only add switches, buffered files are written in line
+    for (i = 0; want > 1 && i < want; i++) {
+        if (pthread_create(&pool->tids[pool->nthreads], NULL, unpack_worker_routine, pool) != 0) {
+            WARN("Failed to start unpack worker, continue with %zu workers", pool->nthreads);
+            break;
+        }
+        pool->nthreads++;
+    }
+}
+
+static void unpack_pool_submit(struct unpack_pool *pool, struct unpack_file_job *job)
+{
+    if (pool->nthreads == 0) {
+        unpack_run_job(job, pool->err);
+        unpack_free_job(job);
+        return;
+    }
+
+    (void)pthread_mutex_lock(&pool->mutex);
+    while (pool->pending_bytes > 0 && pool->pending_bytes + job->len > UNPACK_MAX_PENDING_BYTES) {
+        (void)pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    if (pool->tail == NULL) {
+        pool->head = job;
+    } else {
+        pool->tail->next = job;
+    }
+    pool->tail = job;
+    pool->pending_jobs++;
+    pool->pending_bytes += job->len;
+    (void)pthread_cond_signal(&pool->job_cond);
+    (void)pthread_mutex_unlock(&pool->mutex);
+}
+
+static void unpack_pool_wait(struct unpack_pool *pool)
+{
+    (void)pthread_mutex_lock(&pool->mutex);
+    while (pool->pending_jobs > 0) {
+        (void)pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    (void)pthread_mutex_unlock(&pool->mutex);
+}
+
+// queued jobs are still run, they own fds of files already created
+static void unpack_pool_destroy(struct unpack_pool *pool)
+{
+    size_t i;
+
+    (void)pthread_mutex_lock(&pool->mutex);
+    pool->stop = true;
+    (void)pthread_cond_broadcast(&pool->job_cond);
+    (void)pthread_mutex_unlock(&pool->mutex);
+
+    for (i = 0; i < pool->nthreads; i++) {
+        (void)pthread_join(pool->tids[i], NULL);
+    }
+    pool->nthreads = 0;
+    (void)pthread_cond_destroy(&pool->done_cond);
+    (void)pthread_cond_destroy(&pool->job_cond);
+    (void)pthread_mutex_destroy(&pool->mutex);
+}
+
+// write the data of the entry at the offsets libarchive gives, holes of sparse files are kept
+static int unpack_write_data(struct unpack_context *ctx, struct archive *a, int fd, const char *path, int64_t size)
+{
+    int r;
+    const void *buff = NULL;
+    size_t len;
+    int64_t offset;
+
+    for (;;) {
+        r = archive_read_data_block(a, &buff, &len, &offset);
+        if (r == ARCHIVE_EOF) {
+            break;
+        }
+        if (r < ARCHIVE_OK) {
+            unpack_set_error(&ctx->err, "Failed to read data of %s: %s", path, archive_error_string(a));
+            return -1;
+        }
+        if (len > 0 && pwrite(fd, buff, len, (off_t)offset) != (ssize_t)len) {
+            unpack_set_error(&ctx->err, "Failed to write %s: %s", path, strerror(errno));
+            return -1;
+        }
+    }
+
+    if (size > 0 && ftruncate(fd, (off_t)size) != 0) {
+        unpack_set_error(&ctx->err, "Failed to truncate %s: %s", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int unpack_buffer_data(struct unpack_context *ctx, struct archive *a, struct unpack_file_job *job)
+{
+    int r;
+    const void *buff = NULL;
+    size_t len;
+    int64_t offset;
+
+    for (;;) {
+        r = archive_read_data_block(a, &buff, &len, &offset);
+        if (r == ARCHIVE_EOF) {
+            return 0;
+        }
+        if (r < ARCHIVE_OK) {
+            unpack_set_error(&ctx->err, "Failed to read data of %s: %s", job->path, archive_error_string(a));
+            return -1;
+        }
+        if (offset < 0 || (uint64_t)offset + len > job->len) {
+            unpack_set_error(&ctx->err, "Invalid data of %s beyond its size", job->path);
+            return -1;
+        }
+        if (len > 0) {
+            (void)memcpy(job->data + offset, buff, len);
+        }
+    }
+}
+
+static int unpack_regular_file(struct unpack_context *ctx, struct archive *a, struct archive_entry *entry, int dirfd,
+                               const char *base, const char *path, struct unpack_meta *meta)
+{
+    int fd = -1;
+    int64_t size = archive_entry_size(entry);
+    struct unpack_file_job *job = NULL;
+    int ret = -1;
+
+    fd = openat(dirfd, base, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        unpack_set_error(&ctx->err, "Failed to create %s: %s", path, strerror(errno));
+        return -1;
+    }
+
+    if (ctx->pool.nthreads == 0 || !archive_entry_size_is_set(entry) || size < 0 || size > UNPACK_BUFFERED_FILE_MAX) {
+        if (unpack_write_data(ctx, a, fd, path, size) == 0 && unpack_apply_fd_meta(fd, path, meta, &ctx->err) == 0) {
+            ret = 0;
+        }
+        close(fd);
+        return ret;
+    }
+
+    job = util_common_calloc_s(sizeof(struct unpack_file_job));
+    if (job == NULL) {
+        ERROR("Out of memory");
+        close(fd);
+        return -1;
+    }
+    job->fd = fd;
+    job->path = util_strdup_s(path);
+    job->len = (size_t)size;
+    job->data = util_common_calloc_s(job->len + 1);
+    job->meta = *meta;
+    (void)memset(meta, 0, sizeof(*meta));
+    if (job->data == NULL) {
+        ERROR("Out of memory");
+        unpack_free_job(job);
+        return -1;
+    }
+    if (unpack_buffer_data(ctx, a, job) != 0) {
+        unpack_free_job(job);
+        return -1;
+    }
+
+    unpack_pool_submit(&ctx->pool, job);
+    return 0;
+}
+
+static int unpack_hardlink(struct unpack_context *ctx, struct archive *a, struct archive_entry *entry, int dirfd,
+                           const char *base, const char *path, struct unpack_meta *meta)
+{
+    char *target = NULL;
+    char *target_dir = NULL;
+    const char *target_base = NULL;
+    char *slash = NULL;
+    char proc_path[PATH_MAX] = { 0 };
+    struct stat st;
+    int target_dirfd = -1;
+    int path_fd = -1;
+    int fd = -1;
+    int ret = -1;
+
+    target = unpack_clean_path(archive_entry_hardlink(entry));
+    if (target == NULL || target[0] == '\0') {
+        unpack_set_error(&ctx->err, "Invalid hardlink target %s of %s", archive_entry_hardlink(entry), path);
+        goto out;
+    }
+    slash = strrchr(target, '/');
+    if (slash != NULL) {
+        *slash = '\0';
+        target_dir = target;
+        target_base = slash + 1;
+    } else {
+        target_dir = "";
+        target_base = target;
+    }
+
+    target_dirfd = unpack_open_dir(ctx, target_dir, false);
+    if (target_dirfd < 0) {
+        unpack_set_error(&ctx->err, "Failed to open directory of hardlink target %s: %s",
+                         archive_entry_hardlink(entry), strerror(errno));
+        goto out;
+    }
+    if (linkat(target_dirfd, target_base, dirfd, base, 0) != 0) {
+        unpack_set_error(&ctx->err, "Failed to link %s to %s: %s", path, archive_entry_hardlink(entry),
+                         strerror(errno));
+        goto out;
+    }
+
+    // metadata is only restored for hardlinks which carry data, as libarchive does
+    if (archive_entry_size(entry) <= 0) {
+        ret = 0;
+        goto out;
+    }
+    // a worker may still write the target
+    unpack_pool_wait(&ctx->pool);
+    // the target may be a fifo or device, where opening for write blocks or has side effects,
+    // check the inode first and open just that inode for the data
+    path_fd = openat(dirfd, base, O_PATH | O_NOFOLLOW | O_CLOEXEC);
+    if (path_fd < 0 || fstat(path_fd, &st) != 0) {
+        unpack_set_error(&ctx->err, "Failed to open %s: %s", path, strerror(errno));
+        goto out;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        unpack_set_error(&ctx->err, "Hardlink %s with data refers to %s which is not a regular file", path,
+                         archive_entry_hardlink(entry));
+        goto out;
+    }
+    if (unpack_proc_fd_path(path_fd, proc_path, sizeof(proc_path)) != 0) {
+        unpack_set_error(&ctx->err, "Failed to print proc path of %s", path);
+        goto out;
+    }
+    fd = open(proc_path, O_WRONLY | O_TRUNC | O_CLOEXEC);
+    if (fd < 0) {
+        unpack_set_error(&ctx->err, "Failed to open %s: %s", path, strerror(errno));
+        goto out;
+    }
+    if (unpack_write_data(ctx, a, fd, path, archive_entry_size(entry)) != 0 ||
+        unpack_apply_fd_meta(fd, path, meta, &ctx->err) != 0) {
+        goto out;
+    }
+    ret = 0;
+
+out:
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (path_fd >= 0) {
+        close(path_fd);
+    }
+    if (target_dirfd >= 0) {
+        close(target_dirfd);
+    }
+    free(target);
+    return ret;
+}
+
+static int unpack_add_dir_fixup(struct unpack_context *ctx, const char *rel_path, struct unpack_meta *meta)
+{
+    struct unpack_dir_fixup *fixup = NULL;
+
+    fixup = util_common_calloc_s(sizeof(struct unpack_dir_fixup));
+    if (fixup == NULL) {
+        ERROR("Out of memory");
+        return -1;
+    }
+    fixup->path = util_strdup_s(rel_path);
+    fixup->meta = *meta;
+    (void)memset(meta, 0, sizeof(*meta));
+    // applied in the order of the archive, so the last entry of a directory wins
+    if (ctx->fixups_tail == NULL) {
+        ctx->fixups = fixup;
+    } else {
+        ctx->fixups_tail->next = fixup;
+    }
+    ctx->fixups_tail = fixup;
+    return 0;
+}
+
+static int unpack_apply_dir_fixups(struct unpack_context *ctx)
+{
+    struct unpack_dir_fixup *fixup = NULL;
+    int fd = -1;
+    int ret = 0;
+
+    for (fixup = ctx->fixups; fixup != NULL; fixup = fixup->next) {
+        fd = unpack_openat2(ctx->root_fd, fixup->path[0] != '\0' ? fixup->path : ".", UNPACK_DIR_FLAGS);
+        if (fd < 0) {
+            // removed by a later entry
+            if (errno == ENOENT || errno == ENOTDIR) {
+                continue;
+            }
+            unpack_set_error(&ctx->err, "Failed to open directory %s/%s: %s", ctx->dstdir, fixup->path,
+                             strerror(errno));
+            ret = -1;
+            break;
+        }
+        ret = unpack_apply_fd_meta(fd, fixup->path, &fixup->meta, &ctx->err);
+        close(fd);
+        if (ret != 0) {
+            break;
+        }
+    }
+    return ret;
+}
+
+// remove name below dirfd recursively, symlinks are removed instead of followed
+static int unpack_remove_at(int dirfd, const char *name, int depth)
+{
+    struct stat st;
+    struct dirent *dent = NULL;
+    DIR *dir = NULL;
+    int fd = -1;
+    int ret = 0;
+
+    if (depth > MAX_PATH_DEPTH) {
+        errno = ELOOP;
+        return -1;
+    }
+    if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return errno == ENOENT ? 0 : -1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return (unlinkat(dirfd, name, 0) == 0 || errno == ENOENT) ? 0 : -1;
+    }
+
+    fd = openat(dirfd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    dir = fdopendir(fd);
+    if (dir == NULL) {
+        close(fd);
+        return -1;
+    }
+    for (dent = readdir(dir); dent != NULL; dent = readdir(dir)) {
+        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
+            continue;
+        }
+        if (unpack_remove_at(fd, dent->d_name, depth + 1) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    (void)closedir(dir);
+    if (ret != 0) {
+        return -1;
+    }
+    return (unlinkat(dirfd, name, AT_REMOVEDIR) == 0 || errno == ENOENT) ? 0 : -1;
+}
+
+// same as remove_files_in_opq_dir, relative to dirfd, dirpath is only for the unpacked paths
+static int unpack_remove_opq_at(int dirfd, const char *dirpath, int depth, map_t *unpacked_path_map)
+{
+    struct dirent *dent = NULL;
+    DIR *dir = NULL;
+    int fd = -1;
+    int ret = 0;
+
+    if (depth > MAX_PATH_DEPTH) {
+        ERROR("Reach max path depth: %s", dirpath);
+        return -1;
+    }
+
+    fd = openat(dirfd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    dir = fdopendir(fd);
+    if (dir == NULL) {
+        close(fd);
+        return -1;
+    }
+    for (dent = readdir(dir); dent != NULL; dent = readdir(dir)) {
+        struct stat st;
+        char *fname = NULL;
+        int subfd = -1;
+
+        if (strcmp(dent->d_name, ".") == 0 || strcmp(dent->d_name, "..") == 0) {
+            continue;
+        }
+        fname = util_path_join(dirpath, dent->d_name);
+        if (fname == NULL) {
+            ret = -1;
+            continue;
+        }
+        if (map_search(unpacked_path_map, (void *)fname) == NULL) {
+            if (unpack_remove_at(fd, dent->d_name, 0) != 0) {
+                ERROR("Failed to remove path %s: %s", fname, strerror(errno));
+                ret = -1;
+            }
+        } else if (fstatat(fd, dent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode)) {
+            subfd = openat(fd, dent->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (subfd < 0 || unpack_remove_opq_at(subfd, fname, depth + 1, unpacked_path_map) != 0) {
+                ret = -1;
+            }
+            if (subfd >= 0) {
+                close(subfd);
+            }
+        }
+        free(fname);
+    }
+    (void)closedir(dir);
+    return ret;
+}
+
+/*
+ * Same as the whiteout callbacks of archive_unpack_handler, relative to the resolved parent.
+ * Return 1 if entry is a whiteout and was handled, 0 if it is a normal entry, -1 on error.
+ */
+static int unpack_whiteout(struct unpack_context *ctx, struct archive_entry *entry, int dirfd, const char *base,
+                           const char *path, whiteout_format_type format, map_t *unpacked_path_map)
+{
+    const char *origin_base = NULL;
+    char *dirpath = NULL;
+    int ret = 1;
+
+    if (format == NONE_WHITEOUT_FORMATE) {
+        return 0;
+    }
+
+    if (strcmp(base, WHITEOUT_OPAQUEDIR) == 0) {
+        if (format == OVERLAY_WHITEOUT_FORMATE) {
+            if (fsetxattr(dirfd, "trusted.overlay.opaque", "y", 1, 0) != 0) {
+                SYSERROR("Failed to set attr for dir of %s", path);
+            }
+            return 1;
+        }
+        dirpath = util_path_dir(path);
+        if (dirpath == NULL || unpack_remove_opq_at(dirfd, dirpath, 0, unpacked_path_map) != 0) {
+            unpack_set_error(&ctx->err, "Failed to remove files in opq dir of %s", path);
+            ret = -1;
+        }
+        free(dirpath);
+        return ret;
+    }
+
+    if (strncmp(base, WHITEOUT_PREFIX, strlen(WHITEOUT_PREFIX)) != 0) {
+        return 0;
+    }
+    origin_base = base + strlen(WHITEOUT_PREFIX);
+    if (format == OVERLAY_WHITEOUT_FORMATE) {
+        if (mknodat(dirfd, origin_base, S_IFCHR, 0) != 0) {
+            SYSERROR("Failed to mknod for whiteout %s", path);
+        }
+        if (fchownat(dirfd, origin_base, archive_entry_uid(entry), archive_entry_gid(entry), AT_SYMLINK_NOFOLLOW) !=
+            0) {
+            SYSERROR("Failed to chown for whiteout %s", path);
+        }
+        return 1;
+    }
+    if (unpack_remove_at(dirfd, origin_base, 0) != 0) {
+        unpack_set_error(&ctx->err, "Failed to delete original path of %s: %s", path, strerror(errno));
+        return -1;
+    }
+    return 1;
+}
+
+// same as try_to_replace_exited_dst, relative to the resolved parent
+static int unpack_replace_existing(struct unpack_context *ctx, int dirfd, const char *base, const char *path,
+                                   struct archive_entry *entry, bool *is_dir)
+{
+    struct stat st;
+
+    *is_dir = false;
+    if (fstatat(dirfd, base, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+        return 0;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        if (archive_entry_filetype(entry) == AE_IFDIR) {
+            *is_dir = true;
+            return 0;
+        }
+        // the parent was resolved without symlinks, nothing outside of the root is removed
+        if (unpack_remove_at(dirfd, base, 0) != 0) {
+            unpack_set_error(&ctx->err, "Failed to remove path %s while unpack: %s", path, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (unlinkat(dirfd, base, 0) != 0 && errno != ENOENT) {
+        unpack_set_error(&ctx->err, "Failed to remove path %s while unpack: %s", path, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int unpack_entry(struct unpack_context *ctx, struct archive *a, struct archive_entry *entry,
+                        const char *dst_path, const struct archive_options *options, map_t *unpacked_path_map)
+{
+    char *rel_path = NULL;
+    char *path = NULL;
+    char *dir = NULL;
+    const char *base = NULL;
+    char *slash = NULL;
+    int dirfd = -1;
+    bool exist_dir = false;
+    struct unpack_meta meta = { 0 };
+    bool b = true;
+    int nret = 0;
+    int ret = -1;
+
+    rel_path = unpack_clean_path(dst_path);
+    if (rel_path == NULL) {
+        unpack_set_error(&ctx->err, "Invalid path %s in archive", dst_path);
+        return -1;
+    }
+    path = rel_path[0] != '\0' ? util_path_join(ctx->dstdir, rel_path) : util_strdup_s(ctx->dstdir);
+    if (path == NULL) {
+        unpack_set_error(&ctx->err, "Failed to join %s and %s", ctx->dstdir, rel_path);
+        goto out;
+    }
+
+    if (rel_path[0] == '\0') {
+        // the root itself, only its metadata can be restored
+        archive_entry_set_uid(entry, options->uid);
+        archive_entry_set_gid(entry, options->gid);
+        if (archive_entry_filetype(entry) == AE_IFDIR &&
+            (unpack_meta_init(entry, &meta) != 0 || unpack_add_dir_fixup(ctx, rel_path, &meta) != 0)) {
+            goto out;
+        }
+        ret = 0;
+        goto out;
+    }
+
+    dir = util_strdup_s(rel_path);
+    slash = strrchr(dir, '/');
+    if (slash != NULL) {
+        *slash = '\0';
+        base = slash + 1;
+    } else {
+        base = dir;
+    }
+    dirfd = unpack_enter_dir(ctx, slash != NULL ? dir : "");
+    if (dirfd < 0) {
+        goto out;
+    }
+
+    nret = unpack_whiteout(ctx, entry, dirfd, base, path, options->whiteout_format, unpacked_path_map);
+    if (nret != 0) {
+        ret = nret > 0 ? 0 : -1;
+        goto out;
+    }
+
+    if (unpack_replace_existing(ctx, dirfd, base, path, entry, &exist_dir) != 0) {
+        goto out;
+    }
+
+    archive_entry_set_uid(entry, options->uid);
+    archive_entry_set_gid(entry, options->gid);
+    if (unpack_meta_init(entry, &meta) != 0) {
+        goto out;
+    }
+
+    if (archive_entry_hardlink(entry) != NULL) {
+        ret = unpack_hardlink(ctx, a, entry, dirfd, base, path, &meta);
+        goto mark;
+    }
+
+    switch (archive_entry_filetype(entry)) {
+        case AE_IFREG:
+            ret = unpack_regular_file(ctx, a, entry, dirfd, base, path, &meta);
+            break;
+        case AE_IFDIR:
+            if (!exist_dir && mkdirat(dirfd, base, 0700) != 0 && errno != EEXIST) {
+                unpack_set_error(&ctx->err, "Failed to create directory %s: %s", path, strerror(errno));
+                break;
+            }
+            ret = unpack_add_dir_fixup(ctx, rel_path, &meta);
+            break;
+        case AE_IFLNK:
+            if (symlinkat(archive_entry_symlink(entry), dirfd, base) != 0) {
+                unpack_set_error(&ctx->err, "Failed to create symlink %s: %s", path, strerror(errno));
+                break;
+            }
+            ret = unpack_apply_path_meta(dirfd, base, path, true, &meta, &ctx->err);
+            break;
+        case AE_IFCHR:
+        case AE_IFBLK:
+        case AE_IFIFO:
+            if (mknodat(dirfd, base, archive_entry_filetype(entry) | meta.mode, archive_entry_rdev(entry)) != 0) {
+                unpack_set_error(&ctx->err, "Failed to create %s: %s", path, strerror(errno));
+                break;
+            }
+            ret = unpack_apply_path_meta(dirfd, base, path, false, &meta, &ctx->err);
+            break;
+        default:
+            WARN("Skip %s of unsupported file type %o", path, archive_entry_filetype(entry));
+            ret = 0;
+            goto out;
+    }
+
+mark:
+    if (ret == 0 && !map_replace(unpacked_path_map, (void *)path, (void *)(&b))) {
+        unpack_set_error(&ctx->err, "Failed to replace unpacked path map element");
+        ret = -1;
+    }
+
+out:
+    unpack_meta_free(&meta);
+    free(rel_path);
+    free(path);
+    free(dir);
+    return ret;
+}
+
+static void unpack_context_free(struct unpack_context *ctx)
+{
+    struct unpack_dir_fixup *fixup = NULL;
+
+    while (ctx->fixups != NULL) {
+        fixup = ctx->fixups;
+        ctx->fixups = fixup->next;
+        unpack_meta_free(&fixup->meta);
+        free(fixup->path);
+        free(fixup);
+    }
+    if (ctx->parent_fd >= 0) {
+        close(ctx->parent_fd);
+        ctx->parent_fd = -1;
+    }
+    free(ctx->parent_path);
+    ctx->parent_path = NULL;
+    (void)pthread_mutex_destroy(&ctx->err.mutex);
+}
+
+static int archive_unpack_in_root(const struct io_read_wrapper *content, int root_fd, const char *dstdir,
+                                  const struct archive_options *options, char **errmsg)
+{
+    int ret = 0;
+    struct archive *a = NULL;
+    struct archive_content_data *mydata = NULL;
+    struct archive_entry *entry = NULL;
+    char *dst_path = NULL;
+    map_t *unpacked_path_map = NULL;
+    struct decompress_stage stage = { .pipefd = { -1, -1 } };
+    struct io_read_wrapper staged_content = { 0 };
+    struct unpack_context ctx = { .root_fd = root_fd, .dstdir = dstdir, .parent_fd = -1 };
+
+    (void)pthread_mutex_init(&ctx.err.mutex, NULL);
+    unpack_pool_init(&ctx.pool, &ctx.err);
+
+    unpacked_path_map = map_new(MAP_STR_BOOL, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    if (unpacked_path_map == NULL) {
+        unpack_set_error(&ctx.err, "Out of memory");
+        ret = -1;
+        goto out;
+    }
+
+    mydata = util_common_calloc_s(sizeof(struct archive_content_data));
+    if (mydata == NULL) {
+        unpack_set_error(&ctx.err, "Out of memory");
+        ret = -1;
+        goto out;
+    }
+    mydata->content = content;
+    if (decompress_stage_start(&stage, content, &staged_content) == 0) {
+        mydata->content = &staged_content;
+    } else {
+        WARN("Decompress content in line with unpacking");
+    }
+
+    a = archive_read_new();
+    if (a == NULL) {
+        unpack_set_error(&ctx.err, "archive read new failed");
+        ret = -1;
+        goto out;
+    }
+    archive_read_support_filter_all(a);
+    archive_read_support_format_all(a);
+
+    if (archive_read_open(a, mydata, NULL, read_content, NULL) != ARCHIVE_OK) {
+        unpack_set_error(&ctx.err, "Failed to open archive: %s", archive_error_string(a));
+        ret = -1;
+        goto out;
+    }
+
+    for (;;) {
+        free(dst_path);
+        dst_path = NULL;
+        ret = archive_read_next_header(a, &entry);
+        if (ret == ARCHIVE_EOF) {
+            break;
+        }
+        if (ret != ARCHIVE_OK) {
+            unpack_set_error(&ctx.err, "Warning reading tar header: %s", archive_error_string(a));
+            ret = -1;
+            goto out;
+        }
+
+        dst_path = update_entry_for_pathname(entry, options->src_base, options->dst_base);
+        if (dst_path == NULL) {
+            unpack_set_error(&ctx.err, "Failed to update pathname");
+            ret = -1;
+            goto out;
+        }
+        if (rebase_hardlink(entry, options->src_base, options->dst_base) != 0) {
+            unpack_set_error(&ctx.err, "Failed to rebase hardlink");
+            ret = -1;
+            goto out;
+        }
+
+        if (unpack_entry(&ctx, a, entry, dst_path, options, unpacked_path_map) != 0 ||
+            unpack_has_error(&ctx.err)) {
+            ret = -1;
+            goto out;
+        }
+    }
+
+    ret = 0;
+
+out:
+    unpack_pool_destroy(&ctx.pool);
+    if (ret == 0 && !unpack_has_error(&ctx.err) && unpack_apply_dir_fixups(&ctx) != 0) {
+        ret = -1;
+    }
+    if (mydata != NULL && decompress_stage_finish(&stage, ret == 0, mydata->buff, sizeof(mydata->buff)) != 0 &&
+        ret == 0) {
+        unpack_set_error(&ctx.err, "Failed to decompress archive content");
+        ret = -1;
+    }
+    if (unpack_has_error(&ctx.err)) {
+        ret = -1;
+        if (errmsg != NULL) {
+            *errmsg = util_strdup_s(ctx.err.msg);
+        }
+    }
+    map_free(unpacked_path_map);
+    free(dst_path);
+    archive_read_close(a);
+    archive_read_free(a);
+    free(mydata);
+    unpack_context_free(&ctx);
+    return ret;
+}
+
+static void close_archive_pipes_fd(int *pipes, size_t pipe_size)
+{
+    size_t i = 0;
+
+    for (i = 0; i < pipe_size; i++) {
+        if (pipes[i] >= 0) {
+            close(pipes[i]);
+            pipes[i] = -1;
+        }
+    }
+}
+
+static int archive_unpack_in_chroot(const struct io_read_wrapper *content, const char *dstdir,
+                                    const struct archive_options *options, char **errmsg)
+{
+    int ret = 0;
+    pid_t pid = -1;
+    int keepfds[] = { -1, -1, -1 };
+    int pipe_stderr[2] = { -1, -1 };
+    char errbuf[BUFSIZ] = { 0 };
+
+    if (pipe2(pipe_stderr, O_CLOEXEC) != 0) {
+        ERROR("Failed to create pipe");
+        ret = -1;
+        goto cleanup;
+    }
+    // 创建子进程
+    pid = fork();
+    if (pid == (pid_t) -1) {
+        ERROR("Failed to fork: %s", strerror(errno));
+        goto cleanup;
+    }
+    // 子进程
+    if (pid == (pid_t)0) {
+        keepfds[0] = isula_libutils_get_log_fd();
+        keepfds[1] = *(int *)(content->context);
+        keepfds[2] = pipe_stderr[1];
+        ret = util_check_inherited_exclude_fds(true, keepfds, 3);
+        if (ret != 0) {
+            ERROR("Failed to close fds.");
+            fprintf(stderr, "Failed to close fds.");
+            ret = -1;
+            goto child_out;
+        }
+
+        // child process, dup2 pipe_for_read[1] to stderr,
+        if (dup2(pipe_stderr[1], 2) < 0) {
+            ERROR("Dup fd error: %s", strerror(errno));
+            ret = -1;
+            goto child_out;
+        }
+
+        if (chroot(dstdir) != 0) {
+            SYSERROR("Failed to chroot to %s", dstdir);
+            fprintf(stderr, "Failed to chroot to %s: %s", dstdir, strerror(errno));
+            ret = -1;
+            goto child_out;
+        }
+
+        if (chdir("/") != 0) {
+            SYSERROR("Failed to chroot to /");
+            fprintf(stderr, "Failed to chroot to /: %s", strerror(errno));
+            ret = -1;
+            goto child_out;
+        }
+
+        ret = archive_unpack_handler(content, options);
+
+child_out:
+        if (ret != 0) {
+            exit(EXIT_FAILURE);
+        } else {
+            exit(EXIT_SUCCESS);
+        }
+    }
+    close(pipe_stderr[1]);
+    pipe_stderr[1] = -1;
+
+    ret = util_wait_for_pid(pid);
+    if (ret != 0) {
+        ERROR("Wait archive_untar_handler failed");
+        fcntl(pipe_stderr[0], F_SETFL, O_NONBLOCK);
+        if (read(pipe_stderr[0], errbuf, BUFSIZ) < 0) {
+            ERROR("read error message from child failed");
+        }
+    }
+
+cleanup:
+    close_archive_pipes_fd(pipe_stderr, 2);
+    if (errmsg != NULL && strlen(errbuf) != 0) {
+        *errmsg = util_strdup_s(errbuf);
+    }
+    return ret;
+}
+
+int archive_unpack(const struct io_read_wrapper *content, const char *dstdir, const struct archive_options *options,
+                   char **errmsg)
+{
+    int ret = 0;
+    int root_fd = -1;
+    int probe_fd = -1;
+
+    root_fd = open(dstdir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root_fd < 0) {
+        SYSERROR("Failed to open %s", dstdir);
+        if (errmsg != NULL) {
+            *errmsg = util_strdup_s(strerror(errno));
+        }
+        return -1;
+    }
+
+    // openat2 is available since linux 5.6, unpack in a chrooted child on older kernels
+    probe_fd = unpack_openat2(root_fd, ".", UNPACK_DIR_FLAGS);
+    if (probe_fd < 0) {
+        DEBUG("openat2 is not usable: %s, unpack %s in chroot", strerror(errno), dstdir);
+        close(root_fd);
+        return archive_unpack_in_chroot(content, dstdir, options, errmsg);
+    }
+    close(probe_fd);
+
+    ret = archive_unpack_in_root(content, root_fd, dstdir, options, errmsg);
+    close(root_fd);
     return ret;
 }
 
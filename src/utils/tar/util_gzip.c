@@ -15,75 +15,583 @@
 #define _GNU_SOURCE /* See feature_test_macros(7) */
 #include "util_gzip.h"
 #include <zlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
 #include <sys/stat.h>
+#include <sys/sysinfo.h>
+#ifdef ENABLE_ZSTD
+#include <zstd.h>
+#endif
 
 #include "utils.h"
 #include "isula_libutils/log.h"
 #include "utils_file.h"
 
 #define BLKSIZE 32768
+#define STREAM_BUF_SIZE (128 * 1024)
 
-// Compress
-int util_gzip_z(const char *srcfile, const char *dstfile, const mode_t mode)
+/*
+ * gzip output is made of independent deflate jobs run in parallel, each primed with the
+ * last GZIP_DICT_SIZE bytes of input before it so the ratio stays close to a single
+ * stream. Every job ends with a sync flush, so their output can simply be concatenated.
+ */
+#define GZIP_JOB_SIZE (128 * 1024)
+#define GZIP_DICT_SIZE 32768
+#define GZIP_MAX_JOBS 8
+
+#define MAGIC_MAX_LEN 4
+
+struct compression_magic {
+    compression_type_t type;
+    unsigned char magic[MAGIC_MAX_LEN];
+    size_t len;
+};
+
+static const struct compression_magic g_magics[] = {
+    { COMPRESSION_GZIP, { 0x1F, 0x8B }, 2 },
+    { COMPRESSION_ZSTD, { 0x28, 0xB5, 0x2F, 0xFD }, 4 },
+};
+
+typedef int (*compress_func_t)(int srcfd, int dstfd);
+typedef int (*decompress_func_t)(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer);
+
+struct compression_codec {
+    compression_type_t type;
+    const char *name;
+    compress_func_t compress;
+    decompress_func_t decompress;
+};
+
+static int write_all(const struct io_write_wrapper *writer, const void *data, size_t len)
 {
-    int ret = 0;
-    int srcfd = 0;
-    gzFile stream = NULL;
-    ssize_t size = 0;
-    size_t n = 0;
-    void *buffer = 0;
-    const char *gzerr = NULL;
-    int errnum = 0;
+    ssize_t nret;
 
-    srcfd = util_open(srcfile, O_RDONLY, SECURE_CONFIG_FILE_MODE);
-    if (srcfd < 0) {
-        ERROR("Open src file: %s, failed: %s", srcfile, strerror(errno));
+    if (len == 0) {
+        return 0;
+    }
+    nret = writer->write_func(writer->context, data, len);
+    if (nret < 0 || (size_t)nret != len) {
+        ERROR("Write decompressed data failed");
         return -1;
     }
+    return 0;
+}
 
-    stream = gzopen(dstfile, "w");
-    if (stream == NULL) {
-        ERROR("gzopen %s error: %s", dstfile, strerror(errno));
-        close(srcfd);
+static int write_fd_all(int fd, const void *data, size_t len)
+{
+    ssize_t nret;
+
+    nret = util_write_nointr_in_total(fd, data, len);
+    if (nret < 0 || (size_t)nret != len) {
+        ERROR("Write compressed data failed: %s", strerror(errno));
         return -1;
     }
+    return 0;
+}
+
+/* the cpus the caller may run on, a daemon limited by a cpuset starts no more jobs than it can run */
+static size_t parallel_jobs(void)
+{
+    cpu_set_t set;
+    int nprocs = 0;
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        nprocs = CPU_COUNT(&set);
+    }
+    if (nprocs < 1) {
+        nprocs = get_nprocs();
+    }
+    if (nprocs < 1) {
+        return 1;
+    }
+    return nprocs > GZIP_MAX_JOBS ? GZIP_MAX_JOBS : (size_t)nprocs;
+}
+
+struct gzip_job {
+    const unsigned char *dict;
+    size_t dict_len;
+    const unsigned char *in;
+    size_t in_len;
+    unsigned char *out;
+    size_t out_cap;
+    size_t out_len;
+    uLong crc;
+    int ret;
+};
+
+static void *gzip_job_run(void *arg)
+{
+    struct gzip_job *job = (struct gzip_job *)arg;
+    z_stream strm = { 0 };
+    size_t bound = 0;
+    unsigned char *out = NULL;
+
+    job->ret = -1;
+    job->crc = crc32(0L, job->in, job->in_len);
+
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return NULL;
+    }
+    if (job->dict_len > 0 && deflateSetDictionary(&strm, job->dict, job->dict_len) != Z_OK) {
+        goto out;
+    }
+
+    // room for the sync flush marker on top of the bound
+    bound = deflateBound(&strm, job->in_len) + 16;
+    if (job->out_cap < bound) {
+        out = realloc(job->out, bound);
+        if (out == NULL) {
+            goto out;
+        }
+        job->out = out;
+        job->out_cap = bound;
+    }
+
+    strm.next_in = (Bytef *)job->in;
+    strm.avail_in = job->in_len;
+    strm.next_out = job->out;
+    strm.avail_out = job->out_cap;
+    if (deflate(&strm, Z_SYNC_FLUSH) != Z_OK || strm.avail_in != 0) {
+        goto out;
+    }
+    job->out_len = job->out_cap - strm.avail_out;
+    job->ret = 0;
+
+out:
+    (void)deflateEnd(&strm);
+    return NULL;
+}
+
+static ssize_t read_full(int fd, unsigned char *buf, size_t len)
+{
+    size_t total = 0;
+    ssize_t n;
+
+    while (total < len) {
+        n = util_read_nointr(fd, buf + total, len - total);
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += (size_t)n;
+    }
+    return (ssize_t)total;
+}
+
+static void put_le32(unsigned char *buf, uint32_t val)
+{
+    buf[0] = val & 0xff;
+    buf[1] = (val >> 8) & 0xff;
+    buf[2] = (val >> 16) & 0xff;
+    buf[3] = (val >> 24) & 0xff;
+}
+
+static int run_gzip_jobs(struct gzip_job *jobs, size_t count)
+{
+    pthread_t tids[GZIP_MAX_JOBS];
+    bool started[GZIP_MAX_JOBS] = { false };
+    size_t i;
+    int ret = 0;
+
+    // the first job runs on the calling thread
+    for (i = 1; i < count; i++) {
+        started[i] = (pthread_create(&tids[i], NULL, gzip_job_run, &jobs[i]) == 0);
+    }
+    (void)gzip_job_run(&jobs[0]);
+    for (i = 1; i < count; i++) {
+        if (started[i]) {
+            (void)pthread_join(tids[i], NULL);
+        } else {
+            (void)gzip_job_run(&jobs[i]);
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (jobs[i].ret != 0) {
+            ERROR("Failed to deflate block");
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+static int gzip_compress(int srcfd, int dstfd)
+{
+    // magic, deflate, no flags, no mtime, no extra flags, unix
+    const unsigned char header[] = { 0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0x03 };
+    // an empty final block with fixed codes terminates the deflate stream
+    const unsigned char last_block[] = { 0x03, 0x00 };
+    unsigned char trailer[8] = { 0 };
+    struct gzip_job jobs[GZIP_MAX_JOBS] = { 0 };
+    size_t njobs = parallel_jobs();
+    size_t batch = njobs * GZIP_JOB_SIZE;
+    unsigned char *buf = NULL;
+    unsigned char *data = NULL;
+    size_t dict_len = 0;
+    size_t keep = 0;
+    size_t count = 0;
+    size_t i;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint32_t total = 0;
+    ssize_t nread;
+    int ret = -1;
 
-    buffer = util_common_calloc_s(BLKSIZE);
-    if (buffer == NULL) {
+    buf = util_common_calloc_s(GZIP_DICT_SIZE + batch);
+    if (buf == NULL) {
         ERROR("out of memory");
-        ret = -1;
+        return -1;
+    }
+    data = buf + GZIP_DICT_SIZE;
+
+    if (write_fd_all(dstfd, header, sizeof(header)) != 0) {
         goto out;
     }
 
     while (true) {
-        size = util_read_nointr(srcfd, buffer, BLKSIZE);
-        if (size < 0) {
-            ERROR("read file %s failed: %s", srcfile, strerror(errno));
-            ret = -1;
+        nread = read_full(srcfd, data, batch);
+        if (nread < 0) {
+            ERROR("Read data to compress failed: %s", strerror(errno));
+            goto out;
+        }
+        if (nread == 0) {
             break;
-        } else if (size == 0) {
+        }
+
+        count = ((size_t)nread + GZIP_JOB_SIZE - 1) / GZIP_JOB_SIZE;
+        for (i = 0; i < count; i++) {
+            jobs[i].in = data + i * GZIP_JOB_SIZE;
+            jobs[i].in_len = (i == count - 1) ? (size_t)nread - i * GZIP_JOB_SIZE : GZIP_JOB_SIZE;
+            jobs[i].dict_len = (i == 0) ? dict_len : GZIP_DICT_SIZE;
+            jobs[i].dict = jobs[i].in - jobs[i].dict_len;
+        }
+        if (run_gzip_jobs(jobs, count) != 0) {
+            goto out;
+        }
+        for (i = 0; i < count; i++) {
+            if (write_fd_all(dstfd, jobs[i].out, jobs[i].out_len) != 0) {
+                goto out;
+            }
+            crc = crc32_combine(crc, jobs[i].crc, (z_off_t)jobs[i].in_len);
+            total += (uint32_t)jobs[i].in_len;
+        }
+
+        // keep the tail of input as dictionary of the next batch
+        keep = dict_len + (size_t)nread;
+        keep = keep > GZIP_DICT_SIZE ? GZIP_DICT_SIZE : keep;
+        (void)memmove(data - keep, data + nread - keep, keep);
+        dict_len = keep;
+
+        if ((size_t)nread < batch) {
             break;
         }
+    }
+
+    if (write_fd_all(dstfd, last_block, sizeof(last_block)) != 0) {
+        goto out;
+    }
+    put_le32(trailer, (uint32_t)crc);
+    put_le32(trailer + 4, total);
+    if (write_fd_all(dstfd, trailer, sizeof(trailer)) != 0) {
+        goto out;
+    }
+    ret = 0;
+
+out:
+    for (i = 0; i < GZIP_MAX_JOBS; i++) {
+        free(jobs[i].out);
+    }
+    free(buf);
+    return ret;
+}
+
+// Decompress gzip members one after another, trailing data which is not a member is ignored like gzread does
+static int gzip_decompress(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer)
+{
+    z_stream strm = { 0 };
+    unsigned char *in = NULL;
+    unsigned char *out = NULL;
+    bool in_member = false;
+    bool need_input = true;
+    ssize_t n;
+    int zret;
+    int ret = -1;
 
-        n = gzwrite(stream, buffer, size);
-        if (n <= 0 || n != (size_t)size) {
-            gzerr = gzerror(stream, &errnum);
-            if (gzerr != NULL && strcmp(gzerr, "") != 0) {
-                ERROR("gzread error: %s", gzerr);
+    in = util_common_calloc_s(STREAM_BUF_SIZE);
+    out = util_common_calloc_s(STREAM_BUF_SIZE);
+    if (in == NULL || out == NULL) {
+        ERROR("out of memory");
+        goto free_out;
+    }
+
+    if (inflateInit2(&strm, MAX_WBITS + 16) != Z_OK) {
+        ERROR("Failed to init inflate");
+        goto free_out;
+    }
+
+    while (true) {
+        // a full output buffer may leave output pending in the stream, drain it before reading more
+        if (strm.avail_in == 0 && need_input) {
+            n = reader->read(reader->context, in, STREAM_BUF_SIZE);
+            if (n < 0) {
+                ERROR("Read gzip data failed");
+                goto out;
             }
-            ret = -1;
+            if (n == 0) {
+                break;
+            }
+            strm.next_in = in;
+            strm.avail_in = (uInt)n;
+        }
+        if (!in_member) {
+            if (strm.next_in[0] != 0x1F) {
+                break;
+            }
+            in_member = true;
+        }
+
+        strm.next_out = out;
+        strm.avail_out = STREAM_BUF_SIZE;
+        zret = inflate(&strm, Z_NO_FLUSH);
+        if (zret != Z_OK && zret != Z_STREAM_END && zret != Z_BUF_ERROR) {
+            ERROR("inflate error: %s", strm.msg != NULL ? strm.msg : "unknown");
+            goto out;
+        }
+        if (write_all(writer, out, STREAM_BUF_SIZE - strm.avail_out) != 0) {
+            goto out;
+        }
+        need_input = (strm.avail_out != 0);
+        if (zret == Z_STREAM_END) {
+            in_member = false;
+            need_input = true;
+            (void)inflateReset(&strm);
+        }
+    }
+
+    if (in_member) {
+        ERROR("inflate error: unexpected end of file");
+        goto out;
+    }
+    ret = 0;
+
+out:
+    (void)inflateEnd(&strm);
+free_out:
+    free(in);
+    free(out);
+    return ret;
+}
+
+#ifdef ENABLE_ZSTD
+static int zstd_compress(int srcfd, int dstfd)
+{
+    ZSTD_CCtx *cctx = NULL;
+    size_t in_size = ZSTD_CStreamInSize();
+    size_t out_size = ZSTD_CStreamOutSize();
+    unsigned char *in = NULL;
+    unsigned char *out = NULL;
+    ZSTD_EndDirective mode;
+    size_t remaining;
+    size_t njobs;
+    ssize_t n;
+    int ret = -1;
+
+    cctx = ZSTD_createCCtx();
+    in = util_common_calloc_s(in_size);
+    out = util_common_calloc_s(out_size);
+    if (cctx == NULL || in == NULL || out == NULL) {
+        ERROR("out of memory");
+        goto out;
+    }
+    (void)ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, ZSTD_CLEVEL_DEFAULT);
+    // compression runs on worker threads when libzstd supports it, ignored otherwise
+    njobs = parallel_jobs();
+    (void)ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, njobs > 1 ? (int)njobs : 0);
+
+    do {
+        n = util_read_nointr(srcfd, in, in_size);
+        if (n < 0) {
+            ERROR("Read data to compress failed: %s", strerror(errno));
+            goto out;
+        }
+        mode = (n == 0) ? ZSTD_e_end : ZSTD_e_continue;
+        ZSTD_inBuffer input = { in, (size_t)n, 0 };
+        do {
+            ZSTD_outBuffer output = { out, out_size, 0 };
+            remaining = ZSTD_compressStream2(cctx, &output, &input, mode);
+            if (ZSTD_isError(remaining)) {
+                ERROR("zstd compress error: %s", ZSTD_getErrorName(remaining));
+                goto out;
+            }
+            if (write_fd_all(dstfd, out, output.pos) != 0) {
+                goto out;
+            }
+        } while (mode == ZSTD_e_end ? remaining != 0 : input.pos != input.size);
+    } while (n != 0);
+    ret = 0;
+
+out:
+    ZSTD_freeCCtx(cctx);
+    free(in);
+    free(out);
+    return ret;
+}
+
+static int zstd_decompress(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer)
+{
+    ZSTD_DCtx *dctx = NULL;
+    size_t in_size = ZSTD_DStreamInSize();
+    size_t out_size = ZSTD_DStreamOutSize();
+    unsigned char *in = NULL;
+    unsigned char *out = NULL;
+    size_t last = 0;
+    ssize_t n;
+    int ret = -1;
+
+    dctx = ZSTD_createDCtx();
+    in = util_common_calloc_s(in_size);
+    out = util_common_calloc_s(out_size);
+    if (dctx == NULL || in == NULL || out == NULL) {
+        ERROR("out of memory");
+        goto out;
+    }
+
+    while (true) {
+        n = reader->read(reader->context, in, in_size);
+        if (n < 0) {
+            ERROR("Read zstd data failed");
+            goto out;
+        }
+        if (n == 0) {
             break;
         }
+        ZSTD_inBuffer input = { in, (size_t)n, 0 };
+        while (input.pos < input.size) {
+            ZSTD_outBuffer output = { out, out_size, 0 };
+            last = ZSTD_decompressStream(dctx, &output, &input);
+            if (ZSTD_isError(last)) {
+                ERROR("zstd decompress error: %s", ZSTD_getErrorName(last));
+                goto out;
+            }
+            if (write_all(writer, out, output.pos) != 0) {
+                goto out;
+            }
+        }
+    }
+
+    if (last != 0) {
+        ERROR("zstd decompress error: unexpected end of file");
+        goto out;
+    }
+    ret = 0;
+
+out:
+    ZSTD_freeDCtx(dctx);
+    free(in);
+    free(out);
+    return ret;
+}
+#endif
+
+static const struct compression_codec g_codecs[] = {
+    { COMPRESSION_GZIP, "gzip", gzip_compress, gzip_decompress },
+#ifdef ENABLE_ZSTD
+    { COMPRESSION_ZSTD, "zstd", zstd_compress, zstd_decompress },
+#endif
+};
+
+static const struct compression_codec *get_codec(compression_type_t type)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(g_codecs) / sizeof(g_codecs[0]); i++) {
+        if (g_codecs[i].type == type) {
+            return &g_codecs[i];
+        }
+    }
+    return NULL;
+}
+
+static compression_type_t detect_compression(const unsigned char *head, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(g_magics) / sizeof(g_magics[0]); i++) {
+        if (len >= g_magics[i].len && memcmp(head, g_magics[i].magic, g_magics[i].len) == 0) {
+            return g_magics[i].type;
+        }
+    }
+    return COMPRESSION_NONE;
+}
+
+bool util_compression_supported(compression_type_t type)
+{
+    return type == COMPRESSION_NONE || get_codec(type) != NULL;
+}
+
+int util_detect_compression(const char *filename, compression_type_t *type)
+{
+    unsigned char head[MAGIC_MAX_LEN] = { 0 };
+    ssize_t nread;
+    int fd;
+
+    if (filename == NULL || type == NULL) {
+        return -1;
+    }
+
+    fd = util_open(filename, O_RDONLY, 0);
+    if (fd < 0) {
+        ERROR("Failed to open file %s: %s", filename, strerror(errno));
+        return -1;
+    }
+    nread = read_full(fd, head, sizeof(head));
+    close(fd);
+    if (nread < 0) {
+        ERROR("Failed to read file %s: %s", filename, strerror(errno));
+        return -1;
+    }
+
+    *type = detect_compression(head, (size_t)nread);
+    return 0;
+}
+
+int util_compress_file(compression_type_t type, const char *srcfile, const char *dstfile, const mode_t mode)
+{
+    int ret = 0;
+    int srcfd = -1;
+    int dstfd = -1;
+    const struct compression_codec *codec = get_codec(type);
+
+    if (codec == NULL) {
+        ERROR("Unsupported compression type %d", (int)type);
+        return -1;
+    }
+
+    srcfd = util_open(srcfile, O_RDONLY, SECURE_CONFIG_FILE_MODE);
+    if (srcfd < 0) {
+        ERROR("Open src file: %s, failed: %s", srcfile, strerror(errno));
+        return -1;
+    }
+
+    dstfd = util_open(dstfile, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (dstfd < 0) {
+        ERROR("Open dst file: %s, failed: %s", dstfile, strerror(errno));
+        close(srcfd);
+        return -1;
+    }
+
+    ret = codec->compress(srcfd, dstfd);
+    if (ret != 0) {
+        ERROR("%s compress %s failed", codec->name, srcfile);
     }
     if (chmod(dstfile, mode) != 0) {
-        ERROR("Change mode of tar-split file");
+        ERROR("Change mode of %s failed", dstfile);
         ret = -1;
     }
 
-out:
-    gzclose(stream);
+    close(dstfd);
     close(srcfd);
-    free(buffer);
     if (ret != 0) {
         if (util_path_remove(dstfile) != 0) {
             ERROR("Remove file %s failed: %s", dstfile, strerror(errno));
@@ -93,58 +601,158 @@ out:
     return ret;
 }
 
-// Decompress
-int util_gzip_d(const char *srcfile, const FILE *dstfp)
+// Compress
+int util_gzip_z(const char *srcfile, const char *dstfile, const mode_t mode)
 {
-    gzFile stream = NULL;
-    const char *gzerr = NULL;
-    int errnum = 0;
-    int ret = 0;
-    size_t size = 0;
-    void *buffer = NULL;
-    size_t n = 0;
+    return util_compress_file(COMPRESSION_GZIP, srcfile, dstfile, mode);
+}
 
-    stream = gzopen(srcfile, "r");
-    if (stream == NULL) {
-        ERROR("gzopen %s failed: %s", srcfile, strerror(errno));
-        return -1;
+struct head_reader {
+    const struct io_read_wrapper *reader;
+    const unsigned char *head;
+    size_t len;
+    size_t off;
+};
+
+// serve the bytes used to detect compression before the rest of the stream
+static ssize_t head_read(void *context, void *buf, size_t len)
+{
+    struct head_reader *hr = (struct head_reader *)context;
+    size_t n;
+
+    if (hr->off < hr->len) {
+        n = hr->len - hr->off;
+        n = n < len ? n : len;
+        (void)memcpy(buf, hr->head + hr->off, n);
+        hr->off += n;
+        return (ssize_t)n;
     }
+    return hr->reader->read(hr->reader->context, buf, len);
+}
 
-    buffer = util_common_calloc_s(BLKSIZE);
-    if (buffer == NULL) {
+static int copy_stream(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer)
+{
+    unsigned char *buf = NULL;
+    ssize_t n;
+    int ret = 0;
+
+    buf = util_common_calloc_s(STREAM_BUF_SIZE);
+    if (buf == NULL) {
         ERROR("out of memory");
-        ret = -1;
-        goto out;
+        return -1;
     }
-
     while (true) {
-        n = gzread(stream, buffer, BLKSIZE);
-        if (n <= 0) {
-            gzerr = gzerror(stream, &errnum);
-            if (gzerr != NULL && strcmp(gzerr, "") != 0) {
-                ERROR("gzread error: %s", gzerr);
-                ret = -1;
-            }
+        n = reader->read(reader->context, buf, STREAM_BUF_SIZE);
+        if (n < 0) {
+            ERROR("Read data failed");
+            ret = -1;
             break;
         }
-
-        if (n > 0) {
-            size = fwrite(buffer, 1, n, (FILE *)dstfp);
-            if (size != n) {
-                ret = -1;
-                ERROR("Write file failed: %s", strerror(errno));
-                break;
-            }
+        if (n == 0) {
+            break;
         }
+        if (write_all(writer, buf, (size_t)n) != 0) {
+            ret = -1;
+            break;
+        }
+    }
+    free(buf);
+    return ret;
+}
+
+int util_decompress_stream(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer)
+{
+    unsigned char head[MAGIC_MAX_LEN] = { 0 };
+    size_t head_len = 0;
+    ssize_t n;
+    compression_type_t type;
+    const struct compression_codec *codec = NULL;
+    struct head_reader hr = { 0 };
+    struct io_read_wrapper wrapped = { 0 };
+
+    if (reader == NULL || reader->read == NULL || writer == NULL || writer->write_func == NULL) {
+        return -1;
+    }
 
-        if (gzeof(stream)) {
+    while (head_len < sizeof(head)) {
+        n = reader->read(reader->context, head + head_len, sizeof(head) - head_len);
+        if (n < 0) {
+            ERROR("Read data failed");
+            return -1;
+        }
+        if (n == 0) {
             break;
         }
+        head_len += (size_t)n;
     }
 
-out:
-    gzclose(stream);
-    free(buffer);
+    hr.reader = reader;
+    hr.head = head;
+    hr.len = head_len;
+    wrapped.context = &hr;
+    wrapped.read = head_read;
+
+    type = detect_compression(head, head_len);
+    if (type == COMPRESSION_NONE) {
+        return copy_stream(&wrapped, writer);
+    }
+
+    codec = get_codec(type);
+    if (codec == NULL) {
+        ERROR("Data is compressed in a format not supported by this build");
+        return -1;
+    }
+    return codec->decompress(&wrapped, writer);
+}
+
+static ssize_t fd_read(void *context, void *buf, size_t len)
+{
+    return util_read_nointr(*(int *)context, buf, len);
+}
+
+int util_decompress_file(const char *srcfile, const struct io_write_wrapper *writer)
+{
+    int fd = -1;
+    int ret = 0;
+    struct io_read_wrapper reader = { 0 };
+
+    if (srcfile == NULL) {
+        return -1;
+    }
+
+    fd = util_open(srcfile, O_RDONLY, 0);
+    if (fd < 0) {
+        ERROR("Open %s failed: %s", srcfile, strerror(errno));
+        return -1;
+    }
+    reader.context = &fd;
+    reader.read = fd_read;
+
+    ret = util_decompress_stream(&reader, writer);
+    close(fd);
+    return ret;
+}
+
+static ssize_t file_write(void *context, const void *data, size_t len)
+{
+    size_t size = fwrite(data, 1, len, (FILE *)context);
+    if (size != len) {
+        ERROR("Write file failed: %s", strerror(errno));
+        return -1;
+    }
+    return (ssize_t)size;
+}
+
+// Decompress
+int util_gzip_d(const char *srcfile, const FILE *dstfp)
+{
+    int ret = 0;
+    struct io_write_wrapper writer = { 0 };
+
+    writer.context = (void *)dstfp;
+    writer.write_func = file_write;
+
+    ret = util_decompress_file(srcfile, &writer);
     if (ret == 0) {
         (void)fflush((FILE *)dstfp);
     }
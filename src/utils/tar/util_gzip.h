@@ -1,5 +1,5 @@
 /******************************************************************************
- * Copyright (c) Huawei Technologies Co., Ltd. 2020. All rights reserved.
+ * Copyright (c) Huawei Technologies Co., Ltd. 2018-2019. All rights reserved.
  * iSulad licensed under the Mulan PSL v2.
  * You can use this software according to the terms and conditions of the Mulan PSL v2.
  * You may obtain a copy of Mulan PSL v2 at:
@@ -11,23 +11,48 @@
  * Author: wangfengtu
  * Create: 2020-07-13
  * Description: provide tar function definition
- *********************************************************************************/
+ ********************************************************************************/
 #ifndef UTILS_TAR_UTIL_GZIP_H
 #define UTILS_TAR_UTIL_GZIP_H
 
 #include <stdio.h>
+#include <stdbool.h>
 #include <sys/types.h>
 
+#include "io_wrapper.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef enum {
+    COMPRESSION_NONE = 0,
+    COMPRESSION_GZIP,
+    COMPRESSION_ZSTD,
+} compression_type_t;
+
 // Compress
 int util_gzip_z(const char *srcfile, const char *dstfile, const mode_t mode);
 
 // Decompress
 int util_gzip_d(const char *srcfile, const FILE *destfp);
 
+// Detect compression of file by its magic number
+int util_detect_compression(const char *filename, compression_type_t *type);
+
+// Whether this build has a codec for type
+bool util_compression_supported(compression_type_t type);
+
+// Compress srcfile into dstfile with the codec of type
+int util_compress_file(compression_type_t type, const char *srcfile, const char *dstfile, const mode_t mode);
+
+// Decompress data read from reader into writer, compression is detected from the data,
+// and data in no known compression format is copied as it is
+int util_decompress_stream(const struct io_read_wrapper *reader, const struct io_write_wrapper *writer);
+
+// Same as util_decompress_stream, read from file srcfile
+int util_decompress_file(const char *srcfile, const struct io_write_wrapper *writer);
+
 #ifdef __cplusplus
 }
 #endif
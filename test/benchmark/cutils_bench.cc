@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: benchmark of common utils
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "map.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_base64.h"
+#include "utils_file.h"
+#include "utils_string.h"
+#include "utils_timestamp.h"
+#include "filters.h"
+#include "sha256.h"
+#include "util_gzip.h"
+
+namespace {
+// 64 hex chars, like container and image ids
+std::vector<std::string> MakeIds(size_t count)
+{
+    std::vector<std::string> ids;
+    std::mt19937 gen(1);
+
+    ids.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::string id;
+        for (int j = 0; j < 64; j++) {
+            id.push_back("0123456789abcdef"[gen() % 16]);
+        }
+        ids.push_back(id);
+    }
+    return ids;
+}
+
+void KeyFree(void *key, void *value)
+{
+    (void)value;
+    free(key);
+}
+
+map_t *NewIdMap(bool hash)
+{
+    return hash ? map_new_hash(MAP_STR_PTR, KeyFree) : map_new(MAP_STR_PTR, MAP_DEFAULT_CMP_FUNC, KeyFree);
+}
+
+// arg 0: number of ids, arg 1: 1 for the hash backend, 0 for the rb tree
+void BM_MapInsertRemove(benchmark::State &state)
+{
+    std::vector<std::string> ids = MakeIds(state.range(0));
+
+    for (auto _ : state) {
+        map_t *map = NewIdMap(state.range(1) != 0);
+        for (auto &id : ids) {
+            map_insert(map, (void *)id.c_str(), (void *)id.c_str());
+        }
+        for (auto &id : ids) {
+            map_remove(map, (void *)id.c_str());
+        }
+        map_free(map);
+    }
+    state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_MapInsertRemove)->Args({ 1000, 0 })->Args({ 1000, 1 })->Args({ 100000, 0 })->Args({ 100000, 1 });
+
+void BM_MapSearch(benchmark::State &state)
+{
+    std::vector<std::string> ids = MakeIds(state.range(0));
+    map_t *map = NewIdMap(state.range(1) != 0);
+    size_t i = 0;
+
+    for (auto &id : ids) {
+        map_insert(map, (void *)id.c_str(), (void *)id.c_str());
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(map_search(map, (void *)ids[i].c_str()));
+        i = (i + 7919) % ids.size();
+    }
+    map_free(map);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MapSearch)->Args({ 1000, 0 })->Args({ 1000, 1 })->Args({ 100000, 0 })->Args({ 100000, 1 });
+
+void BM_MapIterate(benchmark::State &state)
+{
+    std::vector<std::string> ids = MakeIds(state.range(0));
+    map_t *map = NewIdMap(state.range(1) != 0);
+
+    for (auto &id : ids) {
+        map_insert(map, (void *)id.c_str(), (void *)id.c_str());
+    }
+    for (auto _ : state) {
+        map_itor *itor = map_itor_new(map);
+        for (; map_itor_valid(itor); map_itor_next(itor)) {
+            benchmark::DoNotOptimize(map_itor_value(itor));
+        }
+        map_itor_free(itor);
+    }
+    map_free(map);
+    state.SetItemsProcessed(state.iterations() * ids.size());
+}
+BENCHMARK(BM_MapIterate)->Args({ 10000, 0 })->Args({ 10000, 1 });
+
+void BM_StringSplit(benchmark::State &state)
+{
+    // like PATH or a list of mount options
+    std::string src;
+    for (int i = 0; i < state.range(0); i++) {
+        src += (i == 0 ? "" : ":") + std::string("/usr/local/sbin") + std::to_string(i);
+    }
+
+    for (auto _ : state) {
+        char **parts = util_string_split(src.c_str(), ':');
+        benchmark::DoNotOptimize(parts);
+        util_free_array(parts);
+    }
+    state.SetBytesProcessed(state.iterations() * src.size());
+}
+BENCHMARK(BM_StringSplit)->Arg(8)->Arg(256);
+
+void BM_StringJoin(benchmark::State &state)
+{
+    std::vector<std::string> ids = MakeIds(state.range(0));
+    std::vector<const char *> parts;
+
+    for (auto &id : ids) {
+        parts.push_back(id.c_str());
+    }
+    for (auto _ : state) {
+        char *joined = util_string_join(",", parts.data(), parts.size());
+        benchmark::DoNotOptimize(joined);
+        free(joined);
+    }
+    state.SetItemsProcessed(state.iterations() * parts.size());
+}
+BENCHMARK(BM_StringJoin)->Arg(8)->Arg(256);
+
+void BM_Base64Encode(benchmark::State &state)
+{
+    std::vector<unsigned char> bytes(state.range(0), 0x5a);
+
+    for (auto _ : state) {
+        char *out = nullptr;
+        util_base64_encode(bytes.data(), bytes.size(), &out);
+        benchmark::DoNotOptimize(out);
+        free(out);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+}
+BENCHMARK(BM_Base64Encode)->Arg(64)->Arg(64 * 1024);
+
+void BM_Base64Decode(benchmark::State &state)
+{
+    std::vector<unsigned char> bytes(state.range(0), 0x5a);
+    char *encoded = nullptr;
+
+    util_base64_encode(bytes.data(), bytes.size(), &encoded);
+    for (auto _ : state) {
+        unsigned char *out = nullptr;
+        size_t out_len = 0;
+        util_base64_decode(encoded, strlen(encoded), &out, &out_len);
+        benchmark::DoNotOptimize(out);
+        free(out);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes.size());
+    free(encoded);
+}
+BENCHMARK(BM_Base64Decode)->Arg(64)->Arg(64 * 1024);
+
+void BM_TimestampParse(benchmark::State &state)
+{
+    for (auto _ : state) {
+        int64_t nanos = 0;
+        util_to_unix_nanos_from_str("2020-11-20T08:30:12.123456789Z", &nanos);
+        benchmark::DoNotOptimize(nanos);
+    }
+}
+BENCHMARK(BM_TimestampParse);
+
+void BM_TimestampToBuffer(benchmark::State &state)
+{
+    types_timestamp_t timestamp = { 0 };
+    char buffer[TIME_STR_SIZE] = { 0 };
+
+    util_get_now_time_stamp(&timestamp);
+    for (auto _ : state) {
+        util_get_time_buffer(&timestamp, buffer, sizeof(buffer));
+        benchmark::DoNotOptimize(buffer);
+    }
+}
+BENCHMARK(BM_TimestampToBuffer);
+
+// the label filters of a cri list, matched against the labels of one container
+void BM_FiltersMatchLabels(benchmark::State &state)
+{
+    struct filters_args *filters = filters_args_new();
+    map_t *labels = map_new(MAP_STR_STR, MAP_DEFAULT_CMP_FUNC, MAP_DEFAULT_FREE_FUNC);
+    const char *keys[] = { "io.kubernetes.pod.name", "io.kubernetes.pod.namespace", "io.kubernetes.pod.uid",
+                           "io.kubernetes.container.name", "io.kubernetes.docker.type" };
+    const char *values[] = { "nginx-7db9fccd9b-x2k4t", "default", "3b1c3f06-4f5c-4b7a-9f3e-0a6d0c0f2a11", "nginx",
+                             "container" };
+
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        map_replace(labels, (void *)keys[i], (void *)values[i]);
+    }
+    filters_args_add(filters, "label", "io.kubernetes.pod.uid=3b1c3f06-4f5c-4b7a-9f3e-0a6d0c0f2a11");
+    filters_args_add(filters, "label", "io.kubernetes.docker.type=container");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filters_args_match_kv_list(filters, "label", labels));
+    }
+    map_free(labels);
+    filters_args_free(filters);
+}
+BENCHMARK(BM_FiltersMatchLabels);
+
+void BM_FiltersMatchId(benchmark::State &state)
+{
+    std::vector<std::string> ids = MakeIds(2);
+    struct filters_args *filters = filters_args_new();
+
+    filters_args_add(filters, "id", ids[0].substr(0, 12).c_str());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(filters_args_match(filters, "id", ids[1].c_str()));
+    }
+    filters_args_free(filters);
+}
+BENCHMARK(BM_FiltersMatchId);
+
+void BM_Sha256DigestStr(benchmark::State &state)
+{
+    std::string data(state.range(0), 'x');
+
+    for (auto _ : state) {
+        char *digest = sha256_digest_str(data.c_str());
+        benchmark::DoNotOptimize(digest);
+        free(digest);
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_Sha256DigestStr)->Arg(1024)->Arg(1024 * 1024);
+
+class GzipFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State &state) override
+    {
+        char tmpl[] = "/tmp/isulad_bench_XXXXXX";
+        std::string content;
+
+        dir = mkdtemp(tmpl);
+        src = dir + "/layer.tar";
+        dst = dir + "/layer.tar.gz";
+        // half compressible, like a layer of text and binaries
+        std::mt19937 gen(1);
+        for (int64_t i = 0; i < state.range(0); i++) {
+            content.push_back((i % 2 == 0) ? 'a' : (char)(gen() & 0xff));
+        }
+        util_write_file(src.c_str(), content.c_str(), content.size(), 0600);
+        util_gzip_z(src.c_str(), dst.c_str(), 0600);
+    }
+
+    void TearDown(const ::benchmark::State &state) override
+    {
+        (void)state;
+        util_recursive_rmdir(dir.c_str(), 0);
+    }
+
+    std::string dir;
+    std::string src;
+    std::string dst;
+};
+
+BENCHMARK_DEFINE_F(GzipFixture, BM_GzipCompress)(benchmark::State &state)
+{
+    std::string out = dir + "/out.gz";
+
+    for (auto _ : state) {
+        util_gzip_z(src.c_str(), out.c_str(), 0600);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_REGISTER_F(GzipFixture, BM_GzipCompress)->Arg(4 * 1024 * 1024)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(GzipFixture, BM_GzipDecompress)(benchmark::State &state)
+{
+    for (auto _ : state) {
+        FILE *fp = fopen("/dev/null", "w");
+        util_gzip_d(dst.c_str(), fp);
+        fclose(fp);
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_REGISTER_F(GzipFixture, BM_GzipDecompress)->Arg(4 * 1024 * 1024)->Unit(benchmark::kMillisecond);
+} // namespace
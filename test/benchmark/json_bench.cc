@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: benchmark of the json parsers and generators of the container configs
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "utils.h"
+#include "utils_file.h"
+#include "isula_libutils/container_config_v2.h"
+#include "isula_libutils/host_config.h"
+#include "isula_libutils/oci_runtime_spec.h"
+
+// BENCHMARK_DATA_DIR and SPECS_DATA_DIR are set by CMakeLists.txt
+#define CONFIG_V2_FILE BENCHMARK_DATA_DIR "/config.v2.json"
+#define HOST_CONFIG_FILE BENCHMARK_DATA_DIR "/hostconfig.json"
+#define OCI_RUNTIME_SPEC_FILE SPECS_DATA_DIR "/oci_runtime_spec.json"
+
+namespace {
+std::string ReadJson(benchmark::State &state, const char *path)
+{
+    char *content = util_read_text_file(path);
+    std::string json;
+
+    if (content == nullptr) {
+        state.SkipWithError("failed to read json file");
+        return json;
+    }
+    json = content;
+    free(content);
+    return json;
+}
+
+/*
+ * The parse and generate benchmarks of one type, the same options as the daemon uses
+ * when it loads and saves the configs of containers.
+ */
+#define JSON_BENCHMARKS(type, file)                                                    \
+    void BM_##type##_parse(benchmark::State &state)                                    \
+    {                                                                                  \
+        std::string json = ReadJson(state, file);                                      \
+        for (auto _ : state) {                                                         \
+            parser_error err = nullptr;                                                \
+            type *obj = type##_parse_data(json.c_str(), nullptr, &err);                \
+            benchmark::DoNotOptimize(obj);                                             \
+            free_##type(obj);                                                          \
+            free(err);                                                                 \
+        }                                                                              \
+        state.SetBytesProcessed(state.iterations() * json.size());                     \
+    }                                                                                  \
+    BENCHMARK(BM_##type##_parse);                                                      \
+                                                                                       \
+    void BM_##type##_generate(benchmark::State &state)                                 \
+    {                                                                                  \
+        std::string json = ReadJson(state, file);                                      \
+        struct parser_context ctx = { OPT_GEN_SIMPLIFY, 0 };                           \
+        parser_error err = nullptr;                                                    \
+        type *obj = type##_parse_data(json.c_str(), nullptr, &err);                    \
+        free(err);                                                                     \
+        if (obj == nullptr) {                                                          \
+            state.SkipWithError("failed to parse json file");                          \
+            return;                                                                    \
+        }                                                                              \
+        for (auto _ : state) {                                                         \
+            err = nullptr;                                                             \
+            char *out = type##_generate_json(obj, &ctx, &err);                         \
+            benchmark::DoNotOptimize(out);                                             \
+            free(out);                                                                 \
+            free(err);                                                                 \
+        }                                                                              \
+        free_##type(obj);                                                              \
+        state.SetBytesProcessed(state.iterations() * json.size());                     \
+    }                                                                                  \
+    BENCHMARK(BM_##type##_generate);
+
+JSON_BENCHMARKS(container_config_v2, CONFIG_V2_FILE)
+JSON_BENCHMARKS(host_config, HOST_CONFIG_FILE)
+JSON_BENCHMARKS(oci_runtime_spec, OCI_RUNTIME_SPEC_FILE)
+} // namespace
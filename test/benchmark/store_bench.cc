@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: benchmark of the container and image stores
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "container_api.h"
+#include "image_store.h"
+#include "storage.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "utils_file.h"
+#include "util_atomic.h"
+#include "isula_libutils/imagetool_images_list.h"
+
+// the store only needs the reference counting of container_unix.c
+void container_refinc(container_t *cont)
+{
+    if (cont == NULL) {
+        return;
+    }
+    atomic_int_inc(&cont->refcnt);
+}
+
+void container_unref(container_t *cont)
+{
+    if (cont == NULL || !atomic_int_dec_test(&cont->refcnt)) {
+        return;
+    }
+    free_container_config_v2_common_config(cont->common_config);
+    free(cont);
+}
+
+namespace {
+std::string MakeId(std::mt19937 &gen)
+{
+    std::string id;
+
+    for (int j = 0; j < 64; j++) {
+        id.push_back("0123456789abcdef"[gen() % 16]);
+    }
+    return id;
+}
+
+container_t *NewContainer(const std::string &id, size_t index)
+{
+    container_t *cont = (container_t *)util_common_calloc_s(sizeof(container_t));
+    container_config_v2_common_config *common_config =
+        (container_config_v2_common_config *)util_common_calloc_s(sizeof(container_config_v2_common_config));
+    container_config *config = (container_config *)util_common_calloc_s(sizeof(container_config));
+    json_map_string_string *labels = (json_map_string_string *)util_common_calloc_s(sizeof(json_map_string_string));
+
+    // a pod of 4 containers, as the cri creates them
+    append_json_map_string_string(labels, "io.kubernetes.pod.uid", ("pod-" + std::to_string(index / 4)).c_str());
+    append_json_map_string_string(labels, "io.kubernetes.docker.type", index % 4 == 0 ? "podsandbox" : "container");
+    config->labels = labels;
+    common_config->id = util_strdup_s(id.c_str());
+    common_config->name = util_strdup_s(("bench-" + std::to_string(index)).c_str());
+    common_config->config = config;
+    cont->common_config = common_config;
+    cont->refcnt = 1;
+    return cont;
+}
+
+// arg 0: number of containers in the store
+class ContainersStoreFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State &state) override
+    {
+        // the stores are global and have no free, the fixture empties them in TearDown
+        static bool inited = (containers_store_init() == 0 && container_name_index_init() == 0);
+        std::mt19937 gen(1);
+
+        if (!inited) {
+            return;
+        }
+        for (int64_t i = 0; i < state.range(0); i++) {
+            std::string id = MakeId(gen);
+            container_t *cont = NewContainer(id, (size_t)i);
+            if (!containers_store_add(id.c_str(), cont)) {
+                container_unref(cont);
+                continue;
+            }
+            (void)container_name_index_add(cont->common_config->name, id.c_str());
+            ids.push_back(id);
+        }
+    }
+
+    void TearDown(const ::benchmark::State &state) override
+    {
+        (void)state;
+        for (auto &id : ids) {
+            container_t *cont = containers_store_get(id.c_str());
+            if (cont != nullptr) {
+                (void)container_name_index_remove(cont->common_config->name);
+                container_unref(cont);
+            }
+            (void)containers_store_remove(id.c_str());
+        }
+        ids.clear();
+    }
+
+    std::vector<std::string> ids;
+};
+
+BENCHMARK_DEFINE_F(ContainersStoreFixture, BM_ContainersStoreGetById)(benchmark::State &state)
+{
+    size_t i = 0;
+
+    if (ids.empty()) {
+        state.SkipWithError("containers store init failed");
+        return;
+    }
+    for (auto _ : state) {
+        container_t *cont = containers_store_get(ids[i].c_str());
+        benchmark::DoNotOptimize(cont);
+        container_unref(cont);
+        i = (i + 7919) % ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(ContainersStoreFixture, BM_ContainersStoreGetById)->Arg(100)->Arg(10000);
+
+BENCHMARK_DEFINE_F(ContainersStoreFixture, BM_ContainersStoreGetByShortId)(benchmark::State &state)
+{
+    std::vector<std::string> short_ids;
+    size_t i = 0;
+
+    if (ids.empty()) {
+        state.SkipWithError("containers store init failed");
+        return;
+    }
+    for (auto &id : ids) {
+        short_ids.push_back(id.substr(0, 12));
+    }
+    for (auto _ : state) {
+        container_t *cont = containers_store_get(short_ids[i].c_str());
+        benchmark::DoNotOptimize(cont);
+        container_unref(cont);
+        i = (i + 7919) % short_ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(ContainersStoreFixture, BM_ContainersStoreGetByShortId)->Arg(100)->Arg(10000);
+
+BENCHMARK_DEFINE_F(ContainersStoreFixture, BM_ContainersStoreGetByName)(benchmark::State &state)
+{
+    size_t i = 0;
+
+    if (ids.empty()) {
+        state.SkipWithError("containers store init failed");
+        return;
+    }
+    for (auto _ : state) {
+        container_t *cont = containers_store_get(("bench-" + std::to_string(i)).c_str());
+        benchmark::DoNotOptimize(cont);
+        container_unref(cont);
+        i = (i + 7919) % ids.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_REGISTER_F(ContainersStoreFixture, BM_ContainersStoreGetByName)->Arg(100)->Arg(10000);
+
+BENCHMARK_DEFINE_F(ContainersStoreFixture, BM_ContainersStoreListByLabels)(benchmark::State &state)
+{
+    const char *labels[] = { "io.kubernetes.pod.uid=pod-1", "io.kubernetes.docker.type=container" };
+
+    for (auto _ : state) {
+        char **found = nullptr;
+        (void)containers_store_list_ids_by_labels(labels, sizeof(labels) / sizeof(labels[0]), &found);
+        benchmark::DoNotOptimize(found);
+        util_free_array(found);
+    }
+}
+BENCHMARK_REGISTER_F(ContainersStoreFixture, BM_ContainersStoreListByLabels)->Arg(100)->Arg(10000);
+
+// arg 0: number of images in the store
+class ImageStoreFixture : public benchmark::Fixture {
+public:
+    void SetUp(const ::benchmark::State &state) override
+    {
+        char tmpl[] = "/tmp/isulad_bench_XXXXXX";
+        struct storage_module_init_options opts = { 0 };
+        types_timestamp_t now = { 0 };
+        std::mt19937 gen(1);
+
+        dir = mkdtemp(tmpl);
+        opts.storage_root = util_strdup_s(dir.c_str());
+        opts.driver_name = util_strdup_s("overlay");
+        ready = (image_store_init(&opts) == 0);
+        free(opts.storage_root);
+        free(opts.driver_name);
+        if (!ready) {
+            return;
+        }
+
+        (void)util_get_now_time_stamp(&now);
+        for (int64_t i = 0; i < state.range(0); i++) {
+            std::string id = MakeId(gen);
+            std::string name = "bench/image-" + std::to_string(i) + ":latest";
+            const char *names[] = { name.c_str() };
+            std::string layer = MakeId(gen);
+            char *created = image_store_create(id.c_str(), names, 1, layer.c_str(), "{}", &now, nullptr);
+            free(created);
+        }
+    }
+
+    void TearDown(const ::benchmark::State &state) override
+    {
+        (void)state;
+        if (ready) {
+            image_store_free();
+        }
+        (void)util_recursive_rmdir(dir.c_str(), 0);
+    }
+
+    std::string dir;
+    bool ready { false };
+};
+
+BENCHMARK_DEFINE_F(ImageStoreFixture, BM_ImageStoreGetAllImages)(benchmark::State &state)
+{
+    if (!ready) {
+        state.SkipWithError("image store init failed");
+        return;
+    }
+    for (auto _ : state) {
+        imagetool_images_list *images = (imagetool_images_list *)util_common_calloc_s(sizeof(imagetool_images_list));
+        (void)image_store_get_all_images(images);
+        benchmark::DoNotOptimize(images);
+        free_imagetool_images_list(images);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_REGISTER_F(ImageStoreFixture, BM_ImageStoreGetAllImages)->Arg(100)->Arg(1000)->Unit(benchmark::kMicrosecond);
+} // namespace
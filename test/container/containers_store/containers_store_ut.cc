@@ -0,0 +1,214 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide containers store label index unit test
+ ******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "container_api.h"
+#include "map.h"
+#include "utils.h"
+#include "utils_array.h"
+#include "util_atomic.h"
+
+// the store only needs the reference counting of container_unix.c
+void container_refinc(container_t *cont)
+{
+    if (cont == NULL) {
+        return;
+    }
+    atomic_int_inc(&cont->refcnt);
+}
+
+void container_unref(container_t *cont)
+{
+    if (cont == NULL || !atomic_int_dec_test(&cont->refcnt)) {
+        return;
+    }
+    free_container_config_v2_common_config(cont->common_config);
+    free(cont);
+}
+
+static bool g_map_new_hash_fail = false;
+
+extern "C" {
+    map_t *__real_map_new_hash(map_type_t kvtype, map_kvfree_func kvfree);
+
+    map_t *__wrap_map_new_hash(map_type_t kvtype, map_kvfree_func kvfree)
+    {
+        if (g_map_new_hash_fail) {
+            return nullptr;
+        }
+        return __real_map_new_hash(kvtype, kvfree);
+    }
+}
+
+namespace {
+typedef std::vector<std::pair<std::string, std::string>> Labels;
+
+container_t *NewContainer(const std::string &id, const Labels &labels)
+{
+    container_t *cont = (container_t *)util_common_calloc_s(sizeof(container_t));
+    container_config_v2_common_config *common_config =
+        (container_config_v2_common_config *)util_common_calloc_s(sizeof(container_config_v2_common_config));
+    container_config *config = (container_config *)util_common_calloc_s(sizeof(container_config));
+    json_map_string_string *map = (json_map_string_string *)util_common_calloc_s(sizeof(json_map_string_string));
+
+    for (const auto &label : labels) {
+        (void)append_json_map_string_string(map, label.first.c_str(), label.second.c_str());
+    }
+    config->labels = map;
+    common_config->id = util_strdup_s(id.c_str());
+    common_config->name = util_strdup_s(("ut-" + id).c_str());
+    common_config->config = config;
+    cont->common_config = common_config;
+    cont->refcnt = 1;
+    return cont;
+}
+
+void Add(const std::string &id, const Labels &labels)
+{
+    container_t *cont = NewContainer(id, labels);
+
+    ASSERT_TRUE(containers_store_add(id.c_str(), cont));
+}
+
+// sorted ids listed by labels, ret gets the return of the store
+std::vector<std::string> ListByLabels(const std::vector<const char *> &labels, int *ret = nullptr)
+{
+    std::vector<std::string> result;
+    char **ids = nullptr;
+    int nret = containers_store_list_ids_by_labels((const char **)labels.data(), labels.size(), &ids);
+
+    if (ret != nullptr) {
+        *ret = nret;
+    }
+    for (size_t i = 0; ids != nullptr && ids[i] != nullptr; i++) {
+        result.push_back(ids[i]);
+    }
+    util_free_array(ids);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<std::string> Ids(std::initializer_list<std::string> ids)
+{
+    return std::vector<std::string>(ids);
+}
+} // namespace
+
+class ContainersStoreUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        // the store is global and has no free, tests remove what they add
+        ASSERT_EQ(containers_store_init(), 0);
+    }
+
+    void TearDown() override
+    {
+        char **ids = containers_store_list_ids();
+
+        for (size_t i = 0; ids != nullptr && ids[i] != nullptr; i++) {
+            (void)containers_store_remove(ids[i]);
+        }
+        util_free_array(ids);
+        g_map_new_hash_fail = false;
+    }
+};
+
+TEST_F(ContainersStoreUnitTest, test_list_by_labels)
+{
+    int ret = -1;
+
+    Add("c1", { { "app", "web" }, { "tier", "front" } });
+    Add("c2", { { "app", "web" }, { "tier", "back" } });
+    Add("c3", { { "app", "db" }, { "empty", "" } });
+    Add("c4", {});
+
+    ASSERT_EQ(ListByLabels({ "app" }), Ids({ "c1", "c2", "c3" }));
+    ASSERT_EQ(ListByLabels({ "app=web" }), Ids({ "c1", "c2" }));
+    ASSERT_EQ(ListByLabels({ "app=web", "tier=back" }), Ids({ "c2" }));
+    ASSERT_EQ(ListByLabels({ "tier", "app=db" }), Ids({}));
+    ASSERT_EQ(ListByLabels({ "empty" }), Ids({ "c3" }));
+    ASSERT_EQ(ListByLabels({ "empty=" }), Ids({ "c3" }));
+
+    // no container has the label
+    ASSERT_EQ(ListByLabels({ "app=cache" }, &ret), Ids({}));
+    ASSERT_EQ(ret, 0);
+    ASSERT_EQ(ListByLabels({ "app", "missing" }, &ret), Ids({}));
+    ASSERT_EQ(ret, 0);
+}
+
+TEST_F(ContainersStoreUnitTest, test_replace_updates_labels)
+{
+    Add("c1", { { "app", "web" }, { "old", "1" } });
+    Add("c2", { { "app", "web" } });
+    ASSERT_EQ(ListByLabels({ "old" }), Ids({ "c1" }));
+
+    // the same id added again, as a container loaded again
+    Add("c1", { { "app", "db" }, { "new", "1" } });
+    ASSERT_EQ(ListByLabels({ "app=web" }), Ids({ "c2" }));
+    ASSERT_EQ(ListByLabels({ "app=db" }), Ids({ "c1" }));
+    ASSERT_EQ(ListByLabels({ "app" }), Ids({ "c1", "c2" }));
+    ASSERT_EQ(ListByLabels({ "old" }), Ids({}));
+    ASSERT_EQ(ListByLabels({ "old=1" }), Ids({}));
+    ASSERT_EQ(ListByLabels({ "new=1" }), Ids({ "c1" }));
+}
+
+TEST_F(ContainersStoreUnitTest, test_remove_drops_labels)
+{
+    Add("c1", { { "app", "web" }, { "only", "c1" } });
+    Add("c2", { { "app", "web" } });
+
+    ASSERT_TRUE(containers_store_remove("c1"));
+    ASSERT_EQ(ListByLabels({ "app=web" }), Ids({ "c2" }));
+    ASSERT_EQ(ListByLabels({ "only" }), Ids({}));
+
+    ASSERT_TRUE(containers_store_remove("c2"));
+    ASSERT_EQ(ListByLabels({ "app" }), Ids({}));
+    ASSERT_FALSE(containers_store_remove("c2"));
+}
+
+// runs last, the index is not used again once incomplete
+TEST_F(ContainersStoreUnitTest, test_incomplete_index_falls_back)
+{
+    container_t **conts = nullptr;
+    size_t size = 0;
+    int ret = 0;
+
+    Add("c1", { { "app", "web" } });
+    // the id set of a new label cannot be made, c2 is stored but missing in the index
+    g_map_new_hash_fail = true;
+    Add("c2", { { "app", "web" }, { "tier", "front" } });
+    g_map_new_hash_fail = false;
+
+    // callers scan all containers instead
+    ASSERT_EQ(ListByLabels({ "app=web" }, &ret), Ids({}));
+    ASSERT_EQ(ret, -1);
+    ASSERT_EQ(containers_store_list(&conts, &size), 0);
+    ASSERT_EQ(size, 2U);
+    for (size_t i = 0; i < size; i++) {
+        container_unref(conts[i]);
+    }
+    free(conts);
+
+    Add("c3", { { "app", "web" } });
+    ASSERT_EQ(ListByLabels({ "app" }, &ret), Ids({}));
+    ASSERT_EQ(ret, -1);
+}
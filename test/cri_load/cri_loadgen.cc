@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: generate cri load on isulad and report the latency percentiles of each call
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <getopt.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpc++/grpc++.h>
+#include "api.grpc.pb.h"
+
+using grpc::ClientContext;
+using grpc::Status;
+using runtime::v1alpha2::RuntimeService;
+
+namespace {
+const int MAX_ERRORS_SHOWN = 3;
+
+struct Options {
+    std::string endpoint { "unix:///var/run/isulad.sock" };
+    std::string image { "cri-load/sleep:latest" };
+    std::string runtimeHandler;
+    std::string podNamespace { "cri-load" };
+    int pods { 100 };
+    int concurrency { 10 };
+    int containers { 1 };
+    int timeout { 60 };
+    // calls of each pod between the start of its containers and its stop
+    std::map<std::string, int> mix { { "list", 1 }, { "listall", 0 }, { "stats", 1 }, { "exec", 1 } };
+};
+
+class Recorder {
+public:
+    void Add(const std::string &op, double millis, const Status &status)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        OpStats &stats = m_ops[op];
+
+        stats.millis.push_back(millis);
+        if (!status.ok()) {
+            stats.errors++;
+            if (stats.messages.size() < MAX_ERRORS_SHOWN) {
+                stats.messages.insert(status.error_message());
+            }
+        }
+    }
+
+    // returns the number of failed calls
+    size_t Report(double seconds, int pods)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_t errors = 0;
+
+        printf("%-20s %8s %8s %10s %10s %10s %10s\n", "call", "count", "errors", "p50(ms)", "p90(ms)", "p99(ms)",
+               "max(ms)");
+        for (auto &it : m_ops) {
+            std::vector<double> &millis = it.second.millis;
+            std::sort(millis.begin(), millis.end());
+            printf("%-20s %8zu %8zu %10.2f %10.2f %10.2f %10.2f\n", it.first.c_str(), millis.size(), it.second.errors,
+                   Percentile(millis, 0.5), Percentile(millis, 0.9), Percentile(millis, 0.99), millis.back());
+            errors += it.second.errors;
+        }
+        printf("\n%d pods in %.2f s, %.2f pods/s\n", pods, seconds, seconds > 0 ? pods / seconds : 0);
+
+        for (auto &it : m_ops) {
+            for (auto &msg : it.second.messages) {
+                printf("%s error: %s\n", it.first.c_str(), msg.c_str());
+            }
+        }
+        return errors;
+    }
+
+private:
+    struct OpStats {
+        std::vector<double> millis;
+        size_t errors { 0 };
+        std::set<std::string> messages;
+    };
+
+    // nearest rank of sorted values
+    static double Percentile(const std::vector<double> &sorted, double p)
+    {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+
+        return sorted[rank > 0 ? rank - 1 : 0];
+    }
+
+    std::mutex m_mutex;
+    std::map<std::string, OpStats> m_ops;
+};
+
+// a worker runs the whole lifecycle of one pod after another, on its own connection
+class PodWorker {
+public:
+    PodWorker(const Options &opts, Recorder &recorder)
+        : m_opts(opts)
+        , m_recorder(recorder)
+    {
+        grpc::ChannelArguments args;
+
+        // do not share one connection between the workers
+        args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+        m_stub = RuntimeService::NewStub(
+                     grpc::CreateCustomChannel(opts.endpoint, grpc::InsecureChannelCredentials(), args));
+    }
+
+    void RunPod(int index)
+    {
+        runtime::v1alpha2::PodSandboxConfig sandboxConfig;
+        std::vector<std::string> containerIDs;
+        std::string podID;
+
+        MakeSandboxConfig(index, &sandboxConfig);
+        if (!RunPodSandbox(sandboxConfig, &podID)) {
+            return;
+        }
+
+        for (int i = 0; i < m_opts.containers; i++) {
+            std::string containerID;
+            if (CreateContainer(podID, sandboxConfig, i, &containerID) && StartContainer(containerID)) {
+                containerIDs.push_back(containerID);
+            }
+        }
+
+        for (int i = 0; i < m_opts.mix.at("list"); i++) {
+            ListContainers(podID);
+        }
+        for (int i = 0; i < m_opts.mix.at("listall"); i++) {
+            ListContainers("");
+        }
+        for (int i = 0; i < m_opts.mix.at("stats"); i++) {
+            ListContainerStats(podID);
+        }
+        for (int i = 0; i < m_opts.mix.at("exec") && !containerIDs.empty(); i++) {
+            ExecSync(containerIDs[i % containerIDs.size()]);
+        }
+
+        StopAndRemovePodSandbox(podID);
+    }
+
+private:
+    template <class Request, class Response>
+    using Rpc = Status (RuntimeService::Stub::*)(ClientContext *, const Request &, Response *);
+
+    template <class Request, class Response>
+    bool Call(const char *op, Rpc<Request, Response> rpc, const Request &request, Response *response)
+    {
+        ClientContext context;
+        context.set_deadline(std::chrono::system_clock::now() + std::chrono::seconds(m_opts.timeout));
+
+        auto start = std::chrono::steady_clock::now();
+        Status status = (m_stub.get()->*rpc)(&context, request, response);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        m_recorder.Add(op, elapsed.count(), status);
+        return status.ok();
+    }
+
+    void MakeSandboxConfig(int index, runtime::v1alpha2::PodSandboxConfig *config)
+    {
+        std::string name = "load-" + std::to_string(getpid()) + "-" + std::to_string(index);
+
+        config->mutable_metadata()->set_name(name);
+        config->mutable_metadata()->set_uid(name);
+        config->mutable_metadata()->set_namespace_(m_opts.podNamespace);
+        config->mutable_metadata()->set_attempt(0);
+        config->set_hostname(name);
+        (*config->mutable_labels())["cri-load"] = "true";
+    }
+
+    bool RunPodSandbox(const runtime::v1alpha2::PodSandboxConfig &config, std::string *podID)
+    {
+        runtime::v1alpha2::RunPodSandboxRequest request;
+        runtime::v1alpha2::RunPodSandboxResponse response;
+
+        *request.mutable_config() = config;
+        request.set_runtime_handler(m_opts.runtimeHandler);
+        if (!Call("RunPodSandbox", &RuntimeService::Stub::RunPodSandbox, request, &response)) {
+            return false;
+        }
+        *podID = response.pod_sandbox_id();
+        return true;
+    }
+
+    bool CreateContainer(const std::string &podID, const runtime::v1alpha2::PodSandboxConfig &sandboxConfig, int index,
+                         std::string *containerID)
+    {
+        runtime::v1alpha2::CreateContainerRequest request;
+        runtime::v1alpha2::CreateContainerResponse response;
+        runtime::v1alpha2::ContainerConfig *config = request.mutable_config();
+
+        request.set_pod_sandbox_id(podID);
+        *request.mutable_sandbox_config() = sandboxConfig;
+        config->mutable_metadata()->set_name("container-" + std::to_string(index));
+        config->mutable_image()->set_image(m_opts.image);
+        config->add_command("sleep");
+        config->add_command("3600");
+        if (!Call("CreateContainer", &RuntimeService::Stub::CreateContainer, request, &response)) {
+            return false;
+        }
+        *containerID = response.container_id();
+        return true;
+    }
+
+    bool StartContainer(const std::string &containerID)
+    {
+        runtime::v1alpha2::StartContainerRequest request;
+        runtime::v1alpha2::StartContainerResponse response;
+
+        request.set_container_id(containerID);
+        return Call("StartContainer", &RuntimeService::Stub::StartContainer, request, &response);
+    }
+
+    void ListContainers(const std::string &podID)
+    {
+        runtime::v1alpha2::ListContainersRequest request;
+        runtime::v1alpha2::ListContainersResponse response;
+
+        if (!podID.empty()) {
+            request.mutable_filter()->set_pod_sandbox_id(podID);
+        }
+        (void)Call(podID.empty() ? "ListContainers(all)" : "ListContainers", &RuntimeService::Stub::ListContainers,
+                   request, &response);
+    }
+
+    void ListContainerStats(const std::string &podID)
+    {
+        runtime::v1alpha2::ListContainerStatsRequest request;
+        runtime::v1alpha2::ListContainerStatsResponse response;
+
+        request.mutable_filter()->set_pod_sandbox_id(podID);
+        (void)Call("ListContainerStats", &RuntimeService::Stub::ListContainerStats, request, &response);
+    }
+
+    void ExecSync(const std::string &containerID)
+    {
+        runtime::v1alpha2::ExecSyncRequest request;
+        runtime::v1alpha2::ExecSyncResponse response;
+
+        request.set_container_id(containerID);
+        request.add_cmd("true");
+        request.set_timeout(m_opts.timeout);
+        (void)Call("ExecSync", &RuntimeService::Stub::ExecSync, request, &response);
+    }
+
+    void StopAndRemovePodSandbox(const std::string &podID)
+    {
+        runtime::v1alpha2::StopPodSandboxRequest stopRequest;
+        runtime::v1alpha2::StopPodSandboxResponse stopResponse;
+        runtime::v1alpha2::RemovePodSandboxRequest removeRequest;
+        runtime::v1alpha2::RemovePodSandboxResponse removeResponse;
+
+        stopRequest.set_pod_sandbox_id(podID);
+        (void)Call("StopPodSandbox", &RuntimeService::Stub::StopPodSandbox, stopRequest, &stopResponse);
+        removeRequest.set_pod_sandbox_id(podID);
+        (void)Call("RemovePodSandbox", &RuntimeService::Stub::RemovePodSandbox, removeRequest, &removeResponse);
+    }
+
+    const Options &m_opts;
+    Recorder &m_recorder;
+    std::unique_ptr<RuntimeService::Stub> m_stub;
+};
+
+void Usage(const char *prog)
+{
+    printf("Usage: %s [options]\n\n"
+           "Run the lifecycle of pods through the CRI of isulad and report the latency of each call.\n\n"
+           "  -e, --endpoint     cri endpoint (default unix:///var/run/isulad.sock)\n"
+           "  -i, --image        image of the containers (default cri-load/sleep:latest)\n"
+           "  -r, --runtime      runtime handler of the pods (default is the daemon default)\n"
+           "  -n, --pods         number of pods (default 100)\n"
+           "  -c, --concurrency  pods run in parallel (default 10)\n"
+           "  -k, --containers   containers of each pod (default 1)\n"
+           "  -m, --mix          calls of each pod while its containers run, as list=N,listall=N,stats=N,exec=N\n"
+           "                     (default list=1,listall=0,stats=1,exec=1)\n"
+           "  -t, --timeout      timeout of each call in seconds (default 60)\n",
+           prog);
+}
+
+bool ParseMix(const std::string &value, Options *opts)
+{
+    std::stringstream ss(value);
+    std::string item;
+
+    while (std::getline(ss, item, ',')) {
+        size_t pos = item.find('=');
+        if (pos == std::string::npos || opts->mix.count(item.substr(0, pos)) == 0) {
+            fprintf(stderr, "Invalid mix item: %s\n", item.c_str());
+            return false;
+        }
+        opts->mix[item.substr(0, pos)] = std::max(0, std::atoi(item.substr(pos + 1).c_str()));
+    }
+    return true;
+}
+
+bool ParseOptions(int argc, char **argv, Options *opts)
+{
+    static const struct option longOptions[] = {
+        { "endpoint", required_argument, nullptr, 'e' },  { "image", required_argument, nullptr, 'i' },
+        { "runtime", required_argument, nullptr, 'r' },   { "pods", required_argument, nullptr, 'n' },
+        { "concurrency", required_argument, nullptr, 'c' }, { "containers", required_argument, nullptr, 'k' },
+        { "mix", required_argument, nullptr, 'm' },       { "timeout", required_argument, nullptr, 't' },
+        { "help", no_argument, nullptr, 'h' },            { nullptr, 0, nullptr, 0 },
+    };
+    int opt = 0;
+
+    while ((opt = getopt_long(argc, argv, "e:i:r:n:c:k:m:t:h", longOptions, nullptr)) != -1) {
+        switch (opt) {
+            case 'e':
+                opts->endpoint = optarg;
+                break;
+            case 'i':
+                opts->image = optarg;
+                break;
+            case 'r':
+                opts->runtimeHandler = optarg;
+                break;
+            case 'n':
+                opts->pods = std::atoi(optarg);
+                break;
+            case 'c':
+                opts->concurrency = std::atoi(optarg);
+                break;
+            case 'k':
+                opts->containers = std::atoi(optarg);
+                break;
+            case 'm':
+                if (!ParseMix(optarg, opts)) {
+                    return false;
+                }
+                break;
+            case 't':
+                opts->timeout = std::atoi(optarg);
+                break;
+            default:
+                Usage(argv[0]);
+                return false;
+        }
+    }
+
+    if (opts->pods <= 0 || opts->concurrency <= 0 || opts->containers < 0 || opts->timeout <= 0) {
+        fprintf(stderr, "pods, concurrency and timeout must be positive\n");
+        return false;
+    }
+    return true;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opts;
+    Recorder recorder;
+    std::atomic<int> next { 0 };
+    std::vector<std::thread> workers;
+
+    if (!ParseOptions(argc, argv, &opts)) {
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < std::min(opts.concurrency, opts.pods); i++) {
+        workers.emplace_back([&opts, &recorder, &next]() {
+            PodWorker worker(opts, recorder);
+            for (int index = next++; index < opts.pods; index = next++) {
+                worker.RunPod(index);
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return recorder.Report(elapsed.count(), opts.pods) == 0 ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: a fake cni plugin for the cri load generator
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+/*
+ * Touches no network namespace: ADD returns an address of 10.88.0.0/16 derived from the
+ * container id, so a sandbox always gets the same address, and 127.0.0.1 for the lo interface,
+ * then the same binary is also installed as the loopback plugin. DEL and CHECK do nothing.
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_CNI_VERSION "0.3.1"
+#define MAX_CONFIG_LEN 65536
+
+// the cni version of the result has to be the one of the network config
+static void config_cni_version(char *version, size_t len)
+{
+    static char config[MAX_CONFIG_LEN];
+    size_t config_len = 0;
+    size_t nread = 0;
+    char *p = NULL;
+    char *end = NULL;
+
+    (void)snprintf(version, len, "%s", DEFAULT_CNI_VERSION);
+
+    while ((nread = fread(config + config_len, 1, sizeof(config) - 1 - config_len, stdin)) > 0) {
+        config_len += nread;
+    }
+    config[config_len] = '\0';
+
+    p = strstr(config, "\"cniVersion\"");
+    if (p == NULL) {
+        return;
+    }
+    p = strchr(p + strlen("\"cniVersion\""), '"');
+    if (p == NULL) {
+        return;
+    }
+    end = strchr(p + 1, '"');
+    if (end == NULL || (size_t)(end - p) > len) {
+        return;
+    }
+    (void)snprintf(version, len, "%.*s", (int)(end - p - 1), p + 1);
+}
+
+// fnv-1a of the container id, .0 and .255 are skipped
+static void container_address(const char *id, char *address, size_t len)
+{
+    uint32_t hash = 2166136261U;
+    uint32_t host = 0;
+
+    for (; *id != '\0'; id++) {
+        hash ^= (uint8_t)*id;
+        hash *= 16777619U;
+    }
+    host = hash % (254U * 254U);
+    (void)snprintf(address, len, "10.88.%u.%u/16", host / 254U + 1U, host % 254U + 1U);
+}
+
+static int cni_add(const char *version)
+{
+    const char *id = getenv("CNI_CONTAINERID");
+    const char *ifname = getenv("CNI_IFNAME");
+    const char *netns = getenv("CNI_NETNS");
+    char address[32] = { 0 };
+    const char *gateway = "10.88.0.1";
+
+    if (id == NULL || ifname == NULL) {
+        printf("{\"cniVersion\":\"%s\",\"code\":4,\"msg\":\"CNI_CONTAINERID and CNI_IFNAME are required\"}\n",
+               version);
+        return 1;
+    }
+
+    if (strcmp(ifname, "lo") == 0) {
+        (void)snprintf(address, sizeof(address), "127.0.0.1/8");
+        gateway = "127.0.0.1";
+    } else {
+        container_address(id, address, sizeof(address));
+    }
+
+    printf("{\"cniVersion\":\"%s\",\"interfaces\":[{\"name\":\"%s\",\"sandbox\":\"%s\"}],"
+           "\"ips\":[{\"version\":\"4\",\"interface\":0,\"address\":\"%s\",\"gateway\":\"%s\"}],\"dns\":{}}\n",
+           version, ifname, netns != NULL ? netns : "", address, gateway);
+    return 0;
+}
+
+int main(void)
+{
+    const char *command = getenv("CNI_COMMAND");
+    char version[32] = { 0 };
+
+    if (command == NULL) {
+        fprintf(stderr, "CNI_COMMAND is required\n");
+        return 1;
+    }
+
+    if (strcmp(command, "VERSION") == 0) {
+        printf("{\"cniVersion\":\"%s\",\"supportedVersions\":[\"0.1.0\",\"0.2.0\",\"0.3.0\",\"0.3.1\",\"0.4.0\"]}\n",
+               DEFAULT_CNI_VERSION);
+        return 0;
+    }
+
+    config_cni_version(version, sizeof(version));
+    if (strcmp(command, "ADD") == 0) {
+        return cni_add(version);
+    }
+    if (strcmp(command, "DEL") == 0 || strcmp(command, "CHECK") == 0) {
+        return 0;
+    }
+
+    printf("{\"cniVersion\":\"%s\",\"code\":4,\"msg\":\"unknown CNI_COMMAND %s\"}\n", version, command);
+    return 1;
+}
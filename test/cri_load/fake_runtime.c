@@ -0,0 +1,613 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: a fake oci runtime for the cri load generator
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+/*
+ * The runc command line as isulad-shim and isula_rt_ops use it, without any isolation:
+ * the container process is a `sleep` on the host. create forks the process and blocks it on
+ * a fifo until start, exec runs a `sleep 0` whose output is empty and exit code is 0.
+ * The state of a container is the directory <root>/<id>, with the pid, its start time (to
+ * detect pid reuse), the bundle, and the exec fifo while the container is created.
+ */
+#define _GNU_SOURCE
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#define DEFAULT_ROOT "/run/isulad-fake-runtime"
+#define SLEEP_SECONDS "1000000000"
+#define START_TIMEOUT_MS 10000
+
+struct cmd_args {
+    const char *bundle;
+    const char *pid_file;
+    const char *console_socket;
+    bool force;
+    bool stats;
+    // container id and the signal of kill
+    const char *pos[2];
+    int pos_len;
+};
+
+struct container_state {
+    pid_t pid;
+    unsigned long long start_time;
+    char bundle[PATH_MAX];
+};
+
+static const char *g_root = DEFAULT_ROOT;
+
+static void errorf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+static void errorf(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    (void)vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    (void)fputc('\n', stderr);
+}
+
+static int container_path(char *buf, size_t len, const char *id, const char *name)
+{
+    int nret = 0;
+
+    if (name == NULL) {
+        nret = snprintf(buf, len, "%s/%s", g_root, id);
+    } else {
+        nret = snprintf(buf, len, "%s/%s/%s", g_root, id, name);
+    }
+    if (nret < 0 || (size_t)nret >= len) {
+        errorf("path of container %s is too long", id);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_file(const char *path, const char *content)
+{
+    FILE *fp = NULL;
+    int ret = 0;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        errorf("failed to open %s: %s", path, strerror(errno));
+        return -1;
+    }
+    if (fputs(content, fp) == EOF) {
+        errorf("failed to write %s", path);
+        ret = -1;
+    }
+    if (fclose(fp) != 0) {
+        ret = -1;
+    }
+    return ret;
+}
+
+// field 3 is the state and field 22 is the start time, the name in field 2 is in parentheses
+static int read_proc_stat(pid_t pid, char *state, unsigned long long *start_time, unsigned long long *utime,
+                          unsigned long long *stime)
+{
+    char path[PATH_MAX] = { 0 };
+    char buf[1024] = { 0 };
+    char *p = NULL;
+    FILE *fp = NULL;
+    size_t len = 0;
+
+    (void)snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return -1;
+    }
+    len = fread(buf, 1, sizeof(buf) - 1, fp);
+    (void)fclose(fp);
+    buf[len] = '\0';
+
+    p = strrchr(buf, ')');
+    if (p == NULL) {
+        return -1;
+    }
+    if (sscanf(p + 2, "%c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %llu %llu %*d %*d %*d %*d %*d %*d %llu", state,
+               utime, stime, start_time) != 4) {
+        return -1;
+    }
+    return 0;
+}
+
+static int load_state(const char *id, struct container_state *st)
+{
+    char path[PATH_MAX] = { 0 };
+    FILE *fp = NULL;
+    int pid = 0;
+    int nret = 0;
+
+    if (container_path(path, sizeof(path), id, "state") != 0) {
+        return -1;
+    }
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        errorf("container %s does not exist", id);
+        return -1;
+    }
+    nret = fscanf(fp, "%d %llu %4095s", &pid, &st->start_time, st->bundle);
+    (void)fclose(fp);
+    if (nret != 3) {
+        errorf("invalid state of container %s", id);
+        return -1;
+    }
+    st->pid = (pid_t)pid;
+    return 0;
+}
+
+// 'R' or 'S' if running, 'T' if stopped by a signal, 0 if the process is gone
+static char process_state(const struct container_state *st)
+{
+    char state = 0;
+    unsigned long long start_time = 0;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+
+    if (st->pid <= 0 || read_proc_stat(st->pid, &state, &start_time, &utime, &stime) != 0) {
+        return 0;
+    }
+    if (start_time != st->start_time || state == 'Z' || state == 'X') {
+        return 0;
+    }
+    return state;
+}
+
+static bool is_created(const char *id)
+{
+    char fifo[PATH_MAX] = { 0 };
+
+    return container_path(fifo, sizeof(fifo), id, "exec.fifo") == 0 && access(fifo, F_OK) == 0;
+}
+
+static int write_pid_file(const char *path, pid_t pid)
+{
+    char buf[32] = { 0 };
+
+    if (path == NULL) {
+        return 0;
+    }
+    (void)snprintf(buf, sizeof(buf), "%d", (int)pid);
+    return write_file(path, buf);
+}
+
+static void exec_sleep(const char *seconds)
+{
+    execlp("sleep", "sleep", seconds, (char *)NULL);
+    errorf("failed to exec sleep: %s", strerror(errno));
+    _exit(127);
+}
+
+static int cmd_create(const char *id, const struct cmd_args *args)
+{
+    char dir[PATH_MAX] = { 0 };
+    char fifo[PATH_MAX] = { 0 };
+    char path[PATH_MAX] = { 0 };
+    char state[PATH_MAX + 64] = { 0 };
+    char proc_state = 0;
+    unsigned long long start_time = 0;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    pid_t pid = 0;
+    int fd = -1;
+
+    if (args->console_socket != NULL) {
+        errorf("terminal is not supported by the fake runtime");
+        return -1;
+    }
+    if (container_path(dir, sizeof(dir), id, NULL) != 0 || container_path(fifo, sizeof(fifo), id, "exec.fifo") != 0 ||
+        container_path(path, sizeof(path), id, "state") != 0) {
+        return -1;
+    }
+    if (mkdir(g_root, 0700) != 0 && errno != EEXIST) {
+        errorf("failed to create %s: %s", g_root, strerror(errno));
+        return -1;
+    }
+    if (mkdir(dir, 0700) != 0) {
+        errorf("failed to create container %s: %s", id, strerror(errno));
+        return -1;
+    }
+    if (mkfifo(fifo, 0600) != 0) {
+        errorf("failed to create exec fifo: %s", strerror(errno));
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        errorf("failed to fork: %s", strerror(errno));
+        return -1;
+    }
+    if (pid == 0) {
+        // blocks until start opens the fifo for reading, as runc init does
+        fd = open(fifo, O_WRONLY | O_CLOEXEC);
+        if (fd < 0 || write(fd, "0", 1) != 1) {
+            _exit(127);
+        }
+        close(fd);
+        exec_sleep(SLEEP_SECONDS);
+    }
+
+    if (read_proc_stat(pid, &proc_state, &start_time, &utime, &stime) != 0) {
+        errorf("failed to read the stat of process %d", (int)pid);
+        return -1;
+    }
+    (void)snprintf(state, sizeof(state), "%d %llu %s\n", (int)pid, start_time,
+                   args->bundle != NULL ? args->bundle : ".");
+    if (write_file(path, state) != 0) {
+        return -1;
+    }
+    // the process is reparented to isulad-shim, the child subreaper, when we exit
+    return write_pid_file(args->pid_file, pid);
+}
+
+static int cmd_start(const char *id)
+{
+    struct container_state st = { 0 };
+    struct pollfd pfd = { 0 };
+    char fifo[PATH_MAX] = { 0 };
+    char c = 0;
+    int ret = -1;
+
+    if (load_state(id, &st) != 0 || container_path(fifo, sizeof(fifo), id, "exec.fifo") != 0) {
+        return -1;
+    }
+    if (process_state(&st) == 0) {
+        errorf("container %s is stopped", id);
+        return -1;
+    }
+
+    // nonblocking, so that we never wait forever if the process dies
+    pfd.fd = open(fifo, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (pfd.fd < 0) {
+        errorf("container %s is not created: %s", id, strerror(errno));
+        return -1;
+    }
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, START_TIMEOUT_MS) != 1 || read(pfd.fd, &c, 1) != 1) {
+        errorf("container %s did not start in time", id);
+        goto out;
+    }
+    (void)unlink(fifo);
+    ret = 0;
+
+out:
+    close(pfd.fd);
+    return ret;
+}
+
+static int cmd_state(const char *id)
+{
+    struct container_state st = { 0 };
+    const char *status = "stopped";
+    char proc_state = 0;
+
+    if (load_state(id, &st) != 0) {
+        return -1;
+    }
+
+    proc_state = process_state(&st);
+    if (proc_state == 0) {
+        st.pid = 0;
+    } else if (is_created(id)) {
+        status = "created";
+    } else if (proc_state == 'T') {
+        status = "paused";
+    } else {
+        status = "running";
+    }
+
+    printf("{\"ociVersion\":\"1.0.2\",\"id\":\"%s\",\"pid\":%d,\"status\":\"%s\",\"bundle\":\"%s\"}\n", id,
+           (int)st.pid, status, st.bundle);
+    return 0;
+}
+
+static int parse_signal(const char *name)
+{
+    static const struct {
+        const char *name;
+        int sig;
+    } signals[] = {
+        { "KILL", SIGKILL }, { "TERM", SIGTERM }, { "INT", SIGINT },   { "HUP", SIGHUP },   { "QUIT", SIGQUIT },
+        { "USR1", SIGUSR1 }, { "USR2", SIGUSR2 }, { "STOP", SIGSTOP }, { "CONT", SIGCONT },
+    };
+    size_t i = 0;
+
+    if (name == NULL) {
+        return SIGTERM;
+    }
+    if (isdigit((unsigned char)name[0])) {
+        return atoi(name);
+    }
+    if (strncasecmp(name, "SIG", 3) == 0) {
+        name += 3;
+    }
+    for (i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        if (strcasecmp(name, signals[i].name) == 0) {
+            return signals[i].sig;
+        }
+    }
+    return -1;
+}
+
+static int signal_container(const char *id, int sig)
+{
+    struct container_state st = { 0 };
+
+    if (load_state(id, &st) != 0) {
+        return -1;
+    }
+    if (process_state(&st) == 0) {
+        errorf("container %s is not running", id);
+        return -1;
+    }
+    if (kill(st.pid, sig) != 0) {
+        errorf("failed to signal container %s: %s", id, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_kill(const char *id, const struct cmd_args *args)
+{
+    int sig = parse_signal(args->pos_len > 1 ? args->pos[1] : NULL);
+
+    if (sig <= 0) {
+        errorf("invalid signal %s", args->pos[1]);
+        return -1;
+    }
+    return signal_container(id, sig);
+}
+
+static int cmd_delete(const char *id, const struct cmd_args *args)
+{
+    static const char *files[] = { "exec.fifo", "state" };
+    struct container_state st = { 0 };
+    char path[PATH_MAX] = { 0 };
+    size_t i = 0;
+
+    if (load_state(id, &st) != 0) {
+        return args->force ? 0 : -1;
+    }
+    if (process_state(&st) != 0) {
+        if (!args->force && !is_created(id)) {
+            errorf("container %s is running, stop it first or use --force", id);
+            return -1;
+        }
+        (void)kill(st.pid, SIGKILL);
+    }
+
+    for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        if (container_path(path, sizeof(path), id, files[i]) == 0) {
+            (void)unlink(path);
+        }
+    }
+    if (container_path(path, sizeof(path), id, NULL) != 0 || rmdir(path) != 0) {
+        errorf("failed to remove container %s: %s", id, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+static int cmd_exec(const char *id, const struct cmd_args *args)
+{
+    struct container_state st = { 0 };
+    pid_t pid = 0;
+
+    if (args->console_socket != NULL) {
+        errorf("terminal is not supported by the fake runtime");
+        return -1;
+    }
+    if (load_state(id, &st) != 0) {
+        return -1;
+    }
+    if (process_state(&st) == 0 || is_created(id)) {
+        errorf("container %s is not running", id);
+        return -1;
+    }
+
+    pid = fork();
+    if (pid < 0) {
+        errorf("failed to fork: %s", strerror(errno));
+        return -1;
+    }
+    if (pid == 0) {
+        exec_sleep("0");
+    }
+    return write_pid_file(args->pid_file, pid);
+}
+
+// the format of runc events --stats, read by runtime_call_stats
+static int cmd_events(const char *id, const struct cmd_args *args)
+{
+    struct container_state st = { 0 };
+    char path[PATH_MAX] = { 0 };
+    char state = 0;
+    unsigned long long start_time = 0;
+    unsigned long long utime = 0;
+    unsigned long long stime = 0;
+    unsigned long long rss_pages = 0;
+    unsigned long long ticks = (unsigned long long)sysconf(_SC_CLK_TCK);
+    unsigned long long page_size = (unsigned long long)sysconf(_SC_PAGESIZE);
+    FILE *fp = NULL;
+
+    if (!args->stats) {
+        errorf("only events --stats is supported by the fake runtime");
+        return -1;
+    }
+    if (load_state(id, &st) != 0) {
+        return -1;
+    }
+    if (process_state(&st) != 0 && read_proc_stat(st.pid, &state, &start_time, &utime, &stime) == 0) {
+        (void)snprintf(path, sizeof(path), "/proc/%d/statm", (int)st.pid);
+        fp = fopen(path, "r");
+        if (fp != NULL) {
+            if (fscanf(fp, "%*u %llu", &rss_pages) != 1) {
+                rss_pages = 0;
+            }
+            (void)fclose(fp);
+        }
+    }
+
+    printf("{\"type\":\"stats\",\"id\":\"%s\",\"data\":{\"cpu\":{\"usage\":{\"total\":%llu,\"kernel\":%llu}},"
+           "\"memory\":{\"usage\":{\"usage\":%llu,\"limit\":0}},\"pids\":{\"current\":%d}}}\n",
+           id, (utime + stime) * 1000000000ULL / ticks, stime * 1000000000ULL / ticks, rss_pages * page_size,
+           state != 0 ? 1 : 0);
+    return 0;
+}
+
+static bool option_has_value(const char *opt)
+{
+    static const char *opts[] = { "--bundle", "-b",          "--pid-file", "--console-socket", "--process",
+                                  "-p",       "--resources", "-r",         "--interval",       "--log",
+                                  "--log-format", "--root",  "--criu" };
+    size_t i = 0;
+
+    for (i = 0; i < sizeof(opts) / sizeof(opts[0]); i++) {
+        if (strcmp(opt, opts[i]) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// options of all commands in one pass, the unknown flags are ignored
+static int parse_cmd_args(int argc, char **argv, struct cmd_args *args)
+{
+    int i = 0;
+
+    for (i = 0; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = NULL;
+
+        if (arg[0] != '-') {
+            if (args->pos_len >= (int)(sizeof(args->pos) / sizeof(args->pos[0]))) {
+                errorf("too many arguments");
+                return -1;
+            }
+            args->pos[args->pos_len++] = arg;
+            continue;
+        }
+        if (!option_has_value(arg)) {
+            args->force = args->force || strcmp(arg, "--force") == 0 || strcmp(arg, "-f") == 0;
+            args->stats = args->stats || strcmp(arg, "--stats") == 0;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            errorf("option %s needs a value", arg);
+            return -1;
+        }
+        value = argv[++i];
+        if (strcmp(arg, "--bundle") == 0 || strcmp(arg, "-b") == 0) {
+            args->bundle = value;
+        } else if (strcmp(arg, "--pid-file") == 0) {
+            args->pid_file = value;
+        } else if (strcmp(arg, "--console-socket") == 0) {
+            args->console_socket = value;
+        }
+    }
+
+    if (args->pos_len == 0) {
+        errorf("container id is required");
+        return -1;
+    }
+    return 0;
+}
+
+static int run_cmd(const char *cmd, const char *id, const struct cmd_args *args)
+{
+    if (strcmp(cmd, "create") == 0) {
+        return cmd_create(id, args);
+    }
+    if (strcmp(cmd, "start") == 0) {
+        return cmd_start(id);
+    }
+    if (strcmp(cmd, "state") == 0) {
+        return cmd_state(id);
+    }
+    if (strcmp(cmd, "kill") == 0) {
+        return cmd_kill(id, args);
+    }
+    if (strcmp(cmd, "delete") == 0) {
+        return cmd_delete(id, args);
+    }
+    if (strcmp(cmd, "exec") == 0) {
+        return cmd_exec(id, args);
+    }
+    if (strcmp(cmd, "events") == 0) {
+        return cmd_events(id, args);
+    }
+    if (strcmp(cmd, "pause") == 0) {
+        return signal_container(id, SIGSTOP);
+    }
+    if (strcmp(cmd, "resume") == 0) {
+        return signal_container(id, SIGCONT);
+    }
+    if (strcmp(cmd, "update") == 0) {
+        // there are no cgroups to update
+        return 0;
+    }
+
+    errorf("command %s is not supported by the fake runtime", cmd);
+    return -1;
+}
+
+int main(int argc, char **argv)
+{
+    struct cmd_args args = { 0 };
+    int i = 1;
+
+    // global options before the command
+    for (; i < argc && argv[i][0] == '-'; i++) {
+        if (strcmp(argv[i], "--version") == 0 || strcmp(argv[i], "-v") == 0) {
+            printf("fake-runtime version 1.0.0\nspec: 1.0.2\n");
+            return 0;
+        }
+        if (!option_has_value(argv[i])) {
+            continue;
+        }
+        if (i + 1 >= argc) {
+            errorf("option %s needs a value", argv[i]);
+            return 1;
+        }
+        if (strcmp(argv[i], "--root") == 0) {
+            g_root = argv[i + 1];
+        }
+        i++;
+    }
+
+    if (i >= argc) {
+        errorf("usage: %s [--root dir] command [options] id", argv[0]);
+        return 1;
+    }
+    if (parse_cmd_args(argc - i - 1, argv + i + 1, &args) != 0) {
+        return 1;
+    }
+
+    return run_cmd(argv[i], args.pos[0], &args) == 0 ? 0 : 1;
+}
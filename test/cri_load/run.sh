@@ -0,0 +1,181 @@
+#!/bin/bash
+#
+# Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+# iSulad licensed under the Mulan PSL v2.
+# You can use this software according to the terms and conditions of the Mulan PSL v2.
+# You may obtain a copy of Mulan PSL v2 at:
+#     http://license.coscl.org.cn/MulanPSL2
+# THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+# PURPOSE.
+# See the Mulan PSL v2 for more details.
+# Description: run the cri load generator against an isulad with the fake runtime and cni plugin
+# Author: agent
+# Create: 2026-10-18
+#
+# usage: run.sh <dir of cri_loadgen, fake_runtime and fake_cni> [options of cri_loadgen]
+#
+# The isulad in PATH is started with a daemon.json of its own, graph, state and socket in a
+# temporary directory, so it must not be running. /etc/isulad/daemon.json is restored at exit.
+# The image of the pods is generated here, nothing is pulled.
+
+set -u
+
+bin_dir=$(realpath "${1:?usage: $0 <build dir of test/cri_load> [cri_loadgen options]}")
+shift
+work_dir=$(mktemp -d /tmp/isulad-cri-load.XXXXXX)
+daemon_json=/etc/isulad/daemon.json
+endpoint="unix://${work_dir}/isulad.sock"
+image="cri-load/sleep:latest"
+isulad_pid=""
+restore_daemon_json=false
+
+function msg_err()
+{
+    echo -e "\033[1;31m$*\033[0m" >&2
+}
+
+function cleanup()
+{
+    if [ -n "${isulad_pid}" ]; then
+        kill -TERM ${isulad_pid} 2>/dev/null
+        wait ${isulad_pid} 2>/dev/null
+    fi
+    # shims and sleeps left by failed calls, the shims run with the path of the fake runtime
+    pkill -KILL -f "${work_dir}/bin/fake-runtime" 2>/dev/null
+    for state in ${work_dir}/fake-runtime/*/state; do
+        [ -f "${state}" ] && kill -KILL $(awk '{print $1}' ${state}) 2>/dev/null
+    done
+    grep -o " ${work_dir}/[^ ]*" /proc/mounts | sort -r | xargs -r umount -l
+    if [ "${restore_daemon_json}" = true ]; then
+        if [ -f ${work_dir}/daemon.json.bak ]; then
+            cp -f ${work_dir}/daemon.json.bak ${daemon_json}
+        else
+            rm -f ${daemon_json}
+        fi
+    fi
+    rm -rf ${work_dir}
+}
+
+function prepare_bins()
+{
+    mkdir -p ${work_dir}/bin ${work_dir}/cni ${work_dir}/net.d || return 1
+    cp ${bin_dir}/fake_runtime ${work_dir}/bin/fake-runtime || return 1
+    cp ${bin_dir}/fake_cni ${work_dir}/cni/fake-cni || return 1
+    # isulad sets up the lo interface of every pod with the loopback plugin
+    cp ${bin_dir}/fake_cni ${work_dir}/cni/loopback || return 1
+
+    cat > ${work_dir}/net.d/10-cri-load.conflist << EOF
+{
+    "cniVersion": "0.3.1",
+    "name": "cri-load",
+    "plugins": [{ "type": "fake-cni" }]
+}
+EOF
+}
+
+function write_daemon_json()
+{
+    mkdir -p $(dirname ${daemon_json})
+    if [ -f ${daemon_json} ]; then
+        cp -f ${daemon_json} ${work_dir}/daemon.json.bak || return 1
+    fi
+    restore_daemon_json=true
+
+    cat > ${daemon_json} << EOF
+{
+    "graph": "${work_dir}/graph",
+    "state": "${work_dir}/state",
+    "pidfile": "${work_dir}/isulad.pid",
+    "hosts": ["${endpoint}"],
+    "log-level": "ERROR",
+    "log-driver": "file",
+    "log-opts": {
+        "log-path": "${work_dir}"
+    },
+    "storage-driver": "overlay2",
+    "storage-opts": ["overlay2.override_kernel_check=true"],
+    "default-runtime": "fake",
+    "runtimes": {
+        "fake": {
+            "path": "${work_dir}/bin/fake-runtime",
+            "runtime-args": ["--root", "${work_dir}/fake-runtime"]
+        }
+    },
+    "pod-sandbox-image": "${image}",
+    "network-plugin": "cni",
+    "cni-bin-dir": "${work_dir}/cni",
+    "cni-conf-dir": "${work_dir}/net.d"
+}
+EOF
+}
+
+# a docker archive with one small layer, the fake runtime runs `sleep` of the host anyway
+function make_image()
+{
+    local dir=${work_dir}/image
+    local arch=amd64
+    local diff_id
+    local config_id
+
+    case $(uname -m) in
+        aarch64) arch=arm64 ;;
+        x86_64) arch=amd64 ;;
+        *) arch=$(uname -m) ;;
+    esac
+
+    mkdir -p ${dir}/rootfs ${dir}/archive/layer || return 1
+    echo "cri-load" > ${dir}/rootfs/cri-load
+    tar -C ${dir}/rootfs -cf ${dir}/archive/layer/layer.tar . || return 1
+    diff_id=$(sha256sum ${dir}/archive/layer/layer.tar | awk '{print $1}')
+
+    cat > ${dir}/config.json << EOF
+{"architecture":"${arch}","os":"linux","created":"2020-11-24T00:00:00Z","config":{"Cmd":["sleep","3600"]},"rootfs":{"type":"layers","diff_ids":["sha256:${diff_id}"]},"history":[{"created":"2020-11-24T00:00:00Z","created_by":"cri-load"}]}
+EOF
+    config_id=$(sha256sum ${dir}/config.json | awk '{print $1}')
+    mv ${dir}/config.json ${dir}/archive/${config_id}.json || return 1
+    echo "[{\"Config\":\"${config_id}.json\",\"RepoTags\":[\"${image}\"],\"Layers\":[\"layer/layer.tar\"]}]" \
+        > ${dir}/archive/manifest.json
+    tar -C ${dir}/archive -cf ${dir}/sleep.tar . || return 1
+
+    isula load -H ${endpoint} -i ${dir}/sleep.tar
+}
+
+function start_isulad()
+{
+    local i
+
+    isulad > ${work_dir}/isulad.out 2>&1 &
+    isulad_pid=$!
+    for i in $(seq 1 300); do
+        if isula version -H ${endpoint} > /dev/null 2>&1; then
+            return 0
+        fi
+        if ! kill -0 ${isulad_pid} 2>/dev/null; then
+            break
+        fi
+        sleep 0.1
+    done
+
+    msg_err "isulad did not start, output:"
+    cat ${work_dir}/isulad.out >&2
+    return 1
+}
+
+if [ "$(id -u)" -ne 0 ]; then
+    msg_err "must run as root"
+    exit 1
+fi
+if [ -f /var/run/isulad.pid ] && kill -0 $(cat /var/run/isulad.pid) 2>/dev/null; then
+    msg_err "isulad is running, stop it first"
+    exit 1
+fi
+
+trap cleanup EXIT
+
+prepare_bins || { msg_err "failed to prepare the fake runtime and cni plugin"; exit 1; }
+write_daemon_json || { msg_err "failed to write ${daemon_json}"; exit 1; }
+start_isulad || exit 1
+make_image || { msg_err "failed to load the image of pods"; exit 1; }
+
+${bin_dir}/cri_loadgen --endpoint ${endpoint} --image ${image} "$@"
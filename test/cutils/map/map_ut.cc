@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: map unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <set>
+#include <string>
+#include <gtest/gtest.h>
+#include "map.h"
+
+static std::string test_key(int i)
+{
+    char buf[32] = { 0 };
+
+    (void)snprintf(buf, sizeof(buf), "key-%d", i);
+    return std::string(buf);
+}
+
+static void check_map_keys(map_t *map, int begin, int end)
+{
+    std::set<std::string> seen;
+    map_itor *itor = nullptr;
+    int i;
+
+    ASSERT_EQ(map_size(map), (size_t)(end - begin));
+    for (i = begin; i < end; i++) {
+        int *value = (int *)map_search(map, (void *)test_key(i).c_str());
+        ASSERT_NE(value, nullptr);
+        ASSERT_EQ(*value, i);
+    }
+
+    itor = map_itor_new(map);
+    ASSERT_NE(itor, nullptr);
+    for (; map_itor_valid(itor); map_itor_next(itor)) {
+        std::string key((const char *)map_itor_key(itor));
+        ASSERT_EQ(seen.count(key), 0);
+        seen.insert(key);
+    }
+    ASSERT_EQ(seen.size(), (size_t)(end - begin));
+
+    // the same keys backward
+    ASSERT_TRUE(map_itor_last(itor));
+    for (; map_itor_valid(itor); map_itor_prev(itor)) {
+        ASSERT_EQ(seen.erase(std::string((const char *)map_itor_key(itor))), 1);
+    }
+    ASSERT_TRUE(seen.empty());
+    map_itor_free(itor);
+}
+
+TEST(map, test_map_new_hash)
+{
+    ASSERT_EQ(map_new_hash(MAP_INT_INT, MAP_DEFAULT_FREE_FUNC), nullptr);
+    ASSERT_EQ(map_new_hash(MAP_PTR_PTR, MAP_DEFAULT_FREE_FUNC), nullptr);
+
+    map_t *map = map_new_hash(MAP_STR_INT, MAP_DEFAULT_FREE_FUNC);
+    ASSERT_NE(map, nullptr);
+    ASSERT_EQ(map_size(map), 0);
+    ASSERT_EQ(map_search(map, (void *)"none"), nullptr);
+    ASSERT_FALSE(map_remove(map, (void *)"none"));
+
+    map_itor *itor = map_itor_new(map);
+    ASSERT_NE(itor, nullptr);
+    ASSERT_FALSE(map_itor_valid(itor));
+    ASSERT_FALSE(map_itor_first(itor));
+    ASSERT_FALSE(map_itor_last(itor));
+    map_itor_free(itor);
+
+    map_free(map);
+}
+
+TEST(map, test_map_hash_insert_remove)
+{
+    const int count = 20000;
+    map_t *map = map_new_hash(MAP_STR_INT, MAP_DEFAULT_FREE_FUNC);
+    int i;
+
+    ASSERT_NE(map, nullptr);
+    for (i = 0; i < count; i++) {
+        ASSERT_TRUE(map_insert(map, (void *)test_key(i).c_str(), &i));
+        ASSERT_FALSE(map_insert(map, (void *)test_key(i).c_str(), &i));
+        // checked while entries are still moved from the old table
+        if (i == 100 || i == 1000 || i == 13000) {
+            check_map_keys(map, 0, i + 1);
+        }
+    }
+    check_map_keys(map, 0, count);
+
+    for (i = 0; i < count / 2; i++) {
+        ASSERT_TRUE(map_remove(map, (void *)test_key(i).c_str()));
+        ASSERT_FALSE(map_remove(map, (void *)test_key(i).c_str()));
+        ASSERT_EQ(map_search(map, (void *)test_key(i).c_str()), nullptr);
+    }
+    check_map_keys(map, count / 2, count);
+
+    map_clear(map);
+    ASSERT_EQ(map_size(map), 0);
+    ASSERT_TRUE(map_insert(map, (void *)"again", &i));
+    ASSERT_EQ(map_size(map), 1);
+
+    map_free(map);
+}
+
+TEST(map, test_map_hash_replace)
+{
+    map_t *map = map_new_hash(MAP_STR_STR, MAP_DEFAULT_FREE_FUNC);
+
+    ASSERT_NE(map, nullptr);
+    ASSERT_TRUE(map_replace(map, (void *)"key", (void *)"first"));
+    ASSERT_STREQ((const char *)map_search(map, (void *)"key"), "first");
+    ASSERT_TRUE(map_replace(map, (void *)"key", (void *)"second"));
+    ASSERT_STREQ((const char *)map_search(map, (void *)"key"), "second");
+    ASSERT_EQ(map_size(map), 1);
+
+    map_free(map);
+}
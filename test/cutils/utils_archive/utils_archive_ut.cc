@@ -0,0 +1,604 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: util_archive unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+/*
+ * Synthetic tarballs are unpacked with archive_unpack and the resulting tree is compared with
+ * the expected one, entry by entry. Ownership and overlay whiteouts need root.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <sys/xattr.h>
+#include <linux/fs.h>
+#include <map>
+#include <string>
+#include <gtest/gtest.h>
+#include "util_archive.h"
+#include "utils_file.h"
+
+namespace {
+const size_t TAR_BLOCK = 512;
+
+// ustar entries, enough for the unpacker which reads them with libarchive
+class TarBuilder {
+public:
+    void Dir(const std::string &name, unsigned int mode = 0755, unsigned int uid = 0, unsigned int gid = 0)
+    {
+        Header(name, '5', mode, uid, gid, 0, "");
+    }
+
+    void File(const std::string &name, const std::string &data, unsigned int mode = 0644, unsigned int uid = 0,
+              unsigned int gid = 0)
+    {
+        Header(name, '0', mode, uid, gid, data.size(), "");
+        m_data += data;
+        m_data.append((TAR_BLOCK - data.size() % TAR_BLOCK) % TAR_BLOCK, '\0');
+    }
+
+    void Symlink(const std::string &name, const std::string &target)
+    {
+        Header(name, '2', 0777, 0, 0, 0, target);
+    }
+
+    // a hardlink with data replaces the content of its target, libarchive reads the data
+    // of pax entries only
+    void Hardlink(const std::string &name, const std::string &target, const std::string &data = "")
+    {
+        Header(name, '1', 0644, 0, 0, data.size(), target);
+        m_data += data;
+        m_data.append((TAR_BLOCK - data.size() % TAR_BLOCK) % TAR_BLOCK, '\0');
+    }
+
+    void Fifo(const std::string &name, unsigned int mode = 0644)
+    {
+        Header(name, '6', mode, 0, 0, 0, "");
+    }
+
+    // a pax header with one record, applied to the next entry
+    void Pax(const std::string &key, const std::string &value)
+    {
+        std::string body = " " + key + "=" + value + "\n";
+        size_t len = body.size() + 1;
+
+        while (std::to_string(len).size() + body.size() != len) {
+            len = std::to_string(len).size() + body.size();
+        }
+        body = std::to_string(len) + body;
+        Header("PaxHeader", 'x', 0644, 0, 0, body.size(), "");
+        m_data += body;
+        m_data.append((TAR_BLOCK - body.size() % TAR_BLOCK) % TAR_BLOCK, '\0');
+    }
+
+    std::string Finish() const
+    {
+        return m_data + std::string(2 * TAR_BLOCK, '\0');
+    }
+
+private:
+    void Header(const std::string &name, char type, unsigned int mode, unsigned int uid, unsigned int gid,
+                size_t size, const std::string &link)
+    {
+        char block[TAR_BLOCK] = { 0 };
+        unsigned int sum = 0;
+        size_t i;
+
+        (void)snprintf(block, 100, "%s", name.c_str());
+        (void)snprintf(block + 100, 8, "%07o", mode);
+        (void)snprintf(block + 108, 8, "%07o", uid);
+        (void)snprintf(block + 116, 8, "%07o", gid);
+        (void)snprintf(block + 124, 12, "%011lo", (unsigned long)size);
+        (void)snprintf(block + 136, 12, "%011o", 1606176000U);
+        block[156] = type;
+        (void)snprintf(block + 157, 100, "%s", link.c_str());
+        memcpy(block + 257, "ustar", 6);
+        memcpy(block + 263, "00", 2);
+        memset(block + 148, ' ', 8);
+        for (i = 0; i < TAR_BLOCK; i++) {
+            sum += (unsigned char)block[i];
+        }
+        (void)snprintf(block + 148, 8, "%06o", sum);
+        m_data.append(block, TAR_BLOCK);
+    }
+
+    std::string m_data;
+};
+
+struct Node {
+    char type;
+    unsigned int mode;
+    unsigned int uid;
+    unsigned int gid;
+    // content of regular files, target of symlinks
+    std::string data;
+
+    bool operator==(const Node &other) const
+    {
+        return type == other.type && mode == other.mode && uid == other.uid && gid == other.gid &&
+               data == other.data;
+    }
+};
+
+std::ostream &operator<<(std::ostream &os, const Node &node)
+{
+    return os << node.type << " " << std::oct << node.mode << std::dec << " " << node.uid << ":" << node.gid << " '"
+           << node.data << "'";
+}
+
+using Tree = std::map<std::string, Node>;
+
+Node RegNode(const std::string &data, unsigned int mode = 0644, unsigned int uid = 0, unsigned int gid = 0)
+{
+    return Node { 'f', mode, uid, gid, data };
+}
+
+Node DirNode(unsigned int mode = 0755, unsigned int uid = 0, unsigned int gid = 0)
+{
+    return Node { 'd', mode, uid, gid, "" };
+}
+
+Node LinkNode(const std::string &target, unsigned int uid = 0, unsigned int gid = 0)
+{
+    return Node { 'l', 0777, uid, gid, target };
+}
+
+std::string ReadAll(const std::string &path)
+{
+    std::string data;
+    char buf[256];
+    ssize_t n;
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return "<unreadable>";
+    }
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        data.append(buf, (size_t)n);
+    }
+    close(fd);
+    return data;
+}
+
+void Walk(const std::string &root, const std::string &rel, Tree &tree)
+{
+    std::string dir = rel.empty() ? root : root + "/" + rel;
+    DIR *dp = opendir(dir.c_str());
+    struct dirent *dent = nullptr;
+
+    ASSERT_NE(dp, nullptr) << dir;
+    while ((dent = readdir(dp)) != nullptr) {
+        std::string name = dent->d_name;
+        std::string child = rel.empty() ? name : rel + "/" + name;
+        std::string path = root + "/" + child;
+        struct stat st;
+        Node node { '?', 0, 0, 0, "" };
+
+        if (name == "." || name == "..") {
+            continue;
+        }
+        ASSERT_EQ(lstat(path.c_str(), &st), 0) << path;
+        node.mode = st.st_mode & 07777;
+        node.uid = st.st_uid;
+        node.gid = st.st_gid;
+        if (S_ISREG(st.st_mode)) {
+            node.type = 'f';
+            node.data = ReadAll(path);
+        } else if (S_ISDIR(st.st_mode)) {
+            node.type = 'd';
+            Walk(root, child, tree);
+        } else if (S_ISLNK(st.st_mode)) {
+            char target[PATH_MAX] = { 0 };
+            node.type = 'l';
+            node.mode = 0777;
+            ASSERT_GT(readlink(path.c_str(), target, sizeof(target) - 1), 0);
+            node.data = target;
+        } else if (S_ISCHR(st.st_mode)) {
+            node.type = 'c';
+            node.data = std::to_string(major(st.st_rdev)) + ":" + std::to_string(minor(st.st_rdev));
+        } else if (S_ISFIFO(st.st_mode)) {
+            node.type = 'p';
+        }
+        tree[child] = node;
+    }
+    closedir(dp);
+}
+
+void ExpectTree(const std::string &root, const Tree &expected)
+{
+    Tree actual;
+
+    Walk(root, "", actual);
+    for (const auto &it : expected) {
+        auto found = actual.find(it.first);
+        if (found == actual.end()) {
+            ADD_FAILURE() << "missing " << it.first;
+            continue;
+        }
+        EXPECT_EQ(found->second, it.second) << it.first;
+    }
+    for (const auto &it : actual) {
+        if (expected.find(it.first) == expected.end()) {
+            ADD_FAILURE() << "unexpected " << it.first << ": " << it.second;
+        }
+    }
+}
+
+ssize_t ReadFd(void *context, void *buf, size_t len)
+{
+    return read(*(int *)context, buf, len);
+}
+} // namespace
+
+class UtilArchiveUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/util_archive_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_base = tmpl;
+        m_root = m_base + "/root";
+        m_outside = m_base + "/outside";
+        ASSERT_EQ(mkdir(m_root.c_str(), 0755), 0);
+        ASSERT_EQ(mkdir(m_outside.c_str(), 0755), 0);
+        ASSERT_EQ(chmod(m_root.c_str(), 0755), 0);
+        ASSERT_EQ(chmod(m_outside.c_str(), 0755), 0);
+        WriteFile(m_outside + "/secret", "secret");
+        m_umask = umask(022);
+    }
+
+    void TearDown() override
+    {
+        (void)umask(m_umask);
+        (void)util_recursive_rmdir(m_base.c_str(), 0);
+    }
+
+    int Unpack(const TarBuilder &tar, whiteout_format_type format, unsigned int uid = 0, unsigned int gid = 0)
+    {
+        std::string layer = m_base + "/layer.tar";
+        struct archive_options options = { format, uid, gid, nullptr, nullptr };
+        struct io_read_wrapper content = { 0 };
+        char *errmsg = nullptr;
+        int fd = -1;
+        int ret;
+
+        WriteFile(layer, tar.Finish());
+        fd = open(layer.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return -1;
+        }
+        content.context = &fd;
+        content.read = ReadFd;
+        ret = archive_unpack(&content, m_root.c_str(), &options, &errmsg);
+        free(errmsg);
+        close(fd);
+        return ret;
+    }
+
+    void WriteFile(const std::string &path, const std::string &data)
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        ASSERT_GE(fd, 0) << path;
+        ASSERT_EQ(write(fd, data.c_str(), data.size()), (ssize_t)data.size());
+        close(fd);
+    }
+
+    void ExpectOutsideUntouched()
+    {
+        Tree outside = { { "secret", RegNode("secret") } };
+        struct stat st;
+
+        ExpectTree(m_outside, outside);
+        ASSERT_EQ(stat((m_outside + "/secret").c_str(), &st), 0);
+        EXPECT_EQ(st.st_nlink, 1U);
+        EXPECT_NE(access((m_base + "/evil").c_str(), F_OK), 0);
+    }
+
+    std::string m_base;
+    std::string m_root;
+    std::string m_outside;
+    mode_t m_umask { 0 };
+};
+
+TEST_F(UtilArchiveUnitTest, test_unpack_regular_entries)
+{
+    TarBuilder tar;
+    struct stat file_st;
+    struct stat hard_st;
+
+    tar.Dir("dir/", 0750);
+    tar.File("dir/file", "hello", 0640);
+    tar.Hardlink("dir/hard", "dir/file");
+    tar.Symlink("dir/link", "file");
+    tar.Symlink("abs", "/etc/passwd");
+    tar.File("exec", "#!/bin/sh\n", 0755);
+    tar.Dir("empty/", 0700);
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "dir", DirNode(0750) },
+        { "dir/file", RegNode("hello", 0640) },
+        { "dir/hard", RegNode("hello", 0640) },
+        { "dir/link", LinkNode("file") },
+        { "abs", LinkNode("/etc/passwd") },
+        { "exec", RegNode("#!/bin/sh\n", 0755) },
+        { "empty", DirNode(0700) },
+    });
+
+    ASSERT_EQ(lstat((m_root + "/dir/file").c_str(), &file_st), 0);
+    ASSERT_EQ(lstat((m_root + "/dir/hard").c_str(), &hard_st), 0);
+    EXPECT_EQ(file_st.st_ino, hard_st.st_ino);
+    EXPECT_EQ(file_st.st_nlink, 2U);
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_replace_existing)
+{
+    TarBuilder tar;
+
+    // a directory replaced by a file is removed with its content, a symlink in it is not followed
+    ASSERT_EQ(mkdir((m_root + "/was_dir").c_str(), 0755), 0);
+    ASSERT_EQ(symlink(m_outside.c_str(), (m_root + "/was_dir/out").c_str()), 0);
+    WriteFile(m_root + "/was_dir/file", "old");
+    WriteFile(m_root + "/was_file", "old");
+    ASSERT_EQ(symlink(m_outside.c_str(), (m_root + "/was_link").c_str()), 0);
+
+    tar.File("was_dir", "new");
+    tar.Dir("was_file/");
+    tar.File("was_link", "new");
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "was_dir", RegNode("new") },
+        { "was_file", DirNode() },
+        { "was_link", RegNode("new") },
+    });
+    ExpectOutsideUntouched();
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_symlink_escapes)
+{
+    TarBuilder tar;
+
+    ASSERT_EQ(symlink(m_outside.c_str(), (m_root + "/escape").c_str()), 0);
+    tar.File("escape/secret", "pwned");
+    EXPECT_NE(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+    ExpectOutsideUntouched();
+
+    TarBuilder hardlink;
+    hardlink.Hardlink("hard", "escape/secret");
+    EXPECT_NE(Unpack(hardlink, NONE_WHITEOUT_FORMATE), 0);
+    ExpectOutsideUntouched();
+
+    // symlinks of the archive itself are not followed either
+    TarBuilder self;
+    self.Symlink("up", "..");
+    self.File("up/evil", "pwned");
+    EXPECT_NE(Unpack(self, NONE_WHITEOUT_FORMATE), 0);
+    ExpectOutsideUntouched();
+
+    // paths with dot dot are rejected
+    TarBuilder dotdot;
+    dotdot.File("../evil", "pwned");
+    EXPECT_NE(Unpack(dotdot, NONE_WHITEOUT_FORMATE), 0);
+    ExpectOutsideUntouched();
+
+    TarBuilder nested;
+    nested.File("a/../../outside/secret", "pwned");
+    EXPECT_NE(Unpack(nested, NONE_WHITEOUT_FORMATE), 0);
+    ExpectOutsideUntouched();
+
+    ExpectTree(m_root, {
+        { "escape", LinkNode(m_outside) },
+        { "up", LinkNode("..") },
+    });
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_remove_whiteouts)
+{
+    TarBuilder tar;
+
+    ASSERT_EQ(mkdir((m_root + "/a").c_str(), 0755), 0);
+    WriteFile(m_root + "/a/x", "x");
+    WriteFile(m_root + "/a/y", "y");
+    ASSERT_EQ(mkdir((m_root + "/b").c_str(), 0755), 0);
+    ASSERT_EQ(mkdir((m_root + "/b/sub").c_str(), 0755), 0);
+    WriteFile(m_root + "/b/sub/z", "z");
+    ASSERT_EQ(symlink(m_outside.c_str(), (m_root + "/b/out").c_str()), 0);
+    // the content of a removed directory is removed, what its symlinks point to is not
+    ASSERT_EQ(mkdir((m_root + "/c").c_str(), 0755), 0);
+    ASSERT_EQ(symlink(m_outside.c_str(), (m_root + "/c/out").c_str()), 0);
+    ASSERT_EQ(symlink((m_outside + "/secret").c_str(), (m_root + "/c/secret").c_str()), 0);
+
+    tar.Dir("a/");
+    tar.File("a/.wh.x", "");
+    tar.Dir("b/");
+    tar.File("b/new", "new");
+    tar.File("b/.wh..wh..opq", "");
+    tar.File(".wh.c", "");
+    tar.File(".wh.missing", "");
+    ASSERT_EQ(Unpack(tar, REMOVE_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "a", DirNode() },
+        { "a/y", RegNode("y") },
+        { "b", DirNode() },
+        { "b/new", RegNode("new") },
+    });
+    ExpectOutsideUntouched();
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_overlay_whiteouts)
+{
+    TarBuilder tar;
+    char value[8] = { 0 };
+
+    if (geteuid() != 0) {
+        std::cout << "overlay whiteouts need root, skip" << std::endl;
+        return;
+    }
+
+    tar.Dir("a/");
+    tar.File("a/.wh.x", "");
+    tar.Dir("b/");
+    tar.File("b/.wh..wh..opq", "");
+    tar.File("b/new", "new");
+    ASSERT_EQ(Unpack(tar, OVERLAY_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "a", DirNode() },
+        { "a/x", Node { 'c', 0, 0, 0, "0:0" } },
+        { "b", DirNode() },
+        { "b/new", RegNode("new") },
+    });
+    if (lgetxattr((m_root + "/b").c_str(), "trusted.overlay.opaque", value, sizeof(value)) < 0) {
+        ASSERT_EQ(errno, ENOTSUP);
+    } else {
+        EXPECT_STREQ(value, "y");
+    }
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_xattrs)
+{
+    TarBuilder tar;
+    char value[16] = { 0 };
+
+    if (geteuid() != 0) {
+        std::cout << "trusted xattrs need root, skip" << std::endl;
+        return;
+    }
+
+    // xattrs of a symlink are set on the symlink itself, not on what it points to
+    tar.Pax("SCHILY.xattr.trusted.ut", "file");
+    tar.File("file", "data");
+    tar.Pax("SCHILY.xattr.trusted.ut", "link");
+    tar.Symlink("link", m_outside + "/secret");
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    if (lgetxattr((m_root + "/file").c_str(), "trusted.ut", value, sizeof(value)) < 0) {
+        ASSERT_EQ(errno, ENOTSUP);
+        return;
+    }
+    EXPECT_STREQ(value, "file");
+    memset(value, 0, sizeof(value));
+    ASSERT_GT(lgetxattr((m_root + "/link").c_str(), "trusted.ut", value, sizeof(value)), 0);
+    EXPECT_STREQ(value, "link");
+    EXPECT_LT(lgetxattr((m_outside + "/secret").c_str(), "trusted.ut", value, sizeof(value)), 0);
+    ExpectOutsideUntouched();
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_ownership)
+{
+    TarBuilder tar;
+
+    if (geteuid() != 0) {
+        std::cout << "ownership needs root, skip" << std::endl;
+        return;
+    }
+
+    // the owner of the archive is replaced by the one of the options
+    tar.Dir("dir/", 0755, 1, 1);
+    tar.File("dir/file", "data", 0600, 2, 2);
+    tar.Symlink("dir/link", "file");
+    tar.Hardlink("dir/hard", "dir/file");
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE, 1000, 1001), 0);
+
+    ExpectTree(m_root, {
+        { "dir", DirNode(0755, 1000, 1001) },
+        { "dir/file", RegNode("data", 0600, 1000, 1001) },
+        { "dir/link", LinkNode("file", 1000, 1001) },
+        { "dir/hard", RegNode("data", 0600, 1000, 1001) },
+    });
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_hardlink_with_data)
+{
+    TarBuilder tar;
+    struct stat file_st;
+    struct stat hard_st;
+
+    tar.File("file", "old", 0600);
+    tar.Pax("mtime", "1606176000");
+    tar.Hardlink("hard", "file", "new");
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "file", RegNode("new", 0644) },
+        { "hard", RegNode("new", 0644) },
+    });
+    ASSERT_EQ(lstat((m_root + "/file").c_str(), &file_st), 0);
+    ASSERT_EQ(lstat((m_root + "/hard").c_str(), &hard_st), 0);
+    EXPECT_EQ(file_st.st_ino, hard_st.st_ino);
+
+    // opening a fifo for write would block until a reader comes, it is refused instead
+    TarBuilder fifo;
+    fifo.Fifo("fifo");
+    fifo.Pax("mtime", "1606176000");
+    fifo.Hardlink("fifo_hard", "fifo", "data");
+    EXPECT_NE(Unpack(fifo, NONE_WHITEOUT_FORMATE), 0);
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_special_file_mode)
+{
+    TarBuilder tar;
+
+    // created under the umask, the mode of the archive is restored afterwards
+    tar.Fifo("fifo", 0666);
+    tar.Fifo("private", 0600);
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    ExpectTree(m_root, {
+        { "fifo", Node { 'p', 0666, 0, 0, "" } },
+        { "private", Node { 'p', 0600, 0, 0, "" } },
+    });
+}
+
+TEST_F(UtilArchiveUnitTest, test_unpack_fflags)
+{
+    TarBuilder tar;
+    std::string probe = m_base + "/probe";
+    int flags = FS_NODUMP_FL;
+    int fd = -1;
+
+    WriteFile(probe, "");
+    fd = open(probe.c_str(), O_RDONLY | O_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    if (ioctl(fd, FS_IOC_SETFLAGS, &flags) != 0) {
+        close(fd);
+        std::cout << "inode flags are not supported by the filesystem, skip" << std::endl;
+        return;
+    }
+    close(fd);
+
+    tar.Pax("SCHILY.fflags", "nodump");
+    tar.Dir("dir/");
+    tar.Pax("SCHILY.fflags", "nodump");
+    tar.File("dir/file", "data");
+    tar.File("plain", "data");
+    ASSERT_EQ(Unpack(tar, NONE_WHITEOUT_FORMATE), 0);
+
+    for (const char *name : { "dir", "dir/file", "plain" }) {
+        fd = open((m_root + "/" + name).c_str(), O_RDONLY | O_CLOEXEC);
+        ASSERT_GE(fd, 0) << name;
+        flags = 0;
+        ASSERT_EQ(ioctl(fd, FS_IOC_GETFLAGS, &flags), 0) << name;
+        close(fd);
+        EXPECT_EQ((flags & FS_NODUMP_FL) != 0, strcmp(name, "plain") != 0) << name;
+    }
+}
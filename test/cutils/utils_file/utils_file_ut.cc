@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: utils_file copy unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+/*
+ * util_copy_file tries FICLONE, copy_file_range, sendfile and pread/pwrite in turn. The
+ * calls are wrapped, so each step of the chain can be made to fail the way it does on
+ * filesystems and kernels without it, and the copy must come out the same.
+ */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <atomic>
+#include <string>
+#include <gtest/gtest.h>
+#include "utils_file.h"
+
+namespace {
+enum WrapMode {
+    WRAP_REAL = 0,
+    // fails with g_errno
+    WRAP_FAIL,
+    // copies nothing and returns 0
+    WRAP_ZERO,
+};
+
+WrapMode g_clone_mode = WRAP_REAL;
+WrapMode g_range_mode = WRAP_REAL;
+WrapMode g_sendfile_mode = WRAP_REAL;
+int g_range_errno = 0;
+int g_sendfile_errno = 0;
+// the copy workers of util_copy_dir_recursive call them too
+std::atomic<int> g_clone_calls { 0 };
+std::atomic<int> g_range_calls { 0 };
+std::atomic<int> g_sendfile_calls { 0 };
+std::atomic<int> g_pread_calls { 0 };
+
+void ResetWraps()
+{
+    g_clone_mode = WRAP_REAL;
+    g_range_mode = WRAP_REAL;
+    g_sendfile_mode = WRAP_REAL;
+    g_clone_calls = 0;
+    g_range_calls = 0;
+    g_sendfile_calls = 0;
+    g_pread_calls = 0;
+}
+} // namespace
+
+extern "C" {
+    int __real_ioctl(int fd, unsigned long request, ...);
+    long __real_syscall(long number, ...);
+    ssize_t __real_sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+    ssize_t __real_pread(int fd, void *buf, size_t count, off_t offset);
+
+    int __wrap_ioctl(int fd, unsigned long request, ...)
+    {
+        va_list ap;
+        void *arg = nullptr;
+
+        va_start(ap, request);
+        arg = va_arg(ap, void *);
+        va_end(ap);
+        if (request == FICLONE) {
+            g_clone_calls++;
+            if (g_clone_mode == WRAP_FAIL) {
+                errno = EOPNOTSUPP;
+                return -1;
+            }
+        }
+        return __real_ioctl(fd, request, arg);
+    }
+
+    long __wrap_syscall(long number, ...)
+    {
+        va_list ap;
+        long args[6];
+
+        va_start(ap, number);
+        for (int i = 0; i < 6; i++) {
+            args[i] = va_arg(ap, long);
+        }
+        va_end(ap);
+#ifdef __NR_copy_file_range
+        if (number == __NR_copy_file_range) {
+            g_range_calls++;
+            if (g_range_mode == WRAP_FAIL) {
+                errno = g_range_errno;
+                return -1;
+            }
+            if (g_range_mode == WRAP_ZERO) {
+                return 0;
+            }
+        }
+#endif
+        return __real_syscall(number, args[0], args[1], args[2], args[3], args[4], args[5]);
+    }
+
+    ssize_t __wrap_sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+    {
+        g_sendfile_calls++;
+        if (g_sendfile_mode == WRAP_FAIL) {
+            errno = g_sendfile_errno;
+            return -1;
+        }
+        if (g_sendfile_mode == WRAP_ZERO) {
+            return 0;
+        }
+        return __real_sendfile(out_fd, in_fd, offset, count);
+    }
+
+    ssize_t __wrap_pread(int fd, void *buf, size_t count, off_t offset)
+    {
+        g_pread_calls++;
+        return __real_pread(fd, buf, count, offset);
+    }
+}
+
+class UtilsFileCopyUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/utils_file_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_base = tmpl;
+        m_src = m_base + "/src";
+        m_dst = m_base + "/dst";
+        ResetWraps();
+        // filesystems with reflink would clone before any other method is used
+        g_clone_mode = WRAP_FAIL;
+    }
+
+    void TearDown() override
+    {
+        ResetWraps();
+        (void)util_recursive_rmdir(m_base.c_str(), 0);
+    }
+
+    static std::string Pattern(size_t len, char seed)
+    {
+        std::string data(len, '\0');
+
+        for (size_t i = 0; i < len; i++) {
+            data[i] = (char)(seed + i * 7 % 251);
+        }
+        return data;
+    }
+
+    void WriteAt(const std::string &path, off_t offset, const std::string &data)
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+
+        ASSERT_GE(fd, 0) << path;
+        ASSERT_EQ(pwrite(fd, data.c_str(), data.size(), offset), (ssize_t)data.size());
+        close(fd);
+    }
+
+    // data, a hole, data over a chunk of the copy, a hole and a hole at the end
+    void MakeSparse(const std::string &path)
+    {
+        WriteAt(path, 0, Pattern(4096, 'a'));
+        WriteAt(path, 1024 * 1024, Pattern(1536 * 1024 + 123, 'b'));
+        WriteAt(path, 4 * 1024 * 1024, Pattern(8192, 'c'));
+        ASSERT_EQ(truncate(path.c_str(), 6 * 1024 * 1024), 0);
+    }
+
+    std::string ReadFile(const std::string &path)
+    {
+        std::string data;
+        char buf[65536];
+        ssize_t n;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return "cannot open " + path;
+        }
+        while ((n = read(fd, buf, sizeof(buf))) > 0) {
+            data.append(buf, (size_t)n);
+        }
+        close(fd);
+        return data;
+    }
+
+    void ExpectSameFile(const std::string &src, const std::string &dst)
+    {
+        struct stat src_st;
+        struct stat dst_st;
+
+        ASSERT_EQ(stat(src.c_str(), &src_st), 0);
+        ASSERT_EQ(stat(dst.c_str(), &dst_st), 0);
+        ASSERT_EQ(dst_st.st_size, src_st.st_size);
+        ASSERT_TRUE(ReadFile(src) == ReadFile(dst));
+        // holes are kept where the filesystem reports them
+        if ((off_t)src_st.st_blocks * 512 < src_st.st_size) {
+            ASSERT_LE(dst_st.st_blocks, src_st.st_blocks + 64);
+        }
+    }
+
+    std::string m_base;
+    std::string m_src;
+    std::string m_dst;
+};
+
+TEST_F(UtilsFileCopyUnitTest, test_clone_tried_first)
+{
+    g_clone_mode = WRAP_REAL;
+    MakeSparse(m_src);
+    ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(m_src, m_dst);
+    ASSERT_EQ(g_clone_calls, 1);
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_copy_file_range)
+{
+    MakeSparse(m_src);
+    ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(m_src, m_dst);
+    ASSERT_EQ(g_clone_calls, 1);
+#ifdef __NR_copy_file_range
+    ASSERT_GT(g_range_calls, 0);
+#endif
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_fallback_to_sendfile)
+{
+    const int errnos[] = { ENOSYS, EXDEV, EINVAL, EOPNOTSUPP };
+
+    MakeSparse(m_src);
+    g_range_mode = WRAP_FAIL;
+    for (int err : errnos) {
+        g_range_errno = err;
+        g_range_calls = 0;
+        g_sendfile_calls = 0;
+        ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0) << err;
+        ExpectSameFile(m_src, m_dst);
+#ifdef __NR_copy_file_range
+        // not tried again for the next data of the file
+        ASSERT_EQ(g_range_calls, 1) << err;
+#endif
+        ASSERT_GT(g_sendfile_calls, 0) << err;
+    }
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_copy_file_range_returns_zero)
+{
+    MakeSparse(m_src);
+    g_range_mode = WRAP_ZERO;
+    ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    // not taken for the end of the file, the data is copied by sendfile
+    ExpectSameFile(m_src, m_dst);
+    ASSERT_GT(g_sendfile_calls, 0);
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_fallback_to_read_write)
+{
+    MakeSparse(m_src);
+    g_range_mode = WRAP_FAIL;
+    g_range_errno = ENOSYS;
+    g_sendfile_mode = WRAP_FAIL;
+    g_sendfile_errno = EINVAL;
+    ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(m_src, m_dst);
+    ASSERT_EQ(g_sendfile_calls, 1);
+    ASSERT_GT(g_pread_calls, 0);
+
+    // sendfile copying nothing falls back as well
+    g_sendfile_mode = WRAP_ZERO;
+    g_pread_calls = 0;
+    ASSERT_EQ(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(m_src, m_dst);
+    ASSERT_GT(g_pread_calls, 0);
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_copy_errors)
+{
+    MakeSparse(m_src);
+    // not a reason to fall back
+    g_range_mode = WRAP_FAIL;
+    g_range_errno = EIO;
+    ASSERT_NE(util_copy_file(m_src.c_str(), m_dst.c_str(), 0644), 0);
+    ASSERT_EQ(g_sendfile_calls, 0);
+
+    ASSERT_NE(util_copy_file((m_base + "/missing").c_str(), m_dst.c_str(), 0644), 0);
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_sparse_and_small_files)
+{
+    std::string holes = m_base + "/holes";
+    std::string empty = m_base + "/empty";
+    std::string small = m_base + "/small";
+
+    // only a hole
+    WriteAt(holes, 0, "");
+    ASSERT_EQ(truncate(holes.c_str(), 2 * 1024 * 1024), 0);
+    ASSERT_EQ(util_copy_file(holes.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(holes, m_dst);
+
+    WriteAt(empty, 0, "");
+    ASSERT_EQ(util_copy_file(empty.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(empty, m_dst);
+
+    WriteAt(small, 0, "small");
+    ASSERT_EQ(util_copy_file(small.c_str(), m_dst.c_str(), 0644), 0);
+    ExpectSameFile(small, m_dst);
+
+    // files of pseudo filesystems have no size
+    ASSERT_EQ(util_copy_file("/proc/self/status", m_dst.c_str(), 0644), 0);
+    ASSERT_NE(ReadFile(m_dst).find("Name:"), std::string::npos);
+}
+
+TEST_F(UtilsFileCopyUnitTest, test_copy_dir_hardlinks)
+{
+    std::string src = m_base + "/tree";
+    std::string dst = m_base + "/copy";
+    struct stat a;
+    struct stat b;
+    struct stat c;
+    struct stat d;
+    struct stat e;
+
+    ASSERT_EQ(mkdir(src.c_str(), 0755), 0);
+    ASSERT_EQ(mkdir((src + "/sub").c_str(), 0750), 0);
+    WriteAt(src + "/a", 0, Pattern(100 * 1024, 'a'));
+    ASSERT_EQ(link((src + "/a").c_str(), (src + "/sub/b").c_str()), 0);
+    ASSERT_EQ(link((src + "/a").c_str(), (src + "/sub/c").c_str()), 0);
+    WriteAt(src + "/d", 0, "d");
+    ASSERT_EQ(link((src + "/d").c_str(), (src + "/sub/e").c_str()), 0);
+    // big enough for the copy workers
+    for (int i = 0; i < 8; i++) {
+        WriteAt(src + "/big" + std::to_string(i), 0, Pattern(256 * 1024, (char)('0' + i)));
+    }
+
+    ASSERT_EQ(util_copy_dir_recursive((char *)dst.c_str(), (char *)src.c_str()), 0);
+
+    ASSERT_EQ(stat((dst + "/a").c_str(), &a), 0);
+    ASSERT_EQ(stat((dst + "/sub/b").c_str(), &b), 0);
+    ASSERT_EQ(stat((dst + "/sub/c").c_str(), &c), 0);
+    ASSERT_EQ(stat((dst + "/d").c_str(), &d), 0);
+    ASSERT_EQ(stat((dst + "/sub/e").c_str(), &e), 0);
+    ASSERT_EQ(a.st_ino, b.st_ino);
+    ASSERT_EQ(a.st_ino, c.st_ino);
+    ASSERT_EQ(a.st_nlink, 3U);
+    ASSERT_EQ(d.st_ino, e.st_ino);
+    ASSERT_NE(a.st_ino, d.st_ino);
+    ExpectSameFile(src + "/a", dst + "/sub/c");
+    ExpectSameFile(src + "/d", dst + "/sub/e");
+    for (int i = 0; i < 8; i++) {
+        ExpectSameFile(src + "/big" + std::to_string(i), dst + "/big" + std::to_string(i));
+    }
+    ASSERT_EQ(stat((dst + "/sub").c_str(), &b), 0);
+    ASSERT_EQ(b.st_mode & 07777, 0750U);
+}
@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: util_gzip unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+/*
+ * Files are compressed with util_compress_file and read back with util_decompress_file. The
+ * gzip encoder splits its input into jobs run in parallel on every cpu the caller may use,
+ * the serial runs pin the test thread to a single cpu.
+ */
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <zlib.h>
+#include <string>
+#include <gtest/gtest.h>
+#include "util_gzip.h"
+#include "utils_file.h"
+
+namespace {
+// more than a batch of jobs on a machine with 8 cpus, the most the encoder uses
+const size_t LARGE_SIZE = 8 * 128 * 1024 * 2 + 12345;
+
+ssize_t StringWrite(void *context, const void *data, size_t len)
+{
+    static_cast<std::string *>(context)->append(static_cast<const char *>(data), len);
+    return (ssize_t)len;
+}
+
+// compressible text mixed with runs of pseudo random bytes, so some jobs deflate well and some not
+std::string TestData(size_t size)
+{
+    std::string data;
+    unsigned int seed = 42;
+
+    data.reserve(size);
+    while (data.size() < size) {
+        if ((data.size() / 4096) % 3 == 0) {
+            for (int i = 0; i < 4096 && data.size() < size; i++) {
+                data += (char)(rand_r(&seed) & 0xff);
+            }
+        } else {
+            data += "line " + std::to_string(data.size()) + " of some compressible test data\n";
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+// runs the scope on a single cpu, so the encoder starts a single job
+class SingleCpu {
+public:
+    SingleCpu()
+    {
+        cpu_set_t one;
+
+        m_pinned = sched_getaffinity(0, sizeof(m_saved), &m_saved) == 0;
+        if (!m_pinned) {
+            return;
+        }
+        CPU_ZERO(&one);
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &m_saved)) {
+                CPU_SET(i, &one);
+                break;
+            }
+        }
+        m_pinned = sched_setaffinity(0, sizeof(one), &one) == 0;
+    }
+
+    ~SingleCpu()
+    {
+        if (m_pinned) {
+            (void)sched_setaffinity(0, sizeof(m_saved), &m_saved);
+        }
+    }
+
+    bool Pinned() const
+    {
+        return m_pinned;
+    }
+
+private:
+    cpu_set_t m_saved;
+    bool m_pinned { false };
+};
+} // namespace
+
+class UtilGzipUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/util_gzip_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_base = tmpl;
+        m_src = m_base + "/src";
+        m_dst = m_base + "/dst";
+    }
+
+    void TearDown() override
+    {
+        (void)util_recursive_rmdir(m_base.c_str(), 0);
+    }
+
+    void WriteFile(const std::string &path, const std::string &data)
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        ASSERT_GE(fd, 0) << path;
+        ASSERT_EQ(util_write_nointr(fd, data.c_str(), data.size()), (ssize_t)data.size());
+        close(fd);
+    }
+
+    std::string ReadFile(const std::string &path)
+    {
+        std::string data;
+        char buf[8192];
+        ssize_t n;
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (fd < 0) {
+            return data;
+        }
+        while ((n = util_read_nointr(fd, buf, sizeof(buf))) > 0) {
+            data.append(buf, (size_t)n);
+        }
+        close(fd);
+        return data;
+    }
+
+    // compress data into m_dst, returns the compressed bytes
+    std::string Compress(compression_type_t type, const std::string &data)
+    {
+        WriteFile(m_src, data);
+        if (util_compress_file(type, m_src.c_str(), m_dst.c_str(), 0644) != 0) {
+            return "";
+        }
+        return ReadFile(m_dst);
+    }
+
+    int Decompress(const std::string &compressed, std::string &out)
+    {
+        std::string path = m_base + "/compressed";
+        struct io_write_wrapper writer = { 0 };
+
+        WriteFile(path, compressed);
+        out.clear();
+        writer.context = &out;
+        writer.write_func = StringWrite;
+        return util_decompress_file(path.c_str(), &writer);
+    }
+
+    void ExpectRoundTrip(compression_type_t type, const std::string &data)
+    {
+        std::string compressed = Compress(type, data);
+        compression_type_t detected = COMPRESSION_NONE;
+        std::string out;
+
+        ASSERT_FALSE(compressed.empty());
+        ASSERT_EQ(util_detect_compression(m_dst.c_str(), &detected), 0);
+        ASSERT_EQ(detected, type);
+        ASSERT_EQ(Decompress(compressed, out), 0);
+        ASSERT_EQ(out.size(), data.size());
+        ASSERT_TRUE(out == data);
+    }
+
+    // decode with zlib alone, the output of the parallel encoder must be plain gzip
+    std::string ZlibRead(const std::string &path)
+    {
+        std::string data;
+        char buf[8192];
+        int n;
+        gzFile file = gzopen(path.c_str(), "rb");
+
+        if (file == nullptr) {
+            return data;
+        }
+        while ((n = gzread(file, buf, sizeof(buf))) > 0) {
+            data.append(buf, (size_t)n);
+        }
+        if (n < 0) {
+            data = "gzread failed";
+        }
+        gzclose(file);
+        return data;
+    }
+
+    void ZlibWrite(const std::string &path, const std::string &data, const char *mode)
+    {
+        gzFile file = gzopen(path.c_str(), mode);
+
+        ASSERT_NE(file, nullptr);
+        ASSERT_EQ(gzwrite(file, data.c_str(), (unsigned int)data.size()), (int)data.size());
+        ASSERT_EQ(gzclose(file), Z_OK);
+    }
+
+    std::string m_base;
+    std::string m_src;
+    std::string m_dst;
+};
+
+TEST_F(UtilGzipUnitTest, test_gzip_round_trip)
+{
+    const size_t sizes[] = { 0, 1, 4096, 128 * 1024 - 1, 128 * 1024, 128 * 1024 + 1, LARGE_SIZE };
+
+    for (size_t size : sizes) {
+        std::string data = TestData(size);
+        ExpectRoundTrip(COMPRESSION_GZIP, data);
+        ASSERT_TRUE(ZlibRead(m_dst) == data) << size;
+    }
+}
+
+TEST_F(UtilGzipUnitTest, test_gzip_serial_same_as_parallel)
+{
+    std::string data = TestData(LARGE_SIZE);
+    std::string parallel = Compress(COMPRESSION_GZIP, data);
+    std::string serial;
+
+    ASSERT_FALSE(parallel.empty());
+    {
+        SingleCpu pin;
+        if (!pin.Pinned()) {
+            std::cout << "Cannot pin the test to a cpu, skip" << std::endl;
+            return;
+        }
+        ExpectRoundTrip(COMPRESSION_GZIP, data);
+        serial = ReadFile(m_dst);
+    }
+    ASSERT_TRUE(ZlibRead(m_dst) == data);
+    // jobs have a fixed size and each one is primed with the input before it, so the
+    // number of jobs run at once does not change the stream
+    ASSERT_EQ(serial.size(), parallel.size());
+    ASSERT_TRUE(serial == parallel);
+}
+
+TEST_F(UtilGzipUnitTest, test_gzip_decompress_zlib_streams)
+{
+    std::string path = m_base + "/zlib.gz";
+    std::string first = TestData(300 * 1024);
+    std::string second = "second member\n";
+    std::string out;
+
+    // a stream of the serial zlib encoder
+    ZlibWrite(path, first, "wb9");
+    ASSERT_EQ(Decompress(ReadFile(path), out), 0);
+    ASSERT_TRUE(out == first);
+
+    // concatenated members are read as one stream
+    std::string members = ReadFile(path);
+    ZlibWrite(path, second, "wb1");
+    members += ReadFile(path);
+    ASSERT_EQ(Decompress(members, out), 0);
+    ASSERT_TRUE(out == first + second);
+}
+
+TEST_F(UtilGzipUnitTest, test_gzip_truncated)
+{
+    std::string data = TestData(LARGE_SIZE);
+    std::string compressed = Compress(COMPRESSION_GZIP, data);
+    // within the header, within the deflate data, and the trailer cut
+    const size_t cuts[] = { 5, 11, compressed.size() / 2, compressed.size() - 8, compressed.size() - 1 };
+    std::string out;
+
+    ASSERT_FALSE(compressed.empty());
+    for (size_t cut : cuts) {
+        ASSERT_NE(Decompress(compressed.substr(0, cut), out), 0) << cut;
+    }
+}
+
+TEST_F(UtilGzipUnitTest, test_gzip_corrupt)
+{
+    std::string data = TestData(LARGE_SIZE);
+    std::string compressed = Compress(COMPRESSION_GZIP, data);
+    std::string bad;
+    std::string out;
+
+    ASSERT_FALSE(compressed.empty());
+
+    // crc32 of the trailer
+    bad = compressed;
+    bad[bad.size() - 8] ^= 0x55;
+    ASSERT_NE(Decompress(bad, out), 0);
+
+    // size of the trailer
+    bad = compressed;
+    bad[bad.size() - 1] ^= 0x55;
+    ASSERT_NE(Decompress(bad, out), 0);
+
+    // deflate data, found by the data checks of inflate or by the crc
+    bad = compressed;
+    for (size_t i = compressed.size() / 3; i < compressed.size() / 3 + 16; i++) {
+        bad[i] ^= 0xff;
+    }
+    ASSERT_NE(Decompress(bad, out), 0);
+}
+
+TEST_F(UtilGzipUnitTest, test_uncompressed_copied)
+{
+    const std::string inputs[] = { "", "x", "\x1f", "plain text, not compressed\n", TestData(300 * 1024) };
+    std::string out;
+
+    for (const auto &data : inputs) {
+        ASSERT_EQ(Decompress(data, out), 0);
+        ASSERT_TRUE(out == data);
+    }
+}
+
+#ifdef ENABLE_ZSTD
+TEST_F(UtilGzipUnitTest, test_zstd_round_trip)
+{
+    const size_t sizes[] = { 0, 1, 4096, 128 * 1024 + 1, LARGE_SIZE };
+
+    ASSERT_TRUE(util_compression_supported(COMPRESSION_ZSTD));
+    for (size_t size : sizes) {
+        ExpectRoundTrip(COMPRESSION_ZSTD, TestData(size));
+    }
+
+    SingleCpu pin;
+    if (!pin.Pinned()) {
+        std::cout << "Cannot pin the test to a cpu, skip" << std::endl;
+        return;
+    }
+    ExpectRoundTrip(COMPRESSION_ZSTD, TestData(LARGE_SIZE));
+}
+
+TEST_F(UtilGzipUnitTest, test_zstd_truncated)
+{
+    std::string compressed = Compress(COMPRESSION_ZSTD, TestData(LARGE_SIZE));
+    const size_t cuts[] = { 5, compressed.size() / 2, compressed.size() - 1 };
+    std::string out;
+
+    ASSERT_FALSE(compressed.empty());
+    for (size_t cut : cuts) {
+        ASSERT_NE(Decompress(compressed.substr(0, cut), out), 0) << cut;
+    }
+}
+
+TEST_F(UtilGzipUnitTest, test_zstd_corrupt)
+{
+    std::string compressed = Compress(COMPRESSION_ZSTD, TestData(LARGE_SIZE));
+    std::string bad;
+    std::string out;
+
+    ASSERT_FALSE(compressed.empty());
+
+    // the reserved bit of the frame header descriptor
+    bad = compressed;
+    bad[4] |= 0x08;
+    ASSERT_NE(Decompress(bad, out), 0);
+
+    // block data cut short within the frame
+    bad = compressed;
+    bad.erase(compressed.size() / 2, 64);
+    ASSERT_NE(Decompress(bad, out), 0);
+}
+#else
+TEST_F(UtilGzipUnitTest, test_zstd_unsupported)
+{
+    ASSERT_FALSE(util_compression_supported(COMPRESSION_ZSTD));
+    ASSERT_NE(util_compress_file(COMPRESSION_ZSTD, "/dev/null", (m_base + "/out").c_str(), 0644), 0);
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: utils_mount_table unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gtest/gtest.h>
+#include "utils_mount_table.h"
+
+TEST(utils_mount_table, test_util_mount_table_get)
+{
+    util_mount_table_t *table = nullptr;
+    util_mount_table_t *again = nullptr;
+    const util_mount_entry_t *entry = nullptr;
+
+    table = util_mount_table_get();
+    ASSERT_NE(table, nullptr);
+    ASSERT_GT(util_mount_table_len(table), 0);
+
+    entry = util_mount_table_find(table, "/");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_STREQ(entry->mountpoint, "/");
+    ASSERT_NE(entry->fstype, nullptr);
+    ASSERT_EQ(util_mount_table_find_id(table, entry->id), entry);
+
+    // shared until mounts change
+    again = util_mount_table_get();
+    ASSERT_EQ(again, table);
+
+    util_mount_table_put(again);
+    util_mount_table_put(table);
+}
+
+TEST(utils_mount_table, test_util_mount_table_load)
+{
+    util_mount_table_t *cached = nullptr;
+    util_mount_table_t *table = nullptr;
+    size_t i;
+
+    cached = util_mount_table_get();
+    ASSERT_NE(cached, nullptr);
+    table = util_mount_table_load();
+    ASSERT_NE(table, nullptr);
+    ASSERT_NE(table, cached);
+
+    ASSERT_EQ(util_mount_table_len(table), util_mount_table_len(cached));
+    for (i = 0; i < util_mount_table_len(table); i++) {
+        ASSERT_EQ(util_mount_table_at(table, i)->id, util_mount_table_at(cached, i)->id);
+        ASSERT_STREQ(util_mount_table_at(table, i)->mountpoint, util_mount_table_at(cached, i)->mountpoint);
+    }
+    ASSERT_EQ(util_mount_table_at(table, i), nullptr);
+
+    ASSERT_EQ(util_mount_table_find(table, "/not/a/mount/point"), nullptr);
+    ASSERT_EQ(util_mount_table_find(nullptr, "/"), nullptr);
+    ASSERT_EQ(util_mount_table_len(nullptr), 0);
+
+    util_mount_table_put(table);
+    util_mount_table_put(cached);
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: utils_trash unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fstream>
+#include <string>
+#include <gtest/gtest.h>
+#include "utils_trash.h"
+#include "utils_file.h"
+#include "utils_array.h"
+
+namespace {
+// trash workers are named trash
+int TrashWorkers()
+{
+    DIR *dir = opendir("/proc/self/task");
+    struct dirent *entry = nullptr;
+    int count = 0;
+
+    if (dir == nullptr) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::ifstream comm(std::string("/proc/self/task/") + entry->d_name + "/comm");
+        std::string name;
+        if (std::getline(comm, name) && name == "trash") {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+} // namespace
+
+class UtilTrashUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/utils_trash_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_root = tmpl;
+        m_trash = m_root + "/" + TRASH_DIR_NAME;
+        m_outside = m_root + "/outside";
+        ASSERT_EQ(mkdir(m_outside.c_str(), 0755), 0);
+        WriteFile(m_outside + "/keep", "keep");
+    }
+
+    void TearDown() override
+    {
+        (void)util_recursive_rmdir(m_root.c_str(), 0);
+    }
+
+    void WriteFile(const std::string &path, const std::string &data)
+    {
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+        ASSERT_GE(fd, 0) << path;
+        ASSERT_EQ(util_write_nointr(fd, data.c_str(), data.size()), (ssize_t)data.size());
+        close(fd);
+    }
+
+    // dirs directories of files files each, nested depth levels deep, with links out of the tree
+    void MakeTree(const std::string &path, int depth, int dirs, int files)
+    {
+        ASSERT_EQ(mkdir(path.c_str(), 0755), 0) << path;
+        for (int i = 0; i < files; i++) {
+            WriteFile(path + "/f" + std::to_string(i), "data");
+        }
+        ASSERT_EQ(symlink(m_outside.c_str(), (path + "/outside").c_str()), 0);
+        ASSERT_EQ(symlink((m_outside + "/keep").c_str(), (path + "/keep").c_str()), 0);
+        if (depth == 0) {
+            return;
+        }
+        for (int i = 0; i < dirs; i++) {
+            MakeTree(path + "/d" + std::to_string(i), depth - 1, dirs, files);
+        }
+    }
+
+    size_t TrashEntries()
+    {
+        char **entries = nullptr;
+        size_t len = 0;
+
+        if (util_list_all_entries(m_trash.c_str(), &entries) != 0) {
+            return (size_t)-1;
+        }
+        len = util_array_len((const char **)entries);
+        util_free_array(entries);
+        return len;
+    }
+
+    bool WaitTrashEmpty()
+    {
+        for (int i = 0; i < 10000; i++) {
+            if (TrashEntries() == 0) {
+                return true;
+            }
+            usleep(1000);
+        }
+        return false;
+    }
+
+    void ExpectOutsideKept()
+    {
+        struct stat st;
+
+        ASSERT_EQ(stat((m_outside + "/keep").c_str(), &st), 0);
+        ASSERT_TRUE(S_ISREG(st.st_mode));
+    }
+
+    std::string m_root;
+    std::string m_trash;
+    std::string m_outside;
+};
+
+TEST_F(UtilTrashUnitTest, test_trash_tree)
+{
+    std::string path = m_root + "/layer";
+
+    MakeTree(path, 2, 4, 16);
+    ASSERT_EQ(util_trash_path(m_root.c_str(), path.c_str()), 0);
+    // moved away at once, deleted in background
+    ASSERT_NE(access(path.c_str(), F_OK), 0);
+    ASSERT_TRUE(WaitTrashEmpty());
+    ExpectOutsideKept();
+}
+
+TEST_F(UtilTrashUnitTest, test_trash_in_place)
+{
+    std::string path = m_root + "/layer";
+
+    // without a root the tree is deleted before returning
+    MakeTree(path, 1, 2, 4);
+    ASSERT_EQ(util_trash_path(nullptr, path.c_str()), 0);
+    ASSERT_NE(access(path.c_str(), F_OK), 0);
+
+    // nothing to delete
+    ASSERT_EQ(util_trash_path(m_root.c_str(), path.c_str()), 0);
+    ExpectOutsideKept();
+}
+
+TEST_F(UtilTrashUnitTest, test_resume_after_kill)
+{
+    std::string path = m_root + "/layer";
+    int status = 0;
+    pid_t pid;
+
+    MakeTree(path, 2, 8, 64);
+    // no trash work is running, so the child does not inherit a held lock
+    pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // the daemon is killed right after moving the tree to trash
+        if (util_trash_path(m_root.c_str(), path.c_str()) != 0) {
+            _exit(1);
+        }
+        (void)kill(getpid(), SIGKILL);
+        _exit(2);
+    }
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFSIGNALED(status));
+    ASSERT_NE(access(path.c_str(), F_OK), 0);
+    ASSERT_GT(TrashEntries(), 0U);
+
+    // and a partly deleted tree left by an older run
+    MakeTree(m_trash + "/old-1", 1, 4, 8);
+    ASSERT_EQ(util_recursive_rmdir((m_trash + "/old-1/d0").c_str(), 0), 0);
+
+    // on restart what is left in trash is deleted
+    ASSERT_EQ(util_trash_resume(m_root.c_str()), 0);
+    ASSERT_TRUE(WaitTrashEmpty());
+    ExpectOutsideKept();
+    // the trash of a root is resumed once per process
+    ASSERT_EQ(util_trash_resume(m_root.c_str()), 0);
+}
+
+TEST_F(UtilTrashUnitTest, test_trash_split)
+{
+    std::string path = m_root + "/layer";
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    bool split = false;
+    ssize_t n;
+    int fd;
+
+    // workers start while all others are busy, trash some trees at once until some are idle
+    for (int round = 0; round < 10 && TrashWorkers() < 2; round++) {
+        for (int i = 0; i < 4; i++) {
+            MakeTree(m_root + "/warm" + std::to_string(i), 1, 4, 64);
+        }
+        for (int i = 0; i < 4; i++) {
+            std::string warm = m_root + "/warm" + std::to_string(i);
+            ASSERT_EQ(util_trash_path(m_root.c_str(), warm.c_str()), 0);
+        }
+        ASSERT_TRUE(WaitTrashEmpty());
+    }
+    if (TrashWorkers() < 2) {
+        std::cout << "Cannot start more than one trash worker, skip" << std::endl;
+        return;
+    }
+
+    ASSERT_TRUE(mkdir(m_trash.c_str(), 0700) == 0 || errno == EEXIST);
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    ASSERT_GE(fd, 0);
+    ASSERT_GE(inotify_add_watch(fd, m_trash.c_str(), IN_MOVED_TO), 0);
+
+    MakeTree(path, 2, 8, 32);
+    ASSERT_EQ(util_trash_path(m_root.c_str(), path.c_str()), 0);
+    ASSERT_TRUE(WaitTrashEmpty());
+    ExpectOutsideKept();
+
+    // subdirectories were moved to the top of the trash for the idle workers
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (char *p = buf; p < buf + n;) {
+            struct inotify_event *event = (struct inotify_event *)p;
+            if (event->len > 0 && strncmp(event->name, "split-", strlen("split-")) == 0) {
+                split = true;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    close(fd);
+    ASSERT_TRUE(split);
+}
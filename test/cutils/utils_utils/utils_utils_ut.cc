@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: utils exec argv cmd unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "utils.h"
+
+#ifndef __NR_close_range
+#define __NR_close_range 436
+#endif
+
+namespace {
+// close_range fails with ENOSYS as on kernels before 5.9
+bool g_no_close_range = false;
+
+struct ExecResult {
+    bool ok;
+    std::string out;
+    std::string err;
+};
+
+ExecResult Exec(std::vector<std::string> args, const char *dir = nullptr, const char *stdin_msg = nullptr)
+{
+    std::vector<char *> argv;
+    char *stdout_msg = nullptr;
+    char *stderr_msg = nullptr;
+    ExecResult result;
+
+    for (auto &arg : args) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+    result.ok = util_exec_argv_cmd(dir, argv.data(), stdin_msg, &stdout_msg, &stderr_msg);
+    result.out = stdout_msg != nullptr ? stdout_msg : "";
+    result.err = stderr_msg != nullptr ? stderr_msg : "";
+    free(stdout_msg);
+    free(stderr_msg);
+    return result;
+}
+} // namespace
+
+extern "C" {
+    long __real_syscall(long number, ...);
+
+    long __wrap_syscall(long number, ...)
+    {
+        va_list ap;
+        long args[6];
+
+        va_start(ap, number);
+        for (int i = 0; i < 6; i++) {
+            args[i] = va_arg(ap, long);
+        }
+        va_end(ap);
+        if (number == __NR_close_range && g_no_close_range) {
+            errno = ENOSYS;
+            return -1;
+        }
+        return __real_syscall(number, args[0], args[1], args[2], args[3], args[4], args[5]);
+    }
+}
+
+class UtilExecArgvCmdUnitTest : public testing::Test {
+protected:
+    void TearDown() override
+    {
+        g_no_close_range = false;
+    }
+
+    void CheckExitStatus()
+    {
+        ExecResult result = Exec({ "true" });
+        ASSERT_TRUE(result.ok);
+        ASSERT_EQ(result.out, "");
+        ASSERT_EQ(result.err, "");
+
+        result = Exec({ "sh", "-c", "exit 3" });
+        ASSERT_FALSE(result.ok);
+        ASSERT_EQ(result.err, "Command exit with status: 3");
+
+        result = Exec({ "sh", "-c", "kill -9 $$" });
+        ASSERT_FALSE(result.ok);
+        ASSERT_EQ(result.err, "Command exit with signal: 9");
+
+        // the stderr of the command is reported instead
+        result = Exec({ "sh", "-c", "echo failed >&2; exit 1" });
+        ASSERT_FALSE(result.ok);
+        ASSERT_NE(result.err.find("failed"), std::string::npos);
+
+        result = Exec({ "no-such-cmd-for-ut" });
+        ASSERT_FALSE(result.ok);
+        ASSERT_NE(result.err.find("Failed to find cmd no-such-cmd-for-ut"), std::string::npos);
+    }
+
+    void CheckOutputAndInput()
+    {
+        ExecResult result = Exec({ "sh", "-c", "echo out; echo err >&2" });
+        ASSERT_TRUE(result.ok);
+        ASSERT_EQ(result.out, "out\n");
+        ASSERT_NE(result.err.find("err"), std::string::npos);
+
+        result = Exec({ "cat" }, nullptr, "hello");
+        ASSERT_TRUE(result.ok);
+        ASSERT_EQ(result.out, "hello");
+
+        // more than the pipes hold on both outputs at once
+        result = Exec({ "sh", "-c",
+                        "head -c 1048576 /dev/zero | tr '\\0' a; head -c 1048576 /dev/zero | tr '\\0' b >&2" });
+        ASSERT_TRUE(result.ok);
+        ASSERT_EQ(result.out, std::string(1048576, 'a'));
+        ASSERT_EQ(result.err.size(), 1048576U);
+
+        result = Exec({ "pwd" }, "/");
+        ASSERT_TRUE(result.ok);
+        ASSERT_EQ(result.out, "/\n");
+
+        result = Exec({ "pwd" }, "/no-such-dir-for-ut");
+        ASSERT_FALSE(result.ok);
+    }
+
+    void CheckFdsClosed()
+    {
+        int fd = open("/dev/null", O_RDONLY);
+        int high = -1;
+
+        ASSERT_GE(fd, 0);
+        // inherited without FD_CLOEXEC
+        high = dup2(fd, 200);
+        close(fd);
+        ASSERT_EQ(high, 200);
+
+        ExecResult result =
+            Exec({ "sh", "-c", "[ -e /proc/self/fd/0 ] && [ -e /proc/self/fd/2 ] && [ ! -e /proc/self/fd/200 ]" });
+        close(high);
+        ASSERT_TRUE(result.ok) << result.err;
+    }
+};
+
+TEST_F(UtilExecArgvCmdUnitTest, test_exit_status)
+{
+    CheckExitStatus();
+}
+
+TEST_F(UtilExecArgvCmdUnitTest, test_output_and_input)
+{
+    CheckOutputAndInput();
+}
+
+TEST_F(UtilExecArgvCmdUnitTest, test_fds_closed)
+{
+    CheckFdsClosed();
+}
+
+// kernels without close_range run the command by util_exec_cmd
+TEST_F(UtilExecArgvCmdUnitTest, test_fallback_without_close_range)
+{
+    g_no_close_range = true;
+    CheckExitStatus();
+    CheckOutputAndInput();
+    CheckFdsClosed();
+}
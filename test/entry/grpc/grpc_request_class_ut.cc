@@ -0,0 +1,190 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide grpc request class scheduler unit test
+ ******************************************************************************/
+
+#include "grpc_request_class.h"
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "isulad_config_mock.h"
+
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::_;
+
+namespace {
+const std::chrono::system_clock::time_point NO_DEADLINE = std::chrono::system_clock::time_point::max();
+
+bool NotCancelled()
+{
+    return false;
+}
+
+// wait until count calls of heavy wait for a slot
+bool WaitQueued(size_t count)
+{
+    std::string line = "isulad_grpc_class_queue_depth{class=\"heavy\"} " + std::to_string(count) + "\n";
+
+    for (int i = 0; i < 500; i++) {
+        if (RequestClassScheduler::GetInstance()->DumpStats().find(line) != std::string::npos) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+} // namespace
+
+class RequestClassUnitTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        m_scheduler = RequestClassScheduler::GetInstance();
+    }
+
+    void TearDown() override
+    {
+        // the defaults of the scheduler
+        m_scheduler->SetLimit(RequestClass::STREAMING, 256, 16);
+        m_scheduler->SetLimit(RequestClass::HEAVY, 4, 32);
+    }
+
+    void Release(RequestClass cls)
+    {
+        m_scheduler->Release(cls, std::chrono::steady_clock::now());
+    }
+
+    RequestClassScheduler *m_scheduler { nullptr };
+};
+
+TEST_F(RequestClassUnitTest, test_every_class_limited_by_default)
+{
+    // 8 spare threads and the slots of cri status, streaming, heavy and default calls
+    ASSERT_EQ(m_scheduler->RequiredThreads(), 8 + (64 + 64) + (256 + 16) + (4 + 32) + (64 + 64));
+
+    m_scheduler->SetLimit(RequestClass::STREAMING, 0, 0);
+    ASSERT_EQ(m_scheduler->RequiredThreads(), 0);
+}
+
+TEST_F(RequestClassUnitTest, test_admit_within_limit)
+{
+    m_scheduler->SetLimit(RequestClass::HEAVY, 2, 0);
+
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+    // no room to wait
+    auto status = m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+    // other classes do not compete for the slots of heavy calls
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::CRI_STATUS, nullptr).ok());
+    Release(RequestClass::CRI_STATUS);
+
+    Release(RequestClass::HEAVY);
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+    Release(RequestClass::HEAVY);
+    Release(RequestClass::HEAVY);
+}
+
+TEST_F(RequestClassUnitTest, test_queue_bounded)
+{
+    std::atomic<bool> admitted { false };
+
+    m_scheduler->SetLimit(RequestClass::HEAVY, 1, 1);
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+
+    std::thread waiter([&] {
+        admitted = m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok();
+    });
+    ASSERT_TRUE(WaitQueued(1));
+    ASSERT_FALSE(admitted);
+
+    // the queue is full, the next call is turned away at once
+    auto status = m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+
+    // the waiting call takes the released slot
+    Release(RequestClass::HEAVY);
+    waiter.join();
+    ASSERT_TRUE(admitted);
+    ASSERT_TRUE(WaitQueued(0));
+    Release(RequestClass::HEAVY);
+}
+
+TEST_F(RequestClassUnitTest, test_deadline_while_queued)
+{
+    m_scheduler->SetLimit(RequestClass::HEAVY, 1, 1);
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+
+    auto start = std::chrono::steady_clock::now();
+    auto status = m_scheduler->Admit(RequestClass::HEAVY,
+                                     std::chrono::system_clock::now() + std::chrono::milliseconds(50), NotCancelled);
+    auto waited = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+    ASSERT_GE(waited, std::chrono::milliseconds(50));
+    ASSERT_LT(waited, std::chrono::seconds(1));
+
+    // a call which is already late does not wait at all
+    status = m_scheduler->Admit(RequestClass::HEAVY, std::chrono::system_clock::now(), NotCancelled);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+    ASSERT_TRUE(WaitQueued(0));
+    Release(RequestClass::HEAVY);
+}
+
+TEST_F(RequestClassUnitTest, test_cancelled_while_queued)
+{
+    std::atomic<bool> cancelled { false };
+
+    m_scheduler->SetLimit(RequestClass::HEAVY, 1, 1);
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+
+    std::thread canceller([&] {
+        usleep(50 * 1000);
+        cancelled = true;
+    });
+    auto status = m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, [&] { return cancelled.load(); });
+    canceller.join();
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::CANCELLED);
+    ASSERT_NE(m_scheduler->DumpStats().find("isulad_grpc_class_rejected_total{class=\"heavy\"} "), std::string::npos);
+    Release(RequestClass::HEAVY);
+}
+
+TEST_F(RequestClassUnitTest, test_load_limits)
+{
+    NiceMock<MockIsuladConf> isuladConf;
+
+    MockIsuladConf_SetMock(&isuladConf);
+    ON_CALL(isuladConf, ConfGetGrpcRequestClassLimit(_, _, _))
+    .WillByDefault(Invoke([](const char *name, size_t *maxInflight, size_t *maxQueued) {
+        if (strcmp(name, "heavy") == 0) {
+            *maxInflight = 1;
+            *maxQueued = 0;
+            return 0;
+        }
+        // invalid, the default is kept
+        return strcmp(name, "streaming") == 0 ? -1 : 1;
+    }));
+    m_scheduler->LoadLimits();
+    MockIsuladConf_SetMock(nullptr);
+
+    ASSERT_EQ(m_scheduler->RequiredThreads(), 8 + (64 + 64) + (256 + 16) + 1 + (64 + 64));
+    ASSERT_TRUE(m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled).ok());
+    auto status = m_scheduler->Admit(RequestClass::HEAVY, NO_DEADLINE, NotCancelled);
+    ASSERT_EQ(status.error_code(), grpc::StatusCode::RESOURCE_EXHAUSTED);
+    Release(RequestClass::HEAVY);
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide authz decision cache unit test
+ ******************************************************************************/
+
+#include "grpc_server_tls_auth.h"
+#include <chrono>
+#include <string>
+#include <thread>
+#include <gtest/gtest.h>
+#include "http.h"
+
+using GrpcServerTlsAuth::AuthzCache;
+
+namespace {
+// a cached decision of user and action, "miss" if there is none
+std::string Decision(AuthzCache &cache, const std::string &user, const std::string &action)
+{
+    bool allowed { false };
+    std::string errmsg;
+
+    if (!cache.Lookup(user, action, allowed, errmsg)) {
+        return "miss";
+    }
+    return allowed ? "allowed" : "denied: " + errmsg;
+}
+} // namespace
+
+TEST(grpc_server_tls_auth_ut, test_decisions_cached)
+{
+    AuthzCache cache(16, std::chrono::seconds(10), std::chrono::seconds(2));
+    uint64_t generation = authz_http_generation();
+
+    ASSERT_EQ(Decision(cache, "u1", "container_create"), "miss");
+    cache.Insert("u1", "container_create", true, "", generation);
+    // denied decisions are cached too, with the message of the plugin
+    cache.Insert("u2", "container_create", false, "permission denied", generation);
+
+    ASSERT_EQ(Decision(cache, "u1", "container_create"), "allowed");
+    ASSERT_EQ(Decision(cache, "u2", "container_create"), "denied: permission denied");
+    ASSERT_EQ(Decision(cache, "u1", "container_remove"), "miss");
+
+    // a new decision replaces the old one
+    cache.Insert("u2", "container_create", true, "", generation);
+    ASSERT_EQ(Decision(cache, "u2", "container_create"), "allowed");
+}
+
+TEST(grpc_server_tls_auth_ut, test_ttl_expiry)
+{
+    AuthzCache cache(16, std::chrono::milliseconds(300), std::chrono::milliseconds(50));
+    uint64_t generation = authz_http_generation();
+
+    cache.Insert("u1", "allowed_action", true, "", generation);
+    cache.Insert("u1", "denied_action", false, "denied", generation);
+
+    // denied decisions expire first
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_EQ(Decision(cache, "u1", "denied_action"), "miss");
+    ASSERT_EQ(Decision(cache, "u1", "allowed_action"), "allowed");
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    ASSERT_EQ(Decision(cache, "u1", "allowed_action"), "miss");
+}
+
+TEST(grpc_server_tls_auth_ut, test_lru_eviction)
+{
+    AuthzCache cache(3, std::chrono::seconds(10), std::chrono::seconds(2));
+    uint64_t generation = authz_http_generation();
+
+    cache.Insert("u", "a", true, "", generation);
+    cache.Insert("u", "b", true, "", generation);
+    cache.Insert("u", "c", true, "", generation);
+    // a is used again, b is the least recently used one
+    ASSERT_EQ(Decision(cache, "u", "a"), "allowed");
+
+    cache.Insert("u", "d", true, "", generation);
+    ASSERT_EQ(Decision(cache, "u", "b"), "miss");
+    ASSERT_EQ(Decision(cache, "u", "a"), "allowed");
+    ASSERT_EQ(Decision(cache, "u", "c"), "allowed");
+    ASSERT_EQ(Decision(cache, "u", "d"), "allowed");
+
+    // expired decisions are dropped before used ones
+    AuthzCache expiring(2, std::chrono::seconds(10), std::chrono::milliseconds(10));
+    expiring.Insert("u", "denied", false, "denied", generation);
+    expiring.Insert("u", "allowed", true, "", generation);
+    ASSERT_EQ(Decision(expiring, "u", "denied"), "denied: denied");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    expiring.Insert("u", "new", true, "", generation);
+    ASSERT_EQ(Decision(expiring, "u", "allowed"), "allowed");
+    ASSERT_EQ(Decision(expiring, "u", "new"), "allowed");
+}
+
+TEST(grpc_server_tls_auth_ut, test_invalidate)
+{
+    AuthzCache cache(16, std::chrono::seconds(10), std::chrono::seconds(2));
+    uint64_t generation = authz_http_generation();
+
+    cache.Insert("u1", "a", true, "", generation);
+    cache.Insert("u1", "b", false, "denied", generation);
+    cache.Insert("u2", "a", true, "", generation);
+
+    cache.Invalidate("u1");
+    ASSERT_EQ(Decision(cache, "u1", "a"), "miss");
+    ASSERT_EQ(Decision(cache, "u1", "b"), "miss");
+    ASSERT_EQ(Decision(cache, "u2", "a"), "allowed");
+
+    cache.Invalidate();
+    ASSERT_EQ(Decision(cache, "u2", "a"), "miss");
+}
+
+TEST(grpc_server_tls_auth_ut, test_plugin_restart)
+{
+    AuthzCache cache(16, std::chrono::seconds(10), std::chrono::seconds(2));
+    uint64_t before = authz_http_generation();
+
+    cache.Insert("u1", "a", true, "", before);
+    cache.Insert("u1", "b", false, "denied", before);
+    ASSERT_EQ(Decision(cache, "u1", "a"), "allowed");
+
+    // the plugin manager invalidates on a restart of the authz plugin
+    authz_http_invalidate();
+    uint64_t after = authz_http_generation();
+    ASSERT_NE(after, before);
+    ASSERT_EQ(Decision(cache, "u1", "a"), "miss");
+    ASSERT_EQ(Decision(cache, "u1", "b"), "miss");
+
+    // an answer asked before the restart is not used after it
+    cache.Insert("u1", "a", true, "", before);
+    ASSERT_EQ(Decision(cache, "u1", "a"), "miss");
+    cache.Insert("u1", "a", false, "new policy", after);
+    ASSERT_EQ(Decision(cache, "u1", "a"), "denied: new policy");
+}
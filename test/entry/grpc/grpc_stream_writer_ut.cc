@@ -0,0 +1,231 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide grpc stream coalescer unit test
+ ******************************************************************************/
+
+#include "grpc_stream_writer.h"
+#include <unistd.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <gtest/gtest.h>
+#include "container.pb.h"
+
+using containers::RemoteExecRequest;
+using containers::RemoteExecResponse;
+
+namespace {
+struct SentMessage {
+    bool isStdout;
+    std::string data;
+    bool finish;
+    bool bufferHint;
+};
+
+// records what the coalescer sends instead of writing to a client
+class FakeStream {
+public:
+    bool Write(const RemoteExecResponse &response, grpc::WriteOptions options)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_fail) {
+            return false;
+        }
+        SentMessage message;
+        message.isStdout = !response.stdout().empty() || response.stderr().empty();
+        message.data = message.isStdout ? response.stdout() : response.stderr();
+        message.finish = response.finish();
+        message.bufferHint = options.get_buffer_hint();
+        m_messages.push_back(message);
+        return true;
+    }
+
+    bool Write(const RemoteExecResponse &response)
+    {
+        return Write(response, grpc::WriteOptions());
+    }
+
+    std::vector<SentMessage> Messages()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messages;
+    }
+
+    void SetFail()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_fail = true;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::vector<SentMessage> m_messages;
+    bool m_fail { false };
+};
+
+using Coalescer = GrpcStreamCoalescer<RemoteExecResponse, RemoteExecRequest, FakeStream>;
+
+// output of consecutive messages of a channel joined, empty pushes and the finish left out
+std::vector<std::pair<bool, std::string>> Output(const std::vector<SentMessage> &messages)
+{
+    std::vector<std::pair<bool, std::string>> output;
+
+    for (const auto &message : messages) {
+        if (message.finish || message.data.empty()) {
+            continue;
+        }
+        if (!output.empty() && output.back().first == message.isStdout) {
+            output.back().second += message.data;
+            continue;
+        }
+        output.emplace_back(message.isStdout, message.data);
+    }
+    return output;
+}
+
+ssize_t WriteString(Coalescer &coalescer, bool isStdout, const std::string &data)
+{
+    return coalescer.Write(isStdout, data.c_str(), data.size());
+}
+} // namespace
+
+TEST(grpc_stream_writer_ut, test_small_writes_coalesced)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+    std::string expected;
+
+    for (int i = 0; i < 100; i++) {
+        std::string piece = std::to_string(i) + ",";
+        expected += piece;
+        ASSERT_EQ(WriteString(coalescer, true, piece), (ssize_t)piece.size());
+    }
+    ASSERT_TRUE(coalescer.Finish());
+
+    auto messages = stream.Messages();
+    ASSERT_GE(messages.size(), 2U);
+    // far fewer messages than writes, the last one is the finish
+    ASSERT_LE(messages.size(), 10U);
+    ASSERT_TRUE(messages.back().finish);
+    auto output = Output(messages);
+    ASSERT_EQ(output.size(), 1U);
+    ASSERT_TRUE(output[0].first);
+    ASSERT_EQ(output[0].second, expected);
+}
+
+TEST(grpc_stream_writer_ut, test_channels_keep_order)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+
+    ASSERT_GT(WriteString(coalescer, true, "o1"), 0);
+    ASSERT_GT(WriteString(coalescer, true, "o2"), 0);
+    ASSERT_GT(WriteString(coalescer, false, "e1"), 0);
+    ASSERT_GT(WriteString(coalescer, true, "o3"), 0);
+    ASSERT_GT(WriteString(coalescer, false, "e2"), 0);
+    ASSERT_GT(WriteString(coalescer, false, "e3"), 0);
+    ASSERT_TRUE(coalescer.Finish());
+
+    auto output = Output(stream.Messages());
+    std::vector<std::pair<bool, std::string>> expected = {
+        { true, "o1o2" }, { false, "e1" }, { true, "o3" }, { false, "e2e3" }
+    };
+    ASSERT_EQ(output, expected);
+}
+
+TEST(grpc_stream_writer_ut, test_full_message_sent_by_write)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+    std::string big(Coalescer::MaxPendingBytes, 'x');
+
+    ASSERT_EQ(WriteString(coalescer, true, big), (ssize_t)big.size());
+    // sent right away with a buffer hint, without waiting for the deadline
+    auto messages = stream.Messages();
+    ASSERT_EQ(messages.size(), 1U);
+    ASSERT_EQ(messages[0].data, big);
+    ASSERT_TRUE(messages[0].bufferHint);
+
+    // nothing followed, so the timer pushes it with an empty message
+    usleep(50 * 1000);
+    messages = stream.Messages();
+    ASSERT_EQ(messages.size(), 2U);
+    ASSERT_TRUE(messages[1].data.empty());
+    ASSERT_FALSE(messages[1].bufferHint);
+    ASSERT_TRUE(coalescer.Finish());
+}
+
+TEST(grpc_stream_writer_ut, test_pending_sent_at_deadline)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+
+    ASSERT_GT(WriteString(coalescer, false, "prompt$ "), 0);
+    usleep(50 * 1000);
+    auto messages = stream.Messages();
+    ASSERT_EQ(messages.size(), 1U);
+    ASSERT_FALSE(messages[0].isStdout);
+    ASSERT_EQ(messages[0].data, "prompt$ ");
+    ASSERT_FALSE(messages[0].bufferHint);
+    ASSERT_TRUE(coalescer.Finish());
+}
+
+TEST(grpc_stream_writer_ut, test_finish_flushes_pending)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+
+    ASSERT_GT(WriteString(coalescer, true, "tail"), 0);
+    ASSERT_TRUE(coalescer.Finish());
+
+    auto messages = stream.Messages();
+    ASSERT_EQ(messages.size(), 2U);
+    ASSERT_EQ(messages[0].data, "tail");
+    ASSERT_TRUE(messages[1].finish);
+    // no output after the finish message
+    ASSERT_EQ(WriteString(coalescer, true, "late"), -1);
+    usleep(10 * 1000);
+    ASSERT_EQ(stream.Messages().size(), 2U);
+}
+
+TEST(grpc_stream_writer_ut, test_failed_stream)
+{
+    FakeStream stream;
+    Coalescer coalescer(&stream);
+
+    stream.SetFail();
+    ASSERT_GT(WriteString(coalescer, true, "o1"), 0);
+    ASSERT_EQ(WriteString(coalescer, false, "e1"), -1);
+    ASSERT_FALSE(coalescer.Finish());
+}
+
+TEST(grpc_stream_writer_ut, test_many_streams_share_timer)
+{
+    std::vector<FakeStream> streams(64);
+    std::vector<std::unique_ptr<Coalescer>> coalescers;
+
+    for (auto &stream : streams) {
+        coalescers.emplace_back(new Coalescer(&stream));
+        ASSERT_GT(WriteString(*coalescers.back(), true, "out"), 0);
+    }
+    usleep(50 * 1000);
+    for (auto &stream : streams) {
+        auto output = Output(stream.Messages());
+        ASSERT_EQ(output.size(), 1U);
+        ASSERT_EQ(output[0].second, "out");
+    }
+    // destroyed without Finish, the timer must not call them afterwards
+    coalescers.clear();
+}
@@ -0,0 +1,137 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide monitord events queue unit test
+ ******************************************************************************/
+
+#include "monitord_queue.h"
+#include <poll.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#define MONITORD_QUEUE_UT_PRODUCERS 8
+#define MONITORD_QUEUE_UT_MESSAGES 20000
+
+namespace {
+// messages handled by the current drain, producer in pid and sequence in value
+std::vector<struct monitord_msg> g_handled;
+
+void Record(struct monitord_msg *msg)
+{
+    g_handled.push_back(*msg);
+}
+
+struct monitord_msg Message(int producer, int seq)
+{
+    struct monitord_msg msg;
+
+    (void)memset(&msg, 0, sizeof(msg));
+    msg.type = MONITORD_MSG_STATE;
+    msg.pid = producer;
+    msg.value = seq;
+    return msg;
+}
+
+// wait for the doorbell like monitored does
+bool WaitDoorbell(int efd, int timeout)
+{
+    struct pollfd pfd = { efd, POLLIN, 0 };
+
+    return poll(&pfd, 1, timeout) == 1 && (pfd.revents & POLLIN) != 0;
+}
+} // namespace
+
+class MonitordQueueUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        m_efd = monitord_queue_open();
+        ASSERT_GE(m_efd, 0);
+        g_handled.clear();
+    }
+
+    int m_efd { -1 };
+};
+
+TEST_F(MonitordQueueUnitTest, test_push_drain_in_order)
+{
+    ASSERT_EQ(monitord_queue_drain(Record), 0U);
+    ASSERT_FALSE(WaitDoorbell(m_efd, 0));
+
+    for (int i = 0; i < 100; i++) {
+        struct monitord_msg msg = Message(0, i);
+        ASSERT_TRUE(monitord_queue_push(&msg));
+    }
+    ASSERT_TRUE(WaitDoorbell(m_efd, 0));
+    ASSERT_EQ(monitord_queue_drain(Record), 100U);
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(g_handled[i].value, i);
+    }
+    // the doorbell was consumed by the drain
+    ASSERT_FALSE(WaitDoorbell(m_efd, 0));
+    ASSERT_EQ(monitord_queue_push(nullptr), false);
+}
+
+TEST_F(MonitordQueueUnitTest, test_multi_producer)
+{
+    std::vector<std::thread> producers;
+    std::vector<int> next(MONITORD_QUEUE_UT_PRODUCERS, 0);
+    size_t total = (size_t)MONITORD_QUEUE_UT_PRODUCERS * MONITORD_QUEUE_UT_MESSAGES;
+    size_t handled = 0;
+
+    for (int p = 0; p < MONITORD_QUEUE_UT_PRODUCERS; p++) {
+        producers.emplace_back([p] {
+            for (int i = 0; i < MONITORD_QUEUE_UT_MESSAGES; i++) {
+                struct monitord_msg msg = Message(p, i);
+                if (!monitord_queue_push(&msg)) {
+                    return;
+                }
+            }
+        });
+    }
+
+    // drain only when the doorbell rings, a lost wake up leaves messages queued with no
+    // doorbell and the wait times out
+    while (handled < total) {
+        ASSERT_TRUE(WaitDoorbell(m_efd, 5000)) << "no wake up with " << total - handled << " messages left";
+        g_handled.clear();
+        handled += monitord_queue_drain(Record);
+        // messages of every producer come in the order it pushed them, none lost or doubled
+        for (const auto &msg : g_handled) {
+            ASSERT_GE(msg.pid, 0);
+            ASSERT_LT(msg.pid, MONITORD_QUEUE_UT_PRODUCERS);
+            ASSERT_EQ(msg.value, next[msg.pid]) << "producer " << msg.pid;
+            next[msg.pid]++;
+        }
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+
+    ASSERT_EQ(handled, total);
+    for (int p = 0; p < MONITORD_QUEUE_UT_PRODUCERS; p++) {
+        ASSERT_EQ(next[p], MONITORD_QUEUE_UT_MESSAGES);
+    }
+    ASSERT_EQ(monitord_queue_drain(Record), 0U);
+}
+
+// runs last, the queue is not opened again once closed
+TEST_F(MonitordQueueUnitTest, test_closed_rejects)
+{
+    struct monitord_msg msg = Message(0, 0);
+
+    monitord_queue_close();
+    ASSERT_FALSE(monitord_queue_push(&msg));
+    ASSERT_EQ(monitord_queue_drain(Record), 0U);
+}
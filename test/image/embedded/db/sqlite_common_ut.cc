@@ -0,0 +1,208 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide embedded image database unit test
+ ******************************************************************************/
+
+#include "sqlite_common.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "db_common.h"
+#include "utils_file.h"
+
+namespace {
+const char *INSERT_SQL = "INSERT INTO images (name) VALUES (?1);";
+const char *ECHO_SQL = "SELECT ?1;";
+
+// first column of the first row of sql, empty if there is none
+std::string QueryText(sqlite3 *db, const char *sql)
+{
+    sqlite3_stmt *stmt = nullptr;
+    std::string result;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        return "error";
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0) != nullptr) {
+        result = (const char *)sqlite3_column_text(stmt, 0);
+    }
+    (void)sqlite3_finalize(stmt);
+    return result;
+}
+
+int Insert(const char *name)
+{
+    sqlite3_stmt *stmt = db_sqlite_stmt_get(INSERT_SQL);
+    int ret;
+
+    if (stmt == nullptr) {
+        return SQLITE_ERROR;
+    }
+    (void)sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    ret = sqlite3_step(stmt);
+    db_sqlite_stmt_put(stmt);
+    return ret;
+}
+} // namespace
+
+class SqliteCommonUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/sqlite_common_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_root = tmpl;
+        m_dbpath = m_root + "/" + DBNAME;
+    }
+
+    void TearDown() override
+    {
+        db_common_finish();
+        (void)util_recursive_rmdir(m_root.c_str(), 0);
+    }
+
+    void Init(const char *synchronous)
+    {
+        ASSERT_EQ(db_common_init(m_root.c_str(), synchronous), 0);
+        ASSERT_EQ(db_sqlite_request("CREATE TABLE IF NOT EXISTS images (name TEXT NOT NULL);"), SQLITE_OK);
+    }
+
+    std::string Count()
+    {
+        return QueryText(get_global_db(), "SELECT count(*) FROM images;");
+    }
+
+    std::string m_root;
+    std::string m_dbpath;
+};
+
+TEST_F(SqliteCommonUnitTest, test_wal_and_synchronous)
+{
+    Init(nullptr);
+    ASSERT_EQ(QueryText(get_global_db(), "PRAGMA journal_mode;"), "wal");
+    // NORMAL by default
+    ASSERT_EQ(QueryText(get_global_db(), "PRAGMA synchronous;"), "1");
+    ASSERT_EQ(Insert("busybox"), SQLITE_DONE);
+    // written to the log, not the database
+    ASSERT_EQ(access((m_dbpath + "-wal").c_str(), F_OK), 0);
+    db_common_finish();
+
+    Init("full");
+    ASSERT_EQ(QueryText(get_global_db(), "PRAGMA synchronous;"), "2");
+    db_common_finish();
+
+    Init("bogus");
+    ASSERT_EQ(QueryText(get_global_db(), "PRAGMA synchronous;"), "1");
+}
+
+TEST_F(SqliteCommonUnitTest, test_broken_database_recreated)
+{
+    int fd = open(m_dbpath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    std::string junk(8192, 'x');
+
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(write(fd, junk.c_str(), junk.size()), (ssize_t)junk.size());
+    close(fd);
+
+    Init(nullptr);
+    ASSERT_EQ(Count(), "0");
+    ASSERT_EQ(QueryText(get_global_db(), "PRAGMA integrity_check;"), "ok");
+}
+
+TEST_F(SqliteCommonUnitTest, test_stmt_cache)
+{
+    sqlite3_stmt *stmt = nullptr;
+    std::string copy = ECHO_SQL;
+
+    Init(nullptr);
+    ASSERT_EQ(db_sqlite_stmt_get(nullptr), nullptr);
+    ASSERT_EQ(db_sqlite_stmt_get("SELECT FROM nothing;"), nullptr);
+
+    stmt = db_sqlite_stmt_get(ECHO_SQL);
+    ASSERT_NE(stmt, nullptr);
+    ASSERT_EQ(sqlite3_bind_int(stmt, 1, 42), SQLITE_OK);
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    ASSERT_EQ(sqlite3_column_int(stmt, 0), 42);
+    db_sqlite_stmt_put(stmt);
+
+    // prepared once, found by pointer or by text, reset and without bindings when given back
+    ASSERT_EQ(db_sqlite_stmt_get(ECHO_SQL), stmt);
+    ASSERT_FALSE(sqlite3_stmt_busy(stmt));
+    ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+    ASSERT_EQ(sqlite3_column_type(stmt, 0), SQLITE_NULL);
+    db_sqlite_stmt_put(stmt);
+    ASSERT_EQ(db_sqlite_stmt_get(copy.c_str()), stmt);
+    db_sqlite_stmt_put(stmt);
+}
+
+TEST_F(SqliteCommonUnitTest, test_stmt_cache_full)
+{
+    std::vector<std::string> sqls;
+
+    Init(nullptr);
+    // more statements than the cache keeps, those not kept are finalized on put
+    for (int i = 0; i < 64; i++) {
+        sqls.push_back("SELECT " + std::to_string(i) + ";");
+    }
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < 64; i++) {
+            sqlite3_stmt *stmt = db_sqlite_stmt_get(sqls[i].c_str());
+            ASSERT_NE(stmt, nullptr);
+            ASSERT_EQ(sqlite3_step(stmt), SQLITE_ROW);
+            ASSERT_EQ(sqlite3_column_int(stmt, 0), i);
+            db_sqlite_stmt_put(stmt);
+        }
+    }
+    ASSERT_EQ(Insert("busybox"), SQLITE_DONE);
+    ASSERT_EQ(Count(), "1");
+}
+
+TEST_F(SqliteCommonUnitTest, test_transactions)
+{
+    sqlite3 *reader = nullptr;
+
+    Init(nullptr);
+    ASSERT_EQ(sqlite3_open(m_dbpath.c_str(), &reader), SQLITE_OK);
+
+    ASSERT_EQ(db_sqlite_begin(), SQLITE_OK);
+    ASSERT_EQ(Insert("a"), SQLITE_DONE);
+    ASSERT_EQ(Insert("b"), SQLITE_DONE);
+    // a reader is not blocked by the writer and sees nothing before commit
+    ASSERT_EQ(QueryText(reader, "SELECT count(*) FROM images;"), "0");
+    ASSERT_EQ(db_sqlite_commit(), SQLITE_OK);
+    ASSERT_EQ(QueryText(reader, "SELECT count(*) FROM images;"), "2");
+
+    ASSERT_EQ(db_sqlite_begin(), SQLITE_OK);
+    ASSERT_EQ(Insert("c"), SQLITE_DONE);
+    // a failed statement keeps the transaction open
+    ASSERT_EQ(Insert(nullptr), SQLITE_CONSTRAINT);
+    ASSERT_FALSE(sqlite3_get_autocommit(get_global_db()));
+    db_sqlite_rollback();
+    ASSERT_TRUE(sqlite3_get_autocommit(get_global_db()));
+    ASSERT_EQ(Count(), "2");
+
+    // nothing to roll back
+    db_sqlite_rollback();
+    ASSERT_EQ(Count(), "2");
+    ASSERT_NE(db_sqlite_commit(), SQLITE_OK);
+
+    (void)sqlite3_close(reader);
+    db_common_finish();
+    Init(nullptr);
+    ASSERT_EQ(Count(), "2");
+}
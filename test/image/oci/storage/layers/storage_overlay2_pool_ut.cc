@@ -0,0 +1,231 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide overlay2 writable layer pool unit test
+ ******************************************************************************/
+
+#include "driver_overlay2_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <gtest/gtest.h>
+#include "driver.h"
+#include "utils_array.h"
+#include "utils_file.h"
+
+namespace {
+// layers are plain directories in home, creating layers of parents in the failing set fails
+struct FakeLayers {
+    std::mutex mutex;
+    std::string home;
+    std::set<std::string> failing;
+    std::map<std::string, int> creates;
+};
+
+FakeLayers g_layers;
+
+int FakeCreate(const char *id, const char *parent, const struct graphdriver *driver)
+{
+    std::lock_guard<std::mutex> lock(g_layers.mutex);
+
+    (void)driver;
+    g_layers.creates[parent]++;
+    if (g_layers.failing.count(parent) != 0) {
+        return -1;
+    }
+    return mkdir((g_layers.home + "/" + id).c_str(), 0700);
+}
+
+int FakeRename(const char *id, const char *new_id, const struct graphdriver *driver)
+{
+    (void)driver;
+    return rename((g_layers.home + "/" + id).c_str(), (g_layers.home + "/" + new_id).c_str());
+}
+
+int FakeRemove(const char *id, const struct graphdriver *driver)
+{
+    (void)driver;
+    return rmdir((g_layers.home + "/" + id).c_str());
+}
+
+const struct overlay2_pool_ops FAKE_OPS = {
+    .create = FakeCreate,
+    .rename = FakeRename,
+    .remove = FakeRemove,
+};
+
+int Creates(const std::string &parent)
+{
+    std::lock_guard<std::mutex> lock(g_layers.mutex);
+    return g_layers.creates[parent];
+}
+
+void SetFailing(const std::string &parent, bool failing)
+{
+    std::lock_guard<std::mutex> lock(g_layers.mutex);
+
+    if (failing) {
+        g_layers.failing.insert(parent);
+    } else {
+        g_layers.failing.erase(parent);
+    }
+}
+
+bool WaitCreates(const std::string &parent, int count)
+{
+    for (int i = 0; i < 2000; i++) {
+        if (Creates(parent) >= count) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+// a layer is ready a moment after it is created
+bool WaitClaim(const char *id, const char *parent)
+{
+    for (int i = 0; i < 2000; i++) {
+        if (overlay2_pool_claim(id, parent) == 0) {
+            return true;
+        }
+        usleep(1000);
+    }
+    return false;
+}
+
+// number of layers in home
+size_t Layers()
+{
+    char **entries = nullptr;
+    size_t len = 0;
+
+    if (util_list_all_subdir(g_layers.home.c_str(), &entries) != 0) {
+        return (size_t)-1;
+    }
+    len = util_array_len((const char **)entries);
+    util_free_array(entries);
+    return len;
+}
+} // namespace
+
+class Overlay2PoolUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/overlay2_pool_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        g_layers.home = tmpl;
+        g_layers.failing.clear();
+        g_layers.creates.clear();
+        m_driver.home = g_layers.home.c_str();
+    }
+
+    void TearDown() override
+    {
+        overlay2_pool_exit();
+        (void)util_recursive_rmdir(g_layers.home.c_str(), 0);
+    }
+
+    struct graphdriver m_driver {};
+};
+
+TEST_F(Overlay2PoolUnitTest, test_claim_and_refill)
+{
+    ASSERT_EQ(overlay2_pool_init(&m_driver, 2, &FAKE_OPS), 0);
+    // nothing ready yet
+    ASSERT_NE(overlay2_pool_claim("c0", "p1"), 0);
+
+    overlay2_pool_refill("p1");
+    ASSERT_TRUE(WaitClaim("c1", "p1"));
+    ASSERT_EQ(access((g_layers.home + "/c1").c_str(), F_OK), 0);
+    ASSERT_TRUE(WaitClaim("c2", "p1"));
+
+    // topped up after claims
+    overlay2_pool_refill("p1");
+    ASSERT_TRUE(WaitClaim("c3", "p1"));
+    ASSERT_TRUE(WaitClaim("c4", "p1"));
+    ASSERT_GE(Creates("p1"), 4);
+    ASSERT_NE(overlay2_pool_claim("c5", "p2"), 0);
+}
+
+TEST_F(Overlay2PoolUnitTest, test_failed_parent_backs_off)
+{
+    ASSERT_EQ(overlay2_pool_init(&m_driver, 2, &FAKE_OPS), 0);
+    SetFailing("bad", true);
+
+    overlay2_pool_refill("bad");
+    ASSERT_TRUE(WaitCreates("bad", 1));
+    // a create of the image refills its pool, the failed parent is not tried again at once
+    for (int i = 0; i < 10; i++) {
+        overlay2_pool_refill("bad");
+        usleep(10 * 1000);
+    }
+    ASSERT_EQ(Creates("bad"), 1);
+
+    // others are still filled
+    overlay2_pool_refill("good");
+    ASSERT_TRUE(WaitClaim("c1", "good"));
+
+    // tried again by the first refill after the backoff
+    SetFailing("bad", false);
+    usleep(1100 * 1000);
+    ASSERT_EQ(Creates("bad"), 1);
+    overlay2_pool_refill("bad");
+    ASSERT_TRUE(WaitClaim("c2", "bad"));
+}
+
+TEST_F(Overlay2PoolUnitTest, test_backoff_keeps_ready_layers)
+{
+    ASSERT_EQ(overlay2_pool_init(&m_driver, 2, &FAKE_OPS), 0);
+
+    overlay2_pool_refill("p1");
+    ASSERT_TRUE(WaitCreates("p1", 2));
+    SetFailing("p1", true);
+    ASSERT_TRUE(WaitClaim("c1", "p1"));
+    overlay2_pool_refill("p1");
+    ASSERT_TRUE(WaitCreates("p1", 3));
+    usleep(50 * 1000);
+
+    // the layer made before the failure is still claimed
+    ASSERT_TRUE(WaitClaim("c2", "p1"));
+    ASSERT_NE(overlay2_pool_claim("c3", "p1"), 0);
+    ASSERT_EQ(Creates("p1"), 3);
+}
+
+TEST_F(Overlay2PoolUnitTest, test_drain_and_stale_layers)
+{
+    // left by last run
+    ASSERT_EQ(mkdir((g_layers.home + "/" + OVERLAY2_POOL_ID_PREFIX "stale").c_str(), 0700), 0);
+    ASSERT_EQ(mkdir((g_layers.home + "/layer").c_str(), 0700), 0);
+    ASSERT_EQ(overlay2_pool_init(&m_driver, 2, &FAKE_OPS), 0);
+    ASSERT_EQ(Layers(), 1U);
+
+    overlay2_pool_refill("p1");
+    ASSERT_TRUE(WaitCreates("p1", 2));
+    // wait until both are ready
+    usleep(50 * 1000);
+    for (int i = 0; i < 1000 && Layers() != 3U; i++) {
+        usleep(1000);
+    }
+    ASSERT_EQ(Layers(), 3U);
+    overlay2_pool_drain("p1");
+    ASSERT_EQ(Layers(), 1U);
+    ASSERT_NE(overlay2_pool_claim("c1", "p1"), 0);
+}
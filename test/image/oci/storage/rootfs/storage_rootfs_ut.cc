@@ -191,6 +191,35 @@ TEST_F(StorageRootfsUnitTest, test_rootfs_store_exists)
     ASSERT_FALSE(rootfs_store_exists(incorrectId.c_str()));
 }
 
+TEST_F(StorageRootfsUnitTest, test_rootfs_store_index)
+{
+    std::string index = std::string(store_real_path) + "/overlay-containers/.index";
+    struct storage_module_init_options opts;
+    storage_rootfs *cntr = nullptr;
+
+    rootfs_store_exit();
+    ASSERT_EQ(access(index.c_str(), F_OK), 0);
+    rootfs_store_free();
+
+    opts.storage_root = strdup(store_real_path);
+    opts.driver_name = strdup("overlay");
+    ASSERT_EQ(rootfs_store_init(&opts), 0);
+    free(opts.storage_root);
+    free(opts.driver_name);
+
+    for (auto elem : ids) {
+        ASSERT_TRUE(rootfs_store_exists(elem.c_str()));
+    }
+    cntr = rootfs_store_get_rootfs(ids.at(0).c_str());
+    ASSERT_NE(cntr, nullptr);
+    ASSERT_STREQ(cntr->image, "e4db68de4ff27c2adfea0c54bbb73a61a42f5b667c326de4d7d5b19ab71c6a3b");
+    ASSERT_STREQ(cntr->layer, "253836aa199405a39b6262b1e55a0d946b80988bc2f82d8f2b802fc175e4874e");
+    ASSERT_EQ(cntr->names_len, 1);
+    free_storage_rootfs(cntr);
+
+    ASSERT_EQ(unlink(index.c_str()), 0);
+}
+
 TEST_F(StorageRootfsUnitTest, test_rootfs_store_get_all_rootfs)
 {
     std::string source = std::string(store_real_path) + "/overlay-containers/" + ids.at(0);
@@ -0,0 +1,221 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide metrics server unit test
+ ******************************************************************************/
+
+#include "metrics.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <atomic>
+#include <string>
+#include <gtest/gtest.h>
+#include "utils.h"
+#include "utils_file.h"
+
+namespace {
+// accept fails as if the daemon ran out of fds
+std::atomic<bool> g_accept_emfile(false);
+std::atomic<int> g_accept_fails(0);
+
+char *Collector(void)
+{
+    return util_strdup_s("# TYPE ut_collected gauge\nut_collected 7\n");
+}
+
+int Connect(const std::string &path)
+{
+    struct sockaddr_un addr = { 0 };
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+    if (fd < 0) {
+        return -1;
+    }
+    addr.sun_family = AF_UNIX;
+    (void)strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// the whole response, the server closes the connection after it
+std::string ReadAll(int fd)
+{
+    std::string response;
+    char buf[4096];
+    ssize_t n;
+
+    while ((n = util_read_nointr(fd, buf, sizeof(buf))) > 0) {
+        response.append(buf, (size_t)n);
+    }
+    return response;
+}
+
+std::string Request(int fd, const std::string &request)
+{
+    if (util_write_nointr_in_total(fd, request.c_str(), request.size()) < 0) {
+        return "";
+    }
+    return ReadAll(fd);
+}
+} // namespace
+
+extern "C" {
+    int __real_accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags);
+
+    int __wrap_accept4(int sockfd, struct sockaddr *addr, socklen_t *addrlen, int flags)
+    {
+        if (g_accept_emfile) {
+            g_accept_fails++;
+            errno = EMFILE;
+            return -1;
+        }
+        return __real_accept4(sockfd, addr, addrlen, flags);
+    }
+}
+
+class MetricsUnitTest : public testing::Test {
+protected:
+    static void SetUpTestCase()
+    {
+        char tmpl[] = "/tmp/metrics_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_root = tmpl;
+        m_socket = m_root + "/" + METRICS_SOCKET_NAME;
+        ASSERT_EQ(metrics_register_collector(Collector), 0);
+        // the server is started once per process
+        ASSERT_EQ(metrics_server_start(m_socket.c_str()), 0);
+        ASSERT_TRUE(metrics_enabled());
+    }
+
+    static void TearDownTestCase()
+    {
+        (void)util_recursive_rmdir(m_root.c_str(), 0);
+    }
+
+    static std::string m_root;
+    static std::string m_socket;
+};
+
+std::string MetricsUnitTest::m_root;
+std::string MetricsUnitTest::m_socket;
+
+TEST_F(MetricsUnitTest, test_scrape)
+{
+    metrics_counter_t *counter = metrics_counter("ut_requests_total", "method=\"get\"");
+    metrics_histogram_t *histogram = metrics_histogram("ut_duration_seconds", nullptr);
+    metrics_gauge_t *gauge = metrics_gauge("ut_running", nullptr);
+    struct stat st;
+    std::string response;
+    std::string body;
+    size_t pos;
+    int fd;
+
+    // only the owner may scrape
+    ASSERT_EQ(stat(m_socket.c_str(), &st), 0);
+    ASSERT_TRUE(S_ISSOCK(st.st_mode));
+    ASSERT_EQ(st.st_mode & 0777, 0600U);
+
+    ASSERT_NE(counter, nullptr);
+    ASSERT_EQ(metrics_counter("ut_requests_total", "method=\"get\""), counter);
+    metrics_counter_add(counter, 3);
+    metrics_observe_nanos(histogram, 2000000ULL);
+    metrics_observe_nanos(histogram, 200000000ULL);
+    metrics_gauge_add(gauge, 2);
+    metrics_gauge_add(gauge, -1);
+
+    fd = Connect(m_socket);
+    ASSERT_GE(fd, 0);
+    response = Request(fd, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+    close(fd);
+
+    ASSERT_EQ(response.compare(0, strlen("HTTP/1.0 200 OK\r\n"), "HTTP/1.0 200 OK\r\n"), 0) << response;
+    pos = response.find("\r\n\r\n");
+    ASSERT_NE(pos, std::string::npos);
+    body = response.substr(pos + 4);
+    ASSERT_NE(response.find("Content-Length: " + std::to_string(body.size()) + "\r\n"), std::string::npos);
+
+    ASSERT_NE(body.find("# TYPE ut_requests_total counter\nut_requests_total{method=\"get\"} 3\n"),
+              std::string::npos) << body;
+    ASSERT_NE(body.find("# TYPE ut_duration_seconds histogram\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_bucket{le=\"0.001\"} 0\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_bucket{le=\"0.005\"} 1\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_bucket{le=\"0.5\"} 2\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_bucket{le=\"+Inf\"} 2\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_sum 0.202000000\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_duration_seconds_count 2\n"), std::string::npos);
+    ASSERT_NE(body.find("# TYPE ut_running gauge\nut_running 1\n"), std::string::npos);
+    ASSERT_NE(body.find("ut_collected 7\n"), std::string::npos);
+}
+
+TEST_F(MetricsUnitTest, test_bad_requests)
+{
+    std::string response;
+    int idle;
+    int fd;
+
+    fd = Connect(m_socket);
+    ASSERT_GE(fd, 0);
+    response = Request(fd, "GET /other HTTP/1.0\r\n\r\n");
+    close(fd);
+    ASSERT_EQ(response.compare(0, strlen("HTTP/1.0 404 Not Found\r\n"), "HTTP/1.0 404 Not Found\r\n"), 0);
+    ASSERT_NE(response.find("Content-Length: 0\r\n"), std::string::npos);
+
+    // a client which never finishes its request is dropped, others are served after it
+    idle = Connect(m_socket);
+    ASSERT_GE(idle, 0);
+    ASSERT_EQ(util_write_nointr(idle, "GET /met", strlen("GET /met")), (ssize_t)strlen("GET /met"));
+    fd = Connect(m_socket);
+    ASSERT_GE(fd, 0);
+    response = Request(fd, "GET /metrics HTTP/1.0\r\n\r\n");
+    close(fd);
+    ASSERT_EQ(ReadAll(idle), "");
+    close(idle);
+    ASSERT_EQ(response.compare(0, strlen("HTTP/1.0 200 OK\r\n"), "HTTP/1.0 200 OK\r\n"), 0);
+}
+
+TEST_F(MetricsUnitTest, test_accept_backoff_on_emfile)
+{
+    std::string response;
+    int fails;
+    int fd;
+
+    // the server is waiting in accept already, it fails from the accept after this connection
+    g_accept_emfile = true;
+    fd = Connect(m_socket);
+    ASSERT_GE(fd, 0);
+    response = Request(fd, "GET /metrics HTTP/1.0\r\n\r\n");
+    close(fd);
+    ASSERT_EQ(response.compare(0, strlen("HTTP/1.0 200 OK\r\n"), "HTTP/1.0 200 OK\r\n"), 0);
+
+    usleep(500 * 1000);
+    fails = g_accept_fails;
+    g_accept_emfile = false;
+    // accept is not retried in a busy loop
+    ASSERT_GT(fails, 0);
+    ASSERT_LT(fails, 20);
+
+    // and connections are served again once fds are freed
+    fd = Connect(m_socket);
+    ASSERT_GE(fd, 0);
+    response = Request(fd, "GET /metrics HTTP/1.0\r\n\r\n");
+    close(fd);
+    ASSERT_EQ(response.compare(0, strlen("HTTP/1.0 200 OK\r\n"), "HTTP/1.0 200 OK\r\n"), 0);
+}
@@ -77,3 +77,11 @@ void container_update_restart_manager(container_t *cont, const host_config_resta
         return g_container_unix_mock->ContainerUpdateRestartManager(cont, policy);
     }
 }
+
+char *container_get_env_nolock(const container_t *cont, const char *key)
+{
+    if (g_container_unix_mock != nullptr) {
+        return g_container_unix_mock->ContainerGetEnvNolock(cont, key);
+    }
+    return nullptr;
+}
@@ -29,6 +29,7 @@ public:
     MOCK_METHOD1(ContainerLock, void(const container_t *cont));
     MOCK_METHOD1(ContainerUnref, void(container_t *cont));
     MOCK_METHOD2(ContainerUpdateRestartManager, void(container_t *cont, const host_config_restart_policy *policy));
+    MOCK_METHOD2(ContainerGetEnvNolock, char *(const container_t *cont, const char *key));
 };
 
 void MockContainerUnix_SetMock(MockContainerUnix *mock);
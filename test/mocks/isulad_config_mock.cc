@@ -152,3 +152,35 @@ bool conf_get_use_decrypted_key_flag()
     }
     return true;
 }
+
+int conf_get_grpc_request_class_limit(const char *name, size_t *max_inflight, size_t *max_queued)
+{
+    if (g_isulad_conf_mock != nullptr) {
+        return g_isulad_conf_mock->ConfGetGrpcRequestClassLimit(name, max_inflight, max_queued);
+    }
+    return 1;
+}
+
+char *conf_get_enable_plugins()
+{
+    if (g_isulad_conf_mock != nullptr) {
+        return g_isulad_conf_mock->ConfGetEnablePlugins();
+    }
+    return nullptr;
+}
+
+char *conf_get_isulad_statedir()
+{
+    if (g_isulad_conf_mock != nullptr) {
+        return g_isulad_conf_mock->ConfGetIsuladStateDir();
+    }
+    return nullptr;
+}
+
+int conf_get_plugin_event_timeout(const char *name, long *timeout_ms)
+{
+    if (g_isulad_conf_mock != nullptr) {
+        return g_isulad_conf_mock->ConfGetPluginEventTimeout(name, timeout_ms);
+    }
+    return 1;
+}
@@ -36,6 +36,10 @@ public:
     MOCK_METHOD0(GetMonitordPath, char *(void));
     MOCK_METHOD0(ConfGetISuladRootDir, char *(void));
     MOCK_METHOD0(ConfGetUseDecryptedKeyFlag, bool (void));
+    MOCK_METHOD3(ConfGetGrpcRequestClassLimit, int(const char *name, size_t *maxInflight, size_t *maxQueued));
+    MOCK_METHOD0(ConfGetEnablePlugins, char *(void));
+    MOCK_METHOD0(ConfGetIsuladStateDir, char *(void));
+    MOCK_METHOD2(ConfGetPluginEventTimeout, int(const char *name, long *timeoutMs));
 };
 
 void MockIsuladConf_SetMock(MockIsuladConf *mock);
@@ -14,6 +14,7 @@
  ******************************************************************************/
 
 #include "specs_mock.h"
+#include "specs_extend.h"
 
 namespace {
 MockSpecs *g_specs_mock = nullptr;
@@ -47,3 +48,11 @@ int save_oci_config(const char *id, const char *rootpath, const oci_runtime_spec
     }
     return 0;
 }
+
+char *oci_container_get_env(const oci_runtime_spec *oci_spec, const char *key)
+{
+    if (g_specs_mock != nullptr) {
+        return g_specs_mock->OciContainerGetEnv(oci_spec, key);
+    }
+    return nullptr;
+}
@@ -24,6 +24,7 @@ public:
     MOCK_METHOD2(LoadOciConfig, oci_runtime_spec * (const char *rootpath, const char *name));
     MOCK_METHOD2(MergeConfCgroup, int(oci_runtime_spec *oci_spec, const host_config *host_spec));
     MOCK_METHOD3(SaveOciConfig, int(const char *id, const char *rootpath, const oci_runtime_spec *oci_spec));
+    MOCK_METHOD2(OciContainerGetEnv, char *(const oci_runtime_spec *oci_spec, const char *key));
 };
 
 void MockSpecs_SetMock(MockSpecs *mock);
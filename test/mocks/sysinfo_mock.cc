@@ -61,3 +61,19 @@ void free_sysinfo(sysinfo_t *sysinfo)
         return g_sysinfo_mock->FreeSysinfo(sysinfo);
     }
 }
+
+int get_cgroup_version(void)
+{
+    if (g_sysinfo_mock != nullptr) {
+        return g_sysinfo_mock->GetCgroupVersion();
+    }
+    return -1;
+}
+
+int find_cgroup_mountpoint_and_root(const char *subsystem, char **mountpoint, char **root)
+{
+    if (g_sysinfo_mock != nullptr) {
+        return g_sysinfo_mock->FindCgroupMountpointAndRoot(subsystem, mountpoint, root);
+    }
+    return -1;
+}
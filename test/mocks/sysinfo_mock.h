@@ -26,6 +26,8 @@ public:
     MOCK_METHOD1(FreeMountsInfo, void(mountinfo_t **minfos));
     MOCK_METHOD2(ValidateHugetlb, char*(const char *pagesize, uint64_t limit));
     MOCK_METHOD1(FreeSysinfo, void(sysinfo_t *sysinfo));
+    MOCK_METHOD0(GetCgroupVersion, int(void));
+    MOCK_METHOD3(FindCgroupMountpointAndRoot, int(const char *subsystem, char **mountpoint, char **root));
 };
 
 void MockSysinfo_SetMock(MockSysinfo* mock);
@@ -0,0 +1,453 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide plugin event unit test against fake plugin servers
+ ******************************************************************************/
+
+#include "plugin_api.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "isulad_config_mock.h"
+#include "specs_mock.h"
+#include "utils.h"
+
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::_;
+
+#define PLUGIN_UT_WORKERS 4
+
+namespace {
+// answers every event request after a delay, one thread per connection
+class FakePluginServer {
+public:
+    FakePluginServer(const std::string &path, int delayMs)
+        : m_path(path)
+        , m_delayMs(delayMs)
+    {
+    }
+
+    ~FakePluginServer()
+    {
+        Stop();
+    }
+
+    bool Start()
+    {
+        struct sockaddr_un addr;
+
+        (void)memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        (void)strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0) {
+            return false;
+        }
+        (void)unlink(m_path.c_str());
+        if (bind(m_listenFd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(m_listenFd, 64) != 0) {
+            return false;
+        }
+        m_acceptor = std::thread(&FakePluginServer::Accept, this);
+        return true;
+    }
+
+    void Stop()
+    {
+        if (m_listenFd < 0) {
+            return;
+        }
+        m_stopping = true;
+        (void)shutdown(m_listenFd, SHUT_RDWR);
+        m_acceptor.join();
+        close(m_listenFd);
+        m_listenFd = -1;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int fd : m_conns) {
+                (void)shutdown(fd, SHUT_RDWR);
+            }
+        }
+        for (auto &t : m_handlers) {
+            t.join();
+        }
+        m_handlers.clear();
+        (void)unlink(m_path.c_str());
+    }
+
+    int Requests() const
+    {
+        return m_requests;
+    }
+
+private:
+    void Accept()
+    {
+        for (;;) {
+            int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_conns.push_back(fd);
+            m_handlers.emplace_back(&FakePluginServer::Serve, this, fd);
+        }
+    }
+
+    // read one request, return false when the client is gone
+    bool ReadRequest(int fd, std::string &pending)
+    {
+        char buf[4096];
+        size_t headerEnd = std::string::npos;
+
+        while ((headerEnd = pending.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n <= 0) {
+                return false;
+            }
+            pending.append(buf, (size_t)n);
+        }
+        size_t bodyLen = 0;
+        size_t pos = pending.find("Content-Length:");
+        if (pos != std::string::npos && pos < headerEnd) {
+            bodyLen = (size_t)strtoul(pending.c_str() + pos + strlen("Content-Length:"), nullptr, 10);
+        }
+        while (pending.size() < headerEnd + 4 + bodyLen) {
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n <= 0) {
+                return false;
+            }
+            pending.append(buf, (size_t)n);
+        }
+        pending.erase(0, headerEnd + 4 + bodyLen);
+        return true;
+    }
+
+    void Serve(int fd)
+    {
+        std::string pending;
+        const std::string body = "{\"id\":\"c1\"}";
+        const std::string response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                                     std::to_string(body.size()) + "\r\n\r\n" + body;
+
+        while (ReadRequest(fd, pending)) {
+            m_requests++;
+            for (int waited = 0; waited < m_delayMs && !m_stopping; waited += 10) {
+                usleep(10 * 1000);
+            }
+            if (util_write_nointr(fd, response.c_str(), response.size()) != (ssize_t)response.size()) {
+                break;
+            }
+        }
+        close(fd);
+    }
+
+    std::string m_path;
+    int m_delayMs;
+    int m_listenFd { -1 };
+    std::atomic<bool> m_stopping { false };
+    std::atomic<int> m_requests { 0 };
+    std::thread m_acceptor;
+    std::mutex m_mutex;
+    std::vector<int> m_conns;
+    std::vector<std::thread> m_handlers;
+};
+
+int64_t NowNanos()
+{
+    struct timespec ts = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 * 1000 * 1000 + ts.tv_nsec;
+}
+
+// threads of the event dispatch pool
+int EventThreads()
+{
+    DIR *dir = opendir("/proc/self/task");
+    struct dirent *entry = nullptr;
+    int count = 0;
+
+    if (dir == nullptr) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string comm = std::string("/proc/self/task/") + entry->d_name + "/comm";
+        char *name = util_read_text_file(comm.c_str());
+        if (name != nullptr && strncmp(name, "PluginEvent", strlen("PluginEvent")) == 0) {
+            count++;
+        }
+        free(name);
+    }
+    closedir(dir);
+    return count;
+}
+} // namespace
+
+class PluginUnitTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/plugin_ut_XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_dir = tmpl;
+        MockIsuladConf_SetMock(&m_isuladConf);
+        MockSpecs_SetMock(&m_specs);
+        ON_CALL(m_isuladConf, ConfGetPluginEventTimeout(_, _))
+        .WillByDefault(Invoke(this, &PluginUnitTest::EventTimeout));
+        ON_CALL(m_specs, OciContainerGetEnv(_, _))
+        .WillByDefault(Invoke(this, &PluginUnitTest::GetEnv));
+        ASSERT_EQ(pm_init(), 0);
+
+        m_oci = (oci_runtime_spec *)util_common_calloc_s(sizeof(oci_runtime_spec));
+        ASSERT_NE(m_oci, nullptr);
+        m_oci->process = (defs_process *)util_common_calloc_s(sizeof(defs_process));
+        ASSERT_NE(m_oci->process, nullptr);
+    }
+
+    void TearDown() override
+    {
+        for (auto plugin : m_plugins) {
+            (void)pm_del_plugin(plugin);
+        }
+        free_oci_runtime_spec(m_oci);
+        MockIsuladConf_SetMock(nullptr);
+        MockSpecs_SetMock(nullptr);
+        (void)util_recursive_rmdir(m_dir.c_str(), 0);
+    }
+
+    int EventTimeout(const char *name, long *timeoutMs)
+    {
+        if (strcmp(name, "slow") == 0) {
+            *timeoutMs = 200;
+            return 0;
+        }
+        return 1;
+    }
+
+    char *GetEnv(const oci_runtime_spec *oci, const char *key)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        return m_enabled.empty() ? nullptr : util_strdup_s(m_enabled.c_str());
+    }
+
+    std::string Socket(const std::string &name)
+    {
+        return m_dir + "/" + name + ".sock";
+    }
+
+    plugin_t *AddPlugin(const std::string &name, const std::string &addr)
+    {
+        plugin_manifest_t manifest = { 0 };
+        plugin_t *plugin = plugin_new(name.c_str(), addr.c_str());
+
+        if (plugin == nullptr) {
+            return nullptr;
+        }
+        manifest.watch_event = PLUGIN_EVENT_CONTAINER_POST_REMOVE;
+        (void)plugin_set_manifest(plugin, &manifest);
+        if (pm_add_plugin(plugin) != 0) {
+            plugin_put(plugin);
+            return nullptr;
+        }
+        m_plugins.push_back(plugin);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_enabled += m_enabled.empty() ? name : "," + name;
+        return plugin;
+    }
+
+    int SendEvent()
+    {
+        return plugin_event_container_post_remove2("c1", m_oci);
+    }
+
+    plugin_stats_t Stats(plugin_t *plugin)
+    {
+        plugin_stats_t stats;
+
+        plugin_get_stats(plugin, &stats);
+        return stats;
+    }
+
+    void SetOpenUntil(plugin_t *plugin, int64_t openUntil)
+    {
+        (void)pthread_rwlock_wrlock(&plugin->lock);
+        plugin->open_until = openUntil;
+        (void)pthread_rwlock_unlock(&plugin->lock);
+    }
+
+    int64_t OpenUntil(plugin_t *plugin)
+    {
+        int64_t openUntil = 0;
+
+        (void)pthread_rwlock_rdlock(&plugin->lock);
+        openUntil = plugin->open_until;
+        (void)pthread_rwlock_unlock(&plugin->lock);
+        return openUntil;
+    }
+
+    NiceMock<MockIsuladConf> m_isuladConf;
+    NiceMock<MockSpecs> m_specs;
+    std::string m_dir;
+    std::mutex m_mutex;
+    std::string m_enabled;
+    std::vector<plugin_t *> m_plugins;
+    oci_runtime_spec *m_oci { nullptr };
+};
+
+TEST_F(PluginUnitTest, test_breaker_opens_after_failures)
+{
+    // nothing listens on the socket
+    plugin_t *plugin = AddPlugin("down", Socket("down"));
+    ASSERT_NE(plugin, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_NE(SendEvent(), 0);
+    }
+    ASSERT_EQ(Stats(plugin).requests, 3U);
+    ASSERT_EQ(Stats(plugin).failures, 3U);
+    ASSERT_EQ(Stats(plugin).rejected, 0U);
+
+    // open for 10s, the next events fail without a request
+    int64_t left = OpenUntil(plugin) - NowNanos();
+    ASSERT_GT(left, 9LL * 1000 * 1000 * 1000);
+    ASSERT_LE(left, 10LL * 1000 * 1000 * 1000);
+    ASSERT_NE(SendEvent(), 0);
+    ASSERT_NE(SendEvent(), 0);
+    ASSERT_EQ(Stats(plugin).requests, 3U);
+    ASSERT_EQ(Stats(plugin).rejected, 2U);
+}
+
+TEST_F(PluginUnitTest, test_breaker_half_open)
+{
+    FakePluginServer server(Socket("flaky"), 0);
+    plugin_t *plugin = AddPlugin("flaky", Socket("flaky"));
+    ASSERT_NE(plugin, nullptr);
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_NE(SendEvent(), 0);
+    }
+
+    // a failed trial opens it again for 10s
+    SetOpenUntil(plugin, NowNanos() - 1);
+    ASSERT_NE(SendEvent(), 0);
+    ASSERT_EQ(Stats(plugin).requests, 4U);
+    ASSERT_GT(OpenUntil(plugin) - NowNanos(), 9LL * 1000 * 1000 * 1000);
+    ASSERT_NE(SendEvent(), 0);
+    ASSERT_EQ(Stats(plugin).rejected, 1U);
+
+    // the plugin is back, still failed fast until the 10s are over
+    ASSERT_TRUE(server.Start());
+    ASSERT_NE(SendEvent(), 0);
+    ASSERT_EQ(server.Requests(), 0);
+
+    // a successful trial closes it
+    SetOpenUntil(plugin, NowNanos() - 1);
+    ASSERT_EQ(SendEvent(), 0);
+    ASSERT_EQ(server.Requests(), 1);
+    ASSERT_EQ(OpenUntil(plugin), 0);
+    ASSERT_EQ(SendEvent(), 0);
+    ASSERT_EQ(server.Requests(), 2);
+    ASSERT_EQ(Stats(plugin).requests, 6U);
+}
+
+TEST_F(PluginUnitTest, test_per_plugin_timeout)
+{
+    FakePluginServer slowServer(Socket("slow"), 2000);
+    FakePluginServer fastServer(Socket("fast"), 0);
+    ASSERT_TRUE(slowServer.Start());
+    ASSERT_TRUE(fastServer.Start());
+    plugin_t *slow = AddPlugin("slow", Socket("slow"));
+    plugin_t *fast = AddPlugin("fast", Socket("fast"));
+    ASSERT_NE(slow, nullptr);
+    ASSERT_NE(fast, nullptr);
+    ASSERT_EQ(slow->event_timeout_ms, 200);
+    ASSERT_EQ(fast->event_timeout_ms, 30 * 1000);
+
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_NE(SendEvent(), 0);
+    auto took = std::chrono::steady_clock::now() - start;
+
+    // the slow plugin is given up after its own deadline, the fast one is answered meanwhile
+    ASSERT_GE(took, std::chrono::milliseconds(200));
+    ASSERT_LT(took, std::chrono::milliseconds(1500));
+    ASSERT_EQ(Stats(slow).failures, 1U);
+    ASSERT_EQ(Stats(fast).failures, 0U);
+    ASSERT_EQ(fastServer.Requests(), 1);
+}
+
+TEST_F(PluginUnitTest, test_dispatch_pool_bounded)
+{
+    const int plugins = 12;
+    const int callers = 4;
+    const int events = 3;
+    FakePluginServer server(Socket("many"), 100);
+    std::vector<std::thread> threads;
+    std::atomic<int> failed { 0 };
+    std::atomic<bool> done { false };
+    int maxThreads = 0;
+
+    ASSERT_TRUE(server.Start());
+    for (int i = 0; i < plugins; i++) {
+        ASSERT_NE(AddPlugin("p" + std::to_string(i), Socket("many")), nullptr);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < callers; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < events; j++) {
+                if (SendEvent() != 0) {
+                    failed++;
+                }
+            }
+        });
+    }
+    std::thread sampler([&] {
+        while (!done) {
+            maxThreads = std::max(maxThreads, EventThreads());
+            usleep(10 * 1000);
+        }
+    });
+    for (auto &t : threads) {
+        t.join();
+    }
+    auto took = std::chrono::steady_clock::now() - start;
+    done = true;
+    sampler.join();
+
+    ASSERT_EQ(failed, 0);
+    ASSERT_EQ(server.Requests(), plugins * callers * events);
+    // a fixed pool, not a thread per plugin and event
+    ASSERT_GT(maxThreads, 0);
+    ASSERT_LE(maxThreads, PLUGIN_UT_WORKERS);
+    // plugins are still asked at the same time, 144 requests of 100ms one after another take 14.4s
+    ASSERT_LT(took, std::chrono::seconds(6));
+}
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Description: isula runtime cgroup unit test
+ * Author: agent
+ * Create: 2026-10-18
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "isula_rt_cgroup.h"
+#include "sysinfo_mock.h"
+#include "utils.h"
+
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::Invoke;
+using ::testing::_;
+
+/*
+ * The cgroup files are plain files of a temporary directory: a v1 hierarchy of each subsystem
+ * is mounted at $tmp/$subsystem, the v2 one is reached from CGROUP_MOUNTPOINT with "..".
+ */
+class IsulaRtCgroupUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/isula_rt_cgroup_ut.XXXXXX";
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_dir = tmpl;
+        m_root = "/";
+
+        MockSysinfo_SetMock(&m_sysinfo);
+        ON_CALL(m_sysinfo, GetCgroupVersion()).WillByDefault(Return(CGROUP_VERSION_1));
+        ON_CALL(m_sysinfo, FindCgroupMountpointAndRoot(_, _, _))
+        .WillByDefault(Invoke(this, &IsulaRtCgroupUnitTest::FindMountpoint));
+    }
+
+    void TearDown() override
+    {
+        MockSysinfo_SetMock(nullptr);
+        (void)util_recursive_rmdir(m_dir.c_str(), 0);
+    }
+
+    int FindMountpoint(const char *subsystem, char **mountpoint, char **root)
+    {
+        if (std::find(m_unmounted.begin(), m_unmounted.end(), subsystem) != m_unmounted.end()) {
+            return -1;
+        }
+        *mountpoint = util_strdup_s((m_dir + "/" + subsystem).c_str());
+        if (root != nullptr) {
+            *root = util_strdup_s(m_root.c_str());
+        }
+        return 0;
+    }
+
+    // make the container cgroup dir, with files of the given content
+    std::string MakeCgroup(const std::string &dir, const std::vector<std::pair<std::string, std::string>> &files)
+    {
+        std::string path = m_dir + "/" + dir;
+
+        EXPECT_EQ(util_mkdir_p(path.c_str(), 0755), 0);
+        for (const auto &f : files) {
+            std::ofstream out(path + "/" + f.first);
+            out << f.second;
+        }
+        return path;
+    }
+
+    std::string ReadFile(const std::string &path)
+    {
+        std::ifstream in(path);
+        std::stringstream ss;
+
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+    // the cgroup path of dir of the v2 hierarchy
+    std::string V2CgroupPath(const std::string &dir)
+    {
+        return std::string("../../..") + m_dir + "/" + dir;
+    }
+
+    NiceMock<MockSysinfo> m_sysinfo;
+    std::string m_dir;
+    std::string m_root;
+    std::vector<std::string> m_unmounted;
+};
+
+TEST_F(IsulaRtCgroupUnitTest, test_update_v1)
+{
+    host_config hc = {};
+    std::string blkio = MakeCgroup("blkio/c1", { { "blkio.weight", "" } });
+    std::string cpu = MakeCgroup("cpu/c1", { { "cpu.shares", "" }, { "cpu.cfs_period_us", "" }, { "cpu.cfs_quota_us", "100000" } });
+    std::string cpuset = MakeCgroup("cpuset/c1", { { "cpuset.cpus", "" }, { "cpuset.mems", "" } });
+    std::string pids = MakeCgroup("pids/c1", { { "pids.max", "" } });
+
+    hc.blkio_weight = 500;
+    hc.cpu_shares = 1024;
+    hc.cpu_period = 100000;
+    hc.cpu_quota = -1;
+    hc.cpuset_cpus = (char *)"0-1";
+    hc.cpuset_mems = (char *)"0";
+    hc.pids_limit = 100;
+
+    ASSERT_EQ(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(blkio + "/blkio.weight"), "500");
+    ASSERT_EQ(ReadFile(cpu + "/cpu.shares"), "1024");
+    ASSERT_EQ(ReadFile(cpu + "/cpu.cfs_period_us"), "100000");
+    ASSERT_EQ(ReadFile(cpu + "/cpu.cfs_quota_us"), "-1");
+    ASSERT_EQ(ReadFile(cpuset + "/cpuset.cpus"), "0-1");
+    ASSERT_EQ(ReadFile(cpuset + "/cpuset.mems"), "0");
+    ASSERT_EQ(ReadFile(pids + "/pids.max"), "100");
+
+    // nano cpus is a quota of a 100ms period, no pids limit is max on v1 too
+    hc = {};
+    hc.nano_cpus = 1500000000;
+    hc.pids_limit = -1;
+    ASSERT_EQ(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(cpu + "/cpu.cfs_period_us"), "100000");
+    ASSERT_EQ(ReadFile(cpu + "/cpu.cfs_quota_us"), "150000");
+    ASSERT_EQ(ReadFile(pids + "/pids.max"), "max");
+}
+
+TEST_F(IsulaRtCgroupUnitTest, test_update_v1_memsw_order)
+{
+    host_config hc = {};
+    std::string memory = MakeCgroup("memory/c1", { { "memory.limit_in_bytes", "1073741824" } });
+
+    // no memory.memsw.limit_in_bytes: the write of memsw fails, see what was written before it
+    hc.memory = 2147483648;
+    hc.memory_swap = 4294967296;
+    ASSERT_NE(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(memory + "/memory.limit_in_bytes"), "1073741824");
+
+    // lower the limit: memory first, then memsw
+    hc.memory = 536870912;
+    hc.memory_swap = 1073741824;
+    ASSERT_NE(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(memory + "/memory.limit_in_bytes"), "536870912");
+
+    // no limit is raising the limit
+    hc.memory = -1;
+    hc.memory_swap = -1;
+    ASSERT_NE(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(memory + "/memory.limit_in_bytes"), "536870912");
+
+    MakeCgroup("memory/c1", { { "memory.memsw.limit_in_bytes", "1073741824" }, { "memory.soft_limit_in_bytes", "" } });
+    hc.memory_reservation = 268435456;
+    ASSERT_EQ(isula_cgroup_update("/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(memory + "/memory.limit_in_bytes"), "-1");
+    ASSERT_EQ(ReadFile(memory + "/memory.memsw.limit_in_bytes"), "-1");
+    ASSERT_EQ(ReadFile(memory + "/memory.soft_limit_in_bytes"), "268435456");
+}
+
+TEST_F(IsulaRtCgroupUnitTest, test_update_v2)
+{
+    host_config hc = {};
+    std::string dir = MakeCgroup("unified/c1", { { "io.weight", "" },
+        { "cpu.weight", "" }, { "cpu.max", "max 100000" },
+        { "memory.max", "" }, { "memory.swap.max", "" }, { "memory.low", "" },
+        { "pids.max", "" }
+    });
+
+    EXPECT_CALL(m_sysinfo, GetCgroupVersion()).WillRepeatedly(Return(CGROUP_VERSION_2));
+    EXPECT_CALL(m_sysinfo, FindCgroupMountpointAndRoot(_, _, _)).Times(0);
+
+    hc.blkio_weight = 500;
+    hc.cpu_shares = 1024;
+    hc.cpu_quota = 50000;
+    hc.memory = 536870912;
+    hc.memory_swap = 1073741824;
+    hc.memory_reservation = 268435456;
+    hc.pids_limit = 100;
+    ASSERT_EQ(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+    ASSERT_EQ(ReadFile(dir + "/io.weight"), "default 4950");
+    ASSERT_EQ(ReadFile(dir + "/cpu.weight"), "39");
+    // the period is kept
+    ASSERT_EQ(ReadFile(dir + "/cpu.max"), "50000 100000");
+    ASSERT_EQ(ReadFile(dir + "/memory.max"), "536870912");
+    // swap only, without memory
+    ASSERT_EQ(ReadFile(dir + "/memory.swap.max"), "536870912");
+    ASSERT_EQ(ReadFile(dir + "/memory.low"), "268435456");
+    ASSERT_EQ(ReadFile(dir + "/pids.max"), "100");
+
+    // bounds of the weights, no limits are max
+    hc = {};
+    hc.blkio_weight = 10;
+    hc.cpu_shares = 262144;
+    hc.cpu_quota = -1;
+    hc.cpu_period = 200000;
+    hc.memory = -1;
+    hc.memory_swap = -1;
+    hc.pids_limit = -1;
+    ASSERT_EQ(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+    ASSERT_EQ(ReadFile(dir + "/io.weight"), "default 1");
+    ASSERT_EQ(ReadFile(dir + "/cpu.weight"), "10000");
+    ASSERT_EQ(ReadFile(dir + "/cpu.max"), "max 200000");
+    ASSERT_EQ(ReadFile(dir + "/memory.max"), "max");
+    ASSERT_EQ(ReadFile(dir + "/memory.swap.max"), "max");
+    ASSERT_EQ(ReadFile(dir + "/pids.max"), "max");
+}
+
+TEST_F(IsulaRtCgroupUnitTest, test_update_v2_invalid)
+{
+    host_config hc = {};
+    std::string dir = MakeCgroup("unified/c1", { { "memory.max", "1073741824" }, { "memory.swap.max", "" } });
+
+    EXPECT_CALL(m_sysinfo, GetCgroupVersion()).WillRepeatedly(Return(CGROUP_VERSION_2));
+
+    // swap of the current memory limit
+    hc.memory_swap = 536870912;
+    ASSERT_NE(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+    ASSERT_EQ(ReadFile(dir + "/memory.swap.max"), "");
+    hc.memory_swap = 2147483648;
+    ASSERT_EQ(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+    ASSERT_EQ(ReadFile(dir + "/memory.swap.max"), "1073741824");
+
+    hc = {};
+    hc.cpu_realtime_runtime = 1000;
+    ASSERT_NE(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+
+    EXPECT_CALL(m_sysinfo, GetCgroupVersion()).WillRepeatedly(Return(-1));
+    hc = {};
+    hc.pids_limit = 100;
+    ASSERT_NE(isula_cgroup_update(V2CgroupPath("unified/c1").c_str(), &hc), 0);
+    ASSERT_NE(isula_cgroup_update(nullptr, &hc), 0);
+    ASSERT_NE(isula_cgroup_update("/c1", nullptr), 0);
+}
+
+TEST_F(IsulaRtCgroupUnitTest, test_update_v1_root)
+{
+    host_config hc = {};
+    std::string pids = MakeCgroup("pids/isulad/c1", { { "pids.max", "" } });
+    std::string other = MakeCgroup("pids/docker/abcd/isulad/c1", { { "pids.max", "" } });
+
+    hc.pids_limit = 100;
+
+    // isulad in a container, the hierarchy is mounted from the cgroup of the container
+    m_root = "/docker/abc/";
+    ASSERT_EQ(isula_cgroup_update("/docker/abc/isulad/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(pids + "/pids.max"), "100");
+
+    // not under the root
+    hc.pids_limit = 200;
+    ASSERT_EQ(isula_cgroup_update("/docker/abcd/isulad/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(other + "/pids.max"), "200");
+    ASSERT_EQ(ReadFile(pids + "/pids.max"), "100");
+
+    m_root = "/";
+    hc.pids_limit = 300;
+    ASSERT_EQ(isula_cgroup_update("/isulad/c1", &hc), 0);
+    ASSERT_EQ(ReadFile(pids + "/pids.max"), "300");
+}
+
+TEST_F(IsulaRtCgroupUnitTest, test_get_pids)
+{
+    pid_t *pids = nullptr;
+    size_t len = 0;
+    std::vector<pid_t> got;
+
+    MakeCgroup("pids/c1", { { "cgroup.procs", "1\n22\n" } });
+    MakeCgroup("pids/c1/sub", { { "cgroup.procs", "333\n" } });
+    MakeCgroup("pids/c1/sub/sub", { { "cgroup.procs", "" } });
+    MakeCgroup("cpu/c1", { { "cgroup.procs", "4444\n" } });
+
+    ASSERT_EQ(isula_cgroup_get_pids("/c1", &pids, &len), 0);
+    got.assign(pids, pids + len);
+    free(pids);
+    std::sort(got.begin(), got.end());
+    ASSERT_EQ(got, std::vector<pid_t>({ 1, 22, 333 }));
+
+    // no pids hierarchy, cpu has the same processes
+    m_unmounted.push_back("pids");
+    ASSERT_EQ(isula_cgroup_get_pids("/c1", &pids, &len), 0);
+    ASSERT_EQ(len, 1U);
+    ASSERT_EQ(pids[0], 4444);
+    free(pids);
+
+    MakeCgroup("cpu/c1", { { "cgroup.procs", "4444\nabc\n" } });
+    ASSERT_NE(isula_cgroup_get_pids("/c1", &pids, &len), 0);
+    m_unmounted.push_back("cpu");
+    ASSERT_NE(isula_cgroup_get_pids("/c1", &pids, &len), 0);
+
+    // v2 has one hierarchy
+    EXPECT_CALL(m_sysinfo, GetCgroupVersion()).WillRepeatedly(Return(CGROUP_VERSION_2));
+    MakeCgroup("unified/c1", { { "cgroup.procs", "5\n" } });
+    MakeCgroup("unified/c1/init", { { "cgroup.procs", "6\n" } });
+    ASSERT_EQ(isula_cgroup_get_pids(V2CgroupPath("unified/c1").c_str(), &pids, &len), 0);
+    got.assign(pids, pids + len);
+    free(pids);
+    std::sort(got.begin(), got.end());
+    ASSERT_EQ(got, std::vector<pid_t>({ 5, 6 }));
+}
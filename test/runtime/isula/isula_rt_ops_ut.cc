@@ -16,10 +16,18 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <dirent.h>
+#include <signal.h>
+#include <time.h>
+#include <fstream>
+#include <string>
 #include <gtest/gtest.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <fcntl.h>
+#include <isula_libutils/oci_runtime_spec.h>
 #include "mock.h"
 #include "isula_rt_ops.h"
 #include <gtest/gtest.h>
@@ -27,6 +35,8 @@
 #include "engine_mock.h"
 #include "isulad_config_mock.h"
 #include "utils.h"
+#include "utils_convert.h"
+#include "utils_file.h"
 
 using ::testing::Args;
 using ::testing::ByRef;
@@ -163,3 +173,337 @@ TEST_F(IsulaRtOpsUnitTest, test_rt_isula_exec_resize)
     close(fd);
     ASSERT_EQ(system(rm_path.c_str()), 0);
 }
+
+namespace {
+// started as isulad-shim <id> <bundle> <runtime> info 2m0s in the workdir, the container
+// process is a sleep in the session of the shim
+const char *FAKE_SHIM = "#!/bin/bash\n"
+                        "fd=$ISULAD_SHIM_READY_FD\n"
+                        "case \"$FAKE_SHIM_MODE\" in\n"
+                        "report)\n"
+                        "    eval \"sleep 60 $fd>&- &\"\n"
+                        "    echo \"$! 0\" >&$fd\n"
+                        "    ;;\n"
+                        "error)\n"
+                        "    echo \"0 1\" >&$fd\n"
+                        "    exit 1\n"
+                        "    ;;\n"
+                        "pidfile)\n"
+                        "    eval \"sleep 60 $fd>&- &\"\n"
+                        "    echo -n $! > pid\n"
+                        "    ;;\n"
+                        "esac\n"
+                        "exec sleep 60\n";
+
+// "state" reports paused, which no process check gives
+const char *FAKE_RUNC = "#!/bin/sh\n"
+                        "for arg; do\n"
+                        "    if [ \"$arg\" = state ]; then\n"
+                        "        echo '{\"ociVersion\": \"1.0.2\", \"id\": \"shim-ut\", \"status\": \"paused\", \"pid\": 0, \"bundle\": \"/\"}'\n"
+                        "    fi\n"
+                        "done\n"
+                        "exit 0\n";
+
+int OpenFds()
+{
+    DIR *dir = opendir("/proc/self/fd");
+    struct dirent *entry = nullptr;
+    int count = 0;
+
+    if (dir == nullptr) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+long ElapsedMs(const struct timespec &beg)
+{
+    struct timespec end = { 0 };
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &end);
+    return (end.tv_sec - beg.tv_sec) * 1000 + (end.tv_nsec - beg.tv_nsec) / 1000000;
+}
+} // namespace
+
+class IsulaRtShimUnitTest : public testing::Test {
+protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/isula_rt_shim_ut.XXXXXX";
+        const char *path = getenv("PATH");
+
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        m_root = tmpl;
+        m_workdir = m_root + "/" + m_id;
+        ASSERT_EQ(mkdir(m_workdir.c_str(), 0700), 0);
+        ASSERT_EQ(mkdir((m_root + "/bin").c_str(), 0700), 0);
+        ASSERT_EQ(util_write_file((m_root + "/bin/isulad-shim").c_str(), FAKE_SHIM, strlen(FAKE_SHIM), 0700), 0);
+        ASSERT_EQ(util_write_file((m_root + "/bin/runc").c_str(), FAKE_RUNC, strlen(FAKE_RUNC), 0700), 0);
+
+        m_path = path != nullptr ? path : "";
+        ASSERT_EQ(setenv("PATH", (m_root + "/bin:" + m_path).c_str(), 1), 0);
+
+        m_config.process = &m_process;
+        m_create.bundle = m_root.c_str();
+        m_create.state = m_root.c_str();
+        m_create.oci_config_data = &m_config;
+        m_start.state = m_root.c_str();
+    }
+
+    void TearDown() override
+    {
+        rt_clean_params_t params = {};
+
+        KillShim();
+        params.statepath = m_root.c_str();
+        (void)rt_isula_clean_resource(m_id, "runc", &params);
+        (void)setenv("PATH", m_path.c_str(), 1);
+        (void)unsetenv("FAKE_SHIM_MODE");
+        (void)util_recursive_rmdir(m_root.c_str(), 0);
+    }
+
+    int Create(const char *mode)
+    {
+        (void)setenv("FAKE_SHIM_MODE", mode, 1);
+        return rt_isula_create(m_id, "runc", &m_create);
+    }
+
+    // the shim and the container process
+    void KillShim()
+    {
+        char *data = util_read_text_file((m_workdir + "/shim-pid").c_str());
+        int pid = 0;
+
+        if (data != nullptr && util_safe_int(data, &pid) == 0 && pid > 0) {
+            (void)kill(-pid, SIGKILL);
+        }
+        free(data);
+    }
+
+    // the container process runs sleep a moment after it is forked
+    bool IsSleep(int pid)
+    {
+        std::string fname = "/proc/" + std::to_string(pid) + "/comm";
+
+        for (int i = 0; i < 1000; i++) {
+            std::ifstream comm(fname);
+            std::string name;
+            if (std::getline(comm, name) && name == "sleep") {
+                return true;
+            }
+            usleep(1000);
+        }
+        return false;
+    }
+
+    const char *m_id { "shim-ut" };
+    std::string m_root;
+    std::string m_workdir;
+    std::string m_path;
+    defs_process m_process {};
+    oci_runtime_spec m_config {};
+    rt_create_params_t m_create {};
+    rt_start_params_t m_start {};
+};
+
+TEST_F(IsulaRtShimUnitTest, test_start_pid_from_readiness_pipe)
+{
+    pid_ppid_info_t pid_info = {};
+
+    ASSERT_EQ(Create("report"), 0);
+    ASSERT_EQ(rt_isula_start(m_id, "runc", &m_start, &pid_info), 0);
+    // the pid was never written to the pid file
+    ASSERT_NE(access((m_workdir + "/pid").c_str(), F_OK), 0);
+    ASSERT_GT(pid_info.pid, 0);
+    ASSERT_TRUE(IsSleep(pid_info.pid));
+    ASSERT_GT(pid_info.ppid, 0);
+}
+
+TEST_F(IsulaRtShimUnitTest, test_start_reported_error)
+{
+    pid_ppid_info_t pid_info = {};
+    struct timespec beg = { 0 };
+
+    ASSERT_EQ(Create("error"), 0);
+    ASSERT_EQ(clock_gettime(CLOCK_MONOTONIC, &beg), 0);
+    ASSERT_EQ(rt_isula_start(m_id, "runc", &m_start, &pid_info), -1);
+    // failed at once instead of waiting for the pid file
+    ASSERT_LT(ElapsedMs(beg), 10 * 1000);
+}
+
+TEST_F(IsulaRtShimUnitTest, test_start_pid_file_fallback)
+{
+    pid_ppid_info_t pid_info = {};
+    struct timespec beg = { 0 };
+    long elapsed = 0;
+
+    // a shim which does not report, the pipe stays open
+    ASSERT_EQ(Create("pidfile"), 0);
+    ASSERT_EQ(clock_gettime(CLOCK_MONOTONIC, &beg), 0);
+    ASSERT_EQ(rt_isula_start(m_id, "runc", &m_start, &pid_info), 0);
+    elapsed = ElapsedMs(beg);
+    ASSERT_TRUE(IsSleep(pid_info.pid));
+    // found by the pid file check after 500ms without a report
+    ASSERT_GE(elapsed, 400);
+    ASSERT_LT(elapsed, 10 * 1000);
+}
+
+TEST_F(IsulaRtShimUnitTest, test_create_again_closes_old_pipe)
+{
+    pid_ppid_info_t pid_info = {};
+    int fds = OpenFds();
+
+    ASSERT_EQ(Create("report"), 0);
+    ASSERT_EQ(OpenFds(), fds + 1);
+    KillShim();
+
+    // the pipe of the first create is closed, not leaked
+    ASSERT_EQ(Create("report"), 0);
+    ASSERT_EQ(OpenFds(), fds + 1);
+    ASSERT_EQ(rt_isula_start(m_id, "runc", &m_start, &pid_info), 0);
+    ASSERT_TRUE(IsSleep(pid_info.pid));
+    ASSERT_EQ(OpenFds(), fds);
+}
+
+// the test is the shim of a forked container process
+class IsulaRtStatusUnitTest : public IsulaRtShimUnitTest {
+protected:
+    void SetUp() override
+    {
+        IsulaRtShimUnitTest::SetUp();
+        m_child = fork();
+        ASSERT_GE(m_child, 0);
+        if (m_child == 0) {
+            for (;;) {
+                pause();
+            }
+        }
+        WriteInt("shim-pid", getpid());
+        WriteInt("pid", m_child);
+        ASSERT_TRUE(SaveLast());
+        m_params.state = m_root.c_str();
+        m_params.last_pid_info = &m_last;
+    }
+
+    void TearDown() override
+    {
+        // not to be killed as the shim
+        (void)unlink((m_workdir + "/shim-pid").c_str());
+        if (m_child > 0) {
+            (void)kill(m_child, SIGKILL);
+            (void)waitpid(m_child, nullptr, 0);
+        }
+        IsulaRtShimUnitTest::TearDown();
+    }
+
+    void WriteInt(const char *name, int val)
+    {
+        std::string data = std::to_string(val);
+
+        ASSERT_EQ(util_write_file((m_workdir + "/" + name).c_str(), data.c_str(), data.size(), 0600), 0);
+    }
+
+    // as saved by the start of the container
+    bool SaveLast()
+    {
+        proc_t *proc = util_get_process_proc_info(m_child);
+        proc_t *pproc = util_get_process_proc_info(getpid());
+        bool ret = proc != nullptr && pproc != nullptr;
+
+        if (ret) {
+            m_last.pid = m_child;
+            m_last.start_time = proc->start_time;
+            m_last.ppid = getpid();
+            m_last.pstart_time = pproc->start_time;
+        }
+        free(proc);
+        free(pproc);
+        return ret;
+    }
+
+    int Status()
+    {
+        m_status = {};
+        return rt_isula_status(m_id, "runc", &m_params, &m_status);
+    }
+
+    pid_t m_child { -1 };
+    pid_ppid_info_t m_last {};
+    rt_status_params_t m_params {};
+    struct runtime_container_status_info m_status {};
+};
+
+TEST_F(IsulaRtStatusUnitTest, test_status_running_process)
+{
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_RUNNING);
+    ASSERT_TRUE(m_status.has_pid);
+    ASSERT_EQ(m_status.pid, (uint32_t)m_child);
+
+    // without the last process the runtime is asked
+    m_params.last_pid_info = nullptr;
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_PAUSED);
+}
+
+TEST_F(IsulaRtStatusUnitTest, test_status_exited_process)
+{
+    ASSERT_EQ(kill(m_child, SIGKILL), 0);
+    ASSERT_EQ(waitpid(m_child, nullptr, 0), m_child);
+    m_child = -1;
+
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_STOPPED);
+}
+
+TEST_F(IsulaRtStatusUnitTest, test_status_reused_pid)
+{
+    // the pid now belongs to a process started at another time
+    m_last.start_time++;
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_STOPPED);
+}
+
+TEST_F(IsulaRtStatusUnitTest, test_status_zombie_asks_runtime)
+{
+    proc_t *proc = nullptr;
+    bool zombie = false;
+
+    ASSERT_EQ(kill(m_child, SIGKILL), 0);
+    for (int i = 0; i < 1000 && !zombie; i++) {
+        proc = util_get_process_proc_info(m_child);
+        zombie = proc != nullptr && proc->state == 'Z';
+        free(proc);
+        usleep(1000);
+    }
+    ASSERT_TRUE(zombie);
+
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_PAUSED);
+}
+
+TEST_F(IsulaRtStatusUnitTest, test_status_pid_file_asks_runtime)
+{
+    // missing
+    ASSERT_EQ(unlink((m_workdir + "/pid").c_str()), 0);
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_PAUSED);
+
+    // of another process
+    WriteInt("pid", getpid());
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_PAUSED);
+}
+
+TEST_F(IsulaRtStatusUnitTest, test_status_other_parent_asks_runtime)
+{
+    m_last.pstart_time++;
+    ASSERT_EQ(Status(), 0);
+    ASSERT_EQ(m_status.status, RUNTIME_CONTAINER_STATUS_PAUSED);
+}
@@ -0,0 +1,269 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide stats sampler unit test
+ ******************************************************************************/
+
+#include "stats_sampler.h"
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "runtime_mock.h"
+#include "containers_store_mock.h"
+#include "container_state_mock.h"
+#include "container_unix_mock.h"
+#include "collector_mock.h"
+#include "isulad_config_mock.h"
+#include "sysinfo_mock.h"
+#include "utils.h"
+#include "utils_array.h"
+
+using ::testing::NiceMock;
+using ::testing::Invoke;
+using ::testing::_;
+
+#define STATS_SAMPLER_UT_CLIENTS 20
+#define STATS_SAMPLER_UT_SAMPLES 20
+
+/*
+ * The store has a running container c1 and a stopped c2, the runtime counts the stats read
+ * of each container. The events client stands for the collector and returns when the
+ * sampler cancels it, that is when the sampler stopped.
+ */
+class StatsSamplerUnitTest : public testing::Test {
+public:
+    void SetUp() override
+    {
+        MockRuntime_SetMock(&m_runtime);
+        MockContainersStore_SetMock(&m_containersStore);
+        MockContainerState_SetMock(&m_containerState);
+        MockContainerUnix_SetMock(&m_containerUnix);
+        MockCollector_SetMock(&m_collector);
+        MockIsuladConf_SetMock(&m_isuladConf);
+        MockSysinfo_SetMock(&m_sysinfo);
+
+        NewContainer("c1");
+        NewContainer("c2");
+
+        ON_CALL(m_containersStore, ContainersStoreListIds())
+        .WillByDefault(Invoke(this, &StatsSamplerUnitTest::ListIds));
+        ON_CALL(m_containersStore, ContainersStoreGet(_))
+        .WillByDefault(Invoke(this, &StatsSamplerUnitTest::StoreGet));
+        ON_CALL(m_containerState, IsRunning(_))
+        .WillByDefault(Invoke(this, &StatsSamplerUnitTest::IsRunning));
+        ON_CALL(m_runtime, RuntimeResourcesStats(_, _, _, _))
+        .WillByDefault(Invoke(this, &StatsSamplerUnitTest::ResourcesStats));
+        ON_CALL(m_collector, AddMonitorClient(_, _, _, _))
+        .WillByDefault(Invoke(this, &StatsSamplerUnitTest::AddMonitorClient));
+    }
+
+    void TearDown() override
+    {
+        MockRuntime_SetMock(nullptr);
+        MockContainersStore_SetMock(nullptr);
+        MockContainerState_SetMock(nullptr);
+        MockContainerUnix_SetMock(nullptr);
+        MockCollector_SetMock(nullptr);
+        MockIsuladConf_SetMock(nullptr);
+        MockSysinfo_SetMock(nullptr);
+
+        for (auto &it : m_containers) {
+            free(it.second->common_config->id);
+            free(it.second->common_config);
+            free(it.second->state);
+            free(it.second);
+        }
+    }
+
+    void NewContainer(const char *id)
+    {
+        container_t *cont = (container_t *)util_common_calloc_s(sizeof(container_t));
+
+        cont->common_config =
+            (container_config_v2_common_config *)util_common_calloc_s(sizeof(container_config_v2_common_config));
+        cont->common_config->id = util_strdup_s(id);
+        cont->state = (container_state_t *)util_common_calloc_s(sizeof(container_state_t));
+        cont->refcnt = 1;
+        m_containers[id] = cont;
+    }
+
+    char **ListIds()
+    {
+        char **ids = nullptr;
+
+        m_lists++;
+        for (auto &it : m_containers) {
+            (void)util_array_append(&ids, it.first.c_str());
+        }
+        return ids;
+    }
+
+    container_t *StoreGet(const char *id)
+    {
+        auto it = m_containers.find(id);
+
+        return it == m_containers.end() ? nullptr : it->second;
+    }
+
+    bool IsRunning(container_state_t *s)
+    {
+        return s == m_containers.at("c1")->state;
+    }
+
+    int ResourcesStats(const char *name, const char *runtime, const rt_stats_params_t *params,
+                       struct runtime_container_resources_stats_info *rs_stats)
+    {
+        if (strcmp(name, "c1") == 0) {
+            m_reads++;
+        }
+        rs_stats->mem_used = 1024;
+        return 0;
+    }
+
+    int AddMonitorClient(const char *name, const types_timestamp_t *since, const types_timestamp_t *until,
+                         const stream_func_wrapper *stream)
+    {
+        m_monitors++;
+        while (!stream->is_cancelled(stream->context)) {
+            usleep(1000);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped++;
+        m_cond.notify_all();
+        return 0;
+    }
+
+    bool WaitStopped(int times)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        return m_cond.wait_for(lock, std::chrono::seconds(5), [&] { return m_stopped >= times; });
+    }
+
+    NiceMock<MockRuntime> m_runtime;
+    NiceMock<MockContainersStore> m_containersStore;
+    NiceMock<MockContainerState> m_containerState;
+    NiceMock<MockContainerUnix> m_containerUnix;
+    NiceMock<MockCollector> m_collector;
+    NiceMock<MockIsuladConf> m_isuladConf;
+    NiceMock<MockSysinfo> m_sysinfo;
+
+    std::map<std::string, container_t *> m_containers;
+    std::atomic<int> m_lists { 0 };
+    std::atomic<int> m_reads { 0 };
+    std::atomic<int> m_monitors { 0 };
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::atomic<int> m_stopped { 0 };
+};
+
+static void collect_sample(const container_info *info, bool running, void *arg)
+{
+    std::map<std::string, bool> *sample = static_cast<std::map<std::string, bool> *>(arg);
+
+    (*sample)[info->id] = running;
+}
+
+TEST_F(StatsSamplerUnitTest, test_one_pass_for_all_clients)
+{
+    std::vector<stats_sampler_client_t *> clients;
+    std::vector<std::thread> threads;
+    std::atomic<int> samples { 0 };
+
+    for (int i = 0; i < STATS_SAMPLER_UT_CLIENTS; i++) {
+        stats_sampler_client_t *client = stats_sampler_join();
+        ASSERT_NE(client, nullptr);
+        clients.push_back(client);
+    }
+
+    for (auto client : clients) {
+        threads.emplace_back([client, &samples] {
+            int got = 0;
+
+            for (int i = 0; i < 10 * STATS_SAMPLER_UT_SAMPLES && got < STATS_SAMPLER_UT_SAMPLES; i++) {
+                std::map<std::string, bool> sample;
+
+                if (!stats_sampler_wait(client, 1000)) {
+                    continue;
+                }
+                stats_sampler_foreach(client, collect_sample, &sample);
+                if (sample.size() == 2 && sample["c1"] && !sample["c2"]) {
+                    got++;
+                }
+            }
+            samples += got;
+            stats_sampler_leave(client);
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    ASSERT_TRUE(WaitStopped(1));
+    ASSERT_EQ(samples, STATS_SAMPLER_UT_CLIENTS * STATS_SAMPLER_UT_SAMPLES);
+    // one read of c1 per pass for all clients, instead of one per client and sample
+    ASSERT_GE(m_reads, STATS_SAMPLER_UT_SAMPLES);
+    ASSERT_LE(m_reads, STATS_SAMPLER_UT_SAMPLES + 5);
+    ASSERT_EQ(m_monitors, 1);
+}
+
+TEST_F(StatsSamplerUnitTest, test_restart_on_last_leave)
+{
+    std::map<std::string, bool> sample;
+    stats_sampler_client_t *first = nullptr;
+    stats_sampler_client_t *second = nullptr;
+    int reads = 0;
+
+    first = stats_sampler_join();
+    second = stats_sampler_join();
+    ASSERT_NE(first, nullptr);
+    ASSERT_NE(second, nullptr);
+    ASSERT_TRUE(stats_sampler_wait(first, 1000));
+
+    // the sampler runs while a client is left
+    stats_sampler_leave(first);
+    ASSERT_TRUE(stats_sampler_wait(second, 1000));
+    ASSERT_TRUE(stats_sampler_wait(second, 1000));
+    stats_sampler_foreach(second, collect_sample, &sample);
+    ASSERT_EQ(sample.size(), 2U);
+    ASSERT_TRUE(sample["c1"]);
+    ASSERT_FALSE(sample["c2"]);
+    ASSERT_EQ(m_stopped, 0);
+
+    stats_sampler_leave(second);
+    ASSERT_TRUE(WaitStopped(1));
+    reads = m_reads;
+    usleep(3 * STATS_SAMPLER_INTERVAL_MS * 1000);
+    ASSERT_EQ(m_reads, reads);
+
+    // a new client starts it again, with the store listed again
+    first = stats_sampler_join();
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(stats_sampler_wait(first, 1000));
+    ASSERT_GT(m_reads, reads);
+    ASSERT_EQ(m_lists, 2);
+    ASSERT_EQ(m_monitors, 2);
+    stats_sampler_leave(first);
+    ASSERT_TRUE(WaitStopped(2));
+
+    ASSERT_FALSE(stats_sampler_wait(nullptr, 0));
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+ * Copyright (c) Huawei Technologies Co., Ltd. 2026. All rights reserved.
+ * iSulad licensed under the Mulan PSL v2.
+ * You can use this software according to the terms and conditions of the Mulan PSL v2.
+ * You may obtain a copy of Mulan PSL v2 at:
+ *     http://license.coscl.org.cn/MulanPSL2
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND, EITHER EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT, MERCHANTABILITY OR FIT FOR A PARTICULAR
+ * PURPOSE.
+ * See the Mulan PSL v2 for more details.
+ * Author: agent
+ * Create: 2026-10-18
+ * Description: provide io reactor unit test
+ ******************************************************************************/
+
+#include "io_reactor.h"
+#include <dirent.h>
+#include <string.h>
+#include <unistd.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "utils.h"
+
+#define IO_REACTOR_UT_SESSIONS 200
+#define IO_REACTOR_UT_CHUNKS 10
+
+namespace {
+struct Sink {
+    std::mutex mutex;
+    std::string data;
+    int closes { 0 };
+    useconds_t delay { 0 };
+};
+
+ssize_t SinkWrite(void *context, const void *data, size_t len)
+{
+    Sink *sink = static_cast<Sink *>(context);
+
+    if (sink->delay > 0) {
+        usleep(sink->delay);
+    }
+    std::lock_guard<std::mutex> lock(sink->mutex);
+    sink->data.append(static_cast<const char *>(data), len);
+    return (ssize_t)len;
+}
+
+int SinkClose(void *context, char **err)
+{
+    Sink *sink = static_cast<Sink *>(context);
+
+    (void)err;
+    std::lock_guard<std::mutex> lock(sink->mutex);
+    sink->closes++;
+    return 0;
+}
+
+int ThreadCount()
+{
+    DIR *dir = opendir("/proc/self/task");
+    struct dirent *entry = nullptr;
+    int count = 0;
+
+    if (dir == nullptr) {
+        return -1;
+    }
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] != '.') {
+            count++;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+void WriteAll(int fd, const std::string &data)
+{
+    ASSERT_EQ(util_write_nointr(fd, data.c_str(), data.size()), (ssize_t)data.size());
+}
+
+io_copy_session_t *StartWriterSession(int srcfd, Sink *sink)
+{
+    struct io_reactor_channel channel = { 0 };
+    io_copy_session_t *session = nullptr;
+
+    channel.srcfd = srcfd;
+    channel.dstfd = -1;
+    channel.writer.context = sink;
+    channel.writer.write_func = SinkWrite;
+    channel.writer.close_func = SinkClose;
+    if (io_reactor_session_start(-1, false, &channel, 1, &session) != 0) {
+        return nullptr;
+    }
+    return session;
+}
+} // namespace
+
+TEST(io_reactor_ut, test_writer_threads_bounded)
+{
+    std::vector<Sink> sinks(IO_REACTOR_UT_SESSIONS);
+    std::vector<int> writefds;
+    std::vector<io_copy_session_t *> sessions;
+    int before = ThreadCount();
+
+    ASSERT_GT(before, 0);
+    for (int i = 0; i < IO_REACTOR_UT_SESSIONS; i++) {
+        int fds[2] = { -1, -1 };
+        ASSERT_EQ(pipe(fds), 0);
+        sinks[i].delay = 100;
+        io_copy_session_t *session = StartWriterSession(fds[0], &sinks[i]);
+        ASSERT_NE(session, nullptr);
+        sessions.push_back(session);
+        writefds.push_back(fds[1]);
+    }
+
+    for (int j = 0; j < IO_REACTOR_UT_CHUNKS; j++) {
+        for (int i = 0; i < IO_REACTOR_UT_SESSIONS; i++) {
+            WriteAll(writefds[i], "s" + std::to_string(i) + "c" + std::to_string(j) + ";");
+        }
+    }
+
+    // every session is open and writing, the reactor and writer threads are shared by all of them
+    ASSERT_LE(ThreadCount(), before + 4 + 8);
+
+    for (int i = 0; i < IO_REACTOR_UT_SESSIONS; i++) {
+        close(writefds[i]);
+    }
+    for (int i = 0; i < IO_REACTOR_UT_SESSIONS; i++) {
+        ASSERT_EQ(io_copy_session_wait(sessions[i]), 0);
+    }
+
+    for (int i = 0; i < IO_REACTOR_UT_SESSIONS; i++) {
+        std::string expected;
+        for (int j = 0; j < IO_REACTOR_UT_CHUNKS; j++) {
+            expected += "s" + std::to_string(i) + "c" + std::to_string(j) + ";";
+        }
+        ASSERT_EQ(sinks[i].data, expected);
+        ASSERT_EQ(sinks[i].closes, 1);
+    }
+    ASSERT_LE(ThreadCount(), before + 4 + 8);
+}
+
+TEST(io_reactor_ut, test_slow_writer_keeps_order)
+{
+    Sink sink;
+    std::string expected;
+    int fds[2] = { -1, -1 };
+    io_copy_session_t *session = nullptr;
+
+    ASSERT_EQ(pipe(fds), 0);
+    sink.delay = 1000;
+    session = StartWriterSession(fds[0], &sink);
+    ASSERT_NE(session, nullptr);
+
+    // more than the writer queue holds, so the source is paused and resumed on the way
+    for (int i = 0; i < 256; i++) {
+        std::string block(4096, (char)('a' + i % 26));
+        expected += block;
+        WriteAll(fds[1], block);
+    }
+    close(fds[1]);
+    ASSERT_EQ(io_copy_session_wait(session), 0);
+
+    ASSERT_EQ(sink.data.size(), expected.size());
+    ASSERT_TRUE(sink.data == expected);
+    ASSERT_EQ(sink.closes, 1);
+}
+
+TEST(io_reactor_ut, test_fd_to_fd)
+{
+    struct io_reactor_channel channel = { 0 };
+    io_copy_session_t *session = nullptr;
+    int src[2] = { -1, -1 };
+    int dst[2] = { -1, -1 };
+    char buf[64] = { 0 };
+
+    ASSERT_EQ(pipe(src), 0);
+    ASSERT_EQ(pipe(dst), 0);
+    channel.srcfd = src[0];
+    channel.dstfd = dst[1];
+    ASSERT_EQ(io_reactor_session_start(-1, false, &channel, 1, &session), 0);
+
+    WriteAll(src[1], "hello");
+    ASSERT_EQ(util_read_nointr(dst[0], buf, 5), 5);
+    ASSERT_STREQ(buf, "hello");
+
+    close(src[1]);
+    ASSERT_EQ(io_copy_session_wait(session), 0);
+    // the session closed its end of dst
+    ASSERT_EQ(util_read_nointr(dst[0], buf, sizeof(buf)), 0);
+    close(dst[0]);
+}
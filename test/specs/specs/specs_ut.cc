@@ -15,10 +15,13 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include <gtest/gtest.h>
 #include "mock.h"
 #include "isula_libutils/oci_runtime_spec.h"
 #include "specs_api.h"
+#include "specs_template.h"
 #include "isula_libutils/host_config.h"
 #include "isula_libutils/container_config.h"
 #include "oci_ut_common.h"
@@ -331,3 +334,151 @@ TEST_F(SpecsUnitTest, test_merge_oci_cgroups_path_5)
 
     testing::Mock::VerifyAndClearExpectations(&m_isulad_conf);
 }
+
+static char *spec_json(const oci_runtime_spec *spec)
+{
+    struct parser_context ctx = { OPT_GEN_SIMPLIFY, 0 };
+    parser_error err = nullptr;
+    char *json = oci_runtime_spec_generate_json(spec, &ctx, &err);
+
+    free(err);
+    return json;
+}
+
+TEST(spec_template_ut, test_spec_template_clone_independent)
+{
+    char *oci_config_file = json_path(OCI_RUNTIME_SPEC_FILE);
+    parser_error err = nullptr;
+    oci_runtime_spec *spec = nullptr;
+    oci_runtime_spec *first = nullptr;
+    oci_runtime_spec *second = nullptr;
+    char *expected = nullptr;
+    char *json = nullptr;
+
+    ASSERT_TRUE(oci_config_file != nullptr);
+    spec = oci_runtime_spec_parse_file(oci_config_file, nullptr, &err);
+    ASSERT_TRUE(spec != nullptr);
+    expected = spec_json(spec);
+    ASSERT_TRUE(expected != nullptr);
+
+    first = spec_template_new_oci_spec(oci_config_file, &err);
+    ASSERT_TRUE(first != nullptr);
+    json = spec_json(first);
+    ASSERT_STREQ(json, expected);
+    free(json);
+
+    // change the first clone the way the create path does
+    free(first->hostname);
+    first->hostname = util_strdup_s("spec-template-clone");
+    ASSERT_TRUE(first->mounts_len > 0);
+    free(first->mounts[0]->destination);
+    first->mounts[0]->destination = util_strdup_s("/changed");
+    ASSERT_TRUE(first->process != nullptr && first->process->args_len > 0);
+    free(first->process->args[0]);
+    first->process->args[0] = util_strdup_s("changed");
+    ASSERT_TRUE(first->root != nullptr);
+    free(first->root->path);
+    first->root->path = util_strdup_s("/changed");
+
+    second = spec_template_new_oci_spec(oci_config_file, &err);
+    ASSERT_TRUE(second != nullptr);
+    ASSERT_NE(second->mounts, first->mounts);
+    ASSERT_NE(second->process, first->process);
+    json = spec_json(second);
+    ASSERT_STREQ(json, expected);
+    free(json);
+
+    free_oci_runtime_spec(first);
+    // the template outlives the clones
+    json = spec_json(second);
+    ASSERT_STREQ(json, expected);
+    free(json);
+    free_oci_runtime_spec(second);
+
+    spec_template_clear();
+    free_oci_runtime_spec(spec);
+    free(expected);
+    free(oci_config_file);
+    free(err);
+}
+
+TEST(spec_template_ut, test_spec_template_reload)
+{
+    const char *tmpfile = "./spec_template_ut.json";
+    char *oci_config_file = json_path(OCI_RUNTIME_SPEC_FILE);
+    parser_error err = nullptr;
+    oci_runtime_spec *spec = nullptr;
+    oci_runtime_spec *copy = nullptr;
+    char *json = nullptr;
+
+    ASSERT_TRUE(oci_config_file != nullptr);
+    spec = oci_runtime_spec_parse_file(oci_config_file, nullptr, &err);
+    ASSERT_TRUE(spec != nullptr);
+    json = spec_json(spec);
+    ASSERT_TRUE(json != nullptr);
+    ASSERT_EQ(util_write_file(tmpfile, json, strlen(json), 0600), 0);
+    free(json);
+
+    for (int i = 0; i < 2; i++) {
+        copy = spec_template_new_oci_spec(tmpfile, &err);
+        ASSERT_TRUE(copy != nullptr);
+        ASSERT_STREQ(copy->hostname, "localhost");
+        free_oci_runtime_spec(copy);
+    }
+
+    // rewritten file must not be served from the old template
+    free(spec->hostname);
+    spec->hostname = util_strdup_s("spec-template-changed");
+    json = spec_json(spec);
+    ASSERT_TRUE(json != nullptr);
+    ASSERT_EQ(util_write_file(tmpfile, json, strlen(json), 0600), 0);
+    free(json);
+
+    copy = spec_template_new_oci_spec(tmpfile, &err);
+    ASSERT_TRUE(copy != nullptr);
+    ASSERT_STREQ(copy->hostname, "spec-template-changed");
+    free_oci_runtime_spec(copy);
+
+    (void)unlink(tmpfile);
+    copy = spec_template_new_oci_spec(tmpfile, &err);
+    ASSERT_TRUE(copy == nullptr);
+    ASSERT_TRUE(err != nullptr);
+
+    spec_template_clear();
+    free_oci_runtime_spec(spec);
+    free(oci_config_file);
+    free(err);
+}
+
+TEST(spec_template_ut, test_spec_template_hooks_clone_independent)
+{
+    const char *tmpfile = "./spec_template_hooks_ut.json";
+    const char *data = "{\"prestart\": [{\"path\": \"/usr/bin/true\", \"args\": [\"true\", \"prestart\"]}]}";
+    parser_error err = nullptr;
+    oci_runtime_spec_hooks *first = nullptr;
+    oci_runtime_spec_hooks *second = nullptr;
+
+    ASSERT_EQ(util_write_file(tmpfile, data, strlen(data), 0600), 0);
+
+    first = spec_template_new_hooks(tmpfile, &err);
+    ASSERT_TRUE(first != nullptr);
+    ASSERT_EQ(first->prestart_len, 1U);
+    free(first->prestart[0]->path);
+    first->prestart[0]->path = util_strdup_s("/changed");
+    free(first->prestart[0]->args[1]);
+    first->prestart[0]->args[1] = util_strdup_s("changed");
+
+    second = spec_template_new_hooks(tmpfile, &err);
+    ASSERT_TRUE(second != nullptr);
+    ASSERT_EQ(second->prestart_len, 1U);
+    ASSERT_NE(second->prestart[0], first->prestart[0]);
+    ASSERT_STREQ(second->prestart[0]->path, "/usr/bin/true");
+    ASSERT_EQ(second->prestart[0]->args_len, 2U);
+    ASSERT_STREQ(second->prestart[0]->args[1], "prestart");
+
+    free_oci_runtime_spec_hooks(first);
+    free_oci_runtime_spec_hooks(second);
+    spec_template_clear();
+    (void)unlink(tmpfile);
+    free(err);
+}